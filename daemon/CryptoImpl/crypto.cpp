@@ -67,6 +67,7 @@ Daemon::ApiImpl::CryptoDBusObject::CryptoDBusObject(
 
 
 void Daemon::ApiImpl::CryptoDBusObject::getPluginInfo(
+        quint64 traceId,
         const QDBusMessage &message,
         Result &result,
         QVector<Sailfish::Crypto::PluginInfo> &cryptoPlugins,
@@ -79,6 +80,7 @@ void Daemon::ApiImpl::CryptoDBusObject::getPluginInfo(
                                   inParams,
                                   connection(),
                                   message,
+                                  traceId,
                                   result);
 }
 
@@ -87,6 +89,7 @@ void Daemon::ApiImpl::CryptoDBusObject::generateRandomData(
         const QString &csprngEngineName,
         const QVariantMap &customParameters,
         const QString &cryptosystemProviderName,
+        quint64 traceId,
         const QDBusMessage &message,
         Result &result,
         QByteArray &randomData)
@@ -101,6 +104,7 @@ void Daemon::ApiImpl::CryptoDBusObject::generateRandomData(
                                   inParams,
                                   connection(),
                                   message,
+                                  traceId,
                                   result);
 }
 
@@ -110,6 +114,7 @@ void Daemon::ApiImpl::CryptoDBusObject::seedRandomDataGenerator(
         const QString &csprngEngineName,
         const QVariantMap &customParameters,
         const QString &cryptosystemProviderName,
+        quint64 traceId,
         const QDBusMessage &message,
         Result &result)
 {
@@ -123,6 +128,7 @@ void Daemon::ApiImpl::CryptoDBusObject::seedRandomDataGenerator(
                                   inParams,
                                   connection(),
                                   message,
+                                  traceId,
                                   result);
 }
 
@@ -132,6 +138,7 @@ void Daemon::ApiImpl::CryptoDBusObject::generateInitializationVector(
         int keySize,
         const QVariantMap &customParameters,
         const QString &cryptosystemProviderName,
+        quint64 traceId,
         const QDBusMessage &message,
         Sailfish::Crypto::Result &result,
         QByteArray &generatedIV)
@@ -148,6 +155,7 @@ void Daemon::ApiImpl::CryptoDBusObject::generateInitializationVector(
                                   inParams,
                                   connection(),
                                   message,
+                                  traceId,
                                   result);
 }
 
@@ -157,6 +165,7 @@ void Daemon::ApiImpl::CryptoDBusObject::generateKey(
         const KeyDerivationParameters &skdfParams,
         const QVariantMap &customParameters,
         const QString &cryptosystemProviderName,
+        quint64 traceId,
         const QDBusMessage &message,
         Result &result,
         Key &key)
@@ -172,6 +181,7 @@ void Daemon::ApiImpl::CryptoDBusObject::generateKey(
                                   inParams,
                                   connection(),
                                   message,
+                                  traceId,
                                   result);
 }
 
@@ -182,6 +192,7 @@ void Daemon::ApiImpl::CryptoDBusObject::generateStoredKey(
         const InteractionParameters &uiParams,
         const QVariantMap &customParameters,
         const QString &cryptosystemProviderName,
+        quint64 traceId,
         const QDBusMessage &message,
         Result &result,
         Key &key)
@@ -198,6 +209,7 @@ void Daemon::ApiImpl::CryptoDBusObject::generateStoredKey(
                                   inParams,
                                   connection(),
                                   message,
+                                  traceId,
                                   result);
 }
 
@@ -206,6 +218,7 @@ void Daemon::ApiImpl::CryptoDBusObject::importKey(
         const Sailfish::Crypto::InteractionParameters &uiParams,
         const QVariantMap &customParameters,
         const QString &cryptosystemProviderName,
+        quint64 traceId,
         const QDBusMessage &message,
         Result &result,
         Key &importedKey)
@@ -220,6 +233,7 @@ void Daemon::ApiImpl::CryptoDBusObject::importKey(
                                   inParams,
                                   connection(),
                                   message,
+                                  traceId,
                                   result);
 }
 
@@ -229,6 +243,7 @@ void Daemon::ApiImpl::CryptoDBusObject::importStoredKey(
         const Sailfish::Crypto::InteractionParameters &uiParams,
         const QVariantMap &customParameters,
         const QString &cryptosystemProviderName,
+        quint64 traceId,
         const QDBusMessage &message,
         Result &result,
         Key &importedKey)
@@ -244,6 +259,7 @@ void Daemon::ApiImpl::CryptoDBusObject::importStoredKey(
                                   inParams,
                                   connection(),
                                   message,
+                                  traceId,
                                   result);
 }
 
@@ -251,6 +267,7 @@ void Daemon::ApiImpl::CryptoDBusObject::storedKey(
         const Key::Identifier &identifier,
         Key::Components keyComponents,
         const QVariantMap &customParameters,
+        quint64 traceId,
         const QDBusMessage &message,
         Result &result,
         Key &key)
@@ -264,11 +281,13 @@ void Daemon::ApiImpl::CryptoDBusObject::storedKey(
                                   inParams,
                                   connection(),
                                   message,
+                                  traceId,
                                   result);
 }
 
 void Daemon::ApiImpl::CryptoDBusObject::deleteStoredKey(
         const Key::Identifier &identifier,
+        quint64 traceId,
         const QDBusMessage &message,
         Result &result)
 {
@@ -278,6 +297,7 @@ void Daemon::ApiImpl::CryptoDBusObject::deleteStoredKey(
                                   inParams,
                                   connection(),
                                   message,
+                                  traceId,
                                   result);
 }
 
@@ -285,6 +305,7 @@ void Daemon::ApiImpl::CryptoDBusObject::storedKeyIdentifiers(
         const QString &storagePluginName,
         const QString &collectionName,
         const QVariantMap &customParameters,
+        quint64 traceId,
         const QDBusMessage &message,
         Result &result,
         QVector<Key::Identifier> &identifiers)
@@ -298,6 +319,7 @@ void Daemon::ApiImpl::CryptoDBusObject::storedKeyIdentifiers(
                                   inParams,
                                   connection(),
                                   message,
+                                  traceId,
                                   result);
 }
 
@@ -307,6 +329,7 @@ void Daemon::ApiImpl::CryptoDBusObject::calculateDigest(
         CryptoManager::DigestFunction digestFunction,
         const QVariantMap &customParameters,
         const QString &cryptosystemProviderName,
+        quint64 traceId,
         const QDBusMessage &message,
         Result &result,
         QByteArray &digest)
@@ -322,6 +345,7 @@ void Daemon::ApiImpl::CryptoDBusObject::calculateDigest(
                                   inParams,
                                   connection(),
                                   message,
+                                  traceId,
                                   result);
 }
 
@@ -332,6 +356,7 @@ void Daemon::ApiImpl::CryptoDBusObject::sign(
         CryptoManager::DigestFunction digest,
         const QVariantMap &customParameters,
         const QString &cryptosystemProviderName,
+        quint64 traceId,
         const QDBusMessage &message,
         Result &result,
         QByteArray &signature)
@@ -348,6 +373,7 @@ void Daemon::ApiImpl::CryptoDBusObject::sign(
                                   inParams,
                                   connection(),
                                   message,
+                                  traceId,
                                   result);
 }
 
@@ -359,6 +385,7 @@ void Daemon::ApiImpl::CryptoDBusObject::verify(
         CryptoManager::DigestFunction digest,
         const QVariantMap &customParameters,
         const QString &cryptosystemProviderName,
+        quint64 traceId,
         const QDBusMessage &message,
         Result &result,
         CryptoManager::VerificationStatus &verificationStatus)
@@ -376,6 +403,37 @@ void Daemon::ApiImpl::CryptoDBusObject::verify(
                                   inParams,
                                   connection(),
                                   message,
+                                  traceId,
+                                  result);
+}
+
+void Daemon::ApiImpl::CryptoDBusObject::batchVerify(
+        const QVector<QByteArray> &signatures,
+        const QVector<QByteArray> &data,
+        const Key &key,
+        CryptoManager::SignaturePadding padding,
+        CryptoManager::DigestFunction digest,
+        const QVariantMap &customParameters,
+        const QString &cryptosystemProviderName,
+        quint64 traceId,
+        const QDBusMessage &message,
+        Result &result,
+        QVector<CryptoManager::VerificationStatus> &verificationStatuses)
+{
+    Q_UNUSED(verificationStatuses);  // outparam, set in handlePendingRequest / handleFinishedRequest
+    QList<QVariant> inParams;
+    inParams << QVariant::fromValue<QVector<QByteArray> >(signatures);
+    inParams << QVariant::fromValue<QVector<QByteArray> >(data);
+    inParams << QVariant::fromValue<Key>(MAP_PLUGIN_NAMES(key));
+    inParams << QVariant::fromValue<CryptoManager::SignaturePadding>(padding);
+    inParams << QVariant::fromValue<CryptoManager::DigestFunction>(digest);
+    inParams << QVariant::fromValue<QVariantMap>(customParameters);
+    inParams << QVariant::fromValue<QString>(MAP_PLUGIN_NAMES(cryptosystemProviderName));
+    m_requestQueue->handleRequest(Daemon::ApiImpl::BatchVerifyRequest,
+                                  inParams,
+                                  connection(),
+                                  message,
+                                  traceId,
                                   result);
 }
 
@@ -388,6 +446,7 @@ void Daemon::ApiImpl::CryptoDBusObject::encrypt(
         const QByteArray &authenticationData,
         const QVariantMap &customParameters,
         const QString &cryptosystemProviderName,
+        quint64 traceId,
         const QDBusMessage &message,
         Result &result,
         QByteArray &encrypted,
@@ -410,6 +469,7 @@ void Daemon::ApiImpl::CryptoDBusObject::encrypt(
                                   inParams,
                                   connection(),
                                   message,
+                                  traceId,
                                   result);
 }
 
@@ -423,6 +483,7 @@ void Daemon::ApiImpl::CryptoDBusObject::decrypt(
         const QByteArray &authenticationTag,
         const QVariantMap &customParameters,
         const QString &cryptosystemProviderName,
+        quint64 traceId,
         const QDBusMessage &message,
         Result &result,
         QByteArray &decrypted,
@@ -446,6 +507,7 @@ void Daemon::ApiImpl::CryptoDBusObject::decrypt(
                                   inParams,
                                   connection(),
                                   message,
+                                  traceId,
                                   result);
 }
 
@@ -459,6 +521,7 @@ void Daemon::ApiImpl::CryptoDBusObject::initializeCipherSession(
         Sailfish::Crypto::CryptoManager::DigestFunction digest,
         const QVariantMap &customParameters,
         const QString &cryptosystemProviderName,
+        quint64 traceId,
         const QDBusMessage &message,
         Sailfish::Crypto::Result &result,
         quint32 &cipherSessionToken)
@@ -478,6 +541,7 @@ void Daemon::ApiImpl::CryptoDBusObject::initializeCipherSession(
                                   inParams,
                                   connection(),
                                   message,
+                                  traceId,
                                   result);
 }
 
@@ -486,6 +550,7 @@ void Daemon::ApiImpl::CryptoDBusObject::updateCipherSessionAuthentication(
         const QVariantMap &customParameters,
         const QString &cryptosystemProviderName,
         quint32 cipherSessionToken,
+        quint64 traceId,
         const QDBusMessage &message,
         Sailfish::Crypto::Result &result)
 {
@@ -498,6 +563,7 @@ void Daemon::ApiImpl::CryptoDBusObject::updateCipherSessionAuthentication(
                                   inParams,
                                   connection(),
                                   message,
+                                  traceId,
                                   result);
 }
 
@@ -506,6 +572,7 @@ void Daemon::ApiImpl::CryptoDBusObject::updateCipherSession(
         const QVariantMap &customParameters,
         const QString &cryptosystemProviderName,
         quint32 cipherSessionToken,
+        quint64 traceId,
         const QDBusMessage &message,
         Sailfish::Crypto::Result &result,
         QByteArray &generatedData)
@@ -520,6 +587,7 @@ void Daemon::ApiImpl::CryptoDBusObject::updateCipherSession(
                                   inParams,
                                   connection(),
                                   message,
+                                  traceId,
                                   result);
 }
 
@@ -528,6 +596,7 @@ void Daemon::ApiImpl::CryptoDBusObject::finalizeCipherSession(
         const QVariantMap &customParameters,
         const QString &cryptosystemProviderName,
         quint32 cipherSessionToken,
+        quint64 traceId,
         const QDBusMessage &message,
         Sailfish::Crypto::Result &result,
         QByteArray &generatedData,
@@ -544,12 +613,14 @@ void Daemon::ApiImpl::CryptoDBusObject::finalizeCipherSession(
                                   inParams,
                                   connection(),
                                   message,
+                                  traceId,
                                   result);
 }
 
 void Daemon::ApiImpl::CryptoDBusObject::queryLockStatus(
         LockCodeRequest::LockCodeTargetType lockCodeTargetType,
         const QString &lockCodeTarget,
+        quint64 traceId,
         const QDBusMessage &message,
         Result &result,
         LockCodeRequest::LockStatus &lockStatus)
@@ -562,6 +633,7 @@ void Daemon::ApiImpl::CryptoDBusObject::queryLockStatus(
                                   inParams,
                                   connection(),
                                   message,
+                                  traceId,
                                   result);
 }
 
@@ -569,6 +641,7 @@ void Daemon::ApiImpl::CryptoDBusObject::modifyLockCode(
         LockCodeRequest::LockCodeTargetType lockCodeTargetType,
         const QString &lockCodeTarget,
         const InteractionParameters &interactionParameters,
+        quint64 traceId,
         const QDBusMessage &message,
         Result &result)
 {
@@ -580,6 +653,7 @@ void Daemon::ApiImpl::CryptoDBusObject::modifyLockCode(
                                   inParams,
                                   connection(),
                                   message,
+                                  traceId,
                                   result);
 }
 
@@ -587,6 +661,7 @@ void Daemon::ApiImpl::CryptoDBusObject::provideLockCode(
         LockCodeRequest::LockCodeTargetType lockCodeTargetType,
         const QString &lockCodeTarget,
         const InteractionParameters &interactionParameters,
+        quint64 traceId,
         const QDBusMessage &message,
         Result &result)
 {
@@ -598,6 +673,7 @@ void Daemon::ApiImpl::CryptoDBusObject::provideLockCode(
                                   inParams,
                                   connection(),
                                   message,
+                                  traceId,
                                   result);
 }
 
@@ -605,6 +681,7 @@ void Daemon::ApiImpl::CryptoDBusObject::forgetLockCode(
         LockCodeRequest::LockCodeTargetType lockCodeTargetType,
         const QString &lockCodeTarget,
         const InteractionParameters &interactionParameters,
+        quint64 traceId,
         const QDBusMessage &message,
         Result &result)
 {
@@ -616,6 +693,51 @@ void Daemon::ApiImpl::CryptoDBusObject::forgetLockCode(
                                   inParams,
                                   connection(),
                                   message,
+                                  traceId,
+                                  result);
+}
+
+void Daemon::ApiImpl::CryptoDBusObject::openKeySession(
+        const Key &key,
+        CryptoManager::Operations operations,
+        const QVariantMap &customParameters,
+        const QString &cryptosystemProviderName,
+        quint64 traceId,
+        const QDBusMessage &message,
+        Result &result,
+        quint32 &keySessionToken)
+{
+    Q_UNUSED(keySessionToken);  // outparam, set in handlePendingRequest / handleFinishedRequest
+    QList<QVariant> inParams;
+    inParams << QVariant::fromValue<Key>(MAP_PLUGIN_NAMES(key));
+    inParams << QVariant::fromValue<CryptoManager::Operations>(operations);
+    inParams << QVariant::fromValue<QVariantMap>(customParameters);
+    inParams << QVariant::fromValue<QString>(MAP_PLUGIN_NAMES(cryptosystemProviderName));
+    m_requestQueue->handleRequest(Daemon::ApiImpl::OpenKeySessionRequest,
+                                  inParams,
+                                  connection(),
+                                  message,
+                                  traceId,
+                                  result);
+}
+
+void Daemon::ApiImpl::CryptoDBusObject::closeKeySession(
+        quint32 keySessionToken,
+        const QVariantMap &customParameters,
+        const QString &cryptosystemProviderName,
+        quint64 traceId,
+        const QDBusMessage &message,
+        Result &result)
+{
+    QList<QVariant> inParams;
+    inParams << QVariant::fromValue<quint32>(keySessionToken);
+    inParams << QVariant::fromValue<QVariantMap>(customParameters);
+    inParams << QVariant::fromValue<QString>(MAP_PLUGIN_NAMES(cryptosystemProviderName));
+    m_requestQueue->handleRequest(Daemon::ApiImpl::CloseKeySessionRequest,
+                                  inParams,
+                                  connection(),
+                                  message,
+                                  traceId,
                                   result);
 }
 
@@ -659,6 +781,15 @@ QWeakPointer<QThreadPool> Daemon::ApiImpl::CryptoRequestQueue::cryptoThreadPool(
     return m_cryptoThreadPool.toWeakRef();
 }
 
+// The worker threads of the pool never expire by themselves, so that
+// plugin state with thread affinity remains usable between requests.
+// Once the pool is idle, waiting for it to be done also terminates its
+// threads; a new thread is started on demand by the next request.
+bool Daemon::ApiImpl::CryptoRequestQueue::releaseIdleThreads()
+{
+    return m_cryptoThreadPool->waitForDone(0);
+}
+
 QMap<QString, Sailfish::Crypto::CryptoPlugin*>
 Daemon::ApiImpl::CryptoRequestQueue::plugins() const
 {
@@ -692,6 +823,12 @@ bool Daemon::ApiImpl::CryptoRequestQueue::setLockCodePlugin(
     return m_requestProcessor->setLockCodePlugin(pluginName, oldCode, newCode);
 }
 
+void Daemon::ApiImpl::CryptoRequestQueue::handleClientDisconnected(
+        const QString &connectionName)
+{
+    m_requestProcessor->closeKeySessions(connectionName);
+}
+
 QString Daemon::ApiImpl::CryptoRequestQueue::requestTypeToString(int type) const
 {
     switch (type) {
@@ -720,6 +857,9 @@ QString Daemon::ApiImpl::CryptoRequestQueue::requestTypeToString(int type) const
         case ModifyLockCodeRequest:            return QLatin1String("ModifyLockCodeRequest");
         case ProvideLockCodeRequest:           return QLatin1String("ProvideLockCodeRequest");
         case ForgetLockCodeRequest:            return QLatin1String("ForgetLockCodeRequest");
+        case BatchVerifyRequest:               return QLatin1String("BatchVerifyRequest");
+        case OpenKeySessionRequest:            return QLatin1String("OpenKeySessionRequest");
+        case CloseKeySessionRequest:           return QLatin1String("CloseKeySessionRequest");
         default: break;
     }
     return QLatin1String("Unknown Crypto Request!");
@@ -1153,6 +1293,38 @@ void Daemon::ApiImpl::CryptoRequestQueue::handlePendingRequest(
             }
             break;
         }
+        case BatchVerifyRequest: {
+            qCDebug(lcSailfishCryptoDaemon) << "Handling BatchVerifyRequest from client:" << request->remotePid << ", request number:" << request->requestId;
+            QVector<CryptoManager::VerificationStatus> verificationStatuses;
+            QVector<QByteArray> signatures = request->inParams.size() ? request->inParams.takeFirst().value<QVector<QByteArray> >() : QVector<QByteArray>();
+            QVector<QByteArray> data = request->inParams.size() ? request->inParams.takeFirst().value<QVector<QByteArray> >() : QVector<QByteArray>();
+            Key key = request->inParams.size() ? request->inParams.takeFirst().value<Key>() : Key();
+            CryptoManager::SignaturePadding padding = request->inParams.size() ? request->inParams.takeFirst().value<CryptoManager::SignaturePadding>() : CryptoManager::SignaturePaddingUnknown;
+            CryptoManager::DigestFunction digest = request->inParams.size() ? request->inParams.takeFirst().value<CryptoManager::DigestFunction>() : CryptoManager::DigestUnknown;
+            QVariantMap customParameters = request->inParams.size() ? request->inParams.takeFirst().value<QVariantMap>() : QVariantMap();
+            QString cryptosystemProviderName = request->inParams.size() ? request->inParams.takeFirst().value<QString>() : QString();
+            Result result = m_requestProcessor->batchVerify(
+                        request->remotePid,
+                        request->requestId,
+                        signatures,
+                        data,
+                        key,
+                        padding,
+                        digest,
+                        customParameters,
+                        cryptosystemProviderName,
+                        &verificationStatuses);
+            // send the reply to the calling peer.
+            if (result.code() == Result::Pending) {
+                // waiting for asynchronous flow to complete
+                *completed = false;
+            } else {
+                request->connection.send(request->message.createReply() << QVariant::fromValue<Result>(result)
+                                                                        << QVariant::fromValue<QVector<CryptoManager::VerificationStatus> >(verificationStatuses));
+                *completed = true;
+            }
+            break;
+        }
         case EncryptRequest: {
             qCDebug(lcSailfishCryptoDaemon) << "Handling EncryptRequest from client:" << request->remotePid << ", request number:" << request->requestId;
             QByteArray encrypted;
@@ -1450,6 +1622,54 @@ void Daemon::ApiImpl::CryptoRequestQueue::handlePendingRequest(
             }
             break;
         }
+        case OpenKeySessionRequest: {
+            qCDebug(lcSailfishCryptoDaemon) << "Handling OpenKeySessionRequest from client:" << request->remotePid << ", request number:" << request->requestId;
+            quint32 keySessionToken = 0;
+            Key key = request->inParams.size() ? request->inParams.takeFirst().value<Key>() : Key();
+            CryptoManager::Operations operations = request->inParams.size() ? request->inParams.takeFirst().value<CryptoManager::Operations>() : CryptoManager::OperationUnknown;
+            QVariantMap customParameters = request->inParams.size() ? request->inParams.takeFirst().value<QVariantMap>() : QVariantMap();
+            QString cryptosystemProviderName = request->inParams.size() ? request->inParams.takeFirst().value<QString>() : QString();
+            Result result = m_requestProcessor->openKeySession(
+                        request->remotePid,
+                        request->requestId,
+                        request->connection.name(),
+                        key,
+                        operations,
+                        customParameters,
+                        cryptosystemProviderName,
+                        &keySessionToken);
+            // send the reply to the calling peer.
+            if (result.code() == Result::Pending) {
+                // waiting for asynchronous flow to complete
+                *completed = false;
+            } else {
+                request->connection.send(request->message.createReply() << QVariant::fromValue<Result>(result)
+                                                                        << QVariant::fromValue<quint32>(keySessionToken));
+                *completed = true;
+            }
+            break;
+        }
+        case CloseKeySessionRequest: {
+            qCDebug(lcSailfishCryptoDaemon) << "Handling CloseKeySessionRequest from client:" << request->remotePid << ", request number:" << request->requestId;
+            quint32 keySessionToken = request->inParams.size() ? request->inParams.takeFirst().value<quint32>() : 0;
+            QVariantMap customParameters = request->inParams.size() ? request->inParams.takeFirst().value<QVariantMap>() : QVariantMap();
+            QString cryptosystemProviderName = request->inParams.size() ? request->inParams.takeFirst().value<QString>() : QString();
+            Result result = m_requestProcessor->closeKeySession(
+                        request->remotePid,
+                        request->requestId,
+                        keySessionToken,
+                        customParameters,
+                        cryptosystemProviderName);
+            // send the reply to the calling peer.
+            if (result.code() == Result::Pending) {
+                // waiting for asynchronous flow to complete
+                *completed = false;
+            } else {
+                request->connection.send(request->message.createReply() << QVariant::fromValue<Result>(result));
+                *completed = true;
+            }
+            break;
+        }
         default: {
             qCWarning(lcSailfishCryptoDaemon) << "Cannot handle request:" << request->requestId
                                               << "with invalid type:" << requestTypeToString(request->type);
@@ -1723,6 +1943,25 @@ void Daemon::ApiImpl::CryptoRequestQueue::handleFinishedRequest(
             }
             break;
         }
+        case BatchVerifyRequest: {
+            Result result = request->outParams.size()
+                    ? request->outParams.takeFirst().value<Result>()
+                    : Result(Result::UnknownError,
+                             QLatin1String("Unable to determine result of BatchVerifyRequest request"));
+            if (result.code() == Result::Pending) {
+                // shouldn't happen!
+                qCWarning(lcSailfishCryptoDaemon) << "BatchVerifyRequest:" << request->requestId << "finished as pending!";
+                *completed = true;
+            } else {
+                QVector<CryptoManager::VerificationStatus> verificationStatuses = request->outParams.size()
+                        ? request->outParams.takeFirst().value<QVector<CryptoManager::VerificationStatus> >()
+                        : QVector<CryptoManager::VerificationStatus>();
+                request->connection.send(request->message.createReply() << QVariant::fromValue<Result>(result)
+                                                                        << QVariant::fromValue<QVector<CryptoManager::VerificationStatus> >(verificationStatuses));
+                *completed = true;
+            }
+            break;
+        }
         case EncryptRequest: {
             Result result = request->outParams.size()
                     ? request->outParams.takeFirst().value<Result>()
@@ -1912,6 +2151,25 @@ void Daemon::ApiImpl::CryptoRequestQueue::handleFinishedRequest(
             }
             break;
         }
+        case OpenKeySessionRequest: {
+            Result result = request->outParams.size()
+                    ? request->outParams.takeFirst().value<Result>()
+                    : Result(Result::UnknownError,
+                             QLatin1String("Unable to determine result of OpenKeySessionRequest request"));
+            if (result.code() == Result::Pending) {
+                // shouldn't happen!
+                qCWarning(lcSailfishCryptoDaemon) << "OpenKeySessionRequest:" << request->requestId << "finished as pending!";
+                *completed = true;
+            } else {
+                quint32 keySessionToken = request->outParams.size()
+                        ? request->outParams.takeFirst().value<quint32>()
+                        : 0;
+                request->connection.send(request->message.createReply() << QVariant::fromValue<Result>(result)
+                                                                        << QVariant::fromValue<quint32>(keySessionToken));
+                *completed = true;
+            }
+            break;
+        }
         default: {
             qCWarning(lcSailfishCryptoDaemon) << "Cannot handle synchronous request:" << request->requestId << "with type:" << requestTypeToString(request->type) << "in an asynchronous fashion";
             *completed = false;
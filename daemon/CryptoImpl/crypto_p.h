@@ -53,6 +53,7 @@ class CryptoDBusObject : public QObject, protected QDBusContext
     Q_CLASSINFO("D-Bus Introspection", ""
     "  <interface name=\"org.sailfishos.crypto\">\n"
     "      <method name=\"getPluginInfo\">\n"
+    "          <arg name=\"traceId\" type=\"t\" direction=\"in\" />\n"
     "          <arg name=\"result\" type=\"(iiis)\" direction=\"out\" />\n"
     "          <arg name=\"cryptoPlugins\" type=\"a(ssi)\" direction=\"out\" />\n"
     "          <arg name=\"storagePlugins\" type=\"a(ssi)\" direction=\"out\" />\n"
@@ -65,6 +66,7 @@ class CryptoDBusObject : public QObject, protected QDBusContext
     "          <arg name=\"csprngEngineName\" type=\"s\" direction=\"in\" />\n"
     "          <arg name=\"customParameters\" type=\"a{sv}\" direction=\"in\" />\n"
     "          <arg name=\"cryptosystemProviderName\" type=\"s\" direction=\"in\" />\n"
+    "          <arg name=\"traceId\" type=\"t\" direction=\"in\" />\n"
     "          <arg name=\"result\" type=\"(iiis)\" direction=\"out\" />\n"
     "          <arg name=\"randomData\" type=\"ay\" direction=\"out\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.Out0\" value=\"Sailfish::Crypto::Result\" />\n"
@@ -75,6 +77,7 @@ class CryptoDBusObject : public QObject, protected QDBusContext
     "          <arg name=\"csprngEngineName\" type=\"s\" direction=\"in\" />\n"
     "          <arg name=\"customParameters\" type=\"a{sv}\" direction=\"in\" />\n"
     "          <arg name=\"cryptosystemProviderName\" type=\"s\" direction=\"in\" />\n"
+    "          <arg name=\"traceId\" type=\"t\" direction=\"in\" />\n"
     "          <arg name=\"result\" type=\"(iiis)\" direction=\"out\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.Out0\" value=\"Sailfish::Crypto::Result\" />\n"
     "      </method>\n"
@@ -84,6 +87,7 @@ class CryptoDBusObject : public QObject, protected QDBusContext
     "          <arg name=\"skdfParameters\" type=\"(ayay(i)(i)(i)(i)xiiia{sv})\" direction=\"in\" />\n"
     "          <arg name=\"customParameters\" type=\"a{sv}\" direction=\"in\" />\n"
     "          <arg name=\"cryptosystemProviderName\" type=\"s\" direction=\"in\" />\n"
+    "          <arg name=\"traceId\" type=\"t\" direction=\"in\" />\n"
     "          <arg name=\"result\" type=\"(iiis)\" direction=\"out\" />\n"
     "          <arg name=\"key\" type=\"(ay)\" direction=\"out\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.In0\" value=\"Sailfish::Crypto::Key\" />\n"
@@ -99,6 +103,7 @@ class CryptoDBusObject : public QObject, protected QDBusContext
     "          <arg name=\"uiParams\" type=\"(sss(i)sss(i)(i))\" direction=\"in\" />\n"
     "          <arg name=\"customParameters\" type=\"a{sv}\" direction=\"in\" />\n"
     "          <arg name=\"cryptosystemProviderName\" type=\"s\" direction=\"in\" />\n"
+    "          <arg name=\"traceId\" type=\"t\" direction=\"in\" />\n"
     "          <arg name=\"result\" type=\"(iiis)\" direction=\"out\" />\n"
     "          <arg name=\"key\" type=\"(ay)\" direction=\"out\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.In0\" value=\"Sailfish::Crypto::Key\" />\n"
@@ -113,6 +118,7 @@ class CryptoDBusObject : public QObject, protected QDBusContext
     "          <arg name=\"uiParams\" type=\"(ssss(i)ssa{is}(i)(i))\" direction=\"in\" />\n"
     "          <arg name=\"customParameters\" type=\"a{sv}\" direction=\"in\" />\n"
     "          <arg name=\"cryptosystemProviderName\" type=\"s\" direction=\"in\" />\n"
+    "          <arg name=\"traceId\" type=\"t\" direction=\"in\" />\n"
     "          <arg name=\"result\" type=\"(iiis)\" direction=\"out\" />\n"
     "          <arg name=\"importedKey\" type=\"(ay)\" direction=\"out\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.In1\" value=\"Sailfish::Crypto::InteractionParameters\" />\n"
@@ -125,6 +131,7 @@ class CryptoDBusObject : public QObject, protected QDBusContext
     "          <arg name=\"uiParams\" type=\"(ssss(i)ssa{is}(i)(i))\" direction=\"in\" />\n"
     "          <arg name=\"customParameters\" type=\"a{sv}\" direction=\"in\" />\n"
     "          <arg name=\"cryptosystemProviderName\" type=\"s\" direction=\"in\" />\n"
+    "          <arg name=\"traceId\" type=\"t\" direction=\"in\" />\n"
     "          <arg name=\"result\" type=\"(iiis)\" direction=\"out\" />\n"
     "          <arg name=\"importedKeyReference\" type=\"(ay)\" direction=\"out\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.In1\" value=\"Sailfish::Crypto::Key\" />\n"
@@ -136,6 +143,7 @@ class CryptoDBusObject : public QObject, protected QDBusContext
     "          <arg name=\"identifier\" type=\"(sss)\" direction=\"in\" />\n"
     "          <arg name=\"keyComponents\" type=\"(i)\" direction=\"in\" />\n"
     "          <arg name=\"customParameters\" type=\"a{sv}\" direction=\"in\" />\n"
+    "          <arg name=\"traceId\" type=\"t\" direction=\"in\" />\n"
     "          <arg name=\"result\" type=\"(iiis)\" direction=\"out\" />\n"
     "          <arg name=\"key\" type=\"(ay)\" direction=\"out\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.In0\" value=\"Sailfish::Crypto::Key::Identifier\" />\n"
@@ -145,6 +153,7 @@ class CryptoDBusObject : public QObject, protected QDBusContext
     "      </method>\n"
     "      <method name=\"deleteStoredKey\">\n"
     "          <arg name=\"identifier\" type=\"(sss)\" direction=\"in\" />\n"
+    "          <arg name=\"traceId\" type=\"t\" direction=\"in\" />\n"
     "          <arg name=\"result\" type=\"(iiis)\" direction=\"out\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.In0\" value=\"Sailfish::Crypto::Key::Identifier\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.Out0\" value=\"Sailfish::Crypto::Result\" />\n"
@@ -153,8 +162,9 @@ class CryptoDBusObject : public QObject, protected QDBusContext
     "          <arg name=\"storagePluginName\" type=\"s\" direction=\"in\" />\n"
     "          <arg name=\"collectionName\" type=\"s\" direction=\"in\" />\n"
     "          <arg name=\"customParameters\" type=\"a{sv}\" direction=\"in\" />\n"
+    "          <arg name=\"traceId\" type=\"t\" direction=\"in\" />\n"
     "          <arg name=\"result\" type=\"(iiis)\" direction=\"out\" />\n"
-    "          <arg name=\"identifiers\" type=\"a(sss)\" direction=\"out\" />\n"
+    "          <arg name=\"identifiers\" type=\"a(ssas)\" direction=\"out\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.Out0\" value=\"Sailfish::Crypto::Result\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.Out1\" value=\"QVector<Sailfish::Crypto::Key::Identifier>\" />\n"
     "      </method>\n"
@@ -164,6 +174,7 @@ class CryptoDBusObject : public QObject, protected QDBusContext
     "          <arg name=\"digestFunction\" type=\"(i)\" direction=\"in\" />\n"
     "          <arg name=\"customParameters\" type=\"a{sv}\" direction=\"in\" />\n"
     "          <arg name=\"cryptosystemProviderName\" type=\"s\" direction=\"in\" />\n"
+    "          <arg name=\"traceId\" type=\"t\" direction=\"in\" />\n"
     "          <arg name=\"result\" type=\"(iiis)\" direction=\"out\" />\n"
     "          <arg name=\"digest\" type=\"ay\" direction=\"out\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.In1\" value=\"Sailfish::Crypto::CryptoManager::SignaturePadding\" />\n"
@@ -177,6 +188,7 @@ class CryptoDBusObject : public QObject, protected QDBusContext
     "          <arg name=\"digest\" type=\"(i)\" direction=\"in\" />\n"
     "          <arg name=\"customParameters\" type=\"a{sv}\" direction=\"in\" />\n"
     "          <arg name=\"cryptosystemProviderName\" type=\"s\" direction=\"in\" />\n"
+    "          <arg name=\"traceId\" type=\"t\" direction=\"in\" />\n"
     "          <arg name=\"result\" type=\"(iiis)\" direction=\"out\" />\n"
     "          <arg name=\"signature\" type=\"ay\" direction=\"out\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.In1\" value=\"Sailfish::Crypto::Key\" />\n"
@@ -192,6 +204,7 @@ class CryptoDBusObject : public QObject, protected QDBusContext
     "          <arg name=\"digest\" type=\"(i)\" direction=\"in\" />\n"
     "          <arg name=\"customParameters\" type=\"a{sv}\" direction=\"in\" />\n"
     "          <arg name=\"cryptosystemProviderName\" type=\"s\" direction=\"in\" />\n"
+    "          <arg name=\"traceId\" type=\"t\" direction=\"in\" />\n"
     "          <arg name=\"result\" type=\"(iiis)\" direction=\"out\" />\n"
     "          <arg name=\"verificationStatus\" type=\"(i)\" direction=\"out\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.In2\" value=\"Sailfish::Crypto::Key\" />\n"
@@ -200,6 +213,25 @@ class CryptoDBusObject : public QObject, protected QDBusContext
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.Out0\" value=\"Sailfish::Crypto::Result\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.Out1\" value=\"Sailfish::Crypto::CryptoManager::VerificationStatus\" />\n"
     "      </method>\n"
+    "      <method name=\"batchVerify\">\n"
+    "          <arg name=\"signatures\" type=\"aay\" direction=\"in\" />\n"
+    "          <arg name=\"data\" type=\"aay\" direction=\"in\" />\n"
+    "          <arg name=\"key\" type=\"(ay)\" direction=\"in\" />\n"
+    "          <arg name=\"padding\" type=\"(i)\" direction=\"in\" />\n"
+    "          <arg name=\"digest\" type=\"(i)\" direction=\"in\" />\n"
+    "          <arg name=\"customParameters\" type=\"a{sv}\" direction=\"in\" />\n"
+    "          <arg name=\"cryptosystemProviderName\" type=\"s\" direction=\"in\" />\n"
+    "          <arg name=\"traceId\" type=\"t\" direction=\"in\" />\n"
+    "          <arg name=\"result\" type=\"(iiis)\" direction=\"out\" />\n"
+    "          <arg name=\"verificationStatuses\" type=\"a(i)\" direction=\"out\" />\n"
+    "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.In0\" value=\"QVector<QByteArray>\" />\n"
+    "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.In1\" value=\"QVector<QByteArray>\" />\n"
+    "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.In2\" value=\"Sailfish::Crypto::Key\" />\n"
+    "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.In3\" value=\"Sailfish::Crypto::CryptoManager::SignaturePadding\" />\n"
+    "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.In4\" value=\"Sailfish::Crypto::CryptoManager::Digest\" />\n"
+    "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.Out0\" value=\"Sailfish::Crypto::Result\" />\n"
+    "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.Out1\" value=\"QVector<Sailfish::Crypto::CryptoManager::VerificationStatus>\" />\n"
+    "      </method>\n"
     "      <method name=\"encrypt\">\n"
     "          <arg name=\"data\" type=\"ay\" direction=\"in\" />\n"
     "          <arg name=\"iv\" type=\"ay\" direction=\"in\" />\n"
@@ -209,6 +241,7 @@ class CryptoDBusObject : public QObject, protected QDBusContext
     "          <arg name=\"authenticationData\" type=\"ay\" direction=\"in\" />\n"
     "          <arg name=\"customParameters\" type=\"a{sv}\" direction=\"in\" />\n"
     "          <arg name=\"cryptosystemProviderName\" type=\"s\" direction=\"in\" />\n"
+    "          <arg name=\"traceId\" type=\"t\" direction=\"in\" />\n"
     "          <arg name=\"result\" type=\"(iiis)\" direction=\"out\" />\n"
     "          <arg name=\"encrypted\" type=\"ay\" direction=\"out\" />\n"
     "          <arg name=\"authenticationTag\" type=\"ay\" direction=\"out\" />\n"
@@ -227,6 +260,7 @@ class CryptoDBusObject : public QObject, protected QDBusContext
     "          <arg name=\"authenticationTag\" type=\"ay\" direction=\"in\" />\n"
     "          <arg name=\"customParameters\" type=\"a{sv}\" direction=\"in\" />\n"
     "          <arg name=\"cryptosystemProviderName\" type=\"s\" direction=\"in\" />\n"
+    "          <arg name=\"traceId\" type=\"t\" direction=\"in\" />\n"
     "          <arg name=\"result\" type=\"(iiis)\" direction=\"out\" />\n"
     "          <arg name=\"decrypted\" type=\"ay\" direction=\"out\" />\n"
     "          <arg name=\"verificationStatus\" type=\"(i)\" direction=\"out\" />\n"
@@ -246,6 +280,7 @@ class CryptoDBusObject : public QObject, protected QDBusContext
     "          <arg name=\"digest\" type=\"(i)\" direction=\"in\" />\n"
     "          <arg name=\"customParameters\" type=\"a{sv}\" direction=\"in\" />\n"
     "          <arg name=\"cryptosystemProviderName\" type=\"s\" direction=\"in\" />\n"
+    "          <arg name=\"traceId\" type=\"t\" direction=\"in\" />\n"
     "          <arg name=\"result\" type=\"(iiis)\" direction=\"out\" />\n"
     "          <arg name=\"cipherSessionToken\" type=\"u\" direction=\"out\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.In1\" value=\"Sailfish::Crypto::Key\" />\n"
@@ -261,6 +296,7 @@ class CryptoDBusObject : public QObject, protected QDBusContext
     "          <arg name=\"customParameters\" type=\"a{sv}\" direction=\"in\" />\n"
     "          <arg name=\"cryptosystemProviderName\" type=\"s\" direction=\"in\" />\n"
     "          <arg name=\"cipherSessionToken\" type=\"u\" direction=\"in\" />\n"
+    "          <arg name=\"traceId\" type=\"t\" direction=\"in\" />\n"
     "          <arg name=\"result\" type=\"(iiis)\" direction=\"out\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.Out0\" value=\"Sailfish::Crypto::Result\" />\n"
     "      </method>\n"
@@ -269,6 +305,7 @@ class CryptoDBusObject : public QObject, protected QDBusContext
     "          <arg name=\"customParameters\" type=\"a{sv}\" direction=\"in\" />\n"
     "          <arg name=\"cryptosystemProviderName\" type=\"s\" direction=\"in\" />\n"
     "          <arg name=\"cipherSessionToken\" type=\"u\" direction=\"in\" />\n"
+    "          <arg name=\"traceId\" type=\"t\" direction=\"in\" />\n"
     "          <arg name=\"result\" type=\"(iiis)\" direction=\"out\" />\n"
     "          <arg name=\"generatedData\" type=\"ay\" direction=\"out\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.Out0\" value=\"Sailfish::Crypto::Result\" />\n"
@@ -278,6 +315,7 @@ class CryptoDBusObject : public QObject, protected QDBusContext
     "          <arg name=\"customParameters\" type=\"a{sv}\" direction=\"in\" />\n"
     "          <arg name=\"cryptosystemProviderName\" type=\"s\" direction=\"in\" />\n"
     "          <arg name=\"cipherSessionToken\" type=\"u\" direction=\"in\" />\n"
+    "          <arg name=\"traceId\" type=\"t\" direction=\"in\" />\n"
     "          <arg name=\"result\" type=\"(iiis)\" direction=\"out\" />\n"
     "          <arg name=\"generatedData\" type=\"ay\" direction=\"out\" />\n"
     "          <arg name=\"verificationStatus\" type=\"(i)\" direction=\"out\" />\n"
@@ -289,6 +327,7 @@ class CryptoDBusObject : public QObject, protected QDBusContext
     "          <arg name=\"lockCodeTarget\" type=\"s\" direction=\"in\" />\n"
     "          <arg name=\"result\" type=\"(iis)\" direction=\"out\" />\n"
     "          <arg name=\"lockStatus\" type=\"(i)\" direction=\"in\" />\n"
+    "          <arg name=\"traceId\" type=\"t\" direction=\"in\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.In0\" value=\"Sailfish::Crypto::LockCodeRequest::LockCodeTargetType\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.Out0\" value=\"Sailfish::Crypto::Result\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.Out1\" value=\"Sailfish::Crypto::LockCodeRequest::LockStatus\" />\n"
@@ -297,6 +336,7 @@ class CryptoDBusObject : public QObject, protected QDBusContext
     "          <arg name=\"lockCodeTargetType\" type=\"(i)\" direction=\"in\" />\n"
     "          <arg name=\"lockCodeTarget\" type=\"s\" direction=\"in\" />\n"
     "          <arg name=\"interactionParameters\" type=\"(sss(i)sss(i)(i))\" direction=\"in\" />\n"
+    "          <arg name=\"traceId\" type=\"t\" direction=\"in\" />\n"
     "          <arg name=\"result\" type=\"(iis)\" direction=\"out\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.In0\" value=\"Sailfish::Crypto::LockCodeRequest::LockCodeTargetType\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.In2\" value=\"Sailfish::Crypto::InteractionParameters\" />\n"
@@ -306,6 +346,7 @@ class CryptoDBusObject : public QObject, protected QDBusContext
     "          <arg name=\"lockCodeTargetType\" type=\"(i)\" direction=\"in\" />\n"
     "          <arg name=\"lockCodeTarget\" type=\"s\" direction=\"in\" />\n"
     "          <arg name=\"interactionParameters\" type=\"(sss(i)sss(i)(i))\" direction=\"in\" />\n"
+    "          <arg name=\"traceId\" type=\"t\" direction=\"in\" />\n"
     "          <arg name=\"result\" type=\"(iis)\" direction=\"out\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.In0\" value=\"Sailfish::Crypto::LockCodeRequest::LockCodeTargetType\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.In2\" value=\"Sailfish::Crypto::InteractionParameters\" />\n"
@@ -315,11 +356,32 @@ class CryptoDBusObject : public QObject, protected QDBusContext
     "          <arg name=\"lockCodeTargetType\" type=\"(i)\" direction=\"in\" />\n"
     "          <arg name=\"lockCodeTarget\" type=\"s\" direction=\"in\" />\n"
     "          <arg name=\"interactionParameters\" type=\"(sss(i)sss(i)(i))\" direction=\"in\" />\n"
+    "          <arg name=\"traceId\" type=\"t\" direction=\"in\" />\n"
     "          <arg name=\"result\" type=\"(iis)\" direction=\"out\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.In0\" value=\"Sailfish::Crypto::LockCodeRequest::LockCodeTargetType\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.In2\" value=\"Sailfish::Crypto::InteractionParameters\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.Out0\" value=\"Sailfish::Crypto::Result\" />\n"
     "      </method>\n"
+    "      <method name=\"openKeySession\">\n"
+    "          <arg name=\"key\" type=\"(ay)\" direction=\"in\" />\n"
+    "          <arg name=\"operations\" type=\"(i)\" direction=\"in\" />\n"
+    "          <arg name=\"customParameters\" type=\"a{sv}\" direction=\"in\" />\n"
+    "          <arg name=\"cryptosystemProviderName\" type=\"s\" direction=\"in\" />\n"
+    "          <arg name=\"traceId\" type=\"t\" direction=\"in\" />\n"
+    "          <arg name=\"result\" type=\"(iiis)\" direction=\"out\" />\n"
+    "          <arg name=\"keySessionToken\" type=\"u\" direction=\"out\" />\n"
+    "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.In0\" value=\"Sailfish::Crypto::Key\" />\n"
+    "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.In1\" value=\"Sailfish::Crypto::CryptoManager::Operations\" />\n"
+    "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.Out0\" value=\"Sailfish::Crypto::Result\" />\n"
+    "      </method>\n"
+    "      <method name=\"closeKeySession\">\n"
+    "          <arg name=\"keySessionToken\" type=\"u\" direction=\"in\" />\n"
+    "          <arg name=\"customParameters\" type=\"a{sv}\" direction=\"in\" />\n"
+    "          <arg name=\"cryptosystemProviderName\" type=\"s\" direction=\"in\" />\n"
+    "          <arg name=\"traceId\" type=\"t\" direction=\"in\" />\n"
+    "          <arg name=\"result\" type=\"(iiis)\" direction=\"out\" />\n"
+    "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.Out0\" value=\"Sailfish::Crypto::Result\" />\n"
+    "      </method>\n"
     "  </interface>\n"
     "")
 
@@ -328,6 +390,7 @@ public:
 
 public Q_SLOTS:
     void getPluginInfo(
+            quint64 traceId,
             const QDBusMessage &message,
             Sailfish::Crypto::Result &result,
             QVector<Sailfish::Crypto::PluginInfo> &cryptoPlugins,
@@ -338,6 +401,7 @@ public Q_SLOTS:
             const QString &csprngEngineName,
             const QVariantMap &customParameters,
             const QString &cryptosystemProviderName,
+            quint64 traceId,
             const QDBusMessage &message,
             Sailfish::Crypto::Result &result,
             QByteArray &randomData);
@@ -348,6 +412,7 @@ public Q_SLOTS:
             const QString &csprngEngineName,
             const QVariantMap &customParameters,
             const QString &cryptosystemProviderName,
+            quint64 traceId,
             const QDBusMessage &message,
             Sailfish::Crypto::Result &result);
 
@@ -357,6 +422,7 @@ public Q_SLOTS:
             int keySize,
             const QVariantMap &customParameters,
             const QString &cryptosystemProviderName,
+            quint64 traceId,
             const QDBusMessage &message,
             Sailfish::Crypto::Result &result,
             QByteArray &generatedIV);
@@ -367,6 +433,7 @@ public Q_SLOTS:
             const Sailfish::Crypto::KeyDerivationParameters &skdfParams,
             const QVariantMap &customParameters,
             const QString &cryptosystemProviderName,
+            quint64 traceId,
             const QDBusMessage &message,
             Sailfish::Crypto::Result &result,
             Sailfish::Crypto::Key &key);
@@ -378,6 +445,7 @@ public Q_SLOTS:
             const Sailfish::Crypto::InteractionParameters &uiParams,
             const QVariantMap &customParameters,
             const QString &cryptosystemProviderName,
+            quint64 traceId,
             const QDBusMessage &message,
             Sailfish::Crypto::Result &result,
             Sailfish::Crypto::Key &key);
@@ -387,6 +455,7 @@ public Q_SLOTS:
             const Sailfish::Crypto::InteractionParameters &uiParams,
             const QVariantMap &customParameters,
             const QString &cryptosystemProviderName,
+            quint64 traceId,
             const QDBusMessage &message,
             Sailfish::Crypto::Result &result,
             Sailfish::Crypto::Key &importedKey);
@@ -397,6 +466,7 @@ public Q_SLOTS:
             const Sailfish::Crypto::InteractionParameters &uiParams,
             const QVariantMap &customParameters,
             const QString &cryptosystemProviderName,
+            quint64 traceId,
             const QDBusMessage &message,
             Sailfish::Crypto::Result &result,
             Sailfish::Crypto::Key &importedKey);
@@ -405,12 +475,14 @@ public Q_SLOTS:
             const Sailfish::Crypto::Key::Identifier &identifier,
             Sailfish::Crypto::Key::Components keyComponents,
             const QVariantMap &customParameters,
+            quint64 traceId,
             const QDBusMessage &message,
             Sailfish::Crypto::Result &result,
             Sailfish::Crypto::Key &key);
 
     void deleteStoredKey(
             const Sailfish::Crypto::Key::Identifier &identifier,
+            quint64 traceId,
             const QDBusMessage &message,
             Sailfish::Crypto::Result &result);
 
@@ -418,6 +490,7 @@ public Q_SLOTS:
             const QString &storagePluginName,
             const QString &collectionName,
             const QVariantMap &customParameters,
+            quint64 traceId,
             const QDBusMessage &message,
             Sailfish::Crypto::Result &result,
             QVector<Sailfish::Crypto::Key::Identifier> &identifiers);
@@ -428,6 +501,7 @@ public Q_SLOTS:
             Sailfish::Crypto::CryptoManager::DigestFunction digestFunction,
             const QVariantMap &customParameters,
             const QString &cryptosystemProviderName,
+            quint64 traceId,
             const QDBusMessage &message,
             Sailfish::Crypto::Result &result,
             QByteArray &digest);
@@ -439,6 +513,7 @@ public Q_SLOTS:
             Sailfish::Crypto::CryptoManager::DigestFunction digestFunction,
             const QVariantMap &customParameters,
             const QString &cryptosystemProviderName,
+            quint64 traceId,
             const QDBusMessage &message,
             Sailfish::Crypto::Result &result,
             QByteArray &signature);
@@ -451,10 +526,24 @@ public Q_SLOTS:
             Sailfish::Crypto::CryptoManager::DigestFunction digestFunction,
             const QVariantMap &customParameters,
             const QString &cryptosystemProviderName,
+            quint64 traceId,
             const QDBusMessage &message,
             Sailfish::Crypto::Result &result,
             Sailfish::Crypto::CryptoManager::VerificationStatus &verificationStatus);
 
+    void batchVerify(
+            const QVector<QByteArray> &signatures,
+            const QVector<QByteArray> &data,
+            const Sailfish::Crypto::Key &key,
+            Sailfish::Crypto::CryptoManager::SignaturePadding padding,
+            Sailfish::Crypto::CryptoManager::DigestFunction digestFunction,
+            const QVariantMap &customParameters,
+            const QString &cryptosystemProviderName,
+            quint64 traceId,
+            const QDBusMessage &message,
+            Sailfish::Crypto::Result &result,
+            QVector<Sailfish::Crypto::CryptoManager::VerificationStatus> &verificationStatuses);
+
     void encrypt(
             const QByteArray &data,
             const QByteArray &iv,
@@ -464,6 +553,7 @@ public Q_SLOTS:
             const QByteArray &authenticationData,
             const QVariantMap &customParameters,
             const QString &cryptosystemProviderName,
+            quint64 traceId,
             const QDBusMessage &message,
             Sailfish::Crypto::Result &result,
             QByteArray &encrypted,
@@ -479,6 +569,7 @@ public Q_SLOTS:
             const QByteArray &authenticationTag,
             const QVariantMap &customParameters,
             const QString &cryptosystemProviderName,
+            quint64 traceId,
             const QDBusMessage &message,
             Sailfish::Crypto::Result &result,
             QByteArray &decrypted,
@@ -494,6 +585,7 @@ public Q_SLOTS:
             Sailfish::Crypto::CryptoManager::DigestFunction digestFunction,
             const QVariantMap &customParameters,
             const QString &cryptosystemProviderName,
+            quint64 traceId,
             const QDBusMessage &message,
             Sailfish::Crypto::Result &result,
             quint32 &cipherSessionToken);
@@ -503,6 +595,7 @@ public Q_SLOTS:
             const QVariantMap &customParameters,
             const QString &cryptosystemProviderName,
             quint32 cipherSessionToken,
+            quint64 traceId,
             const QDBusMessage &message,
             Sailfish::Crypto::Result &result);
 
@@ -511,6 +604,7 @@ public Q_SLOTS:
             const QVariantMap &customParameters,
             const QString &cryptosystemProviderName,
             quint32 cipherSessionToken,
+            quint64 traceId,
             const QDBusMessage &message,
             Sailfish::Crypto::Result &result,
             QByteArray &generatedData);
@@ -520,6 +614,7 @@ public Q_SLOTS:
             const QVariantMap &customParameters,
             const QString &cryptosystemProviderName,
             quint32 cipherSessionToken,
+            quint64 traceId,
             const QDBusMessage &message,
             Sailfish::Crypto::Result &result,
             QByteArray &generatedData,
@@ -528,6 +623,7 @@ public Q_SLOTS:
     void queryLockStatus(
             Sailfish::Crypto::LockCodeRequest::LockCodeTargetType lockCodeTargetType,
             const QString &lockCodeTarget,
+            quint64 traceId,
             const QDBusMessage &message,
             Sailfish::Crypto::Result &result,
             Sailfish::Crypto::LockCodeRequest::LockStatus &lockStatus);
@@ -536,6 +632,7 @@ public Q_SLOTS:
             Sailfish::Crypto::LockCodeRequest::LockCodeTargetType lockCodeTargetType,
             const QString &lockCodeTarget,
             const Sailfish::Crypto::InteractionParameters &interactionParameters,
+            quint64 traceId,
             const QDBusMessage &message,
             Sailfish::Crypto::Result &result);
 
@@ -543,6 +640,7 @@ public Q_SLOTS:
             Sailfish::Crypto::LockCodeRequest::LockCodeTargetType lockCodeTargetType,
             const QString &lockCodeTarget,
             const Sailfish::Crypto::InteractionParameters &interactionParameters,
+            quint64 traceId,
             const QDBusMessage &message,
             Sailfish::Crypto::Result &result);
 
@@ -550,6 +648,25 @@ public Q_SLOTS:
             Sailfish::Crypto::LockCodeRequest::LockCodeTargetType lockCodeTargetType,
             const QString &lockCodeTarget,
             const Sailfish::Crypto::InteractionParameters &interactionParameters,
+            quint64 traceId,
+            const QDBusMessage &message,
+            Sailfish::Crypto::Result &result);
+
+    void openKeySession(
+            const Sailfish::Crypto::Key &key,
+            Sailfish::Crypto::CryptoManager::Operations operations,
+            const QVariantMap &customParameters,
+            const QString &cryptosystemProviderName,
+            quint64 traceId,
+            const QDBusMessage &message,
+            Sailfish::Crypto::Result &result,
+            quint32 &keySessionToken);
+
+    void closeKeySession(
+            quint32 keySessionToken,
+            const QVariantMap &customParameters,
+            const QString &cryptosystemProviderName,
+            quint64 traceId,
             const QDBusMessage &message,
             Sailfish::Crypto::Result &result);
 
@@ -571,12 +688,15 @@ public:
     Sailfish::Secrets::Daemon::Controller *controller();
     QWeakPointer<QThreadPool> cryptoThreadPool();
     QMap<QString, Sailfish::Crypto::CryptoPlugin*> plugins() const;
+    bool releaseIdleThreads();
 
     Sailfish::Crypto::LockCodeRequest::LockStatus queryLockStatusPlugin(const QString &pluginName);
     bool lockPlugin(const QString &pluginName);
     bool unlockPlugin(const QString &pluginName, const QByteArray &lockCode);
     bool setLockCodePlugin(const QString &pluginName, const QByteArray &oldCode, const QByteArray &newCode);
 
+    void handleClientDisconnected(const QString &connectionName);
+
     void handlePendingRequest(Sailfish::Secrets::Daemon::ApiImpl::RequestQueue::RequestData *request, bool *completed) Q_DECL_OVERRIDE;
     void handleFinishedRequest(Sailfish::Secrets::Daemon::ApiImpl::RequestQueue::RequestData *request, bool *completed) Q_DECL_OVERRIDE;
     QString requestTypeToString(int type) const Q_DECL_OVERRIDE;
@@ -612,7 +732,10 @@ enum RequestType {
     QueryLockStatusRequest,
     ModifyLockCodeRequest,
     ProvideLockCodeRequest,
-    ForgetLockCodeRequest
+    ForgetLockCodeRequest,
+    BatchVerifyRequest,
+    OpenKeySessionRequest,
+    CloseKeySessionRequest
 };
 
 } // ApiImpl
@@ -8,11 +8,13 @@
 #include "CryptoImpl/cryptopluginfunctionwrappers_p.h"
 #include "SecretsImpl/metadatadb_p.h"
 #include "logging_p.h"
+#include "plugincallstatistics_p.h"
 #include "util_p.h"
 
 using namespace Sailfish::Crypto;
 using namespace Sailfish::Crypto::Daemon::ApiImpl;
 using namespace Sailfish::Secrets::Daemon::Util;
+using Sailfish::Secrets::Daemon::ApiImpl::PluginCallScope;
 
 namespace {
     Sailfish::Secrets::Result unlockCollection(CryptoStoragePluginWrapper *w,
@@ -54,20 +56,23 @@ namespace {
 bool CryptoPluginFunctionWrapper::isLocked(
         CryptoPlugin *plugin)
 {
+    PluginCallScope scope(plugin, "isLocked");
     return plugin->isLocked();
 }
 
 bool CryptoPluginFunctionWrapper::lock(
         CryptoPlugin *plugin)
 {
-    return plugin->lock();
+    PluginCallScope scope(plugin, "lock");
+    return scope.result(plugin->lock());
 }
 
 bool CryptoPluginFunctionWrapper::unlock(
         CryptoPlugin *plugin,
         const QByteArray &lockCode)
 {
-    return plugin->unlock(lockCode);
+    PluginCallScope scope(plugin, "unlock");
+    return scope.result(plugin->unlock(lockCode));
 }
 
 bool CryptoPluginFunctionWrapper::setLockCode(
@@ -75,7 +80,8 @@ bool CryptoPluginFunctionWrapper::setLockCode(
         const QByteArray &oldLockCode,
         const QByteArray &newLockCode)
 {
-    return plugin->setLockCode(oldLockCode, newLockCode);
+    PluginCallScope scope(plugin, "setLockCode");
+    return scope.result(plugin->setLockCode(oldLockCode, newLockCode));
 }
 
 DataResult CryptoPluginFunctionWrapper::generateRandomData(
@@ -84,6 +90,7 @@ DataResult CryptoPluginFunctionWrapper::generateRandomData(
         const QString &csprngEngineName,
         quint64 numberBytes)
 {
+    PluginCallScope scope(pluginAndCustomParams.plugin, "generateRandomData");
     QByteArray randomData;
     Result result = pluginAndCustomParams.plugin->generateRandomData(
                 callerIdent,
@@ -91,7 +98,8 @@ DataResult CryptoPluginFunctionWrapper::generateRandomData(
                 numberBytes,
                 pluginAndCustomParams.customParameters,
                 &randomData);
-    return DataResult(result, randomData);
+    scope.setBytesOut(randomData.size());
+    return scope.result(DataResult(result, randomData));
 }
 
 Result CryptoPluginFunctionWrapper::seedRandomDataGenerator(
@@ -101,12 +109,13 @@ Result CryptoPluginFunctionWrapper::seedRandomDataGenerator(
         const QByteArray &seedData,
         double entropyEstimate)
 {
-    return pluginAndCustomParams.plugin->seedRandomDataGenerator(
+    PluginCallScope scope(pluginAndCustomParams.plugin, "seedRandomDataGenerator", seedData.size());
+    return scope.result(pluginAndCustomParams.plugin->seedRandomDataGenerator(
                 callerIdent,
                 csprngEngineName,
                 seedData,
                 entropyEstimate,
-                pluginAndCustomParams.customParameters);
+                pluginAndCustomParams.customParameters));
 }
 
 DataResult CryptoPluginFunctionWrapper::generateInitializationVector(
@@ -115,12 +124,13 @@ DataResult CryptoPluginFunctionWrapper::generateInitializationVector(
         CryptoManager::BlockMode blockMode,
         int keySize)
 {
+    PluginCallScope scope(pluginAndCustomParams.plugin, "generateInitializationVector");
     QByteArray iv;
     Result result = pluginAndCustomParams.plugin->generateInitializationVector(
                 algorithm, blockMode, keySize,
                 pluginAndCustomParams.customParameters,
                 &iv);
-    return DataResult(result, iv);
+    return scope.result(DataResult(result, iv));
 }
 
 KeyResult CryptoPluginFunctionWrapper::importKey(
@@ -128,12 +138,13 @@ KeyResult CryptoPluginFunctionWrapper::importKey(
         const QByteArray &keyData,
         const QByteArray &passphrase)
 {
+    PluginCallScope scope(pluginAndCustomParams.plugin, "importKey", keyData.size());
     Key key;
     Result result = pluginAndCustomParams.plugin->importKey(
                 keyData, passphrase,
                 pluginAndCustomParams.customParameters,
                 &key);
-    return KeyResult(result, key);
+    return scope.result(KeyResult(result, key));
 }
 
 KeyResult CryptoPluginFunctionWrapper::importAndStoreKey(
@@ -143,12 +154,13 @@ KeyResult CryptoPluginFunctionWrapper::importAndStoreKey(
         const QByteArray &passphrase,
         const QByteArray &collectionDecryptionKey)
 {
+    PluginCallScope scope(pluginAndCustomParams.plugin, "importAndStoreKey", keyData.size());
     Sailfish::Secrets::Daemon::ApiImpl::CollectionMetadata collectionMetadata;
     Sailfish::Secrets::Result sresult = pluginAndCustomParams.wrapper->collectionMetadata(
                 keyTemplate.identifier().collectionName(),
                 &collectionMetadata);
     if (sresult.code() != Sailfish::Secrets::Result::Succeeded) {
-        return KeyResult(transformSecretsResult(sresult), keyTemplate);
+        return scope.result(KeyResult(transformSecretsResult(sresult), keyTemplate));
     }
 
     Sailfish::Secrets::Daemon::ApiImpl::SecretMetadata metadata;
@@ -172,7 +184,7 @@ KeyResult CryptoPluginFunctionWrapper::importAndStoreKey(
                 pluginAndCustomParams.customParameters,
                 collectionDecryptionKey,
                 &keyReference);
-    return KeyResult(result, keyReference);
+    return scope.result(KeyResult(result, keyReference));
 }
 
 KeyResult CryptoPluginFunctionWrapper::generateKey(
@@ -181,12 +193,13 @@ KeyResult CryptoPluginFunctionWrapper::generateKey(
         const KeyPairGenerationParameters &kpgParams,
         const KeyDerivationParameters &skdfParams)
 {
+    PluginCallScope scope(pluginAndCustomParams.plugin, "generateKey");
     Key key(keyTemplate);
     Result result = pluginAndCustomParams.plugin->generateKey(
                 keyTemplate, kpgParams, skdfParams,
                 pluginAndCustomParams.customParameters,
                 &key);
-    return KeyResult(result, key);
+    return scope.result(KeyResult(result, key));
 }
 
 KeyResult CryptoPluginFunctionWrapper::storedKey(
@@ -195,11 +208,12 @@ KeyResult CryptoPluginFunctionWrapper::storedKey(
         Key::Components keyComponents,
         const QVariantMap &customParameters)
 {
+    PluginCallScope scope(plugin, "storedKey");
     Key key;
     key.setIdentifier(identifier);
     Result result = plugin->storedKey(
                 identifier, keyComponents, customParameters, &key);
-    return KeyResult(result, key);
+    return scope.result(KeyResult(result, key));
 }
 
 IdentifiersResult CryptoPluginFunctionWrapper::storedKeyIdentifiers(
@@ -207,9 +221,10 @@ IdentifiersResult CryptoPluginFunctionWrapper::storedKeyIdentifiers(
         const QString &collectionName,
         const QVariantMap &customParameters)
 {
+    PluginCallScope scope(plugin, "storedKeyIdentifiers");
     QVector<Key::Identifier> identifiers;
     Result result = plugin->storedKeyIdentifiers(collectionName, customParameters, &identifiers);
-    return IdentifiersResult(result, identifiers);
+    return scope.result(IdentifiersResult(result, identifiers));
 }
 
 DataResult CryptoPluginFunctionWrapper::calculateDigest(
@@ -217,6 +232,7 @@ DataResult CryptoPluginFunctionWrapper::calculateDigest(
         const QByteArray &data,
         const SignatureOptions &options)
 {
+    PluginCallScope scope(pluginAndCustomParams.plugin, "calculateDigest", data.size());
     QByteArray digest;
     Result result = pluginAndCustomParams.plugin->calculateDigest(
                 data,
@@ -224,7 +240,8 @@ DataResult CryptoPluginFunctionWrapper::calculateDigest(
                 options.digestFunction,
                 pluginAndCustomParams.customParameters,
                 &digest);
-    return DataResult(result, digest);
+    scope.setBytesOut(digest.size());
+    return scope.result(DataResult(result, digest));
 }
 
 DataResult CryptoPluginFunctionWrapper::sign(
@@ -233,6 +250,7 @@ DataResult CryptoPluginFunctionWrapper::sign(
         const KeyAndCollectionKey &keyAndCollectionKey,
         const SignatureOptions &options)
 {
+    PluginCallScope scope(pluginAndCustomParams.plugin, "sign", data.size());
     QByteArray signature;
     Result result(Result::Succeeded);
 
@@ -280,7 +298,8 @@ DataResult CryptoPluginFunctionWrapper::sign(
                         QLatin1String("Internal error: wrapper and plugin null"));
     }
 
-    return DataResult(result, signature);
+    scope.setBytesOut(signature.size());
+    return scope.result(DataResult(result, signature));
 }
 
 ValidatedResult CryptoPluginFunctionWrapper::verify(
@@ -290,6 +309,7 @@ ValidatedResult CryptoPluginFunctionWrapper::verify(
         const KeyAndCollectionKey &keyAndCollectionKey,
         const SignatureOptions &options)
 {
+    PluginCallScope scope(pluginAndCustomParams.plugin, "verify", data.size());
     Sailfish::Crypto::CryptoManager::VerificationStatus verificationStatus = Sailfish::Crypto::CryptoManager::VerificationStatusUnknown;
     Result result(Result::Succeeded);
 
@@ -339,7 +359,78 @@ ValidatedResult CryptoPluginFunctionWrapper::verify(
                         QLatin1String("Internal error: wrapper and plugin null"));
     }
 
-    return ValidatedResult(result, verificationStatus);
+    return scope.result(ValidatedResult(result, verificationStatus));
+}
+
+ValidatedResults CryptoPluginFunctionWrapper::batchVerify(
+        const PluginWrapperAndCustomParams &pluginAndCustomParams,
+        const QVector<QByteArray> &signatures,
+        const QVector<QByteArray> &data,
+        const KeyAndCollectionKey &keyAndCollectionKey,
+        const SignatureOptions &options)
+{
+    qint64 bytesIn = 0;
+    for (const QByteArray &d : data) {
+        bytesIn += d.size();
+    }
+    PluginCallScope scope(pluginAndCustomParams.plugin, "batchVerify", bytesIn);
+    QVector<Sailfish::Crypto::CryptoManager::VerificationStatus> verificationStatuses;
+    Result result(Result::Succeeded);
+
+    if (CryptoStoragePluginWrapper *w = pluginAndCustomParams.wrapper) {
+        const QString collectionName = keyAndCollectionKey.key.identifier().collectionName();
+        const QByteArray collectionKey = keyAndCollectionKey.collectionKey;
+        bool wasLocked = false;
+
+        // check to see if we need to unlock the collection in order to access the key.
+        // we don't need to do this if the given key has the appropriate components already.
+        if (keyAndCollectionKey.key.publicKey().isEmpty()
+                && keyAndCollectionKey.key.privateKey().isEmpty()
+                && keyAndCollectionKey.key.secretKey().isEmpty()) {
+            Sailfish::Secrets::Result lockedResult = unlockCollection(
+                        w, collectionName, collectionKey, &wasLocked);
+
+            if (lockedResult.code() == Sailfish::Secrets::Result::Failed) {
+                result = transformSecretsResult(lockedResult);
+            }
+        }
+
+        // the collection stays unlocked for the whole batch.
+        if (result.code() == Result::Succeeded) {
+            result = w->cryptoPlugin()->batchVerify(
+                        signatures, data, keyAndCollectionKey.key,
+                        options.signaturePadding,
+                        options.digestFunction,
+                        pluginAndCustomParams.customParameters,
+                        &verificationStatuses);
+        }
+
+        if (wasLocked) {
+            // relock.
+            Sailfish::Secrets::Result r = w->setEncryptionKey(
+                        collectionName,
+                        QByteArray());
+            Q_UNUSED(r);
+        }
+    } else if (pluginAndCustomParams.plugin) {
+        result = pluginAndCustomParams.plugin->batchVerify(
+                signatures, data, keyAndCollectionKey.key,
+                options.signaturePadding,
+                options.digestFunction,
+                pluginAndCustomParams.customParameters,
+                &verificationStatuses);
+    } else {
+        result = Result(Result::InvalidCryptographicServiceProvider,
+                        QLatin1String("Internal error: wrapper and plugin null"));
+    }
+
+    if (result.code() == Result::Succeeded && verificationStatuses.size() != signatures.size()) {
+        result = Result(Result::CryptoPluginVerificationError,
+                        QLatin1String("Plugin returned an invalid number of verification statuses"));
+        verificationStatuses.clear();
+    }
+
+    return scope.result(ValidatedResults(result, verificationStatuses));
 }
 
 TagDataResult CryptoPluginFunctionWrapper::encrypt(
@@ -349,6 +440,7 @@ TagDataResult CryptoPluginFunctionWrapper::encrypt(
         const EncryptionOptions &options,
         const QByteArray &authenticationData)
 {
+    PluginCallScope scope(pluginAndCustomParams.plugin, "encrypt", data.size());
     QByteArray ciphertext;
     QByteArray authenticationTag;
     Result result(Result::Succeeded);
@@ -405,7 +497,8 @@ TagDataResult CryptoPluginFunctionWrapper::encrypt(
                         QLatin1String("Internal error: wrapper and plugin null"));
     }
 
-    return TagDataResult(result, ciphertext, authenticationTag);
+    scope.setBytesOut(ciphertext.size());
+    return scope.result(TagDataResult(result, ciphertext, authenticationTag));
 }
 
 VerifiedDataResult CryptoPluginFunctionWrapper::decrypt(
@@ -415,6 +508,7 @@ VerifiedDataResult CryptoPluginFunctionWrapper::decrypt(
         const EncryptionOptions &options,
         const AuthDataAndTag &authDataAndTag)
 {
+    PluginCallScope scope(pluginAndCustomParams.plugin, "decrypt", data.size());
     QByteArray plaintext;
     Sailfish::Crypto::CryptoManager::VerificationStatus verificationStatus = Sailfish::Crypto::CryptoManager::VerificationStatusUnknown;
     Result result(Result::Succeeded);
@@ -471,7 +565,8 @@ VerifiedDataResult CryptoPluginFunctionWrapper::decrypt(
                         QLatin1String("Internal error: wrapper and plugin null"));
     }
 
-    return VerifiedDataResult(result, plaintext, verificationStatus);
+    scope.setBytesOut(plaintext.size());
+    return scope.result(VerifiedDataResult(result, plaintext, verificationStatus));
 }
 
 CipherSessionTokenResult CryptoPluginFunctionWrapper::initializeCipherSession(
@@ -481,6 +576,7 @@ CipherSessionTokenResult CryptoPluginFunctionWrapper::initializeCipherSession(
         const KeyAndCollectionKey &keyAndCollectionKey,
         const CipherSessionOptions &options)
 {
+    PluginCallScope scope(pluginAndCustomParams.plugin, "initializeCipherSession");
     quint32 cipherSessionToken = 0;
     Result result(Result::Succeeded);
 
@@ -545,7 +641,7 @@ CipherSessionTokenResult CryptoPluginFunctionWrapper::initializeCipherSession(
                         QLatin1String("Internal error: wrapper and plugin null"));
     }
 
-    return CipherSessionTokenResult(result, cipherSessionToken);
+    return scope.result(CipherSessionTokenResult(result, cipherSessionToken));
 }
 
 Result CryptoPluginFunctionWrapper::updateCipherSessionAuthentication(
@@ -554,10 +650,11 @@ Result CryptoPluginFunctionWrapper::updateCipherSessionAuthentication(
         const QByteArray &authenticationData,
         quint32 cipherSessionToken)
 {
-    return pluginAndCustomParams.plugin->updateCipherSessionAuthentication(
+    PluginCallScope scope(pluginAndCustomParams.plugin, "updateCipherSessionAuthentication", authenticationData.size());
+    return scope.result(pluginAndCustomParams.plugin->updateCipherSessionAuthentication(
                 clientId, authenticationData,
                 pluginAndCustomParams.customParameters,
-                cipherSessionToken);
+                cipherSessionToken));
 }
 
 DataResult CryptoPluginFunctionWrapper::updateCipherSession(
@@ -566,13 +663,15 @@ DataResult CryptoPluginFunctionWrapper::updateCipherSession(
         const QByteArray &data,
         quint32 cipherSessionToken)
 {
+    PluginCallScope scope(pluginAndCustomParams.plugin, "updateCipherSession", data.size());
     QByteArray generatedData;
     Result result = pluginAndCustomParams.plugin->updateCipherSession(
                 clientId, data,
                 pluginAndCustomParams.customParameters,
                 cipherSessionToken,
                 &generatedData);
-    return DataResult(result, generatedData);
+    scope.setBytesOut(generatedData.size());
+    return scope.result(DataResult(result, generatedData));
 }
 
 VerifiedDataResult CryptoPluginFunctionWrapper::finalizeCipherSession(
@@ -581,6 +680,7 @@ VerifiedDataResult CryptoPluginFunctionWrapper::finalizeCipherSession(
         const QByteArray &data,
         quint32 cipherSessionToken)
 {
+    PluginCallScope scope(pluginAndCustomParams.plugin, "finalizeCipherSession", data.size());
     Sailfish::Crypto::CryptoManager::VerificationStatus verificationStatus = Sailfish::Crypto::CryptoManager::VerificationStatusUnknown;
     QByteArray generatedData;
     Result result = pluginAndCustomParams.plugin->finalizeCipherSession(
@@ -588,7 +688,8 @@ VerifiedDataResult CryptoPluginFunctionWrapper::finalizeCipherSession(
                 pluginAndCustomParams.customParameters,
                 cipherSessionToken,
                 &generatedData, &verificationStatus);
-    return VerifiedDataResult(result, generatedData, verificationStatus);
+    scope.setBytesOut(generatedData.size());
+    return scope.result(VerifiedDataResult(result, generatedData, verificationStatus));
 }
 
 KeyResult CryptoPluginFunctionWrapper::generateAndStoreKey(
@@ -598,12 +699,13 @@ KeyResult CryptoPluginFunctionWrapper::generateAndStoreKey(
         const Sailfish::Crypto::KeyDerivationParameters &skdfParams,
         const QByteArray &collectionUnlockCode)
 {
+    PluginCallScope scope(pluginAndCustomParams.plugin, "generateAndStoreKey");
     Sailfish::Secrets::Daemon::ApiImpl::CollectionMetadata collectionMetadata;
     Sailfish::Secrets::Result sresult = pluginAndCustomParams.wrapper->collectionMetadata(
                 keyTemplate.identifier().collectionName(),
                 &collectionMetadata);
     if (sresult.code() != Sailfish::Secrets::Result::Succeeded) {
-        return KeyResult(transformSecretsResult(sresult), keyTemplate);
+        return scope.result(KeyResult(transformSecretsResult(sresult), keyTemplate));
     }
 
     Sailfish::Secrets::Daemon::ApiImpl::SecretMetadata metadata;
@@ -627,5 +729,5 @@ KeyResult CryptoPluginFunctionWrapper::generateAndStoreKey(
                 pluginAndCustomParams.customParameters,
                 collectionUnlockCode,
                 &keyReference);
-    return KeyResult(result, keyReference);
+    return scope.result(KeyResult(result, keyReference));
 }
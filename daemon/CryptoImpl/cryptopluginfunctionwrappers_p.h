@@ -67,6 +67,16 @@ struct ValidatedResult {
     Sailfish::Crypto::CryptoManager::VerificationStatus verificationStatus;
 };
 
+struct ValidatedResults {
+    ValidatedResults(const Sailfish::Crypto::Result &r = Sailfish::Crypto::Result(),
+                     const QVector<Sailfish::Crypto::CryptoManager::VerificationStatus> &v = QVector<Sailfish::Crypto::CryptoManager::VerificationStatus>())
+        : result(r), verificationStatuses(v) {}
+    ValidatedResults(const ValidatedResults &other)
+        : result(other.result), verificationStatuses(other.verificationStatuses) {}
+    Sailfish::Crypto::Result result;
+    QVector<Sailfish::Crypto::CryptoManager::VerificationStatus> verificationStatuses;
+};
+
 struct KeyResult {
     KeyResult(const Sailfish::Crypto::Result &r = Sailfish::Crypto::Result(),
               const Sailfish::Crypto::Key &k = Sailfish::Crypto::Key())
@@ -278,6 +288,13 @@ ValidatedResult verify(
         const KeyAndCollectionKey &keyAndCollectionKey,
         const SignatureOptions &options);
 
+ValidatedResults batchVerify(
+        const PluginWrapperAndCustomParams &pluginAndCustomParams,
+        const QVector<QByteArray> &signatures,
+        const QVector<QByteArray> &data,
+        const KeyAndCollectionKey &keyAndCollectionKey,
+        const SignatureOptions &options);
+
 TagDataResult encrypt(
         const PluginWrapperAndCustomParams &pluginAndCustomParams,
         const DataAndIV &dataAndIv,
@@ -14,6 +14,7 @@
 #include "Secrets/lockcoderequest.h"
 
 #include "Crypto/plugininfo.h"
+#include "Crypto/keysessionrequest.h"
 
 #include "util_p.h"
 #include "logging_p.h"
@@ -23,6 +24,7 @@
 #include "cryptopluginwrapper_p.h"
 
 #include <QtCore/QDir>
+#include <QtCore/QFile>
 #include <QtCore/QPluginLoader>
 #include <QtCore/QObject>
 #include <QtCore/QCoreApplication>
@@ -32,6 +34,13 @@
 #include <QtConcurrent>
 
 namespace {
+    // Clients may not claim the key derivation limits of the daemon's own requests.
+    QVariantMap clientCustomParameters(const QVariantMap &customParameters) {
+        QVariantMap parameters(customParameters);
+        parameters.remove(QLatin1String(Sailfish_Crypto_CryptoPlugin_DaemonRequestParameter));
+        return parameters;
+    }
+
     void nullifyKeyFields(Sailfish::Crypto::Key *key, Sailfish::Crypto::Key::Components keep) {
         // This method is called for keys stored in generic secrets storage plugins.
         // Null-out fields if the client hasn't specified that they be kept,
@@ -103,6 +112,10 @@ Daemon::ApiImpl::RequestProcessor::RequestProcessor(
             this, &Daemon::ApiImpl::RequestProcessor::secretsCryptoPluginLockStatusRequestCompleted);
     connect(m_secrets, &Sailfish::Secrets::Daemon::ApiImpl::SecretsRequestQueue::cryptoPluginLockCodeRequestCompleted,
             this, &Daemon::ApiImpl::RequestProcessor::secretsCryptoPluginLockCodeRequestCompleted);
+    connect(m_secrets, &Sailfish::Secrets::Daemon::ApiImpl::SecretsRequestQueue::collectionRemoved,
+            this, &Daemon::ApiImpl::RequestProcessor::secretsCollectionRemoved);
+    connect(m_secrets, &Sailfish::Secrets::Daemon::ApiImpl::SecretsRequestQueue::collectionLocked,
+            this, &Daemon::ApiImpl::RequestProcessor::secretsCollectionLocked);
 }
 
 QMap<QString, CryptoPlugin*>
@@ -132,6 +145,9 @@ LockCodeRequest::LockStatus Daemon::ApiImpl::RequestProcessor::queryLockStatusPl
 bool Daemon::ApiImpl::RequestProcessor::lockPlugin(
         const QString &pluginName)
 {
+    // the key sessions must not outlive the unlocked state in which they were opened.
+    closeKeySessionsOfPlugin(pluginName);
+
     if (m_cryptoPlugins.contains(pluginName)) {
         return false;
     }
@@ -240,7 +256,8 @@ Daemon::ApiImpl::RequestProcessor::generateRandomData(
     }
 
     QFutureWatcher<DataResult> *watcher = new QFutureWatcher<DataResult>(this);
-    QFuture<DataResult> future = QtConcurrent::run(
+    QFuture<DataResult> future = Sailfish::Secrets::Daemon::ApiImpl::tracedRun(
+                requestId,
                 m_requestQueue->controller()->threadPoolForPlugin(cryptosystemProviderName).data(),
                 CryptoPluginFunctionWrapper::generateRandomData,
                 PluginAndCustomParams(m_cryptoPlugins[cryptosystemProviderName], customParameters),
@@ -280,7 +297,8 @@ Daemon::ApiImpl::RequestProcessor::seedRandomDataGenerator(
     }
 
     QFutureWatcher<Result> *watcher = new QFutureWatcher<Result>(this);
-    QFuture<Result> future = QtConcurrent::run(
+    QFuture<Result> future = Sailfish::Secrets::Daemon::ApiImpl::tracedRun(
+                requestId,
                 m_requestQueue->controller()->threadPoolForPlugin(cryptosystemProviderName).data(),
                 CryptoPluginFunctionWrapper::seedRandomDataGenerator,
                 PluginAndCustomParams(m_cryptoPlugins[cryptosystemProviderName], customParameters),
@@ -321,7 +339,8 @@ Daemon::ApiImpl::RequestProcessor::generateInitializationVector(
     }
 
     QFutureWatcher<DataResult> *watcher = new QFutureWatcher<DataResult>(this);
-    QFuture<DataResult> future = QtConcurrent::run(
+    QFuture<DataResult> future = Sailfish::Secrets::Daemon::ApiImpl::tracedRun(
+                requestId,
                 m_requestQueue->controller()->threadPoolForPlugin(cryptosystemProviderName).data(),
                 CryptoPluginFunctionWrapper::generateInitializationVector,
                 PluginAndCustomParams(m_cryptoPlugins[cryptosystemProviderName], customParameters),
@@ -372,10 +391,12 @@ Daemon::ApiImpl::RequestProcessor::generateKey(
     // will be fully specified with input key data.
 
     QFutureWatcher<KeyResult> *watcher = new QFutureWatcher<KeyResult>(this);
-    QFuture<KeyResult> future = QtConcurrent::run(
+    QFuture<KeyResult> future = Sailfish::Secrets::Daemon::ApiImpl::tracedRun(
+                requestId,
                 m_requestQueue->controller()->threadPoolForPlugin(cryptosystemProviderName).data(),
                 CryptoPluginFunctionWrapper::generateKey,
-                PluginAndCustomParams(m_cryptoPlugins[cryptosystemProviderName], customParameters),
+                PluginAndCustomParams(m_cryptoPlugins[cryptosystemProviderName],
+                                      clientCustomParameters(customParameters)),
                 keyTemplate,
                 kpgParams,
                 skdfParams);
@@ -454,7 +475,7 @@ Daemon::ApiImpl::RequestProcessor::generateStoredKey(
                                                     << QVariant::fromValue<KeyPairGenerationParameters>(kpgParams)
                                                     << QVariant::fromValue<KeyDerivationParameters>(skdfParams)
                                                     << QVariant::fromValue<InteractionParameters>(uiParams)
-                                                    << QVariant::fromValue<QVariantMap>(customParameters)
+                                                    << QVariant::fromValue<QVariantMap>(clientCustomParameters(customParameters))
                                                     << QVariant::fromValue<QString>(cryptosystemProviderName)));
     }
     return Result(Result::Pending);
@@ -607,7 +628,8 @@ Daemon::ApiImpl::RequestProcessor::generateStoredKey_withKdfData(
     } else {
         // generate the key, then store it separately in the storage plugin
         QFutureWatcher<KeyResult> *watcher = new QFutureWatcher<KeyResult>(this);
-        QFuture<KeyResult> future = QtConcurrent::run(
+        QFuture<KeyResult> future = Sailfish::Secrets::Daemon::ApiImpl::tracedRun(
+                    requestId,
                     m_requestQueue->controller()->threadPoolForPlugin(cryptosystemProviderName).data(),
                     CryptoPluginFunctionWrapper::generateKey,
                     PluginAndCustomParams(m_cryptoPlugins[cryptosystemProviderName], customParameters),
@@ -687,7 +709,8 @@ Daemon::ApiImpl::RequestProcessor::generateStoredKey_inCryptoPlugin(
 
     Sailfish::Crypto::Daemon::ApiImpl::CryptoStoragePluginWrapper *wrapper(m_secrets->cryptoStoragePluginWrapper(cryptosystemProviderName));
     QFutureWatcher<KeyResult> *watcher = new QFutureWatcher<KeyResult>(this);
-    QFuture<KeyResult> future = QtConcurrent::run(
+    QFuture<KeyResult> future = Sailfish::Secrets::Daemon::ApiImpl::tracedRun(
+                requestId,
                 m_requestQueue->controller()->threadPoolForPlugin(cryptosystemProviderName).data(),
                 CryptoPluginFunctionWrapper::generateAndStoreKey,
                 PluginWrapperAndCustomParams(wrapper->cryptoPlugin(), wrapper, customParameters),
@@ -774,7 +797,8 @@ Daemon::ApiImpl::RequestProcessor::importKey(
     }
 
     QFutureWatcher<KeyResult> *watcher = new QFutureWatcher<KeyResult>(this);
-    QFuture<KeyResult> future = QtConcurrent::run(
+    QFuture<KeyResult> future = Sailfish::Secrets::Daemon::ApiImpl::tracedRun(
+                requestId,
                 m_requestQueue->controller()->threadPoolForPlugin(cryptosystemProviderName).data(),
                 CryptoPluginFunctionWrapper::importKey,
                 PluginAndCustomParams(m_cryptoPlugins.value(cryptosystemProviderName),
@@ -967,7 +991,8 @@ Daemon::ApiImpl::RequestProcessor::importStoredKey_withPassphrase(
     if (cryptosystemProviderName == keyTemplate.identifier().storagePluginName()) {
         Sailfish::Crypto::Daemon::ApiImpl::CryptoStoragePluginWrapper *wrapper(m_secrets->cryptoStoragePluginWrapper(cryptosystemProviderName));
         QFutureWatcher<KeyResult> *watcher = new QFutureWatcher<KeyResult>(this);
-        QFuture<KeyResult> future = QtConcurrent::run(
+        QFuture<KeyResult> future = Sailfish::Secrets::Daemon::ApiImpl::tracedRun(
+                    requestId,
                     m_requestQueue->controller()->threadPoolForPlugin(cryptosystemProviderName).data(),
                     CryptoPluginFunctionWrapper::importAndStoreKey,
                     PluginWrapperAndCustomParams(wrapper->cryptoPlugin(),
@@ -1010,7 +1035,8 @@ Daemon::ApiImpl::RequestProcessor::importStoredKey_withPassphrase(
         watcher->setFuture(future);
     } else {
         QFutureWatcher<KeyResult> *watcher = new QFutureWatcher<KeyResult>(this);
-        QFuture<KeyResult> future = QtConcurrent::run(
+        QFuture<KeyResult> future = Sailfish::Secrets::Daemon::ApiImpl::tracedRun(
+                    requestId,
                     m_requestQueue->controller()->threadPoolForPlugin(cryptosystemProviderName).data(),
                     CryptoPluginFunctionWrapper::importKey,
                     PluginAndCustomParams(m_cryptoPlugins.value(cryptosystemProviderName),
@@ -1108,7 +1134,8 @@ Daemon::ApiImpl::RequestProcessor::storedKey(
 
     if (m_cryptoPlugins.contains(identifier.storagePluginName())) {
         QFutureWatcher<KeyResult> *watcher = new QFutureWatcher<KeyResult>(this);
-        QFuture<KeyResult> future = QtConcurrent::run(
+        QFuture<KeyResult> future = Sailfish::Secrets::Daemon::ApiImpl::tracedRun(
+                    requestId,
                     m_requestQueue->controller()->threadPoolForPlugin(identifier.storagePluginName()).data(),
                     CryptoPluginFunctionWrapper::storedKey,
                     m_cryptoPlugins[identifier.storagePluginName()],
@@ -1179,7 +1206,9 @@ Daemon::ApiImpl::RequestProcessor::deleteStoredKey(
 {
     // delete from secrets storage
     Result retn = transformSecretsResult(m_secrets->deleteStoredKey(callerPid, requestId, identifier));
-    if (retn.code() == Result::Pending) {
+    if (retn.code() == Result::Succeeded) {
+        closeKeySessionsOfKey(identifier);
+    } else if (retn.code() == Result::Pending) {
         // asynchronous flow, will call back to deleteStoredKey2().
         m_pendingRequests.insert(requestId,
                                  Daemon::ApiImpl::RequestProcessor::PendingRequest(
@@ -1199,7 +1228,9 @@ void Daemon::ApiImpl::RequestProcessor::deleteStoredKey2(
         const Key::Identifier &identifier)
 {
     Q_UNUSED(callerPid);
-    Q_UNUSED(identifier);
+    if (result.code() == Result::Succeeded) {
+        closeKeySessionsOfKey(identifier);
+    }
     QList<QVariant> outParams;
     outParams << QVariant::fromValue<Result>(result);
     m_requestQueue->requestFinished(requestId, outParams);
@@ -1267,7 +1298,8 @@ Daemon::ApiImpl::RequestProcessor::calculateDigest(
     }
 
     QFutureWatcher<DataResult> *watcher = new QFutureWatcher<DataResult>(this);
-    QFuture<DataResult> future = QtConcurrent::run(
+    QFuture<DataResult> future = Sailfish::Secrets::Daemon::ApiImpl::tracedRun(
+                requestId,
                 m_requestQueue->controller()->threadPoolForPlugin(cryptosystemProviderName).data(),
                 CryptoPluginFunctionWrapper::calculateDigest,
                 PluginAndCustomParams(cryptoPlugin, customParameters),
@@ -1308,6 +1340,24 @@ Daemon::ApiImpl::RequestProcessor::sign(
                       QLatin1String("No such cryptographic service provider plugin exists"));
     }
 
+    QVariantMap pluginParameters(customParameters);
+    KeySession keySession;
+    Result sessionResult = keySessionForRequest(callerPid, requestId, key, CryptoManager::OperationSign,
+                                                cryptosystemProviderName, &pluginParameters, &keySession);
+    if (sessionResult.code() != Result::Succeeded) {
+        return sessionResult;
+    } else if (keySession.isValid()) {
+        // the key was resolved when the key session was opened.
+        if (keySession.storedInCryptoPlugin()) {
+            sign_withCollectionKey(requestId, data, keySession.keyReference(), padding, digestFunction,
+                                   pluginParameters, cryptosystemProviderName, sessionResult, keySession.collectionKey);
+        } else {
+            sign_withKey(requestId, sessionResult, keySession.serializedKey, data, padding, digestFunction,
+                         pluginParameters, cryptosystemProviderName);
+        }
+        return Result(Result::Pending);
+    }
+
     Key fullKey;
     if (key.privateKey().isEmpty() && key.secretKey().isEmpty()) {
         // the key is a key reference, we may need to read the full key from storage.
@@ -1384,7 +1434,8 @@ Daemon::ApiImpl::RequestProcessor::sign(
 
     Sailfish::Crypto::Daemon::ApiImpl::CryptoStoragePluginWrapper *wrapper(m_secrets->cryptoStoragePluginWrapper(cryptosystemProviderName));
     QFutureWatcher<DataResult> *watcher = new QFutureWatcher<DataResult>(this);
-    QFuture<DataResult> future = QtConcurrent::run(
+    QFuture<DataResult> future = Sailfish::Secrets::Daemon::ApiImpl::tracedRun(
+                requestId,
                 m_requestQueue->controller()->threadPoolForPlugin(cryptosystemProviderName).data(),
                 CryptoPluginFunctionWrapper::sign,
                 PluginWrapperAndCustomParams(cryptoPlugin, wrapper, customParameters),
@@ -1426,7 +1477,8 @@ Daemon::ApiImpl::RequestProcessor::sign_withKey(
 
     Sailfish::Crypto::Daemon::ApiImpl::CryptoStoragePluginWrapper *wrapper(m_secrets->cryptoStoragePluginWrapper(cryptoPluginName));
     QFutureWatcher<DataResult> *watcher = new QFutureWatcher<DataResult>(this);
-    QFuture<DataResult> future = QtConcurrent::run(
+    QFuture<DataResult> future = Sailfish::Secrets::Daemon::ApiImpl::tracedRun(
+                requestId,
                 m_requestQueue->controller()->threadPoolForPlugin(cryptoPluginName).data(),
                 CryptoPluginFunctionWrapper::sign,
                 PluginWrapperAndCustomParams(m_cryptoPlugins[cryptoPluginName], wrapper, customParameters),
@@ -1467,7 +1519,8 @@ Daemon::ApiImpl::RequestProcessor::sign_withCollectionKey(
 
     Sailfish::Crypto::Daemon::ApiImpl::CryptoStoragePluginWrapper *wrapper(m_secrets->cryptoStoragePluginWrapper(cryptoPluginName));
     QFutureWatcher<DataResult> *watcher = new QFutureWatcher<DataResult>(this);
-    QFuture<DataResult> future = QtConcurrent::run(
+    QFuture<DataResult> future = Sailfish::Secrets::Daemon::ApiImpl::tracedRun(
+                requestId,
                 m_requestQueue->controller()->threadPoolForPlugin(cryptoPluginName).data(),
                 CryptoPluginFunctionWrapper::sign,
                 PluginWrapperAndCustomParams(m_cryptoPlugins[cryptoPluginName], wrapper, customParameters),
@@ -1508,6 +1561,24 @@ Daemon::ApiImpl::RequestProcessor::verify(
                       QLatin1String("No such cryptographic service provider plugin exists"));
     }
 
+    QVariantMap pluginParameters(customParameters);
+    KeySession keySession;
+    Result sessionResult = keySessionForRequest(callerPid, requestId, key, CryptoManager::OperationVerify,
+                                                cryptosystemProviderName, &pluginParameters, &keySession);
+    if (sessionResult.code() != Result::Succeeded) {
+        return sessionResult;
+    } else if (keySession.isValid()) {
+        // the key was resolved when the key session was opened.
+        if (keySession.storedInCryptoPlugin()) {
+            verify_withCollectionKey(requestId, signature, data, keySession.keyReference(), padding, digestFunction,
+                                     pluginParameters, cryptosystemProviderName, sessionResult, keySession.collectionKey);
+        } else {
+            verify_withKey(requestId, sessionResult, keySession.serializedKey, signature, data, padding, digestFunction,
+                           pluginParameters, cryptosystemProviderName);
+        }
+        return Result(Result::Pending);
+    }
+
     Key fullKey;
     if (key.publicKey().isEmpty() && key.privateKey().isEmpty() && key.secretKey().isEmpty()) { // can use public key to verify
         // the key is a key reference, we may need to read the full key from storage.
@@ -1586,7 +1657,8 @@ Daemon::ApiImpl::RequestProcessor::verify(
 
     Sailfish::Crypto::Daemon::ApiImpl::CryptoStoragePluginWrapper *wrapper(m_secrets->cryptoStoragePluginWrapper(cryptosystemProviderName));
     QFutureWatcher<ValidatedResult> *watcher = new QFutureWatcher<ValidatedResult>(this);
-    QFuture<ValidatedResult> future = QtConcurrent::run(
+    QFuture<ValidatedResult> future = Sailfish::Secrets::Daemon::ApiImpl::tracedRun(
+                requestId,
                 m_requestQueue->controller()->threadPoolForPlugin(cryptosystemProviderName).data(),
                 CryptoPluginFunctionWrapper::verify,
                 PluginWrapperAndCustomParams(cryptoPlugin, wrapper, customParameters),
@@ -1630,7 +1702,8 @@ Daemon::ApiImpl::RequestProcessor::verify_withKey(
 
     Sailfish::Crypto::Daemon::ApiImpl::CryptoStoragePluginWrapper *wrapper(m_secrets->cryptoStoragePluginWrapper(cryptoPluginName));
     QFutureWatcher<ValidatedResult> *watcher = new QFutureWatcher<ValidatedResult>(this);
-    QFuture<ValidatedResult> future = QtConcurrent::run(
+    QFuture<ValidatedResult> future = Sailfish::Secrets::Daemon::ApiImpl::tracedRun(
+                requestId,
                 m_requestQueue->controller()->threadPoolForPlugin(cryptoPluginName).data(),
                 CryptoPluginFunctionWrapper::verify,
                 PluginWrapperAndCustomParams(m_cryptoPlugins[cryptoPluginName], wrapper, customParameters),
@@ -1673,7 +1746,8 @@ Daemon::ApiImpl::RequestProcessor::verify_withCollectionKey(
 
     Sailfish::Crypto::Daemon::ApiImpl::CryptoStoragePluginWrapper *wrapper(m_secrets->cryptoStoragePluginWrapper(cryptoPluginName));
     QFutureWatcher<ValidatedResult> *watcher = new QFutureWatcher<ValidatedResult>(this);
-    QFuture<ValidatedResult> future = QtConcurrent::run(
+    QFuture<ValidatedResult> future = Sailfish::Secrets::Daemon::ApiImpl::tracedRun(
+                requestId,
                 m_requestQueue->controller()->threadPoolForPlugin(cryptoPluginName).data(),
                 CryptoPluginFunctionWrapper::verify,
                 PluginWrapperAndCustomParams(m_cryptoPlugins[cryptoPluginName], wrapper, customParameters),
@@ -1693,6 +1767,217 @@ Daemon::ApiImpl::RequestProcessor::verify_withCollectionKey(
     watcher->setFuture(future);
 }
 
+Result
+Daemon::ApiImpl::RequestProcessor::batchVerify(
+        pid_t callerPid,
+        quint64 requestId,
+        const QVector<QByteArray> &signatures,
+        const QVector<QByteArray> &data,
+        const Key &key,
+        CryptoManager::SignaturePadding padding,
+        CryptoManager::DigestFunction digestFunction,
+        const QVariantMap &customParameters,
+        const QString &cryptosystemProviderName,
+        QVector<Sailfish::Crypto::CryptoManager::VerificationStatus> *verificationStatuses)
+{
+    // TODO: Access Control
+    CryptoPlugin* cryptoPlugin = m_cryptoPlugins.value(cryptosystemProviderName);
+    if (cryptoPlugin == Q_NULLPTR) {
+        return Result(Result::InvalidCryptographicServiceProvider,
+                      QLatin1String("No such cryptographic service provider plugin exists"));
+    } else if (signatures.size() != data.size()) {
+        return Result(Result::CryptoPluginVerificationError,
+                      QLatin1String("Mismatched number of signatures and data"));
+    } else if (signatures.isEmpty()) {
+        verificationStatuses->clear();
+        return Result(Result::Succeeded);
+    }
+
+    QVariantMap pluginParameters(customParameters);
+    KeySession keySession;
+    Result sessionResult = keySessionForRequest(callerPid, requestId, key, CryptoManager::OperationVerify,
+                                                cryptosystemProviderName, &pluginParameters, &keySession);
+    if (sessionResult.code() != Result::Succeeded) {
+        return sessionResult;
+    } else if (keySession.isValid()) {
+        // the key was resolved when the key session was opened.
+        if (keySession.storedInCryptoPlugin()) {
+            batchVerify_withCollectionKey(requestId, signatures, data, keySession.keyReference(), padding, digestFunction,
+                                          pluginParameters, cryptosystemProviderName, sessionResult, keySession.collectionKey);
+        } else {
+            batchVerify_withKey(requestId, sessionResult, keySession.serializedKey, signatures, data, padding, digestFunction,
+                                pluginParameters, cryptosystemProviderName);
+        }
+        return Result(Result::Pending);
+    }
+
+    // The key is resolved once for the whole batch, exactly as for a single verify().
+    Key fullKey;
+    if (key.publicKey().isEmpty() && key.privateKey().isEmpty() && key.secretKey().isEmpty()) { // can use public key to verify
+        // the key is a key reference, we may need to read the full key from storage.
+        if (key.identifier().name().isEmpty()) {
+            return Result(Result::InvalidKeyIdentifier,
+                          QLatin1String("Empty key name given in key reference identifier"));
+        } else if (key.identifier().collectionName().isEmpty()) {
+            return Result(Result::InvalidKeyIdentifier,
+                          QLatin1String("Empty collection name given in key reference identifier"));
+        } else if (key.identifier().storagePluginName().isEmpty()) {
+            return Result(Result::InvalidKeyIdentifier,
+                          QLatin1String("Empty storage plugin name given in key reference identifier"));
+        } else if (!m_secrets->encryptedStoragePluginNames().contains(key.identifier().storagePluginName())
+                   && !m_secrets->storagePluginNames().contains(key.identifier().storagePluginName())) {
+            return Result(Result::InvalidStorageProvider,
+                          QLatin1String("Unknown storage plugin name specified in key reference identifier"));
+        }
+
+        // find out if the key is stored in the crypto plugin.
+        // if so, we don't need to pull it into the daemon process address space.
+        if (key.identifier().storagePluginName() == cryptosystemProviderName) {
+            // yes, it is stored in the plugin.
+            // it may be that the collection the key is stored in is locked,
+            // and if so, we need to retrieve the collection key to unlock it.
+            Result retn = transformSecretsResult(m_secrets->useKeyPreCheck(callerPid,
+                                                                           requestId,
+                                                                           key.identifier(),
+                                                                           CryptoManager::OperationVerify,
+                                                                           cryptosystemProviderName));
+            if (retn.code() == Result::Failed) {
+                return retn;
+            }
+
+            // asynchronous flow required, will call back to batchVerify_withCollectionKey().
+            m_pendingRequests.insert(requestId,
+                                     Daemon::ApiImpl::RequestProcessor::PendingRequest(
+                                         callerPid,
+                                         requestId,
+                                         Daemon::ApiImpl::BatchVerifyRequest,
+                                         QVariantList() << QVariant::fromValue<QVector<QByteArray> >(signatures)
+                                                        << QVariant::fromValue<QVector<QByteArray> >(data)
+                                                        << QVariant::fromValue<Key>(key)
+                                                        << QVariant::fromValue<CryptoManager::SignaturePadding>(padding)
+                                                        << QVariant::fromValue<CryptoManager::DigestFunction>(digestFunction)
+                                                        << QVariant::fromValue<QVariantMap>(customParameters)
+                                                        << QVariant::fromValue<QString>(cryptosystemProviderName)));
+            return retn;
+        } else {
+            // no, it is stored in some other plugin
+            QByteArray serializedKey;
+            QMap<QString, QString> filterData;
+            Result retn = transformSecretsResult(m_secrets->storedKey(callerPid, requestId, key.identifier(), &serializedKey, &filterData));
+            if (retn.code() == Result::Failed) {
+                return retn;
+            } else if (retn.code() == Result::Pending) {
+                // asynchronous flow required, will call back to batchVerify_withKey().
+                m_pendingRequests.insert(requestId,
+                                         Daemon::ApiImpl::RequestProcessor::PendingRequest(
+                                             callerPid,
+                                             requestId,
+                                             Daemon::ApiImpl::BatchVerifyRequest,
+                                             QVariantList() << QVariant::fromValue<QVector<QByteArray> >(signatures)
+                                                            << QVariant::fromValue<QVector<QByteArray> >(data)
+                                                            << QVariant::fromValue<CryptoManager::SignaturePadding>(padding)
+                                                            << QVariant::fromValue<CryptoManager::DigestFunction>(digestFunction)
+                                                            << QVariant::fromValue<QVariantMap>(customParameters)
+                                                            << QVariant::fromValue<QString>(cryptosystemProviderName)));
+                return retn;
+            }
+
+            fullKey = Key::deserialize(serializedKey);
+        }
+    } else {
+        fullKey = key;
+    }
+
+    batchVerify_finish(requestId, signatures, data, fullKey, padding, digestFunction,
+                       customParameters, cryptosystemProviderName, QByteArray());
+    return Result(Result::Pending);
+}
+
+void
+Daemon::ApiImpl::RequestProcessor::batchVerify_withKey(
+        quint64 requestId,
+        const Result &result,
+        const QByteArray &serializedKey,
+        const QVector<QByteArray> &signatures,
+        const QVector<QByteArray> &data,
+        CryptoManager::SignaturePadding padding,
+        CryptoManager::DigestFunction digestFunction,
+        const QVariantMap &customParameters,
+        const QString &cryptoPluginName)
+{
+    if (result.code() != Result::Succeeded) {
+        QList<QVariant> outParams;
+        outParams << QVariant::fromValue<Result>(result);
+        outParams << QVariant::fromValue<QVector<CryptoManager::VerificationStatus> >(QVector<CryptoManager::VerificationStatus>());
+        m_requestQueue->requestFinished(requestId, outParams);
+        return;
+    }
+
+    batchVerify_finish(requestId, signatures, data, Key::deserialize(serializedKey), padding,
+                       digestFunction, customParameters, cryptoPluginName, QByteArray());
+}
+
+void
+Daemon::ApiImpl::RequestProcessor::batchVerify_withCollectionKey(
+        quint64 requestId,
+        const QVector<QByteArray> &signatures,
+        const QVector<QByteArray> &data,
+        const Key &key,
+        CryptoManager::SignaturePadding padding,
+        CryptoManager::DigestFunction digestFunction,
+        const QVariantMap &customParameters,
+        const QString &cryptoPluginName,
+        const Result &result,
+        const QByteArray &collectionKey)
+{
+    if (result.code() != Result::Succeeded) {
+        QList<QVariant> outParams;
+        outParams << QVariant::fromValue<Result>(result);
+        outParams << QVariant::fromValue<QVector<CryptoManager::VerificationStatus> >(QVector<CryptoManager::VerificationStatus>());
+        m_requestQueue->requestFinished(requestId, outParams);
+        return;
+    }
+
+    batchVerify_finish(requestId, signatures, data, key, padding,
+                       digestFunction, customParameters, cryptoPluginName, collectionKey);
+}
+
+// runs the whole batch as a single plugin operation in the plugin's thread pool.
+void
+Daemon::ApiImpl::RequestProcessor::batchVerify_finish(
+        quint64 requestId,
+        const QVector<QByteArray> &signatures,
+        const QVector<QByteArray> &data,
+        const Key &key,
+        CryptoManager::SignaturePadding padding,
+        CryptoManager::DigestFunction digestFunction,
+        const QVariantMap &customParameters,
+        const QString &cryptoPluginName,
+        const QByteArray &collectionKey)
+{
+    Sailfish::Crypto::Daemon::ApiImpl::CryptoStoragePluginWrapper *wrapper(m_secrets->cryptoStoragePluginWrapper(cryptoPluginName));
+    QFutureWatcher<ValidatedResults> *watcher = new QFutureWatcher<ValidatedResults>(this);
+    QFuture<ValidatedResults> future = Sailfish::Secrets::Daemon::ApiImpl::tracedRun(
+                requestId,
+                m_requestQueue->controller()->threadPoolForPlugin(cryptoPluginName).data(),
+                CryptoPluginFunctionWrapper::batchVerify,
+                PluginWrapperAndCustomParams(m_cryptoPlugins[cryptoPluginName], wrapper, customParameters),
+                signatures,
+                data,
+                KeyAndCollectionKey(key, collectionKey),
+                SignatureOptions(padding, digestFunction));
+
+    connect(watcher, &QFutureWatcher<ValidatedResults>::finished, [=] {
+        watcher->deleteLater();
+        ValidatedResults vr = watcher->future().result();
+        QVariantList outParams;
+        outParams << QVariant::fromValue<Result>(vr.result);
+        outParams << QVariant::fromValue<QVector<CryptoManager::VerificationStatus> >(vr.verificationStatuses);
+        m_requestQueue->requestFinished(requestId, outParams);
+    });
+    watcher->setFuture(future);
+}
+
 Result
 Daemon::ApiImpl::RequestProcessor::encrypt(
         pid_t callerPid,
@@ -1718,6 +2003,24 @@ Daemon::ApiImpl::RequestProcessor::encrypt(
                       QLatin1String("No such cryptographic service provider plugin exists"));
     }
 
+    QVariantMap pluginParameters(customParameters);
+    KeySession keySession;
+    Result sessionResult = keySessionForRequest(callerPid, requestId, key, CryptoManager::OperationEncrypt,
+                                                cryptosystemProviderName, &pluginParameters, &keySession);
+    if (sessionResult.code() != Result::Succeeded) {
+        return sessionResult;
+    } else if (keySession.isValid()) {
+        // the key was resolved when the key session was opened.
+        if (keySession.storedInCryptoPlugin()) {
+            encrypt_withCollectionKey(requestId, data, iv, keySession.keyReference(), blockMode, padding, authenticationData,
+                                      pluginParameters, cryptosystemProviderName, sessionResult, keySession.collectionKey);
+        } else {
+            encrypt_withKey(requestId, sessionResult, keySession.serializedKey, data, iv, blockMode, padding, authenticationData,
+                            pluginParameters, cryptosystemProviderName);
+        }
+        return Result(Result::Pending);
+    }
+
     Key fullKey;
     if (key.publicKey().isEmpty() && key.privateKey().isEmpty() && key.secretKey().isEmpty()) { // can use public key to encrypt
         // the key is a key reference, we may need to read the full key from storage.
@@ -1800,7 +2103,8 @@ Daemon::ApiImpl::RequestProcessor::encrypt(
 
     Sailfish::Crypto::Daemon::ApiImpl::CryptoStoragePluginWrapper *wrapper(m_secrets->cryptoStoragePluginWrapper(cryptosystemProviderName));
     QFutureWatcher<TagDataResult> *watcher = new QFutureWatcher<TagDataResult>(this);
-    QFuture<TagDataResult> future = QtConcurrent::run(
+    QFuture<TagDataResult> future = Sailfish::Secrets::Daemon::ApiImpl::tracedRun(
+                requestId,
                 m_requestQueue->controller()->threadPoolForPlugin(cryptosystemProviderName).data(),
                 CryptoPluginFunctionWrapper::encrypt,
                 PluginWrapperAndCustomParams(cryptoPlugin, wrapper, customParameters),
@@ -1859,7 +2163,8 @@ Daemon::ApiImpl::RequestProcessor::encrypt_withKey(
 
     Sailfish::Crypto::Daemon::ApiImpl::CryptoStoragePluginWrapper *wrapper(m_secrets->cryptoStoragePluginWrapper(cryptoPluginName));
     QFutureWatcher<TagDataResult> *watcher = new QFutureWatcher<TagDataResult>(this);
-    QFuture<TagDataResult> future = QtConcurrent::run(
+    QFuture<TagDataResult> future = Sailfish::Secrets::Daemon::ApiImpl::tracedRun(
+                requestId,
                 m_requestQueue->controller()->threadPoolForPlugin(cryptoPluginName).data(),
                 CryptoPluginFunctionWrapper::encrypt,
                 PluginWrapperAndCustomParams(m_cryptoPlugins[cryptoPluginName], wrapper, customParameters),
@@ -1906,7 +2211,8 @@ Daemon::ApiImpl::RequestProcessor::encrypt_withCollectionKey(
 
     Sailfish::Crypto::Daemon::ApiImpl::CryptoStoragePluginWrapper *wrapper(m_secrets->cryptoStoragePluginWrapper(cryptoPluginName));
     QFutureWatcher<TagDataResult> *watcher = new QFutureWatcher<TagDataResult>(this);
-    QFuture<TagDataResult> future = QtConcurrent::run(
+    QFuture<TagDataResult> future = Sailfish::Secrets::Daemon::ApiImpl::tracedRun(
+                requestId,
                 m_requestQueue->controller()->threadPoolForPlugin(cryptoPluginName).data(),
                 CryptoPluginFunctionWrapper::encrypt,
                 PluginWrapperAndCustomParams(m_cryptoPlugins[cryptoPluginName], wrapper, customParameters),
@@ -1953,6 +2259,24 @@ Daemon::ApiImpl::RequestProcessor::decrypt(
                       QLatin1String("No such cryptographic service provider plugin exists"));
     }
 
+    QVariantMap pluginParameters(customParameters);
+    KeySession keySession;
+    Result sessionResult = keySessionForRequest(callerPid, requestId, key, CryptoManager::OperationDecrypt,
+                                                cryptosystemProviderName, &pluginParameters, &keySession);
+    if (sessionResult.code() != Result::Succeeded) {
+        return sessionResult;
+    } else if (keySession.isValid()) {
+        // the key was resolved when the key session was opened.
+        if (keySession.storedInCryptoPlugin()) {
+            decrypt_withCollectionKey(requestId, data, iv, keySession.keyReference(), blockMode, padding, authenticationData,
+                                      authenticationTag, pluginParameters, cryptosystemProviderName, sessionResult, keySession.collectionKey);
+        } else {
+            decrypt_withKey(requestId, sessionResult, keySession.serializedKey, data, iv, blockMode, padding, authenticationData,
+                            authenticationTag, pluginParameters, cryptosystemProviderName);
+        }
+        return Result(Result::Pending);
+    }
+
     Key fullKey;
     if (key.privateKey().isEmpty() && key.secretKey().isEmpty()) {
         // the key is a key reference, we may need to read the full key from storage.
@@ -2037,7 +2361,8 @@ Daemon::ApiImpl::RequestProcessor::decrypt(
 
     Sailfish::Crypto::Daemon::ApiImpl::CryptoStoragePluginWrapper *wrapper(m_secrets->cryptoStoragePluginWrapper(cryptosystemProviderName));
     QFutureWatcher<VerifiedDataResult> *watcher = new QFutureWatcher<VerifiedDataResult>(this);
-    QFuture<VerifiedDataResult> future = QtConcurrent::run(
+    QFuture<VerifiedDataResult> future = Sailfish::Secrets::Daemon::ApiImpl::tracedRun(
+                requestId,
                 m_requestQueue->controller()->threadPoolForPlugin(cryptosystemProviderName).data(),
                 CryptoPluginFunctionWrapper::decrypt,
                 PluginWrapperAndCustomParams(cryptoPlugin, wrapper, customParameters),
@@ -2085,7 +2410,8 @@ Daemon::ApiImpl::RequestProcessor::decrypt_withKey(
 
     Sailfish::Crypto::Daemon::ApiImpl::CryptoStoragePluginWrapper *wrapper(m_secrets->cryptoStoragePluginWrapper(cryptoPluginName));
     QFutureWatcher<VerifiedDataResult> *watcher = new QFutureWatcher<VerifiedDataResult>(this);
-    QFuture<VerifiedDataResult> future = QtConcurrent::run(
+    QFuture<VerifiedDataResult> future = Sailfish::Secrets::Daemon::ApiImpl::tracedRun(
+                requestId,
                 m_requestQueue->controller()->threadPoolForPlugin(cryptoPluginName).data(),
                 CryptoPluginFunctionWrapper::decrypt,
                 PluginWrapperAndCustomParams(m_cryptoPlugins[cryptoPluginName], wrapper, customParameters),
@@ -2132,7 +2458,8 @@ Daemon::ApiImpl::RequestProcessor::decrypt_withCollectionKey(
 
     Sailfish::Crypto::Daemon::ApiImpl::CryptoStoragePluginWrapper *wrapper(m_secrets->cryptoStoragePluginWrapper(cryptoPluginName));
     QFutureWatcher<VerifiedDataResult> *watcher = new QFutureWatcher<VerifiedDataResult>(this);
-    QFuture<VerifiedDataResult> future = QtConcurrent::run(
+    QFuture<VerifiedDataResult> future = Sailfish::Secrets::Daemon::ApiImpl::tracedRun(
+                requestId,
                 m_requestQueue->controller()->threadPoolForPlugin(cryptoPluginName).data(),
                 CryptoPluginFunctionWrapper::decrypt,
                 PluginWrapperAndCustomParams(m_cryptoPlugins[cryptoPluginName], wrapper, customParameters),
@@ -2260,7 +2587,8 @@ Daemon::ApiImpl::RequestProcessor::initializeCipherSession(
 
     Sailfish::Crypto::Daemon::ApiImpl::CryptoStoragePluginWrapper *wrapper(m_secrets->cryptoStoragePluginWrapper(cryptosystemProviderName));
     QFutureWatcher<CipherSessionTokenResult> *watcher = new QFutureWatcher<CipherSessionTokenResult>(this);
-    QFuture<CipherSessionTokenResult> future = QtConcurrent::run(
+    QFuture<CipherSessionTokenResult> future = Sailfish::Secrets::Daemon::ApiImpl::tracedRun(
+                requestId,
                 m_requestQueue->controller()->threadPoolForPlugin(cryptosystemProviderName).data(),
                 CryptoPluginFunctionWrapper::initializeCipherSession,
                 PluginWrapperAndCustomParams(cryptoPlugin, wrapper, customParameters),
@@ -2312,7 +2640,8 @@ Daemon::ApiImpl::RequestProcessor::initializeCipherSession_withKey(
 
     Sailfish::Crypto::Daemon::ApiImpl::CryptoStoragePluginWrapper *wrapper(m_secrets->cryptoStoragePluginWrapper(cryptoPluginName));
     QFutureWatcher<CipherSessionTokenResult> *watcher = new QFutureWatcher<CipherSessionTokenResult>(this);
-    QFuture<CipherSessionTokenResult> future = QtConcurrent::run(
+    QFuture<CipherSessionTokenResult> future = Sailfish::Secrets::Daemon::ApiImpl::tracedRun(
+                requestId,
                 m_requestQueue->controller()->threadPoolForPlugin(cryptoPluginName).data(),
                 CryptoPluginFunctionWrapper::initializeCipherSession,
                 PluginWrapperAndCustomParams(m_cryptoPlugins[cryptoPluginName], wrapper, customParameters),
@@ -2363,7 +2692,8 @@ Daemon::ApiImpl::RequestProcessor::initializeCipherSession_withCollectionKey(
 
     Sailfish::Crypto::Daemon::ApiImpl::CryptoStoragePluginWrapper *wrapper(m_secrets->cryptoStoragePluginWrapper(cryptoPluginName));
     QFutureWatcher<CipherSessionTokenResult> *watcher = new QFutureWatcher<CipherSessionTokenResult>(this);
-    QFuture<CipherSessionTokenResult> future = QtConcurrent::run(
+    QFuture<CipherSessionTokenResult> future = Sailfish::Secrets::Daemon::ApiImpl::tracedRun(
+                requestId,
                 m_requestQueue->controller()->threadPoolForPlugin(cryptoPluginName).data(),
                 CryptoPluginFunctionWrapper::initializeCipherSession,
                 PluginWrapperAndCustomParams(m_cryptoPlugins[cryptoPluginName], wrapper, customParameters),
@@ -2406,7 +2736,8 @@ Daemon::ApiImpl::RequestProcessor::updateCipherSessionAuthentication(
     }
 
     QFutureWatcher<Result> *watcher = new QFutureWatcher<Result>(this);
-    QFuture<Result> future = QtConcurrent::run(
+    QFuture<Result> future = Sailfish::Secrets::Daemon::ApiImpl::tracedRun(
+                requestId,
                 m_requestQueue->controller()->threadPoolForPlugin(cryptosystemProviderName).data(),
                 CryptoPluginFunctionWrapper::updateCipherSessionAuthentication,
                 PluginAndCustomParams(cryptoPlugin, customParameters),
@@ -2445,7 +2776,8 @@ Daemon::ApiImpl::RequestProcessor::updateCipherSession(
     }
 
     QFutureWatcher<DataResult> *watcher = new QFutureWatcher<DataResult>(this);
-    QFuture<DataResult> future = QtConcurrent::run(
+    QFuture<DataResult> future = Sailfish::Secrets::Daemon::ApiImpl::tracedRun(
+                requestId,
                 m_requestQueue->controller()->threadPoolForPlugin(cryptosystemProviderName).data(),
                 CryptoPluginFunctionWrapper::updateCipherSession,
                 PluginAndCustomParams(cryptoPlugin, customParameters),
@@ -2488,7 +2820,8 @@ Daemon::ApiImpl::RequestProcessor::finalizeCipherSession(
     }
 
     QFutureWatcher<VerifiedDataResult> *watcher = new QFutureWatcher<VerifiedDataResult>(this);
-    QFuture<VerifiedDataResult> future = QtConcurrent::run(
+    QFuture<VerifiedDataResult> future = Sailfish::Secrets::Daemon::ApiImpl::tracedRun(
+                requestId,
                 m_requestQueue->controller()->threadPoolForPlugin(cryptosystemProviderName).data(),
                 CryptoPluginFunctionWrapper::finalizeCipherSession,
                 PluginAndCustomParams(cryptoPlugin, customParameters),
@@ -2674,6 +3007,347 @@ Daemon::ApiImpl::RequestProcessor::forgetLockCode(
     return retn;
 }
 
+Result
+Daemon::ApiImpl::RequestProcessor::openKeySession(
+        pid_t callerPid,
+        quint64 requestId,
+        const QString &connectionName,
+        const Key &key,
+        CryptoManager::Operations operations,
+        const QVariantMap &customParameters,
+        const QString &cryptosystemProviderName,
+        quint32 *keySessionToken)
+{
+    Q_UNUSED(customParameters); // there are currently no key session parameters.
+
+    if (!m_cryptoPlugins.contains(cryptosystemProviderName)) {
+        return Result(Result::InvalidCryptographicServiceProvider,
+                      QLatin1String("No such cryptographic service provider plugin exists"));
+    } else if (!key.privateKey().isEmpty() || !key.secretKey().isEmpty() || !key.publicKey().isEmpty()) {
+        return Result(Result::InvalidKeyIdentifier,
+                      QLatin1String("Key sessions can only be opened with a reference to a stored key"));
+    } else if (key.identifier().name().isEmpty()) {
+        return Result(Result::InvalidKeyIdentifier,
+                      QLatin1String("Empty key name given in key reference identifier"));
+    } else if (key.identifier().collectionName().isEmpty()) {
+        return Result(Result::InvalidKeyIdentifier,
+                      QLatin1String("Empty collection name given in key reference identifier"));
+    } else if (key.identifier().storagePluginName().isEmpty()) {
+        return Result(Result::InvalidKeyIdentifier,
+                      QLatin1String("Empty storage plugin name given in key reference identifier"));
+    } else if (!m_secrets->encryptedStoragePluginNames().contains(key.identifier().storagePluginName())
+               && !m_secrets->storagePluginNames().contains(key.identifier().storagePluginName())) {
+        return Result(Result::InvalidStorageProvider,
+                      QLatin1String("Unknown storage plugin name specified in key reference identifier"));
+    } else if (operations == CryptoManager::OperationUnknown) {
+        return Result(Result::OperationNotSupportedError,
+                      QLatin1String("No operations specified for the key session"));
+    }
+
+    // Resolve the key in the same way as the requests which use it,
+    // but only once for all of the requests which cite the session.
+    // If the collection locks again before the key has been resolved,
+    // the key may only be used once and no session can be opened.
+    m_openingKeySessions.insert(requestId, key.identifier());
+    if (key.identifier().storagePluginName() == cryptosystemProviderName) {
+        // the key is stored in the plugin, retain the key of its collection.
+        // The user is prompted (if required) as for the first of the operations.
+        const int ops = static_cast<int>(operations);
+        const CryptoManager::Operation promptOperation = static_cast<CryptoManager::Operation>(ops & -ops);
+        Result retn = transformSecretsResult(m_secrets->useKeyPreCheck(callerPid,
+                                                                       requestId,
+                                                                       key.identifier(),
+                                                                       promptOperation,
+                                                                       cryptosystemProviderName));
+        if (retn.code() == Result::Failed) {
+            m_openingKeySessions.remove(requestId);
+            return retn;
+        }
+
+        // asynchronous flow required, will call back to openKeySession_withCollectionKey().
+        m_pendingRequests.insert(requestId,
+                                 Daemon::ApiImpl::RequestProcessor::PendingRequest(
+                                     callerPid,
+                                     requestId,
+                                     Daemon::ApiImpl::OpenKeySessionRequest,
+                                     QVariantList() << QVariant::fromValue<QString>(connectionName)
+                                                    << QVariant::fromValue<Key::Identifier>(key.identifier())
+                                                    << QVariant::fromValue<CryptoManager::Operations>(operations)
+                                                    << QVariant::fromValue<QString>(cryptosystemProviderName)));
+        return retn;
+    }
+
+    // the key is stored in some other plugin, retain the key itself.
+    QByteArray serializedKey;
+    QMap<QString, QString> filterData;
+    Result retn = transformSecretsResult(m_secrets->storedKey(callerPid, requestId, key.identifier(), &serializedKey, &filterData));
+    if (retn.code() == Result::Failed) {
+        m_openingKeySessions.remove(requestId);
+        return retn;
+    } else if (retn.code() == Result::Pending) {
+        // asynchronous flow required, will call back to openKeySession_withKey().
+        m_pendingRequests.insert(requestId,
+                                 Daemon::ApiImpl::RequestProcessor::PendingRequest(
+                                     callerPid,
+                                     requestId,
+                                     Daemon::ApiImpl::OpenKeySessionRequest,
+                                     QVariantList() << QVariant::fromValue<QString>(connectionName)
+                                                    << QVariant::fromValue<Key::Identifier>(key.identifier())
+                                                    << QVariant::fromValue<CryptoManager::Operations>(operations)
+                                                    << QVariant::fromValue<QString>(cryptosystemProviderName)));
+        return retn;
+    }
+
+    KeySession session;
+    session.callerPid = callerPid;
+    session.connectionName = connectionName;
+    session.cryptoPluginName = cryptosystemProviderName;
+    session.identifier = key.identifier();
+    session.operations = operations;
+    session.serializedKey = serializedKey;
+    return insertKeySession(requestId, session, keySessionToken);
+}
+
+void
+Daemon::ApiImpl::RequestProcessor::openKeySession_withKey(
+        quint64 requestId,
+        const Result &result,
+        const QByteArray &serializedKey,
+        pid_t callerPid,
+        const QString &connectionName,
+        const Key::Identifier &identifier,
+        CryptoManager::Operations operations,
+        const QString &cryptoPluginName)
+{
+    quint32 keySessionToken = 0;
+    Result returnResult(result);
+    if (result.code() == Result::Succeeded) {
+        KeySession session;
+        session.callerPid = callerPid;
+        session.connectionName = connectionName;
+        session.cryptoPluginName = cryptoPluginName;
+        session.identifier = identifier;
+        session.operations = operations;
+        session.serializedKey = serializedKey;
+        returnResult = insertKeySession(requestId, session, &keySessionToken);
+    } else {
+        m_openingKeySessions.remove(requestId);
+    }
+
+    QList<QVariant> outParams;
+    outParams << QVariant::fromValue<Result>(returnResult);
+    outParams << QVariant::fromValue<quint32>(keySessionToken);
+    m_requestQueue->requestFinished(requestId, outParams);
+}
+
+void
+Daemon::ApiImpl::RequestProcessor::openKeySession_withCollectionKey(
+        quint64 requestId,
+        pid_t callerPid,
+        const QString &connectionName,
+        const Key::Identifier &identifier,
+        CryptoManager::Operations operations,
+        const QString &cryptoPluginName,
+        const Result &result,
+        const QByteArray &collectionKey)
+{
+    quint32 keySessionToken = 0;
+    Result returnResult(result);
+    if (result.code() == Result::Succeeded) {
+        KeySession session;
+        session.callerPid = callerPid;
+        session.connectionName = connectionName;
+        session.cryptoPluginName = cryptoPluginName;
+        session.identifier = identifier;
+        session.operations = operations;
+        session.collectionKey = collectionKey;
+        returnResult = insertKeySession(requestId, session, &keySessionToken);
+    } else {
+        m_openingKeySessions.remove(requestId);
+    }
+
+    QList<QVariant> outParams;
+    outParams << QVariant::fromValue<Result>(returnResult);
+    outParams << QVariant::fromValue<quint32>(keySessionToken);
+    m_requestQueue->requestFinished(requestId, outParams);
+}
+
+Result
+Daemon::ApiImpl::RequestProcessor::closeKeySession(
+        pid_t callerPid,
+        quint64 requestId,
+        quint32 keySessionToken,
+        const QVariantMap &customParameters,
+        const QString &cryptosystemProviderName)
+{
+    Q_UNUSED(customParameters); // there are currently no key session parameters.
+
+    QHash<quint32, KeySession>::iterator it = m_keySessions.find(keySessionToken);
+    if (it == m_keySessions.end() || it->callerPid != callerPid
+            || it->connectionName != m_requestQueue->requestConnectionName(requestId)) {
+        return Result(Result::InvalidKeySessionToken,
+                      QLatin1String("No such key session is open"));
+    } else if (it->cryptoPluginName != cryptosystemProviderName) {
+        return Result(Result::InvalidCryptographicServiceProvider,
+                      QLatin1String("The key session was opened with another cryptographic service provider plugin"));
+    }
+
+    m_keySessions.erase(it);
+    return Result(Result::Succeeded);
+}
+
+void
+Daemon::ApiImpl::RequestProcessor::closeKeySessions(
+        const QString &connectionName)
+{
+    QHash<quint32, KeySession>::iterator it = m_keySessions.begin();
+    while (it != m_keySessions.end()) {
+        if (it->connectionName == connectionName) {
+            it = m_keySessions.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void
+Daemon::ApiImpl::RequestProcessor::closeKeySessionsOfKey(
+        const Key::Identifier &identifier)
+{
+    QHash<quint32, KeySession>::iterator it = m_keySessions.begin();
+    while (it != m_keySessions.end()) {
+        if (it->identifier == identifier) {
+            it = m_keySessions.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void
+Daemon::ApiImpl::RequestProcessor::closeKeySessionsOfPlugin(
+        const QString &cryptoPluginName)
+{
+    QHash<quint32, KeySession>::iterator it = m_keySessions.begin();
+    while (it != m_keySessions.end()) {
+        if (it->cryptoPluginName == cryptoPluginName
+                || it->identifier.storagePluginName() == cryptoPluginName) {
+            it = m_keySessions.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+// An empty collection name matches every collection of the storage plugin,
+// and an empty storage plugin name as well matches every collection.
+void
+Daemon::ApiImpl::RequestProcessor::closeKeySessionsOfCollection(
+        const QString &collectionName,
+        const QString &storagePluginName)
+{
+    auto inCollection = [&collectionName, &storagePluginName] (const Key::Identifier &identifier) {
+        return (storagePluginName.isEmpty() || identifier.storagePluginName() == storagePluginName)
+                && (collectionName.isEmpty() || identifier.collectionName() == collectionName);
+    };
+
+    QHash<quint32, KeySession>::iterator it = m_keySessions.begin();
+    while (it != m_keySessions.end()) {
+        if (inCollection(it->identifier)) {
+            it = m_keySessions.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    QHash<quint64, Key::Identifier>::iterator oit = m_openingKeySessions.begin();
+    while (oit != m_openingKeySessions.end()) {
+        if (inCollection(oit.value())) {
+            oit = m_openingKeySessions.erase(oit);
+        } else {
+            ++oit;
+        }
+    }
+}
+
+Result
+Daemon::ApiImpl::RequestProcessor::insertKeySession(
+        quint64 requestId,
+        const KeySession &session,
+        quint32 *keySessionToken)
+{
+    if (!m_openingKeySessions.remove(requestId)) {
+        return Result(Result::OperationNotSupportedError,
+                      QLatin1String("The collection of the key was locked again after use, so no key session can be opened for the key"));
+    }
+
+    int clientSessions = 0;
+    for (const KeySession &other : m_keySessions) {
+        if (other.callerPid == session.callerPid) {
+            ++clientSessions;
+        }
+    }
+    if (clientSessions >= MaxKeySessionsPerClient) {
+        return Result(Result::DaemonError,
+                      QLatin1String("Too many key sessions are open, close some before opening another"));
+    }
+
+    // the token must be non-zero, and is never reused while the previous session is open.
+    // It is random so that it cannot be predicted from the tokens of other sessions.
+    QFile urandom(QLatin1String("/dev/urandom"));
+    if (!urandom.open(QIODevice::ReadOnly)) {
+        return Result(Result::DaemonError,
+                      QLatin1String("Unable to generate a key session token"));
+    }
+    do {
+        if (urandom.read(reinterpret_cast<char*>(keySessionToken), sizeof(quint32)) != sizeof(quint32)) {
+            *keySessionToken = 0;
+            return Result(Result::DaemonError,
+                          QLatin1String("Unable to generate a key session token"));
+        }
+    } while (*keySessionToken == 0 || m_keySessions.contains(*keySessionToken));
+    m_keySessions.insert(*keySessionToken, session);
+    return Result(Result::Succeeded);
+}
+
+// Finds the key session which the custom parameters of a request cite, and
+// removes the citation from the parameters which are passed to the plugin.
+// If no session is cited, the result succeeds and the session is invalid.
+Result
+Daemon::ApiImpl::RequestProcessor::keySessionForRequest(
+        pid_t callerPid,
+        quint64 requestId,
+        const Key &key,
+        CryptoManager::Operation operation,
+        const QString &cryptoPluginName,
+        QVariantMap *customParameters,
+        KeySession *session) const
+{
+    const QVariant token = customParameters->take(KeySessionRequest::keySessionParameterName());
+    if (!token.isValid()) {
+        return Result(Result::Succeeded);
+    }
+
+    const KeySession cited = m_keySessions.value(token.value<quint32>());
+    if (!cited.isValid() || cited.callerPid != callerPid
+            || cited.connectionName != m_requestQueue->requestConnectionName(requestId)) {
+        return Result(Result::InvalidKeySessionToken,
+                      QLatin1String("The cited key session is not open"));
+    } else if (cited.cryptoPluginName != cryptoPluginName) {
+        return Result(Result::InvalidCryptographicServiceProvider,
+                      QLatin1String("The key session was opened with another cryptographic service provider plugin"));
+    } else if (!key.identifier().name().isEmpty() && !(key.identifier() == cited.identifier)) {
+        return Result(Result::InvalidKeyIdentifier,
+                      QLatin1String("The key of the request is not the key of the cited key session"));
+    } else if (!(cited.operations & operation)) {
+        return Result(Result::OperationNotSupportedError,
+                      QLatin1String("The cited key session doesn't permit the operation"));
+    }
+
+    *session = cited;
+    return Result(Result::Succeeded);
+}
+
 // asynchronous operation (retrieve stored key) has completed.
 void Daemon::ApiImpl::RequestProcessor::secretsStoredKeyCompleted(
         quint64 requestId,
@@ -2688,6 +3362,9 @@ void Daemon::ApiImpl::RequestProcessor::secretsStoredKeyCompleted(
 
         // call the appropriate method to complete the request
         Daemon::ApiImpl::RequestProcessor::PendingRequest pr = m_pendingRequests.take(requestId);
+        Sailfish::Secrets::Daemon::ApiImpl::RequestTracer::instance()->addSpan(
+                requestId, "processor", QStringLiteral("pendingRequest"),
+                pr.startTime, Sailfish::Secrets::Daemon::ApiImpl::monotonicNsecs());
         switch (pr.requestType) {
             case StoredKeyRequest: {
                 (void)pr.parameters.takeFirst(); // the identifier, we don't need it.
@@ -2714,6 +3391,16 @@ void Daemon::ApiImpl::RequestProcessor::secretsStoredKeyCompleted(
                 verify_withKey(requestId, returnResult, serializedKey, signature, data, padding, digestFunction, customParameters, cryptoPluginName);
                 break;
             }
+            case BatchVerifyRequest: {
+                QVector<QByteArray> signatures = pr.parameters.takeFirst().value<QVector<QByteArray> >();
+                QVector<QByteArray> data = pr.parameters.takeFirst().value<QVector<QByteArray> >();
+                CryptoManager::SignaturePadding padding = pr.parameters.takeFirst().value<CryptoManager::SignaturePadding>();
+                CryptoManager::DigestFunction digestFunction = pr.parameters.takeFirst().value<CryptoManager::DigestFunction>();
+                QVariantMap customParameters = pr.parameters.takeFirst().value<QVariantMap>();
+                QString cryptoPluginName = pr.parameters.takeFirst().value<QString>();
+                batchVerify_withKey(requestId, returnResult, serializedKey, signatures, data, padding, digestFunction, customParameters, cryptoPluginName);
+                break;
+            }
             case EncryptRequest: {
                 QByteArray data = pr.parameters.takeFirst().value<QByteArray>();
                 QByteArray iv = pr.parameters.takeFirst().value<QByteArray>();
@@ -2753,6 +3440,16 @@ void Daemon::ApiImpl::RequestProcessor::secretsStoredKeyCompleted(
                                                 digestFunction, customParameters, cryptoPluginName);
                 break;
             }
+            case OpenKeySessionRequest: {
+                QString connectionName = pr.parameters.takeFirst().value<QString>();
+                Key::Identifier identifier = pr.parameters.takeFirst().value<Key::Identifier>();
+                CryptoManager::Operations operations = pr.parameters.takeFirst().value<CryptoManager::Operations>();
+                QString cryptoPluginName = pr.parameters.takeFirst().value<QString>();
+                openKeySession_withKey(requestId, returnResult, serializedKey,
+                                       pr.callerPid, connectionName, identifier,
+                                       operations, cryptoPluginName);
+                break;
+            }
             default: {
                 qCWarning(lcSailfishCryptoDaemon) << "Secrets completed storedKey() operation for request:" << requestId << "of invalid type:" << pr.requestType;
                 break;
@@ -2776,6 +3473,9 @@ void Daemon::ApiImpl::RequestProcessor::secretsUseKeyPreCheckCompleted(
 
         // call the appropriate method to complete the request
         Daemon::ApiImpl::RequestProcessor::PendingRequest pr = m_pendingRequests.take(requestId);
+        Sailfish::Secrets::Daemon::ApiImpl::RequestTracer::instance()->addSpan(
+                requestId, "processor", QStringLiteral("pendingRequest"),
+                pr.startTime, Sailfish::Secrets::Daemon::ApiImpl::monotonicNsecs());
         switch (pr.requestType) {
             case SignRequest: {
                 QByteArray data = pr.parameters.takeFirst().value<QByteArray>();
@@ -2815,6 +3515,26 @@ void Daemon::ApiImpl::RequestProcessor::secretsUseKeyPreCheckCompleted(
                                          collectionDecryptionKey);
                 break;
             }
+            case BatchVerifyRequest: {
+                QVector<QByteArray> signatures = pr.parameters.takeFirst().value<QVector<QByteArray> >();
+                QVector<QByteArray> data = pr.parameters.takeFirst().value<QVector<QByteArray> >();
+                Key key = pr.parameters.takeFirst().value<Key>();
+                CryptoManager::SignaturePadding padding = pr.parameters.takeFirst().value<CryptoManager::SignaturePadding>();
+                CryptoManager::DigestFunction digestFunction = pr.parameters.takeFirst().value<CryptoManager::DigestFunction>();
+                QVariantMap customParameters = pr.parameters.takeFirst().value<QVariantMap>();
+                QString cryptosystemProviderName = pr.parameters.takeFirst().value<QString>();
+                batchVerify_withCollectionKey(requestId,
+                                              signatures,
+                                              data,
+                                              key,
+                                              padding,
+                                              digestFunction,
+                                              customParameters,
+                                              cryptosystemProviderName,
+                                              returnResult,
+                                              collectionDecryptionKey);
+                break;
+            }
             case EncryptRequest: {
                 QByteArray data = pr.parameters.takeFirst().value<QByteArray>();
                 QByteArray iv = pr.parameters.takeFirst().value<QByteArray>();
@@ -2886,6 +3606,21 @@ void Daemon::ApiImpl::RequestProcessor::secretsUseKeyPreCheckCompleted(
                                                           collectionDecryptionKey);
                 break;
             }
+            case OpenKeySessionRequest: {
+                QString connectionName = pr.parameters.takeFirst().value<QString>();
+                Key::Identifier identifier = pr.parameters.takeFirst().value<Key::Identifier>();
+                CryptoManager::Operations operations = pr.parameters.takeFirst().value<CryptoManager::Operations>();
+                QString cryptosystemProviderName = pr.parameters.takeFirst().value<QString>();
+                openKeySession_withCollectionKey(requestId,
+                                                 pr.callerPid,
+                                                 connectionName,
+                                                 identifier,
+                                                 operations,
+                                                 cryptosystemProviderName,
+                                                 returnResult,
+                                                 collectionDecryptionKey);
+                break;
+            }
             default: {
                 qCWarning(lcSailfishCryptoDaemon) << "Secrets completed useKeyPreCheck() operation for request:" << requestId << "of invalid type:" << pr.requestType;
                 break;
@@ -2909,6 +3644,9 @@ void Daemon::ApiImpl::RequestProcessor::secretsStoreKeyPreCheckCompleted(
 
         // call the appropriate method to complete the request
         Daemon::ApiImpl::RequestProcessor::PendingRequest pr = m_pendingRequests.take(requestId);
+        Sailfish::Secrets::Daemon::ApiImpl::RequestTracer::instance()->addSpan(
+                requestId, "processor", QStringLiteral("pendingRequest"),
+                pr.startTime, Sailfish::Secrets::Daemon::ApiImpl::monotonicNsecs());
         switch (pr.requestType) {
             case GenerateStoredKeyRequest: {
                 Key keyTemplate = pr.parameters.takeFirst().value<Key>();
@@ -2968,6 +3706,9 @@ void Daemon::ApiImpl::RequestProcessor::secretsStoreKeyCompleted(
 
         // call the appropriate method to complete the request
         Daemon::ApiImpl::RequestProcessor::PendingRequest pr = m_pendingRequests.take(requestId);
+        Sailfish::Secrets::Daemon::ApiImpl::RequestTracer::instance()->addSpan(
+                requestId, "processor", QStringLiteral("pendingRequest"),
+                pr.startTime, Sailfish::Secrets::Daemon::ApiImpl::monotonicNsecs());
         switch (pr.requestType) {
             case GenerateStoredKeyRequest: {
                 Key fullKey = pr.parameters.takeFirst().value<Key>();
@@ -3001,6 +3742,9 @@ void Daemon::ApiImpl::RequestProcessor::secretsDeleteStoredKeyCompleted(
 
         // call the appropriate method to complete the request
         Daemon::ApiImpl::RequestProcessor::PendingRequest pr = m_pendingRequests.take(requestId);
+        Sailfish::Secrets::Daemon::ApiImpl::RequestTracer::instance()->addSpan(
+                requestId, "processor", QStringLiteral("pendingRequest"),
+                pr.startTime, Sailfish::Secrets::Daemon::ApiImpl::monotonicNsecs());
         switch (pr.requestType) {
             case DeleteStoredKeyRequest: {
                 Key::Identifier identifier = pr.parameters.size()
@@ -3032,6 +3776,7 @@ void Daemon::ApiImpl::RequestProcessor::secretsStoredKeyIdentifiersCompleted(
 
         // transform the identifiers.
         QVector<Key::Identifier> identifiers;
+        identifiers.reserve(idents.size());
         for (const Sailfish::Secrets::Secret::Identifier &id : idents) {
             identifiers.append(Key::Identifier(
                     id.name(), id.collectionName(), id.storagePluginName()));
@@ -3039,6 +3784,9 @@ void Daemon::ApiImpl::RequestProcessor::secretsStoredKeyIdentifiersCompleted(
 
         // call the appropriate method to complete the request
         Daemon::ApiImpl::RequestProcessor::PendingRequest pr = m_pendingRequests.take(requestId);
+        Sailfish::Secrets::Daemon::ApiImpl::RequestTracer::instance()->addSpan(
+                requestId, "processor", QStringLiteral("pendingRequest"),
+                pr.startTime, Sailfish::Secrets::Daemon::ApiImpl::monotonicNsecs());
         switch (pr.requestType) {
             case StoredKeyIdentifiersRequest: {
                 storedKeyIdentifiers2(pr.callerPid, requestId, returnResult, identifiers);
@@ -3067,6 +3815,9 @@ void Daemon::ApiImpl::RequestProcessor::secretsUserInputCompleted(
 
         // call the appropriate method to complete the request
         Daemon::ApiImpl::RequestProcessor::PendingRequest pr = m_pendingRequests.take(requestId);
+        Sailfish::Secrets::Daemon::ApiImpl::RequestTracer::instance()->addSpan(
+                requestId, "processor", QStringLiteral("pendingRequest"),
+                pr.startTime, Sailfish::Secrets::Daemon::ApiImpl::monotonicNsecs());
         switch (pr.requestType) {
             case GenerateStoredKeyRequest: {
                 Key keyTemplate = pr.parameters.takeFirst().value<Key>();
@@ -3130,6 +3881,9 @@ void Daemon::ApiImpl::RequestProcessor::secretsCryptoPluginLockStatusRequestComp
 
         // call the appropriate method to complete the request
         Daemon::ApiImpl::RequestProcessor::PendingRequest pr = m_pendingRequests.take(requestId);
+        Sailfish::Secrets::Daemon::ApiImpl::RequestTracer::instance()->addSpan(
+                requestId, "processor", QStringLiteral("pendingRequest"),
+                pr.startTime, Sailfish::Secrets::Daemon::ApiImpl::monotonicNsecs());
         switch (pr.requestType) {
             case QueryLockStatusRequest: {
                 // nothing more to do, return the result directly.
@@ -3163,6 +3917,9 @@ void Daemon::ApiImpl::RequestProcessor::secretsCryptoPluginLockCodeRequestComple
 
         // call the appropriate method to complete the request
         Daemon::ApiImpl::RequestProcessor::PendingRequest pr = m_pendingRequests.take(requestId);
+        Sailfish::Secrets::Daemon::ApiImpl::RequestTracer::instance()->addSpan(
+                requestId, "processor", QStringLiteral("pendingRequest"),
+                pr.startTime, Sailfish::Secrets::Daemon::ApiImpl::monotonicNsecs());
         switch (pr.requestType) {
             case ModifyLockCodeRequest:   // flow on
             case ProvideLockCodeRequest:  // flow on
@@ -3182,3 +3939,20 @@ void Daemon::ApiImpl::RequestProcessor::secretsCryptoPluginLockCodeRequestComple
         qCWarning(lcSailfishCryptoDaemon) << "Secrets completed crypto plugin lock code operation for unknown request:" << requestId;
     }
 }
+
+// a collection has been deleted, so the keys stored in it no longer exist.
+void Daemon::ApiImpl::RequestProcessor::secretsCollectionRemoved(
+        const QString &collectionName,
+        const QString &storagePluginName)
+{
+    closeKeySessionsOfCollection(collectionName, storagePluginName);
+}
+
+// a collection (or every collection of a plugin, or all of them) has been locked again,
+// so the keys retained for its key sessions may no longer be used without authentication.
+void Daemon::ApiImpl::RequestProcessor::secretsCollectionLocked(
+        const QString &collectionName,
+        const QString &storagePluginName)
+{
+    closeKeySessionsOfCollection(collectionName, storagePluginName);
+}
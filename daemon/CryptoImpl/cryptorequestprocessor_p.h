@@ -35,6 +35,7 @@
 #include <QtCore/QString>
 #include <QtCore/QDateTime>
 #include <QtCore/QMap>
+#include <QtCore/QHash>
 #include <QtCore/QVector>
 
 #include <sys/types.h>
@@ -204,6 +205,18 @@ public:
             const QString &cryptosystemProviderName,
             Sailfish::Crypto::CryptoManager::VerificationStatus *verificationStatus);
 
+    Sailfish::Crypto::Result batchVerify(
+            pid_t callerPid,
+            quint64 requestId,
+            const QVector<QByteArray> &signatures,
+            const QVector<QByteArray> &data,
+            const Sailfish::Crypto::Key &key,
+            Sailfish::Crypto::CryptoManager::SignaturePadding padding,
+            Sailfish::Crypto::CryptoManager::DigestFunction digestFunction,
+            const QVariantMap &customParameters,
+            const QString &cryptosystemProviderName,
+            QVector<Sailfish::Crypto::CryptoManager::VerificationStatus> *verificationStatuses);
+
     Sailfish::Crypto::Result encrypt(
             pid_t callerPid,
             quint64 requestId,
@@ -302,6 +315,25 @@ public:
             const QString &lockCodeTarget,
             const Sailfish::Crypto::InteractionParameters &interactionParameters);
 
+    Sailfish::Crypto::Result openKeySession(
+            pid_t callerPid,
+            quint64 requestId,
+            const QString &connectionName,
+            const Sailfish::Crypto::Key &key,
+            Sailfish::Crypto::CryptoManager::Operations operations,
+            const QVariantMap &customParameters,
+            const QString &cryptosystemProviderName,
+            quint32 *keySessionToken);
+
+    Sailfish::Crypto::Result closeKeySession(
+            pid_t callerPid,
+            quint64 requestId,
+            quint32 keySessionToken,
+            const QVariantMap &customParameters,
+            const QString &cryptosystemProviderName);
+
+    void closeKeySessions(const QString &connectionName);
+
 public Q_SLOTS:
     void secretsUseKeyPreCheckCompleted(
             quint64 requestId,
@@ -346,22 +378,89 @@ public Q_SLOTS:
             quint64 requestId,
             const Sailfish::Secrets::Result &result);
 
+    void secretsCollectionRemoved(
+            const QString &collectionName,
+            const QString &storagePluginName);
+
+    void secretsCollectionLocked(
+            const QString &collectionName,
+            const QString &storagePluginName);
+
 private:
     struct PendingRequest {
         PendingRequest()
-            : callerPid(0), requestId(0), requestType(Sailfish::Crypto::Daemon::ApiImpl::InvalidRequest) {}
+            : callerPid(0), requestId(0), requestType(Sailfish::Crypto::Daemon::ApiImpl::InvalidRequest), startTime(0) {}
         PendingRequest(uint pid, quint64 rid, Sailfish::Crypto::Daemon::ApiImpl::RequestType rtype, QVariantList params)
-            : callerPid(pid), requestId(rid), requestType(rtype), parameters(params) {}
+            : callerPid(pid), requestId(rid), requestType(rtype), parameters(params)
+            , startTime(Sailfish::Secrets::Daemon::ApiImpl::monotonicNsecs()) {}
         PendingRequest(const PendingRequest &other)
-            : callerPid(other.callerPid), requestId(other.requestId), requestType(other.requestType), parameters(other.parameters) {}
+            : callerPid(other.callerPid), requestId(other.requestId), requestType(other.requestType), parameters(other.parameters)
+            , startTime(other.startTime) {}
         uint callerPid;
         quint64 requestId;
         Sailfish::Crypto::Daemon::ApiImpl::RequestType requestType;
         QVariantList parameters;
+        qint64 startTime; // used for request tracing
+    };
+
+    // A stored key which has been resolved once for a client, and which
+    // the requests of the client may cite instead of resolving it again.
+    struct KeySession {
+        KeySession() : callerPid(0), operations(Sailfish::Crypto::CryptoManager::OperationUnknown) {}
+        bool isValid() const { return callerPid != 0; }
+        bool storedInCryptoPlugin() const { return identifier.storagePluginName() == cryptoPluginName; }
+        Sailfish::Crypto::Key keyReference() const {
+            return Sailfish::Crypto::Key(identifier.name(), identifier.collectionName(), identifier.storagePluginName());
+        }
+        pid_t callerPid;
+        QString connectionName;
+        QString cryptoPluginName;
+        Sailfish::Crypto::Key::Identifier identifier;
+        Sailfish::Crypto::CryptoManager::Operations operations;
+        QByteArray serializedKey; // if the key is stored outside of the crypto plugin
+        QByteArray collectionKey; // if the key is stored in the crypto plugin
+    };
+
+    enum {
+        MaxKeySessionsPerClient = 32
     };
 
     Result validateKeyIdentifier(pid_t callerPid, quint64 requestId, const Key &keyTemplate);
 
+    Result keySessionForRequest(
+            pid_t callerPid,
+            quint64 requestId,
+            const Sailfish::Crypto::Key &key,
+            Sailfish::Crypto::CryptoManager::Operation operation,
+            const QString &cryptoPluginName,
+            QVariantMap *customParameters,
+            KeySession *session) const;
+
+    void openKeySession_withKey(
+            quint64 requestId,
+            const Sailfish::Crypto::Result &result,
+            const QByteArray &serializedKey,
+            pid_t callerPid,
+            const QString &connectionName,
+            const Sailfish::Crypto::Key::Identifier &identifier,
+            Sailfish::Crypto::CryptoManager::Operations operations,
+            const QString &cryptoPluginName);
+
+    void openKeySession_withCollectionKey(
+            quint64 requestId,
+            pid_t callerPid,
+            const QString &connectionName,
+            const Sailfish::Crypto::Key::Identifier &identifier,
+            Sailfish::Crypto::CryptoManager::Operations operations,
+            const QString &cryptoPluginName,
+            const Sailfish::Crypto::Result &result,
+            const QByteArray &collectionKey);
+
+    Result insertKeySession(quint64 requestId, const KeySession &session, quint32 *keySessionToken);
+    void closeKeySessionsOfKey(const Sailfish::Crypto::Key::Identifier &identifier);
+    void closeKeySessionsOfPlugin(const QString &cryptoPluginName);
+    void closeKeySessionsOfCollection(const QString &collectionName, const QString &storagePluginName);
+
     void storedKey2(
             quint64 requestId,
             Key::Components keyComponents,
@@ -519,6 +618,40 @@ private:
             const Sailfish::Crypto::Result &result,
             const QByteArray &collectionKey);
 
+    void batchVerify_withKey(
+            quint64 requestId,
+            const Sailfish::Crypto::Result &result,
+            const QByteArray &serializedKey,
+            const QVector<QByteArray> &signatures,
+            const QVector<QByteArray> &data,
+            Sailfish::Crypto::CryptoManager::SignaturePadding padding,
+            Sailfish::Crypto::CryptoManager::DigestFunction digestFunction,
+            const QVariantMap &customParameters,
+            const QString &cryptoPluginName);
+
+    void batchVerify_withCollectionKey(
+            quint64 requestId,
+            const QVector<QByteArray> &signatures,
+            const QVector<QByteArray> &data,
+            const Sailfish::Crypto::Key &key,
+            Sailfish::Crypto::CryptoManager::SignaturePadding padding,
+            Sailfish::Crypto::CryptoManager::DigestFunction digestFunction,
+            const QVariantMap &customParameters,
+            const QString &cryptosystemProviderName,
+            const Sailfish::Crypto::Result &result,
+            const QByteArray &collectionKey);
+
+    void batchVerify_finish(
+            quint64 requestId,
+            const QVector<QByteArray> &signatures,
+            const QVector<QByteArray> &data,
+            const Sailfish::Crypto::Key &key,
+            Sailfish::Crypto::CryptoManager::SignaturePadding padding,
+            Sailfish::Crypto::CryptoManager::DigestFunction digestFunction,
+            const QVariantMap &customParameters,
+            const QString &cryptoPluginName,
+            const QByteArray &collectionKey);
+
     void encrypt_withKey(
             quint64 requestId,
             const Sailfish::Crypto::Result &result,
@@ -605,6 +738,8 @@ private:
     Sailfish::Secrets::Daemon::ApiImpl::SecretsRequestQueue *m_secrets;
     QMap<QString, Sailfish::Crypto::CryptoPlugin*> m_cryptoPlugins;
     QMap<quint64, Sailfish::Crypto::Daemon::ApiImpl::RequestProcessor::PendingRequest> m_pendingRequests;
+    QHash<quint32, Sailfish::Crypto::Daemon::ApiImpl::RequestProcessor::KeySession> m_keySessions;
+    QHash<quint64, Sailfish::Crypto::Key::Identifier> m_openingKeySessions; // by request id, until the collection locks
     bool m_autotestMode;
 };
 
@@ -10,7 +10,8 @@ HEADERS += \
     $$PWD/secrets_p.h \
     $$PWD/secretsrequestprocessor_p.h \
     $$PWD/applicationpermissions_p.h \
-    $$PWD/dataprotector_p.h
+    $$PWD/dataprotector_p.h \
+    $$PWD/kdfparametersstore_p.h
 
 SOURCES += \
     $$PWD/metadatadb.cpp \
@@ -19,7 +20,8 @@ SOURCES += \
     $$PWD/secrets.cpp \
     $$PWD/secretsrequestprocessor.cpp \
     $$PWD/applicationpermissions.cpp \
-    $$PWD/dataprotector.cpp
+    $$PWD/dataprotector.cpp \
+    $$PWD/kdfparametersstore.cpp
 
 SOURCES += \
     $$PWD/secretscryptohelpers.cpp
@@ -10,14 +10,18 @@
 
 #include <QtCore/QDir>
 #include <QtCore/QFile>
-#include <QtCore/QSaveFile>
+#include <QtCore/QPair>
+#include <QtCore/QStringList>
 #include <QtCore/QVector>
-#include <QtCore/QMap>
-#include <QtCore/QUuid>
 #include <QtCore/QSharedPointer>
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QtEndian>
 
 #include <algorithm>
 
+#include <fcntl.h>
+#include <unistd.h>
+
 /*
     Implements a data protection mechanism for sensitive sailfish-secrets data files.
 
@@ -30,20 +34,108 @@
     * Protection from major flash corruption (your system will be highly unlikely to boot anyway)
 
     How we do it:
-    The data is stored in 3 files, each of them have the same content
+    The data is stored in 3 replica files, each of them have the same content.
+    Each replica carries a header with a generation number and the length of
+    the data, and a SHA-256 digest of the header and the data, so that every
+    replica can be verified on its own.  The replicas of each generation are
+    stored in a directory named after the generation.
 
     When storing the data:
-    1. We create a new directory
-    2. We write the 3 new files (with the same content) into this directory
-    3. Finally, we delete the old data directory
+    1. We create a new directory for the next generation
+    2. We write the 3 new replicas into this directory, and then sync them all
+       (and the directory) in one batch
+    3. Finally, we delete the directories of the older generations
 
     When accessing the data:
-    1. If more than one directory exists, we assume that the store operation was incomplete,
-       so we delete all but the oldest directory
-    2. We read all files from the directory and make a majority decision about which one is correct
-    3. Return the correct file contents to the caller
+    1. We start from the newest generation, and read its replicas one at a time,
+       until one of them verifies.  Usually the first replica verifies, so only
+       a single file is read.
+    2. If none of the replicas of a generation verifies, we assume that the store
+       operation was incomplete, and fall back to the previous generation.
+    3. Directories of other generations than the one which was read are deleted,
+       as they are either incomplete or were superseded.
+
+    Directories written by older versions (named by UUID, with unchecksummed
+    replicas) are read by majority decision, and migrated to the new format.
 */
 
+namespace {
+
+const QByteArray ReplicaMagic = QByteArrayLiteral("SDP2");
+const int ReplicaHeaderSize = 4 + 8 + 4; // magic, generation, data length
+const int ReplicaDigestSize = 32;        // SHA-256
+const int ReplicaCount = 3;
+
+QString generationDirName(quint64 generation)
+{
+    return QStringLiteral("gen-%1").arg(generation, 16, 16, QLatin1Char('0'));
+}
+
+bool parseGenerationDirName(const QString &dirName, quint64 *generation)
+{
+    if (!dirName.startsWith(QLatin1String("gen-"))) {
+        return false;
+    }
+    bool ok = false;
+    *generation = dirName.mid(4).toULongLong(&ok, 16);
+    return ok;
+}
+
+QByteArray encodeReplica(quint64 generation, const QByteArray &data)
+{
+    QByteArray replica;
+    replica.reserve(ReplicaHeaderSize + data.size() + ReplicaDigestSize);
+    replica.append(ReplicaMagic);
+
+    uchar header[12];
+    qToBigEndian<quint64>(generation, header);
+    qToBigEndian<quint32>(quint32(data.size()), header + 8);
+    replica.append(reinterpret_cast<const char *>(header), sizeof(header));
+    replica.append(data);
+    replica.append(QCryptographicHash::hash(replica, QCryptographicHash::Sha256));
+    return replica;
+}
+
+bool decodeReplica(const QByteArray &replica, quint64 expectedGeneration, QByteArray *data)
+{
+    if (replica.size() < ReplicaHeaderSize + ReplicaDigestSize
+            || !replica.startsWith(ReplicaMagic)) {
+        return false;
+    }
+
+    const uchar *header = reinterpret_cast<const uchar *>(replica.constData()) + ReplicaMagic.size();
+    const quint64 generation = qFromBigEndian<quint64>(header);
+    const quint32 length = qFromBigEndian<quint32>(header + 8);
+    if (generation != expectedGeneration
+            || quint64(replica.size()) != quint64(ReplicaHeaderSize) + length + ReplicaDigestSize) {
+        return false;
+    }
+
+    const int digestOffset = ReplicaHeaderSize + int(length);
+    const QByteArray digest = QCryptographicHash::hash(
+                QByteArray::fromRawData(replica.constData(), digestOffset),
+                QCryptographicHash::Sha256);
+    if (digest != replica.mid(digestOffset)) {
+        return false;
+    }
+
+    *data = replica.mid(ReplicaHeaderSize, int(length));
+    return true;
+}
+
+bool syncDirectory(const QString &path)
+{
+    const int fd = ::open(QFile::encodeName(path).constData(), O_RDONLY | O_DIRECTORY);
+    if (fd < 0) {
+        return false;
+    }
+    const bool synced = ::fsync(fd) == 0;
+    ::close(fd);
+    return synced;
+}
+
+}
+
 namespace Sailfish {
 
 namespace Secrets {
@@ -55,6 +147,7 @@ namespace ApiImpl {
 DataProtector::DataProtector(const QString &path, QObject *parent)
     : QObject(parent)
     , m_path(path)
+    , m_generation(0)
 {
 }
 
@@ -84,23 +177,100 @@ DataProtector::Status DataProtector::getData(QByteArray *result)
         return Success;
     }
 
-    // Get all subdirectories, we want oldest first
-    QFileInfoList subdirs = dir.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Time);
+    // Get all subdirectories, we want the newest generation first,
+    // and the directories of the old format (oldest first) last.
+    QFileInfoList subdirs = dir.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Time | QDir::Reversed);
     if (subdirs.size() == 0) {
         qCDebug(lcSailfishSecretsDaemon) << "No subdirectories found by getData, so the data is empty.";
         return Success;
     }
 
-    // Keep only the oldest subdirectory, we assume it has correct data and was not already deleted
-    // because we didn't finish writing the newer ones
-    for (int i = 1; i < subdirs.size(); i++) {
-        QString subdirPath = subdirs.at(i).absoluteFilePath();
-        qCDebug(lcSailfishSecretsDaemon) << "getData is assuming incomplete data directory, deleting it:" << subdirPath;
-        dir.rmdir(subdirPath);
+    QVector<QPair<quint64, QString> > generations;
+    QStringList legacyDirPaths;
+    for (const QFileInfo &subdir : subdirs) {
+        quint64 generation = 0;
+        if (parseGenerationDirName(subdir.fileName(), &generation)) {
+            generations.append(qMakePair(generation, subdir.absoluteFilePath()));
+        } else {
+            legacyDirPaths.append(subdir.absoluteFilePath());
+        }
+    }
+    std::sort(generations.begin(), generations.end(), [](const QPair<quint64, QString> &a, const QPair<quint64, QString> &b) {
+        return a.first > b.first;
+    });
+
+    QString dataDirPath;
+    for (const QPair<quint64, QString> &generation : generations) {
+        if (readReplicas(generation.second, generation.first, &m_data)) {
+            m_generation = generation.first;
+            dataDirPath = generation.second;
+            break;
+        }
+        qCWarning(lcSailfishSecretsDaemon) << "No replica of generation" << generation.first
+                                           << "could be verified, assuming it is incomplete:" << generation.second;
+    }
+
+    bool migrate = false;
+    if (dataDirPath.isEmpty() && !legacyDirPaths.isEmpty()) {
+        // Keep only the oldest directory of the old format, we assume it has correct data
+        // and was not already deleted because we didn't finish writing the newer ones
+        Status legacyStatus = readLegacyReplicas(legacyDirPaths.first(), &m_data);
+        if (legacyStatus != Success) {
+            return legacyStatus;
+        }
+        dataDirPath = legacyDirPaths.first();
+        migrate = true;
     }
 
-    // Get the oldest data directory and examine its files
-    QString dataDirPath = subdirs.at(0).absoluteFilePath();
+    if (dataDirPath.isEmpty()) {
+        qCWarning(lcSailfishSecretsDaemon) << "Could not verify the data of any generation. Data is irretrievable.";
+        return Irretrievable;
+    }
+
+    // Delete the directories of incomplete or superseded writes
+    for (const QFileInfo &subdir : subdirs) {
+        if (subdir.absoluteFilePath() != dataDirPath) {
+            qCDebug(lcSailfishSecretsDaemon) << "getData is deleting stale data directory:" << subdir.absoluteFilePath();
+            QDir(subdir.absoluteFilePath()).removeRecursively();
+        }
+    }
+
+    *result = m_data;
+
+    if (migrate) {
+        qCDebug(lcSailfishSecretsDaemon) << "Migrating protected data to the checksummed format:" << m_path;
+        const QByteArray data = m_data;
+        Status migrateStatus = putData(data);
+        if (migrateStatus != Success) {
+            // The data was read successfully, and the old directory is still intact,
+            // so the migration may be attempted again on the next read.
+            qCWarning(lcSailfishSecretsDaemon) << "Could not migrate protected data:" << migrateStatus;
+        }
+        m_data = data;
+    }
+
+    return Success;
+}
+
+bool DataProtector::readReplicas(const QString &dataDirPath, quint64 generation, QByteArray *result) const
+{
+    for (int i = 0; i < ReplicaCount; ++i) {
+        QFile file(dataDirPath + QStringLiteral("/file%1").arg(i));
+        if (!file.open(QIODevice::ReadOnly)) {
+            // Loss of any individual file here doesn't yet necessarily mean an error
+            qCWarning(lcSailfishSecretsDaemon) << "can't open file:" << file.fileName();
+            continue;
+        }
+        if (decodeReplica(file.readAll(), generation, result)) {
+            return true;
+        }
+        qCWarning(lcSailfishSecretsDaemon) << "Replica failed verification:" << file.fileName();
+    }
+    return false;
+}
+
+DataProtector::Status DataProtector::readLegacyReplicas(const QString &dataDirPath, QByteArray *result) const
+{
     QDir dataDir(dataDirPath);
     QFileInfoList filesInDataDir = dataDir.entryInfoList(QDir::Files);
 
@@ -144,9 +314,9 @@ DataProtector::Status DataProtector::getData(QByteArray *result)
         return file->readAll();
     });
 
-    std::remove_if(fileContents.begin(), fileContents.end(), [](QByteArray &byteArray) {
+    fileContents.erase(std::remove_if(fileContents.begin(), fileContents.end(), [](QByteArray &byteArray) {
         return byteArray.isEmpty();
-    });
+    }), fileContents.end());
 
     //  If none of the files could be read, again we are unlucky
     if (fileContents.size() == 0) {
@@ -180,9 +350,7 @@ DataProtector::Status DataProtector::getData(QByteArray *result)
         return Irretrievable;
     }
 
-    m_data = fileContents[maxOccourenceIndex];
-    *result = m_data;
-
+    *result = fileContents[maxOccourenceIndex];
     return Success;
 }
 
@@ -200,54 +368,79 @@ DataProtector::Status DataProtector::putData(const QByteArray &bytes)
         qCDebug(lcSailfishSecretsDaemon) << "Protected root directory didn't exist, so putData assumes the data is empty.";
     }
 
-    // Get list of old directories, these will be deleted at the end
+    // Get list of old directories, these will be deleted at the end.
+    // The new generation follows the newest one which exists, even if that
+    // one is incomplete, so that a generation is never written twice.
     QFileInfoList oldDirectories = dir.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot);
+    quint64 newGeneration = m_generation + 1;
+    for (const QFileInfo &fileInfo : oldDirectories) {
+        quint64 generation = 0;
+        if (parseGenerationDirName(fileInfo.fileName(), &generation) && generation >= newGeneration) {
+            newGeneration = generation + 1;
+        }
+    }
 
     // Create new data directory
-    QString dataDirName = QUuid::createUuid().toString().remove('{').remove('}');
-    QString dataDirPath = m_path + QStringLiteral("/") + dataDirName;
+    QString dataDirPath = m_path + QStringLiteral("/") + generationDirName(newGeneration);
     if (!dir.mkdir(dataDirPath)) {
         qCWarning(lcSailfishSecretsDaemon) << "Can't create data directory when writing new data:" << dataDirPath;
         return ErrorCannotCreateDirectory;
     }
 
-    // Create redundant files in new data directory
-    QVector<QString> dataFilePaths = {
-        dataDirPath + QStringLiteral("/file0"),
-        dataDirPath + QStringLiteral("/file1"),
-        dataDirPath + QStringLiteral("/file2"),
+    // Write the redundant replicas.  They are not renamed into place, as a
+    // replica which was not completely written will fail verification,
+    // so they only need to be synced (all together) before the old data is removed.
+    // If any step fails, the new generation is removed again: as the newest
+    // generation which verifies is preferred when reading, a write which was
+    // reported as failed must not be able to replace the last good data.
+    const QByteArray replica = encodeReplica(newGeneration, bytes);
+    QVector<QSharedPointer<QFile> > files;
+    auto discardNewGeneration = [&files, &dataDirPath] () {
+        for (QSharedPointer<QFile> &file : files) {
+            file->close();
+        }
+        if (!QDir(dataDirPath).removeRecursively()) {
+            qCWarning(lcSailfishSecretsDaemon) << "Could not remove data directory after failing to write new data:" << dataDirPath;
+        }
     };
-    QVector<QSharedPointer<QSaveFile> > files;
-    std::transform(dataFilePaths.begin(), dataFilePaths.end(), std::back_inserter(files), [](const QString &filePath) {
-        return QSharedPointer<QSaveFile>(new QSaveFile(filePath));
-    });
 
-    bool allOpen = std::all_of(files.begin(), files.end(), [](QSharedPointer<QSaveFile> &file) {
-        bool isOpen = file->open(QIODevice::WriteOnly);
-        if (!isOpen) {
+    for (int i = 0; i < ReplicaCount; ++i) {
+        QSharedPointer<QFile> file(new QFile(dataDirPath + QStringLiteral("/file%1").arg(i)));
+        files.append(file);
+        if (!file->open(QIODevice::WriteOnly | QIODevice::Unbuffered)) {
             qCWarning(lcSailfishSecretsDaemon) << "Can't open file for writing:" << file->fileName();
+            discardNewGeneration();
+            return ErrorCannotOpenFile;
         }
-        return isOpen;
-    });
-
-    if (!allOpen) {
-        qCWarning(lcSailfishSecretsDaemon) << "Not all files could be open for writing.";
-        return ErrorCannotOpenFile;
-    }
-
-    // Write redundant data
-    for (QSharedPointer<QSaveFile> &file : files) {
-        qint64 bytesWritten = file->write(bytes);
-        if (bytesWritten != bytes.size()) {
+        qint64 bytesWritten = file->write(replica);
+        if (bytesWritten != replica.size()) {
             qCWarning(lcSailfishSecretsDaemon) << "Can't write file:" << file->fileName();
+            discardNewGeneration();
             return ErrorCannotWriteFile;
         }
-        if (!file->commit()) {
-            qCWarning(lcSailfishSecretsDaemon) << "Could not commit file:" << file->fileName();
+    }
+
+    for (QSharedPointer<QFile> &file : files) {
+        if (::fdatasync(file->handle()) != 0) {
+            qCWarning(lcSailfishSecretsDaemon) << "Could not sync file:" << file->fileName();
+            discardNewGeneration();
             return ErrorCannotWriteFile;
         }
+        file->close();
     }
 
+    if (!syncDirectory(dataDirPath) || !syncDirectory(m_path)) {
+        qCWarning(lcSailfishSecretsDaemon) << "Could not sync data directory:" << dataDirPath;
+        discardNewGeneration();
+        syncDirectory(m_path);
+        return ErrorCannotWriteFile;
+    }
+
+    // The new data is now committed.  Clear in-memory data, so it gets
+    // refreshed on next call.
+    m_data.clear();
+    m_generation = newGeneration;
+
     // Remove old data directories
     for (QFileInfo &fileInfo : oldDirectories) {
         QDir oldDataDir(fileInfo.absoluteFilePath());
@@ -257,8 +450,6 @@ DataProtector::Status DataProtector::putData(const QByteArray &bytes)
         }
     }
 
-    // Clear in-memory data, so it gets refreshed on next call
-    m_data.clear();
     return Success;
 }
 
@@ -47,8 +47,12 @@ public:
     Q_INVOKABLE Status putData(const QByteArray &bytes);
 
 private:
+    bool readReplicas(const QString &dataDirPath, quint64 generation, QByteArray *result) const;
+    Status readLegacyReplicas(const QString &dataDirPath, QByteArray *result) const;
+
     QString m_path;
     QByteArray m_data;
+    quint64 m_generation;
 
 };
 
@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2018 Jolla Ltd.
+ * Contact: Chris Adams <chris.adams@jollamobile.com>
+ * All rights reserved.
+ * BSD 3-Clause License, see LICENSE.
+ */
+
+#include "../logging_p.h"
+#include "kdfparametersstore_p.h"
+
+#include <QtCore/QDataStream>
+#include <QtCore/QDir>
+
+using namespace Sailfish::Secrets::Daemon::ApiImpl;
+
+KdfParametersStore::KdfParametersStore(const QString &secretsDirPath, bool autotestMode)
+    : m_secretsDirPath(secretsDirPath)
+    , m_autotestMode(autotestMode)
+{
+}
+
+QString KdfParametersStore::dataDirPath(const QString &baseName) const
+{
+    QDir secretsDir(m_secretsDirPath);
+    if (!secretsDir.mkpath(m_secretsDirPath)) {
+        qCWarning(lcSailfishSecretsDaemon) << "Permissions error: unable to create secrets directory:" << m_secretsDirPath;
+        return QString();
+    }
+
+    return secretsDir.absoluteFilePath(m_autotestMode
+                                       ? baseName + QLatin1String("-test")
+                                       : baseName);
+}
+
+DataProtector::Status KdfParametersStore::readMasterLockParameters(MasterLockKdfParameters *parameters) const
+{
+    const QString path = dataDirPath(QStringLiteral("kdfparameters"));
+    if (path.isEmpty()) {
+        return DataProtector::ErrorCannotCreateDirectory;
+    }
+
+    DataProtector dataProtector(path);
+    QByteArray kdfData;
+    const DataProtector::Status s = dataProtector.getData(&kdfData);
+    if (s != DataProtector::Success) {
+        return s;
+    }
+
+    *parameters = MasterLockKdfParameters::legacy();
+    if (!kdfData.isEmpty()) {
+        const QList<QByteArray> fields = kdfData.split('\n');
+        const MasterLockKdfParameters stored(fields.value(0).toInt(), fields.value(1).toInt());
+        if (stored.isValid()) {
+            *parameters = stored;
+        } else {
+            qCWarning(lcSailfishSecretsDaemon) << "readMasterLockParameters: ignoring invalid key derivation parameters";
+        }
+    }
+    return DataProtector::Success;
+}
+
+bool KdfParametersStore::writeMasterLockParameters(const MasterLockKdfParameters &parameters) const
+{
+    const QString path = dataDirPath(QStringLiteral("kdfparameters"));
+    if (path.isEmpty()) {
+        return false;
+    }
+
+    DataProtector dataProtector(path);
+    const DataProtector::Status s = dataProtector.putData(
+                QByteArray::number(parameters.bookkeepingIterations) + '\n'
+                + QByteArray::number(parameters.deviceLockIterations));
+    if (s != DataProtector::Success) {
+        qCWarning(lcSailfishSecretsDaemon) << "writeMasterLockParameters: Can't write key derivation parameters. DataProtector returned:" << s;
+        return false;
+    }
+    return true;
+}
+
+bool KdfParametersStore::replaceMasterLockParameters(
+        const MasterLockKdfParameters &parameters,
+        const std::function<bool()> &commit) const
+{
+    MasterLockKdfParameters previousParameters;
+    if (readMasterLockParameters(&previousParameters) != DataProtector::Success) {
+        previousParameters = MasterLockKdfParameters();
+    }
+
+    if (!writeMasterLockParameters(parameters)) {
+        return false;
+    }
+
+    if (!commit()) {
+        if (previousParameters.isValid() && !writeMasterLockParameters(previousParameters)) {
+            qCWarning(lcSailfishSecretsDaemon) << "replaceMasterLockParameters: Can't restore the previous key derivation parameters";
+        }
+        return false;
+    }
+    return true;
+}
+
+DataProtector::Status KdfParametersStore::readCollectionParameters(QMap<QString, QVariantMap> *parameters) const
+{
+    const QString path = dataDirPath(QStringLiteral("collectionkdfparameters"));
+    if (path.isEmpty()) {
+        return DataProtector::ErrorCannotCreateDirectory;
+    }
+
+    DataProtector dataProtector(path);
+    QByteArray kdfData;
+    const DataProtector::Status s = dataProtector.getData(&kdfData);
+    if (s != DataProtector::Success) {
+        return s;
+    }
+
+    parameters->clear();
+    if (!kdfData.isEmpty()) {
+        QDataStream in(kdfData);
+        in >> *parameters;
+        if (in.status() != QDataStream::Ok) {
+            qCWarning(lcSailfishSecretsDaemon) << "readCollectionParameters: ignoring invalid key derivation parameters";
+            parameters->clear();
+        }
+    }
+    return DataProtector::Success;
+}
+
+bool KdfParametersStore::writeCollectionParameters(const QMap<QString, QVariantMap> &parameters) const
+{
+    const QString path = dataDirPath(QStringLiteral("collectionkdfparameters"));
+    if (path.isEmpty()) {
+        return false;
+    }
+
+    QByteArray kdfData;
+    QDataStream out(&kdfData, QIODevice::WriteOnly);
+    out << parameters;
+
+    DataProtector dataProtector(path);
+    const DataProtector::Status s = dataProtector.putData(kdfData);
+    if (s != DataProtector::Success) {
+        qCWarning(lcSailfishSecretsDaemon) << "writeCollectionParameters: Can't write key derivation parameters. DataProtector returned:" << s;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2018 Jolla Ltd.
+ * Contact: Chris Adams <chris.adams@jollamobile.com>
+ * All rights reserved.
+ * BSD 3-Clause License, see LICENSE.
+ */
+
+#ifndef SAILFISHSECRETS_APIIMPL_KDFPARAMETERSSTORE_P_H
+#define SAILFISHSECRETS_APIIMPL_KDFPARAMETERSSTORE_P_H
+
+#include "dataprotector_p.h"
+
+#include <QtCore/QMap>
+#include <QtCore/QString>
+#include <QtCore/QVariantMap>
+
+#include <functional>
+
+namespace Sailfish {
+
+namespace Secrets {
+
+namespace Daemon {
+
+namespace ApiImpl {
+
+// The PBKDF2 iteration counts used to derive the bookkeeping database key
+// and the device lock key from the master lock code.  These are calibrated
+// for the device whenever the master lock code is changed.
+struct MasterLockKdfParameters
+{
+    // keys derived before calibration was introduced used fixed costs.
+    enum {
+        LegacyBookkeepingIterations = 12000,
+        LegacyDeviceLockIterations = 16000
+    };
+
+    MasterLockKdfParameters(int bookkeeping = 0, int deviceLock = 0)
+        : bookkeepingIterations(bookkeeping), deviceLockIterations(deviceLock) {}
+    bool isValid() const { return bookkeepingIterations > 0 && deviceLockIterations > 0; }
+    bool operator==(const MasterLockKdfParameters &other) const {
+        return bookkeepingIterations == other.bookkeepingIterations
+                && deviceLockIterations == other.deviceLockIterations;
+    }
+
+    static MasterLockKdfParameters legacy() {
+        return MasterLockKdfParameters(LegacyBookkeepingIterations, LegacyDeviceLockIterations);
+    }
+
+    int bookkeepingIterations;
+    int deviceLockIterations;
+};
+
+// Persists the key derivation parameters calibrated for the device: those
+// of the master lock code, and those used for new custom lock collections
+// (per encryption plugin).  Both are stored next to each other in the
+// secrets directory, so that calibration is not repeated after the daemon
+// restarts.  The parameters of existing collections are stored in their
+// metadata instead, and are not affected by recalibration.
+class KdfParametersStore
+{
+public:
+    KdfParametersStore(const QString &secretsDirPath, bool autotestMode);
+
+    DataProtector::Status readMasterLockParameters(MasterLockKdfParameters *parameters) const;
+    bool writeMasterLockParameters(const MasterLockKdfParameters &parameters) const;
+    // Writes the given parameters and then calls commit, which stores the data
+    // that depends upon them.  If commit fails, the previous parameters are restored.
+    bool replaceMasterLockParameters(const MasterLockKdfParameters &parameters,
+                                     const std::function<bool()> &commit) const;
+
+    // An empty map of parameters means the default key derivation of the
+    // plugin, which is distinct from the plugin not being calibrated at all.
+    DataProtector::Status readCollectionParameters(QMap<QString, QVariantMap> *parameters) const;
+    bool writeCollectionParameters(const QMap<QString, QVariantMap> &parameters) const;
+
+private:
+    QString dataDirPath(const QString &baseName) const;
+
+    QString m_secretsDirPath;
+    bool m_autotestMode;
+};
+
+} // ApiImpl
+
+} // Daemon
+
+} // Secrets
+
+} // Sailfish
+
+#endif // SAILFISHSECRETS_APIIMPL_KDFPARAMETERSSTORE_P_H
@@ -8,6 +8,8 @@
 #include "metadatadb_p.h"
 #include "controller_p.h"
 
+#include <QtCore/QDataStream>
+
 using namespace Sailfish::Secrets;
 
 // arg %1 must be a 64-character hex string = 32 byte key.
@@ -43,6 +45,7 @@ static const char *createCollectionsTable =
         "   AuthenticationPluginName TEXT NOT NULL,"
         "   UnlockSemantic INTEGER NOT NULL,"
         "   AccessControlMode INTEGER NOT NULL,"
+        "   KdfParameters BLOB,"
         "   CONSTRAINT collectionNameUnique UNIQUE (CollectionName));";
 
 static const char *createSecretsTable =
@@ -68,11 +71,44 @@ static const char *createStatements[] =
     NULL
 };
 
+static const char *upgradeVersion1[] = {
+    "\n ALTER TABLE Collections ADD COLUMN KdfParameters BLOB;",
+    "\n PRAGMA user_version=2;",
+    0
+};
+
 static Daemon::Sqlite::UpgradeOperation upgradeVersions[] = {
+    { 0, upgradeVersion1 },
     { 0, 0 },
 };
 
-static const int currentSchemaVersion = 1;
+static const int currentSchemaVersion = 2;
+
+namespace {
+
+// The key derivation parameters of a collection are stored serialized,
+// and an empty value means the plugin's default derivation.
+QByteArray serializeKdfParameters(const QVariantMap &parameters)
+{
+    QByteArray data;
+    if (!parameters.isEmpty()) {
+        QDataStream out(&data, QIODevice::WriteOnly);
+        out << parameters;
+    }
+    return data;
+}
+
+QVariantMap deserializeKdfParameters(const QByteArray &data)
+{
+    QVariantMap parameters;
+    if (!data.isEmpty()) {
+        QDataStream in(data);
+        in >> parameters;
+    }
+    return parameters;
+}
+
+}
 
 Daemon::ApiImpl::MetadataDatabase::MetadataDatabase(
         const QString &defaultEncryptionPluginName,
@@ -160,6 +196,11 @@ bool Daemon::ApiImpl::MetadataDatabase::isOpen() const
     return m_db.isOpen();
 }
 
+void Daemon::ApiImpl::MetadataDatabase::clearPreparedQueries()
+{
+    m_db.clearPreparedQueries();
+}
+
 bool Daemon::ApiImpl::MetadataDatabase::beginTransaction()
 {
     return m_db.beginTransaction();
@@ -316,10 +357,11 @@ Daemon::ApiImpl::MetadataDatabase::insertCollectionMetadata(
                   "EncryptionPluginName,"
                   "AuthenticationPluginName,"
                   "UnlockSemantic,"
-                  "AccessControlMode"
+                  "AccessControlMode,"
+                  "KdfParameters"
                 ")"
                 " VALUES ("
-                  "?,?,?,?,?,?,?"
+                  "?,?,?,?,?,?,?,?"
                 ");");
 
     QString errorText;
@@ -336,7 +378,8 @@ Daemon::ApiImpl::MetadataDatabase::insertCollectionMetadata(
             << metadata.encryptionPluginName
             << metadata.authenticationPluginName
             << metadata.unlockSemantic
-            << static_cast<int>(metadata.accessControlMode);
+            << static_cast<int>(metadata.accessControlMode)
+            << serializeKdfParameters(metadata.kdfParameters);
     iq.bindValues(ivalues);
 
     if (!m_db.execute(iq, &errorText)) {
@@ -431,7 +474,8 @@ Daemon::ApiImpl::MetadataDatabase::collectionMetadata(
                     " EncryptionPluginName,"
                     " AuthenticationPluginName,"
                     " UnlockSemantic,"
-                    " AccessControlMode"
+                    " AccessControlMode,"
+                    " KdfParameters"
                   " FROM Collections"
                   " WHERE CollectionName = ?;"
              );
@@ -461,6 +505,7 @@ Daemon::ApiImpl::MetadataDatabase::collectionMetadata(
         metadata->authenticationPluginName = sq.value(3).value<QString>();
         metadata->unlockSemantic = sq.value(4).value<int>();
         metadata->accessControlMode = static_cast<SecretManager::AccessControlMode>(sq.value(5).value<int>());
+        metadata->kdfParameters = deserializeKdfParameters(sq.value(6).value<QByteArray>());
     }
 
     return Result(Result::Succeeded);
@@ -20,6 +20,7 @@
 #include <QtCore/QString>
 #include <QtCore/QVector>
 #include <QtCore/QByteArray>
+#include <QtCore/QVariantMap>
 
 namespace Sailfish {
 
@@ -41,6 +42,7 @@ public:
     QString authenticationPluginName;
     int unlockSemantic;
     Sailfish::Secrets::SecretManager::AccessControlMode accessControlMode;
+    QVariantMap kdfParameters; // empty for the plugin's default key derivation
 };
 
 class SecretMetadata
@@ -70,6 +72,7 @@ public:
 
     bool isOpen() const;
     bool openDatabase(const QByteArray &hexKey);
+    void clearPreparedQueries();
     QString errorMessage() const;
 
     bool beginTransaction();
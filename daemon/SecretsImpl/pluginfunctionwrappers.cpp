@@ -7,10 +7,85 @@
 
 #include "pluginfunctionwrappers_p.h"
 #include "logging_p.h"
+#include "plugincallstatistics_p.h"
+
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QElapsedTimer>
+
+#include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlQuery>
+#include <QtSql/QSqlError>
 
 using namespace Sailfish::Secrets;
 using namespace Sailfish::Secrets::Daemon::ApiImpl;
 
+namespace {
+
+// The bounds of the calibrated PBKDF2 cost of custom lock collection keys.
+// Those keys were derived with 10000 iterations before the cost was
+// calibrated, and calibration never chooses a lower cost.
+const int MinimumCollectionKdfIterations = 10000;
+const int MaximumCollectionKdfIterations = 4000000;
+
+// Times key derivations by the given plugin, and returns the PBKDF2
+// parameters with which deriving a key takes the target time.  Returns
+// empty parameters, meaning the plugin's default key derivation, if the
+// plugin does not support PBKDF2 parameters.
+template <typename Plugin>
+QVariantMap calibrateKdfParameters(Plugin *plugin, const QByteArray &salt, int targetMsecs)
+{
+    QVariantMap parameters;
+    parameters.insert(QStringLiteral("keyDerivationFunction"), QStringLiteral("pbkdf2"));
+
+    // time derivations with increasing cost until the measurement is
+    // long enough not to be dominated by the call overhead.
+    int iterations = 1000;
+    qint64 elapsedNsecs = 0;
+    forever {
+        parameters.insert(QStringLiteral("iterations"), iterations);
+        QByteArray key;
+        QElapsedTimer timer;
+        timer.start();
+        const Result result = plugin->deriveKeyFromCodeWithParameters(
+                    QByteArrayLiteral("calibration"), salt, parameters, &key);
+        elapsedNsecs = timer.nsecsElapsed();
+        if (result.code() != Result::Succeeded) {
+            qCDebug(lcSailfishSecretsDaemon) << "Plugin" << plugin->name()
+                                             << "uses its default collection key derivation:"
+                                             << result.errorMessage();
+            return QVariantMap();
+        }
+        if (elapsedNsecs >= 20000000 || iterations >= 16000) {
+            break;
+        }
+        iterations *= 4;
+    }
+
+    const qint64 calibrated = qBound<qint64>(MinimumCollectionKdfIterations,
+                                             iterations * qint64(targetMsecs) * 1000000 / qMax<qint64>(elapsedNsecs, 1),
+                                             MaximumCollectionKdfIterations);
+    parameters.insert(QStringLiteral("iterations"), int(calibrated / 1000 * 1000));
+    qCDebug(lcSailfishSecretsDaemon) << "Calibrated collection key derivation for plugin" << plugin->name()
+                                     << ":" << parameters.value(QStringLiteral("iterations")).toInt()
+                                     << "iterations for" << targetMsecs << "ms";
+    return parameters;
+}
+
+template <typename Plugin>
+DerivedKeyResult calibrateAndDeriveKey(
+        Plugin *plugin,
+        const QByteArray &authenticationCode,
+        const QByteArray &salt,
+        int targetMsecs)
+{
+    const QVariantMap parameters = calibrateKdfParameters(plugin, salt, targetMsecs);
+    QByteArray key;
+    Result result = plugin->deriveKeyFromCodeWithParameters(authenticationCode, salt, parameters, &key);
+    return DerivedKeyResult(result, key, parameters);
+}
+
+}
+
 /* These methods are to be called via QtConcurrent */
 
 PluginState Daemon::ApiImpl::pluginState(PluginBase *plugin)
@@ -18,6 +93,94 @@ PluginState Daemon::ApiImpl::pluginState(PluginBase *plugin)
     return PluginState(plugin->isAvailable(), plugin->isLocked());
 }
 
+QString Daemon::ApiImpl::calculateSecretNameHash(const Secret::Identifier &ident)
+{
+    return QString::fromLatin1(
+            QCryptographicHash::hash(
+                QStringLiteral("%1%2%3")
+                    .arg(ident.storagePluginName(),
+                         ident.collectionName(),
+                         ident.name()).toUtf8(),
+                QCryptographicHash::Sha512).toBase64());
+}
+
+CollectionSearchResult Daemon::ApiImpl::findSecretsInCollections(
+        StoragePluginWrapper *storagePlugin,
+        EncryptedStoragePluginWrapper *encryptedStoragePlugin,
+        const QString &callerApplicationId,
+        const QSet<QString> &unlockedCollectionHashes,
+        const Secret::FilterData &filter,
+        StoragePlugin::FilterOperator filterOperator,
+        StoragePlugin::FilterMatch filterMatch)
+{
+    PluginWrapper *plugin = storagePlugin
+            ? static_cast<PluginWrapper*>(storagePlugin)
+            : static_cast<PluginWrapper*>(encryptedStoragePlugin);
+    PluginCallScope scope(plugin, "findSecretsInCollections");
+    CollectionSearchResult searchResult(Result(Result::Succeeded));
+    const QString pluginName = plugin->name();
+
+    QVariantMap cnamesMap;
+    Result result = plugin->collectionNames(&cnamesMap);
+    if (result.code() != Result::Succeeded) {
+        // report the whole plugin as skipped, so that other plugins
+        // can still contribute to the search results.
+        searchResult.skippedCollections.append(
+                Secret::Identifier(QString(), QString(), pluginName));
+        searchResult.skippedCollectionResults.append(result);
+        return scope.result(searchResult);
+    }
+
+    for (QVariantMap::const_iterator it = cnamesMap.constBegin(); it != cnamesMap.constEnd(); ++it) {
+        const QString &cname = it.key();
+        if (cname.compare(QStringLiteral("standalone"), Qt::CaseInsensitive) == 0) {
+            continue;
+        }
+
+        CollectionMetadata metadata;
+        result = plugin->collectionMetadata(cname, &metadata);
+        if (result.code() == Result::Succeeded) {
+            if (metadata.accessControlMode == SecretManager::SystemAccessControlMode) {
+                result = Result(Result::OperationNotSupportedError,
+                                QLatin1String("Access control requests are not currently supported. TODO!"));
+            } else if (metadata.accessControlMode == SecretManager::OwnerOnlyMode
+                       && metadata.ownerApplicationId != callerApplicationId) {
+                result = Result(Result::PermissionsError,
+                                QString::fromLatin1("Collection %1 is owned by a different application")
+                                .arg(cname));
+            } else if (encryptedStoragePlugin
+                       ? it.value().toBool()
+                       : !unlockedCollectionHashes.contains(calculateSecretNameHash(
+                                 Secret::Identifier(QString(), cname, pluginName)))) {
+                result = Result(Result::CollectionIsLockedError,
+                                QString::fromLatin1("Collection %1 is locked")
+                                .arg(cname));
+            } else if (encryptedStoragePlugin) {
+                QVector<Secret::Identifier> identifiers;
+                result = encryptedStoragePlugin->findSecrets(cname, filter, filterOperator, filterMatch, &identifiers);
+                if (result.code() == Result::Succeeded) {
+                    searchResult.identifiers << identifiers;
+                }
+            } else {
+                QStringList secretNames;
+                result = storagePlugin->findSecrets(cname, filter, filterOperator, filterMatch, &secretNames);
+                if (result.code() == Result::Succeeded) {
+                    for (const QString &secretName : secretNames) {
+                        searchResult.identifiers.append(Secret::Identifier(secretName, cname, pluginName));
+                    }
+                }
+            }
+        }
+
+        if (result.code() != Result::Succeeded) {
+            searchResult.skippedCollections.append(Secret::Identifier(QString(), cname, pluginName));
+            searchResult.skippedCollectionResults.append(result);
+        }
+    }
+
+    return scope.result(searchResult);
+}
+
 FoundLockStatusResult Daemon::ApiImpl::queryLockSpecificPlugin(
         const QMap<QString, Sailfish::Secrets::EncryptionPlugin*> &encryptionPlugins,
         const QMap<QString, StoragePluginWrapper*> &storagePlugins,
@@ -250,6 +413,68 @@ bool Daemon::ApiImpl::masterUnlockPlugins(
     return allSucceeded;
 }
 
+// Releases the memory cached by the SQLite connections of this thread,
+// i.e. the metadata databases of the plugin wrappers, as well as the
+// databases opened by the storage plugins themselves.
+// Returns the number of database connections which were shrunk.
+int Daemon::ApiImpl::releaseDatabaseMemory(
+        const QList<StoragePluginWrapper*> &storagePlugins,
+        const QList<EncryptedStoragePluginWrapper*> &encryptedStoragePlugins)
+{
+    for (StoragePluginWrapper *splugin : storagePlugins) {
+        splugin->releaseCachedQueries();
+    }
+    for (EncryptedStoragePluginWrapper *esplugin : encryptedStoragePlugins) {
+        esplugin->releaseCachedQueries();
+    }
+
+    // The plugins' own prepared queries are not accessible via the plugin
+    // API, but each connection's page cache can be released via SQL.
+    int shrunk = 0;
+    for (const QString &connectionName : QSqlDatabase::connectionNames()) {
+        QSqlDatabase db = QSqlDatabase::database(connectionName, false);
+        if (db.isOpen()) {
+            QSqlQuery query(db);
+            if (query.exec(QStringLiteral("PRAGMA shrink_memory"))) {
+                shrunk++;
+            } else {
+                qCDebug(lcSailfishSecretsDaemon) << "Unable to shrink memory of database connection:"
+                                                 << connectionName << query.lastError().text();
+            }
+        }
+    }
+    return shrunk;
+}
+
+// Returns true if any in-memory storage plugin holds a collection,
+// which would be lost if the daemon exited.
+bool Daemon::ApiImpl::holdsInMemoryCollections(
+        const QList<StoragePluginWrapper*> &storagePlugins,
+        const QList<EncryptedStoragePluginWrapper*> &encryptedStoragePlugins)
+{
+    QList<PluginWrapper*> plugins;
+    for (StoragePluginWrapper *splugin : storagePlugins) {
+        if (splugin->storageType() == StoragePlugin::InMemoryStorage) {
+            plugins.append(splugin);
+        }
+    }
+    for (EncryptedStoragePluginWrapper *esplugin : encryptedStoragePlugins) {
+        if (esplugin->storageType() == StoragePlugin::InMemoryStorage) {
+            plugins.append(esplugin);
+        }
+    }
+
+    for (PluginWrapper *plugin : plugins) {
+        QVariantMap cnames;
+        if (plugin->collectionNames(&cnames).code() != Result::Succeeded
+                || !cnames.isEmpty()) {
+            // if in doubt, assume that the plugin holds data.
+            return true;
+        }
+    }
+    return false;
+}
+
 bool Daemon::ApiImpl::modifyMasterLockPlugins(
         const QList<StoragePluginWrapper*> &storagePlugins,
         const QList<EncryptedStoragePluginWrapper*> &encryptedStoragePlugins,
@@ -300,6 +525,7 @@ IdentifiersResult Daemon::ApiImpl::storedKeyIdentifiers(
         if (result->code() != Result::Succeeded) {
             return;
         }
+        const QString pluginName = p->name();
         for (const QString &cname : cnames) {
             knames.clear();
             *result = p->keyNames(cname, customParameters, &knames);
@@ -313,7 +539,7 @@ IdentifiersResult Daemon::ApiImpl::storedKeyIdentifiers(
             }
             for (const QString &kname : knames) {
                 idents->append(Secret::Identifier(
-                        kname, cname, p->name()));
+                        kname, cname, pluginName));
             }
         }
     };
@@ -358,9 +584,11 @@ IdentifiersResult Daemon::ApiImpl::storedKeyIdentifiersFromCollection(
             *result = p->keyNames(cname, customParameters, &knames);
         }
         if (result->code() == Result::Succeeded && idents) {
+            const QString pluginName = p->name();
+            idents->reserve(idents->size() + knames.size());
             for (const QString &kname : knames) {
                 idents->append(Secret::Identifier(
-                        kname, cname, p->name()));
+                        kname, cname, pluginName));
             }
         }
     };
@@ -430,18 +658,21 @@ IdentifiersResult Daemon::ApiImpl::storedKeyIdentifiersFromCollection(
 
 bool EncryptionPluginFunctionWrapper::isLocked(EncryptionPlugin *plugin)
 {
+    PluginCallScope scope(plugin, "isLocked");
     return plugin->isLocked();
 }
 
 bool EncryptionPluginFunctionWrapper::lock(EncryptionPlugin *plugin)
 {
-    return plugin->lock();
+    PluginCallScope scope(plugin, "lock");
+    return scope.result(plugin->lock());
 }
 
 bool EncryptionPluginFunctionWrapper::unlock(EncryptionPlugin *plugin,
                                      const QByteArray &lockCode)
 {
-    return plugin->unlock(lockCode);
+    PluginCallScope scope(plugin, "unlock");
+    return scope.result(plugin->unlock(lockCode));
 }
 
 bool setLockCode(EncryptionPlugin *plugin,
@@ -455,11 +686,24 @@ DerivedKeyResult
 EncryptionPluginFunctionWrapper::deriveKeyFromCode(
         EncryptionPlugin *plugin,
         const QByteArray &authenticationCode,
-        const QByteArray &salt)
+        const QByteArray &salt,
+        const QVariantMap &kdfParameters)
 {
+    PluginCallScope scope(plugin, "deriveKeyFromCode", authenticationCode.size());
     QByteArray key;
-    Result result = plugin->deriveKeyFromCode(authenticationCode, salt, &key);
-    return DerivedKeyResult(result, key);
+    Result result = plugin->deriveKeyFromCodeWithParameters(authenticationCode, salt, kdfParameters, &key);
+    return scope.result(DerivedKeyResult(result, key, kdfParameters));
+}
+
+DerivedKeyResult
+EncryptionPluginFunctionWrapper::calibrateAndDeriveKeyFromCode(
+        EncryptionPlugin *plugin,
+        const QByteArray &authenticationCode,
+        const QByteArray &salt,
+        int targetMsecs)
+{
+    PluginCallScope scope(plugin, "calibrateAndDeriveKeyFromCode", authenticationCode.size());
+    return scope.result(calibrateAndDeriveKey(plugin, authenticationCode, salt, targetMsecs));
 }
 
 EncryptionPluginFunctionWrapper::DataResult
@@ -468,9 +712,11 @@ EncryptionPluginFunctionWrapper::encryptSecret(
         const QByteArray &plaintext,
         const QByteArray &key)
 {
+    PluginCallScope scope(plugin, "encryptSecret", plaintext.size());
     QByteArray ciphertext;
     Result result = plugin->encryptSecret(plaintext, key, &ciphertext);
-    return EncryptionPluginFunctionWrapper::DataResult(result, ciphertext);
+    scope.setBytesOut(ciphertext.size());
+    return scope.result(EncryptionPluginFunctionWrapper::DataResult(result, ciphertext));
 }
 
 EncryptionPluginFunctionWrapper::DataResult
@@ -479,26 +725,31 @@ EncryptionPluginFunctionWrapper::decryptSecret(
         const QByteArray &encrypted,
         const QByteArray &key)
 {
+    PluginCallScope scope(plugin, "decryptSecret", encrypted.size());
     QByteArray plaintext;
     Result result = plugin->decryptSecret(encrypted, key, &plaintext);
-    return EncryptionPluginFunctionWrapper::DataResult(result, plaintext);
+    scope.setBytesOut(plaintext.size());
+    return scope.result(EncryptionPluginFunctionWrapper::DataResult(result, plaintext));
 }
 
 bool StoragePluginFunctionWrapper::isLocked(StoragePluginWrapper *plugin)
 {
+    PluginCallScope scope(plugin, "isLocked");
     return plugin->isLocked();
 }
 
 bool StoragePluginFunctionWrapper::lock(StoragePluginWrapper *plugin)
 {
-    return plugin->lock();
+    PluginCallScope scope(plugin, "lock");
+    return scope.result(plugin->lock());
 }
 
 bool StoragePluginFunctionWrapper::unlock(
         StoragePluginWrapper *plugin,
         const QByteArray &lockCode)
 {
-    return plugin->unlock(lockCode);
+    PluginCallScope scope(plugin, "unlock");
+    return scope.result(plugin->unlock(lockCode));
 }
 
 bool StoragePluginFunctionWrapper::setLockCode(
@@ -506,16 +757,18 @@ bool StoragePluginFunctionWrapper::setLockCode(
         const QByteArray &oldLockCode,
         const QByteArray &newLockCode)
 {
-    return plugin->setLockCode(oldLockCode, newLockCode);
+    PluginCallScope scope(plugin, "setLockCode");
+    return scope.result(plugin->setLockCode(oldLockCode, newLockCode));
 }
 
 CollectionMetadataResult StoragePluginFunctionWrapper::collectionMetadata(
         StoragePluginWrapper *plugin,
         const QString &collectionName)
 {
+    PluginCallScope scope(plugin, "collectionMetadata");
     CollectionMetadata metadata;
     Result result = plugin->collectionMetadata(collectionName, &metadata);
-    return CollectionMetadataResult(result, metadata);
+    return scope.result(CollectionMetadataResult(result, metadata));
 }
 
 SecretMetadataResult StoragePluginFunctionWrapper::secretMetadata(
@@ -523,31 +776,35 @@ SecretMetadataResult StoragePluginFunctionWrapper::secretMetadata(
         const QString &collectionName,
         const QString &secretName)
 {
+    PluginCallScope scope(plugin, "secretMetadata");
     SecretMetadata metadata;
     Result result = plugin->secretMetadata(collectionName, secretName, &metadata);
-    return SecretMetadataResult(result, metadata);
+    return scope.result(SecretMetadataResult(result, metadata));
 }
 
 CollectionNamesResult StoragePluginFunctionWrapper::collectionNames(
         StoragePluginWrapper *plugin)
 {
+    PluginCallScope scope(plugin, "collectionNames");
     QVariantMap cnamesMap;
     Result result = plugin->collectionNames(&cnamesMap);
-    return CollectionNamesResult(result, cnamesMap);
+    return scope.result(CollectionNamesResult(result, cnamesMap));
 }
 
 Result StoragePluginFunctionWrapper::createCollection(
         StoragePluginWrapper *plugin,
         const CollectionMetadata &metadata)
 {
-    return plugin->createCollection(metadata);
+    PluginCallScope scope(plugin, "createCollection");
+    return scope.result(plugin->createCollection(metadata));
 }
 
 Result StoragePluginFunctionWrapper::removeCollection(
         StoragePluginWrapper *plugin,
         const QString &collectionName)
 {
-    return plugin->removeCollection(collectionName);
+    PluginCallScope scope(plugin, "removeCollection");
+    return scope.result(plugin->removeCollection(collectionName));
 }
 
 Result StoragePluginFunctionWrapper::setSecret(
@@ -556,9 +813,10 @@ Result StoragePluginFunctionWrapper::setSecret(
         const QByteArray &secret,
         const Secret::FilterData &filterData)
 {
-    return plugin->setSecret(secretMetadata,
-                             secret,
-                             filterData);
+    PluginCallScope scope(plugin, "setSecret", secret.size());
+    return scope.result(plugin->setSecret(secretMetadata,
+                                          secret,
+                                          filterData));
 }
 
 SecretDataResult
@@ -567,14 +825,31 @@ StoragePluginFunctionWrapper::getSecret(
         const QString &collectionName,
         const QString &secretName)
 {
+    PluginCallScope scope(plugin, "getSecret");
     QByteArray secret;
     Secret::FilterData filterData;
     Result result = plugin->getSecret(collectionName,
                                       secretName,
                                       &secret,
                                       &filterData);
-    return SecretDataResult(
-                result, secret, filterData);
+    scope.setBytesOut(secret.size());
+    return scope.result(SecretDataResult(
+                result, secret, filterData));
+}
+
+SecretDataResult
+StoragePluginFunctionWrapper::getSecretFilterData(
+        StoragePluginWrapper *plugin,
+        const QString &collectionName,
+        const QString &secretName)
+{
+    PluginCallScope scope(plugin, "getSecretFilterData");
+    Secret::FilterData filterData;
+    Result result = plugin->getSecretFilterData(collectionName,
+                                                secretName,
+                                                &filterData);
+    return scope.result(SecretDataResult(
+                result, QByteArray(), filterData));
 }
 
 Result StoragePluginFunctionWrapper::removeSecret(
@@ -582,8 +857,9 @@ Result StoragePluginFunctionWrapper::removeSecret(
         const QString &collectionName,
         const QString &secretName)
 {
-    return plugin->removeSecret(collectionName,
-                                secretName);
+    PluginCallScope scope(plugin, "removeSecret");
+    return scope.result(plugin->removeSecret(collectionName,
+                                             secretName));
 }
 
 Result StoragePluginFunctionWrapper::reencrypt(
@@ -594,11 +870,12 @@ Result StoragePluginFunctionWrapper::reencrypt(
         const QByteArray &newkey,
         EncryptionPlugin *encryptionPlugin)
 {
-    return plugin->reencrypt(collectionName,
-                             secretNames,
-                             oldkey,
-                             newkey,
-                             encryptionPlugin);
+    PluginCallScope scope(plugin, "reencrypt");
+    return scope.result(plugin->reencrypt(collectionName,
+                                          secretNames,
+                                          oldkey,
+                                          newkey,
+                                          encryptionPlugin));
 }
 
 Result StoragePluginFunctionWrapper::encryptAndStoreSecret(
@@ -608,6 +885,7 @@ Result StoragePluginFunctionWrapper::encryptAndStoreSecret(
         const Secret &secret,
         const QByteArray &encryptionKey)
 {
+    PluginCallScope scope(storagePlugin, "encryptAndStoreSecret", secret.data().size());
     QByteArray encrypted;
     Result pluginResult = encryptionPlugin->encryptSecret(
                 secret.data(), encryptionKey, &encrypted);
@@ -617,7 +895,7 @@ Result StoragePluginFunctionWrapper::encryptAndStoreSecret(
                     encrypted,
                     secret.filterData());
     }
-    return pluginResult;
+    return scope.result(pluginResult);
 }
 
 SecretResult StoragePluginFunctionWrapper::getAndDecryptSecret(
@@ -626,6 +904,7 @@ SecretResult StoragePluginFunctionWrapper::getAndDecryptSecret(
         const Secret::Identifier &identifier,
         const QByteArray &encryptionKey)
 {
+    PluginCallScope scope(storagePlugin, "getAndDecryptSecret");
     Secret secret;
     QByteArray encrypted;
     Secret::FilterData filterData;
@@ -642,7 +921,8 @@ SecretResult StoragePluginFunctionWrapper::getAndDecryptSecret(
         secret.setFilterData(filterData);
     }
 
-    return SecretResult(pluginResult, secret);
+    scope.setBytesOut(secret.data().size());
+    return scope.result(SecretResult(pluginResult, secret));
 }
 
 IdentifiersResult
@@ -650,16 +930,20 @@ StoragePluginFunctionWrapper::findSecrets(
         StoragePluginWrapper *storagePlugin,
         const QString &collectionName,
         const Sailfish::Secrets::Secret::FilterData &filter,
-        Sailfish::Secrets::StoragePlugin::FilterOperator filterOp)
+        Sailfish::Secrets::StoragePlugin::FilterOperator filterOp,
+        Sailfish::Secrets::StoragePlugin::FilterMatch filterMatch)
 {
+    PluginCallScope scope(storagePlugin, "findSecrets");
     QVector<Secret::Identifier> identifiers;
     QStringList secretNames;
-    Result pluginResult = storagePlugin->findSecrets(collectionName, filter, filterOp, &secretNames);
+    Result pluginResult = storagePlugin->findSecrets(collectionName, filter, filterOp, filterMatch, &secretNames);
+    const QString pluginName = storagePlugin->name();
+    identifiers.reserve(secretNames.size());
     for (const QString &secretName : secretNames) {
-        identifiers.append(Secret::Identifier(secretName, collectionName, storagePlugin->name()));
+        identifiers.append(Secret::Identifier(secretName, collectionName, pluginName));
     }
 
-    return IdentifiersResult(pluginResult, identifiers);
+    return scope.result(IdentifiersResult(pluginResult, identifiers));
 }
 
 Result
@@ -669,6 +953,7 @@ StoragePluginFunctionWrapper::reencryptDeviceLockedCollectionsAndSecrets(
         const QByteArray &oldEncryptionKey,
         const QByteArray &newEncryptionKey)
 {
+    PluginCallScope scope(plugin, "reencryptDeviceLockedCollectionsAndSecrets");
     // get collection names
     // foreach collection, get metadata
     // if usesDeviceLockKey, re-encrypt
@@ -677,22 +962,22 @@ StoragePluginFunctionWrapper::reencryptDeviceLockedCollectionsAndSecrets(
     Result result = plugin->collectionNames(&cnamesMap);
     cnames = cnamesMap.keys();
     if (result.code() != Result::Succeeded) {
-        return result;
+        return scope.result(result);
     }
     QMap<QString, EncryptionPlugin*> reencryptCollections;
     for (const QString &cname : cnames) {
         CollectionMetadata metadata;
         result = plugin->collectionMetadata(cname, &metadata);
         if (result.code() != Result::Succeeded) {
-            return result;
+            return scope.result(result);
         }
 
         if (metadata.usesDeviceLockKey) {
             if (!encryptionPlugins.contains(metadata.encryptionPluginName)) {
                 // TODO: stale data in metadata db?
-                return Result(Result::InvalidExtensionPluginError,
-                              QStringLiteral("Unknown collection encryption plugin %1")
-                              .arg(metadata.encryptionPluginName));
+                return scope.result(Result(Result::InvalidExtensionPluginError,
+                                           QStringLiteral("Unknown collection encryption plugin %1")
+                                           .arg(metadata.encryptionPluginName)));
             }
             reencryptCollections.insert(cname, encryptionPlugins.value(metadata.encryptionPluginName));
         }
@@ -704,22 +989,22 @@ StoragePluginFunctionWrapper::reencryptDeviceLockedCollectionsAndSecrets(
     QStringList snames;
     result = plugin->secretNames(QString(), &snames);
     if (result.code() != Result::Succeeded) {
-        return result;
+        return scope.result(result);
     }
     QMap<QString, EncryptionPlugin*> reencryptSecrets;
     for (const QString &sname : snames) {
         SecretMetadata metadata;
         result = plugin->secretMetadata(QString(), sname, &metadata);
         if (result.code() != Result::Succeeded) {
-            return result;
+            return scope.result(result);
         }
 
         if (metadata.usesDeviceLockKey) {
             if (!encryptionPlugins.contains(metadata.encryptionPluginName)) {
                 // TODO: stale data in metadata db?
-                return Result(Result::InvalidExtensionPluginError,
-                              QStringLiteral("Unknown secret encryption plugin %1")
-                              .arg(metadata.encryptionPluginName));
+                return scope.result(Result(Result::InvalidExtensionPluginError,
+                                           QStringLiteral("Unknown secret encryption plugin %1")
+                                           .arg(metadata.encryptionPluginName)));
             }
             reencryptSecrets.insert(sname, encryptionPlugins.value(metadata.encryptionPluginName));
         }
@@ -747,7 +1032,7 @@ StoragePluginFunctionWrapper::reencryptDeviceLockedCollectionsAndSecrets(
             result = sresult;
         }
     }
-    return result;
+    return scope.result(result);
 }
 
 Result
@@ -757,18 +1042,19 @@ StoragePluginFunctionWrapper::collectionSecretPreCheck(
         const QString &secretName,
         bool newSecret)
 {
+    PluginCallScope scope(plugin, "collectionSecretPreCheck");
     QStringList cnames;
     QVariantMap cnamesMap;
     Result result = plugin->collectionNames(&cnamesMap);
     cnames = cnamesMap.keys();
     if (result.code() != Result::Succeeded) {
-        return result;
+        return scope.result(result);
     }
 
     if (!cnames.contains(collectionName)) {
-        return Result(Result::InvalidCollectionError,
-                      QStringLiteral("No such collection %1 exists in plugin %2")
-                      .arg(collectionName, plugin->name()));
+        return scope.result(Result(Result::InvalidCollectionError,
+                                   QStringLiteral("No such collection %1 exists in plugin %2")
+                                   .arg(collectionName, plugin->name())));
     }
 
     SecretMetadata metadata;
@@ -776,43 +1062,46 @@ StoragePluginFunctionWrapper::collectionSecretPreCheck(
     if (result.code() == Result::Succeeded) {
         if (newSecret) {
             // this is bad, since it means that the secret already exists.
-            return Result(Result::SecretAlreadyExistsError,
-                          QStringLiteral("A secret with that name in this collection already exists"));
+            return scope.result(Result(Result::SecretAlreadyExistsError,
+                                       QStringLiteral("A secret with that name in this collection already exists")));
         } else {
             // this is good, the secret we want to use does exist.
-            return Result(Result::Succeeded);
+            return scope.result(Result(Result::Succeeded));
         }
     } else if (result.errorCode() == Result::InvalidSecretError) {
         if (newSecret) {
             // this is good, the secret does not exist.
-            return Result(Result::Succeeded);
+            return scope.result(Result(Result::Succeeded));
         } else {
             // This is bad, since it means that the secret does not exist.
             // However, we can let the plugin report an error in that case,
-            // so return success just in case it's a "hidden" key.
-            return Result(Result::Succeeded);
+            // so return scope.result(success just in case it's a "hidden" key.
+                         return Result(Result::Succeeded));
         }
     } else {
         // some database error occurred.
-        return result;
+        return scope.result(result);
     }
 }
 
 bool EncryptedStoragePluginFunctionWrapper::isLocked(EncryptedStoragePluginWrapper *plugin)
 {
+    PluginCallScope scope(plugin, "isLocked");
     return plugin->isLocked();
 }
 
 bool EncryptedStoragePluginFunctionWrapper::lock(EncryptedStoragePluginWrapper *plugin)
 {
-    return plugin->lock();
+    PluginCallScope scope(plugin, "lock");
+    return scope.result(plugin->lock());
 }
 
 bool EncryptedStoragePluginFunctionWrapper::unlock(
         EncryptedStoragePluginWrapper *plugin,
         const QByteArray &lockCode)
 {
-    return plugin->unlock(lockCode);
+    PluginCallScope scope(plugin, "unlock");
+    return scope.result(plugin->unlock(lockCode));
 }
 
 bool EncryptedStoragePluginFunctionWrapper::setLockCode(
@@ -820,17 +1109,19 @@ bool EncryptedStoragePluginFunctionWrapper::setLockCode(
         const QByteArray &oldLockCode,
         const QByteArray &newLockCode)
 {
-    return plugin->setLockCode(oldLockCode, newLockCode);
+    PluginCallScope scope(plugin, "setLockCode");
+    return scope.result(plugin->setLockCode(oldLockCode, newLockCode));
 }
 
 CollectionMetadataResult EncryptedStoragePluginFunctionWrapper::collectionMetadata(
         EncryptedStoragePluginWrapper *plugin,
         const QString &collectionName)
 {
+    PluginCallScope scope(plugin, "collectionMetadata");
     CollectionMetadata metadata;
     Result result = plugin->collectionMetadata(collectionName, &metadata);
     metadata.collectionName = collectionName;
-    return CollectionMetadataResult(result, metadata);
+    return scope.result(CollectionMetadataResult(result, metadata));
 }
 
 SecretMetadataResult EncryptedStoragePluginFunctionWrapper::secretMetadata(
@@ -838,19 +1129,21 @@ SecretMetadataResult EncryptedStoragePluginFunctionWrapper::secretMetadata(
         const QString &collectionName,
         const QString &secretName)
 {
+    PluginCallScope scope(plugin, "secretMetadata");
     SecretMetadata metadata;
     Result result = plugin->secretMetadata(collectionName, secretName, &metadata);
     metadata.collectionName = collectionName;
     metadata.secretName = secretName;
-    return SecretMetadataResult(result, metadata);
+    return scope.result(SecretMetadataResult(result, metadata));
 }
 
 CollectionNamesResult EncryptedStoragePluginFunctionWrapper::collectionNames(
         EncryptedStoragePluginWrapper *plugin)
 {
+    PluginCallScope scope(plugin, "collectionNames");
     QVariantMap cnamesMap;
     Result result = plugin->collectionNames(&cnamesMap);
-    return CollectionNamesResult(result, cnamesMap);
+    return scope.result(CollectionNamesResult(result, cnamesMap));
 }
 
 Result EncryptedStoragePluginFunctionWrapper::createCollection(
@@ -858,14 +1151,16 @@ Result EncryptedStoragePluginFunctionWrapper::createCollection(
         const CollectionMetadata &metadata,
         const QByteArray &key)
 {
-    return plugin->createCollection(metadata, key);
+    PluginCallScope scope(plugin, "createCollection");
+    return scope.result(plugin->createCollection(metadata, key));
 }
 
 Result EncryptedStoragePluginFunctionWrapper::removeCollection(
         EncryptedStoragePluginWrapper *plugin,
         const QString &collectionName)
 {
-    return plugin->removeCollection(collectionName);
+    PluginCallScope scope(plugin, "removeCollection");
+    return scope.result(plugin->removeCollection(collectionName));
 }
 
 LockedResult
@@ -873,20 +1168,34 @@ EncryptedStoragePluginFunctionWrapper::isCollectionLocked(
         EncryptedStoragePluginWrapper *plugin,
         const QString &collectionName)
 {
+    PluginCallScope scope(plugin, "isCollectionLocked");
     bool locked = false;
     Result result = plugin->isCollectionLocked(collectionName, &locked);
-    return LockedResult(result, locked);
+    return scope.result(LockedResult(result, locked));
 }
 
 DerivedKeyResult
 EncryptedStoragePluginFunctionWrapper::deriveKeyFromCode(
         EncryptedStoragePluginWrapper *plugin,
         const QByteArray &authenticationCode,
-        const QByteArray &salt)
+        const QByteArray &salt,
+        const QVariantMap &kdfParameters)
 {
+    PluginCallScope scope(plugin, "deriveKeyFromCode", authenticationCode.size());
     QByteArray key;
-    Result result = plugin->deriveKeyFromCode(authenticationCode, salt, &key);
-    return DerivedKeyResult(result, key);
+    Result result = plugin->deriveKeyFromCodeWithParameters(authenticationCode, salt, kdfParameters, &key);
+    return scope.result(DerivedKeyResult(result, key, kdfParameters));
+}
+
+DerivedKeyResult
+EncryptedStoragePluginFunctionWrapper::calibrateAndDeriveKeyFromCode(
+        EncryptedStoragePluginWrapper *plugin,
+        const QByteArray &authenticationCode,
+        const QByteArray &salt,
+        int targetMsecs)
+{
+    PluginCallScope scope(plugin, "calibrateAndDeriveKeyFromCode", authenticationCode.size());
+    return scope.result(calibrateAndDeriveKey(plugin, authenticationCode, salt, targetMsecs));
 }
 
 Result EncryptedStoragePluginFunctionWrapper::setEncryptionKey(
@@ -894,7 +1203,8 @@ Result EncryptedStoragePluginFunctionWrapper::setEncryptionKey(
         const QString &collectionName,
         const QByteArray &key)
 {
-    return plugin->setEncryptionKey(collectionName, key);
+    PluginCallScope scope(plugin, "setEncryptionKey");
+    return scope.result(plugin->setEncryptionKey(collectionName, key));
 }
 
 Result EncryptedStoragePluginFunctionWrapper::reencrypt(
@@ -903,9 +1213,10 @@ Result EncryptedStoragePluginFunctionWrapper::reencrypt(
         const QByteArray &oldkey,
         const QByteArray &newkey)
 {
-    return plugin->reencrypt(collectionName,
-                             oldkey,
-                             newkey);
+    PluginCallScope scope(plugin, "reencrypt");
+    return scope.result(plugin->reencrypt(collectionName,
+                                          oldkey,
+                                          newkey));
 }
 
 Result EncryptedStoragePluginFunctionWrapper::setSecret(
@@ -914,9 +1225,10 @@ Result EncryptedStoragePluginFunctionWrapper::setSecret(
         const QByteArray &secret,
         const Secret::FilterData &filterData)
 {
-    return plugin->setSecret(secretMetadata,
-                             secret,
-                             filterData);
+    PluginCallScope scope(plugin, "setSecret", secret.size());
+    return scope.result(plugin->setSecret(secretMetadata,
+                                          secret,
+                                          filterData));
 }
 
 SecretDataResult
@@ -925,14 +1237,31 @@ EncryptedStoragePluginFunctionWrapper::getSecret(
         const QString &collectionName,
         const QString &secretName)
 {
+    PluginCallScope scope(plugin, "getSecret");
     QByteArray secret;
     Secret::FilterData filterData;
     Result result = plugin->getSecret(collectionName,
                                       secretName,
                                       &secret,
                                       &filterData);
-    return SecretDataResult(
-                result, secret, filterData);
+    scope.setBytesOut(secret.size());
+    return scope.result(SecretDataResult(
+                result, secret, filterData));
+}
+
+SecretDataResult
+EncryptedStoragePluginFunctionWrapper::getSecretFilterData(
+        EncryptedStoragePluginWrapper *plugin,
+        const QString &collectionName,
+        const QString &secretName)
+{
+    PluginCallScope scope(plugin, "getSecretFilterData");
+    Secret::FilterData filterData;
+    Result result = plugin->getSecretFilterData(collectionName,
+                                                secretName,
+                                                &filterData);
+    return scope.result(SecretDataResult(
+                result, QByteArray(), filterData));
 }
 
 IdentifiersResult
@@ -940,14 +1269,17 @@ EncryptedStoragePluginFunctionWrapper::findSecrets(
         EncryptedStoragePluginWrapper *plugin,
         const QString &collectionName,
         const Secret::FilterData &filter,
-        StoragePlugin::FilterOperator filterOperator)
+        StoragePlugin::FilterOperator filterOperator,
+        StoragePlugin::FilterMatch filterMatch)
 {
+    PluginCallScope scope(plugin, "findSecrets");
     QVector<Secret::Identifier> identifiers;
     Result result = plugin->findSecrets(collectionName,
                                         filter,
                                         filterOperator,
+                                        filterMatch,
                                         &identifiers);
-    return IdentifiersResult(result, identifiers);
+    return scope.result(IdentifiersResult(result, identifiers));
 }
 
 Result EncryptedStoragePluginFunctionWrapper::removeSecret(
@@ -955,8 +1287,9 @@ Result EncryptedStoragePluginFunctionWrapper::removeSecret(
         const QString &collectionName,
         const QString &secretName)
 {
-    return plugin->removeSecret(collectionName,
-                                secretName);
+    PluginCallScope scope(plugin, "removeSecret");
+    return scope.result(plugin->removeSecret(collectionName,
+                                             secretName));
 }
 
 Result EncryptedStoragePluginFunctionWrapper::setStandaloneSecret(
@@ -965,10 +1298,11 @@ Result EncryptedStoragePluginFunctionWrapper::setStandaloneSecret(
         const Secret &secret,
         const QByteArray &key)
 {
-    return plugin->setSecret(secretMetadata,
-                             secret.data(),
-                             secret.filterData(),
-                             key);
+    PluginCallScope scope(plugin, "setStandaloneSecret", secret.data().size());
+    return scope.result(plugin->setSecret(secretMetadata,
+                                          secret.data(),
+                                          secret.filterData(),
+                                          key));
 }
 
 SecretDataResult
@@ -977,14 +1311,16 @@ EncryptedStoragePluginFunctionWrapper::accessStandaloneSecret(
         const QString &secretName,
         const QByteArray &key)
 {
+    PluginCallScope scope(plugin, "accessStandaloneSecret");
     QByteArray secret;
     Secret::FilterData filterData;
     Result result = plugin->accessSecret(secretName,
                                          key,
                                          &secret,
                                          &filterData);
-    return SecretDataResult(
-                result, secret, filterData);
+    scope.setBytesOut(secret.size());
+    return scope.result(SecretDataResult(
+                result, secret, filterData));
 }
 
 Result EncryptedStoragePluginFunctionWrapper::unlockCollectionAndStoreSecret(
@@ -993,6 +1329,7 @@ Result EncryptedStoragePluginFunctionWrapper::unlockCollectionAndStoreSecret(
         const Secret &secret,
         const QByteArray &encryptionKey)
 {
+    PluginCallScope scope(plugin, "unlockCollectionAndStoreSecret", secret.data().size());
     bool originallyLocked = false;
     bool locked = false;
     Result pluginResult = plugin->isCollectionLocked(secret.identifier().collectionName(), &locked);
@@ -1003,23 +1340,23 @@ Result EncryptedStoragePluginFunctionWrapper::unlockCollectionAndStoreSecret(
             if (pluginResult.code() != Result::Succeeded) {
                 // unable to apply the new encryptionKey.
                 plugin->setEncryptionKey(secret.identifier().collectionName(), QByteArray());
-                return Result(Result::SecretsPluginDecryptionError,
-                              QString::fromLatin1("Unable to decrypt collection %1 with the entered authentication key").arg(secret.identifier().collectionName()));
+                return scope.result(Result(Result::SecretsPluginDecryptionError,
+                                           QString::fromLatin1("Unable to decrypt collection %1 with the entered authentication key").arg(secret.identifier().collectionName())));
 
             }
             pluginResult = plugin->isCollectionLocked(secret.identifier().collectionName(), &locked);
             if (pluginResult.code() != Result::Succeeded) {
                 plugin->setEncryptionKey(secret.identifier().collectionName(), QByteArray());
-                return Result(Result::SecretsPluginDecryptionError,
-                              QString::fromLatin1("Unable to check lock state of collection %1 after setting the entered authentication key").arg(secret.identifier().collectionName()));
+                return scope.result(Result(Result::SecretsPluginDecryptionError,
+                                           QString::fromLatin1("Unable to check lock state of collection %1 after setting the entered authentication key").arg(secret.identifier().collectionName())));
 
             }
         }
         if (locked) {
             // still locked, even after applying the new encryptionKey?  The authenticationCode was wrong.
             plugin->setEncryptionKey(secret.identifier().collectionName(), QByteArray());
-            return Result(Result::IncorrectAuthenticationCodeError,
-                          QString::fromLatin1("The authentication code entered for collection %1 was incorrect").arg(secret.identifier().collectionName()));
+            return scope.result(Result(Result::IncorrectAuthenticationCodeError,
+                                       QString::fromLatin1("The authentication code entered for collection %1 was incorrect").arg(secret.identifier().collectionName())));
         } else {
             // successfully unlocked the encrypted storage collection.  write the secret.
             pluginResult = plugin->setSecret(secretMetadata, secret.data(), secret.filterData());
@@ -1036,7 +1373,7 @@ Result EncryptedStoragePluginFunctionWrapper::unlockCollectionAndStoreSecret(
             }
         }
     }
-    return pluginResult;
+    return scope.result(pluginResult);
 }
 
 SecretResult EncryptedStoragePluginFunctionWrapper::unlockCollectionAndReadSecret(
@@ -1045,12 +1382,13 @@ SecretResult EncryptedStoragePluginFunctionWrapper::unlockCollectionAndReadSecre
         const Secret::Identifier &identifier,
         const QByteArray &encryptionKey)
 {
+    PluginCallScope scope(plugin, "unlockCollectionAndReadSecret");
     Secret secret;
     bool originallyLocked = false;
     bool locked = false;
     Result pluginResult = plugin->isCollectionLocked(identifier.collectionName(), &locked);
     if (pluginResult.code() != Result::Succeeded) {
-        return SecretResult(pluginResult, secret);
+        return scope.result(SecretResult(pluginResult, secret));
     }
 
     // if it's locked, attempt to unlock it
@@ -1060,19 +1398,19 @@ SecretResult EncryptedStoragePluginFunctionWrapper::unlockCollectionAndReadSecre
         if (pluginResult.code() != Result::Succeeded) {
             // unable to apply the new encryptionKey.
             plugin->setEncryptionKey(identifier.collectionName(), QByteArray());
-            return SecretResult(Result(Result::SecretsPluginDecryptionError,
-                                       QString::fromLatin1("Unable to decrypt collection %1 with the entered authentication key")
-                                       .arg(identifier.collectionName())),
-                                secret);
+            return scope.result(SecretResult(Result(Result::SecretsPluginDecryptionError,
+                                                    QString::fromLatin1("Unable to decrypt collection %1 with the entered authentication key")
+                                                    .arg(identifier.collectionName())),
+                                             secret));
 
         }
         pluginResult = plugin->isCollectionLocked(identifier.collectionName(), &locked);
         if (pluginResult.code() != Result::Succeeded) {
             plugin->setEncryptionKey(identifier.collectionName(), QByteArray());
-            return SecretResult(Result(Result::SecretsPluginDecryptionError,
-                                       QString::fromLatin1("Unable to check lock state of collection %1 after setting the entered authentication key")
-                                       .arg(identifier.collectionName())),
-                                secret);
+            return scope.result(SecretResult(Result(Result::SecretsPluginDecryptionError,
+                                                    QString::fromLatin1("Unable to check lock state of collection %1 after setting the entered authentication key")
+                                                    .arg(identifier.collectionName())),
+                                             secret));
 
         }
     }
@@ -1080,10 +1418,10 @@ SecretResult EncryptedStoragePluginFunctionWrapper::unlockCollectionAndReadSecre
     if (locked) {
         // still locked, even after applying the new encryptionKey?  The authenticationCode was wrong.
         plugin->setEncryptionKey(identifier.collectionName(), QByteArray());
-        return SecretResult(Result(Result::IncorrectAuthenticationCodeError,
-                                   QString::fromLatin1("The authentication code entered for collection %1 was incorrect")
-                                   .arg(identifier.collectionName())),
-                            secret);
+        return scope.result(SecretResult(Result(Result::IncorrectAuthenticationCodeError,
+                                                QString::fromLatin1("The authentication code entered for collection %1 was incorrect")
+                                                .arg(identifier.collectionName())),
+                                         secret));
     }
 
     // successfully unlocked the encrypted storage collection.  read the secret.
@@ -1105,7 +1443,7 @@ SecretResult EncryptedStoragePluginFunctionWrapper::unlockCollectionAndReadSecre
         }
     }
 
-    return SecretResult(pluginResult, secret);
+    return scope.result(SecretResult(pluginResult, secret));
 }
 
 Result EncryptedStoragePluginFunctionWrapper::unlockCollectionAndRemoveSecret(
@@ -1114,11 +1452,12 @@ Result EncryptedStoragePluginFunctionWrapper::unlockCollectionAndRemoveSecret(
         const Secret::Identifier &identifier,
         const QByteArray &encryptionKey)
 {
+    PluginCallScope scope(plugin, "unlockCollectionAndRemoveSecret");
     bool originallyLocked = false;
     bool locked = false;
     Result pluginResult = plugin->isCollectionLocked(identifier.collectionName(), &locked);
     if (pluginResult.code() != Result::Succeeded) {
-        return pluginResult;
+        return scope.result(pluginResult);
     }
 
     // if it's locked, attempt to unlock it
@@ -1128,23 +1467,23 @@ Result EncryptedStoragePluginFunctionWrapper::unlockCollectionAndRemoveSecret(
         if (pluginResult.code() != Result::Succeeded) {
             // unable to apply the new encryptionKey.
             plugin->setEncryptionKey(identifier.collectionName(), QByteArray());
-            return Result(Result::SecretsPluginDecryptionError,
-                          QString::fromLatin1("Unable to decrypt collection %1 with the entered authentication key").arg(identifier.collectionName()));
+            return scope.result(Result(Result::SecretsPluginDecryptionError,
+                                       QString::fromLatin1("Unable to decrypt collection %1 with the entered authentication key").arg(identifier.collectionName())));
 
         }
         pluginResult = plugin->isCollectionLocked(identifier.collectionName(), &locked);
         if (pluginResult.code() != Result::Succeeded) {
             plugin->setEncryptionKey(identifier.collectionName(), QByteArray());
-            return Result(Result::SecretsPluginDecryptionError,
-                          QString::fromLatin1("Unable to check lock state of collection %1 after setting the entered authentication key").arg(identifier.collectionName()));
+            return scope.result(Result(Result::SecretsPluginDecryptionError,
+                                       QString::fromLatin1("Unable to check lock state of collection %1 after setting the entered authentication key").arg(identifier.collectionName())));
 
         }
     }
     if (locked) {
         // still locked, even after applying the new encryptionKey?  The authenticationCode was wrong.
         plugin->setEncryptionKey(identifier.collectionName(), QByteArray());
-        return Result(Result::IncorrectAuthenticationCodeError,
-                      QString::fromLatin1("The authentication code entered for collection %1 was incorrect").arg(identifier.collectionName()));
+        return scope.result(Result(Result::IncorrectAuthenticationCodeError,
+                                   QString::fromLatin1("The authentication code entered for collection %1 was incorrect").arg(identifier.collectionName())));
     }
 
     // successfully unlocked the encrypted storage collection.  remove the secret.
@@ -1161,7 +1500,7 @@ Result EncryptedStoragePluginFunctionWrapper::unlockCollectionAndRemoveSecret(
         }
     }
 
-    return pluginResult;
+    return scope.result(pluginResult);
 }
 
 IdentifiersResult
@@ -1170,14 +1509,16 @@ EncryptedStoragePluginFunctionWrapper::unlockAndFindSecrets(
         const CollectionMetadata &collectionMetadata,
         const Secret::FilterData &filter,
         StoragePlugin::FilterOperator filterOperator,
+        StoragePlugin::FilterMatch filterMatch,
         const QByteArray &encryptionKey)
 {
+    PluginCallScope scope(plugin, "unlockAndFindSecrets");
     QVector<Secret::Identifier> identifiers;
     bool originallyLocked = false;
     bool locked = false;
     Result pluginResult = plugin->isCollectionLocked(collectionMetadata.collectionName, &locked);
     if (pluginResult.code() != Result::Succeeded) {
-        return IdentifiersResult(pluginResult, identifiers);
+        return scope.result(IdentifiersResult(pluginResult, identifiers));
     }
 
     // if it's locked, attempt to unlock it
@@ -1187,19 +1528,19 @@ EncryptedStoragePluginFunctionWrapper::unlockAndFindSecrets(
         if (pluginResult.code() != Result::Succeeded) {
             // unable to apply the new encryptionKey.
             plugin->setEncryptionKey(collectionMetadata.collectionName, QByteArray());
-            return IdentifiersResult(Result(Result::SecretsPluginDecryptionError,
-                                            QString::fromLatin1("Unable to decrypt collection %1 with the entered authentication key")
-                                            .arg(collectionMetadata.collectionName)),
-                                     identifiers);
+            return scope.result(IdentifiersResult(Result(Result::SecretsPluginDecryptionError,
+                                                         QString::fromLatin1("Unable to decrypt collection %1 with the entered authentication key")
+                                                         .arg(collectionMetadata.collectionName)),
+                                                  identifiers));
 
         }
         pluginResult = plugin->isCollectionLocked(collectionMetadata.collectionName, &locked);
         if (pluginResult.code() != Result::Succeeded) {
             plugin->setEncryptionKey(collectionMetadata.collectionName, QByteArray());
-            return IdentifiersResult(Result(Result::SecretsPluginDecryptionError,
-                                            QString::fromLatin1("Unable to check lock state of collection %1 after setting the entered authentication key")
-                                            .arg(collectionMetadata.collectionName)),
-                                     identifiers);
+            return scope.result(IdentifiersResult(Result(Result::SecretsPluginDecryptionError,
+                                                         QString::fromLatin1("Unable to check lock state of collection %1 after setting the entered authentication key")
+                                                         .arg(collectionMetadata.collectionName)),
+                                                  identifiers));
 
         }
     }
@@ -1207,14 +1548,14 @@ EncryptedStoragePluginFunctionWrapper::unlockAndFindSecrets(
     if (locked) {
         // still locked, even after applying the new encryptionKey?  The authenticationCode was wrong.
         plugin->setEncryptionKey(collectionMetadata.collectionName, QByteArray());
-        return IdentifiersResult(Result(Result::IncorrectAuthenticationCodeError,
-                                        QString::fromLatin1("The authentication code entered for collection %1 was incorrect")
-                                        .arg(collectionMetadata.collectionName)),
-                                 identifiers);
+        return scope.result(IdentifiersResult(Result(Result::IncorrectAuthenticationCodeError,
+                                                     QString::fromLatin1("The authentication code entered for collection %1 was incorrect")
+                                                     .arg(collectionMetadata.collectionName)),
+                                              identifiers));
     }
 
     // successfully unlocked the encrypted storage collection.  perform the filtering operation.
-    pluginResult = plugin->findSecrets(collectionMetadata.collectionName, filter, static_cast<StoragePlugin::FilterOperator>(filterOperator), &identifiers);
+    pluginResult = plugin->findSecrets(collectionMetadata.collectionName, filter, static_cast<StoragePlugin::FilterOperator>(filterOperator), filterMatch, &identifiers);
 
     // relock the collection if we need to.
     if (originallyLocked
@@ -1227,7 +1568,7 @@ EncryptedStoragePluginFunctionWrapper::unlockAndFindSecrets(
         }
     }
 
-    return IdentifiersResult(pluginResult, identifiers);
+    return scope.result(IdentifiersResult(pluginResult, identifiers));
 }
 
 Result EncryptedStoragePluginFunctionWrapper::unlockDeviceLockedCollectionsAndReencrypt(
@@ -1235,13 +1576,14 @@ Result EncryptedStoragePluginFunctionWrapper::unlockDeviceLockedCollectionsAndRe
         const QByteArray &oldEncryptionKey,
         const QByteArray &newEncryptionKey)
 {
+    PluginCallScope scope(plugin, "unlockDeviceLockedCollectionsAndReencrypt");
     // find out which collections are device-locked
     QStringList cnames;
     QVariantMap cnamesMap;
     Result result = plugin->collectionNames(&cnamesMap);
     cnames = cnamesMap.keys();
     if (result.code() != Result::Succeeded) {
-        return result;
+        return scope.result(result);
     }
 
     QStringList reencryptCNames;
@@ -1249,7 +1591,7 @@ Result EncryptedStoragePluginFunctionWrapper::unlockDeviceLockedCollectionsAndRe
         CollectionMetadata metadata;
         result = plugin->collectionMetadata(cname, &metadata);
         if (result.code() != Result::Succeeded) {
-            return result;
+            return scope.result(result);
         }
         if (metadata.usesDeviceLockKey) {
             reencryptCNames.append(cname);
@@ -1282,7 +1624,7 @@ Result EncryptedStoragePluginFunctionWrapper::unlockDeviceLockedCollectionsAndRe
         }
     }
 
-    return result;
+    return scope.result(result);
 }
 
 Result EncryptedStoragePluginFunctionWrapper::unlockAndRemoveCollection(
@@ -1290,66 +1632,69 @@ Result EncryptedStoragePluginFunctionWrapper::unlockAndRemoveCollection(
         const QString &collectionName,
         const QByteArray &encryptionKey)
 {
+    PluginCallScope scope(plugin, "unlockAndRemoveCollection");
     bool locked = false;
     Result result = plugin->isCollectionLocked(collectionName, &locked);
     if (result.code() != Result::Succeeded) {
-        return result;
+        return scope.result(result);
     }
 
     if (locked) {
         result = plugin->setEncryptionKey(collectionName, encryptionKey);
         if (result.code() != Result::Succeeded) {
-            return result;
+            return scope.result(result);
         }
 
         locked = false;
         result = plugin->isCollectionLocked(collectionName, &locked);
         if (result.code() != Result::Succeeded) {
-            return result;
+            return scope.result(result);
         } else if (locked) {
-            return Result(Result::CollectionIsLockedError,
-                          QStringLiteral("Invalid lock code, unable to unlock collection to delete"));
+            return scope.result(Result(Result::CollectionIsLockedError,
+                                       QStringLiteral("Invalid lock code, unable to unlock collection to delete")));
         }
     }
 
-    return plugin->removeCollection(collectionName);
+    return scope.result(plugin->removeCollection(collectionName));
 }
 
 Result EncryptedStoragePluginFunctionWrapper::deriveKeyUnlockAndRemoveCollection(
         EncryptedStoragePluginWrapper *plugin,
         const QString &collectionName,
         const QByteArray &lockCode,
-        const QByteArray &salt)
+        const QByteArray &salt,
+        const QVariantMap &kdfParameters)
 {
+    PluginCallScope scope(plugin, "deriveKeyUnlockAndRemoveCollection");
     bool locked = false;
     Result result = plugin->isCollectionLocked(collectionName, &locked);
     if (result.code() != Result::Succeeded) {
-        return result;
+        return scope.result(result);
     }
 
     if (locked) {
         QByteArray derivedKey;
-        result = plugin->deriveKeyFromCode(lockCode, salt, &derivedKey);
+        result = plugin->deriveKeyFromCodeWithParameters(lockCode, salt, kdfParameters, &derivedKey);
         if (result.code() != Result::Succeeded) {
-            return result;
+            return scope.result(result);
         }
 
         result = plugin->setEncryptionKey(collectionName, derivedKey);
         if (result.code() != Result::Succeeded) {
-            return result;
+            return scope.result(result);
         }
 
         locked = false;
         result = plugin->isCollectionLocked(collectionName, &locked);
         if (result.code() != Result::Succeeded) {
-            return result;
+            return scope.result(result);
         } else if (locked) {
-            return Result(Result::CollectionIsLockedError,
-                          QStringLiteral("Invalid lock code, unable to unlock collection to delete"));
+            return scope.result(Result(Result::CollectionIsLockedError,
+                                       QStringLiteral("Invalid lock code, unable to unlock collection to delete")));
         }
     }
 
-    return plugin->removeCollection(collectionName);
+    return scope.result(plugin->removeCollection(collectionName));
 }
 
 Result EncryptedStoragePluginFunctionWrapper::collectionSecretPreCheck(
@@ -1358,41 +1703,42 @@ Result EncryptedStoragePluginFunctionWrapper::collectionSecretPreCheck(
         const QString &secretName,
         bool newSecret)
 {
+    PluginCallScope scope(plugin, "collectionSecretPreCheck");
     QStringList cnames;
     QVariantMap cnamesMap;
     Result result = plugin->collectionNames(&cnamesMap);
     cnames = cnamesMap.keys();
     if (result.code() != Result::Succeeded) {
-        return result;
+        return scope.result(result);
     }
 
     if (!cnames.contains(collectionInfo.collectionName)) {
-        return Result(Result::InvalidCollectionError,
-                      QStringLiteral("No such collection %1 exists in plugin %2")
-                      .arg(collectionInfo.collectionName, plugin->name()));
+        return scope.result(Result(Result::InvalidCollectionError,
+                                   QStringLiteral("No such collection %1 exists in plugin %2")
+                                   .arg(collectionInfo.collectionName, plugin->name())));
     }
 
     bool originallyLocked = false;
     bool locked = false;
     result = plugin->isCollectionLocked(collectionInfo.collectionName, &locked);
     if (result.code() != Result::Succeeded) {
-        return result;
+        return scope.result(result);
     }
 
     originallyLocked = locked;
     if (locked) {
         result = plugin->setEncryptionKey(collectionInfo.collectionName, collectionInfo.collectionKey);
         if (result.code() != Result::Succeeded) {
-            return result;
+            return scope.result(result);
         }
 
         locked = false;
         result = plugin->isCollectionLocked(collectionInfo.collectionName, &locked);
         if (result.code() != Result::Succeeded) {
-            return result;
+            return scope.result(result);
         } else if (locked) {
-            return Result(Result::CollectionIsLockedError,
-                          QStringLiteral("Invalid lock code, unable to unlock collection"));
+            return scope.result(Result(Result::CollectionIsLockedError,
+                                       QStringLiteral("Invalid lock code, unable to unlock collection")));
         }
     }
 
@@ -1411,24 +1757,24 @@ Result EncryptedStoragePluginFunctionWrapper::collectionSecretPreCheck(
     if (result.code() == Result::Succeeded) {
         if (newSecret) {
             // this is bad, since it means that the secret already exists.
-            return Result(Result::SecretAlreadyExistsError,
-                          QStringLiteral("A secret with that name in this collection already exists"));
+            return scope.result(Result(Result::SecretAlreadyExistsError,
+                                       QStringLiteral("A secret with that name in this collection already exists")));
         } else {
             // this is good, the secret we want to use does exist.
-            return Result(Result::Succeeded);
+            return scope.result(Result(Result::Succeeded));
         }
     } else if (result.errorCode() == Result::InvalidSecretError) {
         if (newSecret) {
             // this is good, the secret does not exist.
-            return Result(Result::Succeeded);
+            return scope.result(Result(Result::Succeeded));
         } else {
             // This is bad, since it means that the secret does not exist.
             // However, we can let the plugin report an error in that case,
-            // so return success just in case it's a "hidden" key.
-            return Result(Result::Succeeded);
+            // so return scope.result(success just in case it's a "hidden" key.
+                         return Result(Result::Succeeded));
         }
     } else {
         // some database error occurred.
-        return result;
+        return scope.result(result);
     }
 }
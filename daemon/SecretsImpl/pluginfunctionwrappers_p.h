@@ -22,6 +22,7 @@
 
 #include <QtCore/QString>
 #include <QtCore/QByteArray>
+#include <QtCore/QSet>
 
 namespace Sailfish {
 
@@ -81,14 +82,31 @@ struct IdentifiersResult {
     QVector<Sailfish::Secrets::Secret::Identifier> identifiers;
 };
 
+struct CollectionSearchResult {
+    CollectionSearchResult(const Sailfish::Secrets::Result &r = Sailfish::Secrets::Result(),
+                           const QVector<Sailfish::Secrets::Secret::Identifier> &i = QVector<Sailfish::Secrets::Secret::Identifier>())
+        : result(r), identifiers(i) {}
+    CollectionSearchResult(const CollectionSearchResult &other)
+        : result(other.result)
+        , identifiers(other.identifiers)
+        , skippedCollections(other.skippedCollections)
+        , skippedCollectionResults(other.skippedCollectionResults) {}
+    Sailfish::Secrets::Result result;
+    QVector<Sailfish::Secrets::Secret::Identifier> identifiers;
+    QVector<Sailfish::Secrets::Secret::Identifier> skippedCollections;
+    QVector<Sailfish::Secrets::Result> skippedCollectionResults;
+};
+
 struct DerivedKeyResult {
     DerivedKeyResult(const Sailfish::Secrets::Result &r = Sailfish::Secrets::Result(),
-                     const QByteArray &k = QByteArray())
-        : result(r), key(k) {}
+                     const QByteArray &k = QByteArray(),
+                     const QVariantMap &p = QVariantMap())
+        : result(r), key(k), kdfParameters(p) {}
     DerivedKeyResult(const DerivedKeyResult &other)
-        : result(other.result), key(other.key) {}
+        : result(other.result), key(other.key), kdfParameters(other.kdfParameters) {}
     Sailfish::Secrets::Result result;
     QByteArray key;
+    QVariantMap kdfParameters;
 };
 
 struct FoundResult {
@@ -170,6 +188,21 @@ struct PluginState {
 
 PluginState pluginState(PluginBase *plugin);
 
+QString calculateSecretNameHash(const Sailfish::Secrets::Secret::Identifier &ident);
+
+// Searches every collection of the given plugin (exactly one of the
+// plugin pointers should be non-null).  Collections which the caller may
+// not access, or which are locked, are skipped rather than unlocked, and
+// the reason is reported in skippedCollectionResults.
+CollectionSearchResult findSecretsInCollections(
+        StoragePluginWrapper *storagePlugin,
+        EncryptedStoragePluginWrapper *encryptedStoragePlugin,
+        const QString &callerApplicationId,
+        const QSet<QString> &unlockedCollectionHashes,
+        const Sailfish::Secrets::Secret::FilterData &filter,
+        Sailfish::Secrets::StoragePlugin::FilterOperator filterOperator,
+        Sailfish::Secrets::StoragePlugin::FilterMatch filterMatch);
+
 FoundLockStatusResult queryLockSpecificPlugin(
         const QMap<QString, Sailfish::Secrets::EncryptionPlugin*> &encryptionPlugins,
         const QMap<QString, StoragePluginWrapper*> &storagePlugins,
@@ -205,6 +238,14 @@ bool masterUnlockPlugins(
         const QList<EncryptedStoragePluginWrapper*> &encryptedStoragePlugins,
         const QByteArray &encryptionKey);
 
+int releaseDatabaseMemory(
+        const QList<StoragePluginWrapper*> &storagePlugins,
+        const QList<EncryptedStoragePluginWrapper*> &encryptedStoragePlugins);
+
+bool holdsInMemoryCollections(
+        const QList<StoragePluginWrapper*> &storagePlugins,
+        const QList<EncryptedStoragePluginWrapper*> &encryptedStoragePlugins);
+
 bool modifyMasterLockPlugins(
         const QList<StoragePluginWrapper*> &storagePlugins,
         const QList<EncryptedStoragePluginWrapper*> &encryptedStoragePlugins,
@@ -245,7 +286,13 @@ namespace EncryptionPluginFunctionWrapper {
     DerivedKeyResult deriveKeyFromCode(
             Sailfish::Secrets::EncryptionPlugin *plugin,
             const QByteArray &authenticationCode,
-            const QByteArray &salt);
+            const QByteArray &salt,
+            const QVariantMap &kdfParameters);
+    DerivedKeyResult calibrateAndDeriveKeyFromCode(
+            Sailfish::Secrets::EncryptionPlugin *plugin,
+            const QByteArray &authenticationCode,
+            const QByteArray &salt,
+            int targetMsecs);
     DataResult encryptSecret(
             Sailfish::Secrets::EncryptionPlugin *plugin,
             const QByteArray &plaintext,
@@ -304,11 +351,16 @@ namespace StoragePluginFunctionWrapper {
             StoragePluginWrapper *plugin,
             const QString &collectionName,
             const QString &secretName);
+    SecretDataResult getSecretFilterData(
+            StoragePluginWrapper *plugin,
+            const QString &collectionName,
+            const QString &secretName);
     IdentifiersResult findSecrets(
             StoragePluginWrapper *plugin,
             const QString &collectionName,
             const Sailfish::Secrets::Secret::FilterData &filter,
-            Sailfish::Secrets::StoragePlugin::FilterOperator filterOperator);
+            Sailfish::Secrets::StoragePlugin::FilterOperator filterOperator,
+            Sailfish::Secrets::StoragePlugin::FilterMatch filterMatch);
     Sailfish::Secrets::Result removeSecret(
             StoragePluginWrapper *plugin,
             const QString &collectionName,
@@ -387,7 +439,13 @@ namespace EncryptedStoragePluginFunctionWrapper {
     DerivedKeyResult deriveKeyFromCode(
             EncryptedStoragePluginWrapper *plugin,
             const QByteArray &authenticationCode,
-            const QByteArray &salt);
+            const QByteArray &salt,
+            const QVariantMap &kdfParameters);
+    DerivedKeyResult calibrateAndDeriveKeyFromCode(
+            EncryptedStoragePluginWrapper *plugin,
+            const QByteArray &authenticationCode,
+            const QByteArray &salt,
+            int targetMsecs);
     Sailfish::Secrets::Result setEncryptionKey(
             EncryptedStoragePluginWrapper *plugin,
             const QString &collectionName,
@@ -407,11 +465,16 @@ namespace EncryptedStoragePluginFunctionWrapper {
             EncryptedStoragePluginWrapper *plugin,
             const QString &collectionName,
             const QString &secretName);
+    SecretDataResult getSecretFilterData(
+            EncryptedStoragePluginWrapper *plugin,
+            const QString &collectionName,
+            const QString &secretName);
     IdentifiersResult findSecrets(
             EncryptedStoragePluginWrapper *plugin,
             const QString &collectionName,
             const Sailfish::Secrets::Secret::FilterData &filter,
-            Sailfish::Secrets::StoragePlugin::FilterOperator filterOperator);
+            Sailfish::Secrets::StoragePlugin::FilterOperator filterOperator,
+            Sailfish::Secrets::StoragePlugin::FilterMatch filterMatch);
 
     Sailfish::Secrets::Result removeSecret(
             EncryptedStoragePluginWrapper *plugin,
@@ -452,6 +515,7 @@ namespace EncryptedStoragePluginFunctionWrapper {
             const CollectionMetadata &collectionMetadata,
             const Sailfish::Secrets::Secret::FilterData &filter,
             Sailfish::Secrets::StoragePlugin::FilterOperator filterOperator,
+            Sailfish::Secrets::StoragePlugin::FilterMatch filterMatch,
             const QByteArray &encryptionKey);
 
     Sailfish::Secrets::Result unlockDeviceLockedCollectionsAndReencrypt(
@@ -468,7 +532,8 @@ namespace EncryptedStoragePluginFunctionWrapper {
             EncryptedStoragePluginWrapper *plugin,
             const QString &collectionName,
             const QByteArray &lockCode,
-            const QByteArray &salt);
+            const QByteArray &salt,
+            const QVariantMap &kdfParameters);
 
     Sailfish::Secrets::Result collectionSecretPreCheck(
             EncryptedStoragePluginWrapper *plugin,
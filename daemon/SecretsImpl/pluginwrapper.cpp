@@ -7,6 +7,7 @@
 
 #include "pluginwrapper_p.h"
 #include "logging_p.h"
+#include "startupprofiler_p.h"
 
 using namespace Sailfish::Secrets;
 using namespace Sailfish::Secrets::Daemon::ApiImpl;
@@ -103,6 +104,11 @@ bool PluginWrapper::setMasterLockKey(const QByteArray &oldMasterLockKey, const Q
     return initialize(newMasterLockKey); // may need to synchronize data between metadataDb and plugin.
 }
 
+void PluginWrapper::releaseCachedQueries()
+{
+    m_metadataDb.clearPreparedQueries();
+}
+
 bool PluginWrapper::supportsLocking() const
 {
     return m_plugin->supportsLocking();
@@ -171,6 +177,7 @@ bool StoragePluginWrapper::initialize(const QByteArray &masterLockKey)
 
     // step one: open the metadata database.
     if (!m_metadataDb.isOpen()) {
+        StartupPhase phase("openMetadataDatabase", name());
         if (!m_metadataDb.openDatabase(masterLockKey)) {
             qCWarning(lcSailfishSecretsDaemon) << "cannot open metadata database:"
                                                << m_metadataDb.errorMessage();
@@ -274,13 +281,22 @@ Result StoragePluginWrapper::getSecret(
     return m_storagePlugin->getSecret(collectionName, secretName, secret, filterData);
 }
 
+Result StoragePluginWrapper::getSecretFilterData(
+        const QString &collectionName,
+        const QString &secretName,
+        Secret::FilterData *filterData)
+{
+    return m_storagePlugin->getSecretFilterData(collectionName, secretName, filterData);
+}
+
 Result StoragePluginWrapper::findSecrets(
         const QString &collectionName,
         const Secret::FilterData &filter,
         StoragePlugin::FilterOperator filterOperator,
+        StoragePlugin::FilterMatch filterMatch,
         QStringList *secretNames)
 {
-    return m_storagePlugin->findSecrets(collectionName, filter, filterOperator, secretNames);
+    return m_storagePlugin->findSecrets(collectionName, filter, filterOperator, filterMatch, secretNames);
 }
 
 Result StoragePluginWrapper::reencrypt(
@@ -536,6 +552,7 @@ bool EncryptedStoragePluginWrapper::initialize(const QByteArray &masterLockKey)
 
     // step one: open the metadata database.
     if (!m_metadataDb.isOpen()) {
+        StartupPhase phase("openMetadataDatabase", name());
         if (!m_metadataDb.openDatabase(masterLockKey)) {
             qCWarning(lcSailfishSecretsDaemon) << "cannot open metadata database:"
                                                << m_metadataDb.errorMessage();
@@ -657,12 +674,13 @@ Result EncryptedStoragePluginWrapper::isCollectionLocked(
     return m_encryptedStoragePlugin->isCollectionLocked(collectionName, locked);
 }
 
-Result EncryptedStoragePluginWrapper::deriveKeyFromCode(
+Result EncryptedStoragePluginWrapper::deriveKeyFromCodeWithParameters(
         const QByteArray &authenticationCode,
         const QByteArray &salt,
+        const QVariantMap &parameters,
         QByteArray *key)
 {
-    return m_encryptedStoragePlugin->deriveKeyFromCode(authenticationCode, salt, key);
+    return m_encryptedStoragePlugin->deriveKeyFromCodeWithParameters(authenticationCode, salt, parameters, key);
 }
 
 Result EncryptedStoragePluginWrapper::setEncryptionKey(
@@ -701,13 +719,22 @@ Result EncryptedStoragePluginWrapper::getSecret(
     return m_encryptedStoragePlugin->getSecret(collectionName, secretName, secret, filterData);
 }
 
+Result EncryptedStoragePluginWrapper::getSecretFilterData(
+        const QString &collectionName,
+        const QString &secretName,
+        Secret::FilterData *filterData)
+{
+    return m_encryptedStoragePlugin->getSecretFilterData(collectionName, secretName, filterData);
+}
+
 Result EncryptedStoragePluginWrapper::findSecrets(
         const QString &collectionName,
         const Secret::FilterData &filter,
         StoragePlugin::FilterOperator filterOperator,
+        StoragePlugin::FilterMatch filterMatch,
         QVector<Secret::Identifier> *identifiers)
 {
-    return m_encryptedStoragePlugin->findSecrets(collectionName, filter, filterOperator, identifiers);
+    return m_encryptedStoragePlugin->findSecrets(collectionName, filter, filterOperator, filterMatch, identifiers);
 }
 
 Result EncryptedStoragePluginWrapper::accessSecret(
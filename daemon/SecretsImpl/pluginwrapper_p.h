@@ -67,6 +67,9 @@ public:
     bool masterUnlock(const QByteArray &masterLockKey);
     bool setMasterLockKey(const QByteArray &oldMasterLockKey, const QByteArray &newMasterLockKey);
 
+    // releases the cached prepared queries of the per-plugin metadata database
+    void releaseCachedQueries();
+
 protected:
     MetadataDatabase m_metadataDb;
     bool m_initialized;
@@ -97,7 +100,8 @@ public:
     Sailfish::Secrets::Result removeCollection(const QString &collectionName);
     Sailfish::Secrets::Result setSecret(const SecretMetadata &metadata, const QByteArray &secret, const Sailfish::Secrets::Secret::FilterData &filterData);
     Sailfish::Secrets::Result getSecret(const QString &collectionName, const QString &secretName, QByteArray *secret, Sailfish::Secrets::Secret::FilterData *filterData);
-    Sailfish::Secrets::Result findSecrets(const QString &collectionName, const Sailfish::Secrets::Secret::FilterData &filter, Sailfish::Secrets::StoragePlugin::FilterOperator filterOperator, QStringList *secretNames);
+    Sailfish::Secrets::Result getSecretFilterData(const QString &collectionName, const QString &secretName, Sailfish::Secrets::Secret::FilterData *filterData);
+    Sailfish::Secrets::Result findSecrets(const QString &collectionName, const Sailfish::Secrets::Secret::FilterData &filter, Sailfish::Secrets::StoragePlugin::FilterOperator filterOperator, Sailfish::Secrets::StoragePlugin::FilterMatch filterMatch, QStringList *secretNames);
     Sailfish::Secrets::Result removeSecret(const QString &collectionName, const QString &secretName);
 
     Sailfish::Secrets::Result reencrypt(
@@ -134,13 +138,14 @@ public:
     Sailfish::Secrets::Result removeCollection(const QString &collectionName);
 
     Sailfish::Secrets::Result isCollectionLocked(const QString &collectionName, bool *locked);
-    Sailfish::Secrets::Result deriveKeyFromCode(const QByteArray &authenticationCode, const QByteArray &salt, QByteArray *key);
+    Sailfish::Secrets::Result deriveKeyFromCodeWithParameters(const QByteArray &authenticationCode, const QByteArray &salt, const QVariantMap &parameters, QByteArray *key);
     Sailfish::Secrets::Result setEncryptionKey(const QString &collectionName, const QByteArray &key);
     Sailfish::Secrets::Result reencrypt(const QString &collectionName, const QByteArray &oldkey, const QByteArray &newkey);
 
     Sailfish::Secrets::Result setSecret(const SecretMetadata &metadata, const QByteArray &secret, const Sailfish::Secrets::Secret::FilterData &filterData);
     Sailfish::Secrets::Result getSecret(const QString &collectionName, const QString &secretName, QByteArray *secret, Sailfish::Secrets::Secret::FilterData *filterData);
-    Sailfish::Secrets::Result findSecrets(const QString &collectionName, const Sailfish::Secrets::Secret::FilterData &filter, Sailfish::Secrets::StoragePlugin::FilterOperator filterOperator, QVector<Sailfish::Secrets::Secret::Identifier> *identifiers);
+    Sailfish::Secrets::Result getSecretFilterData(const QString &collectionName, const QString &secretName, Sailfish::Secrets::Secret::FilterData *filterData);
+    Sailfish::Secrets::Result findSecrets(const QString &collectionName, const Sailfish::Secrets::Secret::FilterData &filter, Sailfish::Secrets::StoragePlugin::FilterOperator filterOperator, Sailfish::Secrets::StoragePlugin::FilterMatch filterMatch, QVector<Sailfish::Secrets::Secret::Identifier> *identifiers);
     Sailfish::Secrets::Result removeSecret(const QString &collectionName, const QString &secretName);
 
     Sailfish::Secrets::Result setSecret(const SecretMetadata &metadata, const QByteArray &secret, const Sailfish::Secrets::Secret::FilterData &filterData, const QByteArray &key);
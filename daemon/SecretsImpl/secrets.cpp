@@ -8,6 +8,7 @@
 #include "secrets_p.h"
 #include "secretsrequestprocessor_p.h"
 #include "logging_p.h"
+#include "startupprofiler_p.h"
 
 #include "../CryptoImpl/crypto_p.h"
 #include "../CryptoImpl/cryptopluginfunctionwrappers_p.h"
@@ -30,6 +31,7 @@
 #include <QtCore/QFile>
 #include <QtCore/QDir>
 #include <QtCore/QCryptographicHash>
+#include <QtCore/QElapsedTimer>
 
 #include <QtConcurrent>
 
@@ -71,6 +73,14 @@ namespace {
         *deviceLockKey = tempDeviceLockKey;
     }
 
+    // the master lock keys may be derived with a higher (calibrated) cost
+    // than the crypto plugins allow for client requests.
+    QVariantMap masterLockCustomParameters() {
+        QVariantMap customParameters;
+        customParameters.insert(QLatin1String(Sailfish_Crypto_CryptoPlugin_DaemonRequestParameter), true);
+        return customParameters;
+    }
+
     Sailfish::Secrets::Secret mapPluginNames(
             Sailfish::Secrets::Daemon::Controller *controller,
             const Sailfish::Secrets::Secret &secret) {
@@ -115,6 +125,7 @@ Daemon::ApiImpl::SecretsDBusObject::SecretsDBusObject(
 
 // retrieve information about available plugins
 void Daemon::ApiImpl::SecretsDBusObject::getPluginInfo(
+        quint64 traceId,
         const QDBusMessage &message,
         Result &result,
         QVector<PluginInfo> &storagePlugins,
@@ -131,11 +142,13 @@ void Daemon::ApiImpl::SecretsDBusObject::getPluginInfo(
                                   inParams,
                                   connection(),
                                   message,
+                                  traceId,
                                   result);
 }
 
 // retrieve information about secrets health
 void Daemon::ApiImpl::SecretsDBusObject::getHealthInfo(
+        quint64 traceId,
         const QDBusMessage &message,
         Result &result,
         HealthCheckRequest::Health &saltDataHealth,
@@ -148,12 +161,14 @@ void Daemon::ApiImpl::SecretsDBusObject::getHealthInfo(
                                   inParams,
                                   connection(),
                                   message,
+                                  traceId,
                                   result);
 }
 
 // retrieve user input for the client (daemon)
 void Daemon::ApiImpl::SecretsDBusObject::userInput(
         const InteractionParameters &uiParams,
+        quint64 traceId,
         const QDBusMessage &message,
         Result &result,
         QByteArray &data)
@@ -178,6 +193,7 @@ void Daemon::ApiImpl::SecretsDBusObject::userInput(
                                   inParams,
                                   connection(),
                                   message,
+                                  traceId,
                                   result);
 }
 
@@ -186,6 +202,7 @@ void Daemon::ApiImpl::SecretsDBusObject::userInput(
 // retrieve the names of collections
 void Daemon::ApiImpl::SecretsDBusObject::collectionNames(
         const QString &storagePluginName,
+        quint64 traceId,
         const QDBusMessage &message,
         Sailfish::Secrets::Result &result,
         QVariantMap &names)
@@ -197,6 +214,7 @@ void Daemon::ApiImpl::SecretsDBusObject::collectionNames(
                                   inParams,
                                   connection(),
                                   message,
+                                  traceId,
                                   result);
 }
 
@@ -207,6 +225,7 @@ void Daemon::ApiImpl::SecretsDBusObject::createCollection(
         const QString &encryptionPluginName,
         SecretManager::DeviceLockUnlockSemantic unlockSemantic,
         SecretManager::AccessControlMode accessControlMode,
+        quint64 traceId,
         const QDBusMessage &message,
         Result &result)
 {
@@ -220,6 +239,7 @@ void Daemon::ApiImpl::SecretsDBusObject::createCollection(
                                   inParams,
                                   connection(),
                                   message,
+                                  traceId,
                                   result);
 }
 
@@ -233,6 +253,7 @@ void Daemon::ApiImpl::SecretsDBusObject::createCollection(
         SecretManager::AccessControlMode accessControlMode,
         SecretManager::UserInteractionMode userInteractionMode,
         const QString &interactionServiceAddress,
+        quint64 traceId,
         const QDBusMessage &message,
         Result &result)
 {
@@ -249,6 +270,7 @@ void Daemon::ApiImpl::SecretsDBusObject::createCollection(
                                   inParams,
                                   connection(),
                                   message,
+                                  traceId,
                                   result);
 }
 
@@ -258,6 +280,7 @@ void Daemon::ApiImpl::SecretsDBusObject::deleteCollection(
         const QString &storagePluginName,
         SecretManager::UserInteractionMode userInteractionMode,
         const QString &interactionServiceAddress,
+        quint64 traceId,
         const QDBusMessage &message,
         Result &result)
 {
@@ -270,6 +293,7 @@ void Daemon::ApiImpl::SecretsDBusObject::deleteCollection(
                                   inParams,
                                   connection(),
                                   message,
+                                  traceId,
                                   result);
 }
 
@@ -279,6 +303,7 @@ void Daemon::ApiImpl::SecretsDBusObject::setSecret(
         const InteractionParameters &uiParams,
         SecretManager::UserInteractionMode userInteractionMode,
         const QString &interactionServiceAddress,
+        quint64 traceId,
         const QDBusMessage &message,
         Result &result)
 {
@@ -291,6 +316,7 @@ void Daemon::ApiImpl::SecretsDBusObject::setSecret(
                                   inParams,
                                   connection(),
                                   message,
+                                  traceId,
                                   result);
 }
 
@@ -303,6 +329,7 @@ void Daemon::ApiImpl::SecretsDBusObject::setSecret(
         SecretManager::AccessControlMode accessControlMode,
         SecretManager::UserInteractionMode userInteractionMode,
         const QString &interactionServiceAddress,
+        quint64 traceId,
         const QDBusMessage &message,
         Result &result)
 {
@@ -318,6 +345,7 @@ void Daemon::ApiImpl::SecretsDBusObject::setSecret(
                                   inParams,
                                   connection(),
                                   message,
+                                  traceId,
                                   result);
 }
 
@@ -331,6 +359,7 @@ void Daemon::ApiImpl::SecretsDBusObject::setSecret(
         SecretManager::AccessControlMode accessControlMode,
         SecretManager::UserInteractionMode userInteractionMode,
         const QString &interactionServiceAddress,
+        quint64 traceId,
         const QDBusMessage &message,
         Result &result)
 {
@@ -347,6 +376,7 @@ void Daemon::ApiImpl::SecretsDBusObject::setSecret(
                                   inParams,
                                   connection(),
                                   message,
+                                  traceId,
                                   result);
 }
 
@@ -355,6 +385,7 @@ void Daemon::ApiImpl::SecretsDBusObject::getSecret(
         const Secret::Identifier &identifier,
         SecretManager::UserInteractionMode userInteractionMode,
         const QString &interactionServiceAddress,
+        quint64 traceId,
         const QDBusMessage &message,
         Result &result,
         Secret &secret)
@@ -370,6 +401,26 @@ void Daemon::ApiImpl::SecretsDBusObject::getSecret(
                                   inParams,
                                   connection(),
                                   message,
+                                  traceId,
+                                  result);
+}
+
+// get the filter data of a secret, without its secret data
+void Daemon::ApiImpl::SecretsDBusObject::getSecretFilterData(
+        const Secret::Identifier &identifier,
+        quint64 traceId,
+        const QDBusMessage &message,
+        Result &result,
+        Secret &secret)
+{
+    Q_UNUSED(secret); // outparam, set in handlePendingRequest / handleFinishedRequest
+    QList<QVariant> inParams;
+    inParams << QVariant::fromValue<Secret::Identifier>(MAP_PLUGIN_NAMES(identifier));
+    m_requestQueue->handleRequest(Daemon::ApiImpl::GetCollectionSecretFilterDataRequest,
+                                  inParams,
+                                  connection(),
+                                  message,
+                                  traceId,
                                   result);
 }
 
@@ -379,8 +430,10 @@ void Daemon::ApiImpl::SecretsDBusObject::findSecrets(
         const QString &storagePluginName,
         const Secret::FilterData &filter,
         SecretManager::FilterOperator filterOperator,
+        SecretManager::FilterMatch filterMatch,
         SecretManager::UserInteractionMode userInteractionMode,
         const QString &interactionServiceAddress,
+        quint64 traceId,
         const QDBusMessage &message,
         Result &result,
         QVector<Secret::Identifier> &identifiers)
@@ -393,6 +446,7 @@ void Daemon::ApiImpl::SecretsDBusObject::findSecrets(
     inParams << QVariant::fromValue<QString>(MAP_PLUGIN_NAMES(storagePluginName))
              << QVariant::fromValue<Secret::FilterData>(filter)
              << QVariant::fromValue<SecretManager::FilterOperator>(filterOperator)
+             << QVariant::fromValue<SecretManager::FilterMatch>(filterMatch)
              << QVariant::fromValue<SecretManager::UserInteractionMode>(userInteractionMode)
              << QVariant::fromValue<QString>(interactionServiceAddress);
     m_requestQueue->handleRequest(collectionName.isEmpty()
@@ -401,6 +455,39 @@ void Daemon::ApiImpl::SecretsDBusObject::findSecrets(
                                   inParams,
                                   connection(),
                                   message,
+                                  traceId,
+                                  result);
+}
+
+// find secrets via filter in all collections of one or all storage plugins
+void Daemon::ApiImpl::SecretsDBusObject::findSecretsInCollections(
+        const QString &storagePluginName,
+        const Secret::FilterData &filter,
+        SecretManager::FilterOperator filterOperator,
+        SecretManager::FilterMatch filterMatch,
+        quint64 traceId,
+        const QDBusMessage &message,
+        Result &result,
+        QVector<Secret::Identifier> &identifiers,
+        QVector<Secret::Identifier> &skippedCollections,
+        QVector<Result> &skippedCollectionResults)
+{
+    // outparams, set in handlePendingRequest / handleFinishedRequest
+    Q_UNUSED(identifiers);
+    Q_UNUSED(skippedCollections);
+    Q_UNUSED(skippedCollectionResults);
+    QList<QVariant> inParams;
+    inParams << QVariant::fromValue<QString>(storagePluginName.isEmpty()
+                                                 ? storagePluginName
+                                                 : MAP_PLUGIN_NAMES(storagePluginName))
+             << QVariant::fromValue<Secret::FilterData>(filter)
+             << QVariant::fromValue<SecretManager::FilterOperator>(filterOperator)
+             << QVariant::fromValue<SecretManager::FilterMatch>(filterMatch);
+    m_requestQueue->handleRequest(Daemon::ApiImpl::FindSecretsInCollectionsRequest,
+                                  inParams,
+                                  connection(),
+                                  message,
+                                  traceId,
                                   result);
 }
 
@@ -409,6 +496,7 @@ void Daemon::ApiImpl::SecretsDBusObject::deleteSecret(
         const Secret::Identifier &identifier,
         SecretManager::UserInteractionMode userInteractionMode,
         const QString &interactionServiceAddress,
+        quint64 traceId,
         const QDBusMessage &message,
         Result &result)
 {
@@ -422,6 +510,7 @@ void Daemon::ApiImpl::SecretsDBusObject::deleteSecret(
                                   inParams,
                                   connection(),
                                   message,
+                                  traceId,
                                   result);
 }
 
@@ -429,6 +518,7 @@ void Daemon::ApiImpl::SecretsDBusObject::deleteSecret(
 void Daemon::ApiImpl::SecretsDBusObject::queryLockStatus(
         LockCodeRequest::LockCodeTargetType lockCodeTargetType,
         const QString &lockCodeTarget,
+        quint64 traceId,
         const QDBusMessage &message,
         Result &result,
         LockCodeRequest::LockStatus &lockStatus)
@@ -441,6 +531,7 @@ void Daemon::ApiImpl::SecretsDBusObject::queryLockStatus(
                                   inParams,
                                   connection(),
                                   message,
+                                  traceId,
                                   result);
 }
 
@@ -451,6 +542,7 @@ void Daemon::ApiImpl::SecretsDBusObject::modifyLockCode(
         const InteractionParameters &interactionParameters,
         SecretManager::UserInteractionMode userInteractionMode,
         const QString &interactionServiceAddress,
+        quint64 traceId,
         const QDBusMessage &message,
         Result &result)
 {
@@ -464,6 +556,7 @@ void Daemon::ApiImpl::SecretsDBusObject::modifyLockCode(
                                   inParams,
                                   connection(),
                                   message,
+                                  traceId,
                                   result);
 }
 
@@ -474,6 +567,7 @@ void Daemon::ApiImpl::SecretsDBusObject::provideLockCode(
         const InteractionParameters &interactionParameters,
         SecretManager::UserInteractionMode userInteractionMode,
         const QString &interactionServiceAddress,
+        quint64 traceId,
         const QDBusMessage &message,
         Result &result)
 {
@@ -487,6 +581,7 @@ void Daemon::ApiImpl::SecretsDBusObject::provideLockCode(
                                   inParams,
                                   connection(),
                                   message,
+                                  traceId,
                                   result);
 }
 
@@ -497,6 +592,7 @@ void Daemon::ApiImpl::SecretsDBusObject::forgetLockCode(
         const InteractionParameters &interactionParameters,
         SecretManager::UserInteractionMode userInteractionMode,
         const QString &interactionServiceAddress,
+        quint64 traceId,
         const QDBusMessage &message,
         Result &result)
 {
@@ -510,6 +606,7 @@ void Daemon::ApiImpl::SecretsDBusObject::forgetLockCode(
                                   inParams,
                                   connection(),
                                   message,
+                                  traceId,
                                   result);
 }
 
@@ -533,6 +630,9 @@ Daemon::ApiImpl::SecretsRequestQueue::SecretsRequestQueue(
     , m_deviceLockKeyLen(0)
     , m_noLockCode(false)
     , m_locked(true)
+    , m_kdfParametersStore(secretsDirPath, autotestMode)
+    , m_collectionKdfParametersRead(false)
+    , m_directCompletion(Q_NULLPTR)
 {
     SecretsDaemonConnection::registerDBusTypes();
 
@@ -542,6 +642,18 @@ Daemon::ApiImpl::SecretsRequestQueue::SecretsRequestQueue(
     m_appPermissions = new Daemon::ApiImpl::ApplicationPermissions(this);
     m_requestProcessor = new Daemon::ApiImpl::RequestProcessor(m_appPermissions, autotestMode, this);
 
+    // Each storage plugin has a worker thread of its own, in which all of
+    // its operations are performed, so that operations on different plugins
+    // may run concurrently.
+    const QStringList storagePluginNames = m_requestProcessor->storagePluginNames()
+                                         + m_requestProcessor->encryptedStoragePluginNames();
+    for (const QString &pluginName : storagePluginNames) {
+        QSharedPointer<QThreadPool> pool = QSharedPointer<QThreadPool>::create();
+        pool->setMaxThreadCount(1);
+        pool->setExpiryTimeout(-1);
+        m_storagePluginThreadPools.insert(pluginName, pool);
+    }
+
     setDBusObject(new Daemon::ApiImpl::SecretsDBusObject(this));
     qCDebug(lcSailfishSecretsDaemon) << "Secrets: initialization succeeded, awaiting client connections.";
 }
@@ -561,9 +673,20 @@ QWeakPointer<QThreadPool> Daemon::ApiImpl::SecretsRequestQueue::secretsThreadPoo
     return m_secretsThreadPool.toWeakRef();
 }
 
+// The database connections of a storage plugin may only be used from the
+// thread which opened them, so every operation on the plugin must be run
+// in the pool returned by this function.  Operations which do not involve
+// a storage plugin are run in the secrets thread pool.
+QWeakPointer<QThreadPool> Daemon::ApiImpl::SecretsRequestQueue::storagePluginThreadPool(const QString &pluginName)
+{
+    return m_storagePluginThreadPools.value(pluginName, m_secretsThreadPool).toWeakRef();
+}
+
 bool Daemon::ApiImpl::SecretsRequestQueue::generateKeyData(
         const QByteArray &lockCode,
         const QString &cipherPluginName,
+        bool recalibrate,
+        MasterLockKdfParameters *kdfParameters,
         QByteArray *bkdbKey,
         QByteArray *deviceLockKey,
         QByteArray *testCipherText,
@@ -582,7 +705,6 @@ bool Daemon::ApiImpl::SecretsRequestQueue::generateKeyData(
     kdfParams.setKeyDerivationFunction(Sailfish::Crypto::CryptoManager::KdfPkcs5Pbkdf2);
     kdfParams.setKeyDerivationMac(Sailfish::Crypto::CryptoManager::MacHmac);
     kdfParams.setKeyDerivationDigestFunction(Sailfish::Crypto::CryptoManager::DigestSha512);
-    kdfParams.setIterations(12000);
     if (lockCode.isEmpty()) {
         kdfParams.setInputData(QByteArray(1, '\0'));
     } else {
@@ -627,11 +749,15 @@ bool Daemon::ApiImpl::SecretsRequestQueue::generateKeyData(
     if (cplugin == Q_NULLPTR) {
         for (auto it = cplugins.constBegin(); it != cplugins.constEnd(); ++it) {
             const QString &currPluginName = it.key();
+            const MasterLockKdfParameters params = recalibrate
+                    ? calibrateKdfParameters(it.value(), salt)
+                    : *kdfParameters;
             // attempt to generate the bookkeeping db key
+            kdfParams.setIterations(params.bookkeepingIterations);
             QFuture<Sailfish::Crypto::KeyResult> future = QtConcurrent::run(
                     controller()->threadPoolForPlugin(currPluginName).data(),
                     Sailfish::Crypto::Daemon::ApiImpl::CryptoPluginFunctionWrapper::generateKey,
-                    Sailfish::Crypto::PluginAndCustomParams(it.value(), QVariantMap()),
+                    Sailfish::Crypto::PluginAndCustomParams(it.value(), masterLockCustomParameters()),
                     keyTemplate,
                     Sailfish::Crypto::KeyPairGenerationParameters(),
                     kdfParams);
@@ -640,11 +766,11 @@ bool Daemon::ApiImpl::SecretsRequestQueue::generateKeyData(
             if (kr.result.code() == Sailfish::Crypto::Result::Succeeded) {
                 Sailfish::Crypto::Key tempKey = kr.key;
                 // attempt to generate the devicelock key
-                kdfParams.setIterations(16000);
+                kdfParams.setIterations(params.deviceLockIterations);
                 future = QtConcurrent::run(
                     controller()->threadPoolForPlugin(currPluginName).data(),
                     Sailfish::Crypto::Daemon::ApiImpl::CryptoPluginFunctionWrapper::generateKey,
-                    Sailfish::Crypto::PluginAndCustomParams(it.value(), QVariantMap()),
+                    Sailfish::Crypto::PluginAndCustomParams(it.value(), masterLockCustomParameters()),
                     keyTemplate,
                     Sailfish::Crypto::KeyPairGenerationParameters(),
                     kdfParams);
@@ -655,16 +781,21 @@ bool Daemon::ApiImpl::SecretsRequestQueue::generateKeyData(
                     cplugin = it.value();
                     bookkeepingdbKey = tempKey;
                     devicelockKey = kr.key;
+                    *kdfParameters = params;
                     break;
                 }
             }
         }
     } else {
+        const MasterLockKdfParameters params = recalibrate
+                ? calibrateKdfParameters(cplugin, salt)
+                : *kdfParameters;
         // attempt to generate the bookkeeping db key
+        kdfParams.setIterations(params.bookkeepingIterations);
         QFuture<Sailfish::Crypto::KeyResult> future = QtConcurrent::run(
                 controller()->threadPoolForPlugin(cplugin->name()).data(),
                 Sailfish::Crypto::Daemon::ApiImpl::CryptoPluginFunctionWrapper::generateKey,
-                Sailfish::Crypto::PluginAndCustomParams(cplugin, QVariantMap()),
+                Sailfish::Crypto::PluginAndCustomParams(cplugin, masterLockCustomParameters()),
                 keyTemplate,
                 Sailfish::Crypto::KeyPairGenerationParameters(),
                 kdfParams);
@@ -673,11 +804,11 @@ bool Daemon::ApiImpl::SecretsRequestQueue::generateKeyData(
         if (kr.result.code() == Sailfish::Crypto::Result::Succeeded) {
             Sailfish::Crypto::Key tempKey = kr.key;
             // attempt to generate the devicelock key
-            kdfParams.setIterations(16000);
+            kdfParams.setIterations(params.deviceLockIterations);
             future = QtConcurrent::run(
                 controller()->threadPoolForPlugin(cplugin->name()).data(),
                 Sailfish::Crypto::Daemon::ApiImpl::CryptoPluginFunctionWrapper::generateKey,
-                Sailfish::Crypto::PluginAndCustomParams(cplugin, QVariantMap()),
+                Sailfish::Crypto::PluginAndCustomParams(cplugin, masterLockCustomParameters()),
                 keyTemplate,
                 Sailfish::Crypto::KeyPairGenerationParameters(),
                 kdfParams);
@@ -687,6 +818,7 @@ bool Daemon::ApiImpl::SecretsRequestQueue::generateKeyData(
                 // successfully generated both keys.
                 bookkeepingdbKey = tempKey;
                 devicelockKey = kr.key;
+                *kdfParameters = params;
             } else {
                 qCWarning(lcSailfishSecretsDaemon) << "Unable to generate device lock key:" << kr.result.errorMessage();
                 return false;
@@ -758,9 +890,19 @@ bool Daemon::ApiImpl::SecretsRequestQueue::initialize(
         // assume that this is the first time initialization has occurred.
         firstTimeInitialization = true;
     }
+    // the key derivation cost is calibrated for the device whenever the
+    // master lock code is changed.  Until then the lock code is empty and
+    // the legacy cost is used, which keeps calibration off the startup path.
+    const bool recalibrate = mode == SecretsRequestQueue::ModifyLockMode;
+    MasterLockKdfParameters kdfParams = recalibrate ? MasterLockKdfParameters() : kdfParameters();
+    if (!recalibrate && !kdfParams.isValid()
+            && cipherPluginName != QStringLiteral("no-key-derivation-cipher-plugin")) {
+        qCWarning(lcSailfishSecretsDaemon) << "Secrets: unable to read the lock code key derivation parameters!";
+        return false;
+    }
     // generate the keys and test cipher text
     if (cipherPluginName != QStringLiteral("no-key-derivation-cipher-plugin")
-            && !generateKeyData(lockCode, cipherPluginName, &bkdbKey, &deviceLockKey, &testCipherText, &usedCipherPluginName)) {
+            && !generateKeyData(lockCode, cipherPluginName, recalibrate, &kdfParams, &bkdbKey, &deviceLockKey, &testCipherText, &usedCipherPluginName)) {
         qCDebug(lcSailfishSecretsDaemon) << "Secrets: unable to generate keys from the lock code!";
         if (!firstTimeInitialization) {
             // the plugin we used to generate the keys was removed.
@@ -776,8 +918,23 @@ bool Daemon::ApiImpl::SecretsRequestQueue::initialize(
     }
     // test against or modify the test cipher text, depending on mode
     if (mode == SecretsRequestQueue::ModifyLockMode) {
-        if (!writeTestCipherText(testCipherText, usedCipherPluginName)) {
-            qCWarning(lcSailfishSecretsDaemon) << "Secrets: unable to write new test cipher text file!";
+        // store the newly calibrated key derivation parameters before the
+        // test cipher text which depends upon them, and restore the previous
+        // parameters if the test cipher text cannot be written.
+        const std::function<bool()> writeNewTestCipherText = [&] {
+            if (!writeTestCipherText(testCipherText, usedCipherPluginName)) {
+                qCWarning(lcSailfishSecretsDaemon) << "Secrets: unable to write new test cipher text file!";
+                return false;
+            }
+            return true;
+        };
+        if (kdfParams.isValid()) {
+            if (!m_kdfParametersStore.replaceMasterLockParameters(kdfParams, writeNewTestCipherText)) {
+                qCWarning(lcSailfishSecretsDaemon) << "Secrets: unable to replace lock code key derivation parameters!";
+                return false;
+            }
+            m_kdfParameters = kdfParams;
+        } else if (!writeNewTestCipherText()) {
             return false;
         }
     } else if (mode == SecretsRequestQueue::UnlockMode && !compareTestCipherText(testCipherText, true, usedCipherPluginName)) {
@@ -809,6 +966,24 @@ bool Daemon::ApiImpl::SecretsRequestQueue::initializePlugins()
     return m_requestProcessor->initializePlugins();
 }
 
+// Returns true if the daemon holds unlocked state which could not be
+// restored without user interaction if the daemon were restarted.
+bool Daemon::ApiImpl::SecretsRequestQueue::holdsUnlockedState() const
+{
+    if (!m_noLockCode && !m_locked) {
+        // the master lock was unlocked with the user's lock code.
+        return true;
+    }
+    // collections in in-memory storage would be lost if the daemon exited.
+    return m_requestProcessor->hasCachedUserKeys(deviceLockKey())
+            || m_requestProcessor->holdsInMemoryCollections();
+}
+
+int Daemon::ApiImpl::SecretsRequestQueue::releaseDatabaseMemory()
+{
+    return m_requestProcessor->releaseDatabaseMemory();
+}
+
 bool Daemon::ApiImpl::SecretsRequestQueue::masterLocked() const
 {
     return m_locked;
@@ -824,9 +999,11 @@ bool Daemon::ApiImpl::SecretsRequestQueue::testLockCode(
         return false;
     }
     // if there is no valid key derivation crypto plugin, specify dummy keys, otherwise generate key data.
+    MasterLockKdfParameters kdfParams = kdfParameters();
     if (cipherPluginName == QStringLiteral("no-key-derivation-cipher-plugin")) {
         specifyDummyMasterlockKeys(lockCode, &testCipherText, &bkdbKey, &deviceLockKey);
-    } else if (!generateKeyData(lockCode, cipherPluginName, &bkdbKey, &deviceLockKey, &testCipherText, &usedCipherPluginName)) {
+    } else if (!kdfParams.isValid()
+            || !generateKeyData(lockCode, cipherPluginName, false, &kdfParams, &bkdbKey, &deviceLockKey, &testCipherText, &usedCipherPluginName)) {
         qCWarning(lcSailfishSecretsDaemon) << "Secrets: unable to generate keys from the lock code!";
         return false;
     }
@@ -881,6 +1058,7 @@ bool Daemon::ApiImpl::SecretsRequestQueue::determineTestCipherPlugin(
             : QLatin1String("lockcodecheck");
     const QString lockCodeCheckDirPath = secretsDir.absoluteFilePath(lockCodeCheckDirName);
 
+    Daemon::ApiImpl::StartupPhase phase("readLockCheckData");
     QByteArray previousData;
     DataProtector dataProtector(lockCodeCheckDirPath);
     DataProtector::Status s = dataProtector.getData(&previousData);
@@ -920,6 +1098,7 @@ bool Daemon::ApiImpl::SecretsRequestQueue::compareTestCipherText(
             : QLatin1String("lockcodecheck");
     const QString lockCodeCheckDirPath = secretsDir.absoluteFilePath(lockCodeCheckDirName);
 
+    Daemon::ApiImpl::StartupPhase phase("readLockCheckData");
     QByteArray previousData;
     DataProtector dataProtector(lockCodeCheckDirPath);
     DataProtector::Status s = dataProtector.getData(&previousData);
@@ -994,6 +1173,7 @@ QByteArray Daemon::ApiImpl::SecretsRequestQueue::saltData() const
             : QLatin1String("initialsalt");
     const QString saltDirPath = secretsDir.absoluteFilePath(saltDirName);
 
+    Daemon::ApiImpl::StartupPhase phase("readSalt");
     DataProtector dataProtector(saltDirPath);
     QByteArray saltData;
     DataProtector::Status s = dataProtector.getData(&saltData);
@@ -1033,6 +1213,139 @@ QByteArray Daemon::ApiImpl::SecretsRequestQueue::saltData() const
     return saltData;
 }
 
+// Bounds for the calibrated cost, so that a slow device still derives keys
+// with a reasonable cost, and a fast one does not exceed plugin limits.
+static const int MinimumKdfIterations = 4000;
+static const int MaximumKdfIterations = 4000000;
+static const int DefaultKdfTargetMsecs = 500;
+
+Daemon::ApiImpl::MasterLockKdfParameters
+Daemon::ApiImpl::SecretsRequestQueue::calibrateKdfParameters(
+        Sailfish::Crypto::CryptoPlugin *cplugin,
+        const QByteArray &salt) const
+{
+    bool ok = false;
+    int targetMsecs = qgetenv(ENV_MASTERLOCK_KDF_TARGET_MSECS).toInt(&ok);
+    if (!ok || targetMsecs <= 0) {
+        targetMsecs = DefaultKdfTargetMsecs;
+    }
+
+    Sailfish::Crypto::Key keyTemplate;
+    keyTemplate.setAlgorithm(Sailfish::Crypto::CryptoManager::AlgorithmAes);
+    keyTemplate.setSize(256);
+    Sailfish::Crypto::KeyDerivationParameters kdfParams;
+    kdfParams.setKeyDerivationFunction(Sailfish::Crypto::CryptoManager::KdfPkcs5Pbkdf2);
+    kdfParams.setKeyDerivationMac(Sailfish::Crypto::CryptoManager::MacHmac);
+    kdfParams.setKeyDerivationDigestFunction(Sailfish::Crypto::CryptoManager::DigestSha512);
+    kdfParams.setInputData(QByteArray("calibration"));
+    kdfParams.setSalt(salt);
+    kdfParams.setOutputKeySize(256);
+
+    // time derivations with increasing cost until the measurement is
+    // long enough not to be dominated by the call overhead.
+    Daemon::ApiImpl::StartupPhase phase("calibrateKdf");
+    int iterations = 1000;
+    qint64 elapsedNsecs = 0;
+    forever {
+        kdfParams.setIterations(iterations);
+        QElapsedTimer timer;
+        timer.start();
+        QFuture<Sailfish::Crypto::KeyResult> future = QtConcurrent::run(
+                controller()->threadPoolForPlugin(cplugin->name()).data(),
+                Sailfish::Crypto::Daemon::ApiImpl::CryptoPluginFunctionWrapper::generateKey,
+                Sailfish::Crypto::PluginAndCustomParams(cplugin, masterLockCustomParameters()),
+                keyTemplate,
+                Sailfish::Crypto::KeyPairGenerationParameters(),
+                kdfParams);
+        future.waitForFinished();
+        elapsedNsecs = timer.nsecsElapsed();
+        const Sailfish::Crypto::KeyResult kr = future.result();
+        if (kr.result.code() != Sailfish::Crypto::Result::Succeeded) {
+            qCWarning(lcSailfishSecretsDaemon) << "Unable to calibrate key derivation with plugin" << cplugin->name()
+                                               << ":" << kr.result.errorMessage();
+            return MasterLockKdfParameters::legacy();
+        }
+        if (elapsedNsecs >= 20000000 || iterations >= 16000) {
+            break;
+        }
+        iterations *= 4;
+    }
+
+    // unlocking derives both keys, and the device lock key uses 4/3
+    // as many iterations as the bookkeeping key, so the bookkeeping key
+    // gets 3/7 of the target time.
+    const qint64 targetNsecs = qint64(targetMsecs) * 1000000 * 3 / 7;
+    const qint64 calibrated = qBound<qint64>(MinimumKdfIterations,
+                                             iterations * targetNsecs / qMax<qint64>(elapsedNsecs, 1),
+                                             MaximumKdfIterations * 3 / 4);
+    const int bookkeepingIterations = int(calibrated / 1000 * 1000);
+    qCDebug(lcSailfishSecretsDaemon) << "Calibrated master lock key derivation:" << bookkeepingIterations
+                                     << "iterations for" << targetMsecs << "ms";
+    return MasterLockKdfParameters(bookkeepingIterations, bookkeepingIterations / 3 * 4);
+}
+
+Daemon::ApiImpl::MasterLockKdfParameters
+Daemon::ApiImpl::SecretsRequestQueue::kdfParameters() const
+{
+    if (m_kdfParameters.isValid()) {
+        return m_kdfParameters;
+    }
+
+    Daemon::ApiImpl::StartupPhase phase("readKdfParameters");
+    MasterLockKdfParameters stored;
+    DataProtector::Status s = m_kdfParametersStore.readMasterLockParameters(&stored);
+
+    if (s == DataProtector::Irretrievable) {
+        qCWarning(lcSailfishSecretsDaemon) << "kdfParameters: key derivation parameters are irretrievably corrupted.";
+        dealWithDataCorruption();
+        return MasterLockKdfParameters();
+    } else if (s == DataProtector::ErrorCannotCreateDirectory) {
+        return MasterLockKdfParameters::legacy();
+    } else if (s != DataProtector::Success) {
+        qCWarning(lcSailfishSecretsDaemon) << "kdfParameters: can't read key derivation parameters. DataProtector returned:" << s;
+        return MasterLockKdfParameters();
+    }
+
+    m_kdfParameters = stored;
+    return m_kdfParameters;
+}
+
+// Returns the key derivation parameters calibrated for new custom lock
+// collections encrypted by the given plugin, or false if the plugin
+// has not been calibrated yet.
+bool Daemon::ApiImpl::SecretsRequestQueue::collectionKdfParameters(
+        const QString &encryptionPluginName,
+        QVariantMap *kdfParameters) const
+{
+    if (!m_collectionKdfParametersRead) {
+        DataProtector::Status s = m_kdfParametersStore.readCollectionParameters(&m_collectionKdfParameters);
+        if (s != DataProtector::Success) {
+            // the collection parameters are only a cache of the calibration,
+            // so there is no need to reset the data if they are corrupted.
+            qCWarning(lcSailfishSecretsDaemon) << "collectionKdfParameters: can't read key derivation parameters. DataProtector returned:" << s;
+            m_collectionKdfParameters.clear();
+        }
+        m_collectionKdfParametersRead = true;
+    }
+
+    if (!m_collectionKdfParameters.contains(encryptionPluginName)) {
+        return false;
+    }
+    *kdfParameters = m_collectionKdfParameters.value(encryptionPluginName);
+    return true;
+}
+
+void Daemon::ApiImpl::SecretsRequestQueue::setCollectionKdfParameters(
+        const QString &encryptionPluginName,
+        const QVariantMap &kdfParameters)
+{
+    m_collectionKdfParameters.insert(encryptionPluginName, kdfParameters);
+    if (!m_kdfParametersStore.writeCollectionParameters(m_collectionKdfParameters)) {
+        // the calibration is still used until the daemon exits.
+        qCWarning(lcSailfishSecretsDaemon) << "Unable to store the collection key derivation parameters of plugin" << encryptionPluginName;
+    }
+}
+
 bool Daemon::ApiImpl::SecretsRequestQueue::noLockCode() const
 {
     return m_noLockCode;
@@ -1204,6 +1517,8 @@ QString Daemon::ApiImpl::SecretsRequestQueue::requestTypeToString(int type) cons
         case ModifyLockCodeRequest:                 return QLatin1String("ModifyLockCodeRequest");
         case ProvideLockCodeRequest:                return QLatin1String("ProvideLockCodeRequest");
         case ForgetLockCodeRequest:                 return QLatin1String("ForgetLockCodeRequest");
+        case FindSecretsInCollectionsRequest:       return QLatin1String("FindSecretsInCollectionsRequest");
+        case GetCollectionSecretFilterDataRequest:  return QLatin1String("GetCollectionSecretFilterDataRequest");
         case UseCollectionKeyPreCheckRequest:       return QLatin1String("UseCollectionKeyPreCheckRequest");
         case SetCollectionKeyPreCheckRequest:       return QLatin1String("SetCollectionKeyPreCheckRequest");
         case SetCollectionKeyRequest:               return QLatin1String("SetCollectionKeyRequest");
@@ -1588,6 +1903,31 @@ void Daemon::ApiImpl::SecretsRequestQueue::handlePendingRequest(
             }
             break;
         }
+        case GetCollectionSecretFilterDataRequest: {
+            qCDebug(lcSailfishSecretsDaemon) << "Handling GetCollectionSecretFilterDataRequest from client:" << request->remotePid << ", request number:" << request->requestId;
+            Secret::Identifier identifier = request->inParams.size()
+                    ? request->inParams.takeFirst().value<Secret::Identifier>()
+                    : Secret::Identifier();
+            Secret secret;
+            Result result = masterLocked()
+                    ? Result(Result::SecretsDaemonLockedError,
+                             QLatin1String("The secrets database is locked"))
+                    : m_requestProcessor->getCollectionSecretFilterData(
+                                      request->remotePid,
+                                      request->requestId,
+                                      identifier,
+                                      &secret);
+            // send the reply to the calling peer.
+            if (result.code() == Result::Pending) {
+                // waiting for asynchronous flow to complete
+                *completed = false;
+            } else {
+                request->connection.send(request->message.createReply() << QVariant::fromValue<Result>(result)
+                                                                        << QVariant::fromValue<Secret>(secret));
+                *completed = true;
+            }
+            break;
+        }
         case GetStandaloneSecretRequest: {
             qCDebug(lcSailfishSecretsDaemon) << "Handling GetStandaloneSecretRequest from client:" << request->remotePid << ", request number:" << request->requestId;
             Secret::Identifier identifier = request->inParams.size()
@@ -1637,6 +1977,9 @@ void Daemon::ApiImpl::SecretsRequestQueue::handlePendingRequest(
             SecretManager::FilterOperator filterOperator = request->inParams.size()
                     ? request->inParams.takeFirst().value<SecretManager::FilterOperator>()
                     : SecretManager::OperatorOr;
+            SecretManager::FilterMatch filterMatch = request->inParams.size()
+                    ? request->inParams.takeFirst().value<SecretManager::FilterMatch>()
+                    : SecretManager::MatchExact;
             SecretManager::UserInteractionMode userInteractionMode = request->inParams.size()
                     ? request->inParams.takeFirst().value<SecretManager::UserInteractionMode>()
                     : SecretManager::PreventInteraction;
@@ -1652,6 +1995,7 @@ void Daemon::ApiImpl::SecretsRequestQueue::handlePendingRequest(
                                       storagePluginName,
                                       filter,
                                       filterOperator,
+                                      filterMatch,
                                       userInteractionMode,
                                       interactionServiceAddress,
                                       &identifiers);
@@ -1681,6 +2025,9 @@ void Daemon::ApiImpl::SecretsRequestQueue::handlePendingRequest(
             SecretManager::FilterOperator filterOperator = request->inParams.size()
                     ? request->inParams.takeFirst().value<SecretManager::FilterOperator>()
                     : SecretManager::OperatorOr;
+            SecretManager::FilterMatch filterMatch = request->inParams.size()
+                    ? request->inParams.takeFirst().value<SecretManager::FilterMatch>()
+                    : SecretManager::MatchExact;
             SecretManager::UserInteractionMode userInteractionMode = request->inParams.size()
                     ? request->inParams.takeFirst().value<SecretManager::UserInteractionMode>()
                     : SecretManager::PreventInteraction;
@@ -1695,6 +2042,7 @@ void Daemon::ApiImpl::SecretsRequestQueue::handlePendingRequest(
                                       storagePluginName,
                                       filter,
                                       filterOperator,
+                                      filterMatch,
                                       userInteractionMode,
                                       interactionServiceAddress,
                                       &identifiers);
@@ -1713,6 +2061,49 @@ void Daemon::ApiImpl::SecretsRequestQueue::handlePendingRequest(
             }
             break;
         }
+        case FindSecretsInCollectionsRequest: {
+            qCDebug(lcSailfishSecretsDaemon) << "Handling FindSecretsInCollectionsRequest from client:" << request->remotePid << ", request number:" << request->requestId;
+            QString storagePluginName = request->inParams.size()
+                    ? request->inParams.takeFirst().value<QString>()
+                    : QString();
+            Secret::FilterData filter = request->inParams.size()
+                    ? request->inParams.takeFirst().value<Secret::FilterData >()
+                    : Secret::FilterData();
+            SecretManager::FilterOperator filterOperator = request->inParams.size()
+                    ? request->inParams.takeFirst().value<SecretManager::FilterOperator>()
+                    : SecretManager::OperatorOr;
+            SecretManager::FilterMatch filterMatch = request->inParams.size()
+                    ? request->inParams.takeFirst().value<SecretManager::FilterMatch>()
+                    : SecretManager::MatchExact;
+            QVector<Secret::Identifier> identifiers;
+            QVector<Secret::Identifier> skippedCollections;
+            QVector<Result> skippedCollectionResults;
+            Result result = masterLocked()
+                    ? Result(Result::SecretsDaemonLockedError,
+                             QLatin1String("The secrets database is locked"))
+                    : m_requestProcessor->findSecretsInCollections(
+                                      request->remotePid,
+                                      request->requestId,
+                                      storagePluginName,
+                                      filter,
+                                      filterOperator,
+                                      filterMatch,
+                                      &identifiers,
+                                      &skippedCollections,
+                                      &skippedCollectionResults);
+            // send the reply to the calling peer.
+            if (result.code() == Result::Pending) {
+                // waiting for asynchronous flow to complete
+                *completed = false;
+            } else {
+                request->connection.send(request->message.createReply() << QVariant::fromValue<Result>(result)
+                                                                        << QVariant::fromValue<QVector<Secret::Identifier> >(identifiers)
+                                                                        << QVariant::fromValue<QVector<Secret::Identifier> >(skippedCollections)
+                                                                        << QVariant::fromValue<QVector<Result> >(skippedCollectionResults));
+                *completed = true;
+            }
+            break;
+        }
         case DeleteCollectionSecretRequest: {
             qCDebug(lcSailfishSecretsDaemon) << "Handling DeleteCollectionSecretRequest from client:" << request->remotePid << ", request number:" << request->requestId;
             Secret::Identifier identifier = request->inParams.size()
@@ -2324,6 +2715,25 @@ void Daemon::ApiImpl::SecretsRequestQueue::handleFinishedRequest(
             }
             break;
         }
+        case GetCollectionSecretFilterDataRequest: {
+            Result result = request->outParams.size()
+                    ? request->outParams.takeFirst().value<Result>()
+                    : Result(Result::UnknownError,
+                             QLatin1String("Unable to determine result of GetCollectionSecretFilterDataRequest request"));
+            if (result.code() == Result::Pending) {
+                // shouldn't happen!
+                qCWarning(lcSailfishSecretsDaemon) << "GetCollectionSecretFilterDataRequest:" << request->requestId << "finished as pending!";
+                *completed = true;
+            } else {
+                Secret secret = request->outParams.size()
+                        ? request->outParams.takeFirst().value<Secret>()
+                        : Secret();
+                request->connection.send(request->message.createReply() << QVariant::fromValue<Result>(result)
+                                                                        << QVariant::fromValue<Secret>(secret));
+                *completed = true;
+            }
+            break;
+        }
         case GetStandaloneSecretRequest: {
             Result result = request->outParams.size()
                     ? request->outParams.takeFirst().value<Result>()
@@ -2393,6 +2803,33 @@ void Daemon::ApiImpl::SecretsRequestQueue::handleFinishedRequest(
             }
             break;
         }
+        case FindSecretsInCollectionsRequest: {
+            Result result = request->outParams.size()
+                    ? request->outParams.takeFirst().value<Result>()
+                    : Result(Result::UnknownError,
+                             QLatin1String("Unable to determine result of FindSecretsInCollectionsRequest request"));
+            if (result.code() == Result::Pending) {
+                // shouldn't happen!
+                qCWarning(lcSailfishSecretsDaemon) << "FindSecretsInCollectionsRequest:" << request->requestId << "finished as pending!";
+                *completed = true;
+            } else {
+                QVector<Secret::Identifier> identifiers = request->outParams.size()
+                        ? request->outParams.takeFirst().value<QVector<Secret::Identifier> >()
+                        : QVector<Secret::Identifier>();
+                QVector<Secret::Identifier> skippedCollections = request->outParams.size()
+                        ? request->outParams.takeFirst().value<QVector<Secret::Identifier> >()
+                        : QVector<Secret::Identifier>();
+                QVector<Result> skippedCollectionResults = request->outParams.size()
+                        ? request->outParams.takeFirst().value<QVector<Result> >()
+                        : QVector<Result>();
+                request->connection.send(request->message.createReply() << QVariant::fromValue<Result>(result)
+                                                                        << QVariant::fromValue<QVector<Secret::Identifier> >(identifiers)
+                                                                        << QVariant::fromValue<QVector<Secret::Identifier> >(skippedCollections)
+                                                                        << QVariant::fromValue<QVector<Result> >(skippedCollectionResults));
+                *completed = true;
+            }
+            break;
+        }
         case DeleteCollectionSecretRequest: {
             Result result = request->outParams.size()
                     ? request->outParams.takeFirst().value<Result>()
@@ -10,6 +10,7 @@
 
 #include "requestqueue_p.h"
 #include "applicationpermissions_p.h"
+#include "kdfparametersstore_p.h"
 
 #include "Secrets/secret.h"
 #include "Secrets/interactionparameters.h"
@@ -31,10 +32,19 @@
 // of the crypto plugin to use when deriving the master lock keys.
 #define ENV_MASTERLOCK_CRYPTOPLUGIN "SAILFISH_SECRETSD_MASTERLOCK_CRYPTOPLUGIN"
 
+// the environment variable which can be used to specify the time in
+// milliseconds which deriving the master lock keys should take.
+#define ENV_MASTERLOCK_KDF_TARGET_MSECS "SAILFISH_SECRETSD_MASTERLOCK_KDF_TARGET_MSECS"
+
+// the environment variable which can be used to specify the time in
+// milliseconds which deriving a custom lock collection key should take.
+#define ENV_COLLECTION_KDF_TARGET_MSECS "SAILFISH_SECRETSD_COLLECTION_KDF_TARGET_MSECS"
+
 namespace Sailfish {
 
 // forward declare the CryptoRequestQueue type
 namespace Crypto {
+    class CryptoPlugin;
     namespace Daemon {
         namespace ApiImpl {
             class CryptoRequestQueue;
@@ -57,6 +67,7 @@ class SecretsDBusObject : public QObject, protected QDBusContext
     Q_CLASSINFO("D-Bus Introspection", ""
     "  <interface name=\"org.sailfishos.secrets\">\n"
     "      <method name=\"getPluginInfo\">\n"
+    "          <arg name=\"traceId\" type=\"t\" direction=\"in\" />\n"
     "          <arg name=\"result\" type=\"(iis)\" direction=\"out\" />\n"
     "          <arg name=\"storagePlugins\" type=\"a(ssi)\" direction=\"out\" />\n"
     "          <arg name=\"encryptionPlugins\" type=\"a(ssi)\" direction=\"out\" />\n"
@@ -69,6 +80,7 @@ class SecretsDBusObject : public QObject, protected QDBusContext
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.Out4\" value=\"QVector<Sailfish::Secrets::PluginInfo>\" />\n"
     "      </method>\n"
     "      <method name=\"getHealthInfo\">\n"
+    "          <arg name=\"traceId\" type=\"t\" direction=\"in\" />\n"
     "          <arg name=\"result\" type=\"(iis)\" direction=\"out\" />\n"
     "          <arg name=\"saltDataHealth\" type=\"(i)\" direction=\"out\" />\n"
     "          <arg name=\"masterlockHealth\" type=\"(i)\" direction=\"out\" />\n"
@@ -78,6 +90,7 @@ class SecretsDBusObject : public QObject, protected QDBusContext
     "      </method>\n"
     "      <method name=\"userInput\">\n"
     "          <arg name=\"uiParams\" type=\"(sss(i)sss(i)(i))\" direction=\"in\" />\n"
+    "          <arg name=\"traceId\" type=\"t\" direction=\"in\" />\n"
     "          <arg name=\"result\" type=\"(iis)\" direction=\"out\" />\n"
     "          <arg name=\"data\" type=\"ay\" direction=\"out\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.In0\" value=\"Sailfish::Secrets::InteractionParameters\" />\n"
@@ -85,6 +98,7 @@ class SecretsDBusObject : public QObject, protected QDBusContext
     "      </method>\n"
     "      <method name=\"collectionNames\">\n"
     "          <arg name=\"storagePluginName\" type=\"s\" direction=\"in\" />\n"
+    "          <arg name=\"traceId\" type=\"t\" direction=\"in\" />\n"
     "          <arg name=\"result\" type=\"(iis)\" direction=\"out\" />\n"
     "          <arg name=\"names\" type=\"a{sv}\" direction=\"out\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.Out0\" value=\"Sailfish::Secrets::Result\" />\n"
@@ -95,6 +109,7 @@ class SecretsDBusObject : public QObject, protected QDBusContext
     "          <arg name=\"encryptionPluginName\" type=\"s\" direction=\"in\" />\n"
     "          <arg name=\"unlockSemantic\" type=\"(i)\" direction=\"in\" />\n"
     "          <arg name=\"accessControlMode\" type=\"(i)\" direction=\"in\" />\n"
+    "          <arg name=\"traceId\" type=\"t\" direction=\"in\" />\n"
     "          <arg name=\"result\" type=\"(iis)\" direction=\"out\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.In3\" value=\"Sailfish::Secrets::SecretManager::DeviceLockUnlockSemantic\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.In4\" value=\"Sailfish::Secrets::SecretManager::AccessControlMode\" />\n"
@@ -109,6 +124,7 @@ class SecretsDBusObject : public QObject, protected QDBusContext
     "          <arg name=\"accessControlMode\" type=\"(i)\" direction=\"in\" />\n"
     "          <arg name=\"userInteractionMode\" type=\"(i)\" direction=\"in\" />\n"
     "          <arg name=\"interactionServiceAddress\" type=\"s\" direction=\"in\" />\n"
+    "          <arg name=\"traceId\" type=\"t\" direction=\"in\" />\n"
     "          <arg name=\"result\" type=\"(iis)\" direction=\"out\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.In4\" value=\"Sailfish::Secrets::SecretManager::CustomLockUnlockSemantic\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.In5\" value=\"Sailfish::Secrets::SecretManager::AccessControlMode\" />\n"
@@ -120,6 +136,7 @@ class SecretsDBusObject : public QObject, protected QDBusContext
     "          <arg name=\"storagePluginName\" type=\"s\" direction=\"in\" />\n"
     "          <arg name=\"userInteractionMode\" type=\"(i)\" direction=\"in\" />\n"
     "          <arg name=\"interactionServiceAddress\" type=\"s\" direction=\"in\" />\n"
+    "          <arg name=\"traceId\" type=\"t\" direction=\"in\" />\n"
     "          <arg name=\"result\" type=\"(iis)\" direction=\"out\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.In2\" value=\"Sailfish::Secrets::SecretManager::UserInteractionMode\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.Out0\" value=\"Sailfish::Secrets::Result\" />\n"
@@ -129,6 +146,7 @@ class SecretsDBusObject : public QObject, protected QDBusContext
     "          <arg name=\"uiParams\" type=\"(sss(i)sss(i)(i))\" direction=\"in\" />\n"
     "          <arg name=\"userInteractionMode\" type=\"(i)\" direction=\"in\" />\n"
     "          <arg name=\"interactionServiceAddress\" type=\"s\" direction=\"in\" />\n"
+    "          <arg name=\"traceId\" type=\"t\" direction=\"in\" />\n"
     "          <arg name=\"result\" type=\"(iis)\" direction=\"out\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.In0\" value=\"Sailfish::Secrets::Secret\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.In1\" value=\"Sailfish::Secrets::InteractionParameters\" />\n"
@@ -143,6 +161,7 @@ class SecretsDBusObject : public QObject, protected QDBusContext
     "          <arg name=\"accessControlMode\" type=\"(i)\" direction=\"in\" />\n"
     "          <arg name=\"userInteractionMode\" type=\"(i)\" direction=\"in\" />\n"
     "          <arg name=\"interactionServiceAddress\" type=\"s\" direction=\"in\" />\n"
+    "          <arg name=\"traceId\" type=\"t\" direction=\"in\" />\n"
     "          <arg name=\"result\" type=\"(iis)\" direction=\"out\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.In0\" value=\"Sailfish::Secrets::Secret\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.In2\" value=\"Sailfish::Secrets::InteractionParameters\" />\n"
@@ -160,6 +179,7 @@ class SecretsDBusObject : public QObject, protected QDBusContext
     "          <arg name=\"accessControlMode\" type=\"(i)\" direction=\"in\" />\n"
     "          <arg name=\"userInteractionMode\" type=\"(i)\" direction=\"in\" />\n"
     "          <arg name=\"interactionServiceAddress\" type=\"s\" direction=\"in\" />\n"
+    "          <arg name=\"traceId\" type=\"t\" direction=\"in\" />\n"
     "          <arg name=\"result\" type=\"(iis)\" direction=\"out\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.In0\" value=\"Sailfish::Secrets::Secret\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.In3\" value=\"Sailfish::Secrets::InteractionParameters\" />\n"
@@ -172,6 +192,7 @@ class SecretsDBusObject : public QObject, protected QDBusContext
     "          <arg name=\"identifier\" type=\"(sss)\" direction=\"in\" />\n"
     "          <arg name=\"userInteractionMode\" type=\"(i)\" direction=\"in\" />\n"
     "          <arg name=\"interactionServiceAddress\" type=\"s\" direction=\"in\" />\n"
+    "          <arg name=\"traceId\" type=\"t\" direction=\"in\" />\n"
     "          <arg name=\"result\" type=\"(iis)\" direction=\"out\" />\n"
     "          <arg name=\"secret\" type=\"((sss)aya{sv})\" direction=\"out\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.In0\" value=\"Sailfish::Secrets::Secret::Identifier\" />\n"
@@ -179,25 +200,56 @@ class SecretsDBusObject : public QObject, protected QDBusContext
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.Out0\" value=\"Sailfish::Secrets::Result\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.Out1\" value=\"Sailfish::Secrets::Secret\" />\n"
     "      </method>\n"
+    "      <method name=\"getSecretFilterData\">\n"
+    "          <arg name=\"identifier\" type=\"(sss)\" direction=\"in\" />\n"
+    "          <arg name=\"traceId\" type=\"t\" direction=\"in\" />\n"
+    "          <arg name=\"result\" type=\"(iis)\" direction=\"out\" />\n"
+    "          <arg name=\"secret\" type=\"((sss)aya{sv})\" direction=\"out\" />\n"
+    "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.In0\" value=\"Sailfish::Secrets::Secret::Identifier\" />\n"
+    "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.Out0\" value=\"Sailfish::Secrets::Result\" />\n"
+    "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.Out1\" value=\"Sailfish::Secrets::Secret\" />\n"
+    "      </method>\n"
     "      <method name=\"findSecrets\">\n"
     "          <arg name=\"collectionName\" type=\"s\" direction=\"in\" />\n"
     "          <arg name=\"storagePluginName\" type=\"s\" direction=\"in\" />\n"
     "          <arg name=\"filter\" type=\"a{ss}\" direction=\"in\" />\n"
     "          <arg name=\"filterOperator\" type=\"(i)\" direction=\"in\" />\n"
+    "          <arg name=\"filterMatch\" type=\"(i)\" direction=\"in\" />\n"
     "          <arg name=\"userInteractionMode\" type=\"(i)\" direction=\"in\" />\n"
     "          <arg name=\"interactionServiceAddress\" type=\"s\" direction=\"in\" />\n"
+    "          <arg name=\"traceId\" type=\"t\" direction=\"in\" />\n"
     "          <arg name=\"result\" type=\"(iis)\" direction=\"out\" />\n"
-    "          <arg name=\"identifiers\" type=\"(a(sss))\" direction=\"out\" />\n"
+    "          <arg name=\"identifiers\" type=\"a(ssas)\" direction=\"out\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.In2\" value=\"Sailfish::Secrets::Secret::FilterData\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.In3\" value=\"Sailfish::Secrets::SecretManager::FilterOperator\" />\n"
-    "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.In4\" value=\"Sailfish::Secrets::SecretManager::UserInteractionMode\" />\n"
+    "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.In4\" value=\"Sailfish::Secrets::SecretManager::FilterMatch\" />\n"
+    "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.In5\" value=\"Sailfish::Secrets::SecretManager::UserInteractionMode\" />\n"
+    "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.Out0\" value=\"Sailfish::Secrets::Result\" />\n"
+    "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.Out1\" value=\"QVector<Sailfish::Secrets::Secret::Identifier>\" />\n"
+    "      </method>\n"
+    "      <method name=\"findSecretsInCollections\">\n"
+    "          <arg name=\"storagePluginName\" type=\"s\" direction=\"in\" />\n"
+    "          <arg name=\"filter\" type=\"a{ss}\" direction=\"in\" />\n"
+    "          <arg name=\"filterOperator\" type=\"(i)\" direction=\"in\" />\n"
+    "          <arg name=\"filterMatch\" type=\"(i)\" direction=\"in\" />\n"
+    "          <arg name=\"traceId\" type=\"t\" direction=\"in\" />\n"
+    "          <arg name=\"result\" type=\"(iis)\" direction=\"out\" />\n"
+    "          <arg name=\"identifiers\" type=\"a(ssas)\" direction=\"out\" />\n"
+    "          <arg name=\"skippedCollections\" type=\"a(ssas)\" direction=\"out\" />\n"
+    "          <arg name=\"skippedCollectionResults\" type=\"a(iis)\" direction=\"out\" />\n"
+    "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.In1\" value=\"Sailfish::Secrets::Secret::FilterData\" />\n"
+    "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.In2\" value=\"Sailfish::Secrets::SecretManager::FilterOperator\" />\n"
+    "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.In3\" value=\"Sailfish::Secrets::SecretManager::FilterMatch\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.Out0\" value=\"Sailfish::Secrets::Result\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.Out1\" value=\"QVector<Sailfish::Secrets::Secret::Identifier>\" />\n"
+    "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.Out2\" value=\"QVector<Sailfish::Secrets::Secret::Identifier>\" />\n"
+    "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.Out3\" value=\"QVector<Sailfish::Secrets::Result>\" />\n"
     "      </method>\n"
     "      <method name=\"deleteSecret\">\n"
     "          <arg name=\"identifier\" type=\"(sss)\" direction=\"in\" />\n"
     "          <arg name=\"userInteractionMode\" type=\"(i)\" direction=\"in\" />\n"
     "          <arg name=\"interactionServiceAddress\" type=\"s\" direction=\"in\" />\n"
+    "          <arg name=\"traceId\" type=\"t\" direction=\"in\" />\n"
     "          <arg name=\"result\" type=\"(iis)\" direction=\"out\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.In0\" value=\"Sailfish::Secrets::Secret::Identifier\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.In1\" value=\"Sailfish::Secrets::SecretManager::UserInteractionMode\" />\n"
@@ -208,6 +260,7 @@ class SecretsDBusObject : public QObject, protected QDBusContext
     "          <arg name=\"lockCodeTarget\" type=\"s\" direction=\"in\" />\n"
     "          <arg name=\"result\" type=\"(iis)\" direction=\"out\" />\n"
     "          <arg name=\"lockStatus\" type=\"(i)\" direction=\"in\" />\n"
+    "          <arg name=\"traceId\" type=\"t\" direction=\"in\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.In0\" value=\"Sailfish::Secrets::LockCodeRequest::LockCodeTargetType\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.Out0\" value=\"Sailfish::Secrets::Result\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.Out1\" value=\"Sailfish::Secrets::LockCodeRequest::LockStatus\" />\n"
@@ -218,6 +271,7 @@ class SecretsDBusObject : public QObject, protected QDBusContext
     "          <arg name=\"interactionParameters\" type=\"(sss(i)sss(i)(i))\" direction=\"in\" />\n"
     "          <arg name=\"userInteractionMode\" type=\"(i)\" direction=\"in\" />\n"
     "          <arg name=\"interactionServiceAddress\" type=\"s\" direction=\"in\" />\n"
+    "          <arg name=\"traceId\" type=\"t\" direction=\"in\" />\n"
     "          <arg name=\"result\" type=\"(iis)\" direction=\"out\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.In0\" value=\"Sailfish::Secrets::LockCodeRequest::LockCodeTargetType\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.In2\" value=\"Sailfish::Secrets::InteractionParameters\" />\n"
@@ -230,6 +284,7 @@ class SecretsDBusObject : public QObject, protected QDBusContext
     "          <arg name=\"interactionParameters\" type=\"(sss(i)sss(i)(i))\" direction=\"in\" />\n"
     "          <arg name=\"userInteractionMode\" type=\"(i)\" direction=\"in\" />\n"
     "          <arg name=\"interactionServiceAddress\" type=\"s\" direction=\"in\" />\n"
+    "          <arg name=\"traceId\" type=\"t\" direction=\"in\" />\n"
     "          <arg name=\"result\" type=\"(iis)\" direction=\"out\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.In0\" value=\"Sailfish::Secrets::LockCodeRequest::LockCodeTargetType\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.In2\" value=\"Sailfish::Secrets::InteractionParameters\" />\n"
@@ -242,6 +297,7 @@ class SecretsDBusObject : public QObject, protected QDBusContext
     "          <arg name=\"interactionParameters\" type=\"(sss(i)sss(i)(i))\" direction=\"in\" />\n"
     "          <arg name=\"userInteractionMode\" type=\"(i)\" direction=\"in\" />\n"
     "          <arg name=\"interactionServiceAddress\" type=\"s\" direction=\"in\" />\n"
+    "          <arg name=\"traceId\" type=\"t\" direction=\"in\" />\n"
     "          <arg name=\"result\" type=\"(iis)\" direction=\"out\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.In0\" value=\"Sailfish::Secrets::LockCodeRequest::LockCodeTargetType\" />\n"
     "          <annotation name=\"org.qtproject.QtDBus.QtTypeName.In2\" value=\"Sailfish::Secrets::InteractionParameters\" />\n"
@@ -257,6 +313,7 @@ public:
 public Q_SLOTS:
     // retrieve information about available plugins
     void getPluginInfo(
+            quint64 traceId,
             const QDBusMessage &message,
             Sailfish::Secrets::Result &result,
             QVector<Sailfish::Secrets::PluginInfo> &storagePlugins,
@@ -266,6 +323,7 @@ public Q_SLOTS:
 
     // retrieve information about secrets health
     void getHealthInfo(
+            quint64 traceId,
             const QDBusMessage &message,
             Sailfish::Secrets::Result &result,
             Sailfish::Secrets::HealthCheckRequest::Health &saltDataHealth,
@@ -274,6 +332,7 @@ public Q_SLOTS:
     // retrieve user input for the client (daemon)
     void userInput(
             const Sailfish::Secrets::InteractionParameters &uiParams,
+            quint64 traceId,
             const QDBusMessage &message,
             Sailfish::Secrets::Result &result,
             QByteArray &data);
@@ -281,6 +340,7 @@ public Q_SLOTS:
     // retrieve the names of collections
     void collectionNames(
             const QString &storagePluginName,
+            quint64 traceId,
             const QDBusMessage &message,
             Sailfish::Secrets::Result &result,
             QVariantMap &names);
@@ -292,6 +352,7 @@ public Q_SLOTS:
             const QString &encryptionPluginName,
             Sailfish::Secrets::SecretManager::DeviceLockUnlockSemantic unlockSemantic,
             Sailfish::Secrets::SecretManager::AccessControlMode accessControlMode,
+            quint64 traceId,
             const QDBusMessage &message,
             Sailfish::Secrets::Result &result);
 
@@ -305,6 +366,7 @@ public Q_SLOTS:
             Sailfish::Secrets::SecretManager::AccessControlMode accessControlMode,
             Sailfish::Secrets::SecretManager::UserInteractionMode userInteractionMode,
             const QString &interactionServiceAddress,
+            quint64 traceId,
             const QDBusMessage &message,
             Sailfish::Secrets::Result &result);
 
@@ -314,6 +376,7 @@ public Q_SLOTS:
             const QString &storagePluginName,
             Sailfish::Secrets::SecretManager::UserInteractionMode userInteractionMode,
             const QString &interactionServiceAddress,
+            quint64 traceId,
             const QDBusMessage &message,
             Sailfish::Secrets::Result &result);
 
@@ -323,6 +386,7 @@ public Q_SLOTS:
             const Sailfish::Secrets::InteractionParameters &uiParams,
             Sailfish::Secrets::SecretManager::UserInteractionMode userInteractionMode,
             const QString &interactionServiceAddress,
+            quint64 traceId,
             const QDBusMessage &message,
             Sailfish::Secrets::Result &result);
 
@@ -335,6 +399,7 @@ public Q_SLOTS:
             Sailfish::Secrets::SecretManager::AccessControlMode accessControlMode,
             Sailfish::Secrets::SecretManager::UserInteractionMode userInteractionMode,
             const QString &interactionServiceAddress,
+            quint64 traceId,
             const QDBusMessage &message,
             Sailfish::Secrets::Result &result);
 
@@ -348,6 +413,7 @@ public Q_SLOTS:
             Sailfish::Secrets::SecretManager::AccessControlMode accessControlMode,
             Sailfish::Secrets::SecretManager::UserInteractionMode userInteractionMode,
             const QString &interactionServiceAddress,
+            quint64 traceId,
             const QDBusMessage &message,
             Sailfish::Secrets::Result &result);
 
@@ -356,6 +422,15 @@ public Q_SLOTS:
             const Sailfish::Secrets::Secret::Identifier &identifier,
             Sailfish::Secrets::SecretManager::UserInteractionMode userInteractionMode,
             const QString &interactionServiceAddress,
+            quint64 traceId,
+            const QDBusMessage &message,
+            Sailfish::Secrets::Result &result,
+            Sailfish::Secrets::Secret &secret);
+
+    // get the filter data of a secret, without its secret data
+    void getSecretFilterData(
+            const Sailfish::Secrets::Secret::Identifier &identifier,
+            quint64 traceId,
             const QDBusMessage &message,
             Sailfish::Secrets::Result &result,
             Sailfish::Secrets::Secret &secret);
@@ -366,17 +441,33 @@ public Q_SLOTS:
             const QString &storagePluginName,
             const Sailfish::Secrets::Secret::FilterData &filter,
             Sailfish::Secrets::SecretManager::FilterOperator filterOperator,
+            Sailfish::Secrets::SecretManager::FilterMatch filterMatch,
             Sailfish::Secrets::SecretManager::UserInteractionMode userInteractionMode,
             const QString &interactionServiceAddress,
+            quint64 traceId,
             const QDBusMessage &message,
             Sailfish::Secrets::Result &result,
             QVector<Sailfish::Secrets::Secret::Identifier> &identifiers);
 
+    // find secrets via filter in all collections of one or all storage plugins
+    void findSecretsInCollections(
+            const QString &storagePluginName,
+            const Sailfish::Secrets::Secret::FilterData &filter,
+            Sailfish::Secrets::SecretManager::FilterOperator filterOperator,
+            Sailfish::Secrets::SecretManager::FilterMatch filterMatch,
+            quint64 traceId,
+            const QDBusMessage &message,
+            Sailfish::Secrets::Result &result,
+            QVector<Sailfish::Secrets::Secret::Identifier> &identifiers,
+            QVector<Sailfish::Secrets::Secret::Identifier> &skippedCollections,
+            QVector<Sailfish::Secrets::Result> &skippedCollectionResults);
+
     // delete a secret
     void deleteSecret(
             const Sailfish::Secrets::Secret::Identifier &identifier,
             Sailfish::Secrets::SecretManager::UserInteractionMode userInteractionMode,
             const QString &interactionServiceAddress,
+            quint64 traceId,
             const QDBusMessage &message,
             Sailfish::Secrets::Result &result);
 
@@ -384,6 +475,7 @@ public Q_SLOTS:
     void queryLockStatus(
             Sailfish::Secrets::LockCodeRequest::LockCodeTargetType lockCodeTargetType,
             const QString &lockCodeTarget,
+            quint64 traceId,
             const QDBusMessage &message,
             Sailfish::Secrets::Result &result,
             Sailfish::Secrets::LockCodeRequest::LockStatus &lockStatus);
@@ -395,6 +487,7 @@ public Q_SLOTS:
             const Sailfish::Secrets::InteractionParameters &interactionParameters,
             Sailfish::Secrets::SecretManager::UserInteractionMode userInteractionMode,
             const QString &interactionServiceAddress,
+            quint64 traceId,
             const QDBusMessage &message,
             Sailfish::Secrets::Result &result);
 
@@ -405,6 +498,7 @@ public Q_SLOTS:
             const Sailfish::Secrets::InteractionParameters &interactionParameters,
             Sailfish::Secrets::SecretManager::UserInteractionMode userInteractionMode,
             const QString &interactionServiceAddress,
+            quint64 traceId,
             const QDBusMessage &message,
             Sailfish::Secrets::Result &result);
 
@@ -415,6 +509,7 @@ public Q_SLOTS:
             const Sailfish::Secrets::InteractionParameters &interactionParameters,
             Sailfish::Secrets::SecretManager::UserInteractionMode userInteractionMode,
             const QString &interactionServiceAddress,
+            quint64 traceId,
             const QDBusMessage &message,
             Sailfish::Secrets::Result &result);
 
@@ -439,8 +534,11 @@ public:
 
     Sailfish::Secrets::Daemon::Controller *controller() const;
     QWeakPointer<QThreadPool> secretsThreadPool();
+    QWeakPointer<QThreadPool> storagePluginThreadPool(const QString &pluginName);
     bool initialize(const QByteArray &lockCode, InitializationMode mode);
     bool initializePlugins();
+    bool holdsUnlockedState() const;
+    int releaseDatabaseMemory();
 
     void handlePendingRequest(Sailfish::Secrets::Daemon::ApiImpl::RequestQueue::RequestData *request, bool *completed) Q_DECL_OVERRIDE;
     void handleFinishedRequest(Sailfish::Secrets::Daemon::ApiImpl::RequestQueue::RequestData *request, bool *completed) Q_DECL_OVERRIDE;
@@ -455,6 +553,7 @@ public: // helpers for crypto API: secretscryptohelpers.cpp
 
 private:
     QSharedPointer<QThreadPool> m_secretsThreadPool;
+    QMap<QString, QSharedPointer<QThreadPool> > m_storagePluginThreadPools;
     Sailfish::Secrets::Daemon::ApiImpl::ApplicationPermissions *m_appPermissions;
     Sailfish::Secrets::Daemon::ApiImpl::RequestProcessor *m_requestProcessor;
     Sailfish::Secrets::Daemon::Controller *m_controller;
@@ -468,7 +567,13 @@ private:
     bool m_noLockCode;
     bool m_locked;
     mutable QByteArray m_saltData;
-    bool generateKeyData(const QByteArray &lockCode, const QString &cipherPluginName, QByteArray *bkdbKey, QByteArray *deviceLockKey, QByteArray *testCipherText, QString *usedCipherPluginName) const;
+    Sailfish::Secrets::Daemon::ApiImpl::KdfParametersStore m_kdfParametersStore;
+    mutable Sailfish::Secrets::Daemon::ApiImpl::MasterLockKdfParameters m_kdfParameters;
+    mutable QMap<QString, QVariantMap> m_collectionKdfParameters;
+    mutable bool m_collectionKdfParametersRead;
+    bool generateKeyData(const QByteArray &lockCode, const QString &cipherPluginName, bool recalibrate, Sailfish::Secrets::Daemon::ApiImpl::MasterLockKdfParameters *kdfParameters, QByteArray *bkdbKey, QByteArray *deviceLockKey, QByteArray *testCipherText, QString *usedCipherPluginName) const;
+    Sailfish::Secrets::Daemon::ApiImpl::MasterLockKdfParameters calibrateKdfParameters(Sailfish::Crypto::CryptoPlugin *cplugin, const QByteArray &salt) const;
+    Sailfish::Secrets::Daemon::ApiImpl::MasterLockKdfParameters kdfParameters() const;
     bool initializeKeyData(const QByteArray &bkdkKey, const QByteArray &deviceLockKey);
     void dealWithDataCorruption() const;
 
@@ -479,6 +584,8 @@ public: // For use by the secrets request processor to handle device-locked coll
     bool writeTestCipherText(const QByteArray &testCipherText, const QString &cipherPluginName) const; // the testCipherText file should be considered mutable.
     bool determineTestCipherPlugin(QString *cipherPluginName) const;
     QByteArray saltData() const;
+    bool collectionKdfParameters(const QString &encryptionPluginName, QVariantMap *kdfParameters) const;
+    void setCollectionKdfParameters(const QString &encryptionPluginName, const QVariantMap &kdfParameters);
     bool noLockCode() const;
     void setNoLockCode(bool value);
     const QByteArray bkdbLockKey() const;
@@ -520,6 +627,14 @@ Q_SIGNALS:
     void userInputCompleted(quint64 cryptoRequestId, const Sailfish::Secrets::Result &result, const QByteArray &userInput);
     void cryptoPluginLockStatusRequestCompleted(quint64 cryptoRequestId, const Sailfish::Secrets::Result &result, Sailfish::Secrets::LockCodeRequest::LockStatus lockStatus);
     void cryptoPluginLockCodeRequestCompleted(quint64 cryptoRequestId, const Sailfish::Secrets::Result &result);
+    // emitted when a collection has been deleted, so that state derived from it can be released.
+    void collectionRemoved(const QString &collectionName, const QString &storagePluginName);
+    // emitted when a collection has been locked again, so that state derived from its key can be released.
+    // An empty collection name means every collection of the storage plugin, and an empty
+    // storage plugin name as well means every collection (e.g. when the master lock is locked).
+    void collectionLocked(const QString &collectionName, const QString &storagePluginName);
+private Q_SLOTS:
+    void finishDeferredCryptoApiHelperRequest(quint64 cryptoRequestId);
 private:
     enum CryptoApiHelperRequestType {
         InvalidCryptoApiHelperRequest = 0,
@@ -536,7 +651,28 @@ private:
         ProvideLockCodeCryptoApiHelperRequest,
         ForgetLockCodeCryptoApiHelperRequest
     };
-    QMap<quint64, CryptoApiHelperRequestType> m_cryptoApiHelperRequests; // crypto request id to crypto api call type.
+    struct CryptoApiHelperRequest {
+        CryptoApiHelperRequest(CryptoApiHelperRequestType t = InvalidCryptoApiHelperRequest)
+            : type(t), startTime(Sailfish::Secrets::Daemon::ApiImpl::monotonicNsecs()) {}
+        CryptoApiHelperRequestType type;
+        qint64 startTime; // used for request tracing
+    };
+    QMap<quint64, CryptoApiHelperRequest> m_cryptoApiHelperRequests; // crypto request id to crypto api call type.
+
+    // captures the result of a crypto api helper request which completes
+    // synchronously when handled directly rather than via the queue.
+    struct DirectCryptoApiHelperCompletion {
+        DirectCryptoApiHelperCompletion(quint64 id = 0)
+            : cryptoRequestId(id), completed(false) {}
+        quint64 cryptoRequestId;
+        bool completed;
+        Sailfish::Secrets::Result result;
+        QVariantList parameters;
+    };
+    DirectCryptoApiHelperCompletion *m_directCompletion;
+    QMap<quint64, QPair<Sailfish::Secrets::Result, QVariantList> > m_deferredCryptoApiHelperResults;
+    Sailfish::Secrets::Result directCryptoApiHelperRequest(pid_t callerPid, quint64 cryptoRequestId, int requestType, CryptoApiHelperRequestType helperRequestType,
+                                                           const QVariantList &inParams, QVariantList *parameters);
 };
 
 enum RequestType {
@@ -561,6 +697,8 @@ enum RequestType {
     ModifyLockCodeRequest,
     ProvideLockCodeRequest,
     ForgetLockCodeRequest,
+    FindSecretsInCollectionsRequest,
+    GetCollectionSecretFilterDataRequest,
     // Internal user input request types:
     SetCollectionUserInputSecretRequest,
     SetStandaloneDeviceLockUserInputSecretRequest,
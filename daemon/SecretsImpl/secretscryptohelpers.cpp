@@ -251,6 +251,44 @@ Daemon::ApiImpl::SecretsRequestQueue::storedKeyIdentifiers(
     return Result(Result::Pending);
 }
 
+Result
+Daemon::ApiImpl::SecretsRequestQueue::directCryptoApiHelperRequest(
+        pid_t callerPid,
+        quint64 cryptoRequestId,
+        int requestType,
+        Daemon::ApiImpl::SecretsRequestQueue::CryptoApiHelperRequestType helperRequestType,
+        const QVariantList &inParams,
+        QVariantList *parameters)
+{
+    // Handle the request immediately instead of enqueuing it.
+    // If it completes synchronously, the result is returned to the caller
+    // rather than being emitted via the completion signal.
+    m_cryptoApiHelperRequests.insert(cryptoRequestId, helperRequestType);
+    Daemon::ApiImpl::SecretsRequestQueue::DirectCryptoApiHelperCompletion completion(cryptoRequestId);
+    Daemon::ApiImpl::SecretsRequestQueue::DirectCryptoApiHelperCompletion *outerCompletion = m_directCompletion;
+    m_directCompletion = &completion;
+    Result directResult(Result::Succeeded);
+    bool completed = false;
+    handleDirectRequest(
+                callerPid,
+                cryptoRequestId,
+                requestType,
+                inParams,
+                directResult,
+                &completed);
+    m_directCompletion = outerCompletion;
+
+    if (directResult.code() == Result::Failed) {
+        m_cryptoApiHelperRequests.remove(cryptoRequestId);
+        return directResult;
+    } else if (!completion.completed) {
+        return Result(Result::Pending);
+    }
+
+    *parameters = completion.parameters;
+    return completion.result;
+}
+
 Result
 Daemon::ApiImpl::SecretsRequestQueue::useKeyPreCheck(
         pid_t callerPid,
@@ -267,17 +305,26 @@ Daemon::ApiImpl::SecretsRequestQueue::useKeyPreCheck(
              << QVariant::fromValue<Sailfish::Crypto::CryptoManager::Operation>(operation)
              << QVariant::fromValue<QString>(cryptoPluginName)
              << QVariant::fromValue<SecretManager::UserInteractionMode>(SecretManager::SystemInteraction);
-    Result enqueueResult(Result::Succeeded);
-    handleRequest(
+    QVariantList parameters;
+    Result result = directCryptoApiHelperRequest(
                 callerPid,
                 cryptoRequestId,
                 Daemon::ApiImpl::UseCollectionKeyPreCheckRequest,
+                Daemon::ApiImpl::SecretsRequestQueue::UseKeyPreCheckCryptoApiHelperRequest,
                 inParams,
-                enqueueResult);
-    if (enqueueResult.code() == Result::Failed) {
-        return enqueueResult;
+                &parameters);
+    if (result.code() == Result::Failed || result.code() == Result::Pending) {
+        return result;
     }
+
+    // The caller only records its pending request once this returns,
+    // so the collection key is delivered via useKeyPreCheckCompleted()
+    // from the event loop, as if the request had been asynchronous.
     m_cryptoApiHelperRequests.insert(cryptoRequestId, Daemon::ApiImpl::SecretsRequestQueue::UseKeyPreCheckCryptoApiHelperRequest);
+    m_deferredCryptoApiHelperResults.insert(cryptoRequestId, qMakePair(result, parameters));
+    QMetaObject::invokeMethod(this, "finishDeferredCryptoApiHelperRequest",
+                              Qt::QueuedConnection,
+                              Q_ARG(quint64, cryptoRequestId));
     return Result(Result::Pending);
 }
 
@@ -289,9 +336,6 @@ Daemon::ApiImpl::SecretsRequestQueue::storedKey(
         QByteArray *serializedKey,
         QMap<QString, QString> *filterData)
 {
-    Q_UNUSED(serializedKey); // this request is always asynchronous
-    Q_UNUSED(filterData);
-
     // perform the "get collection secret" request, as a secrets-for-crypto request.
     QList<QVariant> inParams;
     inParams << QVariant::fromValue<Secret::Identifier>(Secret::Identifier(identifier.name(),
@@ -299,18 +343,21 @@ Daemon::ApiImpl::SecretsRequestQueue::storedKey(
                                                                            identifier.storagePluginName()))
              << QVariant::fromValue<SecretManager::UserInteractionMode>(SecretManager::SystemInteraction)
              << QVariant::fromValue<QString>(QString());
-    Result enqueueResult(Result::Succeeded);
-    handleRequest(
+    QVariantList parameters;
+    Result result = directCryptoApiHelperRequest(
                 callerPid,
                 cryptoRequestId,
                 Daemon::ApiImpl::GetCollectionSecretRequest,
+                Daemon::ApiImpl::SecretsRequestQueue::StoredKeyCryptoApiHelperRequest,
                 inParams,
-                enqueueResult);
-    if (enqueueResult.code() == Result::Failed) {
-        return enqueueResult;
+                &parameters);
+    if (result.code() == Result::Succeeded && parameters.size()) {
+        // completed synchronously, e.g. the collection was already unlocked.
+        const Secret secret = parameters.first().value<Secret>();
+        *serializedKey = secret.data();
+        *filterData = secret.filterData();
     }
-    m_cryptoApiHelperRequests.insert(cryptoRequestId, Daemon::ApiImpl::SecretsRequestQueue::StoredKeyCryptoApiHelperRequest);
-    return Result(Result::Pending);
+    return result;
 }
 
 Result
@@ -458,7 +505,20 @@ Daemon::ApiImpl::SecretsRequestQueue::asynchronousCryptoRequestCompleted(
         return;
     }
 
-    Daemon::ApiImpl::SecretsRequestQueue::CryptoApiHelperRequestType type = m_cryptoApiHelperRequests.take(cryptoRequestId);
+    const Daemon::ApiImpl::SecretsRequestQueue::CryptoApiHelperRequest helperRequest = m_cryptoApiHelperRequests.take(cryptoRequestId);
+    Daemon::ApiImpl::RequestTracer::instance()->addSpan(
+            cryptoRequestId, "secrets", QStringLiteral("cryptoApiHelper"),
+            helperRequest.startTime, Daemon::ApiImpl::monotonicNsecs());
+    if (m_directCompletion && m_directCompletion->cryptoRequestId == cryptoRequestId) {
+        // completed synchronously while being handled directly,
+        // directCryptoApiHelperRequest() returns the result to the caller.
+        m_directCompletion->completed = true;
+        m_directCompletion->result = result;
+        m_directCompletion->parameters = parameters;
+        return;
+    }
+
+    Daemon::ApiImpl::SecretsRequestQueue::CryptoApiHelperRequestType type = helperRequest.type;
     switch (type) {
         case StoredKeyCryptoApiHelperRequest: {
             Secret secret = parameters.size() ? parameters.first().value<Secret>() : Secret();
@@ -513,3 +573,16 @@ Daemon::ApiImpl::SecretsRequestQueue::asynchronousCryptoRequestCompleted(
         }
     }
 }
+
+void
+Daemon::ApiImpl::SecretsRequestQueue::finishDeferredCryptoApiHelperRequest(
+        quint64 cryptoRequestId)
+{
+    if (!m_deferredCryptoApiHelperResults.contains(cryptoRequestId)) {
+        qCWarning(lcSailfishSecretsCryptoHelpers) << "Unknown deferred secrets request result for crypto request:" << cryptoRequestId;
+        return;
+    }
+
+    const QPair<Result, QVariantList> deferred = m_deferredCryptoApiHelperResults.take(cryptoRequestId);
+    asynchronousCryptoRequestCompleted(cryptoRequestId, deferred.first, deferred.second);
+}
@@ -27,6 +27,7 @@
 #include <QtCore/QList>
 #include <QtCore/QHash>
 #include <QtCore/QSet>
+#include <QtCore/QSharedPointer>
 #include <QtCore/QDir>
 #include <QtCore/QCoreApplication>
 #include <QtConcurrent>
@@ -35,15 +36,64 @@ using namespace Sailfish::Secrets;
 
 namespace {
 
-    QString calculateSecretNameHash(const Secret::Identifier &ident)
+    // The time which deriving a custom lock collection key should take.
+    // The autotests derive many keys, so they use the minimum cost.
+    int collectionKdfTargetMsecs(bool autotestMode)
     {
-        return QString::fromLatin1(
-                QCryptographicHash::hash(
-                    QStringLiteral("%1%2%3")
-                        .arg(ident.storagePluginName(),
-                             ident.collectionName(),
-                             ident.name()).toUtf8(),
-                    QCryptographicHash::Sha512).toBase64());
+        bool ok = false;
+        const int targetMsecs = qgetenv(ENV_COLLECTION_KDF_TARGET_MSECS).toInt(&ok);
+        if (ok && targetMsecs > 0) {
+            return qMin(targetMsecs, 60000);
+        }
+        return autotestMode ? 1 : 500;
+    }
+
+    // Runs the given function once for each storage plugin, in the worker
+    // thread of that plugin, passing it plugin lists which contain only that
+    // plugin.  The plugins are processed concurrently, and the results are
+    // returned once every plugin has been processed.
+    template <typename Function, typename... Args>
+    auto runForEachStoragePlugin(
+            quint64 requestId,
+            Sailfish::Secrets::Daemon::ApiImpl::SecretsRequestQueue *requestQueue,
+            const QMap<QString, Sailfish::Secrets::Daemon::ApiImpl::StoragePluginWrapper*> &storagePlugins,
+            const QMap<QString, Sailfish::Secrets::Daemon::ApiImpl::EncryptedStoragePluginWrapper*> &encryptedStoragePlugins,
+            Function function,
+            Args... args)
+        -> QVector<decltype(function(QList<Sailfish::Secrets::Daemon::ApiImpl::StoragePluginWrapper*>(),
+                                     QList<Sailfish::Secrets::Daemon::ApiImpl::EncryptedStoragePluginWrapper*>(),
+                                     args...))>
+    {
+        typedef QList<Sailfish::Secrets::Daemon::ApiImpl::StoragePluginWrapper*> StoragePluginList;
+        typedef QList<Sailfish::Secrets::Daemon::ApiImpl::EncryptedStoragePluginWrapper*> EncryptedStoragePluginList;
+        typedef decltype(function(StoragePluginList(), EncryptedStoragePluginList(), args...)) ResultType;
+
+        QVector<QFuture<ResultType> > futures;
+        for (auto it = storagePlugins.constBegin(); it != storagePlugins.constEnd(); ++it) {
+            futures.append(Sailfish::Secrets::Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    requestQueue->storagePluginThreadPool(it.key()).data(),
+                    function,
+                    StoragePluginList() << it.value(),
+                    EncryptedStoragePluginList(),
+                    args...));
+        }
+        for (auto it = encryptedStoragePlugins.constBegin(); it != encryptedStoragePlugins.constEnd(); ++it) {
+            futures.append(Sailfish::Secrets::Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    requestQueue->storagePluginThreadPool(it.key()).data(),
+                    function,
+                    StoragePluginList(),
+                    EncryptedStoragePluginList() << it.value(),
+                    args...));
+        }
+
+        QVector<ResultType> results;
+        for (QFuture<ResultType> &future : futures) {
+            future.waitForFinished();
+            results.append(future.result());
+        }
+        return results;
     }
 
     QString determineAuthPlugin(Sailfish::Secrets::Daemon::Controller *controller,
@@ -172,21 +222,66 @@ Daemon::ApiImpl::RequestProcessor::RequestProcessor(
 
 bool Daemon::ApiImpl::RequestProcessor::initializePlugins()
 {
-    QFuture<bool> future = QtConcurrent::run(
-                m_requestQueue->secretsThreadPool().data(),
+    const bool unlocked = !runForEachStoragePlugin(
+                0,
+                m_requestQueue,
+                m_storagePlugins,
+                m_encryptedStoragePlugins,
                 &Daemon::ApiImpl::masterUnlockPlugins,
-                m_storagePlugins.values(),
-                m_encryptedStoragePlugins.values(),
-                m_requestQueue->bkdbLockKey());
-    future.waitForFinished();
-    if (!future.result()) {
+                m_requestQueue->bkdbLockKey()).contains(false);
+    if (!unlocked) {
         // TODO: FIXME: how can we recover from this?
         // This is symptomatic of a power-loss halfway through previous re-encryption,
         // meaning that some metadata databases will have been encrypted with
         // the OLD lock code, and some with the NEW lock code...
         qCWarning(lcSailfishSecretsDaemon) << "Critical Error! Failed to initialize metadata plugins";
     }
-    return future.result();
+    return unlocked;
+}
+
+// The database connections may only be used from the thread which
+// opened them, so the memory is released in each plugin's worker thread.
+int Daemon::ApiImpl::RequestProcessor::releaseDatabaseMemory()
+{
+    int released = 0;
+    for (int count : runForEachStoragePlugin(
+                0,
+                m_requestQueue,
+                m_storagePlugins,
+                m_encryptedStoragePlugins,
+                &Daemon::ApiImpl::releaseDatabaseMemory)) {
+        released += count;
+    }
+    return released;
+}
+
+// Returns true if any in-memory storage plugin holds a collection.
+bool Daemon::ApiImpl::RequestProcessor::holdsInMemoryCollections()
+{
+    return runForEachStoragePlugin(
+                0,
+                m_requestQueue,
+                m_storagePlugins,
+                m_encryptedStoragePlugins,
+                &Daemon::ApiImpl::holdsInMemoryCollections).contains(true);
+}
+
+// Returns true if any collection or standalone secret keys are cached
+// which were derived from a user-supplied authentication code, rather
+// than being the device lock key (which is re-derived at startup).
+bool Daemon::ApiImpl::RequestProcessor::hasCachedUserKeys(const QByteArray &deviceLockKey) const
+{
+    for (const QByteArray &key : m_collectionEncryptionKeys) {
+        if (key != deviceLockKey) {
+            return true;
+        }
+    }
+    for (const QByteArray &key : m_standaloneSecretEncryptionKeys) {
+        if (key != deviceLockKey) {
+            return true;
+        }
+    }
+    return false;
 }
 
 // retrieve information about available plugins
@@ -300,13 +395,15 @@ Daemon::ApiImpl::RequestProcessor::collectionNames(
     QFutureWatcher<CollectionNamesResult> *watcher = new QFutureWatcher<CollectionNamesResult>(this);
     QFuture<CollectionNamesResult> future;
     if (m_encryptedStoragePlugins.contains(storagePluginName)) {
-        future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(storagePluginName).data(),
                     EncryptedStoragePluginFunctionWrapper::collectionNames,
                     m_encryptedStoragePlugins[storagePluginName]);
     } else {
-        future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(storagePluginName).data(),
                     StoragePluginFunctionWrapper::collectionNames,
                     m_storagePlugins[storagePluginName]);
     }
@@ -371,15 +468,17 @@ Daemon::ApiImpl::RequestProcessor::createDeviceLockCollection(
     QFutureWatcher<Result> *watcher = new QFutureWatcher<Result>(this);
     QFuture<Result> future;
     if (storagePluginName == encryptionPluginName) {
-        future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(storagePluginName).data(),
                     EncryptedStoragePluginFunctionWrapper::createCollection,
                     m_encryptedStoragePlugins[storagePluginName],
                     metadata,
                     m_requestQueue->deviceLockKey());
     } else {
-        future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(storagePluginName).data(),
                     StoragePluginFunctionWrapper::createCollection,
                     m_storagePlugins[storagePluginName],
                     metadata);
@@ -511,23 +610,49 @@ Daemon::ApiImpl::RequestProcessor::createCustomLockCollectionWithAuthenticationC
         const QString &interactionServiceAddress,
         const QByteArray &authenticationCode)
 {
+    // the key derivation cost of a new collection is calibrated for the
+    // device once per encryption plugin, and stored in the collection metadata.
     QFutureWatcher<DerivedKeyResult> *watcher
             = new QFutureWatcher<DerivedKeyResult>(this);
     QFuture<DerivedKeyResult> future;
+    QVariantMap kdfParameters;
+    const bool calibrated = m_requestQueue->collectionKdfParameters(encryptionPluginName, &kdfParameters);
     if (storagePluginName == encryptionPluginName) {
-        future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
-                    EncryptedStoragePluginFunctionWrapper::deriveKeyFromCode,
-                    m_encryptedStoragePlugins[encryptionPluginName],
-                    authenticationCode,
-                    m_requestQueue->saltData());
+        future = calibrated
+                ? Daemon::ApiImpl::tracedRun(
+                        requestId,
+                        m_requestQueue->storagePluginThreadPool(encryptionPluginName).data(),
+                        EncryptedStoragePluginFunctionWrapper::deriveKeyFromCode,
+                        m_encryptedStoragePlugins[encryptionPluginName],
+                        authenticationCode,
+                        m_requestQueue->saltData(),
+                        kdfParameters)
+                : Daemon::ApiImpl::tracedRun(
+                        requestId,
+                        m_requestQueue->storagePluginThreadPool(encryptionPluginName).data(),
+                        EncryptedStoragePluginFunctionWrapper::calibrateAndDeriveKeyFromCode,
+                        m_encryptedStoragePlugins[encryptionPluginName],
+                        authenticationCode,
+                        m_requestQueue->saltData(),
+                        collectionKdfTargetMsecs(m_autotestMode));
     } else {
-        future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
-                    EncryptionPluginFunctionWrapper::deriveKeyFromCode,
-                    m_encryptionPlugins[encryptionPluginName],
-                    authenticationCode,
-                    m_requestQueue->saltData());
+        future = calibrated
+                ? Daemon::ApiImpl::tracedRun(
+                        requestId,
+                        m_requestQueue->secretsThreadPool().data(),
+                        EncryptionPluginFunctionWrapper::deriveKeyFromCode,
+                        m_encryptionPlugins[encryptionPluginName],
+                        authenticationCode,
+                        m_requestQueue->saltData(),
+                        kdfParameters)
+                : Daemon::ApiImpl::tracedRun(
+                        requestId,
+                        m_requestQueue->secretsThreadPool().data(),
+                        EncryptionPluginFunctionWrapper::calibrateAndDeriveKeyFromCode,
+                        m_encryptionPlugins[encryptionPluginName],
+                        authenticationCode,
+                        m_requestQueue->saltData(),
+                        collectionKdfTargetMsecs(m_autotestMode));
     }
 
     connect(watcher, &QFutureWatcher<DerivedKeyResult>::finished, [=] {
@@ -538,6 +663,9 @@ Daemon::ApiImpl::RequestProcessor::createCustomLockCollectionWithAuthenticationC
             outParams << QVariant::fromValue<Result>(dkr.result);
             m_requestQueue->requestFinished(requestId, outParams);
         } else {
+            if (!calibrated) {
+                m_requestQueue->setCollectionKdfParameters(encryptionPluginName, dkr.kdfParameters);
+            }
             createCustomLockCollectionWithEncryptionKey(
                         callerPid,
                         requestId,
@@ -549,6 +677,7 @@ Daemon::ApiImpl::RequestProcessor::createCustomLockCollectionWithAuthenticationC
                         accessControlMode,
                         userInteractionMode,
                         interactionServiceAddress,
+                        dkr.kdfParameters,
                         dkr.key);
         }
     });
@@ -569,6 +698,7 @@ Daemon::ApiImpl::RequestProcessor::createCustomLockCollectionWithEncryptionKey(
         SecretManager::AccessControlMode accessControlMode,
         SecretManager::UserInteractionMode userInteractionMode,
         const QString &interactionServiceAddress,
+        const QVariantMap &kdfParameters,
         const QByteArray &encryptionKey)
 {
     Q_UNUSED(userInteractionMode);
@@ -588,19 +718,22 @@ Daemon::ApiImpl::RequestProcessor::createCustomLockCollectionWithEncryptionKey(
     metadata.authenticationPluginName = authenticationPluginName;
     metadata.unlockSemantic = static_cast<int>(unlockSemantic);
     metadata.accessControlMode = accessControlMode;
+    metadata.kdfParameters = kdfParameters;
 
     QFutureWatcher<Result> *watcher = new QFutureWatcher<Result>(this);
     QFuture<Result> future;
     if (storagePluginName == encryptionPluginName) {
-        future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(storagePluginName).data(),
                     EncryptedStoragePluginFunctionWrapper::createCollection,
                     m_encryptedStoragePlugins[storagePluginName],
                     metadata,
                     encryptionKey);
     } else {
-        future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(storagePluginName).data(),
                     StoragePluginFunctionWrapper::createCollection,
                     m_storagePlugins[storagePluginName],
                     metadata);
@@ -661,14 +794,16 @@ Daemon::ApiImpl::RequestProcessor::deleteCollection(
             = new QFutureWatcher<CollectionMetadataResult>(this);
     QFuture<CollectionMetadataResult> future;
     if (m_encryptedStoragePlugins.contains(storagePluginName)) {
-        future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(storagePluginName).data(),
                     EncryptedStoragePluginFunctionWrapper::collectionMetadata,
                     m_encryptedStoragePlugins[storagePluginName],
                     collectionName);
     } else {
-        future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(storagePluginName).data(),
                     StoragePluginFunctionWrapper::collectionMetadata,
                     m_storagePlugins[storagePluginName],
                     collectionName);
@@ -734,8 +869,9 @@ Daemon::ApiImpl::RequestProcessor::deleteCollectionWithMetadata(
     if (m_encryptedStoragePlugins.contains(storagePluginName)) {
         // TODO: make this asynchronous instead of blocking the main thread!
         QFuture<LockedResult> future
-                = QtConcurrent::run(
-                        m_requestQueue->secretsThreadPool().data(),
+                = Daemon::ApiImpl::tracedRun(
+                        requestId,
+                        m_requestQueue->storagePluginThreadPool(storagePluginName).data(),
                         EncryptedStoragePluginFunctionWrapper::isCollectionLocked,
                         m_encryptedStoragePlugins[storagePluginName],
                         collectionName);
@@ -874,16 +1010,19 @@ Daemon::ApiImpl::RequestProcessor::deleteCollectionWithLockCode(
     QFutureWatcher<Result> *watcher = new QFutureWatcher<Result>(this);
     QFuture<Result> future;
     if (m_encryptedStoragePlugins.contains(storagePluginName)) {
-        future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(storagePluginName).data(),
                     EncryptedStoragePluginFunctionWrapper::deriveKeyUnlockAndRemoveCollection,
                     m_encryptedStoragePlugins[storagePluginName],
                     collectionName,
                     lockCode,
-                    m_requestQueue->saltData());
+                    m_requestQueue->saltData(),
+                    collectionMetadata.kdfParameters);
     } else {
-        future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(storagePluginName).data(),
                     StoragePluginFunctionWrapper::removeCollection,
                     m_storagePlugins[storagePluginName],
                     collectionName);
@@ -896,6 +1035,7 @@ Daemon::ApiImpl::RequestProcessor::deleteCollectionWithLockCode(
             const QString hashedCollectionName = calculateSecretNameHash(
                         Secret::Identifier(QString(), collectionName, storagePluginName));
             m_collectionEncryptionKeys.remove(hashedCollectionName);
+            emit m_requestQueue->collectionRemoved(collectionName, storagePluginName);
             if (collectionMetadata.accessControlMode == SecretManager::SystemAccessControlMode) {
                 // TODO: tell AccessControl daemon to remove this datum from its database.
             }
@@ -926,15 +1066,17 @@ Daemon::ApiImpl::RequestProcessor::deleteCollectionWithEncryptionKey(
     QFutureWatcher<Result> *watcher = new QFutureWatcher<Result>(this);
     QFuture<Result> future;
     if (m_encryptedStoragePlugins.contains(storagePluginName)) {
-        future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(storagePluginName).data(),
                     EncryptedStoragePluginFunctionWrapper::unlockAndRemoveCollection,
                     m_encryptedStoragePlugins[storagePluginName],
                     collectionName,
                     encryptionKey);
     } else {
-        future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(storagePluginName).data(),
                     StoragePluginFunctionWrapper::removeCollection,
                     m_storagePlugins[storagePluginName],
                     collectionName);
@@ -947,6 +1089,7 @@ Daemon::ApiImpl::RequestProcessor::deleteCollectionWithEncryptionKey(
             const QString hashedCollectionName = calculateSecretNameHash(
                         Secret::Identifier(QString(), collectionName, storagePluginName));
             m_collectionEncryptionKeys.remove(hashedCollectionName);
+            emit m_requestQueue->collectionRemoved(collectionName, storagePluginName);
             if (collectionMetadata.accessControlMode == SecretManager::SystemAccessControlMode) {
                 // TODO: tell AccessControl daemon to remove this datum from its database.
             }
@@ -989,8 +1132,9 @@ Daemon::ApiImpl::RequestProcessor::storedKeyIdentifiers(
         // return key identifiers from all collections in the plugin.
         // note that collections which are locked will NOT be represented.
         // TODO: make this one asynchronous.
-        QFuture<IdentifiersResult> future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        QFuture<IdentifiersResult> future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(storagePluginName).data(),
                     &Daemon::ApiImpl::storedKeyIdentifiers,
                     m_storagePlugins.value(storagePluginName),
                     m_encryptedStoragePlugins.value(storagePluginName),
@@ -1006,14 +1150,16 @@ Daemon::ApiImpl::RequestProcessor::storedKeyIdentifiers(
             = new QFutureWatcher<CollectionMetadataResult>(this);
     QFuture<CollectionMetadataResult> future;
     if (m_encryptedStoragePlugins.contains(storagePluginName)) {
-        future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(storagePluginName).data(),
                     EncryptedStoragePluginFunctionWrapper::collectionMetadata,
                     m_encryptedStoragePlugins[storagePluginName],
                     collectionName);
     } else {
-        future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(storagePluginName).data(),
                     StoragePluginFunctionWrapper::collectionMetadata,
                     m_storagePlugins[storagePluginName],
                     collectionName);
@@ -1081,8 +1227,9 @@ Daemon::ApiImpl::RequestProcessor::storedKeyIdentifiersWithMetadata(
     if (m_encryptedStoragePlugins.contains(storagePluginName)) {
         // TODO: make this asynchronous instead of blocking the main thread!
         QFuture<LockedResult> future
-                = QtConcurrent::run(
-                        m_requestQueue->secretsThreadPool().data(),
+                = Daemon::ApiImpl::tracedRun(
+                        requestId,
+                        m_requestQueue->storagePluginThreadPool(storagePluginName).data(),
                         EncryptedStoragePluginFunctionWrapper::isCollectionLocked,
                         m_encryptedStoragePlugins[storagePluginName],
                         collectionName);
@@ -1224,19 +1371,23 @@ Daemon::ApiImpl::RequestProcessor::storedKeyIdentifiersWithAuthenticationCode(
     QFuture<DerivedKeyResult> future;
     if (storagePluginName == collectionMetadata.encryptionPluginName
             || collectionMetadata.encryptionPluginName.isEmpty()) {
-        future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(storagePluginName).data(),
                     EncryptedStoragePluginFunctionWrapper::deriveKeyFromCode,
                     m_encryptedStoragePlugins[storagePluginName],
                     authenticationCode,
-                    m_requestQueue->saltData());
+                    m_requestQueue->saltData(),
+                    collectionMetadata.kdfParameters);
     } else {
-        future = QtConcurrent::run(
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
                     m_requestQueue->secretsThreadPool().data(),
                     EncryptionPluginFunctionWrapper::deriveKeyFromCode,
                     m_encryptionPlugins[collectionMetadata.encryptionPluginName],
                     authenticationCode,
-                    m_requestQueue->saltData());
+                    m_requestQueue->saltData(),
+                    collectionMetadata.kdfParameters);
     }
 
     connect(watcher, &QFutureWatcher<DerivedKeyResult>::finished, [=] {
@@ -1283,8 +1434,9 @@ Daemon::ApiImpl::RequestProcessor::storedKeyIdentifiersWithEncryptionKey(
             || (collectionMetadata.usesDeviceLockKey
               && collectionMetadata.unlockSemantic != SecretManager::DeviceLockKeepUnlocked));
     QFutureWatcher<IdentifiersResult> *watcher = new QFutureWatcher<IdentifiersResult>(this);
-    QFuture<IdentifiersResult> future = QtConcurrent::run(
-                m_requestQueue->secretsThreadPool().data(),
+    QFuture<IdentifiersResult> future = Daemon::ApiImpl::tracedRun(
+                requestId,
+                m_requestQueue->storagePluginThreadPool(storagePluginName).data(),
                 &Daemon::ApiImpl::storedKeyIdentifiersFromCollection,
                 m_storagePlugins.value(storagePluginName),
                 m_encryptedStoragePlugins.value(storagePluginName),
@@ -1404,14 +1556,16 @@ Daemon::ApiImpl::RequestProcessor::setCollectionSecret(
             = new QFutureWatcher<CollectionMetadataResult>(this);
     QFuture<CollectionMetadataResult> future;
     if (m_encryptedStoragePlugins.contains(secret.identifier().storagePluginName())) {
-        future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(secret.identifier().storagePluginName()).data(),
                     EncryptedStoragePluginFunctionWrapper::collectionMetadata,
                     m_encryptedStoragePlugins[secret.identifier().storagePluginName()],
                     secret.identifier().collectionName());
     } else {
-        future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(secret.identifier().storagePluginName()).data(),
                     StoragePluginFunctionWrapper::collectionMetadata,
                     m_storagePlugins[secret.identifier().storagePluginName()],
                     secret.identifier().collectionName());
@@ -1574,8 +1728,9 @@ Daemon::ApiImpl::RequestProcessor::setCollectionSecretGetAuthenticationCode(
     if (m_encryptedStoragePlugins.contains(secret.identifier().storagePluginName())) {
         // TODO: make this asynchronous instead of blocking the main thread!
         QFuture<LockedResult> future
-                = QtConcurrent::run(
-                        m_requestQueue->secretsThreadPool().data(),
+                = Daemon::ApiImpl::tracedRun(
+                        requestId,
+                        m_requestQueue->storagePluginThreadPool(secret.identifier().storagePluginName()).data(),
                         EncryptedStoragePluginFunctionWrapper::isCollectionLocked,
                         m_encryptedStoragePlugins[secret.identifier().storagePluginName()],
                         secret.identifier().collectionName());
@@ -1791,19 +1946,23 @@ Daemon::ApiImpl::RequestProcessor::setCollectionSecretWithAuthenticationCode(
     QFuture<DerivedKeyResult> future;
     if (secret.identifier().storagePluginName() == collectionMetadata.encryptionPluginName
             || collectionMetadata.encryptionPluginName.isEmpty()) {
-        future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(secret.identifier().storagePluginName()).data(),
                     EncryptedStoragePluginFunctionWrapper::deriveKeyFromCode,
                     m_encryptedStoragePlugins[secret.identifier().storagePluginName()],
                     authenticationCode,
-                    m_requestQueue->saltData());
+                    m_requestQueue->saltData(),
+                    collectionMetadata.kdfParameters);
     } else {
-        future = QtConcurrent::run(
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
                     m_requestQueue->secretsThreadPool().data(),
                     EncryptionPluginFunctionWrapper::deriveKeyFromCode,
                     m_encryptionPlugins[collectionMetadata.encryptionPluginName],
                     authenticationCode,
-                    m_requestQueue->saltData());
+                    m_requestQueue->saltData(),
+                    collectionMetadata.kdfParameters);
     }
 
     connect(watcher, &QFutureWatcher<DerivedKeyResult>::finished, [=] {
@@ -1856,8 +2015,9 @@ Daemon::ApiImpl::RequestProcessor::setCollectionSecretWithEncryptionKey(
     QFuture<Result> future;
     if (secret.identifier().storagePluginName() == collectionMetadata.encryptionPluginName
             || collectionMetadata.encryptionPluginName.isEmpty()) {
-        future = QtConcurrent::run(
-                m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                requestId,
+                m_requestQueue->storagePluginThreadPool(secret.identifier().storagePluginName()).data(),
                 EncryptedStoragePluginFunctionWrapper::unlockCollectionAndStoreSecret,
                 m_encryptedStoragePlugins[secret.identifier().storagePluginName()],
                 secretMetadata,
@@ -1876,8 +2036,9 @@ Daemon::ApiImpl::RequestProcessor::setCollectionSecretWithEncryptionKey(
             m_collectionEncryptionKeys.insert(hashedCollectionName, encryptionKey);
         }
 
-        future = QtConcurrent::run(
-                m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                requestId,
+                m_requestQueue->storagePluginThreadPool(secret.identifier().storagePluginName()).data(),
                 StoragePluginFunctionWrapper::encryptAndStoreSecret,
                 m_encryptionPlugins[secretMetadata.encryptionPluginName],
                 m_storagePlugins[secret.identifier().storagePluginName()],
@@ -1970,15 +2131,17 @@ Daemon::ApiImpl::RequestProcessor::setStandaloneDeviceLockSecret(
             = new QFutureWatcher<SecretMetadataResult>(this);
     QFuture<SecretMetadataResult> future;
     if (m_encryptedStoragePlugins.contains(secret.identifier().storagePluginName())) {
-        future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(secret.identifier().storagePluginName()).data(),
                     EncryptedStoragePluginFunctionWrapper::secretMetadata,
                     m_encryptedStoragePlugins[secret.identifier().storagePluginName()],
                     QStringLiteral("standalone"),
                     secret.identifier().name());
     } else {
-        future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(secret.identifier().storagePluginName()).data(),
                     StoragePluginFunctionWrapper::secretMetadata,
                     m_storagePlugins[secret.identifier().storagePluginName()],
                     QStringLiteral("standalone"),
@@ -2103,8 +2266,9 @@ Daemon::ApiImpl::RequestProcessor::writeStandaloneDeviceLockSecret(
     Secret identifiedSecret(secret);
     identifiedSecret.setCollectionName(QStringLiteral("standalone"));
     QFutureWatcher<Result> *watcher = new QFutureWatcher<Result>(this);
-    QFuture<Result> future = QtConcurrent::run(
-            m_requestQueue->secretsThreadPool().data(),
+    QFuture<Result> future = Daemon::ApiImpl::tracedRun(
+            requestId,
+            m_requestQueue->storagePluginThreadPool(secret.identifier().storagePluginName()).data(),
             StoragePluginFunctionWrapper::encryptAndStoreSecret,
             m_encryptionPlugins[secretMetadata.encryptionPluginName],
             m_storagePlugins[secret.identifier().storagePluginName()],
@@ -2198,15 +2362,17 @@ Daemon::ApiImpl::RequestProcessor::setStandaloneCustomLockSecret(
             = new QFutureWatcher<SecretMetadataResult>(this);
     QFuture<SecretMetadataResult> future;
     if (m_encryptedStoragePlugins.contains(secret.identifier().storagePluginName())) {
-        future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(secret.identifier().storagePluginName()).data(),
                     EncryptedStoragePluginFunctionWrapper::secretMetadata,
                     m_encryptedStoragePlugins[secret.identifier().storagePluginName()],
                     QStringLiteral("standalone"),
                     secret.identifier().name());
     } else {
-        future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(secret.identifier().storagePluginName()).data(),
                     StoragePluginFunctionWrapper::secretMetadata,
                     m_storagePlugins[secret.identifier().storagePluginName()],
                     QStringLiteral("standalone"),
@@ -2389,19 +2555,23 @@ Daemon::ApiImpl::RequestProcessor::setStandaloneCustomLockSecretWithAuthenticati
     QFuture<DerivedKeyResult> future;
     if (secret.identifier().storagePluginName() == secretMetadata.encryptionPluginName
             || secretMetadata.encryptionPluginName.isEmpty()) {
-        future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(secret.identifier().storagePluginName()).data(),
                     EncryptedStoragePluginFunctionWrapper::deriveKeyFromCode,
                     m_encryptedStoragePlugins[secret.identifier().storagePluginName()],
                     authenticationCode,
-                    m_requestQueue->saltData());
+                    m_requestQueue->saltData(),
+                    QVariantMap());
     } else {
-        future = QtConcurrent::run(
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
                     m_requestQueue->secretsThreadPool().data(),
                     EncryptionPluginFunctionWrapper::deriveKeyFromCode,
                     m_encryptionPlugins[secretMetadata.encryptionPluginName],
                     authenticationCode,
-                    m_requestQueue->saltData());
+                    m_requestQueue->saltData(),
+                    QVariantMap());
     }
 
     connect(watcher, &QFutureWatcher<DerivedKeyResult>::finished, [=] {
@@ -2439,8 +2609,9 @@ Daemon::ApiImpl::RequestProcessor::setStandaloneCustomLockSecretWithEncryptionKe
     QFuture<Result> future;
     if (secret.identifier().storagePluginName() == secretMetadata.encryptionPluginName
             || secretMetadata.encryptionPluginName.isEmpty()) {
-        future = QtConcurrent::run(
-                m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                requestId,
+                m_requestQueue->storagePluginThreadPool(secret.identifier().storagePluginName()).data(),
                 EncryptedStoragePluginFunctionWrapper::setStandaloneSecret,
                 m_encryptedStoragePlugins[secret.identifier().storagePluginName()],
                 secretMetadata,
@@ -2449,8 +2620,9 @@ Daemon::ApiImpl::RequestProcessor::setStandaloneCustomLockSecretWithEncryptionKe
     } else {
         Secret identifiedSecret(secret);
         identifiedSecret.setCollectionName(QStringLiteral("standalone"));
-        future = QtConcurrent::run(
-                m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                requestId,
+                m_requestQueue->storagePluginThreadPool(secret.identifier().storagePluginName()).data(),
                 StoragePluginFunctionWrapper::encryptAndStoreSecret,
                 m_encryptionPlugins[secretMetadata.encryptionPluginName],
                 m_storagePlugins[secret.identifier().storagePluginName()],
@@ -2513,14 +2685,16 @@ Daemon::ApiImpl::RequestProcessor::getCollectionSecret(
             = new QFutureWatcher<CollectionMetadataResult>(this);
     QFuture<CollectionMetadataResult> future;
     if (m_encryptedStoragePlugins.contains(identifier.storagePluginName())) {
-        future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(identifier.storagePluginName()).data(),
                     EncryptedStoragePluginFunctionWrapper::collectionMetadata,
                     m_encryptedStoragePlugins[identifier.storagePluginName()],
                     identifier.collectionName());
     } else {
-        future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(identifier.storagePluginName()).data(),
                     StoragePluginFunctionWrapper::collectionMetadata,
                     m_storagePlugins[identifier.storagePluginName()],
                     identifier.collectionName());
@@ -2600,8 +2774,9 @@ Daemon::ApiImpl::RequestProcessor::getCollectionSecretWithMetadata(
             || collectionMetadata.encryptionPluginName.isEmpty()) {
         // TODO: make this asynchronous instead of blocking the main thread!
         QFuture<LockedResult> future
-                = QtConcurrent::run(
-                        m_requestQueue->secretsThreadPool().data(),
+                = Daemon::ApiImpl::tracedRun(
+                        requestId,
+                        m_requestQueue->storagePluginThreadPool(identifier.storagePluginName()).data(),
                         EncryptedStoragePluginFunctionWrapper::isCollectionLocked,
                         m_encryptedStoragePlugins[identifier.storagePluginName()],
                         identifier.collectionName());
@@ -2832,19 +3007,23 @@ Daemon::ApiImpl::RequestProcessor::getCollectionSecretWithAuthenticationCode(
     QFuture<DerivedKeyResult> future;
     if (identifier.storagePluginName() == collectionMetadata.encryptionPluginName
             || collectionMetadata.encryptionPluginName.isEmpty()) {
-        future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(identifier.storagePluginName()).data(),
                     EncryptedStoragePluginFunctionWrapper::deriveKeyFromCode,
                     m_encryptedStoragePlugins[identifier.storagePluginName()],
                     authenticationCode,
-                    m_requestQueue->saltData());
+                    m_requestQueue->saltData(),
+                    collectionMetadata.kdfParameters);
     } else {
-        future = QtConcurrent::run(
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
                     m_requestQueue->secretsThreadPool().data(),
                     EncryptionPluginFunctionWrapper::deriveKeyFromCode,
                     m_encryptionPlugins[collectionMetadata.encryptionPluginName],
                     authenticationCode,
-                    m_requestQueue->saltData());
+                    m_requestQueue->saltData(),
+                    collectionMetadata.kdfParameters);
     }
 
     connect(watcher, &QFutureWatcher<DerivedKeyResult>::finished, [=] {
@@ -2882,24 +3061,25 @@ Daemon::ApiImpl::RequestProcessor::getCollectionSecretWithEncryptionKey(
     Q_UNUSED(userInteractionMode);
     Q_UNUSED(interactionServiceAddress);
 
+    const bool requiresRelock =
+            ((!collectionMetadata.usesDeviceLockKey
+              && collectionMetadata.unlockSemantic != SecretManager::CustomLockKeepUnlocked)
+            || (collectionMetadata.usesDeviceLockKey
+              && collectionMetadata.unlockSemantic != SecretManager::DeviceLockKeepUnlocked));
     QFutureWatcher<SecretResult> *watcher
             = new QFutureWatcher<SecretResult>(this);
     QFuture<SecretResult> future;
     if (identifier.storagePluginName() == collectionMetadata.encryptionPluginName
             || collectionMetadata.encryptionPluginName.isEmpty()) {
-        future = QtConcurrent::run(
-                m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                requestId,
+                m_requestQueue->storagePluginThreadPool(identifier.storagePluginName()).data(),
                 EncryptedStoragePluginFunctionWrapper::unlockCollectionAndReadSecret,
                 m_encryptedStoragePlugins[identifier.storagePluginName()],
                 collectionMetadata,
                 identifier,
                 encryptionKey);
     } else {
-        bool requiresRelock =
-                ((!collectionMetadata.usesDeviceLockKey
-                  && collectionMetadata.unlockSemantic != SecretManager::CustomLockKeepUnlocked)
-                || (collectionMetadata.usesDeviceLockKey
-                  && collectionMetadata.unlockSemantic != SecretManager::DeviceLockKeepUnlocked));
         const QString hashedCollectionName = calculateSecretNameHash(
                     Secret::Identifier(QString(), identifier.collectionName(), identifier.storagePluginName()));
         if (!m_collectionEncryptionKeys.contains(hashedCollectionName) && !requiresRelock) {
@@ -2907,8 +3087,9 @@ Daemon::ApiImpl::RequestProcessor::getCollectionSecretWithEncryptionKey(
             m_collectionEncryptionKeys.insert(hashedCollectionName, encryptionKey);
         }
 
-        future = QtConcurrent::run(
-                m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                requestId,
+                m_requestQueue->storagePluginThreadPool(identifier.storagePluginName()).data(),
                 StoragePluginFunctionWrapper::getAndDecryptSecret,
                 m_encryptionPlugins[collectionMetadata.encryptionPluginName],
                 m_storagePlugins[identifier.storagePluginName()],
@@ -2919,6 +3100,10 @@ Daemon::ApiImpl::RequestProcessor::getCollectionSecretWithEncryptionKey(
     connect(watcher, &QFutureWatcher<SecretResult>::finished, [=] {
         watcher->deleteLater();
         SecretResult sr = watcher->future().result();
+        if (requiresRelock) {
+            // the collection was unlocked for this read only.
+            emit m_requestQueue->collectionLocked(identifier.collectionName(), identifier.storagePluginName());
+        }
         QVariantList outParams;
         outParams << QVariant::fromValue<Result>(sr.result);
         outParams << QVariant::fromValue<Secret>(sr.secret);
@@ -2927,6 +3112,146 @@ Daemon::ApiImpl::RequestProcessor::getCollectionSecretWithEncryptionKey(
     watcher->setFuture(future);
 }
 
+// get the filter data of a secret in a collection, without its secret data
+Result
+Daemon::ApiImpl::RequestProcessor::getCollectionSecretFilterData(
+        pid_t callerPid,
+        quint64 requestId,
+        const Secret::Identifier &identifier,
+        Secret *secret)
+{
+    Q_UNUSED(secret); // asynchronous out param.
+    if (identifier.name().isEmpty()) {
+        return Result(Result::InvalidSecretError,
+                      QLatin1String("Empty secret name given"));
+    } else if (identifier.collectionName().isEmpty()) {
+        return Result(Result::OperationNotSupportedError,
+                      QLatin1String("Reading only the filter data of standalone secrets is not supported"));
+    } else if (identifier.collectionName().compare(QStringLiteral("standalone"), Qt::CaseInsensitive) == 0) {
+        return Result(Result::InvalidCollectionError,
+                      QLatin1String("Reserved collection name given"));
+    } else if (identifier.storagePluginName().isEmpty()) {
+        return Result(Result::InvalidExtensionPluginError,
+                      QLatin1String("Empty storage plugin name given"));
+    } else if (!m_encryptedStoragePlugins.contains(identifier.storagePluginName())
+               && !m_storagePlugins.contains(identifier.storagePluginName())) {
+        return Result(Result::InvalidExtensionPluginError,
+                      QLatin1String("Unknown storage plugin name given"));
+    }
+
+    // Read the metadata about the target collection
+    QFutureWatcher<CollectionMetadataResult> *watcher
+            = new QFutureWatcher<CollectionMetadataResult>(this);
+    QFuture<CollectionMetadataResult> future;
+    if (m_encryptedStoragePlugins.contains(identifier.storagePluginName())) {
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(identifier.storagePluginName()).data(),
+                    EncryptedStoragePluginFunctionWrapper::collectionMetadata,
+                    m_encryptedStoragePlugins[identifier.storagePluginName()],
+                    identifier.collectionName());
+    } else {
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(identifier.storagePluginName()).data(),
+                    StoragePluginFunctionWrapper::collectionMetadata,
+                    m_storagePlugins[identifier.storagePluginName()],
+                    identifier.collectionName());
+    }
+
+    connect(watcher, &QFutureWatcher<CollectionMetadataResult>::finished, [=] {
+        watcher->deleteLater();
+        CollectionMetadataResult cmr = watcher->future().result();
+        Result result = cmr.result.code() != Result::Succeeded
+                ? cmr.result
+                : getCollectionSecretFilterDataWithMetadata(
+                      callerPid,
+                      requestId,
+                      identifier,
+                      cmr.metadata);
+        if (result.code() != Result::Pending) {
+            QVariantList outParams;
+            outParams << QVariant::fromValue<Result>(result);
+            m_requestQueue->requestFinished(requestId, outParams);
+        }
+    });
+    watcher->setFuture(future);
+
+    return Result(Result::Pending);
+}
+
+Result
+Daemon::ApiImpl::RequestProcessor::getCollectionSecretFilterDataWithMetadata(
+        pid_t callerPid,
+        quint64 requestId,
+        const Secret::Identifier &identifier,
+        const CollectionMetadata &collectionMetadata)
+{
+    // TODO: perform access control request to see if the application has permission to read secure storage data.
+    const QString callerApplicationId = m_appPermissions->applicationIsPlatformApplication(callerPid)
+                ? m_appPermissions->platformApplicationId()
+                : m_appPermissions->applicationId(callerPid);
+
+    if (collectionMetadata.accessControlMode == SecretManager::SystemAccessControlMode) {
+        // TODO: perform access control request, to ask for permission to read the secret in the collection.
+        return Result(Result::OperationNotSupportedError,
+                      QLatin1String("Access control requests are not currently supported. TODO!"));
+    } else if (collectionMetadata.accessControlMode == SecretManager::OwnerOnlyMode
+               && collectionMetadata.ownerApplicationId != callerApplicationId) {
+        return Result(Result::PermissionsError,
+                      QString::fromLatin1("Collection %1 in plugin %2 is owned by a different application")
+                      .arg(identifier.collectionName(), identifier.storagePluginName()));
+    }
+
+    // The filter data is never decrypted by an encryption plugin, so no key
+    // is needed.  However, the collection must already be unlocked: reading
+    // the filter data never triggers an authentication flow.
+    const bool encryptedStorage = identifier.storagePluginName() == collectionMetadata.encryptionPluginName
+            || collectionMetadata.encryptionPluginName.isEmpty();
+    if (!encryptedStorage && !m_collectionEncryptionKeys.contains(calculateSecretNameHash(
+                Secret::Identifier(QString(), identifier.collectionName(), identifier.storagePluginName())))) {
+        return Result(Result::CollectionIsLockedError,
+                      QString::fromLatin1("Collection %1 is locked")
+                      .arg(identifier.collectionName()));
+    }
+
+    QFutureWatcher<SecretDataResult> *watcher
+            = new QFutureWatcher<SecretDataResult>(this);
+    QFuture<SecretDataResult> future;
+    if (encryptedStorage) {
+        // the plugin reports CollectionIsLockedError if the collection is locked.
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(identifier.storagePluginName()).data(),
+                    EncryptedStoragePluginFunctionWrapper::getSecretFilterData,
+                    m_encryptedStoragePlugins[identifier.storagePluginName()],
+                    identifier.collectionName(),
+                    identifier.name());
+    } else {
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(identifier.storagePluginName()).data(),
+                    StoragePluginFunctionWrapper::getSecretFilterData,
+                    m_storagePlugins[identifier.storagePluginName()],
+                    identifier.collectionName(),
+                    identifier.name());
+    }
+
+    connect(watcher, &QFutureWatcher<SecretDataResult>::finished, [=] {
+        watcher->deleteLater();
+        SecretDataResult sdr = watcher->future().result();
+        Secret secret(identifier);
+        secret.setFilterData(sdr.secretFilterData);
+        QVariantList outParams;
+        outParams << QVariant::fromValue<Result>(sdr.result);
+        outParams << QVariant::fromValue<Secret>(secret);
+        m_requestQueue->requestFinished(requestId, outParams);
+    });
+    watcher->setFuture(future);
+
+    return Result(Result::Pending);
+}
+
 // get a standalone secret
 Result
 Daemon::ApiImpl::RequestProcessor::getStandaloneSecret(
@@ -2958,15 +3283,17 @@ Daemon::ApiImpl::RequestProcessor::getStandaloneSecret(
             = new QFutureWatcher<SecretMetadataResult>(this);
     QFuture<SecretMetadataResult> future;
     if (m_encryptedStoragePlugins.contains(identifier.storagePluginName())) {
-        future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(identifier.storagePluginName()).data(),
                     EncryptedStoragePluginFunctionWrapper::secretMetadata,
                     m_encryptedStoragePlugins[identifier.storagePluginName()],
                     QStringLiteral("standalone"),
                     identifier.name());
     } else {
-        future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(identifier.storagePluginName()).data(),
                     StoragePluginFunctionWrapper::secretMetadata,
                     m_storagePlugins[identifier.storagePluginName()],
                     QStringLiteral("standalone"),
@@ -3153,19 +3480,23 @@ Daemon::ApiImpl::RequestProcessor::getStandaloneSecretWithAuthenticationCode(
     QFuture<DerivedKeyResult> future;
     if (identifier.storagePluginName() == secretMetadata.encryptionPluginName
             || secretMetadata.encryptionPluginName.isEmpty()) {
-        future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(identifier.storagePluginName()).data(),
                     EncryptedStoragePluginFunctionWrapper::deriveKeyFromCode,
                     m_encryptedStoragePlugins[identifier.storagePluginName()],
                     authenticationCode,
-                    m_requestQueue->saltData());
+                    m_requestQueue->saltData(),
+                    QVariantMap());
     } else {
-        future = QtConcurrent::run(
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
                     m_requestQueue->secretsThreadPool().data(),
                     EncryptionPluginFunctionWrapper::deriveKeyFromCode,
                     m_encryptionPlugins[secretMetadata.encryptionPluginName],
                     authenticationCode,
-                    m_requestQueue->saltData());
+                    m_requestQueue->saltData(),
+                    QVariantMap());
     }
 
     connect(watcher, &QFutureWatcher<DerivedKeyResult>::finished, [=] {
@@ -3208,8 +3539,9 @@ Daemon::ApiImpl::RequestProcessor::getStandaloneSecretWithEncryptionKey(
         QFutureWatcher<SecretDataResult> *watcher
                 = new QFutureWatcher<SecretDataResult>(this);
         QFuture<SecretDataResult> future
-                = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+                = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(identifier.storagePluginName()).data(),
                     EncryptedStoragePluginFunctionWrapper::accessStandaloneSecret,
                     m_encryptedStoragePlugins[identifier.storagePluginName()],
                     identifier.name(),
@@ -3236,8 +3568,9 @@ Daemon::ApiImpl::RequestProcessor::getStandaloneSecretWithEncryptionKey(
         QFutureWatcher<SecretResult> *watcher
                 = new QFutureWatcher<SecretResult>(this);
         QFuture<SecretResult>
-        future = QtConcurrent::run(
-                m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                requestId,
+                m_requestQueue->storagePluginThreadPool(identifier.storagePluginName()).data(),
                 StoragePluginFunctionWrapper::getAndDecryptSecret,
                 m_encryptionPlugins[secretMetadata.encryptionPluginName],
                 m_storagePlugins[identifier.storagePluginName()],
@@ -3266,6 +3599,7 @@ Daemon::ApiImpl::RequestProcessor::findCollectionSecrets(
         const QString &storagePluginName,
         const Secret::FilterData &filter,
         SecretManager::FilterOperator filterOperator,
+        SecretManager::FilterMatch filterMatch,
         SecretManager::UserInteractionMode userInteractionMode,
         const QString &interactionServiceAddress,
         QVector<Secret::Identifier> *identifiers)
@@ -3294,14 +3628,16 @@ Daemon::ApiImpl::RequestProcessor::findCollectionSecrets(
             = new QFutureWatcher<CollectionMetadataResult>(this);
     QFuture<CollectionMetadataResult> future;
     if (m_encryptedStoragePlugins.contains(storagePluginName)) {
-        future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(storagePluginName).data(),
                     EncryptedStoragePluginFunctionWrapper::collectionMetadata,
                     m_encryptedStoragePlugins[storagePluginName],
                     collectionName);
     } else {
-        future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(storagePluginName).data(),
                     StoragePluginFunctionWrapper::collectionMetadata,
                     m_storagePlugins[storagePluginName],
                     collectionName);
@@ -3319,6 +3655,7 @@ Daemon::ApiImpl::RequestProcessor::findCollectionSecrets(
                       storagePluginName,
                       filter,
                       filterOperator,
+                      filterMatch,
                       userInteractionMode,
                       interactionServiceAddress,
                       cmr.metadata);
@@ -3341,6 +3678,7 @@ Daemon::ApiImpl::RequestProcessor::findCollectionSecretsWithMetadata(
         const QString &storagePluginName,
         const Secret::FilterData &filter,
         SecretManager::FilterOperator filterOperator,
+        SecretManager::FilterMatch filterMatch,
         SecretManager::UserInteractionMode userInteractionMode,
         const QString &interactionServiceAddress,
         const CollectionMetadata &collectionMetadata)
@@ -3390,8 +3728,9 @@ Daemon::ApiImpl::RequestProcessor::findCollectionSecretsWithMetadata(
             || collectionMetadata.encryptionPluginName.isEmpty()) {
         // TODO: make this asynchronous instead of blocking the main thread!
         QFuture<LockedResult> future
-                = QtConcurrent::run(
-                        m_requestQueue->secretsThreadPool().data(),
+                = Daemon::ApiImpl::tracedRun(
+                        requestId,
+                        m_requestQueue->storagePluginThreadPool(storagePluginName).data(),
                         EncryptedStoragePluginFunctionWrapper::isCollectionLocked,
                         m_encryptedStoragePlugins[storagePluginName],
                         collectionName);
@@ -3435,6 +3774,7 @@ Daemon::ApiImpl::RequestProcessor::findCollectionSecretsWithMetadata(
                                                             << storagePluginName
                                                             << QVariant::fromValue<Secret::FilterData >(filter)
                                                             << filterOperator
+                                                            << filterMatch
                                                             << userInteractionMode
                                                             << interactionServiceAddress
                                                             << QVariant::fromValue<CollectionMetadata>(collectionMetadata)));
@@ -3485,6 +3825,7 @@ Daemon::ApiImpl::RequestProcessor::findCollectionSecretsWithMetadata(
                                                             << storagePluginName
                                                             << QVariant::fromValue<Secret::FilterData >(filter)
                                                             << filterOperator
+                                                            << filterMatch
                                                             << userInteractionMode
                                                             << interactionServiceAddress
                                                             << QVariant::fromValue<CollectionMetadata>(collectionMetadata)));
@@ -3498,6 +3839,7 @@ Daemon::ApiImpl::RequestProcessor::findCollectionSecretsWithMetadata(
                         storagePluginName,
                         filter,
                         filterOperator,
+                        filterMatch,
                         userInteractionMode,
                         interactionServiceAddress,
                         collectionMetadata,
@@ -3539,6 +3881,7 @@ Daemon::ApiImpl::RequestProcessor::findCollectionSecretsWithMetadata(
                                                             << storagePluginName
                                                             << QVariant::fromValue<Secret::FilterData >(filter)
                                                             << filterOperator
+                                                            << filterMatch
                                                             << userInteractionMode
                                                             << interactionServiceAddress
                                                             << QVariant::fromValue<CollectionMetadata>(collectionMetadata)));
@@ -3589,6 +3932,7 @@ Daemon::ApiImpl::RequestProcessor::findCollectionSecretsWithMetadata(
                                                             << storagePluginName
                                                             << QVariant::fromValue<Secret::FilterData >(filter)
                                                             << filterOperator
+                                                            << filterMatch
                                                             << userInteractionMode
                                                             << interactionServiceAddress
                                                             << QVariant::fromValue<CollectionMetadata>(collectionMetadata)));
@@ -3602,6 +3946,7 @@ Daemon::ApiImpl::RequestProcessor::findCollectionSecretsWithMetadata(
                         storagePluginName,
                         filter,
                         filterOperator,
+                        filterMatch,
                         userInteractionMode,
                         interactionServiceAddress,
                         collectionMetadata,
@@ -3619,6 +3964,7 @@ Daemon::ApiImpl::RequestProcessor::findCollectionSecretsWithAuthenticationCode(
         const QString &storagePluginName,
         const Secret::FilterData &filter,
         SecretManager::FilterOperator filterOperator,
+        SecretManager::FilterMatch filterMatch,
         SecretManager::UserInteractionMode userInteractionMode,
         const QString &interactionServiceAddress,
         const CollectionMetadata &collectionMetadata,
@@ -3639,19 +3985,23 @@ Daemon::ApiImpl::RequestProcessor::findCollectionSecretsWithAuthenticationCode(
     QFuture<DerivedKeyResult> future;
     if (storagePluginName == collectionMetadata.encryptionPluginName
             || collectionMetadata.encryptionPluginName.isEmpty()) {
-        future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(storagePluginName).data(),
                     EncryptedStoragePluginFunctionWrapper::deriveKeyFromCode,
                     m_encryptedStoragePlugins[storagePluginName],
                     authenticationCode,
-                    m_requestQueue->saltData());
+                    m_requestQueue->saltData(),
+                    collectionMetadata.kdfParameters);
     } else {
-        future = QtConcurrent::run(
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
                     m_requestQueue->secretsThreadPool().data(),
                     EncryptionPluginFunctionWrapper::deriveKeyFromCode,
                     m_encryptionPlugins[collectionMetadata.encryptionPluginName],
                     authenticationCode,
-                    m_requestQueue->saltData());
+                    m_requestQueue->saltData(),
+                    collectionMetadata.kdfParameters);
     }
 
     connect(watcher, &QFutureWatcher<DerivedKeyResult>::finished, [=] {
@@ -3665,7 +4015,7 @@ Daemon::ApiImpl::RequestProcessor::findCollectionSecretsWithAuthenticationCode(
             findCollectionSecretsWithEncryptionKey(
                         callerPid, requestId,
                         collectionName, storagePluginName,
-                        filter, filterOperator,
+                        filter, filterOperator, filterMatch,
                         userInteractionMode, interactionServiceAddress,
                         collectionMetadata, dkr.key);
         }
@@ -3683,6 +4033,7 @@ Daemon::ApiImpl::RequestProcessor::findCollectionSecretsWithEncryptionKey(
         const QString &storagePluginName,
         const Secret::FilterData &filter,
         SecretManager::FilterOperator filterOperator,
+        SecretManager::FilterMatch filterMatch,
         SecretManager::UserInteractionMode userInteractionMode,
         const QString &interactionServiceAddress,
         const CollectionMetadata &collectionMetadata,
@@ -3699,13 +4050,15 @@ Daemon::ApiImpl::RequestProcessor::findCollectionSecretsWithEncryptionKey(
     QFuture<IdentifiersResult> future;
     if (storagePluginName == collectionMetadata.encryptionPluginName
             || collectionMetadata.encryptionPluginName.isEmpty()) {
-        future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(storagePluginName).data(),
                     EncryptedStoragePluginFunctionWrapper::unlockAndFindSecrets,
                     m_encryptedStoragePlugins[storagePluginName],
                     collectionMetadata,
                     filter,
                     static_cast<StoragePlugin::FilterOperator>(filterOperator),
+                    static_cast<StoragePlugin::FilterMatch>(filterMatch),
                     encryptionKey);
     } else {
         bool requiresRelock =
@@ -3719,13 +4072,15 @@ Daemon::ApiImpl::RequestProcessor::findCollectionSecretsWithEncryptionKey(
             m_collectionEncryptionKeys.insert(hashedCollectionName, encryptionKey);
         }
 
-        future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(storagePluginName).data(),
                     StoragePluginFunctionWrapper::findSecrets,
                     m_storagePlugins[storagePluginName],
                     collectionName,
                     filter,
-                    static_cast<StoragePlugin::FilterOperator>(filterOperator));
+                    static_cast<StoragePlugin::FilterOperator>(filterOperator),
+                    static_cast<StoragePlugin::FilterMatch>(filterMatch));
     }
 
     connect(watcher, &QFutureWatcher<IdentifiersResult>::finished, [=] {
@@ -3739,6 +4094,114 @@ Daemon::ApiImpl::RequestProcessor::findCollectionSecretsWithEncryptionKey(
     watcher->setFuture(future);
 }
 
+// find secrets via filter in every unlocked collection of one or all storage plugins
+Result
+Daemon::ApiImpl::RequestProcessor::findSecretsInCollections(
+        pid_t callerPid,
+        quint64 requestId,
+        const QString &storagePluginName,
+        const Secret::FilterData &filter,
+        SecretManager::FilterOperator filterOperator,
+        SecretManager::FilterMatch filterMatch,
+        QVector<Secret::Identifier> *identifiers,
+        QVector<Secret::Identifier> *skippedCollections,
+        QVector<Result> *skippedCollectionResults)
+{
+    if (!storagePluginName.isEmpty()
+            && !m_encryptedStoragePlugins.contains(storagePluginName)
+            && !m_storagePlugins.contains(storagePluginName)) {
+        return Result(Result::InvalidExtensionPluginError,
+                      QStringLiteral("Unknown storage plugin name given"));
+    } else if (filter.isEmpty()) {
+        return Result(Result::InvalidFilterError,
+                      QLatin1String("Empty filter given"));
+    }
+
+    // TODO: perform access control request to see if the application has permission to read secure storage data.
+    const QString callerApplicationId = m_appPermissions->applicationIsPlatformApplication(callerPid)
+                ? m_appPermissions->platformApplicationId()
+                : m_appPermissions->applicationId(callerPid);
+
+    // Collections of plain storage plugins are only searchable while their
+    // key is cached; collections are never unlocked on behalf of a search.
+    const QSet<QString> unlockedCollectionHashes = m_collectionEncryptionKeys.keys().toSet();
+
+    // Search each plugin in a separate task in the worker thread of that
+    // plugin, so that the plugins are searched concurrently, and merge the
+    // results as each search finishes.
+    struct SearchState {
+        int remaining = 0;
+        CollectionSearchResult merged;
+    };
+    QSharedPointer<SearchState> state(new SearchState);
+    const auto searchPlugin = [=] (StoragePluginWrapper *storagePlugin,
+                                   EncryptedStoragePluginWrapper *encryptedStoragePlugin) {
+        QFutureWatcher<CollectionSearchResult> *watcher
+                = new QFutureWatcher<CollectionSearchResult>(this);
+        QFuture<CollectionSearchResult> future
+                = Daemon::ApiImpl::tracedRun(
+                        requestId,
+                        m_requestQueue->storagePluginThreadPool(storagePlugin
+                                                                ? storagePlugin->name()
+                                                                : encryptedStoragePlugin->name()).data(),
+                        Daemon::ApiImpl::findSecretsInCollections,
+                        storagePlugin,
+                        encryptedStoragePlugin,
+                        callerApplicationId,
+                        unlockedCollectionHashes,
+                        filter,
+                        static_cast<StoragePlugin::FilterOperator>(filterOperator),
+                        static_cast<StoragePlugin::FilterMatch>(filterMatch));
+        connect(watcher, &QFutureWatcher<CollectionSearchResult>::finished, [=] {
+            watcher->deleteLater();
+            CollectionSearchResult csr = watcher->future().result();
+            state->merged.identifiers << csr.identifiers;
+            state->merged.skippedCollections << csr.skippedCollections;
+            state->merged.skippedCollectionResults << csr.skippedCollectionResults;
+            if (--state->remaining == 0) {
+                QVariantList outParams;
+                outParams << QVariant::fromValue<Result>(Result(Result::Succeeded));
+                outParams << QVariant::fromValue<QVector<Secret::Identifier> >(state->merged.identifiers);
+                outParams << QVariant::fromValue<QVector<Secret::Identifier> >(state->merged.skippedCollections);
+                outParams << QVariant::fromValue<QVector<Result> >(state->merged.skippedCollectionResults);
+                m_requestQueue->requestFinished(requestId, outParams);
+            }
+        });
+        watcher->setFuture(future);
+    };
+
+    QList<StoragePluginWrapper*> storagePlugins;
+    QList<EncryptedStoragePluginWrapper*> encryptedStoragePlugins;
+    if (storagePluginName.isEmpty()) {
+        storagePlugins = m_storagePlugins.values();
+        encryptedStoragePlugins = m_encryptedStoragePlugins.values();
+    } else if (m_storagePlugins.contains(storagePluginName)) {
+        storagePlugins.append(m_storagePlugins.value(storagePluginName));
+    } else {
+        encryptedStoragePlugins.append(m_encryptedStoragePlugins.value(storagePluginName));
+    }
+
+    if (storagePlugins.isEmpty() && encryptedStoragePlugins.isEmpty()) {
+        // nothing to search, so the results are already complete.
+        identifiers->clear();
+        skippedCollections->clear();
+        skippedCollectionResults->clear();
+        return Result(Result::Succeeded);
+    }
+
+    // the counter must be set before any search is started, as the
+    // watchers only report completion via the event loop.
+    state->remaining = storagePlugins.size() + encryptedStoragePlugins.size();
+    for (StoragePluginWrapper *plugin : storagePlugins) {
+        searchPlugin(plugin, Q_NULLPTR);
+    }
+    for (EncryptedStoragePluginWrapper *plugin : encryptedStoragePlugins) {
+        searchPlugin(Q_NULLPTR, plugin);
+    }
+
+    return Result(Result::Pending);
+}
+
 // find standalone secrets via filter
 Result
 Daemon::ApiImpl::RequestProcessor::findStandaloneSecrets(
@@ -3747,6 +4210,7 @@ Daemon::ApiImpl::RequestProcessor::findStandaloneSecrets(
         const QString &storagePluginName,
         const Secret::FilterData &filter,
         SecretManager::FilterOperator filterOperator,
+        SecretManager::FilterMatch filterMatch,
         SecretManager::UserInteractionMode userInteractionMode,
         const QString &interactionServiceAddress,
         QVector<Secret::Identifier> *identifiers)
@@ -3757,6 +4221,7 @@ Daemon::ApiImpl::RequestProcessor::findStandaloneSecrets(
     Q_UNUSED(storagePluginName)
     Q_UNUSED(filter)
     Q_UNUSED(filterOperator)
+    Q_UNUSED(filterMatch)
     Q_UNUSED(userInteractionMode)
     Q_UNUSED(interactionServiceAddress)
     Q_UNUSED(identifiers)
@@ -3796,14 +4261,16 @@ Daemon::ApiImpl::RequestProcessor::deleteCollectionSecret(
             = new QFutureWatcher<CollectionMetadataResult>(this);
     QFuture<CollectionMetadataResult> future;
     if (m_encryptedStoragePlugins.contains(identifier.storagePluginName())) {
-        future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(identifier.storagePluginName()).data(),
                     EncryptedStoragePluginFunctionWrapper::collectionMetadata,
                     m_encryptedStoragePlugins[identifier.storagePluginName()],
                     identifier.collectionName());
     } else {
-        future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(identifier.storagePluginName()).data(),
                     StoragePluginFunctionWrapper::collectionMetadata,
                     m_storagePlugins[identifier.storagePluginName()],
                     identifier.collectionName());
@@ -3890,8 +4357,9 @@ Daemon::ApiImpl::RequestProcessor::deleteCollectionSecretWithMetadata(
             || collectionMetadata.encryptionPluginName.isEmpty()) {
         // TODO: make this asynchronous instead of blocking the main thread!
         QFuture<LockedResult> future
-                = QtConcurrent::run(
-                        m_requestQueue->secretsThreadPool().data(),
+                = Daemon::ApiImpl::tracedRun(
+                        requestId,
+                        m_requestQueue->storagePluginThreadPool(identifier.storagePluginName()).data(),
                         EncryptedStoragePluginFunctionWrapper::isCollectionLocked,
                         m_encryptedStoragePlugins[identifier.storagePluginName()],
                         identifier.collectionName());
@@ -4101,19 +4569,23 @@ Daemon::ApiImpl::RequestProcessor::deleteCollectionSecretWithAuthenticationCode(
     QFuture<DerivedKeyResult> future;
     if (identifier.storagePluginName() == collectionMetadata.encryptionPluginName
             || collectionMetadata.encryptionPluginName.isEmpty()) {
-        future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(identifier.storagePluginName()).data(),
                     EncryptedStoragePluginFunctionWrapper::deriveKeyFromCode,
                     m_encryptedStoragePlugins[identifier.storagePluginName()],
                     authenticationCode,
-                    m_requestQueue->saltData());
+                    m_requestQueue->saltData(),
+                    collectionMetadata.kdfParameters);
     } else {
-        future = QtConcurrent::run(
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
                     m_requestQueue->secretsThreadPool().data(),
                     EncryptionPluginFunctionWrapper::deriveKeyFromCode,
                     m_encryptionPlugins[collectionMetadata.encryptionPluginName],
                     authenticationCode,
-                    m_requestQueue->saltData());
+                    m_requestQueue->saltData(),
+                    collectionMetadata.kdfParameters);
     }
 
     connect(watcher, &QFutureWatcher<DerivedKeyResult>::finished, [=] {
@@ -4155,8 +4627,9 @@ Daemon::ApiImpl::RequestProcessor::deleteCollectionSecretWithEncryptionKey(
     QFuture<Result> future;
     if (identifier.storagePluginName() == collectionMetadata.encryptionPluginName
             || collectionMetadata.encryptionPluginName.isEmpty()) {
-        future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(identifier.storagePluginName()).data(),
                     EncryptedStoragePluginFunctionWrapper::unlockCollectionAndRemoveSecret,
                     m_encryptedStoragePlugins[identifier.storagePluginName()],
                     collectionMetadata,
@@ -4176,8 +4649,9 @@ Daemon::ApiImpl::RequestProcessor::deleteCollectionSecretWithEncryptionKey(
             m_collectionEncryptionKeys.insert(hashedCollectionName, encryptionKey);
         }
 
-        future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(identifier.storagePluginName()).data(),
                     StoragePluginFunctionWrapper::removeSecret,
                     m_storagePlugins[identifier.storagePluginName()],
                     identifier.collectionName(),
@@ -4207,15 +4681,17 @@ Daemon::ApiImpl::RequestProcessor::deleteStandaloneSecret(
             = new QFutureWatcher<SecretMetadataResult>(this);
     QFuture<SecretMetadataResult> future;
     if (m_encryptedStoragePlugins.contains(identifier.storagePluginName())) {
-        future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(identifier.storagePluginName()).data(),
                     EncryptedStoragePluginFunctionWrapper::secretMetadata,
                     m_encryptedStoragePlugins[identifier.storagePluginName()],
                     QStringLiteral("standalone"),
                     identifier.name());
     } else {
-        future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(identifier.storagePluginName()).data(),
                     StoragePluginFunctionWrapper::secretMetadata,
                     m_storagePlugins[identifier.storagePluginName()],
                     QStringLiteral("standalone"),
@@ -4280,15 +4756,17 @@ Daemon::ApiImpl::RequestProcessor::deleteStandaloneSecretWithMetadata(
     QFuture<Result> future;
     if (identifier.storagePluginName() == secretMetadata.encryptionPluginName
             || secretMetadata.encryptionPluginName.isEmpty()) {
-        future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(identifier.storagePluginName()).data(),
                     EncryptedStoragePluginFunctionWrapper::removeSecret,
                     m_encryptedStoragePlugins[identifier.storagePluginName()],
                     identifier.collectionName(),
                     identifier.name());
     } else {
-        future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(identifier.storagePluginName()).data(),
                     StoragePluginFunctionWrapper::removeSecret,
                     m_storagePlugins[identifier.storagePluginName()],
                     QStringLiteral("standalone"),
@@ -4335,8 +4813,9 @@ Daemon::ApiImpl::RequestProcessor::queryLockStatus(
     }
 
     // TODO: make this asynchronous.
-    QFuture<FoundLockStatusResult> future = QtConcurrent::run(
-                m_requestQueue->secretsThreadPool().data(),
+    QFuture<FoundLockStatusResult> future = Daemon::ApiImpl::tracedRun(
+                requestId,
+                m_requestQueue->storagePluginThreadPool(lockCodeTarget).data(),
                 &Daemon::ApiImpl::queryLockSpecificPlugin,
                 m_encryptionPlugins,
                 m_storagePlugins,
@@ -4573,8 +5052,9 @@ Daemon::ApiImpl::RequestProcessor::modifyLockCodeWithLockCodes(
 
     // see if the client is attempting to set the lock code for a plugin
     if (lockCodeTargetType == LockCodeRequest::ExtensionPlugin) {
-        QFuture<FoundResult> future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        QFuture<FoundResult> future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(lockCodeTarget).data(),
                     &Daemon::ApiImpl::modifyLockSpecificPlugin,
                     m_encryptionPlugins,
                     m_storagePlugins,
@@ -4621,15 +5101,15 @@ Daemon::ApiImpl::RequestProcessor::modifyLockCodeWithLockCodes(
     m_requestQueue->initialize(newLockCode, SecretsRequestQueue::ModifyLockMode);
 
     // re-encrypt the metadata (bookkeeping) databases for each storage plugin.
-    QFuture<bool> reencryptMetadata = QtConcurrent::run(
-                m_requestQueue->secretsThreadPool().data(),
+    const bool reencryptedMetadata = !runForEachStoragePlugin(
+                requestId,
+                m_requestQueue,
+                m_storagePlugins,
+                m_encryptedStoragePlugins,
                 &Daemon::ApiImpl::modifyMasterLockPlugins,
-                m_storagePlugins.values(),
-                m_encryptedStoragePlugins.values(),
                 oldBkdbLockKey,
-                m_requestQueue->bkdbLockKey());
-    reencryptMetadata.waitForFinished();
-    if (!reencryptMetadata.result()) {
+                m_requestQueue->bkdbLockKey()).contains(false);
+    if (!reencryptedMetadata) {
         // TODO: FIXME: how do we recover from this?  (Each plugin is modified serially, cannot be atomic...)
         qCWarning(lcSailfishSecretsDaemon) << "Critical Error! Failed to re-encrypt all metadata databases successfully!";
     }
@@ -4638,8 +5118,9 @@ Daemon::ApiImpl::RequestProcessor::modifyLockCodeWithLockCodes(
     for (EncryptedStoragePluginWrapper *plugin : m_encryptedStoragePlugins.values()) {
         // We don't allow storing device-locked standalone secrets in encryptedStoragePlugins,
         // so we just need to ensure that we re-encrypt collections here.
-        QFuture<Result> future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        QFuture<Result> future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(plugin->name()).data(),
                     EncryptedStoragePluginFunctionWrapper::unlockDeviceLockedCollectionsAndReencrypt,
                     plugin,
                     oldDeviceLockKey,
@@ -4655,8 +5136,9 @@ Daemon::ApiImpl::RequestProcessor::modifyLockCodeWithLockCodes(
         }
     }
     for (StoragePluginWrapper *plugin : m_storagePlugins.values()) {
-        QFuture<Result> future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        QFuture<Result> future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(plugin->name()).data(),
                     StoragePluginFunctionWrapper::reencryptDeviceLockedCollectionsAndSecrets,
                     plugin,
                     m_encryptionPlugins,
@@ -4734,14 +5216,14 @@ Daemon::ApiImpl::RequestProcessor::provideLockCode(
             }
 
             // unlock all of our plugins
-            QFuture<bool> future = QtConcurrent::run(
-                        m_requestQueue->secretsThreadPool().data(),
+            const bool unlocked = !runForEachStoragePlugin(
+                        requestId,
+                        m_requestQueue,
+                        m_storagePlugins,
+                        m_encryptedStoragePlugins,
                         &Daemon::ApiImpl::masterUnlockPlugins,
-                        m_storagePlugins.values(),
-                        m_encryptedStoragePlugins.values(),
-                        m_requestQueue->bkdbLockKey());
-            future.waitForFinished();
-            if (!future.result()) {
+                        m_requestQueue->bkdbLockKey()).contains(false);
+            if (!unlocked) {
                 // TODO: FIXME: how can we recover from this?
                 // This is symptomatic of a power-loss halfway through previous re-encryption,
                 // meaning that some metadata databases will have been encrypted with
@@ -4837,8 +5319,9 @@ Daemon::ApiImpl::RequestProcessor::provideLockCodeWithLockCode(
 
     // check if the client is attempting to unlock an extension plugin
     if (lockCodeTargetType == LockCodeRequest::ExtensionPlugin) {
-        QFuture<FoundResult> future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        QFuture<FoundResult> future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(lockCodeTarget).data(),
                     &Daemon::ApiImpl::unlockSpecificPlugin,
                     m_encryptionPlugins,
                     m_storagePlugins,
@@ -4878,14 +5361,14 @@ Daemon::ApiImpl::RequestProcessor::provideLockCodeWithLockCode(
     }
 
     // unlock all of our plugins
-    QFuture<bool> future = QtConcurrent::run(
-                m_requestQueue->secretsThreadPool().data(),
+    const bool unlocked = !runForEachStoragePlugin(
+                requestId,
+                m_requestQueue,
+                m_storagePlugins,
+                m_encryptedStoragePlugins,
                 &Daemon::ApiImpl::masterUnlockPlugins,
-                m_storagePlugins.values(),
-                m_encryptedStoragePlugins.values(),
-                m_requestQueue->bkdbLockKey());
-    future.waitForFinished();
-    if (!future.result()) {
+                m_requestQueue->bkdbLockKey()).contains(false);
+    if (!unlocked) {
         // TODO: FIXME: how can we recover from this?
         // This is symptomatic of a power-loss halfway through previous re-encryption,
         // meaning that some metadata databases will have been encrypted with
@@ -4928,8 +5411,9 @@ Daemon::ApiImpl::RequestProcessor::forgetLockCode(
                           QLatin1String("Only the system settings application can unlock the plugin"));
         }
 
-        QFuture<FoundResult> future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        QFuture<FoundResult> future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(lockCodeTarget).data(),
                     &Daemon::ApiImpl::lockSpecificPlugin,
                     m_encryptionPlugins,
                     m_storagePlugins,
@@ -4940,6 +5424,9 @@ Daemon::ApiImpl::RequestProcessor::forgetLockCode(
         if (fr.found) {
             // if the lock target was a plugin from the encryption/storage/encryptedStorage
             // maps, then return the lock result from the threaded plugin operation.
+            if (fr.result.code() == Result::Succeeded) {
+                emit m_requestQueue->collectionLocked(QString(), lockCodeTarget);
+            }
             return fr.result;
         } else if (m_authenticationPlugins.contains(lockCodeTarget)) {
             AuthenticationPlugin *p = m_authenticationPlugins.value(lockCodeTarget);
@@ -4978,12 +5465,13 @@ Daemon::ApiImpl::RequestProcessor::forgetLockCode(
         }
 
         // lock all of our plugins' metadata databases
-        QFuture<bool> future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
-                    &Daemon::ApiImpl::masterLockPlugins,
-                    m_storagePlugins.values(),
-                    m_encryptedStoragePlugins.values());
-        future.waitForFinished();
+        runForEachStoragePlugin(
+                    requestId,
+                    m_requestQueue,
+                    m_storagePlugins,
+                    m_encryptedStoragePlugins,
+                    &Daemon::ApiImpl::masterLockPlugins);
+        emit m_requestQueue->collectionLocked(QString(), QString());
 
         return Result(Result::Succeeded);
     }
@@ -5023,14 +5511,16 @@ Daemon::ApiImpl::RequestProcessor::useCollectionKeyPreCheck(
             = new QFutureWatcher<CollectionMetadataResult>(this);
     QFuture<CollectionMetadataResult> future;
     if (m_encryptedStoragePlugins.contains(identifier.storagePluginName())) {
-        future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(identifier.storagePluginName()).data(),
                     EncryptedStoragePluginFunctionWrapper::collectionMetadata,
                     m_encryptedStoragePlugins[identifier.storagePluginName()],
                     identifier.collectionName());
     } else {
-        future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(identifier.storagePluginName()).data(),
                     StoragePluginFunctionWrapper::collectionMetadata,
                     m_storagePlugins[identifier.storagePluginName()],
                     identifier.collectionName());
@@ -5149,8 +5639,9 @@ Daemon::ApiImpl::RequestProcessor::useCollectionKeyPreCheckWithMetadata(
     if (m_encryptedStoragePlugins.contains(identifier.storagePluginName())) {
         // TODO: make this asynchronous instead of blocking the main thread!
         QFuture<LockedResult> future
-                = QtConcurrent::run(
-                        m_requestQueue->secretsThreadPool().data(),
+                = Daemon::ApiImpl::tracedRun(
+                        requestId,
+                        m_requestQueue->storagePluginThreadPool(identifier.storagePluginName()).data(),
                         EncryptedStoragePluginFunctionWrapper::isCollectionLocked,
                         m_encryptedStoragePlugins[identifier.storagePluginName()],
                         identifier.collectionName());
@@ -5368,19 +5859,23 @@ Daemon::ApiImpl::RequestProcessor::useCollectionKeyPreCheckWithAuthenticationCod
     QFuture<DerivedKeyResult> future;
     if (identifier.storagePluginName() == collectionMetadata.encryptionPluginName
             || collectionMetadata.encryptionPluginName.isEmpty()) {
-        future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(identifier.storagePluginName()).data(),
                     EncryptedStoragePluginFunctionWrapper::deriveKeyFromCode,
                     m_encryptedStoragePlugins[identifier.storagePluginName()],
                     authenticationCode,
-                    m_requestQueue->saltData());
+                    m_requestQueue->saltData(),
+                    collectionMetadata.kdfParameters);
     } else {
-        future = QtConcurrent::run(
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
                     m_requestQueue->secretsThreadPool().data(),
                     EncryptionPluginFunctionWrapper::deriveKeyFromCode,
                     m_encryptionPlugins[collectionMetadata.encryptionPluginName],
                     authenticationCode,
-                    m_requestQueue->saltData());
+                    m_requestQueue->saltData(),
+                    collectionMetadata.kdfParameters);
     }
 
     connect(watcher, &QFutureWatcher<DerivedKeyResult>::finished, [=] {
@@ -5413,18 +5908,19 @@ Daemon::ApiImpl::RequestProcessor::useCollectionKeyPreCheckWithEncryptionKey(
         const QByteArray &collectionDecryptionKey)
 {
     Q_UNUSED(callerPid);
+    const bool requiresRelock = !collectionDecryptionKey.isEmpty() &&
+            ((!collectionMetadata.usesDeviceLockKey
+              && collectionMetadata.unlockSemantic != SecretManager::CustomLockKeepUnlocked)
+            || (collectionMetadata.usesDeviceLockKey
+              && collectionMetadata.unlockSemantic != SecretManager::DeviceLockKeepUnlocked));
     QFutureWatcher<Result> *watcher
             = new QFutureWatcher<Result>(this);
     QFuture<Result> future;
     if (identifier.storagePluginName() == collectionMetadata.encryptionPluginName
             || collectionMetadata.encryptionPluginName.isEmpty()) {
-        bool requiresRelock = !collectionDecryptionKey.isEmpty() &&
-                ((!collectionMetadata.usesDeviceLockKey
-                  && collectionMetadata.unlockSemantic != SecretManager::CustomLockKeepUnlocked)
-                || (collectionMetadata.usesDeviceLockKey
-                  && collectionMetadata.unlockSemantic != SecretManager::DeviceLockKeepUnlocked));
-        future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(identifier.storagePluginName()).data(),
                     EncryptedStoragePluginFunctionWrapper::collectionSecretPreCheck,
                     m_encryptedStoragePlugins[identifier.storagePluginName()],
                     CollectionInfo(identifier.collectionName(),
@@ -5433,8 +5929,9 @@ Daemon::ApiImpl::RequestProcessor::useCollectionKeyPreCheckWithEncryptionKey(
                     identifier.name(),
                     false);
     } else {
-        future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(identifier.storagePluginName()).data(),
                     StoragePluginFunctionWrapper::collectionSecretPreCheck,
                     m_storagePlugins[identifier.storagePluginName()],
                     identifier.collectionName(),
@@ -5445,6 +5942,10 @@ Daemon::ApiImpl::RequestProcessor::useCollectionKeyPreCheckWithEncryptionKey(
     connect(watcher, &QFutureWatcher<Result>::finished, [=] {
         watcher->deleteLater();
         Result result = watcher->future().result();
+        if (requiresRelock) {
+            // the collection key is handed out for this use only.
+            emit m_requestQueue->collectionLocked(identifier.collectionName(), identifier.storagePluginName());
+        }
         QVariantList outParams;
         outParams << QVariant::fromValue<Result>(result);
         outParams << QVariant::fromValue<QByteArray>(collectionDecryptionKey);
@@ -5485,14 +5986,16 @@ Daemon::ApiImpl::RequestProcessor::setCollectionKeyPreCheck(
             = new QFutureWatcher<CollectionMetadataResult>(this);
     QFuture<CollectionMetadataResult> future;
     if (m_encryptedStoragePlugins.contains(identifier.storagePluginName())) {
-        future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(identifier.storagePluginName()).data(),
                     EncryptedStoragePluginFunctionWrapper::collectionMetadata,
                     m_encryptedStoragePlugins[identifier.storagePluginName()],
                     identifier.collectionName());
     } else {
-        future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(identifier.storagePluginName()).data(),
                     StoragePluginFunctionWrapper::collectionMetadata,
                     m_storagePlugins[identifier.storagePluginName()],
                     identifier.collectionName());
@@ -5569,8 +6072,9 @@ Daemon::ApiImpl::RequestProcessor::setCollectionKeyPreCheckWithMetadata(
     if (m_encryptedStoragePlugins.contains(identifier.storagePluginName())) {
         // TODO: make this asynchronous instead of blocking the main thread!
         QFuture<LockedResult> future
-                = QtConcurrent::run(
-                        m_requestQueue->secretsThreadPool().data(),
+                = Daemon::ApiImpl::tracedRun(
+                        requestId,
+                        m_requestQueue->storagePluginThreadPool(identifier.storagePluginName()).data(),
                         EncryptedStoragePluginFunctionWrapper::isCollectionLocked,
                         m_encryptedStoragePlugins[identifier.storagePluginName()],
                         identifier.collectionName());
@@ -5777,19 +6281,23 @@ Daemon::ApiImpl::RequestProcessor::setCollectionKeyPreCheckWithAuthenticationCod
     QFuture<DerivedKeyResult> future;
     if (identifier.storagePluginName() == collectionMetadata.encryptionPluginName
             || collectionMetadata.encryptionPluginName.isEmpty()) {
-        future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(identifier.storagePluginName()).data(),
                     EncryptedStoragePluginFunctionWrapper::deriveKeyFromCode,
                     m_encryptedStoragePlugins[identifier.storagePluginName()],
                     authenticationCode,
-                    m_requestQueue->saltData());
+                    m_requestQueue->saltData(),
+                    collectionMetadata.kdfParameters);
     } else {
-        future = QtConcurrent::run(
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
                     m_requestQueue->secretsThreadPool().data(),
                     EncryptionPluginFunctionWrapper::deriveKeyFromCode,
                     m_encryptionPlugins[collectionMetadata.encryptionPluginName],
                     authenticationCode,
-                    m_requestQueue->saltData());
+                    m_requestQueue->saltData(),
+                    collectionMetadata.kdfParameters);
     }
 
     connect(watcher, &QFutureWatcher<DerivedKeyResult>::finished, [=] {
@@ -5832,8 +6340,9 @@ Daemon::ApiImpl::RequestProcessor::setCollectionKeyPreCheckWithEncryptionKey(
                   && collectionMetadata.unlockSemantic != SecretManager::CustomLockKeepUnlocked)
                 || (collectionMetadata.usesDeviceLockKey
                   && collectionMetadata.unlockSemantic != SecretManager::DeviceLockKeepUnlocked));
-        future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(identifier.storagePluginName()).data(),
                     EncryptedStoragePluginFunctionWrapper::collectionSecretPreCheck,
                     m_encryptedStoragePlugins[identifier.storagePluginName()],
                     CollectionInfo(identifier.collectionName(),
@@ -5842,8 +6351,9 @@ Daemon::ApiImpl::RequestProcessor::setCollectionKeyPreCheckWithEncryptionKey(
                     identifier.name(),
                     true);
     } else {
-        future = QtConcurrent::run(
-                    m_requestQueue->secretsThreadPool().data(),
+        future = Daemon::ApiImpl::tracedRun(
+                    requestId,
+                    m_requestQueue->storagePluginThreadPool(identifier.storagePluginName()).data(),
                     StoragePluginFunctionWrapper::collectionSecretPreCheck,
                     m_storagePlugins[identifier.storagePluginName()],
                     identifier.collectionName(),
@@ -5884,6 +6394,9 @@ Daemon::ApiImpl::RequestProcessor::userInputInteractionCompleted(
         if (m_pendingRequests.contains(requestId)) {
             // call the appropriate method to complete the request
             Daemon::ApiImpl::RequestProcessor::PendingRequest pr = m_pendingRequests.take(requestId);
+            Sailfish::Secrets::Daemon::ApiImpl::RequestTracer::instance()->addSpan(
+                    requestId, "processor", QStringLiteral("pendingRequest"),
+                    pr.startTime, Sailfish::Secrets::Daemon::ApiImpl::monotonicNsecs());
             switch (pr.requestType) {
                 case CreateCustomLockCollectionRequest: {
                     if (pr.parameters.size() != 8) {
@@ -6018,7 +6531,7 @@ Daemon::ApiImpl::RequestProcessor::userInputInteractionCompleted(
                     break;
                 }
                 case FindCollectionSecretsRequest: {
-                    if (pr.parameters.size() != 7) {
+                    if (pr.parameters.size() != 8) {
                         returnResult = Result(Result::UnknownError,
                                               QLatin1String("Internal error: incorrect parameter count!"));
                     } else {
@@ -6029,6 +6542,7 @@ Daemon::ApiImpl::RequestProcessor::userInputInteractionCompleted(
                                     pr.parameters.takeFirst().value<QString>(),
                                     pr.parameters.takeFirst().value<Secret::FilterData>(),
                                     static_cast<SecretManager::FilterOperator>(pr.parameters.takeFirst().value<int>()),
+                                    static_cast<SecretManager::FilterMatch>(pr.parameters.takeFirst().value<int>()),
                                     static_cast<SecretManager::UserInteractionMode>(pr.parameters.takeFirst().value<int>()),
                                     pr.parameters.takeFirst().value<QString>(),
                                     pr.parameters.takeFirst().value<CollectionMetadata>(),
@@ -6216,6 +6730,9 @@ void Daemon::ApiImpl::RequestProcessor::authenticationCompleted(
         if (m_pendingRequests.contains(requestId)) {
             // call the appropriate method to complete the request
             Daemon::ApiImpl::RequestProcessor::PendingRequest pr = m_pendingRequests.take(requestId);
+            Sailfish::Secrets::Daemon::ApiImpl::RequestTracer::instance()->addSpan(
+                    requestId, "processor", QStringLiteral("pendingRequest"),
+                    pr.startTime, Sailfish::Secrets::Daemon::ApiImpl::monotonicNsecs());
             Q_ASSERT(pr.callerPid == callerPid);
             switch (pr.requestType) {
                 case DeleteCollectionRequest: {
@@ -6308,7 +6825,7 @@ void Daemon::ApiImpl::RequestProcessor::authenticationCompleted(
                     break;
                 }
                 case FindCollectionSecretsRequest: {
-                    if (pr.parameters.size() != 7) {
+                    if (pr.parameters.size() != 8) {
                         returnResult = Result(Result::UnknownError,
                                               QLatin1String("Internal error: incorrect parameter count!"));
                     } else {
@@ -6319,6 +6836,7 @@ void Daemon::ApiImpl::RequestProcessor::authenticationCompleted(
                                     pr.parameters.takeFirst().value<QString>(),
                                     pr.parameters.takeFirst().value<Secret::FilterData>(),
                                     static_cast<SecretManager::FilterOperator>(pr.parameters.takeFirst().value<int>()),
+                                    static_cast<SecretManager::FilterMatch>(pr.parameters.takeFirst().value<int>()),
                                     static_cast<SecretManager::UserInteractionMode>(pr.parameters.takeFirst().value<int>()),
                                     pr.parameters.takeFirst().value<QString>(),
                                     pr.parameters.takeFirst().value<CollectionMetadata>(),
@@ -75,6 +75,9 @@ public:
                      Sailfish::Secrets::Daemon::ApiImpl::SecretsRequestQueue *parent = Q_NULLPTR);
 
     bool initializePlugins();
+    bool hasCachedUserKeys(const QByteArray &deviceLockKey) const;
+    bool holdsInMemoryCollections();
+    int releaseDatabaseMemory();
 
     // retrieve information about available plugins
     Sailfish::Secrets::Result getPluginInfo(
@@ -175,6 +178,13 @@ public:
             const QString &interactionServiceAddress,
             Sailfish::Secrets::Secret *secret);
 
+    // get the filter data of a secret in a collection, without its secret data
+    Sailfish::Secrets::Result getCollectionSecretFilterData(
+            pid_t callerPid,
+            quint64 requestId,
+            const Sailfish::Secrets::Secret::Identifier &identifier,
+            Sailfish::Secrets::Secret *secret);
+
     // get a standalone secret
     Sailfish::Secrets::Result getStandaloneSecret(
             pid_t callerPid,
@@ -192,10 +202,23 @@ public:
             const QString &storagePluginName,
             const Sailfish::Secrets::Secret::FilterData &filter,
             Sailfish::Secrets::SecretManager::FilterOperator filterOperator,
+            Sailfish::Secrets::SecretManager::FilterMatch filterMatch,
             Sailfish::Secrets::SecretManager::UserInteractionMode userInteractionMode,
             const QString &interactionServiceAddress,
             QVector<Sailfish::Secrets::Secret::Identifier> *identifiers);
 
+    // find secrets via filter in every unlocked collection of one or all storage plugins
+    Sailfish::Secrets::Result findSecretsInCollections(
+            pid_t callerPid,
+            quint64 requestId,
+            const QString &storagePluginName,
+            const Sailfish::Secrets::Secret::FilterData &filter,
+            Sailfish::Secrets::SecretManager::FilterOperator filterOperator,
+            Sailfish::Secrets::SecretManager::FilterMatch filterMatch,
+            QVector<Sailfish::Secrets::Secret::Identifier> *identifiers,
+            QVector<Sailfish::Secrets::Secret::Identifier> *skippedCollections,
+            QVector<Sailfish::Secrets::Result> *skippedCollectionResults);
+
     // find standalone secrets via filter
     Sailfish::Secrets::Result findStandaloneSecrets(
             pid_t callerPid,
@@ -203,6 +226,7 @@ public:
             const QString &storagePluginName,
             const Sailfish::Secrets::Secret::FilterData &filter,
             Sailfish::Secrets::SecretManager::FilterOperator filterOperator,
+            Sailfish::Secrets::SecretManager::FilterMatch filterMatch,
             Sailfish::Secrets::SecretManager::UserInteractionMode userInteractionMode,
             const QString &interactionServiceAddress,
             QVector<Sailfish::Secrets::Secret::Identifier> *identifiers);
@@ -366,6 +390,7 @@ private:
             Sailfish::Secrets::SecretManager::AccessControlMode accessControlMode,
             Sailfish::Secrets::SecretManager::UserInteractionMode userInteractionMode,
             const QString &interactionServiceAddress,
+            const QVariantMap &kdfParameters,
             const QByteArray &encryptionKey);
 
     Sailfish::Secrets::Result setCollectionSecretWithMetadata(
@@ -474,6 +499,12 @@ private:
             const CollectionMetadata &collectionMetadata,
             const QByteArray &encryptionKey);
 
+    Sailfish::Secrets::Result getCollectionSecretFilterDataWithMetadata(
+            pid_t callerPid,
+            quint64 requestId,
+            const Sailfish::Secrets::Secret::Identifier &identifier,
+            const CollectionMetadata &collectionMetadata);
+
     Sailfish::Secrets::Result getStandaloneSecretWithMetadata(
             pid_t callerPid,
             quint64 requestId,
@@ -507,6 +538,7 @@ private:
             const QString &storagePluginName,
             const Sailfish::Secrets::Secret::FilterData &filter,
             Sailfish::Secrets::SecretManager::FilterOperator filterOperator,
+            Sailfish::Secrets::SecretManager::FilterMatch filterMatch,
             Sailfish::Secrets::SecretManager::UserInteractionMode userInteractionMode,
             const QString &interactionServiceAddress,
             const CollectionMetadata &collectionMetadata);
@@ -518,6 +550,7 @@ private:
             const QString &storagePluginName,
             const Sailfish::Secrets::Secret::FilterData &filter,
             Sailfish::Secrets::SecretManager::FilterOperator filterOperator,
+            Sailfish::Secrets::SecretManager::FilterMatch filterMatch,
             Sailfish::Secrets::SecretManager::UserInteractionMode userInteractionMode,
             const QString &interactionServiceAddress,
             const CollectionMetadata &collectionMetadata,
@@ -530,6 +563,7 @@ private:
             const QString &storagePluginName,
             const Sailfish::Secrets::Secret::FilterData &filter,
             Sailfish::Secrets::SecretManager::FilterOperator filterOperator,
+            Sailfish::Secrets::SecretManager::FilterMatch filterMatch,
             Sailfish::Secrets::SecretManager::UserInteractionMode userInteractionMode,
             const QString &interactionServiceAddress,
             const CollectionMetadata &collectionMetadata,
@@ -683,15 +717,18 @@ private:
 private:
     struct PendingRequest {
         PendingRequest()
-            : callerPid(0), requestId(0), requestType(Sailfish::Secrets::Daemon::ApiImpl::InvalidRequest) {}
+            : callerPid(0), requestId(0), requestType(Sailfish::Secrets::Daemon::ApiImpl::InvalidRequest), startTime(0) {}
         PendingRequest(uint pid, quint64 rid, Sailfish::Secrets::Daemon::ApiImpl::RequestType rtype, QVariantList params)
-            : callerPid(pid), requestId(rid), requestType(rtype), parameters(params) {}
+            : callerPid(pid), requestId(rid), requestType(rtype), parameters(params)
+            , startTime(Sailfish::Secrets::Daemon::ApiImpl::monotonicNsecs()) {}
         PendingRequest(const PendingRequest &other)
-            : callerPid(other.callerPid), requestId(other.requestId), requestType(other.requestType), parameters(other.parameters) {}
+            : callerPid(other.callerPid), requestId(other.requestId), requestType(other.requestType), parameters(other.parameters)
+            , startTime(other.startTime) {}
         uint callerPid;
         quint64 requestId;
         Sailfish::Secrets::Daemon::ApiImpl::RequestType requestType;
         QVariantList parameters;
+        qint64 startTime; // used for request tracing
     };
 
     Sailfish::Secrets::Daemon::ApiImpl::SecretsRequestQueue *m_requestQueue;
@@ -8,18 +8,26 @@
 #include "controller_p.h"
 #include "discoveryobject_p.h"
 #include "logging_p.h"
+#include "startupprofiler_p.h"
 
 #include "CryptoImpl/crypto_p.h"
 #include "SecretsImpl/secrets_p.h"
 #include "SecretsImpl/metadatadb_p.h"
 #include "SecretsImpl/pluginfunctionwrappers_p.h"
 
+#include <QtCore/QCoreApplication>
 #include <QtCore/QString>
+#include <QtCore/QFile>
 #include <QtCore/QDir>
 #include <QtCore/QStandardPaths>
+#include <QtCore/QTimer>
 
 #include <QtConcurrent>
 
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
 namespace {
     QString p2pSocketAddress()
     {
@@ -40,10 +48,40 @@ namespace {
 
         return address;
     }
+
+    // Returns the resident set size of the daemon in kilobytes, or -1.
+    qint64 residentSetSizeKb()
+    {
+        QFile status(QStringLiteral("/proc/self/status"));
+        if (!status.open(QIODevice::ReadOnly)) {
+            return -1;
+        }
+
+        // the line is of the form "VmRSS:     1234 kB"
+        for (QByteArray line = status.readLine(); !line.isEmpty(); line = status.readLine()) {
+            if (line.startsWith("VmRSS:")) {
+                const QList<QByteArray> fields = line.simplified().split(' ');
+                return fields.size() >= 2 ? fields.at(1).toLongLong() : -1;
+            }
+        }
+        return -1;
+    }
+
+    const QString SecretsDiscoveryServiceName = QStringLiteral("org.sailfishos.secrets.daemon.discovery");
+    const QString CryptoDiscoveryServiceName = QStringLiteral("org.sailfishos.crypto.daemon.discovery");
 }
 
 Sailfish::Secrets::Daemon::Controller::Controller(bool autotestMode, QObject *parent)
     : QObject(parent)
+    , m_dbusServer(Q_NULLPTR)
+    , m_secretsDiscoveryObject(Q_NULLPTR)
+    , m_cryptoDiscoveryObject(Q_NULLPTR)
+    , m_idleTimer(Q_NULLPTR)
+    , m_trimTimer(Q_NULLPTR)
+    , m_lastRequestCount(0)
+    , m_trimCount(0)
+    , m_wasIdle(false)
+    , m_trimmed(true)
     , m_autotestMode(autotestMode)
     , m_isValid(false)
 {
@@ -61,9 +99,13 @@ Sailfish::Secrets::Daemon::Controller::Controller(bool autotestMode, QObject *pa
     // that we have the "correct" bookkeeping database lock key here,
     // but that's ok - we can unlock the database at some later point in
     // time after performing a UI flow asking the user to unlock.
-    if (m_secrets->initialize(
+    Sailfish::Secrets::Daemon::ApiImpl::StartupPhase initializePhase("initialize");
+    const bool initialized = m_secrets->initialize(
                 QByteArray(),
-                Sailfish::Secrets::Daemon::ApiImpl::SecretsRequestQueue::UnlockMode)) {
+                Sailfish::Secrets::Daemon::ApiImpl::SecretsRequestQueue::UnlockMode);
+    initializePhase.finish();
+    if (initialized) {
+        Sailfish::Secrets::Daemon::ApiImpl::StartupPhase phase("initializePlugins");
         m_secrets->initializePlugins();
     }
 
@@ -74,10 +116,12 @@ Sailfish::Secrets::Daemon::Controller::Controller(bool autotestMode, QObject *pa
         return;
     }
 
+    Sailfish::Secrets::Daemon::ApiImpl::StartupPhase dbusPhase("dbusSetup");
+
     // Initialize the discovery objects and register them on the session bus.
     // This allows clients who don't know the P2P socket file path to discover it via DBus.
     m_secretsDiscoveryObject  = new Sailfish::Secrets::Daemon::DiscoveryObject(this);
-    if (!m_secretsDiscoveryObject->registerObject(QString::fromUtf8("org.sailfishos.secrets.daemon.discovery"),
+    if (!m_secretsDiscoveryObject->registerObject(SecretsDiscoveryServiceName,
                                                   QString::fromUtf8("/Sailfish/Secrets/Discovery"))) {
         qCWarning(lcSailfishSecretsDaemon) << "Failed to register secrets discovery object on session bus!"
                                            << "Clients won't be able to connect! (Is another instance already running?)";
@@ -85,7 +129,7 @@ Sailfish::Secrets::Daemon::Controller::Controller(bool autotestMode, QObject *pa
     }
 
     m_cryptoDiscoveryObject  = new Sailfish::Crypto::Daemon::DiscoveryObject(this);
-    if (!m_cryptoDiscoveryObject->registerObject(QString::fromUtf8("org.sailfishos.crypto.daemon.discovery"),
+    if (!m_cryptoDiscoveryObject->registerObject(CryptoDiscoveryServiceName,
                                                  QString::fromUtf8("/Sailfish/Crypto/Discovery"))) {
         qCWarning(lcSailfishSecretsDaemon) << "Failed to register crypto discovery object on session bus!"
                                            << "Clients won't be able to connect! (Is another instance already running?)";
@@ -94,11 +138,38 @@ Sailfish::Secrets::Daemon::Controller::Controller(bool autotestMode, QObject *pa
 
     m_secretsDiscoveryObject->setPeerToPeerAddress(p2pDBusSocketAddress);
     m_cryptoDiscoveryObject->setPeerToPeerAddress(p2pDBusSocketAddress);
+    m_secretsDiscoveryObject->setRequestQueue(m_secrets);
+    m_cryptoDiscoveryObject->setRequestQueue(m_crypto);
 
     // Initialize the Peer-To-Peer DBus server.
     m_dbusServer = new QDBusServer(p2pDBusSocketAddress, this);
     connect(m_dbusServer, &QDBusServer::newConnection,
             this, &Sailfish::Secrets::Daemon::Controller::handleClientConnection);
+    dbusPhase.finish();
+
+    // The daemon is started on demand via DBus activation of its discovery
+    // service, and so may exit once it has been idle for the configured period.
+    bool timeoutOk = false;
+    const int idleExitTimeout = qgetenv(ENV_IDLE_EXIT_TIMEOUT).toInt(&timeoutOk);
+    if (timeoutOk && idleExitTimeout > 0) {
+        m_idleTimer = new QTimer(this);
+        m_idleTimer->setInterval(idleExitTimeout * 1000);
+        connect(m_idleTimer, &QTimer::timeout,
+                this, &Sailfish::Secrets::Daemon::Controller::checkIdle);
+        m_idleTimer->start();
+    }
+
+    // After a burst of activity, release the memory which was cached
+    // to serve it, once no requests have been received for a while.
+    bool trimTimeoutOk = false;
+    const int idleTrimTimeout = qgetenv(ENV_IDLE_TRIM_TIMEOUT).toInt(&trimTimeoutOk);
+    if (trimTimeoutOk && idleTrimTimeout > 0) {
+        m_trimTimer = new QTimer(this);
+        m_trimTimer->setInterval(idleTrimTimeout * 1000);
+        connect(m_trimTimer, &QTimer::timeout,
+                this, &Sailfish::Secrets::Daemon::Controller::checkIdleTrim);
+        m_trimTimer->start();
+    }
 
     m_isValid = true;
 }
@@ -122,11 +193,11 @@ Sailfish::Secrets::Daemon::Controller::crypto() const
 QWeakPointer<QThreadPool> Sailfish::Secrets::Daemon::Controller::threadPoolForPlugin(const QString &pluginName) const
 {
     if (m_secrets->potentialCryptoStoragePlugins().contains(pluginName)) {
-        return m_secrets->secretsThreadPool();
+        return m_secrets->storagePluginThreadPool(pluginName);
     } else if (m_crypto->plugins().contains(pluginName)) {
         return m_crypto->cryptoThreadPool();
     } else {
-        return m_secrets->secretsThreadPool();
+        return m_secrets->storagePluginThreadPool(pluginName);
     }
 }
 
@@ -270,4 +341,132 @@ void Sailfish::Secrets::Daemon::Controller::handleClientConnection(const QDBusCo
     // Each API implementation needs to register its DBus API object with the connection.
     m_secrets->handleClientConnection(connection);
     m_crypto->handleClientConnection(connection);
+
+    // Track the connection so that the daemon doesn't exit while it is in use.
+    m_clientConnectionNames.append(connection.name());
+    m_wasIdle = false;
+    QDBusConnection(connection).connect(QString(), // any service
+                                        QLatin1String("/org/freedesktop/DBus/Local"),
+                                        QLatin1String("org.freedesktop.DBus.Local"),
+                                        QLatin1String("Disconnected"),
+                                        this, SLOT(handleClientDisconnected()));
+}
+
+void Sailfish::Secrets::Daemon::Controller::handleClientDisconnected()
+{
+    // The signal doesn't identify the connection, so release all of the
+    // client connections which are no longer connected.
+    QStringList::iterator it = m_clientConnectionNames.begin();
+    while (it != m_clientConnectionNames.end()) {
+        if (QDBusConnection(*it).isConnected()) {
+            ++it;
+        } else {
+            qCDebug(lcSailfishSecretsDaemon) << "Client p2p connection closed:" << *it;
+            m_crypto->handleClientDisconnected(*it);
+            QDBusConnection::disconnectFromPeer(*it);
+            it = m_clientConnectionNames.erase(it);
+        }
+    }
+}
+
+// The daemon is idle if no clients are connected, no requests are being
+// processed, and it holds no state which could not be restored without
+// user interaction after a restart (e.g. cached collection keys derived
+// from a user-supplied passphrase, a master lock which was unlocked with
+// the user's lock code, or collections in an in-memory storage plugin).
+bool Sailfish::Secrets::Daemon::Controller::isIdle() const
+{
+    return m_clientConnectionNames.isEmpty()
+            && !m_secrets->hasRequests()
+            && !m_crypto->hasRequests()
+            && !m_secrets->holdsUnlockedState();
+}
+
+void Sailfish::Secrets::Daemon::Controller::checkIdleTrim()
+{
+    // Trim once per period of inactivity, i.e. if no requests have
+    // been enqueued since the previous check.
+    const quint64 requestCount = m_secrets->enqueuedRequestCount() + m_crypto->enqueuedRequestCount();
+    if (requestCount != m_lastRequestCount
+            || m_secrets->hasRequests()
+            || m_crypto->hasRequests()) {
+        m_lastRequestCount = requestCount;
+        m_trimmed = false;
+        return;
+    }
+
+    if (!m_trimmed) {
+        m_trimmed = true;
+        trimMemory();
+    }
+}
+
+// Releases memory which is cached to speed up request processing:
+// the prepared queries and page caches of the SQLite databases, the
+// idle crypto worker thread, and the free heap memory held by malloc.
+// The storage plugin worker threads are retained, as the database
+// connections may only be used from the thread which opened them.
+void Sailfish::Secrets::Daemon::Controller::trimMemory()
+{
+    const qint64 rssBefore = residentSetSizeKb();
+
+    const int databases = m_secrets->releaseDatabaseMemory();
+
+    // Crypto plugins may keep cipher session state with affinity to the
+    // worker thread, so only release it if no client could still use it.
+    handleClientDisconnected();
+    const bool releasedThreads = m_clientConnectionNames.isEmpty() && m_crypto->releaseIdleThreads();
+
+#if defined(__GLIBC__)
+    malloc_trim(0);
+#endif
+
+    const qint64 rssAfter = residentSetSizeKb();
+    qCInfo(lcSailfishSecretsDaemon) << "Trimmed idle memory: RSS before:" << rssBefore << "kB"
+                                    << "after:" << rssAfter << "kB"
+                                    << "databases shrunk:" << databases
+                                    << "crypto threads released:" << releasedThreads;
+
+    m_trimCount++;
+    m_lastTrimStatistics = QJsonObject();
+    m_lastTrimStatistics.insert(QStringLiteral("rssBeforeKb"), double(rssBefore));
+    m_lastTrimStatistics.insert(QStringLiteral("rssAfterKb"), double(rssAfter));
+    m_lastTrimStatistics.insert(QStringLiteral("databasesShrunk"), databases);
+    m_lastTrimStatistics.insert(QStringLiteral("cryptoThreadsReleased"), releasedThreads);
+}
+
+// Returns the number of times the daemon has trimmed its memory usage,
+// along with the outcome of the most recent trim, as a JSON object.
+QJsonObject Sailfish::Secrets::Daemon::Controller::trimStatistics() const
+{
+    QJsonObject statistics;
+    statistics.insert(QStringLiteral("trimCount"), double(m_trimCount));
+    if (!m_lastTrimStatistics.isEmpty()) {
+        statistics.insert(QStringLiteral("lastTrim"), m_lastTrimStatistics);
+    }
+    return statistics;
+}
+
+void Sailfish::Secrets::Daemon::Controller::checkIdle()
+{
+    handleClientDisconnected();
+    if (!isIdle()) {
+        m_wasIdle = false;
+        return;
+    }
+
+    // Require that the daemon was idle for a whole timer interval.
+    if (!m_wasIdle) {
+        m_wasIdle = true;
+        return;
+    }
+
+    qCDebug(lcSailfishSecretsDaemon) << "Daemon is idle, exiting";
+    m_idleTimer->stop();
+
+    // Release the discovery service names first, so that any client which
+    // calls the discovery service from now on activates a new instance.
+    QDBusConnection::sessionBus().unregisterService(SecretsDiscoveryServiceName);
+    QDBusConnection::sessionBus().unregisterService(CryptoDiscoveryServiceName);
+    QCoreApplication::quit();
 }
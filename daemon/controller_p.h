@@ -15,13 +15,17 @@
 #include <QtDBus/QDBusServer>
 
 #include <QtCore/QObject>
+#include <QtCore/QJsonObject>
 #include <QtCore/QString>
+#include <QtCore/QStringList>
 #include <QtCore/QThreadPool>
 #include <QtCore/QSharedPointer>
 
 #include <Secrets/Plugins/extensionplugins.h>
 #include <Secrets/plugininfo.h>
 
+class QTimer;
+
 // The environment variables which can be used to specify the name
 // of the default Crypto and Secrets plugins.
 // See Controller::mappedPluginName() for more information.
@@ -34,6 +38,17 @@
 #define ENV_DEFAULT_AUTHENTICATION_PLUGIN "SAILFISH_SECRETSD_DEFAULT_AUTHENTICATION_PLUGIN"
 #define ENV_INAPP_AUTHENTICATION_PLUGIN "SAILFISH_SECRETSD_INAPP_AUTHENTICATION_PLUGIN"
 
+// The environment variable which specifies the number of seconds after which
+// an idle daemon exits.  If unset or zero, the daemon never exits when idle.
+// See Controller::isIdle() for more information.
+#define ENV_IDLE_EXIT_TIMEOUT "SAILFISH_SECRETSD_IDLE_EXIT_TIMEOUT"
+
+// The environment variable which specifies the number of seconds without
+// requests after which the daemon releases cached memory.  If unset or
+// zero, the daemon never trims its memory usage.
+// See Controller::trimMemory() for more information.
+#define ENV_IDLE_TRIM_TIMEOUT "SAILFISH_SECRETSD_IDLE_TRIM_TIMEOUT"
+
 namespace Sailfish {
 
 namespace Crypto {
@@ -72,16 +87,33 @@ public:
     QMap<QString, Sailfish::Secrets::PluginInfo> pluginInfoForPlugins(
             QList<Sailfish::Secrets::PluginBase*> plugins,
             bool masterLocked);
+    QJsonObject trimStatistics() const;
 
 public Q_SLOTS:
     void handleClientConnection(const QDBusConnection &connection);
 
+private Q_SLOTS:
+    void handleClientDisconnected();
+    void checkIdle();
+    void checkIdleTrim();
+
 private:
+    bool isIdle() const;
+    void trimMemory();
+
     QDBusServer *m_dbusServer;
     Sailfish::Secrets::Daemon::DiscoveryObject *m_secretsDiscoveryObject;
     Sailfish::Crypto::Daemon::DiscoveryObject *m_cryptoDiscoveryObject;
     Sailfish::Secrets::Daemon::ApiImpl::SecretsRequestQueue *m_secrets;
     Sailfish::Crypto::Daemon::ApiImpl::CryptoRequestQueue *m_crypto;
+    QTimer *m_idleTimer;
+    QTimer *m_trimTimer;
+    QStringList m_clientConnectionNames;
+    quint64 m_lastRequestCount;
+    quint64 m_trimCount;
+    QJsonObject m_lastTrimStatistics;
+    bool m_wasIdle;
+    bool m_trimmed;
     bool m_autotestMode;
     bool m_isValid;
 };
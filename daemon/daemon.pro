@@ -31,12 +31,20 @@ HEADERS += \
     $$PWD/discoveryobject_p.h \
     $$PWD/logging_p.h \
     $$PWD/plugin_p.h \
-    $$PWD/requestqueue_p.h
+    $$PWD/requestqueue_p.h \
+    $$PWD/plugincallstatistics_p.h \
+    $$PWD/requeststatistics_p.h \
+    $$PWD/requesttracer_p.h \
+    $$PWD/startupprofiler_p.h
 
 SOURCES += \
     $$PWD/controller.cpp \
     $$PWD/plugin_p.cpp \
     $$PWD/requestqueue.cpp \
+    $$PWD/plugincallstatistics.cpp \
+    $$PWD/requeststatistics.cpp \
+    $$PWD/requesttracer.cpp \
+    $$PWD/startupprofiler.cpp \
     $$PWD/main.cpp
 
 include($$PWD/SecretsImpl/SecretsImpl.pri)
@@ -9,22 +9,52 @@
 #define SAILFISHSECRETS_DAEMON_DISCOVERYOBJECT_P_H
 
 #include <QtDBus/QDBusConnection>
+#include <QtDBus/QDBusConnectionInterface>
+#include <QtDBus/QDBusContext>
+#include <QtDBus/QDBusReply>
 
 #include <QtCore/QObject>
 #include <QtCore/QString>
+#include <QtCore/QJsonDocument>
 
 #include "controller_p.h"
+#include "requestqueue_p.h"
+#include "plugincallstatistics_p.h"
+#include "startupprofiler_p.h"
 #include "logging_p.h"
 
+#include "SecretsImpl/applicationpermissions_p.h"
+
 namespace Sailfish {
 
 namespace Secrets {
 
 namespace Daemon {
 
+// The diagnostic methods of the discovery objects reveal the request activity
+// of every client (and can change the daemon's behaviour), but the session bus
+// is open to any client, so only platform applications may call them.
+// Otherwise an access denied error is sent in reply, and false is returned.
+inline bool callerIsPlatformApplication(const QDBusContext &context,
+                                        const Sailfish::Secrets::Daemon::ApiImpl::ApplicationPermissions &permissions)
+{
+    if (context.calledFromDBus()) {
+        const QDBusReply<uint> pid = context.connection().interface()->servicePid(context.message().service());
+        // an unknown caller must not be mistaken for the daemon itself (pid zero)
+        if (pid.isValid() && pid.value() != 0
+                && permissions.applicationIsPlatformApplication(static_cast<pid_t>(pid.value()))) {
+            return true;
+        }
+        context.sendErrorReply(QDBusError::AccessDenied,
+                               QStringLiteral("Only platform applications may read the daemon diagnostics"));
+        return false;
+    }
+    return true;
+}
+
 // The DiscoveryObject exposes to clients the address of the peer to peer object
 // via the DBus session bus.
-class DiscoveryObject : public QObject
+class DiscoveryObject : public QObject, protected QDBusContext
 {
     Q_OBJECT
     Q_CLASSINFO("D-Bus Interface", "org.sailfishos.secrets.daemon.discovery")
@@ -33,6 +63,24 @@ class DiscoveryObject : public QObject
     "      <method name=\"peerToPeerAddress\" />\n"
     "          <arg name=\"address\" type=\"s\" direction=\"out\" />\n"
     "      </method>\n"
+    "      <method name=\"requestStatistics\">\n"
+    "          <arg name=\"statistics\" type=\"s\" direction=\"out\" />\n"
+    "      </method>\n"
+    "      <method name=\"requestTrace\">\n"
+    "          <arg name=\"trace\" type=\"s\" direction=\"out\" />\n"
+    "      </method>\n"
+    "      <method name=\"pluginStatistics\">\n"
+    "          <arg name=\"statistics\" type=\"s\" direction=\"out\" />\n"
+    "      </method>\n"
+    "      <method name=\"setPluginStatisticsEnabled\">\n"
+    "          <arg name=\"enabled\" type=\"b\" direction=\"in\" />\n"
+    "      </method>\n"
+    "      <method name=\"startupStatistics\">\n"
+    "          <arg name=\"statistics\" type=\"s\" direction=\"out\" />\n"
+    "      </method>\n"
+    "      <method name=\"trimStatistics\">\n"
+    "          <arg name=\"statistics\" type=\"s\" direction=\"out\" />\n"
+    "      </method>\n"
     "  </interface>\n"
     "")
 
@@ -40,9 +88,11 @@ public:
     DiscoveryObject(Sailfish::Secrets::Daemon::Controller *parent)
         : QObject(parent)
         , m_parent(parent)
+        , m_requestQueue(Q_NULLPTR)
         , m_registered(false) {}
 
     void setPeerToPeerAddress(const QString &p2pAddress) { m_p2pAddress = p2pAddress; }
+    void setRequestQueue(Sailfish::Secrets::Daemon::ApiImpl::RequestQueue *queue) { m_requestQueue = queue; }
     bool registerObject(const QString &serviceName, const QString &objectPath) {
         if (m_registered) {
             return true;
@@ -64,9 +114,58 @@ public:
 
 public Q_SLOTS:
     QString peerToPeerAddress() const { return m_p2pAddress; }
+    // Returns the per-request-type counters and latency histograms, as a JSON document.
+    QString requestStatistics() const {
+        if (!callerIsPlatformApplication(*this, m_appPermissions)) {
+            return QString();
+        }
+        return m_requestQueue
+                ? QString::fromUtf8(QJsonDocument(m_requestQueue->requestStatistics()).toJson(QJsonDocument::Compact))
+                : QString();
+    }
+    // Returns the recently recorded request spans of both the secrets and crypto APIs,
+    // in the Chrome trace-event JSON format.
+    QString requestTrace() const {
+        if (!callerIsPlatformApplication(*this, m_appPermissions)) {
+            return QString();
+        }
+        return QString::fromUtf8(Sailfish::Secrets::Daemon::ApiImpl::RequestTracer::instance()->toChromeTraceJson());
+    }
+    // Returns the per-plugin, per-operation call statistics of both the secrets
+    // and crypto plugins, as a JSON document.
+    QString pluginStatistics() const {
+        if (!callerIsPlatformApplication(*this, m_appPermissions)) {
+            return QString();
+        }
+        return QString::fromUtf8(QJsonDocument(Sailfish::Secrets::Daemon::ApiImpl::PluginCallStatistics::instance()->toJson()).toJson(QJsonDocument::Compact));
+    }
+    void setPluginStatisticsEnabled(bool enabled) {
+        if (!callerIsPlatformApplication(*this, m_appPermissions)) {
+            return;
+        }
+        Sailfish::Secrets::Daemon::ApiImpl::PluginCallStatistics::setEnabled(enabled);
+    }
+    // Returns the monotonic-clock timings of the startup phases of the daemon,
+    // relative to the entry to main(), as a JSON document.
+    QString startupStatistics() const {
+        if (!callerIsPlatformApplication(*this, m_appPermissions)) {
+            return QString();
+        }
+        return QString::fromUtf8(QJsonDocument(Sailfish::Secrets::Daemon::ApiImpl::StartupProfiler::instance()->toJson()).toJson(QJsonDocument::Compact));
+    }
+    // Returns the number of idle memory trims, and the resident set size
+    // before and after the most recent one, as a JSON document.
+    QString trimStatistics() const {
+        if (!callerIsPlatformApplication(*this, m_appPermissions)) {
+            return QString();
+        }
+        return QString::fromUtf8(QJsonDocument(m_parent->trimStatistics()).toJson(QJsonDocument::Compact));
+    }
 
 private:
     Sailfish::Secrets::Daemon::Controller *m_parent;
+    Sailfish::Secrets::Daemon::ApiImpl::RequestQueue *m_requestQueue;
+    Sailfish::Secrets::Daemon::ApiImpl::ApplicationPermissions m_appPermissions;
     QString m_p2pAddress;
     bool m_registered;
 };
@@ -81,7 +180,7 @@ namespace Daemon {
 
 // The DiscoveryObject exposes to clients the address of the peer to peer object
 // via the DBus session bus.
-class DiscoveryObject : public QObject
+class DiscoveryObject : public QObject, protected QDBusContext
 {
     Q_OBJECT
     Q_CLASSINFO("D-Bus Interface", "org.sailfishos.crypto.daemon.discovery")
@@ -90,6 +189,9 @@ class DiscoveryObject : public QObject
     "      <method name=\"peerToPeerAddress\" />\n"
     "          <arg name=\"address\" type=\"s\" direction=\"out\" />\n"
     "      </method>\n"
+    "      <method name=\"requestStatistics\">\n"
+    "          <arg name=\"statistics\" type=\"s\" direction=\"out\" />\n"
+    "      </method>\n"
     "  </interface>\n"
     "")
 
@@ -97,9 +199,11 @@ public:
     DiscoveryObject(Sailfish::Secrets::Daemon::Controller *parent)
         : QObject(parent)
         , m_parent(parent)
+        , m_requestQueue(Q_NULLPTR)
         , m_registered(false) {}
 
     void setPeerToPeerAddress(const QString &p2pAddress) { m_p2pAddress = p2pAddress; }
+    void setRequestQueue(Sailfish::Secrets::Daemon::ApiImpl::RequestQueue *queue) { m_requestQueue = queue; }
     bool registerObject(const QString &serviceName, const QString &objectPath) {
         if (m_registered) {
             return true;
@@ -121,9 +225,20 @@ public:
 
 public Q_SLOTS:
     QString peerToPeerAddress() const { return m_p2pAddress; }
+    // Returns the per-request-type counters and latency histograms, as a JSON document.
+    QString requestStatistics() const {
+        if (!Sailfish::Secrets::Daemon::callerIsPlatformApplication(*this, m_appPermissions)) {
+            return QString();
+        }
+        return m_requestQueue
+                ? QString::fromUtf8(QJsonDocument(m_requestQueue->requestStatistics()).toJson(QJsonDocument::Compact))
+                : QString();
+    }
 
 private:
     Sailfish::Secrets::Daemon::Controller *m_parent;
+    Sailfish::Secrets::Daemon::ApiImpl::RequestQueue *m_requestQueue;
+    Sailfish::Secrets::Daemon::ApiImpl::ApplicationPermissions m_appPermissions;
     QString m_p2pAddress;
     bool m_registered;
 };
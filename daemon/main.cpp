@@ -13,6 +13,7 @@
 #include "controller_p.h"
 #include "logging_p.h"
 #include "plugin_p.h"
+#include "startupprofiler_p.h"
 
 #include "Crypto/Plugins/extensionplugins.h"
 #include "Secrets/Plugins/extensionplugins.h"
@@ -25,6 +26,8 @@ Q_LOGGING_CATEGORY(lcSailfishCryptoDaemonDBus, "org.sailfishos.crypto.daemon.dbu
 
 Q_DECL_EXPORT int main(int argc, char *argv[])
 {
+    Sailfish::Secrets::Daemon::ApiImpl::StartupProfiler::instance()->markStart();
+
     const QString secretsPluginDir = QLatin1String("/usr/lib/Sailfish/Secrets/");
     const QString cryptoPluginDir = QLatin1String("/usr/lib/Sailfish/Crypto/");
     QCoreApplication::addLibraryPath(secretsPluginDir);
@@ -48,14 +51,20 @@ Q_DECL_EXPORT int main(int argc, char *argv[])
     app.installTranslator(engineeringEnglish.data());
     app.installTranslator(translator.data());
 
-    Sailfish::Secrets::Daemon::ApiImpl::PluginManager::instance()->loadPlugins<Sailfish::Secrets::AuthenticationPlugin,
-                                                                               Sailfish::Secrets::EncryptedStoragePlugin,
-                                                                               Sailfish::Secrets::StoragePlugin,
-                                                                               Sailfish::Secrets::EncryptionPlugin,
-                                                                               Sailfish::Crypto::CryptoPlugin>();
+    {
+        Sailfish::Secrets::Daemon::ApiImpl::StartupPhase phase("loadPlugins");
+        Sailfish::Secrets::Daemon::ApiImpl::PluginManager::instance()->loadPlugins<Sailfish::Secrets::AuthenticationPlugin,
+                                                                                   Sailfish::Secrets::EncryptedStoragePlugin,
+                                                                                   Sailfish::Secrets::StoragePlugin,
+                                                                                   Sailfish::Secrets::EncryptionPlugin,
+                                                                                   Sailfish::Crypto::CryptoPlugin>();
+    }
 
+    Sailfish::Secrets::Daemon::ApiImpl::StartupPhase controllerPhase("controllerConstruction");
     Sailfish::Secrets::Daemon::Controller controller(autotestMode);
+    controllerPhase.finish();
     if (controller.isValid()) {
+        Sailfish::Secrets::Daemon::ApiImpl::StartupProfiler::instance()->markReady();
         return app.exec();
     }
     return 1;
@@ -16,6 +16,8 @@
 #include "Secrets/Plugins/extensionplugins.h"
 #include "Crypto/Plugins/extensionplugins.h"
 
+#include "startupprofiler_p.h"
+
 namespace Sailfish {
 
 namespace Secrets {
@@ -106,6 +108,7 @@ public:
             if (addPlugin(loader, info, obj)) {
                 auto plugin = PluginHelpers::matchAnyPluginType<TPlugins...>(obj);
                 if (plugin) {
+                    StartupPhase phase("pluginInitialize", plugin->name());
                     plugin->initialize();
                 }
             }
@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2018 Jolla Ltd.
+ * Contact: Chris Adams <chris.adams@jollamobile.com>
+ * All rights reserved.
+ * BSD 3-Clause License, see LICENSE.
+ */
+
+#include "plugincallstatistics_p.h"
+
+#include <QtCore/QMutexLocker>
+
+#include <time.h>
+
+using namespace Sailfish::Secrets;
+
+namespace {
+    qint64 threadCpuNsecs()
+    {
+        struct timespec ts;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+        return qint64(ts.tv_sec) * Q_INT64_C(1000000000) + qint64(ts.tv_nsec);
+    }
+
+    bool pluginStatisticsEnabledByEnvironment()
+    {
+        const QByteArray value = qgetenv(ENV_PLUGIN_STATISTICS);
+        return !value.isEmpty() && value != "0";
+    }
+}
+
+QAtomicInt Daemon::ApiImpl::PluginCallStatistics::s_enabled(pluginStatisticsEnabledByEnvironment() ? 1 : 0);
+
+Daemon::ApiImpl::PluginCallStatistics *Daemon::ApiImpl::PluginCallStatistics::instance()
+{
+    static PluginCallStatistics statistics;
+    return &statistics;
+}
+
+Daemon::ApiImpl::PluginCallStatistics::PluginCallStatistics()
+{
+}
+
+Daemon::ApiImpl::PluginCallStatistics::~PluginCallStatistics()
+{
+    for (const QHash<QString, OperationStatistics*> &operations : m_plugins) {
+        qDeleteAll(operations);
+    }
+}
+
+void Daemon::ApiImpl::PluginCallStatistics::setEnabled(bool enabled)
+{
+    s_enabled.storeRelease(enabled ? 1 : 0);
+}
+
+void Daemon::ApiImpl::PluginCallStatistics::record(
+        const QString &pluginName,
+        const char *operation,
+        bool failed,
+        qint64 bytesIn,
+        qint64 bytesOut,
+        qint64 wallNsecs,
+        qint64 cpuNsecs)
+{
+    const QString operationName = QString::fromLatin1(operation);
+
+    QMutexLocker locker(&m_mutex);
+    OperationStatistics *&entry(m_plugins[pluginName][operationName]);
+    if (!entry) {
+        entry = new OperationStatistics;
+    }
+    OperationStatistics *stats = entry;
+    locker.unlock();
+
+    // entries are never removed while the daemon is running,
+    // so they can be updated without holding the lock.
+    stats->calls.fetchAndAddRelaxed(1);
+    if (failed) {
+        stats->errors.fetchAndAddRelaxed(1);
+    }
+    if (bytesIn > 0) {
+        stats->bytesIn.fetchAndAddRelaxed(quint64(bytesIn));
+    }
+    if (bytesOut > 0) {
+        stats->bytesOut.fetchAndAddRelaxed(quint64(bytesOut));
+    }
+    if (cpuNsecs > 0) {
+        stats->cpuUsecs.fetchAndAddRelaxed(quint64(cpuNsecs / 1000));
+    }
+    stats->wallTime.record(wallNsecs / 1000);
+}
+
+QJsonObject Daemon::ApiImpl::PluginCallStatistics::toJson() const
+{
+    QJsonObject plugins;
+    QMutexLocker locker(&m_mutex);
+    for (auto pit = m_plugins.constBegin(); pit != m_plugins.constEnd(); ++pit) {
+        QJsonObject operations;
+        for (auto oit = pit.value().constBegin(); oit != pit.value().constEnd(); ++oit) {
+            const OperationStatistics *stats = oit.value();
+            QJsonObject operation;
+            operation.insert(QStringLiteral("calls"), double(stats->calls.loadAcquire()));
+            operation.insert(QStringLiteral("errors"), double(stats->errors.loadAcquire()));
+            operation.insert(QStringLiteral("bytesIn"), double(stats->bytesIn.loadAcquire()));
+            operation.insert(QStringLiteral("bytesOut"), double(stats->bytesOut.loadAcquire()));
+            operation.insert(QStringLiteral("cpuUsecs"), double(stats->cpuUsecs.loadAcquire()));
+            operation.insert(QStringLiteral("wallTime"), stats->wallTime.toJson());
+            operations.insert(oit.key(), operation);
+        }
+        plugins.insert(pit.key(), operations);
+    }
+    locker.unlock();
+
+    QJsonObject retn;
+    retn.insert(QStringLiteral("enabled"), isEnabled());
+    retn.insert(QStringLiteral("plugins"), plugins);
+    return retn;
+}
+
+void Daemon::ApiImpl::PluginCallScope::start(const PluginBase *plugin)
+{
+    m_pluginName = plugin->name();
+    m_startCpuTime = m_recordStatistics ? threadCpuNsecs() : 0;
+    m_startTime = monotonicNsecs();
+}
+
+void Daemon::ApiImpl::PluginCallScope::finish()
+{
+    const qint64 endTime = monotonicNsecs();
+    if (m_recordStatistics) {
+        PluginCallStatistics::instance()->record(
+                m_pluginName, m_operation, m_failed,
+                m_bytesIn, m_bytesOut,
+                endTime - m_startTime,
+                threadCpuNsecs() - m_startCpuTime);
+    }
+
+    if (m_recordTrace) {
+        RequestTracer::instance()->addSpan(
+                RequestTracer::currentRequestId(), "plugin",
+                m_pluginName + QLatin1Char('.') + QLatin1String(m_operation),
+                m_startTime, endTime);
+    }
+}
@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2018 Jolla Ltd.
+ * Contact: Chris Adams <chris.adams@jollamobile.com>
+ * All rights reserved.
+ * BSD 3-Clause License, see LICENSE.
+ */
+
+#ifndef SAILFISHSECRETS_DAEMON_PLUGINCALLSTATISTICS_P_H
+#define SAILFISHSECRETS_DAEMON_PLUGINCALLSTATISTICS_P_H
+
+#include <QtCore/QAtomicInteger>
+#include <QtCore/QHash>
+#include <QtCore/QJsonObject>
+#include <QtCore/QMutex>
+#include <QtCore/QString>
+
+#include "Secrets/Plugins/extensionplugins.h"
+#include "Secrets/result.h"
+#include "Crypto/result.h"
+
+#include "requeststatistics_p.h"
+#include "requesttracer_p.h"
+
+#define ENV_PLUGIN_STATISTICS "SAILFISH_SECRETSD_PLUGIN_STATISTICS"
+
+namespace Sailfish {
+
+namespace Secrets {
+
+namespace Daemon {
+
+namespace ApiImpl {
+
+// Per-plugin, per-operation call counts, error counts, bytes in/out
+// and wall/CPU time of the calls made through the plugin function wrappers.
+// Collection is disabled by default (or enabled at startup via the
+// SAILFISH_SECRETSD_PLUGIN_STATISTICS environment variable), and can be
+// toggled at runtime.  When disabled, instrumented calls only pay for a
+// single relaxed atomic load.
+class PluginCallStatistics
+{
+public:
+    static PluginCallStatistics *instance();
+
+    static bool isEnabled() { return s_enabled.load() != 0; }
+    static void setEnabled(bool enabled);
+
+    void record(const QString &pluginName,
+                const char *operation,
+                bool failed,
+                qint64 bytesIn,
+                qint64 bytesOut,
+                qint64 wallNsecs,
+                qint64 cpuNsecs);
+
+    QJsonObject toJson() const;
+
+private:
+    PluginCallStatistics();
+    ~PluginCallStatistics();
+    Q_DISABLE_COPY(PluginCallStatistics)
+
+    struct OperationStatistics {
+        QAtomicInteger<quint64> calls;
+        QAtomicInteger<quint64> errors;
+        QAtomicInteger<quint64> bytesIn;
+        QAtomicInteger<quint64> bytesOut;
+        QAtomicInteger<quint64> cpuUsecs;
+        LatencyHistogram wallTime;
+    };
+
+    static QAtomicInt s_enabled;
+    mutable QMutex m_mutex;
+    QHash<QString, QHash<QString, OperationStatistics*> > m_plugins;
+};
+
+inline bool isPluginCallFailure(bool succeeded) { return !succeeded; }
+inline bool isPluginCallFailure(const Sailfish::Secrets::Result &result) { return result.code() == Sailfish::Secrets::Result::Failed; }
+inline bool isPluginCallFailure(const Sailfish::Crypto::Result &result) { return result.code() == Sailfish::Crypto::Result::Failed; }
+template <typename T> bool isPluginCallFailure(const T &wrapperResult) { return isPluginCallFailure(wrapperResult.result); }
+
+// Instruments a single call to a plugin operation, from construction
+// until destruction.  The value returned from the plugin function wrapper
+// should be passed through result(), so that failures can be counted.
+class PluginCallScope
+{
+public:
+    PluginCallScope(const Sailfish::Secrets::PluginBase *plugin,
+                    const char *operation,
+                    qint64 bytesIn = 0)
+        : m_operation(operation)
+        , m_bytesIn(bytesIn)
+        , m_bytesOut(0)
+        , m_startTime(0)
+        , m_startCpuTime(0)
+        , m_failed(false)
+        , m_recordStatistics(PluginCallStatistics::isEnabled())
+        , m_recordTrace(RequestTracer::currentRequestId() != 0)
+    {
+        if ((m_recordStatistics || m_recordTrace) && plugin) {
+            start(plugin);
+        }
+    }
+
+    ~PluginCallScope()
+    {
+        if (m_startTime) {
+            finish();
+        }
+    }
+
+    void setBytesOut(qint64 bytesOut) { m_bytesOut = bytesOut; }
+
+    template <typename T> const T &result(const T &value)
+    {
+        if (m_startTime) {
+            m_failed = isPluginCallFailure(value);
+        }
+        return value;
+    }
+
+private:
+    Q_DISABLE_COPY(PluginCallScope)
+    void start(const Sailfish::Secrets::PluginBase *plugin);
+    void finish();
+
+    QString m_pluginName;
+    const char *m_operation;
+    qint64 m_bytesIn;
+    qint64 m_bytesOut;
+    qint64 m_startTime;
+    qint64 m_startCpuTime;
+    bool m_failed;
+    bool m_recordStatistics;
+    bool m_recordTrace;
+};
+
+} // ApiImpl
+
+} // Daemon
+
+} // Secrets
+
+} // Sailfish
+
+#endif // SAILFISHSECRETS_DAEMON_PLUGINCALLSTATISTICS_P_H
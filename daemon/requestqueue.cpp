@@ -7,6 +7,7 @@
 
 #include "requestqueue_p.h"
 #include "logging_p.h"
+#include "startupprofiler_p.h"
 
 #include "Secrets/secretsdaemonconnection_p.h"
 
@@ -25,6 +26,7 @@ Daemon::ApiImpl::RequestQueue::RequestQueue(
     , m_controller(parent)
     , m_dbusObjectPath(dbusObjectPath)
     , m_dbusInterfaceName(dbusInterfaceName)
+    , m_enqueuedRequestCount(0)
     , m_autotestMode(autotestMode)
 {
     qCDebug(lcSailfishSecretsDaemon) << "New API implementation request queue constructed:" << m_dbusObjectPath << "," << m_dbusInterfaceName;
@@ -54,6 +56,7 @@ void Daemon::ApiImpl::RequestQueue::handleRequest(
         const QVariantList &inParams,
         const QDBusConnection &connection,
         const QDBusMessage &message,
+        quint64 traceId,
         Sailfish::Crypto::Result &returnResult)
 {
     // queue up a Sailfish Crypto API request
@@ -72,6 +75,7 @@ void Daemon::ApiImpl::RequestQueue::handleRequest(
         data->type = requestType;
         data->inParams = inParams;
         data->requestId = 0;
+        data->traceId = traceId;
         Result result = enqueueRequest(data);
         if (result.code() == Result::Succeeded) {
             data->message = message;
@@ -91,6 +95,7 @@ void Daemon::ApiImpl::RequestQueue::handleRequest(
         const QVariantList &inParams,
         const QDBusConnection &connection,
         const QDBusMessage &message,
+        quint64 traceId,
         Result &returnResult)
 {
     // queue up a Sailfish Secrets API request
@@ -109,6 +114,7 @@ void Daemon::ApiImpl::RequestQueue::handleRequest(
         data->type = requestType;
         data->inParams = inParams;
         data->requestId = 0;
+        data->traceId = traceId;
         Result result = enqueueRequest(data);
         if (result.code() == Result::Succeeded) {
             data->message = message;
@@ -136,25 +142,97 @@ void Daemon::ApiImpl::RequestQueue::handleRequest(
     data->requestId = 0;
     data->isSecretsCryptoRequest = true;
     data->cryptoRequestId = cryptoRequestId;
+    data->traceId = RequestTracer::instance()->traceId(cryptoRequestId);
     result = enqueueRequest(data);
     if (result.code() == Result::Failed) {
         delete data;
     }
 }
 
-Result Daemon::ApiImpl::RequestQueue::enqueueRequest(Daemon::ApiImpl::RequestQueue::RequestData *request)
+void Daemon::ApiImpl::RequestQueue::handleDirectRequest(
+        pid_t callerPid,
+        quint64 cryptoRequestId,
+        int requestType,
+        const QVariantList &inParams,
+        Result &result,
+        bool *completed)
 {
-    static quint64 requestId = 0;
+    // handle a Secrets request as part of a Crypto request immediately,
+    // rather than appending it to the queue and waiting for a pass over it.
+    // The request is subject to the same checks as a queued request,
+    // as those are performed by handlePendingRequest().
+    *completed = false;
+    quint64 requestId = 0;
+    if (!nextFreeRequestId(&requestId)) {
+        qCWarning(lcSailfishSecretsDaemon) << "Cannot handle direct request:" << requestTypeToString(requestType) << ": queue is full!";
+        m_statistics.requestRejected(requestType);
+        result = Result(Result::SecretsDaemonRequestQueueFullError,
+                        QString::fromUtf8("Request queue is full, try again later"));
+        return;
+    }
 
-    // If no free request ids (i.e. queue is full) then return an error to the client.
-    quint64 prevId = requestId;
-    quint64 nextFreeId = ++requestId;
+    Daemon::ApiImpl::RequestQueue::RequestData *data = new Daemon::ApiImpl::RequestQueue::RequestData;
+    data->requestId = requestId;
+    data->remotePid = callerPid;
+    data->status = Daemon::ApiImpl::RequestQueue::RequestInProgress;
+    data->type = requestType;
+    data->inParams = inParams;
+    data->isSecretsCryptoRequest = true;
+    data->cryptoRequestId = cryptoRequestId;
+    data->traceId = RequestTracer::instance()->traceId(cryptoRequestId);
+    if (!data->traceId) {
+        data->traceId = RequestTracer::instance()->generateTraceId();
+    }
+
+    qCDebug(lcSailfishSecretsDaemon) << "Handling direct" << requestTypeToString(requestType)
+                                     << "request with id:" << requestId
+                                     << "trace id:" << QString::number(data->traceId, 16)
+                                     << "(secrets crypto)";
+
+    const qint64 handleStartTime = monotonicNsecs();
+    data->enqueuedTime = handleStartTime;
+    m_enqueuedRequestCount++;
+    m_statistics.requestEnqueued(requestType);
+    RequestTracer::instance()->beginRequest(requestId, data->traceId, requestTypeToString(requestType));
+    m_directRequests.insert(requestId, data);
+
+    // the calling Crypto request is still being handled, so restore its id afterwards.
+    const quint64 callingRequestId = RequestTracer::currentRequestId();
+    RequestTracer::setCurrentRequestId(requestId);
+    handlePendingRequest(data, completed);
+    RequestTracer::setCurrentRequestId(callingRequestId);
+    const qint64 handleEndTime = monotonicNsecs();
+    data->processingTime += handleEndTime - handleStartTime;
+    RequestTracer::instance()->addSpan(requestId, "queue", QStringLiteral("handlePendingRequest"),
+                                       handleStartTime, handleEndTime);
+    if (*completed) {
+        m_directRequests.remove(requestId);
+        recordCompletedRequest(data);
+        delete data;
+    } else {
+        // the request is now waiting for an asynchronous
+        // plugin operation or user interaction to complete.
+        data->pluginExecutionStartTime = handleEndTime;
+    }
+
+    result = Result(Result::Succeeded);
+}
+
+bool Daemon::ApiImpl::RequestQueue::nextFreeRequestId(quint64 *requestId)
+{
+    static quint64 lastRequestId = 0;
+
+    quint64 prevId = lastRequestId;
+    quint64 nextFreeId = ++lastRequestId;
     bool found = false;
     for ( ; nextFreeId != prevId; ++nextFreeId) {
         found = false;
         if (m_enqueuingRequests.contains(nextFreeId)) {
             // another enqueuing request is using this id.
             found = true;
+        } else if (m_directRequests.contains(nextFreeId)) {
+            // another direct request is using this id.
+            found = true;
         } else {
             QList<Daemon::ApiImpl::RequestQueue::RequestData*>::const_iterator it = m_requests.constBegin();
             while (it != m_requests.constEnd()) {
@@ -173,22 +251,51 @@ Result Daemon::ApiImpl::RequestQueue::enqueueRequest(Daemon::ApiImpl::RequestQue
     }
 
     if (found) {
+        // all request ids are taken.
+        return false;
+    }
+
+    lastRequestId = nextFreeId;
+    *requestId = nextFreeId;
+    return true;
+}
+
+Result Daemon::ApiImpl::RequestQueue::enqueueRequest(Daemon::ApiImpl::RequestQueue::RequestData *request)
+{
+    if (Daemon::ApiImpl::StartupProfiler::isRecording()) {
+        Daemon::ApiImpl::StartupProfiler::instance()->markFirstRequest();
+    }
+
+    // If no free request ids (i.e. queue is full) then return an error to the client.
+    quint64 nextFreeId = 0;
+    if (!nextFreeRequestId(&nextFreeId)) {
         // all request ids are taken.  we cannot enqueue this request.
         qCWarning(lcSailfishSecretsDaemon) << "Cannot enqueue request:" << requestTypeToString(request->type) << ": queue is full!";
+        m_statistics.requestRejected(request->type);
         return Result(Result::SecretsDaemonRequestQueueFullError,
                                          QString::fromUtf8("Request queue is full, try again later"));
     }
 
+    if (!request->traceId) {
+        request->traceId = RequestTracer::instance()->generateTraceId();
+    }
+
     if (request->isSecretsCryptoRequest) {
         qCDebug(lcSailfishSecretsDaemon) << "Enqueuing" << requestTypeToString(request->type)
                                          << "request with id:" << nextFreeId
+                                         << "trace id:" << QString::number(request->traceId, 16)
                                          << "(secrets crypto)";
     } else {
         qCDebug(lcSailfishSecretsDaemon) << "Enqueuing" << requestTypeToString(request->type)
-                                         << "request with id:" << nextFreeId;
+                                         << "request with id:" << nextFreeId
+                                         << "trace id:" << QString::number(request->traceId, 16);
     }
 
     request->requestId = nextFreeId;
+    request->enqueuedTime = monotonicNsecs();
+    m_enqueuedRequestCount++;
+    m_statistics.requestEnqueued(request->type);
+    RequestTracer::instance()->beginRequest(nextFreeId, request->traceId, requestTypeToString(request->type));
     m_enqueuingRequests.insert(nextFreeId, request);
     // asynchronously append the request to the queue,
     // to avoid invalidating any iterators operating on it.
@@ -211,13 +318,67 @@ void Daemon::ApiImpl::RequestQueue::finishEnqueueRequest(quint64 requestId)
     QMetaObject::invokeMethod(this, "handleRequests", Qt::QueuedConnection);
 }
 
+void Daemon::ApiImpl::RequestQueue::finishDirectRequest(quint64 requestId)
+{
+    Daemon::ApiImpl::RequestQueue::RequestData *request = m_directRequests.value(requestId);
+    if (!request || request->status != Daemon::ApiImpl::RequestQueue::RequestFinished) {
+        // Should never happen, if it does it is always due to a bug in the request queue code.
+        qCWarning(lcSailfishSecretsDaemon) << "Unable to finish direct request:" << requestId;
+        return;
+    }
+
+    bool completed = false;
+    const qint64 handleStartTime = monotonicNsecs();
+    RequestTracer::setCurrentRequestId(requestId);
+    handleFinishedRequest(request, &completed);
+    RequestTracer::setCurrentRequestId(0);
+    const qint64 handleEndTime = monotonicNsecs();
+    request->processingTime += handleEndTime - handleStartTime;
+    RequestTracer::instance()->addSpan(requestId, "queue", QStringLiteral("handleFinishedRequest"),
+                                       handleStartTime, handleEndTime);
+    if (completed) {
+        m_directRequests.remove(requestId);
+        recordCompletedRequest(request);
+        delete request;
+    } else {
+        // waiting for another asynchronous step to complete.
+        request->status = Daemon::ApiImpl::RequestQueue::RequestInProgress;
+        request->pluginExecutionStartTime = handleEndTime;
+    }
+}
+
+void Daemon::ApiImpl::RequestQueue::markRequestFinished(
+        Daemon::ApiImpl::RequestQueue::RequestData *request,
+        const QList<QVariant> &outParams)
+{
+    request->status = Daemon::ApiImpl::RequestQueue::RequestFinished;
+    request->outParams = outParams;
+    if (request->pluginExecutionStartTime) {
+        const qint64 finishedTime = monotonicNsecs();
+        request->pluginExecutionTime += finishedTime - request->pluginExecutionStartTime;
+        RequestTracer::instance()->addSpan(request->requestId, "queue", QStringLiteral("asynchronous"),
+                                           request->pluginExecutionStartTime, finishedTime);
+        request->pluginExecutionStartTime = 0;
+    }
+}
+
 void Daemon::ApiImpl::RequestQueue::requestFinished(quint64 requestId, const QList<QVariant> &outParams)
 {
+    Daemon::ApiImpl::RequestQueue::RequestData *directRequest = m_directRequests.value(requestId);
+    if (directRequest) {
+        // direct requests are finished without a pass over the queue,
+        // once the caller of requestFinished() has returned.
+        markRequestFinished(directRequest, outParams);
+        QMetaObject::invokeMethod(this, "finishDirectRequest",
+                                  Qt::QueuedConnection,
+                                  Q_ARG(quint64, requestId));
+        return;
+    }
+
     QList<Daemon::ApiImpl::RequestQueue::RequestData*>::iterator it = m_requests.begin();
     while (it != m_requests.end()) {
         if ((*it)->requestId == requestId) {
-            (*it)->status = Daemon::ApiImpl::RequestQueue::RequestFinished;
-            (*it)->outParams = outParams;
+            markRequestFinished(*it, outParams);
             QMetaObject::invokeMethod(this, "handleRequests", Qt::QueuedConnection);
             return;
         }
@@ -227,6 +388,19 @@ void Daemon::ApiImpl::RequestQueue::requestFinished(quint64 requestId, const QLi
     qCWarning(lcSailfishSecretsDaemon) << "Unable to finish unknown request:" << requestId;
 }
 
+// Returns the name of the peer connection from which the request was
+// received, or an empty string if the request is unknown.
+QString Daemon::ApiImpl::RequestQueue::requestConnectionName(quint64 requestId) const
+{
+    for (const Daemon::ApiImpl::RequestQueue::RequestData *request : m_requests) {
+        if (request->requestId == requestId) {
+            return request->connection.name();
+        }
+    }
+
+    return QString();
+}
+
 void Daemon::ApiImpl::RequestQueue::handleRequests()
 {
     qCDebug(lcSailfishSecretsDaemon) << "have:" << m_requests.size() << "in queue.";
@@ -242,17 +416,39 @@ void Daemon::ApiImpl::RequestQueue::handleRequests()
             // Track the peer connection (if we haven't already), and then handle the request.
             //trackPeerConnection(request); // TODO: is this needed?
             request->status = RequestInProgress;
+            const qint64 handleStartTime = monotonicNsecs();
+            request->queueWaitTime = handleStartTime - request->enqueuedTime;
+            RequestTracer::setCurrentRequestId(request->requestId);
             handlePendingRequest(request, &completed);
+            RequestTracer::setCurrentRequestId(0);
+            const qint64 handleEndTime = monotonicNsecs();
+            request->processingTime += handleEndTime - handleStartTime;
+            RequestTracer::instance()->addSpan(request->requestId, "queue", QStringLiteral("queued"),
+                                               request->enqueuedTime, handleStartTime);
+            RequestTracer::instance()->addSpan(request->requestId, "queue", QStringLiteral("handlePendingRequest"),
+                                               handleStartTime, handleEndTime);
             if (completed) {
+                recordCompletedRequest(request);
                 it = m_requests.erase(it);
                 delete request;
             } else {
+                // the request is now waiting for an asynchronous
+                // plugin operation or user interaction to complete.
+                request->pluginExecutionStartTime = handleEndTime;
                 it++;
             }
         } else if (request->status == RequestFinished) {
             // This (asynchronous) request is in Finished state.  We need to send the response.
+            const qint64 handleStartTime = monotonicNsecs();
+            RequestTracer::setCurrentRequestId(request->requestId);
             handleFinishedRequest(request, &completed);
+            RequestTracer::setCurrentRequestId(0);
+            const qint64 handleEndTime = monotonicNsecs();
+            request->processingTime += handleEndTime - handleStartTime;
+            RequestTracer::instance()->addSpan(request->requestId, "queue", QStringLiteral("handleFinishedRequest"),
+                                               handleStartTime, handleEndTime);
             if (completed) {
+                recordCompletedRequest(request);
                 it = m_requests.erase(it);
                 delete request;
             } else {
@@ -283,3 +479,32 @@ void Daemon::ApiImpl::RequestQueue::handleRequests()
                                      << msecs << "milliseconds,"
                                      << (nsecs%1000000) << "nanoseconds of processing.";
 }
+
+void Daemon::ApiImpl::RequestQueue::recordCompletedRequest(
+        const Daemon::ApiImpl::RequestQueue::RequestData *request)
+{
+    const qint64 completedTime = monotonicNsecs();
+    const qint64 totalTime = completedTime - request->enqueuedTime;
+    RequestTracer::instance()->addSpan(request->requestId, "request", QStringLiteral("total"),
+                                       request->enqueuedTime, completedTime);
+    RequestTracer::instance()->endRequest(request->requestId);
+    m_statistics.requestCompleted(request->type,
+                                  request->queueWaitTime,
+                                  request->processingTime,
+                                  request->pluginExecutionTime,
+                                  totalTime);
+    qCDebug(lcSailfishSecretsDaemon) << "Completed" << requestTypeToString(request->type)
+                                     << "request with id:" << request->requestId
+                                     << "trace id:" << QString::number(request->traceId, 16)
+                                     << "in" << (totalTime / 1000) << "usecs"
+                                     << "(queue wait:" << (request->queueWaitTime / 1000)
+                                     << "processing:" << (request->processingTime / 1000)
+                                     << "plugin execution:" << (request->pluginExecutionTime / 1000) << ")";
+}
+
+QJsonObject Daemon::ApiImpl::RequestQueue::requestStatistics() const
+{
+    return m_statistics.toJson([this] (int type) {
+        return requestTypeToString(type);
+    });
+}
@@ -13,8 +13,11 @@
 
 #include <QtCore/QObject>
 #include <QtCore/QString>
+#include <QtCore/QJsonObject>
 
 #include "controller_p.h"
+#include "requeststatistics_p.h"
+#include "requesttracer_p.h"
 
 #include "Secrets/result.h"
 #include "Crypto/result.h"
@@ -52,7 +55,13 @@ public:
             , status(RequestPending)
             , connection(QString::fromUtf8("org.sailfishos.secrets.daemon.invalidConnection"))
             , cryptoRequestId(0)
-            , isSecretsCryptoRequest(false) {}
+            , isSecretsCryptoRequest(false)
+            , traceId(0)
+            , enqueuedTime(0)
+            , queueWaitTime(0)
+            , processingTime(0)
+            , pluginExecutionStartTime(0)
+            , pluginExecutionTime(0) {}
         quint64 requestId;
         pid_t remotePid;
         int type;
@@ -66,6 +75,16 @@ public:
         // which is being performed as part of a Sailfish::Crypto request.
         quint64 cryptoRequestId;
         bool isSecretsCryptoRequest;
+
+        // Correlates all of the work done for a single client request.
+        quint64 traceId;
+
+        // Timing information used for request statistics, in nanoseconds.
+        qint64 enqueuedTime;
+        qint64 queueWaitTime;
+        qint64 processingTime;
+        qint64 pluginExecutionStartTime;
+        qint64 pluginExecutionTime;
     };
 
 public:
@@ -82,6 +101,7 @@ public:
                        const QVariantList &inParams,
                        const QDBusConnection &connection,
                        const QDBusMessage &message,
+                       quint64 traceId,
                        Sailfish::Secrets::Result &result);
     void handleRequest(pid_t callerPid,
                        quint64 cryptoRequestId,
@@ -92,21 +112,39 @@ public:
                        const QVariantList &inParams,
                        const QDBusConnection &connection,
                        const QDBusMessage &message,
+                       quint64 traceId,
                        Sailfish::Crypto::Result &result);
+    void handleDirectRequest(pid_t callerPid,
+                             quint64 cryptoRequestId,
+                             int requestType,
+                             const QVariantList &inParams,
+                             Sailfish::Secrets::Result &result,
+                             bool *completed);
 
     Sailfish::Secrets::Result enqueueRequest(Sailfish::Secrets::Daemon::ApiImpl::RequestQueue::RequestData *request);
     void requestFinished(quint64 requestId, const QList<QVariant> &outParams);
+    QString requestConnectionName(quint64 requestId) const;
 
     virtual void handlePendingRequest(Sailfish::Secrets::Daemon::ApiImpl::RequestQueue::RequestData *request, bool *completed) = 0;
     virtual void handleFinishedRequest(Sailfish::Secrets::Daemon::ApiImpl::RequestQueue::RequestData *request, bool *completed) = 0;
     virtual QString requestTypeToString(int type) const = 0;
 
+    QJsonObject requestStatistics() const;
+    bool hasRequests() const { return !m_requests.isEmpty() || !m_enqueuingRequests.isEmpty() || !m_directRequests.isEmpty(); }
+    quint64 enqueuedRequestCount() const { return m_enqueuedRequestCount; }
+
 public Q_SLOTS:
     void handleRequests();
     void handleClientConnection(const QDBusConnection &connection);
 
 private Q_SLOTS:
     void finishEnqueueRequest(quint64 requestId);
+    void finishDirectRequest(quint64 requestId);
+
+private:
+    bool nextFreeRequestId(quint64 *requestId);
+    void markRequestFinished(Sailfish::Secrets::Daemon::ApiImpl::RequestQueue::RequestData *request, const QList<QVariant> &outParams);
+    void recordCompletedRequest(const Sailfish::Secrets::Daemon::ApiImpl::RequestQueue::RequestData *request);
 
 protected:
     Controller *m_controller;
@@ -115,6 +153,9 @@ protected:
     QString m_dbusInterfaceName;
     QList<RequestData*> m_requests;
     QMap<quint64, RequestData*> m_enqueuingRequests;
+    QHash<quint64, RequestData*> m_directRequests; // requests handled outside of the queue, awaiting completion.
+    RequestStatistics m_statistics;
+    quint64 m_enqueuedRequestCount;
 
     bool m_autotestMode;
 };
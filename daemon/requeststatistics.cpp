@@ -0,0 +1,230 @@
+/*
+ * Copyright (C) 2018 Jolla Ltd.
+ * Contact: Chris Adams <chris.adams@jollamobile.com>
+ * All rights reserved.
+ * BSD 3-Clause License, see LICENSE.
+ */
+
+#include "requeststatistics_p.h"
+
+#include <QtCore/QJsonArray>
+#include <QtCore/qalgorithms.h>
+
+#include <time.h>
+
+using namespace Sailfish::Secrets;
+
+qint64 Daemon::ApiImpl::monotonicNsecs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return qint64(ts.tv_sec) * Q_INT64_C(1000000000) + qint64(ts.tv_nsec);
+}
+
+Daemon::ApiImpl::LatencyHistogram::LatencyHistogram()
+{
+}
+
+int Daemon::ApiImpl::LatencyHistogram::bucketIndex(quint64 usecs)
+{
+    if (usecs < SubBucketCount) {
+        return int(usecs);
+    }
+
+    const int msb = 63 - int(qCountLeadingZeroBits(usecs));
+    const int shift = msb - SubBucketBits;
+    const int index = (shift + 1) * SubBucketCount
+                    + int((usecs >> shift) & (SubBucketCount - 1));
+    return qMin(index, int(BucketCount) - 1);
+}
+
+quint64 Daemon::ApiImpl::LatencyHistogram::bucketUpperBound(int index)
+{
+    if (index < SubBucketCount) {
+        return quint64(index);
+    }
+
+    const int shift = (index / SubBucketCount) - 1;
+    const quint64 lower = quint64(SubBucketCount + (index % SubBucketCount)) << shift;
+    return lower + (Q_UINT64_C(1) << shift) - 1;
+}
+
+void Daemon::ApiImpl::LatencyHistogram::record(qint64 usecs)
+{
+    const quint64 value = usecs > 0 ? quint64(usecs) : 0;
+    m_buckets[bucketIndex(value)].fetchAndAddRelaxed(1);
+    m_count.fetchAndAddRelaxed(1);
+    m_sum.fetchAndAddRelaxed(value);
+
+    quint64 currentMax = m_max.loadAcquire();
+    while (value > currentMax && !m_max.testAndSetOrdered(currentMax, value, currentMax)) {
+        // another thread updated the maximum, currentMax now holds the new value.
+    }
+}
+
+quint64 Daemon::ApiImpl::LatencyHistogram::count() const
+{
+    return m_count.loadAcquire();
+}
+
+quint64 Daemon::ApiImpl::LatencyHistogram::sum() const
+{
+    return m_sum.loadAcquire();
+}
+
+quint64 Daemon::ApiImpl::LatencyHistogram::max() const
+{
+    return m_max.loadAcquire();
+}
+
+quint64 Daemon::ApiImpl::LatencyHistogram::percentile(double fraction) const
+{
+    // Recording is not atomic across all members, so derive the total
+    // from the buckets themselves to get a self-consistent snapshot.
+    quint32 snapshot[BucketCount];
+    quint64 total = 0;
+    for (int i = 0; i < BucketCount; ++i) {
+        snapshot[i] = m_buckets[i].loadAcquire();
+        total += snapshot[i];
+    }
+
+    if (total == 0) {
+        return 0;
+    }
+
+    quint64 threshold = quint64(fraction * double(total) + 0.5);
+    if (threshold == 0) {
+        threshold = 1;
+    }
+
+    quint64 cumulative = 0;
+    for (int i = 0; i < BucketCount; ++i) {
+        cumulative += snapshot[i];
+        if (cumulative >= threshold) {
+            return qMin(bucketUpperBound(i), max());
+        }
+    }
+
+    return max();
+}
+
+QJsonObject Daemon::ApiImpl::LatencyHistogram::toJson() const
+{
+    const quint64 c = count();
+    QJsonObject retn;
+    retn.insert(QStringLiteral("count"), double(c));
+    retn.insert(QStringLiteral("sumUsecs"), double(sum()));
+    retn.insert(QStringLiteral("meanUsecs"), c ? double(sum()) / double(c) : 0.0);
+    retn.insert(QStringLiteral("maxUsecs"), double(max()));
+    retn.insert(QStringLiteral("p50Usecs"), double(percentile(0.50)));
+    retn.insert(QStringLiteral("p90Usecs"), double(percentile(0.90)));
+    retn.insert(QStringLiteral("p99Usecs"), double(percentile(0.99)));
+
+    // Non-empty buckets as [upperBoundUsecs, count] pairs, so that
+    // histograms from multiple devices or runs can be merged offline.
+    QJsonArray buckets;
+    for (int i = 0; i < BucketCount; ++i) {
+        const quint32 bucketCount = m_buckets[i].loadAcquire();
+        if (bucketCount) {
+            buckets.append(QJsonArray() << double(bucketUpperBound(i)) << double(bucketCount));
+        }
+    }
+    retn.insert(QStringLiteral("buckets"), buckets);
+    return retn;
+}
+
+Daemon::ApiImpl::RequestStatistics::RequestStatistics()
+{
+}
+
+Daemon::ApiImpl::RequestStatistics::~RequestStatistics()
+{
+    for (int i = 0; i < MaximumRequestTypes; ++i) {
+        delete m_types[i].loadAcquire();
+    }
+}
+
+Daemon::ApiImpl::RequestStatistics::TypeStatistics *
+Daemon::ApiImpl::RequestStatistics::typeStatistics(int type)
+{
+    if (type < 0 || type >= MaximumRequestTypes) {
+        return Q_NULLPTR;
+    }
+
+    TypeStatistics *stats = m_types[type].loadAcquire();
+    if (!stats) {
+        TypeStatistics *newStats = new TypeStatistics;
+        if (m_types[type].testAndSetOrdered(Q_NULLPTR, newStats)) {
+            stats = newStats;
+        } else {
+            // lost the race with another thread.
+            delete newStats;
+            stats = m_types[type].loadAcquire();
+        }
+    }
+    return stats;
+}
+
+void Daemon::ApiImpl::RequestStatistics::requestEnqueued(int type)
+{
+    if (TypeStatistics *stats = typeStatistics(type)) {
+        stats->enqueued.fetchAndAddRelaxed(1);
+    }
+}
+
+void Daemon::ApiImpl::RequestStatistics::requestRejected(int type)
+{
+    if (TypeStatistics *stats = typeStatistics(type)) {
+        stats->rejected.fetchAndAddRelaxed(1);
+    }
+}
+
+void Daemon::ApiImpl::RequestStatistics::requestCompleted(
+        int type,
+        qint64 queueWaitNsecs,
+        qint64 processingNsecs,
+        qint64 pluginExecutionNsecs,
+        qint64 totalNsecs)
+{
+    if (TypeStatistics *stats = typeStatistics(type)) {
+        stats->completed.fetchAndAddRelaxed(1);
+        stats->phases[QueueWaitPhase].record(queueWaitNsecs / 1000);
+        stats->phases[ProcessingPhase].record(processingNsecs / 1000);
+        stats->phases[PluginExecutionPhase].record(pluginExecutionNsecs / 1000);
+        stats->phases[TotalPhase].record(totalNsecs / 1000);
+    }
+}
+
+QString Daemon::ApiImpl::RequestStatistics::phaseToString(Phase phase)
+{
+    switch (phase) {
+        case QueueWaitPhase:        return QStringLiteral("queueWait");
+        case ProcessingPhase:       return QStringLiteral("processing");
+        case PluginExecutionPhase:  return QStringLiteral("pluginExecution");
+        case TotalPhase:            return QStringLiteral("total");
+        default:                    return QStringLiteral("unknown");
+    }
+}
+
+QJsonObject Daemon::ApiImpl::RequestStatistics::toJson(
+        const std::function<QString(int)> &typeName) const
+{
+    QJsonObject retn;
+    for (int i = 0; i < MaximumRequestTypes; ++i) {
+        const TypeStatistics *stats = m_types[i].loadAcquire();
+        if (!stats) {
+            continue;
+        }
+
+        QJsonObject typeObject;
+        typeObject.insert(QStringLiteral("enqueued"), double(stats->enqueued.loadAcquire()));
+        typeObject.insert(QStringLiteral("rejected"), double(stats->rejected.loadAcquire()));
+        typeObject.insert(QStringLiteral("completed"), double(stats->completed.loadAcquire()));
+        for (int phase = 0; phase < PhaseCount; ++phase) {
+            typeObject.insert(phaseToString(static_cast<Phase>(phase)),
+                              stats->phases[phase].toJson());
+        }
+        retn.insert(typeName(i), typeObject);
+    }
+    return retn;
+}
@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2018 Jolla Ltd.
+ * Contact: Chris Adams <chris.adams@jollamobile.com>
+ * All rights reserved.
+ * BSD 3-Clause License, see LICENSE.
+ */
+
+#ifndef SAILFISHSECRETS_DAEMON_REQUESTSTATISTICS_P_H
+#define SAILFISHSECRETS_DAEMON_REQUESTSTATISTICS_P_H
+
+#include <QtCore/QAtomicInteger>
+#include <QtCore/QAtomicPointer>
+#include <QtCore/QJsonObject>
+#include <QtCore/QString>
+
+#include <functional>
+
+namespace Sailfish {
+
+namespace Secrets {
+
+namespace Daemon {
+
+namespace ApiImpl {
+
+// Returns the current value of the monotonic clock, in nanoseconds.
+qint64 monotonicNsecs();
+
+// A fixed-size log-linear latency histogram (in microseconds).
+// Each power-of-two range is split into SubBucketCount linear buckets,
+// so the relative error of any reported percentile is bounded by
+// 1 / SubBucketCount, independent of the magnitude of the value.
+// All operations are lock-free, so values may be recorded from any thread.
+class LatencyHistogram
+{
+public:
+    enum {
+        SubBucketBits = 2,
+        SubBucketCount = 1 << SubBucketBits,
+        MagnitudeCount = 32,
+        BucketCount = (MagnitudeCount - SubBucketBits + 1) * SubBucketCount
+    };
+
+    LatencyHistogram();
+
+    void record(qint64 usecs);
+
+    quint64 count() const;
+    quint64 sum() const;
+    quint64 max() const;
+    quint64 percentile(double fraction) const;
+
+    QJsonObject toJson() const;
+
+    static int bucketIndex(quint64 usecs);
+    static quint64 bucketUpperBound(int index);
+
+private:
+    Q_DISABLE_COPY(LatencyHistogram)
+    QAtomicInteger<quint32> m_buckets[BucketCount];
+    QAtomicInteger<quint64> m_count;
+    QAtomicInteger<quint64> m_sum;
+    QAtomicInteger<quint64> m_max;
+};
+
+// Counters and per-phase latency histograms for each type of request
+// handled by a RequestQueue.  Storage for a particular request type
+// is allocated the first time a request of that type is seen.
+class RequestStatistics
+{
+public:
+    enum Phase {
+        QueueWaitPhase = 0,     // enqueued -> first handled by the queue
+        ProcessingPhase,        // time spent in handlePendingRequest() / handleFinishedRequest()
+        PluginExecutionPhase,   // asynchronous plugin call or user interaction
+        TotalPhase,             // enqueued -> reply sent
+        PhaseCount
+    };
+
+    enum { MaximumRequestTypes = 64 };
+
+    RequestStatistics();
+    ~RequestStatistics();
+
+    void requestEnqueued(int type);
+    void requestRejected(int type);
+    void requestCompleted(int type,
+                          qint64 queueWaitNsecs,
+                          qint64 processingNsecs,
+                          qint64 pluginExecutionNsecs,
+                          qint64 totalNsecs);
+
+    QJsonObject toJson(const std::function<QString(int)> &typeName) const;
+
+    static QString phaseToString(Phase phase);
+
+private:
+    Q_DISABLE_COPY(RequestStatistics)
+
+    struct TypeStatistics {
+        QAtomicInteger<quint64> enqueued;
+        QAtomicInteger<quint64> rejected;
+        QAtomicInteger<quint64> completed;
+        LatencyHistogram phases[PhaseCount];
+    };
+
+    TypeStatistics *typeStatistics(int type);
+    QAtomicPointer<TypeStatistics> m_types[MaximumRequestTypes];
+};
+
+} // ApiImpl
+
+} // Daemon
+
+} // Secrets
+
+} // Sailfish
+
+#endif // SAILFISHSECRETS_DAEMON_REQUESTSTATISTICS_P_H
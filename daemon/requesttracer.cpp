@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) 2018 Jolla Ltd.
+ * Contact: Chris Adams <chris.adams@jollamobile.com>
+ * All rights reserved.
+ * BSD 3-Clause License, see LICENSE.
+ */
+
+#include "requesttracer_p.h"
+
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QMutexLocker>
+
+#include <sys/syscall.h>
+#include <unistd.h>
+
+using namespace Sailfish::Secrets;
+
+namespace {
+    thread_local quint64 tracedRequestId = 0;
+
+    qint64 currentThreadId()
+    {
+        return qint64(syscall(SYS_gettid));
+    }
+}
+
+Daemon::ApiImpl::RequestTracer *Daemon::ApiImpl::RequestTracer::instance()
+{
+    static RequestTracer tracer;
+    return &tracer;
+}
+
+Daemon::ApiImpl::RequestTracer::RequestTracer()
+    : m_capacity(DefaultCapacity)
+    , m_nextSpan(0)
+    , m_wrapped(false)
+    , m_traceIdCounter(0)
+{
+    const QByteArray bufferSize = qgetenv(ENV_TRACE_BUFFER_SIZE);
+    if (!bufferSize.isEmpty()) {
+        bool ok = false;
+        const int capacity = bufferSize.toInt(&ok);
+        if (ok && capacity >= 0) {
+            m_capacity = capacity;
+        }
+    }
+    m_spans.resize(m_capacity);
+}
+
+quint64 Daemon::ApiImpl::RequestTracer::generateTraceId()
+{
+    // Daemon-generated trace ids have the top bit set, to distinguish
+    // them from client-generated trace ids.
+    return Q_UINT64_C(0x8000000000000000) | (m_traceIdCounter.fetchAndAddRelaxed(1) + 1);
+}
+
+void Daemon::ApiImpl::RequestTracer::beginRequest(quint64 requestId, quint64 traceId, const QString &requestName)
+{
+    if (!isEnabled()) {
+        return;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    TracedRequest request;
+    request.traceId = traceId;
+    request.name = requestName;
+    m_requests.insert(requestId, request);
+}
+
+void Daemon::ApiImpl::RequestTracer::endRequest(quint64 requestId)
+{
+    if (!isEnabled()) {
+        return;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    m_requests.remove(requestId);
+}
+
+quint64 Daemon::ApiImpl::RequestTracer::traceId(quint64 requestId) const
+{
+    if (!isEnabled()) {
+        return 0;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    return m_requests.value(requestId).traceId;
+}
+
+void Daemon::ApiImpl::RequestTracer::addSpan(
+        quint64 requestId,
+        const char *category,
+        const QString &name,
+        qint64 startNsecs,
+        qint64 endNsecs)
+{
+    if (!isEnabled()) {
+        return;
+    }
+
+    const qint64 threadId = currentThreadId();
+    QMutexLocker locker(&m_mutex);
+    const TracedRequest request = m_requests.value(requestId);
+    Span &span(m_spans[m_nextSpan]);
+    span.traceId = request.traceId;
+    span.requestId = requestId;
+    span.category = category;
+    span.name = request.name.isEmpty() ? name : request.name + QLatin1Char(':') + name;
+    span.startNsecs = startNsecs;
+    span.durationNsecs = endNsecs - startNsecs;
+    span.threadId = threadId;
+    if (++m_nextSpan == m_capacity) {
+        m_nextSpan = 0;
+        m_wrapped = true;
+    }
+}
+
+quint64 Daemon::ApiImpl::RequestTracer::currentRequestId()
+{
+    return tracedRequestId;
+}
+
+void Daemon::ApiImpl::RequestTracer::setCurrentRequestId(quint64 requestId)
+{
+    tracedRequestId = requestId;
+}
+
+QByteArray Daemon::ApiImpl::RequestTracer::toChromeTraceJson() const
+{
+    const qint64 pid = qint64(getpid());
+    QJsonArray events;
+
+    QMutexLocker locker(&m_mutex);
+    const int count = m_wrapped ? m_capacity : m_nextSpan;
+    const int first = m_wrapped ? m_nextSpan : 0;
+    for (int i = 0; i < count; ++i) {
+        const Span &span(m_spans[(first + i) % m_capacity]);
+        QJsonObject args;
+        args.insert(QStringLiteral("traceId"), QString::number(span.traceId, 16));
+        args.insert(QStringLiteral("requestId"), double(span.requestId));
+
+        QJsonObject event;
+        event.insert(QStringLiteral("name"), span.name);
+        event.insert(QStringLiteral("cat"), QString::fromLatin1(span.category));
+        event.insert(QStringLiteral("ph"), QStringLiteral("X"));
+        event.insert(QStringLiteral("ts"), double(span.startNsecs) / 1000.0);
+        event.insert(QStringLiteral("dur"), double(span.durationNsecs) / 1000.0);
+        event.insert(QStringLiteral("pid"), double(pid));
+        event.insert(QStringLiteral("tid"), double(span.threadId));
+        event.insert(QStringLiteral("args"), args);
+        events.append(event);
+    }
+    locker.unlock();
+
+    QJsonObject trace;
+    trace.insert(QStringLiteral("traceEvents"), events);
+    trace.insert(QStringLiteral("displayTimeUnit"), QStringLiteral("ms"));
+    return QJsonDocument(trace).toJson(QJsonDocument::Compact);
+}
@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2018 Jolla Ltd.
+ * Contact: Chris Adams <chris.adams@jollamobile.com>
+ * All rights reserved.
+ * BSD 3-Clause License, see LICENSE.
+ */
+
+#ifndef SAILFISHSECRETS_DAEMON_REQUESTTRACER_P_H
+#define SAILFISHSECRETS_DAEMON_REQUESTTRACER_P_H
+
+#include <QtCore/QAtomicInteger>
+#include <QtCore/QByteArray>
+#include <QtCore/QFuture>
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QString>
+#include <QtCore/QThreadPool>
+#include <QtCore/QVector>
+
+#include <QtConcurrent>
+
+#include "requeststatistics_p.h"
+
+#define ENV_TRACE_BUFFER_SIZE "SAILFISH_SECRETSD_TRACE_BUFFER_SIZE"
+
+namespace Sailfish {
+
+namespace Secrets {
+
+namespace Daemon {
+
+namespace ApiImpl {
+
+// Records timestamped spans for the various stages of request handling
+// (queueing, processing, plugin calls, user interaction) into a fixed-size
+// ring buffer.  Each span is tagged with the trace id of the request it
+// belongs to.  The trace id is provided by the client (or generated by the
+// daemon if the client did not provide one) and is shared by any internal
+// Secrets requests performed on behalf of a Crypto request, so that the
+// whole lifecycle of a client request can be reconstructed.
+// The buffer can be dumped in the Chrome trace-event JSON format.
+// Tracing is disabled unless a buffer size is set in the environment,
+// in which case every span is recorded under a mutex.
+class RequestTracer
+{
+public:
+    enum { DefaultCapacity = 0 };
+
+    static RequestTracer *instance();
+
+    bool isEnabled() const { return m_capacity > 0; }
+
+    quint64 generateTraceId();
+
+    // Associate the given daemon request id with the given trace id.
+    void beginRequest(quint64 requestId, quint64 traceId, const QString &requestName);
+    void endRequest(quint64 requestId);
+    quint64 traceId(quint64 requestId) const;
+
+    void addSpan(quint64 requestId,
+                 const char *category,
+                 const QString &name,
+                 qint64 startNsecs,
+                 qint64 endNsecs);
+
+    // The request id whose work is being performed by the current thread.
+    static quint64 currentRequestId();
+    static void setCurrentRequestId(quint64 requestId);
+
+    QByteArray toChromeTraceJson() const;
+
+private:
+    RequestTracer();
+    Q_DISABLE_COPY(RequestTracer)
+
+    struct Span {
+        Span() : traceId(0), requestId(0), category(Q_NULLPTR), startNsecs(0), durationNsecs(0), threadId(0) {}
+        quint64 traceId;
+        quint64 requestId;
+        const char *category;
+        QString name;
+        qint64 startNsecs;
+        qint64 durationNsecs;
+        qint64 threadId;
+    };
+
+    struct TracedRequest {
+        quint64 traceId;
+        QString name;
+    };
+
+    mutable QMutex m_mutex;
+    QHash<quint64, TracedRequest> m_requests;
+    QVector<Span> m_spans;
+    int m_capacity;
+    int m_nextSpan;
+    bool m_wrapped;
+    QAtomicInteger<quint64> m_traceIdCounter;
+};
+
+// Runs the given plugin function wrapper in the given thread pool,
+// via QtConcurrent, recording a span for its execution as part of
+// the trace of the request with the given id.
+// The call is always wrapped in a functor, as QtConcurrent::run()
+// accepts at most five arguments for a plain function.
+template <typename Function, typename... Args>
+auto tracedRun(quint64 requestId, QThreadPool *pool, Function function, Args... args)
+    -> QFuture<decltype(function(args...))>
+{
+    typedef decltype(function(args...)) ResultType;
+    if (!RequestTracer::instance()->isEnabled()) {
+        return QtConcurrent::run(pool, [=] () mutable -> ResultType {
+            return function(args...);
+        });
+    }
+
+    const qint64 scheduledTime = monotonicNsecs();
+    return QtConcurrent::run(pool, [=] () mutable -> ResultType {
+        RequestTracer *tracer = RequestTracer::instance();
+        const qint64 startTime = monotonicNsecs();
+        tracer->addSpan(requestId, "threadpool", QStringLiteral("scheduled"), scheduledTime, startTime);
+        RequestTracer::setCurrentRequestId(requestId);
+        ResultType result = function(args...);
+        RequestTracer::setCurrentRequestId(0);
+        tracer->addSpan(requestId, "plugin", QStringLiteral("pluginCall"), startTime, monotonicNsecs());
+        return result;
+    });
+}
+
+} // ApiImpl
+
+} // Daemon
+
+} // Secrets
+
+} // Sailfish
+
+#endif // SAILFISHSECRETS_DAEMON_REQUESTTRACER_P_H
@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2018 Jolla Ltd.
+ * Contact: Chris Adams <chris.adams@jollamobile.com>
+ * All rights reserved.
+ * BSD 3-Clause License, see LICENSE.
+ */
+
+#include "startupprofiler_p.h"
+#include "requeststatistics_p.h"
+#include "logging_p.h"
+
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QMutexLocker>
+
+using namespace Sailfish::Secrets;
+
+QAtomicInt Daemon::ApiImpl::StartupProfiler::s_recording(1);
+
+Daemon::ApiImpl::StartupProfiler *Daemon::ApiImpl::StartupProfiler::instance()
+{
+    static StartupProfiler profiler;
+    return &profiler;
+}
+
+Daemon::ApiImpl::StartupProfiler::StartupProfiler()
+    : m_startTime(0)
+    , m_readyTime(0)
+    , m_firstRequestTime(0)
+{
+}
+
+void Daemon::ApiImpl::StartupProfiler::markStart()
+{
+    QMutexLocker locker(&m_mutex);
+    m_startTime = monotonicNsecs();
+}
+
+void Daemon::ApiImpl::StartupProfiler::markReady()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_readyTime) {
+            return;
+        }
+        m_readyTime = monotonicNsecs();
+    }
+
+    qCDebug(lcSailfishSecretsDaemon) << "Startup profile:"
+                                     << QJsonDocument(toJson()).toJson(QJsonDocument::Compact).constData();
+}
+
+void Daemon::ApiImpl::StartupProfiler::markFirstRequest()
+{
+    if (!s_recording.testAndSetOrdered(1, 0)) {
+        return;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    m_firstRequestTime = monotonicNsecs();
+    qCDebug(lcSailfishSecretsDaemon) << "First request accepted"
+                                     << (m_firstRequestTime - m_startTime) / 1000000 << "ms after startup";
+}
+
+void Daemon::ApiImpl::StartupProfiler::addPhase(
+        const char *phase,
+        const QString &detail,
+        qint64 startTime,
+        qint64 endTime)
+{
+    if (!isRecording()) {
+        return;
+    }
+
+    Phase p;
+    p.name = phase;
+    p.detail = detail;
+    p.startTime = startTime;
+    p.endTime = endTime;
+
+    QMutexLocker locker(&m_mutex);
+    m_phases.append(p);
+}
+
+QJsonObject Daemon::ApiImpl::StartupProfiler::toJson() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    QJsonArray phases;
+    for (const Phase &p : m_phases) {
+        QJsonObject phase;
+        phase.insert(QStringLiteral("phase"), QLatin1String(p.name));
+        if (!p.detail.isEmpty()) {
+            phase.insert(QStringLiteral("detail"), p.detail);
+        }
+        phase.insert(QStringLiteral("startNsecs"), double(p.startTime - m_startTime));
+        phase.insert(QStringLiteral("durationNsecs"), double(p.endTime - p.startTime));
+        phases.append(phase);
+    }
+
+    QJsonObject profile;
+    profile.insert(QStringLiteral("clock"), QStringLiteral("monotonic"));
+    profile.insert(QStringLiteral("readyNsecs"), m_readyTime ? double(m_readyTime - m_startTime) : -1.0);
+    profile.insert(QStringLiteral("firstRequestNsecs"), m_firstRequestTime ? double(m_firstRequestTime - m_startTime) : -1.0);
+    profile.insert(QStringLiteral("phases"), phases);
+    return profile;
+}
+
+Daemon::ApiImpl::StartupPhase::StartupPhase(const char *phase, const QString &detail)
+    : m_phase(phase)
+    , m_detail(detail)
+    , m_startTime(StartupProfiler::isRecording() ? monotonicNsecs() : 0)
+{
+}
+
+Daemon::ApiImpl::StartupPhase::~StartupPhase()
+{
+    finish();
+}
+
+void Daemon::ApiImpl::StartupPhase::finish()
+{
+    if (m_startTime) {
+        const qint64 endTime = monotonicNsecs();
+        StartupProfiler::instance()->addPhase(m_phase, m_detail, m_startTime, endTime);
+        qCDebug(lcSailfishSecretsDaemon) << "Startup phase" << m_phase << m_detail
+                                         << "took" << (endTime - m_startTime) / 1000 << "us";
+        m_startTime = 0;
+    }
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2018 Jolla Ltd.
+ * Contact: Chris Adams <chris.adams@jollamobile.com>
+ * All rights reserved.
+ * BSD 3-Clause License, see LICENSE.
+ */
+
+#ifndef SAILFISHSECRETS_DAEMON_STARTUPPROFILER_P_H
+#define SAILFISHSECRETS_DAEMON_STARTUPPROFILER_P_H
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QJsonObject>
+#include <QtCore/QMutex>
+#include <QtCore/QString>
+#include <QtCore/QVector>
+
+namespace Sailfish {
+
+namespace Secrets {
+
+namespace Daemon {
+
+namespace ApiImpl {
+
+// Records the phases of daemon startup against the monotonic clock, from
+// the entry to main() until the first client request has been accepted.
+// Phases may nest (e.g. the metadata database opens happen during the
+// Controller construction) and may repeat (once per plugin or database),
+// so each is recorded as a separate span with an optional detail string.
+// Once the first request has been accepted, recording stops and further
+// phases cost only a single atomic load.
+class StartupProfiler
+{
+public:
+    static StartupProfiler *instance();
+
+    static bool isRecording() { return s_recording.load() != 0; }
+
+    void markStart();
+    void markReady();
+    void markFirstRequest();
+    void addPhase(const char *phase, const QString &detail, qint64 startTime, qint64 endTime);
+
+    // All times in the JSON document are nanoseconds relative to main().
+    QJsonObject toJson() const;
+
+private:
+    StartupProfiler();
+    Q_DISABLE_COPY(StartupProfiler)
+
+    struct Phase {
+        const char *name;
+        QString detail;
+        qint64 startTime;
+        qint64 endTime;
+    };
+
+    static QAtomicInt s_recording;
+    mutable QMutex m_mutex;
+    QVector<Phase> m_phases;
+    qint64 m_startTime;
+    qint64 m_readyTime;
+    qint64 m_firstRequestTime;
+};
+
+// Records a single startup phase, from construction until destruction.
+class StartupPhase
+{
+public:
+    explicit StartupPhase(const char *phase, const QString &detail = QString());
+    ~StartupPhase();
+
+    // Ends the phase before the end of the enclosing scope.
+    void finish();
+
+private:
+    Q_DISABLE_COPY(StartupPhase)
+    const char *m_phase;
+    QString m_detail;
+    qint64 m_startTime;
+};
+
+} // ApiImpl
+
+} // Daemon
+
+} // Secrets
+
+} // Sailfish
+
+#endif // SAILFISHSECRETS_DAEMON_STARTUPPROFILER_P_H
@@ -463,6 +463,20 @@ Database::Query Database::prepare(const QString &statement, QString *errorText)
     return Query(*it);
 }
 
+// Releases the cached prepared queries, which are otherwise kept for the
+// lifetime of the database connection.  Queries which are currently in
+// use remain valid, as each Query holds its own reference.
+void Database::clearPreparedQueries()
+{
+    if (withinTransaction()) {
+        // the access mutex isn't held by the transaction owner.
+        return;
+    }
+
+    QMutexLocker locker(accessMutex());
+    m_preparedQueries.clear();
+}
+
 bool Database::execute(QSqlQuery &query, QString *errorText)
 {
     static const bool debugSql = !qgetenv("SAILFISHSECRETSD_DEBUG_SQL").isEmpty();
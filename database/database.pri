@@ -2,5 +2,5 @@
 # used by both the daemon and various plugins
 INCLUDEPATH += $$PWD
 DEPENDPATH = $$INCLUDEPATH
-SOURCES += $$PWD/database.cpp $$PWD/util.cpp
-HEADERS += $$PWD/database_p.h $$PWD/util_p.h
+SOURCES += $$PWD/database.cpp $$PWD/util.cpp $$PWD/filterdataindex.cpp
+HEADERS += $$PWD/database_p.h $$PWD/util_p.h $$PWD/filterdataindex_p.h
@@ -112,6 +112,7 @@ public:
 
     Query prepare(const char *statement, QString *errorText) const;
     Query prepare(const QString &statement, QString *errorText) const;
+    void clearPreparedQueries();
 
     static bool execute(QSqlQuery &query, QString *errorText);
     static bool executeBatch(QSqlQuery &query, QString *errorText, QSqlQuery::BatchExecutionMode mode = QSqlQuery::ValuesAsRows);
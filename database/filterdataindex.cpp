@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2018 Jolla Ltd.
+ * Contact: Chris Adams <chris.adams@jollamobile.com>
+ * All rights reserved.
+ * BSD 3-Clause License, see LICENSE.
+ */
+
+#include "filterdataindex_p.h"
+
+#include "Secrets/Plugins/extensionplugins.h"
+
+#include <QtCore/QStringList>
+
+#include <QtSql/QSqlError>
+#include <QtSql/QSqlQuery>
+
+using namespace Sailfish::Secrets::Daemon::Sqlite;
+
+// The index is an external content table, so the values are not duplicated.
+// Its rowids are the FilterDataId values of the indexed rows; an explicit
+// INTEGER PRIMARY KEY is used because VACUUM may renumber implicit rowids.
+static const char *createSecretsFilterDataIndex =
+        "\n CREATE VIRTUAL TABLE IF NOT EXISTS SecretsFilterDataIndex USING fts5("
+        "   Value,"
+        "   content = 'SecretsFilterData',"
+        "   content_rowid = 'FilterDataId');";
+
+static const char *createSecretsFilterDataIndexInsertTrigger =
+        "\n CREATE TRIGGER IF NOT EXISTS SecretsFilterDataIndexInsert"
+        "   AFTER INSERT ON SecretsFilterData"
+        "   BEGIN"
+        "     INSERT INTO SecretsFilterDataIndex (rowid, Value)"
+        "       VALUES (new.FilterDataId, new.Value);"
+        "   END;";
+
+static const char *createSecretsFilterDataIndexDeleteTrigger =
+        "\n CREATE TRIGGER IF NOT EXISTS SecretsFilterDataIndexDelete"
+        "   AFTER DELETE ON SecretsFilterData"
+        "   BEGIN"
+        "     INSERT INTO SecretsFilterDataIndex (SecretsFilterDataIndex, rowid, Value)"
+        "       VALUES ('delete', old.FilterDataId, old.Value);"
+        "   END;";
+
+static const char *createSecretsFilterDataIndexUpdateTrigger =
+        "\n CREATE TRIGGER IF NOT EXISTS SecretsFilterDataIndexUpdate"
+        "   AFTER UPDATE ON SecretsFilterData"
+        "   BEGIN"
+        "     INSERT INTO SecretsFilterDataIndex (SecretsFilterDataIndex, rowid, Value)"
+        "       VALUES ('delete', old.FilterDataId, old.Value);"
+        "     INSERT INTO SecretsFilterDataIndex (rowid, Value)"
+        "       VALUES (new.FilterDataId, new.Value);"
+        "   END;";
+
+static const char *rebuildSecretsFilterDataIndex =
+        "\n INSERT INTO SecretsFilterDataIndex (SecretsFilterDataIndex) VALUES ('rebuild');";
+
+static const char *probeSecretsFilterDataIndex =
+        "\n SELECT rowid FROM SecretsFilterDataIndex LIMIT 0;";
+
+static const char *selectSecretsFilterDataIndexTrigger =
+        "\n SELECT COUNT(*) FROM sqlite_master"
+        "   WHERE type = 'trigger' AND name = 'SecretsFilterDataIndexInsert';";
+
+static const char *createIndexStatements[] =
+{
+    createSecretsFilterDataIndex,
+    probeSecretsFilterDataIndex,
+    createSecretsFilterDataIndexInsertTrigger,
+    createSecretsFilterDataIndexDeleteTrigger,
+    createSecretsFilterDataIndexUpdateTrigger,
+    NULL
+};
+
+static const char *dropIndexTriggerStatements[] =
+{
+    "\n DROP TRIGGER IF EXISTS SecretsFilterDataIndexInsert;",
+    "\n DROP TRIGGER IF EXISTS SecretsFilterDataIndexDelete;",
+    "\n DROP TRIGGER IF EXISTS SecretsFilterDataIndexUpdate;",
+    NULL
+};
+
+static const char *dropIndexTableStatements[] =
+{
+    "\n DROP TABLE IF EXISTS SecretsFilterDataIndex;",
+    NULL
+};
+
+static bool executeStatements(QSqlDatabase &database, const char *statements[])
+{
+    QSqlQuery query(database);
+    for (int i = 0; statements[i]; ++i) {
+        if (!query.exec(QLatin1String(statements[i]))) {
+            qCDebug(lcSailfishSecretsDaemonSqlite) << "Filter data index statement failed:"
+                                                   << query.lastError().text();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool FilterDataIndex::open(Database *db)
+{
+    DatabaseLocker locker(db);
+    QSqlDatabase &database(*db);
+
+    QSqlQuery triggerQuery(database);
+    if (!triggerQuery.exec(QLatin1String(selectSecretsFilterDataIndexTrigger))
+            || !triggerQuery.next()) {
+        return false;
+    }
+    const bool triggersExisted = triggerQuery.value(0).toInt() > 0;
+    triggerQuery.finish();
+
+    if (!db->beginTransaction()) {
+        return false;
+    }
+
+    const char *rebuildStatements[] = { rebuildSecretsFilterDataIndex, NULL };
+    if (executeStatements(database, createIndexStatements)
+            && (triggersExisted || executeStatements(database, rebuildStatements))) {
+        if (db->commitTransaction()) {
+            return true;
+        }
+    }
+    db->rollbackTransaction();
+
+    // FTS5 isn't available.  Remove any triggers created when the database
+    // was last opened with a library which provided it, otherwise every
+    // modification of the filter data would fail.  The index will be
+    // rebuilt if it becomes available again.
+    qCDebug(lcSailfishSecretsDaemonSqlite) << "Full-text index of filter data unavailable";
+    if (triggersExisted && db->beginTransaction()) {
+        if (executeStatements(database, dropIndexTriggerStatements)) {
+            db->commitTransaction();
+        } else {
+            db->rollbackTransaction();
+        }
+    }
+    return false;
+}
+
+bool FilterDataIndex::drop(QSqlDatabase &database)
+{
+    if (!executeStatements(database, dropIndexTriggerStatements)) {
+        return false;
+    }
+
+    // Dropping the virtual table requires FTS5.  If it isn't available the
+    // table cannot have been used since the triggers were last removed, and
+    // the schema upgrade can continue without it.
+    if (!executeStatements(database, dropIndexTableStatements)) {
+        qCWarning(lcSailfishSecretsDaemonSqlite) << "Unable to drop full-text index of filter data";
+    }
+    return true;
+}
+
+QString FilterDataIndex::matchExpression(const Sailfish::Secrets::Secret::FilterData &filter)
+{
+    QStringList alternatives;
+    for (Sailfish::Secrets::Secret::FilterData::const_iterator it = filter.constBegin(); it != filter.constEnd(); it++) {
+        QStringList phrases;
+        const QStringList words = Sailfish::Secrets::StoragePlugin::filterWords(it.value());
+        for (const QString &word : words) {
+            phrases.append(QLatin1Char('"') + QString(word).replace(QLatin1Char('"'), QLatin1String("\"\"")) + QLatin1Char('"'));
+        }
+        if (!phrases.isEmpty()) {
+            alternatives.append(QLatin1Char('(') + phrases.join(QLatin1String(" AND ")) + QLatin1Char(')'));
+        }
+    }
+    return alternatives.join(QLatin1String(" OR "));
+}
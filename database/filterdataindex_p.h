@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2018 Jolla Ltd.
+ * Contact: Chris Adams <chris.adams@jollamobile.com>
+ * All rights reserved.
+ * BSD 3-Clause License, see LICENSE.
+ */
+
+#ifndef SAILFISHSECRETS_COMMON_SQLITE_FILTERDATAINDEX_P_H
+#define SAILFISHSECRETS_COMMON_SQLITE_FILTERDATAINDEX_P_H
+
+#include "database_p.h"
+
+#include "Secrets/secret.h"
+
+#include <QtCore/QString>
+
+namespace Sailfish {
+
+namespace Secrets {
+
+namespace Daemon {
+
+namespace Sqlite {
+
+// Maintains an optional FTS5 full-text index (SecretsFilterDataIndex) of the
+// Value column of the SecretsFilterData table of a storage plugin database.
+// The index is kept up to date by triggers, and is only used if the SQLite
+// library which the database driver uses provides the FTS5 extension.
+namespace FilterDataIndex {
+
+// Creates the index (and the triggers which maintain it) if necessary,
+// rebuilding it if the triggers did not previously exist.  If FTS5 is not
+// available any triggers are removed so that the SecretsFilterData table
+// remains writable, and false is returned.
+bool open(Sailfish::Secrets::Daemon::Sqlite::Database *db);
+
+// Removes the index and its triggers.  Intended for use as the upgrade
+// function of a schema upgrade which changes the SecretsFilterData table;
+// the index is recreated and rebuilt by open() afterwards.
+bool drop(QSqlDatabase &database);
+
+// Returns an FTS5 query expression which matches rows whose Value contains
+// every word of any one of the values of the given filter, or an empty string
+// if none of the filter values contain a word.  The rows matched are a superset
+// of those which satisfy the filter, and must be verified by the caller.
+QString matchExpression(const Sailfish::Secrets::Secret::FilterData &filter);
+
+} // namespace FilterDataIndex
+
+} // namespace Sqlite
+
+} // namespace Daemon
+
+} // namespace Secrets
+
+} // namespace Sailfish
+
+#endif // SAILFISHSECRETS_COMMON_SQLITE_FILTERDATAINDEX_P_H
@@ -153,6 +153,7 @@ ExampleCryptoStoragePlugin::findSecrets(
         const QString &collectionName,
         const Secret::FilterData &filter,
         StoragePlugin::FilterOperator filterOperator,
+        StoragePlugin::FilterMatch filterMatch,
         QVector<Secret::Identifier> *identifiers)
 {
     if (collectionName != QStringLiteral("Default")) {
@@ -177,35 +178,7 @@ ExampleCryptoStoragePlugin::findSecrets(
     // perform in-memory filtering.
     QSet<QString> matchingSecretNames;
     for (QMap<QString, Secret::FilterData >::const_iterator it = secretNameToFilterData.constBegin(); it != secretNameToFilterData.constEnd(); it++) {
-        const Secret::FilterData &currFilterData(it.value());
-        bool matches = filterOperator == StoragePlugin::OperatorOr ? false : true;
-        for (Secret::FilterData::const_iterator fit = filter.constBegin(); fit != filter.constEnd(); fit++) {
-            bool found = false;
-            for (Secret::FilterData::const_iterator mit = currFilterData.constBegin(); mit != currFilterData.constEnd(); mit++) {
-                if (fit.key().compare(mit.key(), Qt::CaseInsensitive) == 0) {
-                    found = true; // found a matching metadata field for this filter field
-                    if (fit.value().compare(mit.value(), Qt::CaseInsensitive) == 0) {
-                        // the metadata value matches the filter value
-                        if (filterOperator == StoragePlugin::OperatorOr) {
-                            // we have a match!
-                            matches = true;
-                        }
-                    } else {
-                        if (filterOperator == StoragePlugin::OperatorAnd) {
-                            // we know that this one doesn't match.
-                            matches = false;
-                        }
-                    }
-                    break; // mit
-                }
-            }
-            if (!found && filterOperator == StoragePlugin::OperatorAnd) {
-                // the metadata is missing a required filter field.
-                matches = false;
-                break; // fit
-            }
-        }
-        if (matches) {
+        if (StoragePlugin::filterDataMatches(it.value(), filter, filterOperator, filterMatch)) {
             matchingSecretNames.insert(it.key());
         }
     }
@@ -8,11 +8,13 @@ QT += dbus
 QT -= gui
 
 include($$PWD/../../common.pri)
+include($$PWD/../libsailfishcryptoevp.pri)
 
 INCLUDEPATH += $$PWD/../
 DEPENDPATH += $$INCLUDEPATH $$PWD
 
 PUBLIC_HEADERS += \
+    $$PWD/batchverifyrequest.h \
     $$PWD/calculatedigestrequest.h \
     $$PWD/cipherrequest.h \
     $$PWD/cryptoglobal.h \
@@ -30,6 +32,7 @@ PUBLIC_HEADERS += \
     $$PWD/key.h \
     $$PWD/keyderivationparameters.h \
     $$PWD/keypairgenerationparameters.h \
+    $$PWD/keysessionrequest.h \
     $$PWD/lockcoderequest.h \
     $$PWD/plugininfo.h \
     $$PWD/plugininforequest.h \
@@ -46,6 +49,7 @@ INTERNAL_PUBLIC_HEADERS += \
     $$PWD/serialization_p.h
 
 PRIVATE_HEADERS += \
+    $$PWD/batchverifyrequest_p.h \
     $$PWD/calculatedigestrequest_p.h \
     $$PWD/cipherrequest_p.h \
     $$PWD/cryptodaemonconnection_p_p.h \
@@ -59,10 +63,12 @@ PRIVATE_HEADERS += \
     $$PWD/generatestoredkeyrequest_p.h \
     $$PWD/importkeyrequest_p.h \
     $$PWD/importstoredkeyrequest_p.h \
+    $$PWD/inprocesscrypto_p.h \
     $$PWD/interactionparameters_p.h \
     $$PWD/key_p.h \
     $$PWD/keyderivationparameters_p.h \
     $$PWD/keypairgenerationparameters_p.h \
+    $$PWD/keysessionrequest_p.h \
     $$PWD/lockcoderequest_p.h \
     $$PWD/plugininfo_p.h \
     $$PWD/plugininforequest_p.h \
@@ -79,6 +85,7 @@ HEADERS += \
     $$PRIVATE_HEADERS
 
 SOURCES += \
+    $$PWD/batchverifyrequest.cpp \
     $$PWD/calculatedigestrequest.cpp \
     $$PWD/cipherrequest.cpp \
     $$PWD/cryptodaemonconnection.cpp \
@@ -92,10 +99,12 @@ SOURCES += \
     $$PWD/generatestoredkeyrequest.cpp \
     $$PWD/importkeyrequest.cpp \
     $$PWD/importstoredkeyrequest.cpp \
+    $$PWD/inprocesscrypto.cpp \
     $$PWD/interactionparameters.cpp \
     $$PWD/key.cpp \
     $$PWD/keyderivationparameters.cpp \
     $$PWD/keypairgenerationparameters.cpp \
+    $$PWD/keysessionrequest.cpp \
     $$PWD/lockcoderequest.cpp \
     $$PWD/plugininfo.cpp \
     $$PWD/plugininforequest.cpp \
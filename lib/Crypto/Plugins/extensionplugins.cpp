@@ -177,7 +177,10 @@ CryptoPlugin::~CryptoPlugin()
  * The \a customParameters will contain plugin-specific parameters which may
  * be required by the plugin.  Such parameters must be documented for clients
  * in the documentation provided with the plugin, and otherwise should be
- * ignored by plugin implementers.
+ * ignored by plugin implementers.  The daemon sets the
+ * Sailfish_Crypto_CryptoPlugin_DaemonRequestParameter when it derives
+ * keys for its own use, and plugins may allow a higher key derivation
+ * cost for such requests than for client requests.
  *
  * If the given key pair generation parameters \a kpgParams are valid, then
  * those parameters specify the security size of the key (i.e. modulus length),
@@ -730,3 +733,52 @@ CryptoPlugin::~CryptoPlugin()
  * \a verificationStatus out-parameter to ascertain whether or not the decrypted
  * data can be trusted.
  */
+
+/*!
+ * \brief Attempts to verify each of the given \a signatures against the
+ *        input \a data at the same position, using the specified
+ *        \a padding, \a digestFunction and key \a key, and writes the
+ *        verification state of each to the out-parameter \a verificationStatuses.
+ *
+ * The \a signatures and \a data will have the same number of elements,
+ * and the \a verificationStatuses should be filled with one status per
+ * element, in the same order.  The status of each element is determined as
+ * for verify(), and the returned result should only be a failure if the
+ * whole batch could not be verified (e.g. if the plugin is locked, or
+ * the digest function is not supported).
+ *
+ * Plugins for which the per-operation setup is expensive (e.g. those which
+ * delegate to an external engine) should reimplement this function, so that
+ * the setup is shared by all the elements of the batch.  The default
+ * implementation calls verify() for each element in turn, and fails the
+ * whole batch if any of those calls fails.
+ */
+Sailfish::Crypto::Result CryptoPlugin::batchVerify(
+        const QVector<QByteArray> &signatures,
+        const QVector<QByteArray> &data,
+        const Sailfish::Crypto::Key &key,
+        Sailfish::Crypto::CryptoManager::SignaturePadding padding,
+        Sailfish::Crypto::CryptoManager::DigestFunction digestFunction,
+        const QVariantMap &customParameters,
+        QVector<Sailfish::Crypto::CryptoManager::VerificationStatus> *verificationStatuses)
+{
+    if (signatures.size() != data.size()) {
+        return Result(Result::CryptoPluginVerificationError,
+                      QLatin1String("Mismatched number of signatures and data"));
+    }
+
+    verificationStatuses->clear();
+    verificationStatuses->reserve(signatures.size());
+    for (int i = 0; i < signatures.size(); ++i) {
+        CryptoManager::VerificationStatus verificationStatus = CryptoManager::VerificationStatusUnknown;
+        Result result = verify(signatures.at(i), data.at(i), key, padding, digestFunction,
+                               customParameters, &verificationStatus);
+        if (result.code() != Result::Succeeded) {
+            verificationStatuses->clear();
+            return result;
+        }
+        verificationStatuses->append(verificationStatus);
+    }
+
+    return Result(Result::Succeeded);
+}
@@ -26,7 +26,11 @@
 #include <QtCore/QSharedDataPointer>
 #include <QtCore/QLoggingCategory>
 
-#define Sailfish_Crypto_CryptoPlugin_IID "org.sailfishos.crypto.CryptoPlugin/1.0"
+#define Sailfish_Crypto_CryptoPlugin_IID "org.sailfishos.crypto.CryptoPlugin/1.1"
+
+// The custom parameter which the daemon sets on its own requests to crypto
+// plugins.  It is removed from the custom parameters of client requests.
+#define Sailfish_Crypto_CryptoPlugin_DaemonRequestParameter "org.sailfishos.crypto.daemonRequest"
 
 SAILFISH_CRYPTO_API Q_DECLARE_LOGGING_CATEGORY(lcSailfishCryptoPlugin)
 
@@ -195,6 +199,17 @@ public:
             quint32 cipherSessionToken,
             QByteArray *generatedData,
             Sailfish::Crypto::CryptoManager::VerificationStatus *verificationStatus) = 0;
+
+    // Added in version 1.1 of the interface.  New virtual functions
+    // must be appended, so that the existing ones keep their vtable slots.
+    virtual Sailfish::Crypto::Result batchVerify(
+            const QVector<QByteArray> &signatures,
+            const QVector<QByteArray> &data,
+            const Sailfish::Crypto::Key &key,
+            Sailfish::Crypto::CryptoManager::SignaturePadding padding,
+            Sailfish::Crypto::CryptoManager::DigestFunction digestFunction,
+            const QVariantMap &customParameters,
+            QVector<Sailfish::Crypto::CryptoManager::VerificationStatus> *verificationStatuses);
 };
 
 } // namespace Crypto
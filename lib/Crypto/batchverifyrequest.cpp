@@ -0,0 +1,322 @@
+/*
+ * Copyright (C) 2018 Jolla Ltd.
+ * Contact: Chris Adams <chris.adams@jollamobile.com>
+ * All rights reserved.
+ * BSD 3-Clause License, see LICENSE.
+ */
+
+#include "Crypto/batchverifyrequest.h"
+#include "Crypto/batchverifyrequest_p.h"
+
+#include "Crypto/cryptomanager.h"
+#include "Crypto/cryptomanager_p.h"
+#include "Crypto/serialization_p.h"
+
+#include <QtDBus/QDBusPendingReply>
+#include <QtDBus/QDBusPendingCallWatcher>
+
+using namespace Sailfish::Crypto;
+
+BatchVerifyRequestPrivate::BatchVerifyRequestPrivate()
+    : m_padding(CryptoManager::SignaturePaddingUnknown)
+    , m_digestFunction(CryptoManager::DigestUnknown)
+    , m_status(Request::Inactive)
+{
+}
+
+/*!
+ * \class BatchVerifyRequest
+ * \brief Allows a client request the system crypto service to verify that
+ *        each of a batch of data was signed with a specific key
+ *
+ * The signature at each position in signatures() is verified against the
+ * data at the same position in data(), and the result of each verification
+ * is reported at the same position in verificationStatuses().
+ *
+ * Verifying a batch in a single request allows the crypto plugin to share
+ * the per-operation setup (e.g. the retrieval of the key, or the connection
+ * to an external engine) between all of the signatures, which is
+ * considerably cheaper than performing a VerifyRequest for each signature
+ * when verifying many small messages (e.g. the signed e-mails of a mailbox).
+ */
+
+/*!
+ * \brief Constructs a new BatchVerifyRequest object with the given \a parent
+ */
+BatchVerifyRequest::BatchVerifyRequest(QObject *parent)
+    : Request(parent)
+    , d_ptr(new BatchVerifyRequestPrivate)
+{
+}
+
+/*!
+ * \brief Destroys the BatchVerifyRequest
+ */
+BatchVerifyRequest::~BatchVerifyRequest()
+{
+}
+
+void BatchVerifyRequest::resetVerificationStatuses()
+{
+    Q_D(BatchVerifyRequest);
+    if (!d->m_verificationStatuses.isEmpty()) {
+        d->m_verificationStatuses.clear();
+        emit verificationStatusesChanged();
+    }
+    if (d->m_status == Request::Finished) {
+        d->m_status = Request::Inactive;
+        emit statusChanged();
+    }
+}
+
+/*!
+ * \brief Returns the signatures which the client wishes the system service to verify
+ */
+QVector<QByteArray> BatchVerifyRequest::signatures() const
+{
+    Q_D(const BatchVerifyRequest);
+    return d->m_signatures;
+}
+
+/*!
+ * \brief Sets the signatures which the client wishes the system service to verify to \a signatures
+ */
+void BatchVerifyRequest::setSignatures(const QVector<QByteArray> &signatures)
+{
+    Q_D(BatchVerifyRequest);
+    if (d->m_status != Request::Active && d->m_signatures != signatures) {
+        d->m_signatures = signatures;
+        resetVerificationStatuses();
+        emit signaturesChanged();
+    }
+}
+
+/*!
+ * \brief Returns the data which were signed by the remote parties
+ */
+QVector<QByteArray> BatchVerifyRequest::data() const
+{
+    Q_D(const BatchVerifyRequest);
+    return d->m_data;
+}
+
+/*!
+ * \brief Sets the data which were signed by the remote parties to \a data
+ *
+ * The data must contain one element for each of the signatures.
+ */
+void BatchVerifyRequest::setData(const QVector<QByteArray> &data)
+{
+    Q_D(BatchVerifyRequest);
+    if (d->m_status != Request::Active && d->m_data != data) {
+        d->m_data = data;
+        resetVerificationStatuses();
+        emit dataChanged();
+    }
+}
+
+/*!
+ * \brief Returns the key which the client wishes the system service to use to verify the data
+ */
+Key BatchVerifyRequest::key() const
+{
+    Q_D(const BatchVerifyRequest);
+    return d->m_key;
+}
+
+/*!
+ * \brief Sets the key which the client wishes the system service to use to verify the data to \a key
+ */
+void BatchVerifyRequest::setKey(const Key &key)
+{
+    Q_D(BatchVerifyRequest);
+    if (d->m_status != Request::Active && d->m_key != key) {
+        d->m_key = key;
+        resetVerificationStatuses();
+        emit keyChanged();
+    }
+}
+
+/*!
+ * \brief Returns the signature padding mode which was used when signing the data
+ */
+Sailfish::Crypto::CryptoManager::SignaturePadding BatchVerifyRequest::padding() const
+{
+    Q_D(const BatchVerifyRequest);
+    return d->m_padding;
+}
+
+/*!
+ * \brief Sets the signature padding mode which was used when signing the data to \a padding
+ */
+void BatchVerifyRequest::setPadding(Sailfish::Crypto::CryptoManager::SignaturePadding padding)
+{
+    Q_D(BatchVerifyRequest);
+    if (d->m_status != Request::Active && d->m_padding != padding) {
+        d->m_padding = padding;
+        resetVerificationStatuses();
+        emit paddingChanged();
+    }
+}
+
+/*!
+ * \brief Returns the digest which was used to generate the signatures
+ */
+Sailfish::Crypto::CryptoManager::DigestFunction BatchVerifyRequest::digestFunction() const
+{
+    Q_D(const BatchVerifyRequest);
+    return d->m_digestFunction;
+}
+
+/*!
+ * \brief Sets the digest which was used to generate the signatures to \a digestFn
+ */
+void BatchVerifyRequest::setDigestFunction(Sailfish::Crypto::CryptoManager::DigestFunction digestFn)
+{
+    Q_D(BatchVerifyRequest);
+    if (d->m_status != Request::Active && d->m_digestFunction != digestFn) {
+        d->m_digestFunction = digestFn;
+        resetVerificationStatuses();
+        emit digestFunctionChanged();
+    }
+}
+
+/*!
+ * \brief Returns the name of the crypto plugin which the client wishes to perform the verification operations
+ */
+QString BatchVerifyRequest::cryptoPluginName() const
+{
+    Q_D(const BatchVerifyRequest);
+    return d->m_cryptoPluginName;
+}
+
+/*!
+ * \brief Sets the name of the crypto plugin which the client wishes to perform the verification operations to \a pluginName
+ */
+void BatchVerifyRequest::setCryptoPluginName(const QString &pluginName)
+{
+    Q_D(BatchVerifyRequest);
+    if (d->m_status != Request::Active && d->m_cryptoPluginName != pluginName) {
+        d->m_cryptoPluginName = pluginName;
+        resetVerificationStatuses();
+        emit cryptoPluginNameChanged();
+    }
+}
+
+/*!
+ * \brief Returns the verification status of each of the signatures, in the same order as signatures().
+ *
+ * Note: this value is only valid if the status of the request is Request::Finished
+ * and the result of the request is Sailfish::Crypto::Result::Succeeded.
+ */
+QVector<Sailfish::Crypto::CryptoManager::VerificationStatus> BatchVerifyRequest::verificationStatuses() const
+{
+    Q_D(const BatchVerifyRequest);
+    return d->m_verificationStatuses;
+}
+
+Request::Status BatchVerifyRequest::status() const
+{
+    Q_D(const BatchVerifyRequest);
+    return d->m_status;
+}
+
+Result BatchVerifyRequest::result() const
+{
+    Q_D(const BatchVerifyRequest);
+    return d->m_result;
+}
+
+QVariantMap BatchVerifyRequest::customParameters() const
+{
+    Q_D(const BatchVerifyRequest);
+    return d->m_customParameters;
+}
+
+void BatchVerifyRequest::setCustomParameters(const QVariantMap &params)
+{
+    Q_D(BatchVerifyRequest);
+    if (d->m_customParameters != params) {
+        d->m_customParameters = params;
+        if (d->m_status == Request::Finished) {
+            d->m_status = Request::Inactive;
+            emit statusChanged();
+        }
+        emit customParametersChanged();
+    }
+}
+
+CryptoManager *BatchVerifyRequest::manager() const
+{
+    Q_D(const BatchVerifyRequest);
+    return d->m_manager.data();
+}
+
+void BatchVerifyRequest::setManager(CryptoManager *manager)
+{
+    Q_D(BatchVerifyRequest);
+    if (d->m_manager.data() != manager) {
+        d->m_manager = manager;
+        emit managerChanged();
+    }
+}
+
+void BatchVerifyRequest::startRequest()
+{
+    Q_D(BatchVerifyRequest);
+    if (d->m_status != Request::Active && !d->m_manager.isNull()) {
+        d->m_status = Request::Active;
+        emit statusChanged();
+        if (d->m_result.code() != Result::Pending) {
+            d->m_result = Result(Result::Pending);
+            emit resultChanged();
+        }
+
+        QDBusPendingReply<Result, QVector<Sailfish::Crypto::CryptoManager::VerificationStatus> > reply =
+                d->m_manager->d_ptr->batchVerify(d->m_signatures,
+                                                 d->m_data,
+                                                 d->m_key,
+                                                 d->m_padding,
+                                                 d->m_digestFunction,
+                                                 d->m_customParameters,
+                                                 d->m_cryptoPluginName);
+        if (!reply.isValid() && !reply.error().message().isEmpty()) {
+            d->m_status = Request::Finished;
+            d->m_result = Result(Result::CryptoManagerNotInitializedError,
+                                 reply.error().message());
+            emit statusChanged();
+            emit resultChanged();
+        } else if (reply.isFinished()
+                // work around a bug in QDBusAbstractInterface / QDBusConnection...
+                && reply.argumentAt<0>().code() != Sailfish::Crypto::Result::Succeeded) {
+            d->m_status = Request::Finished;
+            d->m_result = reply.argumentAt<0>();
+            d->m_verificationStatuses = reply.argumentAt<1>();
+            emit statusChanged();
+            emit resultChanged();
+            emit verificationStatusesChanged();
+        } else {
+            d->m_watcher.reset(new QDBusPendingCallWatcher(reply));
+            connect(d->m_watcher.data(), &QDBusPendingCallWatcher::finished,
+                    [this] {
+                QDBusPendingCallWatcher *watcher = this->d_ptr->m_watcher.take();
+                QDBusPendingReply<Result, QVector<Sailfish::Crypto::CryptoManager::VerificationStatus> > reply = *watcher;
+                this->d_ptr->m_status = Request::Finished;
+                this->d_ptr->m_result = reply.argumentAt<0>();
+                this->d_ptr->m_verificationStatuses = reply.argumentAt<1>();
+                watcher->deleteLater();
+                emit this->statusChanged();
+                emit this->resultChanged();
+                emit this->verificationStatusesChanged();
+            });
+        }
+    }
+}
+
+void BatchVerifyRequest::waitForFinished()
+{
+    Q_D(BatchVerifyRequest);
+    if (d->m_status == Request::Active && !d->m_watcher.isNull()) {
+        d->m_watcher->waitForFinished();
+    }
+}
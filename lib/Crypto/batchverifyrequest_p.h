@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2018 Jolla Ltd.
+ * Contact: Chris Adams <chris.adams@jollamobile.com>
+ * All rights reserved.
+ * BSD 3-Clause License, see LICENSE.
+ */
+
+#ifndef LIBSAILFISHCRYPTO_BATCHVERIFYREQUEST_P_H
+#define LIBSAILFISHCRYPTO_BATCHVERIFYREQUEST_P_H
+
+#include "Crypto/cryptoglobal.h"
+#include "Crypto/batchverifyrequest.h"
+#include "Crypto/cryptomanager.h"
+
+#include <QtCore/QPointer>
+#include <QtCore/QScopedPointer>
+#include <QtCore/QString>
+#include <QtCore/QVector>
+
+#include <QtDBus/QDBusPendingCallWatcher>
+
+namespace Sailfish {
+
+namespace Crypto {
+
+class BatchVerifyRequestPrivate
+{
+    Q_DISABLE_COPY(BatchVerifyRequestPrivate)
+
+public:
+    explicit BatchVerifyRequestPrivate();
+
+    QPointer<Sailfish::Crypto::CryptoManager> m_manager;
+    QVariantMap m_customParameters;
+    QVector<QByteArray> m_signatures;
+    QVector<QByteArray> m_data;
+    Sailfish::Crypto::Key m_key;
+    Sailfish::Crypto::CryptoManager::SignaturePadding m_padding;
+    Sailfish::Crypto::CryptoManager::DigestFunction m_digestFunction;
+    QString m_cryptoPluginName;
+    QVector<Sailfish::Crypto::CryptoManager::VerificationStatus> m_verificationStatuses;
+
+    QScopedPointer<QDBusPendingCallWatcher> m_watcher;
+    Sailfish::Crypto::Request::Status m_status;
+    Sailfish::Crypto::Result m_result;
+};
+
+} // namespace Crypto
+
+} // namespace Sailfish
+
+#endif // LIBSAILFISHCRYPTO_BATCHVERIFYREQUEST_P_H
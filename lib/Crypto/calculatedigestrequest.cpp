@@ -15,13 +15,36 @@
 #include <QtDBus/QDBusPendingReply>
 #include <QtDBus/QDBusPendingCallWatcher>
 
+#include <QtCore/QTimer>
+
 using namespace Sailfish::Crypto;
 
 CalculateDigestRequestPrivate::CalculateDigestRequestPrivate()
-    : m_status(Request::Inactive)
+    : m_inProcessPending(false),
+      m_status(Request::Inactive)
 {
 }
 
+namespace {
+
+void finishInProcessRequest(CalculateDigestRequest *request, CalculateDigestRequestPrivate *d)
+{
+    if (!d->m_inProcessPending) {
+        return;
+    }
+
+    d->m_inProcessPending = false;
+    d->m_status = Request::Finished;
+    d->m_result = d->m_inProcessResult;
+    d->m_digest = d->m_inProcessDigest;
+    d->m_inProcessDigest.clear();
+    emit request->statusChanged();
+    emit request->resultChanged();
+    emit request->digestChanged();
+}
+
+} // namespace
+
 /*!
  * \class CalculateDigestRequest
  * \brief Allows a client request the system crypto service to calculate a digest from data
@@ -218,6 +241,25 @@ void CalculateDigestRequest::startRequest()
             emit resultChanged();
         }
 
+        Result inProcessResult;
+        QByteArray digest;
+        if (d->m_manager->d_ptr->calculateDigestInProcess(d->m_data,
+                                                          d->m_padding,
+                                                          d->m_digestFunction,
+                                                          d->m_customParameters,
+                                                          d->m_cryptoPluginName,
+                                                          &inProcessResult,
+                                                          &digest)) {
+            // Report the outcome asynchronously, as for a daemon round trip.
+            d->m_inProcessPending = true;
+            d->m_inProcessResult = inProcessResult;
+            d->m_inProcessDigest = digest;
+            QTimer::singleShot(0, this, [this] {
+                finishInProcessRequest(this, this->d_ptr.data());
+            });
+            return;
+        }
+
         QDBusPendingReply<Result, QByteArray> reply =
                 d->m_manager->d_ptr->calculateDigest(d->m_data,
                                                      d->m_padding,
@@ -260,7 +302,9 @@ void CalculateDigestRequest::startRequest()
 void CalculateDigestRequest::waitForFinished()
 {
     Q_D(CalculateDigestRequest);
-    if (d->m_status == Request::Active && !d->m_watcher.isNull()) {
+    if (d->m_status == Request::Active && d->m_inProcessPending) {
+        finishInProcessRequest(this, d);
+    } else if (d->m_status == Request::Active && !d->m_watcher.isNull()) {
         d->m_watcher->waitForFinished();
     }
 }
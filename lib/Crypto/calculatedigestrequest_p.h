@@ -37,6 +37,11 @@ public:
     QString m_cryptoPluginName;
     QByteArray m_digest;
 
+    // Outcome of an in-process calculation, reported from the event loop.
+    bool m_inProcessPending;
+    Sailfish::Crypto::Result m_inProcessResult;
+    QByteArray m_inProcessDigest;
+
     QScopedPointer<QDBusPendingCallWatcher> m_watcher;
     Sailfish::Crypto::Request::Status m_status;
     Sailfish::Crypto::Result m_result;
@@ -171,6 +171,8 @@ void Sailfish::Crypto::CryptoDaemonConnection::registerDBusTypes()
     qRegisterMetaType<QVector<Sailfish::Crypto::CryptoManager::DigestFunction> >("QVector<Sailfish::Crypto::CryptoManager::DigestFunction>");
     qRegisterMetaType<Sailfish::Crypto::CryptoManager::Operations>("Sailfish::Crypto::CryptoManager::Operations");
     qRegisterMetaType<Sailfish::Crypto::CryptoManager::VerificationStatus>("Sailfish::Crypto::CryptoManager::VerificationStatus");
+    qRegisterMetaType<QVector<Sailfish::Crypto::CryptoManager::VerificationStatus> >("QVector<Sailfish::Crypto::CryptoManager::VerificationStatus>");
+    qRegisterMetaType<QVector<QByteArray> >("QVector<QByteArray>");
     qRegisterMetaType<Sailfish::Crypto::Key::Identifier>("Sailfish::Crypto::Key::Identifier");
     qRegisterMetaType<QVector<Sailfish::Crypto::Key::Identifier> >("QVector<Sailfish::Crypto::Key::Identifier>");
     qRegisterMetaType<Sailfish::Crypto::Key::FilterData>("Sailfish::Crypto::Key::FilterData");
@@ -203,7 +205,10 @@ void Sailfish::Crypto::CryptoDaemonConnection::registerDBusTypes()
     qDBusRegisterMetaType<QVector<Sailfish::Crypto::CryptoManager::DigestFunction> >();
     qDBusRegisterMetaType<Sailfish::Crypto::CryptoManager::Operations>();
     qDBusRegisterMetaType<Sailfish::Crypto::CryptoManager::VerificationStatus>();
+    qDBusRegisterMetaType<QVector<Sailfish::Crypto::CryptoManager::VerificationStatus> >();
+    qDBusRegisterMetaType<QVector<QByteArray> >();
     qDBusRegisterMetaType<Sailfish::Crypto::Key::Identifier>();
+    qDBusRegisterMetaType<Sailfish::Crypto::KeyIdentifierGroup>();
     qDBusRegisterMetaType<QVector<Sailfish::Crypto::Key::Identifier> >();
     qDBusRegisterMetaType<Sailfish::Crypto::Key>();
     qDBusRegisterMetaType<Sailfish::Crypto::Result>();
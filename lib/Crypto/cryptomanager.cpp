@@ -7,6 +7,7 @@
 
 #include "Crypto/cryptomanager.h"
 #include "Crypto/cryptomanager_p.h"
+#include "Crypto/inprocesscrypto_p.h"
 #include "Crypto/serialization_p.h"
 #include "Crypto/key.h"
 #include "Crypto/keypairgenerationparameters.h"
@@ -24,6 +25,8 @@
 #include <QtDBus/QDBusMetaType>
 
 #include <QtCore/QPointer>
+#include <QtCore/QAtomicInteger>
+#include <QtCore/QCoreApplication>
 #include <QtCore/QLoggingCategory>
 #include <QtCore/QStandardPaths>
 #include <QtCore/QDir>
@@ -49,6 +52,7 @@ CryptoManagerPrivate::CryptoManagerPrivate(CryptoManager *parent)
     , m_interface(m_crypto->connect()
                   ? m_crypto->createInterface(QLatin1String("/Sailfish/Crypto"), QLatin1String("org.sailfishos.crypto"), parent)
                   : Q_NULLPTR)
+    , m_inProcessExecution(false)
 {
 }
 
@@ -61,6 +65,31 @@ CryptoManagerPrivate::~CryptoManagerPrivate()
     m_interface = Q_NULLPTR;
 }
 
+/*!
+ * \internal
+ * \brief Sends the \a method call with the given \a arguments to the daemon
+ *
+ * A newly generated trace id is appended to the arguments of the call.
+ * The daemon associates it with the request so that all of the work it
+ * performs on behalf of the request (including plugin calls and user
+ * interaction) can be correlated.  The trace id is unique per client process.
+ */
+QDBusPendingCall
+CryptoManagerPrivate::tracedAsyncCall(
+        const QString &method,
+        const QVariantList &arguments)
+{
+    static QAtomicInteger<quint32> traceCounter;
+    const quint64 traceId = (quint64(QCoreApplication::applicationPid()) << 32)
+                          | Q_UINT64_C(0x80000000)
+                          | quint64(traceCounter.fetchAndAddRelaxed(1) & 0x7fffffff);
+
+    qCDebug(lcSailfishCrypto) << "Calling" << method << "with trace id:" << QString::number(traceId, 16);
+    QVariantList tracedArguments(arguments);
+    tracedArguments.append(QVariant::fromValue<quint64>(traceId));
+    return m_interface->asyncCallWithArgumentList(method, tracedArguments);
+}
+
 /*!
  * \internal
  * \brief Returns the names of available crypto plugins as well as the names of available (Secrets) storage plugins
@@ -78,7 +107,7 @@ CryptoManagerPrivate::getPluginInfo()
     }
 
     QDBusPendingReply<Result, QVector<PluginInfo>, QVector<PluginInfo> > reply
-            = m_interface->asyncCall("getPluginInfo");
+            = tracedAsyncCall("getPluginInfo");
 
     return reply;
 }
@@ -97,7 +126,7 @@ CryptoManagerPrivate::generateRandomData(
     }
 
     QDBusPendingReply<Result, QByteArray> reply
-            = m_interface->asyncCallWithArgumentList(
+            = tracedAsyncCall(
                 QStringLiteral("generateRandomData"),
                 QVariantList() << QVariant::fromValue<quint64>(numberBytes)
                                << QVariant::fromValue<QString>(csprngEngineName)
@@ -121,7 +150,7 @@ CryptoManagerPrivate::seedRandomDataGenerator(
     }
 
     QDBusPendingReply<Result> reply
-            = m_interface->asyncCallWithArgumentList(
+            = tracedAsyncCall(
                 QStringLiteral("seedRandomDataGenerator"),
                 QVariantList() << QVariant::fromValue<QByteArray>(seedData)
                                << QVariant::fromValue<double>(entropyEstimate)
@@ -146,7 +175,7 @@ CryptoManagerPrivate::generateInitializationVector(
     }
 
     QDBusPendingReply<Result, QByteArray> reply
-            = m_interface->asyncCallWithArgumentList(
+            = tracedAsyncCall(
                 QStringLiteral("generateInitializationVector"),
                 QVariantList() << QVariant::fromValue<CryptoManager::Algorithm>(algorithm)
                                << QVariant::fromValue<CryptoManager::BlockMode>(blockMode)
@@ -171,7 +200,7 @@ CryptoManagerPrivate::generateKey(
     }
 
     QDBusPendingReply<Result, Key> reply
-            = m_interface->asyncCallWithArgumentList(
+            = tracedAsyncCall(
                 QStringLiteral("generateKey"),
                 QVariantList() << QVariant::fromValue<Key>(keyTemplate)
                                << QVariant::fromValue<KeyPairGenerationParameters>(kpgParams)
@@ -197,7 +226,7 @@ CryptoManagerPrivate::generateStoredKey(
     }
 
     QDBusPendingReply<Result, Key> reply
-            = m_interface->asyncCallWithArgumentList(
+            = tracedAsyncCall(
                 QStringLiteral("generateStoredKey"),
                 QVariantList() << QVariant::fromValue<Key>(keyTemplate)
                                << QVariant::fromValue<KeyPairGenerationParameters>(kpgParams)
@@ -222,7 +251,7 @@ CryptoManagerPrivate::importKey(
     }
 
     QDBusPendingReply<Result, Key> reply
-            = m_interface->asyncCallWithArgumentList(
+            = tracedAsyncCall(
                 QStringLiteral("importKey"),
                 QVariantList() << QVariant::fromValue<QByteArray>(data)
                                << QVariant::fromValue<InteractionParameters>(uiParams)
@@ -246,7 +275,7 @@ CryptoManagerPrivate::importStoredKey(
     }
 
     QDBusPendingReply<Result, Key> reply
-            = m_interface->asyncCallWithArgumentList(
+            = tracedAsyncCall(
                 QStringLiteral("importStoredKey"),
                 QVariantList() << QVariant::fromValue<QByteArray>(data)
                                << QVariant::fromValue<Key>(keyTemplate)
@@ -269,7 +298,7 @@ CryptoManagerPrivate::storedKey(
     }
 
     QDBusPendingReply<Result, Key> reply
-            = m_interface->asyncCallWithArgumentList(
+            = tracedAsyncCall(
                 QStringLiteral("storedKey"),
                 QVariantList() << QVariant::fromValue<Key::Identifier>(identifier)
                                << QVariant::fromValue<Key::Components>(keyComponents)
@@ -288,7 +317,7 @@ CryptoManagerPrivate::deleteStoredKey(
     }
 
     QDBusPendingReply<Result> reply
-            = m_interface->asyncCallWithArgumentList(
+            = tracedAsyncCall(
                 QStringLiteral("deleteStoredKey"),
                 QVariantList() << QVariant::fromValue<Key::Identifier>(identifier));
     return reply;
@@ -307,7 +336,7 @@ CryptoManagerPrivate::storedKeyIdentifiers(
     }
 
     QDBusPendingReply<Result, QVector<Key::Identifier> > reply
-            = m_interface->asyncCallWithArgumentList(
+            = tracedAsyncCall(
                 QStringLiteral("storedKeyIdentifiers"),
                 QVariantList() << QVariant::fromValue<QString>(storagePluginName)
                                << QVariant::fromValue<QString>(collectionName)
@@ -330,7 +359,7 @@ CryptoManagerPrivate::calculateDigest(
     }
 
     QDBusPendingReply<Result, QByteArray> reply
-            = m_interface->asyncCallWithArgumentList(
+            = tracedAsyncCall(
                 QStringLiteral("calculateDigest"),
                 QVariantList() << QVariant::fromValue<QByteArray>(data)
                                << QVariant::fromValue<CryptoManager::SignaturePadding>(padding)
@@ -356,7 +385,7 @@ CryptoManagerPrivate::sign(
     }
 
     QDBusPendingReply<Result, QByteArray> reply
-            = m_interface->asyncCallWithArgumentList(
+            = tracedAsyncCall(
                 QStringLiteral("sign"),
                 QVariantList() << QVariant::fromValue<QByteArray>(data)
                                << QVariant::fromValue<Key>(key)
@@ -383,7 +412,7 @@ QDBusPendingReply<Result, CryptoManager::VerificationStatus> CryptoManagerPrivat
     }
 
     QDBusPendingReply<Result, Sailfish::Crypto::CryptoManager::VerificationStatus> reply
-            = m_interface->asyncCallWithArgumentList(
+            = tracedAsyncCall(
                 QStringLiteral("verify"),
                 QVariantList() << QVariant::fromValue<QByteArray>(signature)
                                << QVariant::fromValue<QByteArray>(data)
@@ -395,6 +424,34 @@ QDBusPendingReply<Result, CryptoManager::VerificationStatus> CryptoManagerPrivat
     return reply;
 }
 
+QDBusPendingReply<Result, QVector<CryptoManager::VerificationStatus> > CryptoManagerPrivate::batchVerify(
+        const QVector<QByteArray> &signatures,
+        const QVector<QByteArray> &data,
+        const Key &key,
+        CryptoManager::SignaturePadding padding,
+        CryptoManager::DigestFunction digestFunction,
+        const QVariantMap &customParameters,
+        const QString &cryptosystemProviderName)
+{
+    if (!m_interface) {
+        return QDBusPendingReply<Result, QVector<Sailfish::Crypto::CryptoManager::VerificationStatus> >(
+                    QDBusMessage::createError(QDBusError::Other,
+                                              QStringLiteral("Not connected to daemon")));
+    }
+
+    QDBusPendingReply<Result, QVector<Sailfish::Crypto::CryptoManager::VerificationStatus> > reply
+            = tracedAsyncCall(
+                QStringLiteral("batchVerify"),
+                QVariantList() << QVariant::fromValue<QVector<QByteArray> >(signatures)
+                               << QVariant::fromValue<QVector<QByteArray> >(data)
+                               << QVariant::fromValue<Key>(key)
+                               << QVariant::fromValue<CryptoManager::SignaturePadding>(padding)
+                               << QVariant::fromValue<CryptoManager::DigestFunction>(digestFunction)
+                               << QVariant::fromValue<QVariantMap>(customParameters)
+                               << QVariant::fromValue<QString>(cryptosystemProviderName));
+    return reply;
+}
+
 QDBusPendingReply<Result, QByteArray, QByteArray>
 CryptoManagerPrivate::encrypt(
         const QByteArray &data,
@@ -413,7 +470,7 @@ CryptoManagerPrivate::encrypt(
     }
 
     QDBusPendingReply<Result, QByteArray, QByteArray> reply
-            = m_interface->asyncCallWithArgumentList(
+            = tracedAsyncCall(
                 QStringLiteral("encrypt"),
                 QVariantList() << QVariant::fromValue<QByteArray>(data)
                                << QVariant::fromValue<QByteArray>(iv)
@@ -444,7 +501,7 @@ QDBusPendingReply<Result, QByteArray, Sailfish::Crypto::CryptoManager::Verificat
     }
 
     QDBusPendingReply<Result, QByteArray, Sailfish::Crypto::CryptoManager::VerificationStatus> reply
-            = m_interface->asyncCallWithArgumentList(
+            = tracedAsyncCall(
                 QStringLiteral("decrypt"),
                 QVariantList() << QVariant::fromValue<QByteArray>(data)
                                << QVariant::fromValue<QByteArray>(iv)
@@ -477,7 +534,7 @@ CryptoManagerPrivate::initializeCipherSession(
     }
 
     QDBusPendingReply<Result, quint32> reply
-            = m_interface->asyncCallWithArgumentList(
+            = tracedAsyncCall(
                 "initializeCipherSession",
                 QVariantList() << QVariant::fromValue<QByteArray>(initializationVector)
                                << QVariant::fromValue<Key>(key)
@@ -505,7 +562,7 @@ CryptoManagerPrivate::updateCipherSessionAuthentication(
     }
 
     QDBusPendingReply<Result> reply
-            = m_interface->asyncCallWithArgumentList(
+            = tracedAsyncCall(
                 "updateCipherSessionAuthentication",
                 QVariantList() << QVariant::fromValue<QByteArray>(authenticationData)
                                << QVariant::fromValue<QVariantMap>(customParameters)
@@ -528,7 +585,7 @@ CryptoManagerPrivate::updateCipherSession(
     }
 
     QDBusPendingReply<Result, QByteArray> reply
-            = m_interface->asyncCallWithArgumentList(
+            = tracedAsyncCall(
                 "updateCipherSession",
                 QVariantList() << QVariant::fromValue<QByteArray>(data)
                                << QVariant::fromValue<QVariantMap>(customParameters)
@@ -551,7 +608,7 @@ CryptoManagerPrivate::finalizeCipherSession(
     }
 
     QDBusPendingReply<Result, QByteArray, Sailfish::Crypto::CryptoManager::VerificationStatus> reply
-            = m_interface->asyncCallWithArgumentList(
+            = tracedAsyncCall(
                 "finalizeCipherSession",
                 QVariantList() << QVariant::fromValue<QByteArray>(data)
                                << QVariant::fromValue<QVariantMap>(customParameters)
@@ -560,6 +617,50 @@ CryptoManagerPrivate::finalizeCipherSession(
     return reply;
 }
 
+QDBusPendingReply<Result, quint32>
+CryptoManagerPrivate::openKeySession(
+        const Key &key,
+        CryptoManager::Operations operations,
+        const QVariantMap &customParameters,
+        const QString &cryptosystemProviderName)
+{
+    if (!m_interface) {
+        return QDBusPendingReply<Result, quint32>(
+                    QDBusMessage::createError(QDBusError::Other,
+                                              QStringLiteral("Not connected to daemon")));
+    }
+
+    QDBusPendingReply<Result, quint32> reply
+            = tracedAsyncCall(
+                "openKeySession",
+                QVariantList() << QVariant::fromValue<Key>(key)
+                               << QVariant::fromValue<CryptoManager::Operations>(operations)
+                               << QVariant::fromValue<QVariantMap>(customParameters)
+                               << QVariant::fromValue<QString>(cryptosystemProviderName));
+    return reply;
+}
+
+QDBusPendingReply<Result>
+CryptoManagerPrivate::closeKeySession(
+        quint32 keySessionToken,
+        const QVariantMap &customParameters,
+        const QString &cryptosystemProviderName)
+{
+    if (!m_interface) {
+        return QDBusPendingReply<Result>(
+                    QDBusMessage::createError(QDBusError::Other,
+                                              QStringLiteral("Not connected to daemon")));
+    }
+
+    QDBusPendingReply<Result> reply
+            = tracedAsyncCall(
+                "closeKeySession",
+                QVariantList() << QVariant::fromValue<quint32>(keySessionToken)
+                               << QVariant::fromValue<QVariantMap>(customParameters)
+                               << QVariant::fromValue<QString>(cryptosystemProviderName));
+    return reply;
+}
+
 QDBusPendingReply<Result, LockCodeRequest::LockStatus>
 CryptoManagerPrivate::queryLockStatus(
         LockCodeRequest::LockCodeTargetType lockCodeTargetType,
@@ -572,7 +673,7 @@ CryptoManagerPrivate::queryLockStatus(
     }
 
     QDBusPendingReply<Result, LockCodeRequest::LockStatus> reply
-            = m_interface->asyncCallWithArgumentList(
+            = tracedAsyncCall(
                 "queryLockStatus",
                 QVariantList() << QVariant::fromValue<LockCodeRequest::LockCodeTargetType>(lockCodeTargetType)
                                << QVariant::fromValue<QString>(lockCodeTarget));
@@ -592,7 +693,7 @@ CryptoManagerPrivate::modifyLockCode(
     }
 
     QDBusPendingReply<Result> reply
-            = m_interface->asyncCallWithArgumentList(
+            = tracedAsyncCall(
                 "modifyLockCode",
                 QVariantList() << QVariant::fromValue<LockCodeRequest::LockCodeTargetType>(lockCodeTargetType)
                                << QVariant::fromValue<QString>(lockCodeTarget)
@@ -613,7 +714,7 @@ CryptoManagerPrivate::provideLockCode(
     }
 
     QDBusPendingReply<Result> reply
-            = m_interface->asyncCallWithArgumentList(
+            = tracedAsyncCall(
                 "provideLockCode",
                 QVariantList() << QVariant::fromValue<LockCodeRequest::LockCodeTargetType>(lockCodeTargetType)
                                << QVariant::fromValue<QString>(lockCodeTarget)
@@ -634,7 +735,7 @@ CryptoManagerPrivate::forgetLockCode(
     }
 
     QDBusPendingReply<Result> reply
-            = m_interface->asyncCallWithArgumentList(
+            = tracedAsyncCall(
                 "forgetLockCode",
                 QVariantList() << QVariant::fromValue<LockCodeRequest::LockCodeTargetType>(lockCodeTargetType)
                                << QVariant::fromValue<QString>(lockCodeTarget)
@@ -642,6 +743,83 @@ CryptoManagerPrivate::forgetLockCode(
     return reply;
 }
 
+/*!
+ * \internal
+ */
+bool
+CryptoManagerPrivate::calculateDigestInProcess(
+        const QByteArray &data,
+        CryptoManager::SignaturePadding padding,
+        CryptoManager::DigestFunction digestFunction,
+        const QVariantMap &customParameters,
+        const QString &cryptosystemProviderName,
+        Result *result,
+        QByteArray *digest) const
+{
+    if (!m_inProcessExecution
+            || !InProcessCrypto::canCalculateDigest(customParameters, cryptosystemProviderName)) {
+        return false;
+    }
+
+    *result = InProcessCrypto::calculateDigest(data, padding, digestFunction, digest);
+    return true;
+}
+
+/*!
+ * \internal
+ */
+bool
+CryptoManagerPrivate::encryptInProcess(
+        const QByteArray &data,
+        const QByteArray &iv,
+        const Key &key,
+        CryptoManager::BlockMode blockMode,
+        CryptoManager::EncryptionPadding padding,
+        const QByteArray &authenticationData,
+        const QVariantMap &customParameters,
+        const QString &cryptosystemProviderName,
+        Result *result,
+        QByteArray *encrypted,
+        QByteArray *authenticationTag) const
+{
+    if (!m_inProcessExecution
+            || !InProcessCrypto::canCipher(key, customParameters, cryptosystemProviderName)) {
+        return false;
+    }
+
+    *result = InProcessCrypto::encrypt(data, iv, key, blockMode, padding, authenticationData,
+                                       encrypted, authenticationTag);
+    return true;
+}
+
+/*!
+ * \internal
+ */
+bool
+CryptoManagerPrivate::decryptInProcess(
+        const QByteArray &data,
+        const QByteArray &iv,
+        const Key &key,
+        CryptoManager::BlockMode blockMode,
+        CryptoManager::EncryptionPadding padding,
+        const QByteArray &authenticationData,
+        const QByteArray &authenticationTag,
+        const QVariantMap &customParameters,
+        const QString &cryptosystemProviderName,
+        Result *result,
+        QByteArray *decrypted,
+        CryptoManager::VerificationStatus *verificationStatus) const
+{
+    if (!m_inProcessExecution
+            || !InProcessCrypto::canCipher(key, customParameters, cryptosystemProviderName)) {
+        return false;
+    }
+
+    *result = InProcessCrypto::decrypt(data, iv, key, blockMode, padding, authenticationData,
+                                       authenticationTag, decrypted, verificationStatus);
+    return true;
+}
+
 /*!
  * \internal
  */
@@ -675,7 +853,9 @@ CryptoManagerPrivate *CryptoManager::pimpl() const
   \li \l{CalculateDigestRequest} to calculate a digest (non-keyed hash) of some data
   \li \l{SignRequest} to generate a signature for some data with a given \l{Key}
   \li \l{VerifyRequest} to verify if a signature was generated with a given \l{Key}
+  \li \l{BatchVerifyRequest} to verify if each of many signatures was generated with a given \l{Key}
   \li \l{CipherRequest} to start a cipher session with which to encrypt, decrypt, sign or verify a stream of data
+  \li \l{KeySessionRequest} to open a session with a securely-stored \l{Key} which many requests may use without looking the key up again
   \endlist
  */
 
@@ -707,3 +887,44 @@ bool CryptoManager::isInitialized() const
     Q_D(const CryptoManager);
     return d->m_interface;
 }
+
+/*!
+  \brief Returns true if operations on caller-supplied data may be performed within the client process.
+
+  \sa setInProcessExecutionEnabled()
+ */
+bool CryptoManager::inProcessExecutionEnabled() const
+{
+    Q_D(const CryptoManager);
+    return d->m_inProcessExecution;
+}
+
+/*!
+  \brief Sets whether operations on caller-supplied data may be performed within the client process to \a enabled.
+
+  By default, every request is performed by the system crypto service.
+  If in-process execution is enabled, requests which the OpenSSL crypto
+  plugin would perform using only data supplied by the client are instead
+  performed within the client process, avoiding the round trip to the
+  system crypto service.  These are:
+
+  \list
+  \li \l{CalculateDigestRequest}
+  \li \l{EncryptRequest} and \l{DecryptRequest} with an AES \l{Key} whose
+      \l{Key::secretKey()} is set
+  \endlist
+
+  The crypto plugin must be named explicitly: requests which use
+  CryptoManager::DefaultCryptoPluginName, or which cite a key session,
+  are always performed by the system crypto service, as are requests
+  which use keys stored by the system crypto service.
+  The results of requests performed in-process are identical to those
+  the system crypto service would return, and are likewise reported
+  asynchronously: the request remains active until control returns to the
+  event loop, or until Request::waitForFinished() is called.
+ */
+void CryptoManager::setInProcessExecutionEnabled(bool enabled)
+{
+    Q_D(CryptoManager);
+    d->m_inProcessExecution = enabled;
+}
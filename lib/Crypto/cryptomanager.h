@@ -334,12 +334,16 @@ public:
 
     bool isInitialized() const;
 
+    bool inProcessExecutionEnabled() const;
+    void setInProcessExecutionEnabled(bool enabled);
+
 protected:
     CryptoManagerPrivate *pimpl() const; // for unit tests
 
 private:
     QScopedPointer<CryptoManagerPrivate> const d_ptr;
     Q_DECLARE_PRIVATE(CryptoManager)
+    friend class BatchVerifyRequest;
     friend class CalculateDigestRequest;
     friend class CipherRequest;
     friend class DecryptRequest;
@@ -350,6 +354,7 @@ private:
     friend class GenerateStoredKeyRequest;
     friend class ImportKeyRequest;
     friend class ImportStoredKeyRequest;
+    friend class KeySessionRequest;
     friend class GenerateInitializationVectorRequest;
     friend class LockCodeRequest;
     friend class PluginInfoRequest;
@@ -137,6 +137,15 @@ public:
             const QVariantMap &customParameters,
             const QString &cryptosystemProviderName);
 
+    QDBusPendingReply<Sailfish::Crypto::Result, QVector<Sailfish::Crypto::CryptoManager::VerificationStatus> > batchVerify(
+            const QVector<QByteArray> &signatures,
+            const QVector<QByteArray> &data,
+            const Sailfish::Crypto::Key &key, // or keyreference, i.e. Key(keyName)
+            Sailfish::Crypto::CryptoManager::SignaturePadding padding,
+            Sailfish::Crypto::CryptoManager::DigestFunction digestFunction,
+            const QVariantMap &customParameters,
+            const QString &cryptosystemProviderName);
+
     QDBusPendingReply<Sailfish::Crypto::Result, QByteArray, QByteArray> encrypt(
             const QByteArray &data,
             const QByteArray &iv,
@@ -187,6 +196,17 @@ public:
             const QString &cryptosystemProviderName,
             quint32 cipherSessionToken);
 
+    QDBusPendingReply<Sailfish::Crypto::Result, quint32> openKeySession(
+            const Sailfish::Crypto::Key &key, // keyreference, i.e. Key(keyName)
+            Sailfish::Crypto::CryptoManager::Operations operations,
+            const QVariantMap &customParameters,
+            const QString &cryptosystemProviderName);
+
+    QDBusPendingReply<Sailfish::Crypto::Result> closeKeySession(
+            quint32 keySessionToken,
+            const QVariantMap &customParameters,
+            const QString &cryptosystemProviderName);
+
     QDBusPendingReply<Sailfish::Crypto::Result, Sailfish::Crypto::LockCodeRequest::LockStatus> queryLockStatus(
             Sailfish::Crypto::LockCodeRequest::LockCodeTargetType lockCodeTargetType,
             const QString &lockCodeTarget);
@@ -206,10 +226,56 @@ public:
             const QString &lockCodeTarget,
             const Sailfish::Crypto::InteractionParameters &interactionParameters);
 
+    // Perform the operation within the client process if in-process
+    // execution is enabled and the operation doesn't require the daemon,
+    // writing its outcome to the out-parameters.
+    // Return false if the operation must be performed by the daemon.
+    bool calculateDigestInProcess(
+            const QByteArray &data,
+            Sailfish::Crypto::CryptoManager::SignaturePadding padding,
+            Sailfish::Crypto::CryptoManager::DigestFunction digestFunction,
+            const QVariantMap &customParameters,
+            const QString &cryptosystemProviderName,
+            Sailfish::Crypto::Result *result,
+            QByteArray *digest) const;
+
+    bool encryptInProcess(
+            const QByteArray &data,
+            const QByteArray &iv,
+            const Sailfish::Crypto::Key &key,
+            Sailfish::Crypto::CryptoManager::BlockMode blockMode,
+            Sailfish::Crypto::CryptoManager::EncryptionPadding padding,
+            const QByteArray &authenticationData,
+            const QVariantMap &customParameters,
+            const QString &cryptosystemProviderName,
+            Sailfish::Crypto::Result *result,
+            QByteArray *encrypted,
+            QByteArray *authenticationTag) const;
+
+    bool decryptInProcess(
+            const QByteArray &data,
+            const QByteArray &iv,
+            const Sailfish::Crypto::Key &key,
+            Sailfish::Crypto::CryptoManager::BlockMode blockMode,
+            Sailfish::Crypto::CryptoManager::EncryptionPadding padding,
+            const QByteArray &authenticationData,
+            const QByteArray &authenticationTag,
+            const QVariantMap &customParameters,
+            const QString &cryptosystemProviderName,
+            Sailfish::Crypto::Result *result,
+            QByteArray *decrypted,
+            Sailfish::Crypto::CryptoManager::VerificationStatus *verificationStatus) const;
+
 private:
     friend class CryptoManager;
+    // Sends the given method call to the daemon, preceded by a newly
+    // generated trace id which the daemon uses to correlate all of
+    // the work it performs to handle the request.
+    QDBusPendingCall tracedAsyncCall(const QString &method, const QVariantList &arguments = QVariantList());
+
     QPointer<Sailfish::Crypto::CryptoDaemonConnection> m_crypto;
     QDBusInterface *m_interface;
+    bool m_inProcessExecution;
 };
 
 } // namespace Crypto
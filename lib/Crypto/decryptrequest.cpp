@@ -15,14 +15,40 @@
 #include <QtDBus/QDBusPendingReply>
 #include <QtDBus/QDBusPendingCallWatcher>
 
+#include <QtCore/QTimer>
+
 using namespace Sailfish::Crypto;
 
 DecryptRequestPrivate::DecryptRequestPrivate()
     : m_verificationStatus(Sailfish::Crypto::CryptoManager::VerificationStatusUnknown),
+      m_inProcessPending(false),
+      m_inProcessVerificationStatus(Sailfish::Crypto::CryptoManager::VerificationStatusUnknown),
       m_status(Request::Inactive)
 {
 }
 
+namespace {
+
+void finishInProcessRequest(DecryptRequest *request, DecryptRequestPrivate *d)
+{
+    if (!d->m_inProcessPending) {
+        return;
+    }
+
+    d->m_inProcessPending = false;
+    d->m_status = Request::Finished;
+    d->m_result = d->m_inProcessResult;
+    d->m_plaintext = d->m_inProcessPlaintext;
+    d->m_verificationStatus = d->m_inProcessVerificationStatus;
+    d->m_inProcessPlaintext.clear();
+    emit request->statusChanged();
+    emit request->resultChanged();
+    emit request->plaintextChanged();
+    emit request->verificationStatusChanged();
+}
+
+} // namespace
+
 /*!
  * \class DecryptRequest
  * \brief Allows a client request that the system crypto service decrypt data with a specific key.
@@ -343,6 +369,32 @@ void DecryptRequest::startRequest()
             emit resultChanged();
         }
 
+        Result inProcessResult;
+        QByteArray plaintext;
+        CryptoManager::VerificationStatus verificationStatus = CryptoManager::VerificationStatusUnknown;
+        if (d->m_manager->d_ptr->decryptInProcess(d->m_data,
+                                                  d->m_initializationVector,
+                                                  d->m_key,
+                                                  d->m_blockMode,
+                                                  d->m_padding,
+                                                  d->m_authenticationData,
+                                                  d->m_authenticationTag,
+                                                  d->m_customParameters,
+                                                  d->m_cryptoPluginName,
+                                                  &inProcessResult,
+                                                  &plaintext,
+                                                  &verificationStatus)) {
+            // Report the outcome asynchronously, as for a daemon round trip.
+            d->m_inProcessPending = true;
+            d->m_inProcessResult = inProcessResult;
+            d->m_inProcessPlaintext = plaintext;
+            d->m_inProcessVerificationStatus = verificationStatus;
+            QTimer::singleShot(0, this, [this] {
+                finishInProcessRequest(this, this->d_ptr.data());
+            });
+            return;
+        }
+
         QDBusPendingReply<Result, QByteArray, CryptoManager::VerificationStatus> reply = d->m_manager->d_ptr->decrypt(
                     d->m_data,
                     d->m_initializationVector,
@@ -393,7 +445,9 @@ void DecryptRequest::startRequest()
 void DecryptRequest::waitForFinished()
 {
     Q_D(DecryptRequest);
-    if (d->m_status == Request::Active && !d->m_watcher.isNull()) {
+    if (d->m_status == Request::Active && d->m_inProcessPending) {
+        finishInProcessRequest(this, d);
+    } else if (d->m_status == Request::Active && !d->m_watcher.isNull()) {
         d->m_watcher->waitForFinished();
     }
 }
@@ -42,6 +42,12 @@ public:
     QByteArray m_plaintext;
     Sailfish::Crypto::CryptoManager::VerificationStatus m_verificationStatus;
 
+    // Outcome of an in-process decryption, reported from the event loop.
+    bool m_inProcessPending;
+    Sailfish::Crypto::Result m_inProcessResult;
+    QByteArray m_inProcessPlaintext;
+    Sailfish::Crypto::CryptoManager::VerificationStatus m_inProcessVerificationStatus;
+
     QScopedPointer<QDBusPendingCallWatcher> m_watcher;
     Sailfish::Crypto::Request::Status m_status;
     Sailfish::Crypto::Result m_result;
@@ -15,13 +15,39 @@
 #include <QtDBus/QDBusPendingReply>
 #include <QtDBus/QDBusPendingCallWatcher>
 
+#include <QtCore/QTimer>
+
 using namespace Sailfish::Crypto;
 
 EncryptRequestPrivate::EncryptRequestPrivate()
-    : m_status(Request::Inactive)
+    : m_inProcessPending(false),
+      m_status(Request::Inactive)
 {
 }
 
+namespace {
+
+void finishInProcessRequest(EncryptRequest *request, EncryptRequestPrivate *d)
+{
+    if (!d->m_inProcessPending) {
+        return;
+    }
+
+    d->m_inProcessPending = false;
+    d->m_status = Request::Finished;
+    d->m_result = d->m_inProcessResult;
+    d->m_ciphertext = d->m_inProcessCiphertext;
+    d->m_authenticationTag = d->m_inProcessAuthenticationTag;
+    d->m_inProcessCiphertext.clear();
+    d->m_inProcessAuthenticationTag.clear();
+    emit request->statusChanged();
+    emit request->resultChanged();
+    emit request->ciphertextChanged();
+    emit request->authenticationTagChanged();
+}
+
+} // namespace
+
 /*!
  * \class EncryptRequest
  * \brief Allows a client request that the system crypto service encrypt data with a specific key.
@@ -317,6 +343,31 @@ void EncryptRequest::startRequest()
             emit resultChanged();
         }
 
+        Result inProcessResult;
+        QByteArray ciphertext;
+        QByteArray authenticationTag;
+        if (d->m_manager->d_ptr->encryptInProcess(d->m_data,
+                                                  d->m_initializationVector,
+                                                  d->m_key,
+                                                  d->m_blockMode,
+                                                  d->m_padding,
+                                                  d->m_authenticationData,
+                                                  d->m_customParameters,
+                                                  d->m_cryptoPluginName,
+                                                  &inProcessResult,
+                                                  &ciphertext,
+                                                  &authenticationTag)) {
+            // Report the outcome asynchronously, as for a daemon round trip.
+            d->m_inProcessPending = true;
+            d->m_inProcessResult = inProcessResult;
+            d->m_inProcessCiphertext = ciphertext;
+            d->m_inProcessAuthenticationTag = authenticationTag;
+            QTimer::singleShot(0, this, [this] {
+                finishInProcessRequest(this, this->d_ptr.data());
+            });
+            return;
+        }
+
         QDBusPendingReply<Result, QByteArray, QByteArray> reply =
                 d->m_manager->d_ptr->encrypt(d->m_data,
                                              d->m_initializationVector,
@@ -366,7 +417,9 @@ void EncryptRequest::startRequest()
 void EncryptRequest::waitForFinished()
 {
     Q_D(EncryptRequest);
-    if (d->m_status == Request::Active && !d->m_watcher.isNull()) {
+    if (d->m_status == Request::Active && d->m_inProcessPending) {
+        finishInProcessRequest(this, d);
+    } else if (d->m_status == Request::Active && !d->m_watcher.isNull()) {
         d->m_watcher->waitForFinished();
     }
 }
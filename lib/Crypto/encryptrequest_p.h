@@ -41,6 +41,12 @@ public:
     QByteArray m_authenticationData;
     QByteArray m_authenticationTag;
 
+    // Outcome of an in-process encryption, reported from the event loop.
+    bool m_inProcessPending;
+    Sailfish::Crypto::Result m_inProcessResult;
+    QByteArray m_inProcessCiphertext;
+    QByteArray m_inProcessAuthenticationTag;
+
     QScopedPointer<QDBusPendingCallWatcher> m_watcher;
     Sailfish::Crypto::Request::Status m_status;
     Sailfish::Crypto::Result m_result;
@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 2018 Jolla Ltd.
+ * Contact: Chris Adams <chris.adams@jollamobile.com>
+ * All rights reserved.
+ * BSD 3-Clause License, see LICENSE.
+ */
+
+#include "Crypto/inprocesscrypto_p.h"
+#include "Crypto/keysessionrequest.h"
+
+#include "evp_p.h"
+#include "evp_helpers_p.h"
+#include "evpaes_p.h"
+#include "evpvalidation_p.h"
+
+#include <QtCore/QPair>
+
+using namespace Sailfish::Crypto;
+
+namespace {
+
+// The names of the plugins whose behaviour the in-process implementation
+// reproduces.  Mapped names (e.g. CryptoManager::DefaultCryptoPluginName)
+// are resolved by the daemon, and so are never handled in-process.
+bool isOpenSslCryptoPlugin(const QString &cryptosystemProviderName)
+{
+    return cryptosystemProviderName == QLatin1String("org.sailfishos.crypto.plugin.crypto.openssl")
+            || cryptosystemProviderName == QLatin1String("org.sailfishos.crypto.plugin.crypto.openssl.test");
+}
+
+void ensureInitialized()
+{
+    static const int initialized = OpenSslEvp::init();
+    Q_UNUSED(initialized)
+}
+
+} // namespace
+
+bool InProcessCrypto::canCalculateDigest(
+        const QVariantMap &customParameters,
+        const QString &cryptosystemProviderName)
+{
+    return isOpenSslCryptoPlugin(cryptosystemProviderName)
+            && !customParameters.contains(KeySessionRequest::keySessionParameterName());
+}
+
+bool InProcessCrypto::canCipher(
+        const Key &key,
+        const QVariantMap &customParameters,
+        const QString &cryptosystemProviderName)
+{
+    // keys which are given by reference must be read from storage by the daemon.
+    return key.algorithm() == CryptoManager::AlgorithmAes
+            && !key.secretKey().isEmpty()
+            && canCalculateDigest(customParameters, cryptosystemProviderName);
+}
+
+Result InProcessCrypto::calculateDigest(
+        const QByteArray &data,
+        CryptoManager::SignaturePadding padding,
+        CryptoManager::DigestFunction digestFunction,
+        QByteArray *digest)
+{
+    const Result parametersResult = OpenSslValidation::checkDigestParameters(data, padding);
+    if (parametersResult.code() != Result::Succeeded) {
+        return parametersResult;
+    }
+
+    ensureInitialized();
+    const EVP_MD *evpDigestFunc = getEvpDigestFunction(digestFunction);
+    if (!evpDigestFunc) {
+        return Result(Result::DigestNotSupportedError,
+                      QLatin1String("Unsupported digest function chosen."));
+    }
+
+    uint8_t *digestBytes = Q_NULLPTR;
+    size_t digestLength = 0;
+    int r = OpenSslEvp::digest(evpDigestFunc, data.data(), data.length(), &digestBytes, &digestLength);
+    if (r != 1) {
+        return Result(Result::CryptoPluginDigestError,
+                      QLatin1String("Failed to digest."));
+    }
+
+    *digest = QByteArray((const char*) digestBytes, (int) digestLength);
+    OPENSSL_free(digestBytes);
+    return Result(Result::Succeeded);
+}
+
+Result InProcessCrypto::encrypt(
+        const QByteArray &data,
+        const QByteArray &iv,
+        const Key &key,
+        CryptoManager::BlockMode blockMode,
+        CryptoManager::EncryptionPadding padding,
+        const QByteArray &authenticationData,
+        QByteArray *encrypted,
+        QByteArray *authenticationTag)
+{
+    const Result parametersResult = OpenSslValidation::checkEncryptParameters(
+                iv, key, blockMode, padding, authenticationData);
+    if (parametersResult.code() != Result::Succeeded) {
+        return parametersResult;
+    }
+
+    const unsigned int tagSize = authenticationTagSize(key.algorithm(), blockMode);
+    ensureInitialized();
+    if (!authenticationData.isEmpty()) {
+        QPair<QByteArray, QByteArray> resultData = OpenSslAes::authEncrypt(getEvpCipher(blockMode, key.secretKey().size()), data, key.secretKey(), iv, authenticationData, tagSize);
+        if (resultData.second.isEmpty()) {
+            return Result(Result::CryptoPluginAuthenticationTagError,
+                          QLatin1String("OpenSSL crypto plugin failed to get the authentication tag"));
+        }
+        if (!resultData.first.isEmpty()) {
+            *encrypted = resultData.first;
+            *authenticationTag = resultData.second;
+            return Result(Result::Succeeded);
+        }
+    } else {
+        const QByteArray ciphertext = OpenSslAes::encrypt(getEvpCipher(blockMode, key.secretKey().size()), data, key.secretKey(), iv);
+        if (!ciphertext.isEmpty()) {
+            *encrypted = ciphertext;
+            return Result(Result::Succeeded);
+        }
+    }
+
+    return Result(Result::CryptoPluginEncryptionError,
+                  QLatin1String("OpenSSL crypto plugin failed to encrypt the data"));
+}
+
+Result InProcessCrypto::decrypt(
+        const QByteArray &data,
+        const QByteArray &iv,
+        const Key &key,
+        CryptoManager::BlockMode blockMode,
+        CryptoManager::EncryptionPadding padding,
+        const QByteArray &authenticationData,
+        const QByteArray &authenticationTag,
+        QByteArray *decrypted,
+        CryptoManager::VerificationStatus *verificationStatus)
+{
+    const Result parametersResult = OpenSslValidation::checkDecryptParameters(
+                iv, key, blockMode, padding, authenticationData, authenticationTag);
+    if (parametersResult.code() != Result::Succeeded) {
+        return parametersResult;
+    }
+
+    ensureInitialized();
+    QByteArray plaintext;
+    CryptoManager::VerificationStatus verificationStatusResult = CryptoManager::VerificationFailed;
+    if (!authenticationData.isEmpty()) {
+        QPair<QByteArray, bool> authDecryptResult = OpenSslAes::authDecrypt(getEvpCipher(blockMode, key.secretKey().size()), data, key.secretKey(), iv, authenticationData, authenticationTag);
+        plaintext = authDecryptResult.first;
+        verificationStatusResult = authDecryptResult.second
+                ? CryptoManager::VerificationSucceeded
+                : CryptoManager::VerificationFailed;
+    } else {
+        plaintext = OpenSslAes::decrypt(getEvpCipher(blockMode, key.secretKey().size()), data, key.secretKey(), iv);
+    }
+    if (!plaintext.size() || (plaintext.size() == 1 && plaintext.at(0) == 0)) {
+        return Result(Result::CryptoPluginDecryptionError,
+                      QLatin1String("Failed to decrypt the secret"));
+    }
+
+    *decrypted = plaintext;
+    *verificationStatus = verificationStatusResult;
+    return Result(Result::Succeeded);
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2018 Jolla Ltd.
+ * Contact: Chris Adams <chris.adams@jollamobile.com>
+ * All rights reserved.
+ * BSD 3-Clause License, see LICENSE.
+ */
+
+#ifndef LIBSAILFISHCRYPTO_INPROCESSCRYPTO_P_H
+#define LIBSAILFISHCRYPTO_INPROCESSCRYPTO_P_H
+
+#include "Crypto/cryptoglobal.h"
+#include "Crypto/cryptomanager.h"
+#include "Crypto/result.h"
+#include "Crypto/key.h"
+
+#include <QtCore/QByteArray>
+#include <QtCore/QString>
+#include <QtCore/QVariantMap>
+
+namespace Sailfish {
+
+namespace Crypto {
+
+// Performs operations whose inputs are entirely supplied by the client
+// within the client process, with a copy of the OpenSslEvp helpers which
+// the OpenSSL crypto plugin uses in the daemon.  The results (including
+// the error codes and messages of failures) are identical to those which
+// the OpenSSL crypto plugin would return.
+namespace InProcessCrypto {
+
+// Returns true if the operation may be performed in-process rather than
+// by the named crypto plugin in the daemon.
+bool canCalculateDigest(const QVariantMap &customParameters,
+                        const QString &cryptosystemProviderName);
+bool canCipher(const Sailfish::Crypto::Key &key,
+               const QVariantMap &customParameters,
+               const QString &cryptosystemProviderName);
+
+Sailfish::Crypto::Result calculateDigest(
+        const QByteArray &data,
+        Sailfish::Crypto::CryptoManager::SignaturePadding padding,
+        Sailfish::Crypto::CryptoManager::DigestFunction digestFunction,
+        QByteArray *digest);
+
+Sailfish::Crypto::Result encrypt(
+        const QByteArray &data,
+        const QByteArray &iv,
+        const Sailfish::Crypto::Key &key,
+        Sailfish::Crypto::CryptoManager::BlockMode blockMode,
+        Sailfish::Crypto::CryptoManager::EncryptionPadding padding,
+        const QByteArray &authenticationData,
+        QByteArray *encrypted,
+        QByteArray *authenticationTag);
+
+Sailfish::Crypto::Result decrypt(
+        const QByteArray &data,
+        const QByteArray &iv,
+        const Sailfish::Crypto::Key &key,
+        Sailfish::Crypto::CryptoManager::BlockMode blockMode,
+        Sailfish::Crypto::CryptoManager::EncryptionPadding padding,
+        const QByteArray &authenticationData,
+        const QByteArray &authenticationTag,
+        QByteArray *decrypted,
+        Sailfish::Crypto::CryptoManager::VerificationStatus *verificationStatus);
+
+} // namespace InProcessCrypto
+
+} // namespace Crypto
+
+} // namespace Sailfish
+
+#endif // LIBSAILFISHCRYPTO_INPROCESSCRYPTO_P_H
@@ -0,0 +1,390 @@
+/*
+ * Copyright (C) 2018 Jolla Ltd.
+ * Contact: Chris Adams <chris.adams@jollamobile.com>
+ * All rights reserved.
+ * BSD 3-Clause License, see LICENSE.
+ */
+
+#include "Crypto/keysessionrequest.h"
+#include "Crypto/keysessionrequest_p.h"
+
+#include "Crypto/cryptomanager.h"
+#include "Crypto/cryptomanager_p.h"
+#include "Crypto/serialization_p.h"
+
+#include <QtDBus/QDBusPendingReply>
+#include <QtDBus/QDBusPendingCallWatcher>
+
+using namespace Sailfish::Crypto;
+
+KeySessionRequestPrivate::KeySessionRequestPrivate()
+    : m_keySessionRequestType(KeySessionRequest::OpenKeySession)
+    , m_operations(CryptoManager::OperationUnknown)
+    , m_keySessionToken(0)
+    , m_status(Request::Inactive)
+{
+}
+
+/*!
+ * \class KeySessionRequest
+ * \brief Allows a client to open a session with a stored key, which
+ *        subsequent requests may cite instead of resolving the key again
+ *
+ * Every request which references a stored key normally requires the system
+ * service to perform access control and lock checks on the collection in
+ * which the key is stored, and to retrieve the key (or the key of its
+ * collection) from storage.  A client which performs many operations with
+ * the same stored key may instead open a key session: those checks are
+ * performed once, when the session is opened, and the service then keeps the
+ * resolved key until the session is closed.
+ *
+ * If the \l{keySessionRequestType()} specified is \l{OpenKeySession} then
+ * the service will open a session with the stored key identified by the
+ * \l{key()}, permitting the specified \l{operations()} to be performed with
+ * the key by the specified crypto plugin.  When the request finishes
+ * successfully, the \l{keySessionToken()} identifies the session.
+ *
+ * Sign, verify, batch verify, encrypt and decrypt requests cite the session
+ * by including the token in their custom parameters, under the
+ * \l{keySessionParameterName()}.  The key of such a request must either be
+ * empty or reference the same stored key as the session.  A session may only
+ * be cited by requests made through the connection which opened it.
+ *
+ * Sessions cannot be opened for keys stored in collections which are locked
+ * again after each access (e.g. with the
+ * Sailfish::Secrets::SecretManager::CustomLockAccessRelock semantic); such
+ * requests fail with Result::OperationNotSupportedError.
+ *
+ * If the \l{keySessionRequestType()} specified is \l{CloseKeySession} then
+ * the service will close the session previously opened by this request.
+ * The service also closes the sessions of a client when the client
+ * disconnects, when the stored key is deleted, when the crypto plugin
+ * is locked, and when the collection of the key (or its storage plugin, or
+ * the secrets service as a whole) is locked.  A request which cites a closed session fails with
+ * Result::InvalidKeySessionToken, after which the client should open a new
+ * session.
+ *
+ * An example of signing many messages with a single key session follows:
+ *
+ * \code
+ * Sailfish::Crypto::CryptoManager cm;
+ * Sailfish::Crypto::KeySessionRequest ksr;
+ * ksr.setManager(&cm);
+ * ksr.setKeySessionRequestType(Sailfish::Crypto::KeySessionRequest::OpenKeySession);
+ * ksr.setKey(keyReference);
+ * ksr.setOperations(Sailfish::Crypto::CryptoManager::OperationSign);
+ * ksr.setCryptoPluginName(keyReference.storagePluginName());
+ * ksr.startRequest();
+ * ksr.waitForFinished();
+ *
+ * QVariantMap params;
+ * params.insert(Sailfish::Crypto::KeySessionRequest::keySessionParameterName(),
+ *               ksr.keySessionToken());
+ * for (const QByteArray &message : messages) {
+ *     Sailfish::Crypto::SignRequest sr;
+ *     sr.setManager(&cm);
+ *     sr.setData(message);
+ *     sr.setPadding(Sailfish::Crypto::CryptoManager::SignaturePaddingNone);
+ *     sr.setDigestFunction(Sailfish::Crypto::CryptoManager::DigestSha256);
+ *     sr.setCryptoPluginName(keyReference.storagePluginName());
+ *     sr.setCustomParameters(params);
+ *     sr.startRequest();
+ *     sr.waitForFinished();
+ * }
+ *
+ * ksr.setKeySessionRequestType(Sailfish::Crypto::KeySessionRequest::CloseKeySession);
+ * ksr.startRequest();
+ * \endcode
+ */
+
+/*!
+ * \brief Constructs a new KeySessionRequest object with the given \a parent.
+ */
+KeySessionRequest::KeySessionRequest(QObject *parent)
+    : Request(parent)
+    , d_ptr(new KeySessionRequestPrivate)
+{
+}
+
+/*!
+ * \brief Destroys the KeySessionRequest
+ *
+ * Note that destroying the request doesn't close the key session.
+ */
+KeySessionRequest::~KeySessionRequest()
+{
+}
+
+/*!
+ * \brief Returns the name of the custom parameter with which a request cites a key session
+ */
+QString KeySessionRequest::keySessionParameterName()
+{
+    return QStringLiteral("KeySessionToken");
+}
+
+/*!
+ * \brief Returns the type of key session operation being requested
+ */
+KeySessionRequest::KeySessionRequestType KeySessionRequest::keySessionRequestType() const
+{
+    Q_D(const KeySessionRequest);
+    return d->m_keySessionRequestType;
+}
+
+/*!
+ * \brief Sets the type of key session operation being requested to \a type
+ */
+void KeySessionRequest::setKeySessionRequestType(KeySessionRequest::KeySessionRequestType type)
+{
+    Q_D(KeySessionRequest);
+    if (d->m_status != Request::Active && d->m_keySessionRequestType != type) {
+        d->m_keySessionRequestType = type;
+        if (d->m_status == Request::Finished) {
+            d->m_status = Request::Inactive;
+            emit statusChanged();
+        }
+        emit keySessionRequestTypeChanged();
+    }
+}
+
+/*!
+ * \brief Returns the reference to the stored key with which the session is opened
+ */
+Key KeySessionRequest::key() const
+{
+    Q_D(const KeySessionRequest);
+    return d->m_key;
+}
+
+/*!
+ * \brief Sets the reference to the stored key with which the session is opened to \a key
+ */
+void KeySessionRequest::setKey(const Key &key)
+{
+    Q_D(KeySessionRequest);
+    if (d->m_status != Request::Active && d->m_key != key) {
+        d->m_key = key;
+        if (d->m_status == Request::Finished) {
+            d->m_status = Request::Inactive;
+            emit statusChanged();
+        }
+        emit keyChanged();
+    }
+}
+
+/*!
+ * \brief Returns the operations which the session permits to be performed with the key
+ */
+CryptoManager::Operations KeySessionRequest::operations() const
+{
+    Q_D(const KeySessionRequest);
+    return d->m_operations;
+}
+
+/*!
+ * \brief Sets the operations which the session permits to be performed with the key to \a operations
+ */
+void KeySessionRequest::setOperations(CryptoManager::Operations operations)
+{
+    Q_D(KeySessionRequest);
+    if (d->m_status != Request::Active && d->m_operations != operations) {
+        d->m_operations = operations;
+        if (d->m_status == Request::Finished) {
+            d->m_status = Request::Inactive;
+            emit statusChanged();
+        }
+        emit operationsChanged();
+    }
+}
+
+/*!
+ * \brief Returns the name of the crypto plugin which performs the operations of the session
+ */
+QString KeySessionRequest::cryptoPluginName() const
+{
+    Q_D(const KeySessionRequest);
+    return d->m_cryptoPluginName;
+}
+
+/*!
+ * \brief Sets the name of the crypto plugin which performs the operations of the session to \a pluginName
+ */
+void KeySessionRequest::setCryptoPluginName(const QString &pluginName)
+{
+    Q_D(KeySessionRequest);
+    if (d->m_status != Request::Active && d->m_cryptoPluginName != pluginName) {
+        d->m_cryptoPluginName = pluginName;
+        if (d->m_status == Request::Finished) {
+            d->m_status = Request::Inactive;
+            emit statusChanged();
+        }
+        emit cryptoPluginNameChanged();
+    }
+}
+
+/*!
+ * \brief Returns the token which identifies the open key session
+ *
+ * Note: this value is only valid after an \l{OpenKeySession} request has
+ * finished successfully, and is reset to zero when the session is closed.
+ */
+quint32 KeySessionRequest::keySessionToken() const
+{
+    Q_D(const KeySessionRequest);
+    return d->m_keySessionToken;
+}
+
+Request::Status KeySessionRequest::status() const
+{
+    Q_D(const KeySessionRequest);
+    return d->m_status;
+}
+
+Result KeySessionRequest::result() const
+{
+    Q_D(const KeySessionRequest);
+    return d->m_result;
+}
+
+QVariantMap KeySessionRequest::customParameters() const
+{
+    Q_D(const KeySessionRequest);
+    return d->m_customParameters;
+}
+
+void KeySessionRequest::setCustomParameters(const QVariantMap &params)
+{
+    Q_D(KeySessionRequest);
+    if (d->m_customParameters != params) {
+        d->m_customParameters = params;
+        if (d->m_status == Request::Finished) {
+            d->m_status = Request::Inactive;
+            emit statusChanged();
+        }
+        emit customParametersChanged();
+    }
+}
+
+CryptoManager *KeySessionRequest::manager() const
+{
+    Q_D(const KeySessionRequest);
+    return d->m_manager.data();
+}
+
+void KeySessionRequest::setManager(CryptoManager *manager)
+{
+    Q_D(KeySessionRequest);
+    if (d->m_manager.data() != manager) {
+        d->m_manager = manager;
+        emit managerChanged();
+    }
+}
+
+void KeySessionRequest::startRequest()
+{
+    Q_D(KeySessionRequest);
+    if (d->m_status != Request::Active && !d->m_manager.isNull()) {
+        d->m_status = Request::Active;
+        emit statusChanged();
+        if (d->m_result.code() != Result::Pending) {
+            d->m_result = Result(Result::Pending);
+            emit resultChanged();
+        }
+
+        if (d->m_keySessionRequestType == KeySessionRequest::OpenKeySession) {
+            if (d->m_keySessionToken != 0) {
+                // the previous session is no longer reachable through this request.
+                d->m_keySessionToken = 0;
+                emit keySessionTokenChanged();
+            }
+            QDBusPendingReply<Result, quint32> reply =
+                    d->m_manager->d_ptr->openKeySession(d->m_key,
+                                                        d->m_operations,
+                                                        d->m_customParameters,
+                                                        d->m_cryptoPluginName);
+            if (!reply.isValid() && !reply.error().message().isEmpty()) {
+                d->m_status = Request::Finished;
+                d->m_result = Result(Result::CryptoManagerNotInitializedError,
+                                     reply.error().message());
+                emit statusChanged();
+                emit resultChanged();
+            } else if (reply.isFinished()
+                    // work around a bug in QDBusAbstractInterface / QDBusConnection...
+                    && reply.argumentAt<0>().code() != Sailfish::Crypto::Result::Succeeded) {
+                d->m_status = Request::Finished;
+                d->m_result = reply.argumentAt<0>();
+                emit statusChanged();
+                emit resultChanged();
+            } else {
+                d->m_watcher.reset(new QDBusPendingCallWatcher(reply));
+                connect(d->m_watcher.data(), &QDBusPendingCallWatcher::finished,
+                        [this] {
+                    QDBusPendingCallWatcher *watcher = this->d_ptr->m_watcher.take();
+                    QDBusPendingReply<Result, quint32> reply = *watcher;
+                    this->d_ptr->m_status = Request::Finished;
+                    this->d_ptr->m_result = reply.argumentAt<0>();
+                    if (this->d_ptr->m_result.code() == Result::Succeeded) {
+                        this->d_ptr->m_keySessionToken = reply.argumentAt<1>();
+                    }
+                    watcher->deleteLater();
+                    emit this->statusChanged();
+                    emit this->resultChanged();
+                    if (this->d_ptr->m_keySessionToken != 0) {
+                        emit this->keySessionTokenChanged();
+                    }
+                });
+            }
+        } else {
+            if (d->m_keySessionToken == 0) {
+                d->m_status = Request::Finished;
+                d->m_result = Result(Result::InvalidKeySessionToken,
+                                     QStringLiteral("No key session has been opened by this request"));
+                emit statusChanged();
+                emit resultChanged();
+                return;
+            }
+            QDBusPendingReply<Result> reply =
+                    d->m_manager->d_ptr->closeKeySession(d->m_keySessionToken,
+                                                         d->m_customParameters,
+                                                         d->m_cryptoPluginName);
+            if (!reply.isValid() && !reply.error().message().isEmpty()) {
+                d->m_status = Request::Finished;
+                d->m_result = Result(Result::CryptoManagerNotInitializedError,
+                                     reply.error().message());
+                emit statusChanged();
+                emit resultChanged();
+            } else if (reply.isFinished()
+                    // work around a bug in QDBusAbstractInterface / QDBusConnection...
+                    && reply.argumentAt<0>().code() != Sailfish::Crypto::Result::Succeeded) {
+                d->m_status = Request::Finished;
+                d->m_result = reply.argumentAt<0>();
+                emit statusChanged();
+                emit resultChanged();
+            } else {
+                d->m_watcher.reset(new QDBusPendingCallWatcher(reply));
+                connect(d->m_watcher.data(), &QDBusPendingCallWatcher::finished,
+                        [this] {
+                    QDBusPendingCallWatcher *watcher = this->d_ptr->m_watcher.take();
+                    QDBusPendingReply<Result> reply = *watcher;
+                    this->d_ptr->m_status = Request::Finished;
+                    this->d_ptr->m_result = reply.argumentAt<0>();
+                    // the session no longer exists, whether or not it was still open.
+                    this->d_ptr->m_keySessionToken = 0;
+                    watcher->deleteLater();
+                    emit this->statusChanged();
+                    emit this->resultChanged();
+                    emit this->keySessionTokenChanged();
+                });
+            }
+        }
+    }
+}
+
+void KeySessionRequest::waitForFinished()
+{
+    Q_D(KeySessionRequest);
+    if (d->m_status == Request::Active && !d->m_watcher.isNull()) {
+        d->m_watcher->waitForFinished();
+    }
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2018 Jolla Ltd.
+ * Contact: Chris Adams <chris.adams@jollamobile.com>
+ * All rights reserved.
+ * BSD 3-Clause License, see LICENSE.
+ */
+
+#ifndef LIBSAILFISHCRYPTO_KEYSESSIONREQUEST_H
+#define LIBSAILFISHCRYPTO_KEYSESSIONREQUEST_H
+
+#include "Crypto/cryptoglobal.h"
+#include "Crypto/request.h"
+#include "Crypto/key.h"
+#include "Crypto/cryptomanager.h"
+
+#include <QtCore/QObject>
+#include <QtCore/QScopedPointer>
+#include <QtCore/QString>
+
+namespace Sailfish {
+
+namespace Crypto {
+
+class CryptoManager;
+
+class KeySessionRequestPrivate;
+class SAILFISH_CRYPTO_API KeySessionRequest : public Sailfish::Crypto::Request
+{
+    Q_OBJECT
+    Q_PROPERTY(KeySessionRequestType keySessionRequestType READ keySessionRequestType WRITE setKeySessionRequestType NOTIFY keySessionRequestTypeChanged)
+    Q_PROPERTY(Sailfish::Crypto::Key key READ key WRITE setKey NOTIFY keyChanged)
+    Q_PROPERTY(Sailfish::Crypto::CryptoManager::Operations operations READ operations WRITE setOperations NOTIFY operationsChanged)
+    Q_PROPERTY(QString cryptoPluginName READ cryptoPluginName WRITE setCryptoPluginName NOTIFY cryptoPluginNameChanged)
+    Q_PROPERTY(quint32 keySessionToken READ keySessionToken NOTIFY keySessionTokenChanged)
+
+public:
+    enum KeySessionRequestType {
+        OpenKeySession = 0,
+        CloseKeySession
+    };
+    Q_ENUM(KeySessionRequestType)
+
+    KeySessionRequest(QObject *parent = Q_NULLPTR);
+    ~KeySessionRequest();
+
+    static QString keySessionParameterName();
+
+    KeySessionRequestType keySessionRequestType() const;
+    void setKeySessionRequestType(KeySessionRequestType type);
+
+    Sailfish::Crypto::Key key() const;
+    void setKey(const Sailfish::Crypto::Key &key);
+
+    Sailfish::Crypto::CryptoManager::Operations operations() const;
+    void setOperations(Sailfish::Crypto::CryptoManager::Operations operations);
+
+    QString cryptoPluginName() const;
+    void setCryptoPluginName(const QString &pluginName);
+
+    quint32 keySessionToken() const;
+
+    Sailfish::Crypto::Request::Status status() const Q_DECL_OVERRIDE;
+    Sailfish::Crypto::Result result() const Q_DECL_OVERRIDE;
+
+    QVariantMap customParameters() const Q_DECL_OVERRIDE;
+    void setCustomParameters(const QVariantMap &params) Q_DECL_OVERRIDE;
+
+    Sailfish::Crypto::CryptoManager *manager() const Q_DECL_OVERRIDE;
+    void setManager(Sailfish::Crypto::CryptoManager *manager) Q_DECL_OVERRIDE;
+
+    void startRequest() Q_DECL_OVERRIDE;
+    void waitForFinished() Q_DECL_OVERRIDE;
+
+Q_SIGNALS:
+    void keySessionRequestTypeChanged();
+    void keyChanged();
+    void operationsChanged();
+    void cryptoPluginNameChanged();
+    void keySessionTokenChanged();
+
+private:
+    QScopedPointer<KeySessionRequestPrivate> const d_ptr;
+    Q_DECLARE_PRIVATE(KeySessionRequest)
+};
+
+} // namespace Crypto
+
+} // namespace Sailfish
+
+#endif // LIBSAILFISHCRYPTO_KEYSESSIONREQUEST_H
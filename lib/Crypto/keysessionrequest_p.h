@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2018 Jolla Ltd.
+ * Contact: Chris Adams <chris.adams@jollamobile.com>
+ * All rights reserved.
+ * BSD 3-Clause License, see LICENSE.
+ */
+
+#ifndef LIBSAILFISHCRYPTO_KEYSESSIONREQUEST_P_H
+#define LIBSAILFISHCRYPTO_KEYSESSIONREQUEST_P_H
+
+#include "Crypto/cryptoglobal.h"
+#include "Crypto/keysessionrequest.h"
+#include "Crypto/cryptomanager.h"
+
+#include <QtCore/QPointer>
+#include <QtCore/QScopedPointer>
+#include <QtCore/QString>
+
+#include <QtDBus/QDBusPendingCallWatcher>
+
+namespace Sailfish {
+
+namespace Crypto {
+
+class KeySessionRequestPrivate
+{
+    Q_DISABLE_COPY(KeySessionRequestPrivate)
+
+public:
+    explicit KeySessionRequestPrivate();
+
+    QPointer<Sailfish::Crypto::CryptoManager> m_manager;
+    QVariantMap m_customParameters;
+    Sailfish::Crypto::KeySessionRequest::KeySessionRequestType m_keySessionRequestType;
+    Sailfish::Crypto::Key m_key;
+    Sailfish::Crypto::CryptoManager::Operations m_operations;
+    QString m_cryptoPluginName;
+    quint32 m_keySessionToken;
+
+    QScopedPointer<QDBusPendingCallWatcher> m_watcher;
+    Sailfish::Crypto::Request::Status m_status;
+    Sailfish::Crypto::Result m_result;
+};
+
+} // namespace Crypto
+
+} // namespace Sailfish
+
+#endif // LIBSAILFISHCRYPTO_KEYSESSIONREQUEST_P_H
@@ -49,6 +49,7 @@ public:
         CryptoManagerNotInitializedError,
         InvalidInitializationVectorError,
         InvalidAuthenticationTagError,
+        InvalidKeySessionToken,
 
         OperationNotSupportedError = 20,
         BlockModeNotSupportedError,
@@ -25,9 +25,27 @@
 #include <QtCore/QBuffer>
 #include <QtCore/QDataStream>
 #include <QtCore/QByteArray>
+#include <QtCore/QSet>
 
 Q_LOGGING_CATEGORY(lcSailfishCryptoSerialization, "org.sailfishos.crypto.serialization", QtWarningMsg)
 
+namespace {
+
+// Returns a string equal to the given string which shares its data with
+// the first equal string previously seen, so that the plugin and collection
+// names repeated throughout a large set of identifiers are held only once.
+QString internedString(const QString &str, QSet<QString> *strings)
+{
+    QSet<QString>::const_iterator it = strings->constFind(str);
+    if (it != strings->constEnd()) {
+        return *it;
+    }
+    strings->insert(str);
+    return str;
+}
+
+} // namespace
+
 namespace Sailfish {
 
 namespace Crypto {
@@ -347,6 +365,68 @@ const QDBusArgument &operator>>(const QDBusArgument &argument, Key::Identifier &
     return argument;
 }
 
+QDBusArgument &operator<<(QDBusArgument &argument, const KeyIdentifierGroup &group)
+{
+    argument.beginStructure();
+    argument << group.storagePluginName;
+    argument << group.collectionName;
+    argument << group.names;
+    argument.endStructure();
+    return argument;
+}
+
+const QDBusArgument &operator>>(const QDBusArgument &argument, KeyIdentifierGroup &group)
+{
+    argument.beginStructure();
+    argument >> group.storagePluginName;
+    argument >> group.collectionName;
+    argument >> group.names;
+    argument.endStructure();
+    return argument;
+}
+
+QDBusArgument &operator<<(QDBusArgument &argument, const QVector<Key::Identifier> &identifiers)
+{
+    KeyIdentifierGroup group;
+    argument.beginArray(qMetaTypeId<KeyIdentifierGroup>());
+    for (const Key::Identifier &identifier : identifiers) {
+        if (!group.names.isEmpty()
+                && (identifier.storagePluginName() != group.storagePluginName
+                    || identifier.collectionName() != group.collectionName)) {
+            argument << group;
+            group.names.clear();
+        }
+        if (group.names.isEmpty()) {
+            group.storagePluginName = identifier.storagePluginName();
+            group.collectionName = identifier.collectionName();
+        }
+        group.names.append(identifier.name());
+    }
+    if (!group.names.isEmpty()) {
+        argument << group;
+    }
+    argument.endArray();
+    return argument;
+}
+
+const QDBusArgument &operator>>(const QDBusArgument &argument, QVector<Key::Identifier> &identifiers)
+{
+    QSet<QString> strings;
+    identifiers.clear();
+    argument.beginArray();
+    while (!argument.atEnd()) {
+        KeyIdentifierGroup group;
+        argument >> group;
+        const QString storagePluginName = internedString(group.storagePluginName, &strings);
+        const QString collectionName = internedString(group.collectionName, &strings);
+        for (const QString &name : group.names) {
+            identifiers.append(Key::Identifier(name, collectionName, storagePluginName));
+        }
+    }
+    argument.endArray();
+    return argument;
+}
+
 QDBusArgument &operator<<(QDBusArgument &argument, const Key::FilterData &filterData)
 {
     argument.beginStructure();
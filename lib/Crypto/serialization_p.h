@@ -28,15 +28,32 @@
 #include <QtDBus/QDBusArgument>
 #include <QtDBus/QDBusMetaType>
 
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QVector>
+
 namespace Sailfish {
 
 namespace Crypto {
 
+// A run of consecutive key identifiers which share a storage plugin and
+// collection, as marshalled within a vector of key identifiers.
+struct KeyIdentifierGroup
+{
+    QString storagePluginName;
+    QString collectionName;
+    QStringList names;
+};
+
 QDBusArgument &operator<<(QDBusArgument &argument, const Sailfish::Crypto::Key &key) SAILFISH_CRYPTO_API;
 const QDBusArgument &operator>>(const QDBusArgument &argument, Sailfish::Crypto::Key &key) SAILFISH_CRYPTO_API;
 
 QDBusArgument &operator<<(QDBusArgument &argument, const Sailfish::Crypto::Key::Identifier &identifier) SAILFISH_CRYPTO_API;
 const QDBusArgument &operator>>(const QDBusArgument &argument, Sailfish::Crypto::Key::Identifier &identifier) SAILFISH_CRYPTO_API;
+QDBusArgument &operator<<(QDBusArgument &argument, const Sailfish::Crypto::KeyIdentifierGroup &group) SAILFISH_CRYPTO_API;
+const QDBusArgument &operator>>(const QDBusArgument &argument, Sailfish::Crypto::KeyIdentifierGroup &group) SAILFISH_CRYPTO_API;
+QDBusArgument &operator<<(QDBusArgument &argument, const QVector<Sailfish::Crypto::Key::Identifier> &identifiers) SAILFISH_CRYPTO_API;
+const QDBusArgument &operator>>(const QDBusArgument &argument, QVector<Sailfish::Crypto::Key::Identifier> &identifiers) SAILFISH_CRYPTO_API;
 
 QDBusArgument &operator<<(QDBusArgument &argument, const Sailfish::Crypto::Key::FilterData &filterData) SAILFISH_CRYPTO_API;
 const QDBusArgument &operator>>(const QDBusArgument &argument, Sailfish::Crypto::Key::FilterData &filterData) SAILFISH_CRYPTO_API;
@@ -109,4 +126,6 @@ const QDBusArgument &operator>>(const QDBusArgument &argument, Sailfish::Crypto:
 
 } // Sailfish
 
+Q_DECLARE_METATYPE(Sailfish::Crypto::KeyIdentifierGroup);
+
 #endif // LIBSAILFISHCRYPTO_SERIALIZATION_H
@@ -0,0 +1,29 @@
+TEMPLATE = lib
+TARGET = sailfishcryptoevp
+CONFIG += staticlib hide_symbols link_pkgconfig
+PKGCONFIG += libcrypto
+
+include($$PWD/../../common.pri)
+
+# The static library is linked into the client library and the plugins,
+# so it must be position independent.
+QMAKE_CFLAGS += $$QMAKE_CFLAGS_SHLIB
+QMAKE_CXXFLAGS += $$QMAKE_CXXFLAGS_SHLIB
+
+EVP_DIR = $$PWD/../../plugins/opensslcryptoplugin/evp
+
+INCLUDEPATH += $$EVP_DIR $$PWD/..
+DEPENDPATH += $$INCLUDEPATH
+
+HEADERS += \
+    $$EVP_DIR/evp_p.h \
+    $$EVP_DIR/evp_helpers_p.h \
+    $$EVP_DIR/evpaes_p.h \
+    $$EVP_DIR/evpkdf_p.h \
+    $$EVP_DIR/evpvalidation_p.h
+
+SOURCES += \
+    $$EVP_DIR/evp.cpp \
+    $$EVP_DIR/evpaes.cpp \
+    $$EVP_DIR/evpkdf.cpp \
+    $$EVP_DIR/evpvalidation.cpp
@@ -9,6 +9,8 @@
 
 #include <QObject>
 #include <QString>
+#include <QStringList>
+#include <QRegExp>
 #include <QSharedData>
 
 SAILFISH_SECRETS_API Q_LOGGING_CATEGORY(lcSailfishSecretsPlugin, "org.sailfishos.secrets.daemon.plugin", QtWarningMsg)
@@ -312,6 +314,47 @@ EncryptionPlugin::~EncryptionPlugin()
  * Sailfish::Secrets::Result::SecretsPluginIsLockedError.
  */
 
+/*!
+ * \brief Derive an encryption key from the given \a authenticationCode and
+ *        \a salt using the key derivation function and cost described by
+ *        the given \a parameters, and write it to the out-parameter \a key.
+ *
+ * The \a parameters may contain the following values:
+ * \list
+ * \li "keyDerivationFunction": one of "pbkdf2", "scrypt" or "argon2id"
+ * \li "iterations": the iteration count for PBKDF2, the CPU/memory cost
+ *     (a power of two) for scrypt, or the number of passes for Argon2id
+ * \li "memorySize": the amount of memory in KiB used by Argon2id
+ * \li "parallelism": the number of lanes used by scrypt and Argon2id,
+ *     which plugins may but need not compute concurrently
+ * \endlist
+ *
+ * A key derived with empty \a parameters must be identical to the key
+ * derived via deriveKeyFromCode().  The errors which should be reported
+ * are the same as for that function, and if the plugin does not support
+ * the requested key derivation function or cost it should return a
+ * Sailfish::Secrets::Result with the result code set to
+ * Sailfish::Secrets::Result::Failed and the error code set to
+ * Sailfish::Secrets::Result::OperationNotSupportedError.
+ *
+ * The default implementation calls deriveKeyFromCode() if the \a parameters
+ * are empty, and otherwise returns OperationNotSupportedError.
+ * Plugins which support memory-hard key derivation functions should
+ * reimplement this function.
+ */
+Sailfish::Secrets::Result EncryptionPlugin::deriveKeyFromCodeWithParameters(
+        const QByteArray &authenticationCode,
+        const QByteArray &salt,
+        const QVariantMap &parameters,
+        QByteArray *key)
+{
+    if (parameters.isEmpty()) {
+        return deriveKeyFromCode(authenticationCode, salt, key);
+    }
+    return Sailfish::Secrets::Result(Sailfish::Secrets::Result::OperationNotSupportedError,
+                                     QStringLiteral("Key derivation parameters are not supported by this plugin"));
+}
+
 /*!
  * \fn EncryptionPlugin::encryptSecret(const QByteArray &plaintext, const QByteArray &key, QByteArray *encrypted)
  * \brief Encrypt the given \a plaintext with the given \a key and write
@@ -374,6 +417,22 @@ EncryptionPlugin::~EncryptionPlugin()
  * \value OperatorAnd A secret matches the filter if its filter data contains all of the key-value pairs specified in the filter
  */
 
+/*!
+ * \enum StoragePlugin::FilterMatch
+ *
+ * This enum defines the ways in which a filter value may be compared to a stored value for filter operations
+ *
+ * \value MatchExact A stored value matches a filter value if they are equal, ignoring case
+ * \value MatchPrefix A stored value matches a filter value if it starts with the filter value, ignoring case
+ * \value MatchGlob A stored value matches a filter value if it matches the wildcard pattern given by the filter value, ignoring case
+ * \value MatchFullText A stored value matches a filter value if it contains every word of the filter value, ignoring case
+ *
+ * Plugins which do not support a requested match should return a
+ * Sailfish::Secrets::Result with the result code set to
+ * Sailfish::Secrets::Result::Failed and the error code set to
+ * Sailfish::Secrets::Result::OperationNotSupportedError from findSecrets().
+ */
+
 /*!
  * \brief Constructs a new StoragePlugin instance
  */
@@ -389,6 +448,76 @@ StoragePlugin::~StoragePlugin()
 {
 }
 
+/*!
+ * \brief Returns the words contained in the given \a value, folded to lower case
+ *
+ * Words are maximal sequences of letters and digits.  This is the tokenization
+ * used by \c MatchFullText matching.
+ */
+QStringList StoragePlugin::filterWords(const QString &value)
+{
+    return value.toLower().split(QRegExp(QStringLiteral("[^\\w]+")), QString::SkipEmptyParts);
+}
+
+/*!
+ * \brief Returns true if the stored \a value matches the \a filterValue according
+ *        to the given \a filterMatch
+ *
+ * Returns false if the match is not known.
+ */
+bool StoragePlugin::filterValueMatches(const QString &value, const QString &filterValue, StoragePlugin::FilterMatch filterMatch)
+{
+    switch (filterMatch) {
+        case StoragePlugin::MatchExact:
+            return value.compare(filterValue, Qt::CaseInsensitive) == 0;
+        case StoragePlugin::MatchPrefix:
+            return value.startsWith(filterValue, Qt::CaseInsensitive);
+        case StoragePlugin::MatchGlob:
+            return QRegExp(filterValue, Qt::CaseInsensitive, QRegExp::Wildcard).exactMatch(value);
+        case StoragePlugin::MatchFullText: {
+            const QStringList valueWords = StoragePlugin::filterWords(value);
+            const QStringList filterValueWords = StoragePlugin::filterWords(filterValue);
+            for (const QString &word : filterValueWords) {
+                if (!valueWords.contains(word)) {
+                    return false;
+                }
+            }
+            return !filterValueWords.isEmpty();
+        }
+        default:
+            return false;
+    }
+}
+
+/*!
+ * \brief Returns true if the stored \a filterData matches the \a filter according
+ *        to the given \a filterOperator and \a filterMatch
+ *
+ * This is the reference implementation of the filter semantics described by
+ * Sailfish::Secrets::FindSecretsRequest, which storage plugins may use to
+ * evaluate findSecrets() against the filter data of each stored secret.
+ */
+bool StoragePlugin::filterDataMatches(const Secret::FilterData &filterData, const Secret::FilterData &filter, StoragePlugin::FilterOperator filterOperator, StoragePlugin::FilterMatch filterMatch)
+{
+    const bool requireAll = filterOperator == StoragePlugin::OperatorAnd;
+    for (Secret::FilterData::const_iterator fit = filter.constBegin(); fit != filter.constEnd(); fit++) {
+        bool matched = false;
+        for (Secret::FilterData::const_iterator mit = filterData.constBegin(); mit != filterData.constEnd(); mit++) {
+            if (fit.key().compare(mit.key(), Qt::CaseInsensitive) == 0) {
+                // found the metadata field for this filter field
+                matched = StoragePlugin::filterValueMatches(mit.value(), fit.value(), filterMatch);
+                break;
+            }
+        }
+        if (matched && !requireAll) {
+            return true;
+        } else if (!matched && requireAll) {
+            return false;
+        }
+    }
+    return requireAll && !filter.isEmpty();
+}
+
 /*!
  * \fn StoragePlugin::storageType() const
  * \brief Returns the type of storage which is exposed by the plugin
@@ -553,6 +682,27 @@ StoragePlugin::~StoragePlugin()
  * Sailfish::Secrets::Result::DatabaseError.
  */
 
+/*!
+ * \brief Write the filter data associated with the secret identified by the
+ *        given \a secretName in the collection identified by the given
+ *        \a collectionName into the \a filterData out-parameter.
+ *
+ * This is used when a client requests only the metadata of a secret, and
+ * the errors which should be reported are the same as for getSecret().
+ *
+ * The default implementation calls getSecret() and discards the secret data.
+ * Plugins which store the filter data separately from the secret data should
+ * reimplement this function so that the secret data is never read.
+ */
+Sailfish::Secrets::Result StoragePlugin::getSecretFilterData(
+        const QString &collectionName,
+        const QString &secretName,
+        Sailfish::Secrets::Secret::FilterData *filterData)
+{
+    QByteArray secret;
+    return getSecret(collectionName, secretName, &secret, filterData);
+}
+
 /*!
  * \fn StoragePlugin::secretNames(const QString &collectionName, QStringList *secretNames)
  * \brief Write the names of secrets which are stored by the plugin in the
@@ -628,6 +778,57 @@ StoragePlugin::~StoragePlugin()
  * Sailfish::Secrets::Result::DatabaseError.
  */
 
+/*!
+ * \brief Writes the name of each secret in the collection with the specified
+ *        \a collectionName into the out-parameter \a secretNames if that
+ *        secret has filter data matching the given \a filter according to
+ *        the specified \a filterOperator and \a filterMatch.
+ *
+ * The errors which should be reported are the same as for the findSecrets()
+ * overload without a \a filterMatch, and if the plugin does not support the
+ * requested \a filterMatch it should return a Sailfish::Secrets::Result with
+ * the result code set to Sailfish::Secrets::Result::Failed and the error code
+ * set to Sailfish::Secrets::Result::OperationNotSupportedError.
+ *
+ * The default implementation calls the findSecrets() overload without a
+ * \a filterMatch for \c MatchExact, and otherwise compares the filter data
+ * of every secret in the collection via filterDataMatches().  Plugins which
+ * can narrow the candidate secrets (e.g. with an index) should reimplement
+ * this function.
+ */
+Sailfish::Secrets::Result StoragePlugin::findSecrets(
+        const QString &collectionName,
+        const Sailfish::Secrets::Secret::FilterData &filter,
+        Sailfish::Secrets::StoragePlugin::FilterOperator filterOperator,
+        Sailfish::Secrets::StoragePlugin::FilterMatch filterMatch,
+        QStringList *secretNames)
+{
+    if (filterMatch == StoragePlugin::MatchExact) {
+        return findSecrets(collectionName, filter, filterOperator, secretNames);
+    }
+
+    QStringList names;
+    Sailfish::Secrets::Result result = this->secretNames(collectionName, &names);
+    if (result.code() != Sailfish::Secrets::Result::Succeeded) {
+        return result;
+    }
+
+    QStringList matchingNames;
+    for (const QString &secretName : names) {
+        Sailfish::Secrets::Secret::FilterData filterData;
+        result = getSecretFilterData(collectionName, secretName, &filterData);
+        if (result.code() != Sailfish::Secrets::Result::Succeeded) {
+            return result;
+        }
+        if (StoragePlugin::filterDataMatches(filterData, filter, filterOperator, filterMatch)) {
+            matchingNames.append(secretName);
+        }
+    }
+
+    *secretNames = matchingNames;
+    return Sailfish::Secrets::Result(Sailfish::Secrets::Result::Succeeded);
+}
+
 /*!
  * \fn StoragePlugin::removeSecret(const QString &collectionName, const QString &secretName)
  * \brief Remove the secret identified by the given \a secretName within the
@@ -884,6 +1085,47 @@ EncryptedStoragePlugin::~EncryptedStoragePlugin()
  * Sailfish::Secrets::Result::SecretsPluginIsLockedError.
  */
 
+/*!
+ * \brief Derive an encryption key from the given \a authenticationCode and
+ *        \a salt using the key derivation function and cost described by
+ *        the given \a parameters, and write it to the out-parameter \a key.
+ *
+ * The \a parameters may contain the following values:
+ * \list
+ * \li "keyDerivationFunction": one of "pbkdf2", "scrypt" or "argon2id"
+ * \li "iterations": the iteration count for PBKDF2, the CPU/memory cost
+ *     (a power of two) for scrypt, or the number of passes for Argon2id
+ * \li "memorySize": the amount of memory in KiB used by Argon2id
+ * \li "parallelism": the number of lanes used by scrypt and Argon2id,
+ *     which plugins may but need not compute concurrently
+ * \endlist
+ *
+ * A key derived with empty \a parameters must be identical to the key
+ * derived via deriveKeyFromCode().  The errors which should be reported
+ * are the same as for that function, and if the plugin does not support
+ * the requested key derivation function or cost it should return a
+ * Sailfish::Secrets::Result with the result code set to
+ * Sailfish::Secrets::Result::Failed and the error code set to
+ * Sailfish::Secrets::Result::OperationNotSupportedError.
+ *
+ * The default implementation calls deriveKeyFromCode() if the \a parameters
+ * are empty, and otherwise returns OperationNotSupportedError.
+ * Plugins which support memory-hard key derivation functions should
+ * reimplement this function.
+ */
+Sailfish::Secrets::Result EncryptedStoragePlugin::deriveKeyFromCodeWithParameters(
+        const QByteArray &authenticationCode,
+        const QByteArray &salt,
+        const QVariantMap &parameters,
+        QByteArray *key)
+{
+    if (parameters.isEmpty()) {
+        return deriveKeyFromCode(authenticationCode, salt, key);
+    }
+    return Sailfish::Secrets::Result(Sailfish::Secrets::Result::OperationNotSupportedError,
+                                     QStringLiteral("Key derivation parameters are not supported by this plugin"));
+}
+
 /*!
  * \fn EncryptedStoragePlugin::setEncryptionKey(const QString &collectionName, const QByteArray &key)
  * \brief Unlock the collection identified by the given \a collectionName
@@ -1031,6 +1273,27 @@ EncryptedStoragePlugin::~EncryptedStoragePlugin()
  * Sailfish::Secrets::Result::DatabaseError.
  */
 
+/*!
+ * \brief Write the filter data associated with the secret identified by the
+ *        given \a secretName in the collection identified by the given
+ *        \a collectionName into the \a filterData out-parameter.
+ *
+ * This is used when a client requests only the metadata of a secret, and
+ * the errors which should be reported are the same as for getSecret().
+ *
+ * The default implementation calls getSecret() and discards the secret data.
+ * Plugins which can read the filter data without decrypting the secret data
+ * should reimplement this function.
+ */
+Sailfish::Secrets::Result EncryptedStoragePlugin::getSecretFilterData(
+        const QString &collectionName,
+        const QString &secretName,
+        Sailfish::Secrets::Secret::FilterData *filterData)
+{
+    QByteArray secret;
+    return getSecret(collectionName, secretName, &secret, filterData);
+}
+
 /*!
  * \fn EncryptedStoragePlugin::secretNames(const QString &collectionName, QStringList *secretNames)
  * \brief Retrive the names of secrets stored in the collection identified
@@ -1096,6 +1359,57 @@ EncryptedStoragePlugin::~EncryptedStoragePlugin()
  * Sailfish::Secrets::Result::DatabaseError.
  */
 
+/*!
+ * \brief Retrieve the names of secrets in the collection identified by the
+ *        given \a collectionName which match the given \a filter according
+ *        to the specified \a filterOperator and \a filterMatch, and return
+ *        them in the \a identifiers out-parameter.
+ *
+ * The errors which should be reported are the same as for the findSecrets()
+ * overload without a \a filterMatch, and if the plugin does not support the
+ * requested \a filterMatch it should return a Sailfish::Secrets::Result with
+ * the result code set to Sailfish::Secrets::Result::Failed and the error code
+ * set to Sailfish::Secrets::Result::OperationNotSupportedError.
+ *
+ * The default implementation calls the findSecrets() overload without a
+ * \a filterMatch for \c MatchExact, and otherwise compares the filter data
+ * of every secret in the collection via StoragePlugin::filterDataMatches().
+ * Plugins which can narrow the candidate secrets (e.g. with an index) should
+ * reimplement this function.
+ */
+Sailfish::Secrets::Result EncryptedStoragePlugin::findSecrets(
+        const QString &collectionName,
+        const Sailfish::Secrets::Secret::FilterData &filter,
+        Sailfish::Secrets::StoragePlugin::FilterOperator filterOperator,
+        Sailfish::Secrets::StoragePlugin::FilterMatch filterMatch,
+        QVector<Sailfish::Secrets::Secret::Identifier> *identifiers)
+{
+    if (filterMatch == StoragePlugin::MatchExact) {
+        return findSecrets(collectionName, filter, filterOperator, identifiers);
+    }
+
+    QStringList names;
+    Sailfish::Secrets::Result result = secretNames(collectionName, &names);
+    if (result.code() != Sailfish::Secrets::Result::Succeeded) {
+        return result;
+    }
+
+    QVector<Sailfish::Secrets::Secret::Identifier> matchingIdentifiers;
+    for (const QString &secretName : names) {
+        Sailfish::Secrets::Secret::FilterData filterData;
+        result = getSecretFilterData(collectionName, secretName, &filterData);
+        if (result.code() != Sailfish::Secrets::Result::Succeeded) {
+            return result;
+        }
+        if (StoragePlugin::filterDataMatches(filterData, filter, filterOperator, filterMatch)) {
+            matchingIdentifiers.append(Sailfish::Secrets::Secret::Identifier(secretName, collectionName, name()));
+        }
+    }
+
+    *identifiers = matchingIdentifiers;
+    return Sailfish::Secrets::Result(Sailfish::Secrets::Result::Succeeded);
+}
+
 /*!
  * \fn EncryptedStoragePlugin::removeSecret(const QString &collectionName, const QString &secretName)
  * \brief Remove the secret (and associated filter data) identified by the
@@ -19,11 +19,12 @@
 #include <QtCore/QMap>
 #include <QtCore/QByteArray>
 #include <QtCore/QVector>
+#include <QtCore/QVariantMap>
 #include <QtCore/QLoggingCategory>
 
-#define Sailfish_Secrets_StoragePlugin_IID "org.sailfishos.secrets.StoragePlugin/1.0"
-#define Sailfish_Secrets_EncryptionPlugin_IID "org.sailfishos.secrets.EncryptionPlugin/1.0"
-#define Sailfish_Secrets_EncryptedStoragePlugin_IID "org.sailfishos.secrets.EncryptedStoragePlugin/1.0"
+#define Sailfish_Secrets_StoragePlugin_IID "org.sailfishos.secrets.StoragePlugin/1.1"
+#define Sailfish_Secrets_EncryptionPlugin_IID "org.sailfishos.secrets.EncryptionPlugin/1.1"
+#define Sailfish_Secrets_EncryptedStoragePlugin_IID "org.sailfishos.secrets.EncryptedStoragePlugin/1.1"
 #define Sailfish_Secrets_AuthenticationPlugin_IID "org.sailfishos.secrets.AuthenticationPlugin/1.0"
 
 SAILFISH_SECRETS_API Q_DECLARE_LOGGING_CATEGORY(lcSailfishSecretsPlugin)
@@ -78,6 +79,9 @@ public:
     virtual Sailfish::Secrets::Result deriveKeyFromCode(const QByteArray &authenticationCode, const QByteArray &salt, QByteArray *key) = 0;
     virtual Sailfish::Secrets::Result encryptSecret(const QByteArray &plaintext, const QByteArray &key, QByteArray *encrypted) = 0;
     virtual Sailfish::Secrets::Result decryptSecret(const QByteArray &encrypted, const QByteArray &key, QByteArray *plaintext) = 0;
+
+    // added in version 1.1 of the interface, with default implementations.
+    virtual Sailfish::Secrets::Result deriveKeyFromCodeWithParameters(const QByteArray &authenticationCode, const QByteArray &salt, const QVariantMap &parameters, QByteArray *key);
 };
 
 class SAILFISH_SECRETS_API StoragePlugin : public virtual Sailfish::Secrets::PluginBase
@@ -96,9 +100,20 @@ public:
         OperatorAnd = SecretManager::OperatorAnd
     };
 
+    enum FilterMatch {
+        MatchExact    = SecretManager::MatchExact,
+        MatchPrefix   = SecretManager::MatchPrefix,
+        MatchGlob     = SecretManager::MatchGlob,
+        MatchFullText = SecretManager::MatchFullText
+    };
+
     StoragePlugin();
     virtual ~StoragePlugin();
 
+    static bool filterValueMatches(const QString &value, const QString &filterValue, Sailfish::Secrets::StoragePlugin::FilterMatch filterMatch);
+    static bool filterDataMatches(const Sailfish::Secrets::Secret::FilterData &filterData, const Sailfish::Secrets::Secret::FilterData &filter, Sailfish::Secrets::StoragePlugin::FilterOperator filterOperator, Sailfish::Secrets::StoragePlugin::FilterMatch filterMatch);
+    static QStringList filterWords(const QString &value);
+
     virtual Sailfish::Secrets::StoragePlugin::StorageType storageType() const = 0;
 
     virtual Sailfish::Secrets::Result collectionNames(QStringList *names) = 0;
@@ -116,6 +131,10 @@ public:
             const QByteArray &oldkey,
             const QByteArray &newkey,
             Sailfish::Secrets::EncryptionPlugin *plugin) = 0;
+
+    // added in version 1.1 of the interface, with default implementations.
+    virtual Sailfish::Secrets::Result getSecretFilterData(const QString &collectionName, const QString &secretName, Sailfish::Secrets::Secret::FilterData *filterData);
+    virtual Sailfish::Secrets::Result findSecrets(const QString &collectionName, const Sailfish::Secrets::Secret::FilterData &filter, Sailfish::Secrets::StoragePlugin::FilterOperator filterOperator, Sailfish::Secrets::StoragePlugin::FilterMatch filterMatch, QStringList *secretNames);
 };
 
 class SAILFISH_SECRETS_API EncryptedStoragePlugin : public virtual Sailfish::Secrets::PluginBase
@@ -148,6 +167,11 @@ public:
     virtual Sailfish::Secrets::Result accessSecret(const QString &secretName, const QByteArray &key, QByteArray *secret, Sailfish::Secrets::Secret::FilterData *filterData) = 0;
     virtual Sailfish::Secrets::Result removeSecret(const QString &secretName) = 0;
     virtual Sailfish::Secrets::Result reencryptSecret(const QString &secretName, const QByteArray &oldkey, const QByteArray &newkey) = 0;
+
+    // added in version 1.1 of the interface, with default implementations.
+    virtual Sailfish::Secrets::Result deriveKeyFromCodeWithParameters(const QByteArray &authenticationCode, const QByteArray &salt, const QVariantMap &parameters, QByteArray *key);
+    virtual Sailfish::Secrets::Result getSecretFilterData(const QString &collectionName, const QString &secretName, Sailfish::Secrets::Secret::FilterData *filterData);
+    virtual Sailfish::Secrets::Result findSecrets(const QString &collectionName, const Sailfish::Secrets::Secret::FilterData &filter, Sailfish::Secrets::StoragePlugin::FilterOperator filterOperator, Sailfish::Secrets::StoragePlugin::FilterMatch filterMatch, QVector<Sailfish::Secrets::Secret::Identifier> *identifiers);
 };
 
 class SAILFISH_SECRETS_API AuthenticationPlugin : public QObject, public virtual PluginBase
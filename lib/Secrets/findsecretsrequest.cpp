@@ -18,7 +18,9 @@
 using namespace Sailfish::Secrets;
 
 FindSecretsRequestPrivate::FindSecretsRequestPrivate()
-    : m_userInteractionMode(SecretManager::PreventInteraction)
+    : m_filterMatch(SecretManager::MatchExact)
+    , m_userInteractionMode(SecretManager::PreventInteraction)
+    , m_searchScope(FindSecretsRequest::CollectionSearch)
     , m_status(Request::Inactive)
 {
 }
@@ -30,7 +32,7 @@ FindSecretsRequestPrivate::FindSecretsRequestPrivate()
  *
  * The filter specifies metadata field/value pairs, and will be matched against
  * secrets in the storage plugin identified by the specified storagePluginName()
- * according to the given filterOperator().
+ * according to the given filterOperator() and filterMatch().
  *
  * If a collection() is specified to search within, and the calling application is
  * the creator of the collection, or alternatively if the user has granted the
@@ -57,6 +59,13 @@ FindSecretsRequestPrivate::FindSecretsRequestPrivate()
  * which the application owns (that is, created) or has been granted explicit permission
  * to access will be matched against the filter and potentially returned.
  *
+ * If the searchScope() is \c StoragePluginSearch or \c AllStoragePluginsSearch then
+ * every collection of the storage plugin (or of all storage plugins) is searched
+ * in a single request, and the collectionName() is ignored.  Such searches never
+ * trigger any user interaction: collections which the application may not access,
+ * or which are currently locked, are skipped and reported via skippedCollections()
+ * and skippedCollectionResults() instead of failing the request.
+ *
  * An example of searching for secrets in a collection which match a filter follows:
  *
  * \code
@@ -210,6 +219,50 @@ void FindSecretsRequest::setFilterOperator(Sailfish::Secrets::SecretManager::Fil
     }
 }
 
+/*!
+ * \brief Returns the way in which filter values will be compared to the values stored for secrets
+ */
+Sailfish::Secrets::SecretManager::FilterMatch FindSecretsRequest::filterMatch() const
+{
+    Q_D(const FindSecretsRequest);
+    return d->m_filterMatch;
+}
+
+/*!
+ * \brief Sets the way in which filter values will be compared to the values stored for secrets to \a match
+ *
+ * By default (\c MatchExact) a stored value matches the filter value if the two are
+ * equal, ignoring case.
+ *
+ * If the match is \c MatchPrefix then a stored value matches if it starts with the
+ * filter value, ignoring case.
+ *
+ * If the match is \c MatchGlob then the filter value is interpreted as a wildcard
+ * pattern (where \c * matches any sequence of characters, \c ? matches any single
+ * character, and \c [...] matches a set of characters) which must match the entire
+ * stored value, ignoring case.
+ *
+ * If the match is \c MatchFullText then a stored value matches if every word in the
+ * filter value also occurs as a word in the stored value, ignoring case.  Storage
+ * plugins which maintain a full-text index of filter data will use it to evaluate
+ * such searches.
+ *
+ * Storage plugins which do not support the given match will cause the request to
+ * fail with \c Result::OperationNotSupportedError.
+ */
+void FindSecretsRequest::setFilterMatch(Sailfish::Secrets::SecretManager::FilterMatch match)
+{
+    Q_D(FindSecretsRequest);
+    if (d->m_status != Request::Active && d->m_filterMatch != match) {
+        d->m_filterMatch = match;
+        if (d->m_status == Request::Finished) {
+            d->m_status = Request::Inactive;
+            emit statusChanged();
+        }
+        emit filterMatchChanged();
+    }
+}
+
 /*!
  * \brief Returns the user interaction mode required when filtering the secrets (e.g. if a custom lock code must be requested from the user)
  */
@@ -235,6 +288,42 @@ void FindSecretsRequest::setUserInteractionMode(SecretManager::UserInteractionMo
     }
 }
 
+/*!
+ * \brief Returns the scope of the search
+ */
+FindSecretsRequest::SearchScope FindSecretsRequest::searchScope() const
+{
+    Q_D(const FindSecretsRequest);
+    return d->m_searchScope;
+}
+
+/*!
+ * \brief Sets the scope of the search to \a scope
+ *
+ * By default (\c CollectionSearch) the collection identified by collectionName()
+ * (or the standalone secrets, if no collection name is set) in the storage plugin
+ * identified by storagePluginName() is searched.
+ *
+ * If the scope is \c StoragePluginSearch then all collections in the storage plugin
+ * identified by storagePluginName() are searched; if that name is empty, the
+ * request will fail with \c Result::InvalidExtensionPluginError.
+ *
+ * If the scope is \c AllStoragePluginsSearch then all collections in all
+ * storage plugins are searched by a single request, and the results merged.
+ */
+void FindSecretsRequest::setSearchScope(FindSecretsRequest::SearchScope scope)
+{
+    Q_D(FindSecretsRequest);
+    if (d->m_status != Request::Active && d->m_searchScope != scope) {
+        d->m_searchScope = scope;
+        if (d->m_status == Request::Finished) {
+            d->m_status = Request::Inactive;
+            emit statusChanged();
+        }
+        emit searchScopeChanged();
+    }
+}
+
 /*!
  * \brief Returns the identifiers of secrets which matched the filter.
  */
@@ -244,6 +333,32 @@ QVector<Secret::Identifier> FindSecretsRequest::identifiers() const
     return d->m_identifiers;
 }
 
+/*!
+ * \brief Returns the identifiers of the collections which were not searched
+ *
+ * Only plugin-wide searches (see searchScope()) skip collections.  The secret
+ * name of each identifier is empty, and the collection name is also empty if the
+ * collections of the storage plugin could not be enumerated at all.
+ */
+QVector<Secret::Identifier> FindSecretsRequest::skippedCollections() const
+{
+    Q_D(const FindSecretsRequest);
+    return d->m_skippedCollections;
+}
+
+/*!
+ * \brief Returns the reasons for which each of the skippedCollections() was not searched
+ *
+ * For example, a collection which is currently locked is reported with
+ * \c Result::CollectionIsLockedError, and a collection owned by another application
+ * with \c Result::PermissionsError.
+ */
+QVector<Result> FindSecretsRequest::skippedCollectionResults() const
+{
+    Q_D(const FindSecretsRequest);
+    return d->m_skippedCollectionResults;
+}
+
 Request::Status FindSecretsRequest::status() const
 {
     Q_D(const FindSecretsRequest);
@@ -282,17 +397,24 @@ void FindSecretsRequest::startRequest()
             emit resultChanged();
         }
 
+        if (d->m_searchScope != FindSecretsRequest::CollectionSearch) {
+            startScopedSearch();
+            return;
+        }
+
         QDBusPendingReply<Result, QVector<Secret::Identifier> > reply;
         if (d->m_collectionName.isEmpty()) {
             reply = d->m_manager->d_ptr->findSecrets(d->m_storagePluginName,
                                                      d->m_filter,
                                                      d->m_filterOperator,
+                                                     d->m_filterMatch,
                                                      d->m_userInteractionMode);
         } else {
             reply = d->m_manager->d_ptr->findSecrets(d->m_collectionName,
                                                      d->m_storagePluginName,
                                                      d->m_filter,
                                                      d->m_filterOperator,
+                                                     d->m_filterMatch,
                                                      d->m_userInteractionMode);
         }
 
@@ -329,6 +451,68 @@ void FindSecretsRequest::startRequest()
     }
 }
 
+void FindSecretsRequest::startScopedSearch()
+{
+    Q_D(FindSecretsRequest);
+    if (d->m_searchScope == FindSecretsRequest::StoragePluginSearch
+            && d->m_storagePluginName.isEmpty()) {
+        d->m_status = Request::Finished;
+        d->m_result = Result(Result::InvalidExtensionPluginError,
+                             QLatin1String("Empty storage plugin name given"));
+        emit statusChanged();
+        emit resultChanged();
+        return;
+    }
+
+    QDBusPendingReply<Result, QVector<Secret::Identifier>, QVector<Secret::Identifier>, QVector<Result> > reply
+            = d->m_manager->d_ptr->findSecretsInCollections(
+                    d->m_searchScope == FindSecretsRequest::StoragePluginSearch
+                            ? d->m_storagePluginName
+                            : QString(),
+                    d->m_filter,
+                    d->m_filterOperator,
+                    d->m_filterMatch);
+
+    if (!reply.isValid() && !reply.error().message().isEmpty()) {
+        d->m_status = Request::Finished;
+        d->m_result = Result(Result::SecretManagerNotInitializedError,
+                             reply.error().message());
+        emit statusChanged();
+        emit resultChanged();
+    } else if (reply.isFinished()
+            // work around a bug in QDBusAbstractInterface / QDBusConnection...
+            && reply.argumentAt<0>().code() != Sailfish::Secrets::Result::Succeeded) {
+        d->m_status = Request::Finished;
+        d->m_result = reply.argumentAt<0>();
+        d->m_identifiers = reply.argumentAt<1>();
+        d->m_skippedCollections = reply.argumentAt<2>();
+        d->m_skippedCollectionResults = reply.argumentAt<3>();
+        emit statusChanged();
+        emit resultChanged();
+        emit identifiersChanged();
+        emit skippedCollectionsChanged();
+        emit skippedCollectionResultsChanged();
+    } else {
+        d->m_watcher.reset(new QDBusPendingCallWatcher(reply));
+        connect(d->m_watcher.data(), &QDBusPendingCallWatcher::finished,
+                [this] {
+            QDBusPendingCallWatcher *watcher = this->d_ptr->m_watcher.take();
+            QDBusPendingReply<Result, QVector<Secret::Identifier>, QVector<Secret::Identifier>, QVector<Result> > reply = *watcher;
+            this->d_ptr->m_status = Request::Finished;
+            this->d_ptr->m_result = reply.argumentAt<0>();
+            this->d_ptr->m_identifiers = reply.argumentAt<1>();
+            this->d_ptr->m_skippedCollections = reply.argumentAt<2>();
+            this->d_ptr->m_skippedCollectionResults = reply.argumentAt<3>();
+            watcher->deleteLater();
+            emit this->statusChanged();
+            emit this->resultChanged();
+            emit this->identifiersChanged();
+            emit this->skippedCollectionsChanged();
+            emit this->skippedCollectionResultsChanged();
+        });
+    }
+}
+
 void FindSecretsRequest::waitForFinished()
 {
     Q_D(FindSecretsRequest);
@@ -12,6 +12,7 @@
 #include "Secrets/request.h"
 #include "Secrets/secret.h"
 #include "Secrets/secretmanager.h"
+#include "Secrets/result.h"
 
 #include <QtCore/QObject>
 #include <QtCore/QScopedPointer>
@@ -30,10 +31,21 @@ class SAILFISH_SECRETS_API FindSecretsRequest : public Sailfish::Secrets::Reques
     Q_PROPERTY(QString storagePluginName READ storagePluginName WRITE setStoragePluginName NOTIFY storagePluginNameChanged)
     Q_PROPERTY(Sailfish::Secrets::Secret::FilterData filter READ filter WRITE setFilter NOTIFY filterChanged)
     Q_PROPERTY(Sailfish::Secrets::SecretManager::FilterOperator filterOperator READ filterOperator WRITE setFilterOperator NOTIFY filterOperatorChanged)
+    Q_PROPERTY(Sailfish::Secrets::SecretManager::FilterMatch filterMatch READ filterMatch WRITE setFilterMatch NOTIFY filterMatchChanged)
     Q_PROPERTY(Sailfish::Secrets::SecretManager::UserInteractionMode userInteractionMode READ userInteractionMode WRITE setUserInteractionMode NOTIFY userInteractionModeChanged)
+    Q_PROPERTY(SearchScope searchScope READ searchScope WRITE setSearchScope NOTIFY searchScopeChanged)
     Q_PROPERTY(QVector<Sailfish::Secrets::Secret::Identifier> identifiers READ identifiers NOTIFY identifiersChanged)
+    Q_PROPERTY(QVector<Sailfish::Secrets::Secret::Identifier> skippedCollections READ skippedCollections NOTIFY skippedCollectionsChanged)
+    Q_PROPERTY(QVector<Sailfish::Secrets::Result> skippedCollectionResults READ skippedCollectionResults NOTIFY skippedCollectionResultsChanged)
 
 public:
+    enum SearchScope {
+        CollectionSearch = 0,
+        StoragePluginSearch,
+        AllStoragePluginsSearch
+    };
+    Q_ENUM(SearchScope)
+
     FindSecretsRequest(QObject *parent = Q_NULLPTR);
     ~FindSecretsRequest();
 
@@ -49,10 +61,18 @@ public:
     Sailfish::Secrets::SecretManager::FilterOperator filterOperator() const;
     void setFilterOperator(Sailfish::Secrets::SecretManager::FilterOperator op);
 
+    Sailfish::Secrets::SecretManager::FilterMatch filterMatch() const;
+    void setFilterMatch(Sailfish::Secrets::SecretManager::FilterMatch match);
+
     Sailfish::Secrets::SecretManager::UserInteractionMode userInteractionMode() const;
     void setUserInteractionMode(Sailfish::Secrets::SecretManager::UserInteractionMode mode);
 
+    SearchScope searchScope() const;
+    void setSearchScope(SearchScope scope);
+
     QVector<Sailfish::Secrets::Secret::Identifier> identifiers() const;
+    QVector<Sailfish::Secrets::Secret::Identifier> skippedCollections() const;
+    QVector<Sailfish::Secrets::Result> skippedCollectionResults() const;
 
     Sailfish::Secrets::Request::Status status() const Q_DECL_OVERRIDE;
     Sailfish::Secrets::Result result() const Q_DECL_OVERRIDE;
@@ -68,10 +88,16 @@ Q_SIGNALS:
     void storagePluginNameChanged();
     void filterChanged();
     void filterOperatorChanged();
+    void filterMatchChanged();
     void userInteractionModeChanged();
+    void searchScopeChanged();
     void identifiersChanged();
+    void skippedCollectionsChanged();
+    void skippedCollectionResultsChanged();
 
 private:
+    void startScopedSearch();
+
     QScopedPointer<FindSecretsRequestPrivate> const d_ptr;
     Q_DECLARE_PRIVATE(FindSecretsRequest)
 };
@@ -11,6 +11,7 @@
 #include "Secrets/secretsglobal.h"
 #include "Secrets/secretmanager.h"
 #include "Secrets/secret.h"
+#include "Secrets/findsecretsrequest.h"
 
 #include <QtCore/QPointer>
 #include <QtCore/QScopedPointer>
@@ -35,8 +36,12 @@ public:
     QString m_storagePluginName;
     Sailfish::Secrets::Secret::FilterData m_filter;
     Sailfish::Secrets::SecretManager::FilterOperator m_filterOperator;
+    Sailfish::Secrets::SecretManager::FilterMatch m_filterMatch;
     Sailfish::Secrets::SecretManager::UserInteractionMode m_userInteractionMode;
+    Sailfish::Secrets::FindSecretsRequest::SearchScope m_searchScope;
     QVector<Sailfish::Secrets::Secret::Identifier> m_identifiers;
+    QVector<Sailfish::Secrets::Secret::Identifier> m_skippedCollections;
+    QVector<Sailfish::Secrets::Result> m_skippedCollectionResults;
 
     QScopedPointer<QDBusPendingCallWatcher> m_watcher;
     Sailfish::Secrets::Request::Status m_status;
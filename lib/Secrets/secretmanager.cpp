@@ -20,6 +20,8 @@
 #include <QtDBus/QDBusMetaType>
 
 #include <QtCore/QPointer>
+#include <QtCore/QAtomicInteger>
+#include <QtCore/QCoreApplication>
 #include <QtCore/QLoggingCategory>
 #include <QtCore/QStandardPaths>
 #include <QtCore/QDir>
@@ -67,6 +69,30 @@ SecretManagerPrivate::~SecretManagerPrivate()
     m_interface = Q_NULLPTR;
 }
 
+/*!
+ * \internal
+ * \brief Sends the \a method call with the given \a arguments to the daemon
+ *
+ * A newly generated trace id is appended to the arguments of the call.
+ * The daemon associates it with the request so that all of the work it
+ * performs on behalf of the request (including plugin calls and user
+ * interaction) can be correlated.  The trace id is unique per client process.
+ */
+QDBusPendingCall
+SecretManagerPrivate::tracedAsyncCall(
+        const QString &method,
+        const QVariantList &arguments)
+{
+    static QAtomicInteger<quint32> traceCounter;
+    const quint64 traceId = (quint64(QCoreApplication::applicationPid()) << 32)
+                          | quint64(traceCounter.fetchAndAddRelaxed(1) & 0x7fffffff);
+
+    qCDebug(lcSailfishSecrets) << "Calling" << method << "with trace id:" << QString::number(traceId, 16);
+    QVariantList tracedArguments(arguments);
+    tracedArguments.append(QVariant::fromValue<quint64>(traceId));
+    return m_interface->asyncCallWithArgumentList(method, tracedArguments);
+}
+
 Result
 SecretManagerPrivate::registerInteractionService(
         SecretManager::UserInteractionMode mode,
@@ -110,7 +136,7 @@ SecretManagerPrivate::getPluginInfo()
                       QVector<PluginInfo>,
                       QVector<PluginInfo>,
                       QVector<PluginInfo> > reply
-            = m_interface->asyncCall(QStringLiteral("getPluginInfo"));
+            = tracedAsyncCall(QStringLiteral("getPluginInfo"));
     return reply;
 }
 
@@ -131,7 +157,7 @@ SecretManagerPrivate::getHealthInfo()
     QDBusPendingReply<Sailfish::Secrets::Result,
                       HealthCheckRequest::Health,
                       HealthCheckRequest::Health> reply
-            = m_interface->asyncCall(QStringLiteral("getHealthInfo"));
+            = tracedAsyncCall(QStringLiteral("getHealthInfo"));
     return reply;
 }
 
@@ -146,7 +172,7 @@ SecretManagerPrivate::userInput(
     }
 
     QDBusPendingReply<Result> reply
-            = m_interface->asyncCallWithArgumentList(
+            = tracedAsyncCall(
                 QStringLiteral("userInput"),
                 QVariantList() << QVariant::fromValue<InteractionParameters>(uiParams));
     return reply;
@@ -164,7 +190,7 @@ SecretManagerPrivate::collectionNames(
     }
 
     QDBusPendingReply<Result, QVariantMap> reply
-            = m_interface->asyncCallWithArgumentList(
+            = tracedAsyncCall(
                 QStringLiteral("collectionNames"),
                 QVariantList() << QVariant::fromValue<QString>(storagePluginName));
     return reply;
@@ -185,7 +211,7 @@ SecretManagerPrivate::createCollection(
     }
 
     QDBusPendingReply<Result> reply
-            = m_interface->asyncCallWithArgumentList(
+            = tracedAsyncCall(
                 QStringLiteral("createCollection"),
                 QVariantList() << QVariant::fromValue<QString>(collectionName)
                                << QVariant::fromValue<QString>(storagePluginName)
@@ -220,7 +246,7 @@ SecretManagerPrivate::createCollection(
     }
 
     QDBusPendingReply<Result> reply
-            = m_interface->asyncCallWithArgumentList(
+            = tracedAsyncCall(
                 QStringLiteral("createCollection"),
                 QVariantList() << QVariant::fromValue<QString>(collectionName)
                                << QVariant::fromValue<QString>(storagePluginName)
@@ -254,7 +280,7 @@ SecretManagerPrivate::deleteCollection(
     }
 
     QDBusPendingReply<Result> reply
-            = m_interface->asyncCallWithArgumentList(
+            = tracedAsyncCall(
                 QStringLiteral("deleteCollection"),
                 QVariantList() << QVariant::fromValue<QString>(collectionName)
                                << QVariant::fromValue<QString>(storagePluginName)
@@ -292,7 +318,7 @@ SecretManagerPrivate::setSecret(
     }
 
     QDBusPendingReply<Result> reply
-            = m_interface->asyncCallWithArgumentList(
+            = tracedAsyncCall(
                 QStringLiteral("setSecret"),
                 QVariantList() << QVariant::fromValue<Secret>(secret)
                                << QVariant::fromValue<InteractionParameters>(uiParams)
@@ -333,7 +359,7 @@ SecretManagerPrivate::setSecret(
     }
 
     QDBusPendingReply<Result> reply
-            = m_interface->asyncCallWithArgumentList(
+            = tracedAsyncCall(
                 QStringLiteral("setSecret"),
                 QVariantList() << QVariant::fromValue<Secret>(secret)
                                << QVariant::fromValue<QString>(encryptionPluginName)
@@ -378,7 +404,7 @@ SecretManagerPrivate::setSecret(
     }
 
     QDBusPendingReply<Result> reply
-            = m_interface->asyncCallWithArgumentList(
+            = tracedAsyncCall(
                 QStringLiteral("setSecret"),
                 QVariantList() << QVariant::fromValue<Secret>(secret)
                                << QVariant::fromValue<QString>(encryptionPluginName)
@@ -419,7 +445,7 @@ SecretManagerPrivate::getSecret(
     }
 
     QDBusPendingReply<Result, Secret> reply
-            = m_interface->asyncCallWithArgumentList(
+            = tracedAsyncCall(
                 QStringLiteral("getSecret"),
                 QVariantList() << QVariant::fromValue<Secret::Identifier>(identifier)
                                << QVariant::fromValue<SecretManager::UserInteractionMode>(userInteractionMode)
@@ -427,12 +453,39 @@ SecretManagerPrivate::getSecret(
     return reply;
 }
 
+QDBusPendingReply<Result, Secret>
+SecretManagerPrivate::getSecretFilterData(
+        const Secret::Identifier &identifier)
+{
+    if (!m_interface) {
+        return QDBusPendingReply<Result, Secret>(
+                    QDBusMessage::createError(QDBusError::Other,
+                                              QStringLiteral("Not connected to daemon")));
+    }
+
+    if (!identifier.isValid()) {
+        Result identifierError(Result::InvalidSecretIdentifierError,
+                               QLatin1String("The given identifier is invalid"));
+        return QDBusPendingReply<Result, Secret>(
+                QDBusMessage().createReply(
+                        QVariantList() << QVariant::fromValue<Result>(identifierError)
+                                       << QVariant::fromValue<Secret>(Secret())));
+    }
+
+    QDBusPendingReply<Result, Secret> reply
+            = tracedAsyncCall(
+                QStringLiteral("getSecretFilterData"),
+                QVariantList() << QVariant::fromValue<Secret::Identifier>(identifier));
+    return reply;
+}
+
 QDBusPendingReply<Result, QVector<Secret::Identifier> >
 SecretManagerPrivate::findSecrets(
         const QString &collectionName,
         const QString &storagePluginName,
         const Secret::FilterData &filter,
         SecretManager::FilterOperator filterOperator,
+        SecretManager::FilterMatch filterMatch,
         SecretManager::UserInteractionMode userInteractionMode)
 {
     if (!m_interface) {
@@ -460,12 +513,13 @@ SecretManagerPrivate::findSecrets(
     }
 
     QDBusPendingReply<Result, QVector<Secret::Identifier> > reply
-            = m_interface->asyncCallWithArgumentList(
+            = tracedAsyncCall(
                 QStringLiteral("findSecrets"),
                 QVariantList() << QVariant::fromValue<QString>(collectionName)
                                << QVariant::fromValue<QString>(storagePluginName)
                                << QVariant::fromValue<Secret::FilterData>(filter)
                                << QVariant::fromValue<SecretManager::FilterOperator>(filterOperator)
+                               << QVariant::fromValue<SecretManager::FilterMatch>(filterMatch)
                                << QVariant::fromValue<SecretManager::UserInteractionMode>(userInteractionMode)
                                << QVariant::fromValue<QString>(interactionServiceAddress));
     return reply;
@@ -476,6 +530,7 @@ SecretManagerPrivate::findSecrets(
         const QString &storagePluginName,
         const Secret::FilterData &filter,
         SecretManager::FilterOperator filterOperator,
+        SecretManager::FilterMatch filterMatch,
         SecretManager::UserInteractionMode userInteractionMode)
 {
     if (!m_interface) {
@@ -493,17 +548,41 @@ SecretManagerPrivate::findSecrets(
     }
 
     QDBusPendingReply<Result, Secret> reply
-            = m_interface->asyncCallWithArgumentList(
+            = tracedAsyncCall(
                 QStringLiteral("findSecrets"),
                 QVariantList() << QVariant::fromValue<QString>(QString())
                                << QVariant::fromValue<QString>(storagePluginName)
                                << QVariant::fromValue<Secret::FilterData>(filter)
                                << QVariant::fromValue<SecretManager::FilterOperator>(filterOperator)
+                               << QVariant::fromValue<SecretManager::FilterMatch>(filterMatch)
                                << QVariant::fromValue<SecretManager::UserInteractionMode>(userInteractionMode)
                                << QVariant::fromValue<QString>(interactionServiceAddress));
     return reply;
 }
 
+QDBusPendingReply<Result, QVector<Secret::Identifier>, QVector<Secret::Identifier>, QVector<Result> >
+SecretManagerPrivate::findSecretsInCollections(
+        const QString &storagePluginName,
+        const Secret::FilterData &filter,
+        SecretManager::FilterOperator filterOperator,
+        SecretManager::FilterMatch filterMatch)
+{
+    if (!m_interface) {
+        return QDBusPendingReply<Result, QVector<Secret::Identifier>, QVector<Secret::Identifier>, QVector<Result> >(
+                    QDBusMessage::createError(QDBusError::Other,
+                                              QStringLiteral("Not connected to daemon")));
+    }
+
+    QDBusPendingReply<Result, QVector<Secret::Identifier>, QVector<Secret::Identifier>, QVector<Result> > reply
+            = tracedAsyncCall(
+                QStringLiteral("findSecretsInCollections"),
+                QVariantList() << QVariant::fromValue<QString>(storagePluginName)
+                               << QVariant::fromValue<Secret::FilterData>(filter)
+                               << QVariant::fromValue<SecretManager::FilterOperator>(filterOperator)
+                               << QVariant::fromValue<SecretManager::FilterMatch>(filterMatch));
+    return reply;
+}
+
 QDBusPendingReply<Result>
 SecretManagerPrivate::deleteSecret(
         const Secret::Identifier &identifier,
@@ -532,7 +611,7 @@ SecretManagerPrivate::deleteSecret(
     }
 
     QDBusPendingReply<Result> reply
-            = m_interface->asyncCallWithArgumentList(
+            = tracedAsyncCall(
                 QStringLiteral("deleteSecret"),
                 QVariantList() << QVariant::fromValue<Secret::Identifier>(identifier)
                                << QVariant::fromValue<SecretManager::UserInteractionMode>(userInteractionMode)
@@ -552,7 +631,7 @@ SecretManagerPrivate::queryLockStatus(
     }
 
     QDBusPendingReply<Result, LockCodeRequest::LockStatus> reply
-            = m_interface->asyncCallWithArgumentList(
+            = tracedAsyncCall(
                 "queryLockStatus",
                 QVariantList() << QVariant::fromValue<LockCodeRequest::LockCodeTargetType>(lockCodeTargetType)
                                << QVariant::fromValue<QString>(lockCodeTarget));
@@ -581,7 +660,7 @@ SecretManagerPrivate::modifyLockCode(
     }
 
     QDBusPendingReply<Result> reply
-            = m_interface->asyncCallWithArgumentList(
+            = tracedAsyncCall(
                 QStringLiteral("modifyLockCode"),
                 QVariantList() << QVariant::fromValue<LockCodeRequest::LockCodeTargetType>(lockCodeTargetType)
                                << QVariant::fromValue<QString>(lockCodeTarget)
@@ -613,7 +692,7 @@ SecretManagerPrivate::provideLockCode(
     }
 
     QDBusPendingReply<Result> reply
-            = m_interface->asyncCallWithArgumentList(
+            = tracedAsyncCall(
                 QStringLiteral("provideLockCode"),
                 QVariantList() << QVariant::fromValue<LockCodeRequest::LockCodeTargetType>(lockCodeTargetType)
                                << QVariant::fromValue<QString>(lockCodeTarget)
@@ -645,7 +724,7 @@ SecretManagerPrivate::forgetLockCode(
     }
 
     QDBusPendingReply<Result> reply
-            = m_interface->asyncCallWithArgumentList(
+            = tracedAsyncCall(
                 QStringLiteral("forgetLockCode"),
                 QVariantList() << QVariant::fromValue<LockCodeRequest::LockCodeTargetType>(lockCodeTargetType)
                                << QVariant::fromValue<QString>(lockCodeTarget)
@@ -73,6 +73,14 @@ public:
     };
     Q_ENUM(FilterOperator)
 
+    enum FilterMatch {
+        MatchExact = 0,                     // case-insensitive equality of the stored value and the filter value.
+        MatchPrefix,                        // the stored value starts with the filter value (case-insensitive).
+        MatchGlob,                          // the filter value is a wildcard pattern (* and ?) matched against the whole stored value.
+        MatchFullText                       // every word of the filter value occurs as a word in the stored value.
+    };
+    Q_ENUM(FilterMatch)
+
     static const QString InAppAuthenticationPluginName;
     static const QString DefaultAuthenticationPluginName;
     static const QString DefaultStoragePluginName;
@@ -118,5 +126,6 @@ Q_DECLARE_METATYPE(Sailfish::Secrets::SecretManager::AccessControlMode)
 Q_DECLARE_METATYPE(Sailfish::Secrets::SecretManager::DeviceLockUnlockSemantic)
 Q_DECLARE_METATYPE(Sailfish::Secrets::SecretManager::CustomLockUnlockSemantic)
 Q_DECLARE_METATYPE(Sailfish::Secrets::SecretManager::FilterOperator)
+Q_DECLARE_METATYPE(Sailfish::Secrets::SecretManager::FilterMatch)
 
 #endif // LIBSAILFISHSECRETS_SECRETMANAGER_H
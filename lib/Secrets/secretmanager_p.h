@@ -122,12 +122,17 @@ public:
             const Sailfish::Secrets::Secret::Identifier &identifier,
             Sailfish::Secrets::SecretManager::UserInteractionMode userInteractionMode);
 
+    // get the filter data of a secret from a collection, without its secret data
+    QDBusPendingReply<Sailfish::Secrets::Result, Sailfish::Secrets::Secret> getSecretFilterData(
+            const Sailfish::Secrets::Secret::Identifier &identifier);
+
     // find secrets from a collection via filter
     QDBusPendingReply<Sailfish::Secrets::Result, QVector<Sailfish::Secrets::Secret::Identifier> > findSecrets(
             const QString &collectionName,
             const QString &storagePluginName,
             const Sailfish::Secrets::Secret::FilterData &filter,
             Sailfish::Secrets::SecretManager::FilterOperator filterOperator,
+            Sailfish::Secrets::SecretManager::FilterMatch filterMatch,
             Sailfish::Secrets::SecretManager::UserInteractionMode userInteractionMode);
 
     // find standalone secrets via filter
@@ -135,8 +140,19 @@ public:
             const QString &storagePluginName,
             const Sailfish::Secrets::Secret::FilterData &filter,
             Sailfish::Secrets::SecretManager::FilterOperator filterOperator,
+            Sailfish::Secrets::SecretManager::FilterMatch filterMatch,
             Sailfish::Secrets::SecretManager::UserInteractionMode userInteractionMode);
 
+    // find secrets from every collection of one (or, if the name is empty, all) storage plugins via filter
+    QDBusPendingReply<Sailfish::Secrets::Result,
+                      QVector<Sailfish::Secrets::Secret::Identifier>,
+                      QVector<Sailfish::Secrets::Secret::Identifier>,
+                      QVector<Sailfish::Secrets::Result> > findSecretsInCollections(
+            const QString &storagePluginName,
+            const Sailfish::Secrets::Secret::FilterData &filter,
+            Sailfish::Secrets::SecretManager::FilterOperator filterOperator,
+            Sailfish::Secrets::SecretManager::FilterMatch filterMatch);
+
     // delete a secret (either from a collection or standalone, depending on the identifier)
     QDBusPendingReply<Sailfish::Secrets::Result> deleteSecret(
             const Sailfish::Secrets::Secret::Identifier &identifier,
@@ -173,6 +189,11 @@ private:
     friend class InteractionService;
     InteractionService *m_uiService;
     InteractionView *m_interactionView;
+    // Sends the given method call to the daemon, preceded by a newly
+    // generated trace id which the daemon uses to correlate all of
+    // the work it performs to handle the request.
+    QDBusPendingCall tracedAsyncCall(const QString &method, const QVariantList &arguments = QVariantList());
+
     QPointer<Sailfish::Secrets::SecretsDaemonConnection> m_secrets;
     QDBusInterface *m_interface;
 };
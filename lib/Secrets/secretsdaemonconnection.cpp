@@ -163,9 +163,11 @@ void Sailfish::Secrets::SecretsDaemonConnection::registerDBusTypes()
     qRegisterMetaType<Sailfish::Secrets::SecretManager::DeviceLockUnlockSemantic>("Sailfish::Secrets::SecretManager::DeviceLockUnlockSemantic");
     qRegisterMetaType<Sailfish::Secrets::SecretManager::CustomLockUnlockSemantic>("Sailfish::Secrets::SecretManager::CustomLockUnlockSemantic");
     qRegisterMetaType<Sailfish::Secrets::SecretManager::FilterOperator>("Sailfish::Secrets::SecretManager::FilterOperator");
+    qRegisterMetaType<Sailfish::Secrets::SecretManager::FilterMatch>("Sailfish::Secrets::SecretManager::FilterMatch");
     qRegisterMetaType<Sailfish::Secrets::PluginInfo>("Sailfish::Secrets::PluginInfo");
     qRegisterMetaType<QVector<Sailfish::Secrets::PluginInfo> >("QVector<Sailfish::Secrets::PluginInfo>");
     qRegisterMetaType<Sailfish::Secrets::Result>("Sailfish::Secrets::Result");
+    qRegisterMetaType<QVector<Sailfish::Secrets::Result> >("QVector<Sailfish::Secrets::Result>");
     qRegisterMetaType<Sailfish::Secrets::Secret>("Sailfish::Secrets::Secret");
     qRegisterMetaType<Sailfish::Secrets::Secret::Identifier>("Sailfish::Secrets::Secret::Identifier");
     qRegisterMetaType<Sailfish::Secrets::Secret::FilterData>("Sailfish::Secrets::Secret::FilterData");
@@ -184,11 +186,14 @@ void Sailfish::Secrets::SecretsDaemonConnection::registerDBusTypes()
     qDBusRegisterMetaType<Sailfish::Secrets::SecretManager::DeviceLockUnlockSemantic>();
     qDBusRegisterMetaType<Sailfish::Secrets::SecretManager::CustomLockUnlockSemantic>();
     qDBusRegisterMetaType<Sailfish::Secrets::SecretManager::FilterOperator>();
+    qDBusRegisterMetaType<Sailfish::Secrets::SecretManager::FilterMatch>();
     qDBusRegisterMetaType<Sailfish::Secrets::PluginInfo>();
     qDBusRegisterMetaType<QVector<Sailfish::Secrets::PluginInfo> >();
     qDBusRegisterMetaType<Sailfish::Secrets::Result>();
+    qDBusRegisterMetaType<QVector<Sailfish::Secrets::Result> >();
     qDBusRegisterMetaType<Sailfish::Secrets::Secret>();
     qDBusRegisterMetaType<Sailfish::Secrets::Secret::Identifier>();
+    qDBusRegisterMetaType<Sailfish::Secrets::SecretIdentifierGroup>();
     qDBusRegisterMetaType<QVector<Sailfish::Secrets::Secret::Identifier> >();
     qDBusRegisterMetaType<Sailfish::Secrets::Secret::FilterData>();
     qDBusRegisterMetaType<Sailfish::Secrets::InteractionParameters>();
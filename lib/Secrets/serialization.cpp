@@ -15,10 +15,28 @@
 
 #include <QtDBus/QDBusArgument>
 #include <QtCore/QString>
+#include <QtCore/QSet>
 #include <QtCore/QLoggingCategory>
 
 Q_LOGGING_CATEGORY(lcSailfishSecretsSerialization, "org.sailfishos.secrets.serialization", QtWarningMsg)
 
+namespace {
+
+// Returns a string equal to the given string which shares its data with
+// the first equal string previously seen, so that the names repeated
+// throughout a large set of identifiers are held in memory only once.
+QString internedString(const QString &str, QSet<QString> *strings)
+{
+    QSet<QString>::const_iterator it = strings->constFind(str);
+    if (it != strings->constEnd()) {
+        return *it;
+    }
+    strings->insert(str);
+    return str;
+}
+
+} // namespace
+
 namespace Sailfish {
 
 namespace Secrets {
@@ -71,6 +89,64 @@ const QDBusArgument &operator>>(const QDBusArgument &argument, Secret::Identifie
     return argument;
 }
 
+QDBusArgument &operator<<(QDBusArgument &argument, const SecretIdentifierGroup &group)
+{
+    argument.beginStructure();
+    argument << group.storagePluginName << group.collectionName << group.names;
+    argument.endStructure();
+    return argument;
+}
+
+const QDBusArgument &operator>>(const QDBusArgument &argument, SecretIdentifierGroup &group)
+{
+    argument.beginStructure();
+    argument >> group.storagePluginName >> group.collectionName >> group.names;
+    argument.endStructure();
+    return argument;
+}
+
+QDBusArgument &operator<<(QDBusArgument &argument, const QVector<Secret::Identifier> &identifiers)
+{
+    SecretIdentifierGroup group;
+    argument.beginArray(qMetaTypeId<SecretIdentifierGroup>());
+    for (const Secret::Identifier &identifier : identifiers) {
+        if (!group.names.isEmpty()
+                && (identifier.storagePluginName() != group.storagePluginName
+                    || identifier.collectionName() != group.collectionName)) {
+            argument << group;
+            group.names.clear();
+        }
+        if (group.names.isEmpty()) {
+            group.storagePluginName = identifier.storagePluginName();
+            group.collectionName = identifier.collectionName();
+        }
+        group.names.append(identifier.name());
+    }
+    if (!group.names.isEmpty()) {
+        argument << group;
+    }
+    argument.endArray();
+    return argument;
+}
+
+const QDBusArgument &operator>>(const QDBusArgument &argument, QVector<Secret::Identifier> &identifiers)
+{
+    QSet<QString> strings;
+    identifiers.clear();
+    argument.beginArray();
+    while (!argument.atEnd()) {
+        SecretIdentifierGroup group;
+        argument >> group;
+        const QString storagePluginName = internedString(group.storagePluginName, &strings);
+        const QString collectionName = internedString(group.collectionName, &strings);
+        for (const QString &name : group.names) {
+            identifiers.append(Secret::Identifier(name, collectionName, storagePluginName));
+        }
+    }
+    argument.endArray();
+    return argument;
+}
+
 QDBusArgument &operator<<(QDBusArgument &argument, const Secret &secret)
 {
     argument.beginStructure();
@@ -190,6 +266,25 @@ const QDBusArgument &operator>>(const QDBusArgument &argument, SecretManager::Fi
     return argument;
 }
 
+QDBusArgument &operator<<(QDBusArgument &argument, const SecretManager::FilterMatch filterMatch)
+{
+    int imatch = static_cast<int>(filterMatch);
+    argument.beginStructure();
+    argument << imatch;
+    argument.endStructure();
+    return argument;
+}
+
+const QDBusArgument &operator>>(const QDBusArgument &argument, SecretManager::FilterMatch &filterMatch)
+{
+    int imatch = 0;
+    argument.beginStructure();
+    argument >> imatch;
+    argument.endStructure();
+    filterMatch = static_cast<SecretManager::FilterMatch>(imatch);
+    return argument;
+}
+
 QDBusArgument &operator<<(QDBusArgument &argument, const PluginInfo &info)
 {
     argument.beginStructure();
@@ -27,10 +27,24 @@
 #include <QtDBus/QDBusArgument>
 #include <QtDBus/QDBusMetaType>
 
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QVector>
+
 namespace Sailfish {
 
 namespace Secrets {
 
+// A run of consecutive identifiers which share a storage plugin and
+// collection.  Vectors of identifiers are marshalled as a sequence of
+// these groups, so that the (usually identical) storage plugin and
+// collection names are sent once per group rather than once per secret.
+struct SecretIdentifierGroup
+{
+    QString storagePluginName;
+    QString collectionName;
+    QStringList names;
+};
 
 QDBusArgument &operator<<(QDBusArgument &argument, const Sailfish::Secrets::Result &result) SAILFISH_SECRETS_API;
 const QDBusArgument &operator>>(const QDBusArgument &argument, Sailfish::Secrets::Result &result) SAILFISH_SECRETS_API;
@@ -39,6 +53,10 @@ QDBusArgument &operator<<(QDBusArgument &argument, const Sailfish::Secrets::Secr
 const QDBusArgument &operator>>(const QDBusArgument &argument, Sailfish::Secrets::Secret &secret) SAILFISH_SECRETS_API;
 QDBusArgument &operator<<(QDBusArgument &argument, const Sailfish::Secrets::Secret::Identifier &identifier) SAILFISH_SECRETS_API;
 const QDBusArgument &operator>>(const QDBusArgument &argument, Sailfish::Secrets::Secret::Identifier &identifier) SAILFISH_SECRETS_API;
+QDBusArgument &operator<<(QDBusArgument &argument, const Sailfish::Secrets::SecretIdentifierGroup &group) SAILFISH_SECRETS_API;
+const QDBusArgument &operator>>(const QDBusArgument &argument, Sailfish::Secrets::SecretIdentifierGroup &group) SAILFISH_SECRETS_API;
+QDBusArgument &operator<<(QDBusArgument &argument, const QVector<Sailfish::Secrets::Secret::Identifier> &identifiers) SAILFISH_SECRETS_API;
+const QDBusArgument &operator>>(const QDBusArgument &argument, QVector<Sailfish::Secrets::Secret::Identifier> &identifiers) SAILFISH_SECRETS_API;
 
 QDBusArgument &operator<<(QDBusArgument &argument, const Sailfish::Secrets::SecretManager::UserInteractionMode mode) SAILFISH_SECRETS_API;
 const QDBusArgument &operator>>(const QDBusArgument &argument, Sailfish::Secrets::SecretManager::UserInteractionMode &mode) SAILFISH_SECRETS_API;
@@ -50,6 +68,8 @@ QDBusArgument &operator<<(QDBusArgument &argument, const Sailfish::Secrets::Secr
 const QDBusArgument &operator>>(const QDBusArgument &argument, Sailfish::Secrets::SecretManager::CustomLockUnlockSemantic &semantic) SAILFISH_SECRETS_API;
 QDBusArgument &operator<<(QDBusArgument &argument, const Sailfish::Secrets::SecretManager::FilterOperator filterOperator) SAILFISH_SECRETS_API;
 const QDBusArgument &operator>>(const QDBusArgument &argument, Sailfish::Secrets::SecretManager::FilterOperator &filterOperator) SAILFISH_SECRETS_API;
+QDBusArgument &operator<<(QDBusArgument &argument, const Sailfish::Secrets::SecretManager::FilterMatch filterMatch) SAILFISH_SECRETS_API;
+const QDBusArgument &operator>>(const QDBusArgument &argument, Sailfish::Secrets::SecretManager::FilterMatch &filterMatch) SAILFISH_SECRETS_API;
 
 QDBusArgument &operator<<(QDBusArgument &argument, const Sailfish::Secrets::PluginInfo &info) SAILFISH_SECRETS_API;
 const QDBusArgument &operator>>(const QDBusArgument &argument, Sailfish::Secrets::PluginInfo &info) SAILFISH_SECRETS_API;
@@ -79,4 +99,6 @@ const QDBusArgument &operator>>(const QDBusArgument &argument, Sailfish::Secrets
 
 } // namespace Sailfish
 
+Q_DECLARE_METATYPE(Sailfish::Secrets::SecretIdentifierGroup);
+
 #endif // LIBSAILFISHSECRETS_SERIALIZATION_H
@@ -19,6 +19,7 @@ using namespace Sailfish::Secrets;
 
 StoredSecretRequestPrivate::StoredSecretRequestPrivate()
     : m_userInteractionMode(SecretManager::PreventInteraction)
+    , m_metadataOnly(false)
     , m_status(Request::Inactive)
 {
 }
@@ -52,6 +53,11 @@ StoredSecretRequestPrivate::StoredSecretRequestPrivate()
  * plugin, but otherwise will be a system-mediated UI flow, unless the \a userInteractionMode
  * specified is \c PreventInteraction in which case the request will fail).
  *
+ * If only the filter data of a collection-stored secret is required (for example,
+ * to display a list of the accounts for which passwords are stored), the client
+ * can set metadataOnly() to \c true.  The secret data is then neither read nor
+ * decrypted.
+ *
  * Note that only those components of the secret which were allowed for retrieval
  * via \l{Sailfish::Secrets::Secret::setComponentConstraints()} will be able to be
  * retrieved, even if the calling application is the owner of the secret.
@@ -109,6 +115,39 @@ void StoredSecretRequest::setIdentifier(const Secret::Identifier &ident)
     }
 }
 
+/*!
+ * \brief Returns true if only the metadata of the secret will be retrieved
+ */
+bool StoredSecretRequest::metadataOnly() const
+{
+    Q_D(const StoredSecretRequest);
+    return d->m_metadataOnly;
+}
+
+/*!
+ * \brief Sets whether only the metadata of the secret will be retrieved to \a metadataOnly
+ *
+ * If \a metadataOnly is true, the secret() returned will contain the identifier
+ * and filter data (including the type) of the secret, but no secret data.
+ *
+ * Such requests never trigger any user interaction, so the userInteractionMode()
+ * is ignored: if the collection in which the secret is stored is locked, the request
+ * will fail with \c Result::CollectionIsLockedError.  Retrieving the metadata of
+ * standalone secrets is not supported.
+ */
+void StoredSecretRequest::setMetadataOnly(bool metadataOnly)
+{
+    Q_D(StoredSecretRequest);
+    if (d->m_status != Request::Active && d->m_metadataOnly != metadataOnly) {
+        d->m_metadataOnly = metadataOnly;
+        if (d->m_status == Request::Finished) {
+            d->m_status = Request::Inactive;
+            emit statusChanged();
+        }
+        emit metadataOnlyChanged();
+    }
+}
+
 /*!
  * \brief Returns the secret which was retrieved for the client
  */
@@ -181,9 +220,10 @@ void StoredSecretRequest::startRequest()
             emit resultChanged();
         }
 
-        QDBusPendingReply<Result, Secret> reply = d->m_manager->d_ptr->getSecret(
-                                                        d->m_identifier,
-                                                        d->m_userInteractionMode);
+        QDBusPendingReply<Result, Secret> reply = d->m_metadataOnly
+                ? d->m_manager->d_ptr->getSecretFilterData(d->m_identifier)
+                : d->m_manager->d_ptr->getSecret(d->m_identifier,
+                                                 d->m_userInteractionMode);
         if (!reply.isValid() && !reply.error().message().isEmpty()) {
             d->m_status = Request::Finished;
             d->m_result = Result(Result::SecretManagerNotInitializedError,
@@ -27,6 +27,7 @@ class SAILFISH_SECRETS_API StoredSecretRequest : public Sailfish::Secrets::Reque
     Q_OBJECT
     Q_PROPERTY(Sailfish::Secrets::Secret::Identifier identifier READ identifier WRITE setIdentifier NOTIFY identifierChanged)
     Q_PROPERTY(Sailfish::Secrets::SecretManager::UserInteractionMode userInteractionMode READ userInteractionMode WRITE setUserInteractionMode NOTIFY userInteractionModeChanged)
+    Q_PROPERTY(bool metadataOnly READ metadataOnly WRITE setMetadataOnly NOTIFY metadataOnlyChanged)
     Q_PROPERTY(Sailfish::Secrets::Secret secret READ secret NOTIFY secretChanged)
 
 public:
@@ -39,6 +40,9 @@ public:
     Sailfish::Secrets::SecretManager::UserInteractionMode userInteractionMode() const;
     void setUserInteractionMode(Sailfish::Secrets::SecretManager::UserInteractionMode mode);
 
+    bool metadataOnly() const;
+    void setMetadataOnly(bool metadataOnly);
+
     Sailfish::Secrets::Secret secret() const;
 
     Sailfish::Secrets::Request::Status status() const Q_DECL_OVERRIDE;
@@ -53,6 +57,7 @@ public:
 Q_SIGNALS:
     void identifierChanged();
     void userInteractionModeChanged();
+    void metadataOnlyChanged();
     void secretChanged();
 
 private:
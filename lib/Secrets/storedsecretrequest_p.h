@@ -32,6 +32,7 @@ public:
     QPointer<Sailfish::Secrets::SecretManager> m_manager;
     Sailfish::Secrets::Secret::Identifier m_identifier;
     Sailfish::Secrets::SecretManager::UserInteractionMode m_userInteractionMode;
+    bool m_metadataOnly;
     Sailfish::Secrets::Secret m_secret;
 
     QScopedPointer<QDBusPendingCallWatcher> m_watcher;
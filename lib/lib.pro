@@ -4,6 +4,7 @@ SUBDIRS += \
     Secrets \
     SecretsPluginApi \
     SecretsDocs \
+    CryptoEvp \
     Crypto \
     CryptoPluginApi \
     CryptoDocs
@@ -12,6 +13,7 @@ Secrets.subdir = $$PWD/Secrets
 SecretsPluginApi.subdir = $$PWD/Secrets/Plugins
 SecretsDocs.subdir = $$PWD/Secrets/doc
 
+CryptoEvp.subdir = $$PWD/CryptoEvp
 Crypto.subdir = $$PWD/Crypto
 CryptoPluginApi.subdir = $$PWD/Crypto/Plugins
 CryptoDocs.subdir = $$PWD/Crypto/doc
@@ -19,3 +21,4 @@ CryptoDocs.subdir = $$PWD/Crypto/doc
 SecretsPluginApi.depends = Secrets
 CryptoPluginApi.depends = Crypto
 CryptoPluginApi.depends = SecretsPluginApi
+Crypto.depends = CryptoEvp
@@ -0,0 +1,7 @@
+CONFIG += link_pkgconfig
+PKGCONFIG += libcrypto
+LIBS += -L$$shadowed($$PWD/CryptoEvp) -lsailfishcryptoevp
+PRE_TARGETDEPS += $$shadowed($$PWD/CryptoEvp)/libsailfishcryptoevp.a
+
+INCLUDEPATH += $$PWD/../plugins/opensslcryptoplugin/evp
+DEPENDPATH += $$INCLUDEPATH
@@ -8,18 +8,16 @@ include($$PWD/../../common.pri)
 include($$PWD/../../lib/libsailfishsecretspluginapi.pri)
 include($$PWD/../../lib/libsailfishcryptopluginapi.pri)
 include($$PWD/../../database/database.pri)
+include($$PWD/../../lib/libsailfishcryptoevp.pri)
 
 INCLUDEPATH += . $$PWD/../opensslcryptoplugin $$PWD/../opensslcryptoplugin/evp/
 DEPENDPATH += . $$PWD/../opensslcryptoplugin $$PWD/../opensslcryptoplugin/evp/
 
 HEADERS += \
-    $$PWD/../opensslcryptoplugin/evp/evp_p.h \
-    $$PWD/../opensslcryptoplugin/evp/evp_helpers_p.h \
     $$PWD/../opensslcryptoplugin/opensslcryptoplugin.h \
     $$PWD/exampleusbtokenplugin.h
 
 SOURCES += \
-    $$PWD/../opensslcryptoplugin/evp/evp.cpp \
     $$PWD/../opensslcryptoplugin/opensslcryptoplugin.cpp \
     $$PWD/exampleusbtokenplugin.cpp \
     $$PWD/encryptedstorageplugin.cpp \
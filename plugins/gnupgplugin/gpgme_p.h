@@ -13,18 +13,41 @@
 #endif
 #include <gpgme.h>
 
+#include "gpgmepool_p.h"
+
 #include <Crypto/Plugins/extensionplugins.h>
 #include <Crypto/key.h>
 #include <QString>
 #include <QDebug>
 #include <QDateTime>
 #include <QFile>
+#include <QDBusUnixFileDescriptor>
+
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
 
 struct GPGmeContext {
     gpgme_ctx_t ctx;
     gpgme_error_t err;
+    GPGmeContextPool *pool;
+    QString home;
     GPGmeContext(gpgme_protocol_t protocol, const QString &home = QString())
-        : ctx(0), err(0)
+        : ctx(0), err(0), pool(0), home(home)
+    {
+        create(protocol);
+    }
+    // Reuses an idle context from the pool if there is one, and returns
+    // the context to the pool on destruction.  Only operations which don't
+    // install callbacks on the context should use pooled contexts.
+    GPGmeContext(GPGmeContextPool *pool, const QString &home = QString())
+        : ctx(pool->acquire(home)), err(0), pool(pool), home(home)
+    {
+        if (!ctx) {
+            create(pool->protocol());
+        }
+    }
+    void create(gpgme_protocol_t protocol)
     {
         err = gpgme_engine_check_version(protocol);
         if (gpgme_err_code(err) != GPG_ERR_NO_ERROR) {
@@ -85,7 +108,9 @@ struct GPGmeContext {
     }
     ~GPGmeContext()
     {
-        if (ctx) {
+        if (ctx && pool) {
+            pool->release(home, ctx);
+        } else if (ctx) {
             gpgme_release(ctx);
         }
     }
@@ -108,8 +133,19 @@ struct GPGmeData {
     gpgme_data_t data;
     gpgme_error_t err;
     QFile *source;
+    QByteArray *sink;
+    QDBusUnixFileDescriptor descriptor;
+    struct gpgme_data_cbs cbs;
+    enum Direction {
+        Read,
+        Write
+    };
+    // The maximum time to wait for the caller's end of a file descriptor
+    // to become ready, so that a caller which stops reading or writing
+    // cannot block the plugin indefinitely.
+    enum { DescriptorTimeoutMsecs = 30000 };
     GPGmeData()
-        : data(0), err(0), source(0)
+        : data(0), err(0), source(0), sink(0)
     {
         err = gpgme_data_new(&data);
         if (gpgme_err_code(err) != GPG_ERR_NO_ERROR) {
@@ -117,14 +153,19 @@ struct GPGmeData {
         }
     }
     // The data hold by origin are not copied. origin should be valid
-    // for the whole life of the created structure.
+    // for the whole life of the created structure.  An origin of the
+    // form file://<path> is streamed from the file in chunks, as
+    // gpgme consumes it.
     GPGmeData(const QByteArray &origin)
-        : data(0), err(0), source(0)
+        : data(0), err(0), source(0), sink(0)
     {
         if (origin.startsWith("file://")) {
-            source = new QFile(origin.mid(7));
-            source->open(QIODevice::ReadOnly);
-            err = gpgme_data_new_from_fd(&data, source->handle());
+            source = new QFile(QString::fromUtf8(origin.mid(7)));
+            if (!source->open(QIODevice::ReadOnly)) {
+                err = gpgme_error_from_errno(ENOENT);
+                return;
+            }
+            newFromCallbacks();
         } else {
 #define NO_COPY 0
             err = gpgme_data_new_from_mem(&data, origin.constData(),
@@ -134,6 +175,37 @@ struct GPGmeData {
             data = 0;
         }
     }
+    // The output of gpgme is appended to output as it is produced.
+    // This avoids the intermediate buffer (and the final copy) of
+    // memory based data.
+    GPGmeData(QByteArray *output)
+        : data(0), err(0), source(0), sink(output)
+    {
+        sink->clear();
+        newFromCallbacks();
+        if (gpgme_err_code(err) != GPG_ERR_NO_ERROR) {
+            data = 0;
+        }
+    }
+    // The data are streamed in chunks from, or to, a file descriptor
+    // supplied by the caller (e.g. one end of a pipe), so that neither
+    // the input nor the output is ever held in memory as a whole.
+    GPGmeData(const QDBusUnixFileDescriptor &fd, Direction direction)
+        : data(0), err(0), source(0), sink(0), descriptor(fd)
+    {
+        if (!descriptor.isValid()) {
+            err = gpgme_error_from_errno(EBADF);
+            return;
+        }
+        cbs.read = direction == Read ? readDescriptorCallback : 0;
+        cbs.write = direction == Write ? writeDescriptorCallback : 0;
+        cbs.seek = seekDescriptorCallback;
+        cbs.release = 0;
+        err = gpgme_data_new_from_cbs(&data, &cbs, this);
+        if (gpgme_err_code(err) != GPG_ERR_NO_ERROR) {
+            data = 0;
+        }
+    }
     ~GPGmeData()
     {
         if (data) {
@@ -157,6 +229,104 @@ struct GPGmeData {
         return (err && gpgme_err_code(err) != GPG_ERR_NO_ERROR)
             ? QString(gpgme_strerror(err)) : QString();
     }
+    void newFromCallbacks()
+    {
+        cbs.read = source ? readCallback : 0;
+        cbs.write = sink ? writeCallback : 0;
+        cbs.seek = seekCallback;
+        cbs.release = 0;
+        err = gpgme_data_new_from_cbs(&data, &cbs, this);
+    }
+    static ssize_t readCallback(void *handle, void *buffer, size_t size)
+    {
+        GPGmeData *self = static_cast<GPGmeData*>(handle);
+        qint64 count = self->source->read(static_cast<char*>(buffer), qint64(size));
+        if (count < 0) {
+            errno = EIO;
+            return -1;
+        }
+        return ssize_t(count);
+    }
+    static ssize_t writeCallback(void *handle, const void *buffer, size_t size)
+    {
+        GPGmeData *self = static_cast<GPGmeData*>(handle);
+        self->sink->append(static_cast<const char*>(buffer), int(size));
+        return ssize_t(size);
+    }
+    static off_t seekCallback(void *handle, off_t offset, int whence)
+    {
+        GPGmeData *self = static_cast<GPGmeData*>(handle);
+        const qint64 current = self->source ? self->source->pos() : self->sink->size();
+        const qint64 size = self->source ? self->source->size() : self->sink->size();
+        qint64 position = offset;
+        if (whence == SEEK_CUR) {
+            position += current;
+        } else if (whence == SEEK_END) {
+            position += size;
+        }
+        // Only files are seekable, a memory sink is append-only.
+        if (self->source ? !self->source->seek(position) : position != current) {
+            errno = EINVAL;
+            return -1;
+        }
+        return off_t(position);
+    }
+    static bool waitForDescriptor(int fd, short events)
+    {
+        struct pollfd pfd;
+        pfd.fd = fd;
+        pfd.events = events;
+        pfd.revents = 0;
+        int ready;
+        do {
+            ready = ::poll(&pfd, 1, DescriptorTimeoutMsecs);
+        } while (ready < 0 && errno == EINTR);
+        if (ready == 0) {
+            errno = ETIMEDOUT;
+            return false;
+        }
+        // A hung up pipe is still readable until it is drained.
+        return ready > 0 && !(pfd.revents & (POLLERR | POLLNVAL));
+    }
+    static ssize_t readDescriptorCallback(void *handle, void *buffer, size_t size)
+    {
+        GPGmeData *self = static_cast<GPGmeData*>(handle);
+        const int fd = self->descriptor.fileDescriptor();
+        if (!waitForDescriptor(fd, POLLIN)) {
+            return -1;
+        }
+        ssize_t count;
+        do {
+            count = ::read(fd, buffer, size);
+        } while (count < 0 && errno == EINTR);
+        return count;
+    }
+    static ssize_t writeDescriptorCallback(void *handle, const void *buffer, size_t size)
+    {
+        GPGmeData *self = static_cast<GPGmeData*>(handle);
+        const int fd = self->descriptor.fileDescriptor();
+        const char *bytes = static_cast<const char*>(buffer);
+        size_t written = 0;
+        while (written < size) {
+            if (!waitForDescriptor(fd, POLLOUT)) {
+                return -1;
+            }
+            const ssize_t count = ::write(fd, bytes + written, size - written);
+            if (count < 0 && errno != EINTR && errno != EAGAIN) {
+                return -1;
+            } else if (count > 0) {
+                written += size_t(count);
+            }
+        }
+        return ssize_t(written);
+    }
+    static off_t seekDescriptorCallback(void *handle, off_t offset, int whence)
+    {
+        // Fails with ESPIPE for pipes and sockets, which gpgme
+        // does not need to seek when streaming.
+        GPGmeData *self = static_cast<GPGmeData*>(handle);
+        return ::lseek(self->descriptor.fileDescriptor(), offset, whence);
+    }
     void releaseData(QByteArray *output)
     {
         size_t ln;
@@ -206,6 +376,13 @@ struct GPGmeKey {
         : key(0), sub(0), err(err)
     {
     }
+    // Takes over the given reference to key.
+    GPGmeKey(gpgme_key_t adopted, const char *fingerprint)
+        : key(adopted), sub(adopted->subkeys), err(0)
+    {
+        while (sub && strcmp(fingerprint, sub->fpr))
+            sub = sub->next;
+    }
     GPGmeKey(const GPGmeKey &other)
         : key(other.key), sub(other.sub), err(other.err)
     {
@@ -218,6 +395,23 @@ struct GPGmeKey {
             gpgme_key_unref(key);
         }
     }
+    // Looks the key up from the cache first, and caches it if it
+    // had to be retrieved from the keyring.
+    static GPGmeKey fromCache(GPGmeKeyCache *cache, const gpgme_ctx_t ctx,
+                              const QString &home, const QString &fingerprint,
+                              Level level = Public)
+    {
+        const QByteArray fpr = fingerprint.toLocal8Bit();
+        gpgme_key_t cached = cache->key(home, fpr, level == Secret);
+        if (cached) {
+            return GPGmeKey(cached, fpr.constData());
+        }
+        GPGmeKey key(ctx, fpr.constData(), level);
+        if (key) {
+            cache->insert(home, level == Secret, key);
+        }
+        return key;
+    }
     static GPGmeKey fromUid(const gpgme_ctx_t ctx, const QString &uid)
     {
         GPGmeKey key = listKeys(ctx, uid);
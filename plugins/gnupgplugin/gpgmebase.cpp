@@ -13,6 +13,25 @@
 
 using namespace Sailfish::Crypto;
 
+// Large payloads can be streamed through file descriptors supplied by the
+// caller (e.g. the ends of pipes) in the "Input-Fd" and "Output-Fd" custom
+// parameters, instead of being passed in the request and its result.
+static GPGmeData *inputData(const QByteArray &data, const QVariantMap &customParameters)
+{
+    const QVariant fd = customParameters.value(QStringLiteral("Input-Fd"));
+    return fd.isValid()
+        ? new GPGmeData(fd.value<QDBusUnixFileDescriptor>(), GPGmeData::Read)
+        : new GPGmeData(data);
+}
+
+static GPGmeData *outputData(QByteArray *output, const QVariantMap &customParameters)
+{
+    const QVariant fd = customParameters.value(QStringLiteral("Output-Fd"));
+    return fd.isValid()
+        ? new GPGmeData(fd.value<QDBusUnixFileDescriptor>(), GPGmeData::Write)
+        : new GPGmeData(output);
+}
+
 Daemon::Plugins::GnuPGPlugin::GnuPGPlugin(gpgme_protocol_t protocol)
     : CryptoPlugin(), m_protocol(protocol)
 {
@@ -215,6 +234,7 @@ Result Daemon::Plugins::GnuPGPlugin::generateSubkey(const Key &keyTemplate,
     GPGmeData out;
     gpgme_error_t err;
     err = gpgme_op_edit(ctx, primary, _edit_cb, &params, out);
+    GPGmeKeyCache::instance(m_protocol)->invalidate(home);
     if (gpgme_err_code(err) != GPG_ERR_NO_ERROR) {
         return Result(Result::CryptoPluginKeyGenerationError,
                       QStringLiteral("cannot edit key: %1").arg(gpgme_strerror(err)));
@@ -344,6 +364,7 @@ Result Daemon::Plugins::GnuPGPlugin::generateKey(const Key &keyTemplate,
         // Todo do something with the public data which represent a
         // certificate request for S/MIME. Not implemented yet.
     }
+    GPGmeKeyCache::instance(m_protocol)->invalidate(home);
     if (gpgme_err_code(err) != GPG_ERR_NO_ERROR) {
         return Result(Result::CryptoPluginKeyGenerationError,
                       QStringLiteral("cannot generate key: %1").arg(gpgme_strerror(err)));
@@ -435,6 +456,7 @@ Result Daemon::Plugins::GnuPGPlugin::downloadKey(const QString &fingerprint,
         }
         gpgProcess.start("/usr/bin/gpg2", arguments);
         gpgProcess.waitForFinished();
+        GPGmeKeyCache::instance(m_protocol)->invalidate(home);
         if (gpgProcess.exitStatus() != QProcess::NormalExit) {
             switch (gpgProcess.error()) {
             case QProcess::FailedToStart:
@@ -496,6 +518,7 @@ Result Daemon::Plugins::GnuPGPlugin::importKey(const QByteArray &data,
 
     gpgme_error_t err;
     err = gpgme_op_import(ctx, gdata);
+    GPGmeKeyCache::instance(m_protocol)->invalidate(home);
     if (gpgme_err_code(err) != GPG_ERR_NO_ERROR) {
         return Result(Result::CryptoPluginKeyImportError,
                       QStringLiteral("cannot import data: %1.").arg(gpgme_strerror(err)));
@@ -565,15 +588,15 @@ Result Daemon::Plugins::GnuPGPlugin::storedKey(const Key::Identifier &identifier
                                                const QVariantMap &customParameters,
                                                Key *key)
 {
-    GPGmeContext ctx(m_protocol, customParameters.value("Ephemeral-Home",
-                                                        QVariant(QString())).toString());
+    const QString home = customParameters.value("Ephemeral-Home", QVariant(QString())).toString();
+    GPGmeContext ctx(GPGmeContextPool::instance(m_protocol), home);
     if (!ctx) {
         return Result(Result::StorageError, ctx.error());
     }
 
-    GPGmeKey gkey(ctx, identifier.name(),
-                  (keyComponents & Key::SecretKeyData)
-                  ? GPGmeKey::Secret : GPGmeKey::Public);
+    GPGmeKey gkey = GPGmeKey::fromCache(GPGmeKeyCache::instance(m_protocol), ctx, home, identifier.name(),
+                                        (keyComponents & Key::SecretKeyData)
+                                        ? GPGmeKey::Secret : GPGmeKey::Public);
     if (!gkey) {
         return Result(Result::InvalidKeyIdentifier,
                       Sailfish::Secrets::Result::InvalidSecretError,
@@ -594,14 +617,17 @@ Result Daemon::Plugins::GnuPGPlugin::storedKeyIdentifiers(const QString &collect
         return Result();
     }
 
-    GPGmeContext ctx(m_protocol, customParameters.value("Ephemeral-Home",
-                                                        QVariant(QString())).toString());
+    const QString home = customParameters.value("Ephemeral-Home", QVariant(QString())).toString();
+    GPGmeContext ctx(GPGmeContextPool::instance(m_protocol), home);
     if (!ctx) {
         return Result(Result::StorageError, ctx.error());
     }
 
+    // The listed keys are cached, as they are likely to be used next.
+    GPGmeKeyCache *cache = GPGmeKeyCache::instance(m_protocol);
     GPGmeKey key = GPGmeKey::listKeys(ctx, collectionName);
     while (key) {
+        cache->insert(home, false, key);
         while (key.sub) {
             identifiers->append(Key::Identifier(key.sub->fpr, key.collectionName(), name()));
             key.sub = key.sub->next;
@@ -657,7 +683,8 @@ Result Daemon::Plugins::GnuPGPlugin::operation(CryptoManager::Operation operatio
         return Result(errCode, QStringLiteral("cannot use a non GnuPG key."));
     }
 
-    GPGmeContext ctx(m_protocol, key.filterData("Ephemeral-Home"));
+    const QString home = key.filterData("Ephemeral-Home");
+    GPGmeContext ctx(GPGmeContextPool::instance(m_protocol), home);
     if (!ctx) {
         return Result(errCode, ctx.error());
     }
@@ -667,17 +694,20 @@ Result Daemon::Plugins::GnuPGPlugin::operation(CryptoManager::Operation operatio
     gpgme_set_armor(ctx, customParameters.value("With-Armor",
                                                 QVariant(true)).toBool() ? 1 : 0);
 
-    GPGmeData cdata, gdata(data);
-    if (!cdata || !gdata) {
-        return Result(errCode, QStringLiteral("cannot create cryptographic data."));
+    QByteArray result;
+    QScopedPointer<GPGmeData> cdata(outputData(&result, customParameters));
+    QScopedPointer<GPGmeData> gdata(inputData(data, customParameters));
+    if (!*cdata || !*gdata) {
+        return Result(errCode, QStringLiteral("cannot create cryptographic data: %1.")
+                      .arg(!*cdata ? cdata->error() : gdata->error()));
     }
     gpgme_error_t err = GPG_ERR_NO_ERROR;
     switch (m_protocol) {
     case GPGME_PROTOCOL_OpenPGP:
-        err = gpgme_data_set_encoding(cdata, GPGME_DATA_ENCODING_ARMOR);
+        err = gpgme_data_set_encoding(*cdata, GPGME_DATA_ENCODING_ARMOR);
         break;
     case GPGME_PROTOCOL_CMS:
-        err = gpgme_data_set_encoding(cdata, GPGME_DATA_ENCODING_BASE64);
+        err = gpgme_data_set_encoding(*cdata, GPGME_DATA_ENCODING_BASE64);
         break;
     default:
         break;
@@ -687,9 +717,9 @@ Result Daemon::Plugins::GnuPGPlugin::operation(CryptoManager::Operation operatio
                       QStringLiteral("cannot set encoding on data: %1.").arg(gpgme_strerror(err)));
     }
 
-    GPGmeKey gkey(ctx, key.name(),
-                  (operation == CryptoManager::OperationSign)
-                  ? GPGmeKey::Secret : GPGmeKey::Public);
+    GPGmeKey gkey = GPGmeKey::fromCache(GPGmeKeyCache::instance(m_protocol), ctx, home, key.name(),
+                                        (operation == CryptoManager::OperationSign)
+                                        ? GPGmeKey::Secret : GPGmeKey::Public);
     if (!gkey) {
         return Result(Result::InvalidKeyIdentifier,
                       QStringLiteral("cannot retrieve key %1: %2.").arg(key.name()).arg(gkey.error()));
@@ -701,7 +731,7 @@ Result Daemon::Plugins::GnuPGPlugin::operation(CryptoManager::Operation operatio
             return Result(errCode,
                           QStringLiteral("cannot add key %1: %2.").arg(key.name()).arg(gpgme_strerror(err)));
         }
-        err = gpgme_op_sign(ctx, gdata, cdata, GPGME_SIG_MODE_DETACH);
+        err = gpgme_op_sign(ctx, *gdata, *cdata, GPGME_SIG_MODE_DETACH);
         if (gpgme_err_code(err) != GPG_ERR_NO_ERROR) {
             return Result(errCode,
                           QStringLiteral("cannot sign: %1.").arg(gpgme_strerror(err)));
@@ -725,7 +755,7 @@ Result Daemon::Plugins::GnuPGPlugin::operation(CryptoManager::Operation operatio
                                    QVariant(false)).toBool()) {
             trust = gpgme_encrypt_flags_t(0);
         }
-        err = gpgme_op_encrypt(ctx, recp, trust, gdata, cdata);
+        err = gpgme_op_encrypt(ctx, recp, trust, *gdata, *cdata);
         if (gpgme_err_code(err) != GPG_ERR_NO_ERROR) {
             return Result(errCode,
                           QStringLiteral("cannot encrypt: %1.").arg(gpgme_strerror(err)));
@@ -739,29 +769,15 @@ Result Daemon::Plugins::GnuPGPlugin::operation(CryptoManager::Operation operatio
         }
     }
 
-    cdata.releaseData(output);
+    output->swap(result);
     return Result();
 }
 
-Result Daemon::Plugins::GnuPGPlugin::checkOperation(CryptoManager::Operation operation,
-                                                    gpgme_ctx_t ctx, const Key &key,
-                                                    CryptoManager::VerificationStatus *verificationStatus)
+static void signatureStatus(gpgme_verify_result_t verif, const GPGmeKey &gkey,
+                            CryptoManager::VerificationStatus *verificationStatus)
 {
-    gpgme_verify_result_t verif;
-    verif = gpgme_op_verify_result(ctx);
-    if (!verif) {
-      return (operation == CryptoManager::OperationVerify)
-        ? Result(Result::CryptoPluginVerificationError,
-                 "cannot retrieve results.")
-        : Result();
-    }
     gpgme_signature_t signer;
     signer = verif->signatures;
-    GPGmeKey gkey(ctx, key.name());
-    if (!gkey) {
-        return Result(Result::InvalidKeyIdentifier,
-                      QStringLiteral("cannot retrieve key %1: %2.").arg(key.name()).arg(gkey.error()));
-    }
     while (signer) {
         if (gkey.contains(signer->fpr)) {
             switch (gpgme_err_code(signer->status)) {
@@ -790,6 +806,27 @@ Result Daemon::Plugins::GnuPGPlugin::checkOperation(CryptoManager::Operation ope
         }
         signer = signer->next;
     }
+}
+
+Result Daemon::Plugins::GnuPGPlugin::checkOperation(CryptoManager::Operation operation,
+                                                    gpgme_ctx_t ctx, const Key &key,
+                                                    CryptoManager::VerificationStatus *verificationStatus)
+{
+    gpgme_verify_result_t verif;
+    verif = gpgme_op_verify_result(ctx);
+    if (!verif) {
+      return (operation == CryptoManager::OperationVerify)
+        ? Result(Result::CryptoPluginVerificationError,
+                 "cannot retrieve results.")
+        : Result();
+    }
+    GPGmeKey gkey = GPGmeKey::fromCache(GPGmeKeyCache::instance(m_protocol), ctx,
+                                        key.filterData("Ephemeral-Home"), key.name());
+    if (!gkey) {
+        return Result(Result::InvalidKeyIdentifier,
+                      QStringLiteral("cannot retrieve key %1: %2.").arg(key.name()).arg(gkey.error()));
+    }
+    signatureStatus(verif, gkey, verificationStatus);
 
     return Result();
 }
@@ -818,7 +855,6 @@ Result Daemon::Plugins::GnuPGPlugin::verify(const QByteArray &signature,
 {
     Q_UNUSED(padding);
     Q_UNUSED(digestFunction);
-    Q_UNUSED(customParameters);
 
     if (!verificationStatus) {
         return Result(Result::CryptoPluginVerificationError,
@@ -831,19 +867,20 @@ Result Daemon::Plugins::GnuPGPlugin::verify(const QByteArray &signature,
                       QStringLiteral("cannot verify with a non GnuPG key."));
     }
 
-    GPGmeData gsig(signature), gdata(data);
-    if (!gsig || !gdata) {
+    GPGmeData gsig(signature);
+    QScopedPointer<GPGmeData> gdata(inputData(data, customParameters));
+    if (!gsig || !*gdata) {
         return Result(Result::CryptoPluginVerificationError,
                       QStringLiteral("cannot create signature data."));
     }
 
-    GPGmeContext ctx(m_protocol, key.filterData("Ephemeral-Home"));
+    GPGmeContext ctx(GPGmeContextPool::instance(m_protocol), key.filterData("Ephemeral-Home"));
     if (!ctx) {
         return Result(Result::CryptoPluginVerificationError, ctx.error());
     }
 
     gpgme_error_t err;
-    err = gpgme_op_verify(ctx, gsig, gdata, NULL);
+    err = gpgme_op_verify(ctx, gsig, *gdata, NULL);
     if (gpgme_err_code(err) != GPG_ERR_NO_ERROR) {
         return Result(Result::CryptoPluginVerificationError,
                       QStringLiteral("cannot verify message: %1.").arg(gpgme_strerror(err)));
@@ -851,6 +888,74 @@ Result Daemon::Plugins::GnuPGPlugin::verify(const QByteArray &signature,
     return checkOperation(CryptoManager::OperationVerify, ctx, key, verificationStatus);
 }
 
+Result Daemon::Plugins::GnuPGPlugin::batchVerify(const QVector<QByteArray> &signatures,
+                                                 const QVector<QByteArray> &data,
+                                                 const Key &key,
+                                                 CryptoManager::SignaturePadding padding,
+                                                 CryptoManager::DigestFunction digestFunction,
+                                                 const QVariantMap &customParameters,
+                                                 QVector<CryptoManager::VerificationStatus> *verificationStatuses)
+{
+    Q_UNUSED(padding);
+    Q_UNUSED(digestFunction);
+    Q_UNUSED(customParameters);
+
+    if (!verificationStatuses) {
+        return Result(Result::CryptoPluginVerificationError,
+                      QStringLiteral("missing verificationStatuses argument."));
+    }
+    verificationStatuses->clear();
+
+    if (key.storagePluginName() != name()) {
+        return Result(Result::CryptoPluginVerificationError,
+                      QStringLiteral("cannot verify with a non GnuPG key."));
+    }
+    if (signatures.size() != data.size()) {
+        return Result(Result::CryptoPluginVerificationError,
+                      QStringLiteral("mismatched number of signatures and data."));
+    }
+
+    // The context, the engine behind it and the signing key are
+    // shared by all the messages of the batch.
+    GPGmeContext ctx(GPGmeContextPool::instance(m_protocol), key.filterData("Ephemeral-Home"));
+    if (!ctx) {
+        return Result(Result::CryptoPluginVerificationError, ctx.error());
+    }
+    GPGmeKey gkey = GPGmeKey::fromCache(GPGmeKeyCache::instance(m_protocol), ctx,
+                                        key.filterData("Ephemeral-Home"), key.name());
+    if (!gkey) {
+        return Result(Result::InvalidKeyIdentifier,
+                      QStringLiteral("cannot retrieve key %1: %2.").arg(key.name()).arg(gkey.error()));
+    }
+
+    QVector<CryptoManager::VerificationStatus> statuses;
+    statuses.reserve(signatures.size());
+    for (int i = 0; i < signatures.size(); ++i) {
+        GPGmeData gsig(signatures.at(i)), gdata(data.at(i));
+        if (!gsig || !gdata) {
+            return Result(Result::CryptoPluginVerificationError,
+                          QStringLiteral("cannot create signature data."));
+        }
+
+        // A malformed signature only fails the verification of its own message.
+        CryptoManager::VerificationStatus verificationStatus = CryptoManager::VerificationFailed;
+        gpgme_error_t err;
+        err = gpgme_op_verify(ctx, gsig, gdata, NULL);
+        gpgme_verify_result_t verif = gpgme_err_code(err) == GPG_ERR_NO_ERROR
+            ? gpgme_op_verify_result(ctx) : 0;
+        if (verif) {
+            verificationStatus = CryptoManager::VerificationStatusUnknown;
+            signatureStatus(verif, gkey, &verificationStatus);
+        } else {
+            qCDebug(lcSailfishCryptoPlugin) << "cannot verify message" << i << ":" << gpgme_strerror(err);
+        }
+        statuses.append(verificationStatus);
+    }
+
+    verificationStatuses->swap(statuses);
+    return Result();
+}
+
 Result Daemon::Plugins::GnuPGPlugin::encrypt(const QByteArray &data,
                                              const QByteArray &iv,
                                              const Key &key,
@@ -887,7 +992,6 @@ Result Daemon::Plugins::GnuPGPlugin::decrypt(const QByteArray &data,
     Q_UNUSED(padding);
     Q_UNUSED(authenticationData);
     Q_UNUSED(authenticationTag);
-    Q_UNUSED(customParameters);
 
     if (!verificationStatus) {
         return Result(Result::CryptoPluginDecryptionError,
@@ -900,19 +1004,22 @@ Result Daemon::Plugins::GnuPGPlugin::decrypt(const QByteArray &data,
                       QStringLiteral("cannot decrypt with a non GnuPG key."));
     }
 
-    GPGmeData gdata(data), output;
-    if (!gdata || !output) {
+    QByteArray result;
+    QScopedPointer<GPGmeData> gdata(inputData(data, customParameters));
+    QScopedPointer<GPGmeData> output(outputData(&result, customParameters));
+    if (!*gdata || !*output) {
         return Result(Result::CryptoPluginDecryptionError,
-                      QStringLiteral("cannot create cryptographic data."));
+                      QStringLiteral("cannot create cryptographic data: %1.")
+                      .arg(!*gdata ? gdata->error() : output->error()));
     }
 
-    GPGmeContext ctx(m_protocol, key.filterData("Ephemeral-Home"));
+    GPGmeContext ctx(GPGmeContextPool::instance(m_protocol), key.filterData("Ephemeral-Home"));
     if (!ctx) {
         return Result(Result::CryptoPluginDecryptionError, ctx.error());
     }
 
     gpgme_error_t err;
-    err = gpgme_op_decrypt_verify(ctx, gdata, output);
+    err = gpgme_op_decrypt_verify(ctx, *gdata, *output);
     if (gpgme_err_code(err) != GPG_ERR_NO_ERROR) {
         return Result(Result::CryptoPluginDecryptionError,
                       QStringLiteral("cannot decrypt message: %1.").arg(gpgme_strerror(err)));
@@ -928,7 +1035,7 @@ Result Daemon::Plugins::GnuPGPlugin::decrypt(const QByteArray &data,
         return Result(Result::CryptoPluginDecryptionError,
                       "cannot retrieve results.");
     }
-    output.releaseData(decrypted);
+    decrypted->swap(result);
 
     return Result();
 }
@@ -127,6 +127,15 @@ public:
             const QVariantMap &customParameters,
             Sailfish::Crypto::CryptoManager::VerificationStatus *verificationStatus) Q_DECL_OVERRIDE;
 
+    Sailfish::Crypto::Result batchVerify(
+            const QVector<QByteArray> &signatures,
+            const QVector<QByteArray> &data,
+            const Sailfish::Crypto::Key &key,
+            Sailfish::Crypto::CryptoManager::SignaturePadding padding,
+            Sailfish::Crypto::CryptoManager::DigestFunction digestFunction,
+            const QVariantMap &customParameters,
+            QVector<Sailfish::Crypto::CryptoManager::VerificationStatus> *verificationStatuses) Q_DECL_OVERRIDE;
+
     Sailfish::Crypto::Result encrypt(
             const QByteArray &data,
             const QByteArray &iv,
@@ -0,0 +1,202 @@
+/*
+ * Copyright (C) 2018 Jolla Ltd.
+ * Contact: Chris Adams <chris.adams@jollamobile.com>
+ * All rights reserved.
+ * BSD 3-Clause License, see LICENSE.
+ */
+
+#include "gpgmepool_p.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QMutexLocker>
+
+GPGmeContextPool *GPGmeContextPool::instance(gpgme_protocol_t protocol)
+{
+    static GPGmeContextPool openPgpPool(GPGME_PROTOCOL_OpenPGP);
+    static GPGmeContextPool cmsPool(GPGME_PROTOCOL_CMS);
+    return protocol == GPGME_PROTOCOL_CMS ? &cmsPool : &openPgpPool;
+}
+
+GPGmeContextPool::GPGmeContextPool(gpgme_protocol_t protocol)
+    : m_protocol(protocol)
+{
+}
+
+GPGmeContextPool::~GPGmeContextPool()
+{
+    for (const QVector<gpgme_ctx_t> &contexts : m_idle) {
+        for (gpgme_ctx_t ctx : contexts) {
+            gpgme_release(ctx);
+        }
+    }
+}
+
+gpgme_ctx_t GPGmeContextPool::acquire(const QString &home)
+{
+    QMutexLocker locker(&m_mutex);
+    QHash<QString, QVector<gpgme_ctx_t> >::iterator it = m_idle.find(home);
+    if (it == m_idle.end() || it->isEmpty()) {
+        return 0;
+    }
+    gpgme_ctx_t ctx = it->last();
+    it->removeLast();
+    return ctx;
+}
+
+void GPGmeContextPool::release(const QString &home, gpgme_ctx_t ctx)
+{
+    // Operations may have left signers and output options set, and
+    // an unfinished key listing (e.g. when looking up a single key).
+    gpgme_op_keylist_end(ctx);
+    gpgme_signers_clear(ctx);
+    gpgme_set_armor(ctx, 0);
+    gpgme_set_textmode(ctx, 0);
+    gpgme_set_keylist_mode(ctx, GPGME_KEYLIST_MODE_LOCAL);
+
+    QVector<gpgme_ctx_t> released;
+    {
+        QMutexLocker locker(&m_mutex);
+        m_homes.removeOne(home);
+        m_homes.append(home);
+        QVector<gpgme_ctx_t> &contexts(m_idle[home]);
+        if (contexts.size() < MaxIdleContextsPerHome) {
+            contexts.append(ctx);
+        } else {
+            released.append(ctx);
+        }
+
+        // Ephemeral home directories are usually only used for a short while.
+        while (m_homes.size() > MaxHomes) {
+            released += m_idle.take(m_homes.takeFirst());
+        }
+    }
+
+    for (gpgme_ctx_t releasedCtx : released) {
+        gpgme_release(releasedCtx);
+    }
+}
+
+GPGmeKeyCache *GPGmeKeyCache::instance(gpgme_protocol_t protocol)
+{
+    static GPGmeKeyCache openPgpCache;
+    static GPGmeKeyCache cmsCache;
+    return protocol == GPGME_PROTOCOL_CMS ? &cmsCache : &openPgpCache;
+}
+
+GPGmeKeyCache::GPGmeKeyCache()
+{
+}
+
+GPGmeKeyCache::~GPGmeKeyCache()
+{
+    for (QHash<QString, HomeCache>::iterator it = m_homes.begin(); it != m_homes.end(); ++it) {
+        clear(&it.value());
+    }
+}
+
+QByteArray GPGmeKeyCache::keyringStamp(const QString &home)
+{
+    QString homePath = home;
+    if (homePath.isEmpty()) {
+        homePath = QString::fromLocal8Bit(qgetenv("GNUPGHOME"));
+    }
+    if (homePath.isEmpty()) {
+        homePath = QDir::homePath() + QStringLiteral("/.gnupg");
+    }
+
+    // The keyboxes and keyrings of both gpg and gpgsm, and the directory
+    // of the secret keys held by gpg-agent.
+    static const char *const keyringFiles[] = {
+        "pubring.kbx", "pubring.gpg", "secring.gpg", "trustdb.gpg", "private-keys-v1.d"
+    };
+
+    QByteArray stamp;
+    for (const char *fileName : keyringFiles) {
+        const QFileInfo info(homePath + QLatin1Char('/') + QLatin1String(fileName));
+        if (info.exists()) {
+            stamp += QByteArray::number(info.lastModified().toMSecsSinceEpoch());
+            stamp += ':';
+            stamp += QByteArray::number(info.size());
+        }
+        stamp += ';';
+    }
+    return stamp;
+}
+
+void GPGmeKeyCache::clear(HomeCache *cache)
+{
+    for (gpgme_key_t key : cache->keys) {
+        gpgme_key_unref(key);
+    }
+    cache->keys.clear();
+}
+
+gpgme_key_t GPGmeKeyCache::key(const QString &home, const QByteArray &fingerprint, bool secret)
+{
+    const QByteArray stamp = keyringStamp(home);
+
+    QMutexLocker locker(&m_mutex);
+    QHash<QString, HomeCache>::iterator it = m_homes.find(home);
+    if (it == m_homes.end()) {
+        return 0;
+    }
+    if (it->keyringStamp != stamp) {
+        // The keyring was modified by someone else.
+        clear(&it.value());
+        m_homes.erase(it);
+        return 0;
+    }
+
+    gpgme_key_t key = it->keys.value((secret ? 'S' : 'P') + fingerprint, 0);
+    if (key) {
+        gpgme_key_ref(key);
+    }
+    return key;
+}
+
+void GPGmeKeyCache::insert(const QString &home, bool secret, gpgme_key_t key)
+{
+    if (!key) {
+        return;
+    }
+
+    const QByteArray stamp = keyringStamp(home);
+
+    QMutexLocker locker(&m_mutex);
+    if (!m_homes.contains(home) && m_homes.size() >= MaxHomes) {
+        QHash<QString, HomeCache>::iterator evicted = m_homes.begin();
+        clear(&evicted.value());
+        m_homes.erase(evicted);
+    }
+
+    HomeCache &cache(m_homes[home]);
+    if (cache.keyringStamp != stamp) {
+        clear(&cache);
+        cache.keyringStamp = stamp;
+    }
+
+    for (gpgme_subkey_t sub = key->subkeys; sub; sub = sub->next) {
+        if (!sub->fpr) {
+            continue;
+        }
+        const QByteArray cacheKey = (secret ? 'S' : 'P') + QByteArray(sub->fpr);
+        gpgme_key_ref(key);
+        gpgme_key_t previous = cache.keys.value(cacheKey, 0);
+        cache.keys.insert(cacheKey, key);
+        if (previous) {
+            gpgme_key_unref(previous);
+        }
+    }
+}
+
+void GPGmeKeyCache::invalidate(const QString &home)
+{
+    QMutexLocker locker(&m_mutex);
+    QHash<QString, HomeCache>::iterator it = m_homes.find(home);
+    if (it != m_homes.end()) {
+        clear(&it.value());
+        m_homes.erase(it);
+    }
+}
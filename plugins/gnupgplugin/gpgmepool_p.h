@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2018 Jolla Ltd.
+ * Contact: Chris Adams <chris.adams@jollamobile.com>
+ * All rights reserved.
+ * BSD 3-Clause License, see LICENSE.
+ */
+
+#ifndef GPGME_POOL_P_H
+#define GPGME_POOL_P_H
+
+#ifndef _FILE_OFFSET_BITS
+#define _FILE_OFFSET_BITS 64
+#endif
+#include <gpgme.h>
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// Idle gpgme contexts, per home directory, which can be reused instead
+// of creating (and configuring the engine of) a new context for each
+// operation.  A context is used by a single thread at a time: it is
+// removed from the pool when acquired, and returned to it when released.
+// The pool is shared by the crypto and storage sides of a plugin.
+class GPGmeContextPool
+{
+public:
+    static GPGmeContextPool *instance(gpgme_protocol_t protocol);
+
+    gpgme_protocol_t protocol() const { return m_protocol; }
+
+    // Returns an idle context for home, or a null context if there is none.
+    gpgme_ctx_t acquire(const QString &home);
+    // Resets the options which operations may set, and keeps the context
+    // for reuse, unless enough contexts for home are already idle.
+    void release(const QString &home, gpgme_ctx_t ctx);
+
+private:
+    explicit GPGmeContextPool(gpgme_protocol_t protocol);
+    ~GPGmeContextPool();
+    Q_DISABLE_COPY(GPGmeContextPool)
+
+    enum {
+        MaxIdleContextsPerHome = 2,
+        MaxHomes = 4
+    };
+
+    gpgme_protocol_t m_protocol;
+    QMutex m_mutex;
+    QHash<QString, QVector<gpgme_ctx_t> > m_idle;
+    QStringList m_homes; // least recently released first
+};
+
+// A cache of the keys retrieved by fingerprint, per home directory, so that
+// a key which is used repeatedly isn't looked up from gpg-agent and the
+// keyring for each operation.  The cached keys of a home directory are
+// dropped when the plugin itself modifies the keyring (import, generate,
+// delete), and when the keyring files of the home directory change.
+class GPGmeKeyCache
+{
+public:
+    static GPGmeKeyCache *instance(gpgme_protocol_t protocol);
+
+    // Returns a new reference to the cached key, or a null key.
+    gpgme_key_t key(const QString &home, const QByteArray &fingerprint, bool secret);
+    // Caches key (which must contain the fingerprint) for each of its subkeys.
+    void insert(const QString &home, bool secret, gpgme_key_t key);
+    void invalidate(const QString &home);
+
+private:
+    GPGmeKeyCache();
+    ~GPGmeKeyCache();
+    Q_DISABLE_COPY(GPGmeKeyCache)
+
+    enum {
+        MaxHomes = 4
+    };
+
+    struct HomeCache {
+        QByteArray keyringStamp;
+        QHash<QByteArray, gpgme_key_t> keys; // (secret flag + fingerprint) to key
+    };
+
+    static QByteArray keyringStamp(const QString &home);
+    static void clear(HomeCache *cache);
+
+    QMutex m_mutex;
+    QHash<QString, HomeCache> m_homes;
+};
+
+#endif // GPGME_POOL_P_H
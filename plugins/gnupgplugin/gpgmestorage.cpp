@@ -25,7 +25,7 @@ Result Daemon::Plugins::GnuPGStoragePlugin::collectionNames(QStringList *names)
 {
     names->clear();
 
-    GPGmeContext ctx(m_protocol);
+    GPGmeContext ctx(GPGmeContextPool::instance(m_protocol));
     if (!ctx) {
         return Result(Result::DatabaseError, ctx.error());
     }
@@ -144,7 +144,7 @@ Result Daemon::Plugins::GnuPGStoragePlugin::secretNames(const QString &collectio
         return Result();
     }
 
-    GPGmeContext ctx(m_protocol);
+    GPGmeContext ctx(GPGmeContextPool::instance(m_protocol));
     if (!ctx) {
         return Result(Result::DatabaseError, ctx.error());
     }
@@ -187,6 +187,21 @@ static bool matchRule(const Sailfish::Crypto::Key::FilterData &keyData,
     }
 }
 
+Result Daemon::Plugins::GnuPGStoragePlugin::findSecrets(const QString &collectionName,
+                                                        const Secret::FilterData &filter,
+                                                        StoragePlugin::FilterOperator filterOperator,
+                                                        StoragePlugin::FilterMatch filterMatch,
+                                                        QVector<Secret::Identifier> *identifiers)
+{
+    if (filterMatch != StoragePlugin::MatchExact) {
+        identifiers->clear();
+        return Result(Result::OperationNotSupportedError,
+                      QStringLiteral("Only exact filter matches are supported"));
+    }
+
+    return findSecrets(collectionName, filter, filterOperator, identifiers);
+}
+
 Result Daemon::Plugins::GnuPGStoragePlugin::findSecrets(const QString &collectionName,
                                                         const Secret::FilterData &filter,
                                                         StoragePlugin::FilterOperator filterOperator,
@@ -195,7 +210,7 @@ Result Daemon::Plugins::GnuPGStoragePlugin::findSecrets(const QString &collectio
     qCDebug(lcSailfishCryptoPlugin) << "findSecrets request" << collectionName;
     identifiers->clear();
 
-    GPGmeContext ctx(m_protocol);
+    GPGmeContext ctx(GPGmeContextPool::instance(m_protocol));
     if (!ctx) {
         return Result(Result::DatabaseError, ctx.error());
     }
@@ -212,20 +227,22 @@ Result Daemon::Plugins::GnuPGStoragePlugin::findSecrets(const QString &collectio
             bool match = false;
             const Sailfish::Crypto::Key::FilterData &keyData = key.filterData();
             switch (filterOperator) {
-            case SecretManager::OperatorOr:
+            case StoragePlugin::OperatorOr:
                 match = false;
                 for (Secret::FilterData::ConstIterator it = filter.constBegin();
                      it != filter.constEnd() && !match; it++) {
                     match = matchRule(keyData, key.algorithm(), it.key(), it.value());
                 }
                 break;
-            case SecretManager::OperatorAnd:
+            case StoragePlugin::OperatorAnd:
                 match = true;
                 for (Secret::FilterData::ConstIterator it = filter.constBegin();
                      it != filter.constEnd() && match; it++) {
                     match = matchRule(keyData, key.algorithm(), it.key(), it.value());
                 }
                 break;
+            default:
+                break;
             }
             if (match) {
                 identifiers->append(Secret::Identifier(key.name(),
@@ -345,6 +362,7 @@ Result Daemon::Plugins::GnuPGStoragePlugin::removeSecret(const QString &collecti
         gpgme_error_t err;
 #define DELETE_SECRET 1
         err = gpgme_op_delete(ctx, primary, DELETE_SECRET);
+        GPGmeKeyCache::instance(m_protocol)->invalidate(QString());
         if (gpgme_err_code(err) != GPG_ERR_NO_ERROR) {
             return Result(Result::DatabaseError,
                           QStringLiteral("cannot delete key %1: %2.").arg(secretName).arg(gpgme_strerror(err)));
@@ -354,6 +372,7 @@ Result Daemon::Plugins::GnuPGStoragePlugin::removeSecret(const QString &collecti
         GPGmeData out;
         gpgme_error_t err;
         err = gpgme_op_edit(ctx, primary, _delete_cb, &params, out);
+        GPGmeKeyCache::instance(m_protocol)->invalidate(QString());
         if (gpgme_err_code(err) != GPG_ERR_NO_ERROR) {
             return Result(Result::DatabaseError,
                           QStringLiteral("cannot delete subkey %1: %2").arg(secretName).arg(gpgme_strerror(err)));
@@ -80,6 +80,11 @@ public:
                                           const Sailfish::Secrets::Secret::FilterData &filter,
                                           Sailfish::Secrets::StoragePlugin::FilterOperator filterOperator,
                                           QVector<Sailfish::Secrets::Secret::Identifier> *identifiers) Q_DECL_OVERRIDE;
+    Sailfish::Secrets::Result findSecrets(const QString &collectionName,
+                                          const Sailfish::Secrets::Secret::FilterData &filter,
+                                          Sailfish::Secrets::StoragePlugin::FilterOperator filterOperator,
+                                          Sailfish::Secrets::StoragePlugin::FilterMatch filterMatch,
+                                          QVector<Sailfish::Secrets::Secret::Identifier> *identifiers) Q_DECL_OVERRIDE;
 
     Sailfish::Secrets::Result removeSecret(const QString &collectionName,
                                            const QString &secretName) Q_DECL_OVERRIDE;
@@ -3,14 +3,14 @@ CONFIG += plugin hide_symbols
 TARGET = sailfishcrypto-openpgp
 TARGET = $$qtLibraryTarget($$TARGET)
 LIBS += $$system(gpgme-config --libs)
-QT = core
+QT = core dbus
 
 include($$PWD/../../../common.pri)
 include($$PWD/../../../lib/libsailfishcrypto.pri)
 INCLUDEPATH += ..
 
-HEADERS += $$PWD/plugin.h $$PWD/../gpgmebase.h $$PWD/../gpgmestorage.h $$PWD/../gpgme_p.h
-SOURCES += $$PWD/plugin.cpp $$PWD/../gpgmebase.cpp $$PWD/../gpgmestorage.cpp
+HEADERS += $$PWD/plugin.h $$PWD/../gpgmebase.h $$PWD/../gpgmestorage.h $$PWD/../gpgme_p.h $$PWD/../gpgmepool_p.h
+SOURCES += $$PWD/plugin.cpp $$PWD/../gpgmebase.cpp $$PWD/../gpgmestorage.cpp $$PWD/../gpgmepool.cpp
 
 target.path = /usr/lib/Sailfish/Crypto/
 INSTALLS += target
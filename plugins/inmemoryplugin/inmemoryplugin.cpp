@@ -0,0 +1,732 @@
+/*
+ * Copyright (C) 2018 Jolla Ltd.
+ * Contact: Chris Adams <chris.adams@jollamobile.com>
+ * All rights reserved.
+ * BSD 3-Clause License, see LICENSE.
+ */
+
+#include "inmemoryplugin.h"
+#include "evp_p.h"
+#include "evpkdf_p.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QMutexLocker>
+
+#include <openssl/crypto.h>
+#include <openssl/hmac.h>
+#include <openssl/rand.h>
+
+#include <sys/mman.h>
+
+Q_PLUGIN_METADATA(IID Sailfish_Secrets_EncryptedStoragePlugin_IID)
+
+using namespace Sailfish::Secrets;
+
+namespace {
+    const int BootKeyLength = 32;           // AES-256
+    const int InitializationVectorLength = 12;
+    const int AuthenticationTagLength = 16;
+
+    QByteArray authenticationData(char domain, const QString &collectionName, const QString &secretName)
+    {
+        // binds each sealed value to the secret it belongs to.
+        QByteArray data(1, domain);
+        data.append(collectionName.toUtf8());
+        data.append('\0');
+        data.append(secretName.toUtf8());
+        return data;
+    }
+
+    Result noSuchCollection()
+    {
+        return Result(Result::InvalidCollectionError,
+                      QLatin1String("No collection with that name exists"));
+    }
+}
+
+Daemon::Plugins::InMemoryPlugin::InMemoryPlugin(QObject *parent)
+    : QObject(parent)
+    , m_bootKey(Q_NULLPTR)
+    , m_bootKeyValid(false)
+{
+    OpenSslEvp::init();
+
+    // the key never leaves this mlock()ed allocation, so that
+    // the stored data cannot be decrypted from swap.
+    m_bootKey = static_cast<unsigned char*>(malloc(BootKeyLength));
+    if (m_bootKey) {
+        if (mlock(m_bootKey, BootKeyLength) < 0) {
+            qWarning() << "In-memory plugin: unable to mlock key memory!";
+        }
+        m_bootKeyValid = RAND_bytes(m_bootKey, BootKeyLength) == 1;
+    }
+    if (!m_bootKeyValid) {
+        qWarning() << "In-memory plugin: unable to generate storage key!";
+    }
+}
+
+Daemon::Plugins::InMemoryPlugin::~InMemoryPlugin()
+{
+    m_collections.clear();
+    if (m_bootKey) {
+        OPENSSL_cleanse(m_bootKey, BootKeyLength);
+        munlock(m_bootKey, BootKeyLength);
+        free(m_bootKey);
+    }
+    OpenSslEvp::cleanup();
+}
+
+bool
+Daemon::Plugins::InMemoryPlugin::isAvailable() const
+{
+    return m_bootKeyValid;
+}
+
+QByteArray
+Daemon::Plugins::InMemoryPlugin::keyedDigest(
+        char domain,
+        const QString &field,
+        const QString &value) const
+{
+    if (!m_bootKeyValid) {
+        return QByteArray();
+    }
+
+    // filter data matches are case insensitive.
+    QByteArray data(1, domain);
+    data.append(field.toCaseFolded().toUtf8());
+    data.append('\0');
+    data.append(value.toCaseFolded().toUtf8());
+
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int digestLength = 0;
+    if (!HMAC(OpenSslEvp::fetched_digest(OpenSslEvp::Sha256),
+              m_bootKey, BootKeyLength,
+              reinterpret_cast<const unsigned char*>(data.constData()), data.size(),
+              digest, &digestLength)) {
+        return QByteArray();
+    }
+    return QByteArray(reinterpret_cast<const char*>(digest), digestLength);
+}
+
+QVector<QByteArray>
+Daemon::Plugins::InMemoryPlugin::filterDigests(
+        const Secret::FilterData &filterData) const
+{
+    // index each field by its whole value (for exact matches)
+    // and by each of the words of the value (for full-text matches).
+    QSet<QByteArray> digests;
+    for (Secret::FilterData::const_iterator it = filterData.constBegin(); it != filterData.constEnd(); it++) {
+        digests.insert(keyedDigest('v', it.key(), it.value()));
+        const QStringList words = StoragePlugin::filterWords(it.value());
+        for (const QString &word : words) {
+            digests.insert(keyedDigest('w', it.key(), word));
+        }
+    }
+    digests.remove(QByteArray());
+
+    QVector<QByteArray> retn;
+    retn.reserve(digests.size());
+    for (const QByteArray &digest : digests) {
+        retn.append(digest);
+    }
+    return retn;
+}
+
+QSet<QString>
+Daemon::Plugins::InMemoryPlugin::indexedMatches(
+        const Collection &collection,
+        const Secret::FilterData &filter,
+        StoragePlugin::FilterOperator filterOperator,
+        StoragePlugin::FilterMatch filterMatch) const
+{
+    const bool requireAll = filterOperator == StoragePlugin::OperatorAnd;
+    const bool fullText = filterMatch == StoragePlugin::MatchFullText;
+    QSet<QString> matches;
+    bool first = true;
+    for (Secret::FilterData::const_iterator it = filter.constBegin(); it != filter.constEnd(); it++) {
+        QSet<QString> fieldMatches;
+        if (!fullText) {
+            fieldMatches = collection.filterIndex.value(keyedDigest('v', it.key(), it.value()));
+        } else {
+            // a full-text filter value matches if every one of its words is in the value.
+            const QStringList words = StoragePlugin::filterWords(it.value());
+            for (int i = 0; i < words.size(); ++i) {
+                const QSet<QString> wordMatches = collection.filterIndex.value(keyedDigest('w', it.key(), words.at(i)));
+                fieldMatches = i == 0 ? wordMatches : fieldMatches.intersect(wordMatches);
+                if (fieldMatches.isEmpty()) {
+                    break;
+                }
+            }
+        }
+
+        if (requireAll) {
+            matches = first ? fieldMatches : matches.intersect(fieldMatches);
+            first = false;
+            if (matches.isEmpty()) {
+                break;
+            }
+        } else {
+            matches.unite(fieldMatches);
+        }
+    }
+    return matches;
+}
+
+bool
+Daemon::Plugins::InMemoryPlugin::seal(
+        const QByteArray &plaintext,
+        const QByteArray &authenticationData,
+        QByteArray *sealed) const
+{
+    if (!m_bootKeyValid) {
+        return false;
+    }
+
+    // prefix a version byte, as the plaintext of the cipher may not be empty.
+    QByteArray data(1, '\1');
+    data.append(plaintext);
+
+    unsigned char initVector[InitializationVectorLength];
+    if (RAND_bytes(initVector, InitializationVectorLength) != 1) {
+        OPENSSL_cleanse(data.data(), data.size());
+        return false;
+    }
+
+    unsigned char *encrypted = NULL;
+    unsigned char *tag = NULL;
+    const int size = OpenSslEvp::aes_auth_encrypt_plaintext(
+                OpenSslEvp::fetched_cipher(OpenSslEvp::Aes256Gcm),
+                initVector, InitializationVectorLength,
+                m_bootKey, BootKeyLength,
+                reinterpret_cast<const unsigned char*>(authenticationData.constData()),
+                authenticationData.size(),
+                reinterpret_cast<const unsigned char*>(data.constData()),
+                data.size(),
+                &encrypted,
+                &tag,
+                AuthenticationTagLength);
+    OPENSSL_cleanse(data.data(), data.size());
+    if (size <= 0) {
+        return false;
+    }
+
+    // sealed data is: initialization vector, authentication tag, ciphertext.
+    sealed->clear();
+    sealed->reserve(InitializationVectorLength + AuthenticationTagLength + size);
+    sealed->append(reinterpret_cast<const char*>(initVector), InitializationVectorLength);
+    sealed->append(reinterpret_cast<const char*>(tag), AuthenticationTagLength);
+    sealed->append(reinterpret_cast<const char*>(encrypted), size);
+    free(encrypted);
+    free(tag);
+    return true;
+}
+
+bool
+Daemon::Plugins::InMemoryPlugin::unseal(
+        const QByteArray &sealed,
+        const QByteArray &authenticationData,
+        QByteArray *plaintext) const
+{
+    if (!m_bootKeyValid || sealed.size() <= InitializationVectorLength + AuthenticationTagLength) {
+        return false;
+    }
+
+    QByteArray tag = sealed.mid(InitializationVectorLength, AuthenticationTagLength);
+    unsigned char *decrypted = NULL;
+    int verified = 0;
+    const int size = OpenSslEvp::aes_auth_decrypt_ciphertext(
+                OpenSslEvp::fetched_cipher(OpenSslEvp::Aes256Gcm),
+                reinterpret_cast<const unsigned char*>(sealed.constData()), InitializationVectorLength,
+                m_bootKey, BootKeyLength,
+                reinterpret_cast<const unsigned char*>(authenticationData.constData()),
+                authenticationData.size(),
+                reinterpret_cast<unsigned char*>(tag.data()), AuthenticationTagLength,
+                reinterpret_cast<const unsigned char*>(sealed.constData()) + InitializationVectorLength + AuthenticationTagLength,
+                sealed.size() - InitializationVectorLength - AuthenticationTagLength,
+                &decrypted,
+                &verified);
+    if (size <= 0) {
+        return false;
+    }
+
+    const bool valid = verified > 0 && decrypted[0] == '\1';
+    if (valid) {
+        *plaintext = QByteArray(reinterpret_cast<const char*>(decrypted) + 1, size - 1);
+    }
+    OPENSSL_cleanse(decrypted, size);
+    free(decrypted);
+    return valid;
+}
+
+bool
+Daemon::Plugins::InMemoryPlugin::unsealFilterData(
+        const QString &collectionName,
+        const QString &secretName,
+        const StoredSecret &stored,
+        Secret::FilterData *filterData) const
+{
+    QByteArray serializedFilterData;
+    if (!unseal(stored.filterData, authenticationData('f', collectionName, secretName), &serializedFilterData)) {
+        return false;
+    }
+
+    QMap<QString, QString> secretFilterData;
+    QDataStream in(serializedFilterData);
+    in >> secretFilterData;
+    *filterData = secretFilterData;
+    return in.status() == QDataStream::Ok;
+}
+
+Result
+Daemon::Plugins::InMemoryPlugin::unlockedCollection(
+        const QString &collectionName,
+        Collection **collection)
+{
+    if (collectionName.isEmpty()) {
+        return Result(Result::InvalidCollectionError,
+                      QString::fromUtf8("Empty collection name given"));
+    }
+
+    QHash<QString, Collection>::iterator it = m_collections.find(collectionName);
+    if (it == m_collections.end()) {
+        return noSuchCollection();
+    } else if (it->locked) {
+        return Result(Result::CollectionIsLockedError,
+                      QLatin1String("That collection is locked"));
+    }
+
+    *collection = &(*it);
+    return Result(Result::Succeeded);
+}
+
+Result
+Daemon::Plugins::InMemoryPlugin::collectionNames(QStringList *names)
+{
+    QMutexLocker locker(&m_mutex);
+    *names = m_collections.keys();
+    return Result(Result::Succeeded);
+}
+
+Result
+Daemon::Plugins::InMemoryPlugin::createCollection(
+        const QString &collectionName,
+        const QByteArray &key)
+{
+    QMutexLocker locker(&m_mutex);
+    if (collectionName.isEmpty()) {
+        return Result(Result::InvalidCollectionError,
+                      QString::fromUtf8("Empty collection name given"));
+    } else if (m_collections.contains(collectionName)) {
+        return Result(Result::CollectionAlreadyExistsError,
+                      QLatin1String("A collection with that name already exists"));
+    }
+
+    Collection collection;
+    collection.keyDigest = keyedDigest('k', collectionName, QString::fromLatin1(key.toHex()));
+    if (collection.keyDigest.isEmpty()) {
+        return Result(Result::SecretsPluginEncryptionError,
+                      QLatin1String("In-memory plugin unable to store the collection key"));
+    }
+    m_collections.insert(collectionName, collection);
+    return Result(Result::Succeeded);
+}
+
+Result
+Daemon::Plugins::InMemoryPlugin::removeCollection(
+        const QString &collectionName)
+{
+    QMutexLocker locker(&m_mutex);
+    m_collections.remove(collectionName);
+    return Result(Result::Succeeded);
+}
+
+Result
+Daemon::Plugins::InMemoryPlugin::isCollectionLocked(
+        const QString &collectionName,
+        bool *locked)
+{
+    QMutexLocker locker(&m_mutex);
+    QHash<QString, Collection>::const_iterator it = m_collections.constFind(collectionName);
+    if (it == m_collections.constEnd()) {
+        return noSuchCollection();
+    }
+    *locked = it->locked;
+    return Result(Result::Succeeded);
+}
+
+Result
+Daemon::Plugins::InMemoryPlugin::deriveKeyFromCode(
+        const QByteArray &authenticationCode,
+        const QByteArray &salt,
+        QByteArray *key)
+{
+    return deriveKeyFromCodeWithParameters(authenticationCode, salt, QVariantMap(), key);
+}
+
+Result
+Daemon::Plugins::InMemoryPlugin::deriveKeyFromCodeWithParameters(
+        const QByteArray &authenticationCode,
+        const QByteArray &salt,
+        const QVariantMap &parameters,
+        QByteArray *key)
+{
+    if (!OpenSslKdf::parametersSupported(parameters, salt)) {
+        return Result(Result::OperationNotSupportedError,
+                      QLatin1String("Unsupported key derivation parameters specified"));
+    }
+
+    const QByteArray derived = OpenSslKdf::deriveKey(authenticationCode, salt, parameters,
+                                                     32); // 256 bit
+    if (derived.isEmpty()) {
+        return Result(Result::SecretsPluginKeyDerivationError,
+                      QLatin1String("The In-memory plugin failed to derive the key data"));
+    }
+
+    *key = derived;
+    return Result(Result::Succeeded);
+}
+
+Result
+Daemon::Plugins::InMemoryPlugin::setEncryptionKey(
+        const QString &collectionName,
+        const QByteArray &key)
+{
+    QMutexLocker locker(&m_mutex);
+    QHash<QString, Collection>::iterator it = m_collections.find(collectionName);
+    if (it == m_collections.end()) {
+        return noSuchCollection();
+    }
+
+    if (key.isEmpty()) {
+        // caller wants to lock the collection.  succeeded.
+        it->locked = true;
+        return Result(Result::Succeeded);
+    }
+
+    const QByteArray keyDigest = keyedDigest('k', collectionName, QString::fromLatin1(key.toHex()));
+    if (keyDigest.size() != it->keyDigest.size()
+            || CRYPTO_memcmp(keyDigest.constData(), it->keyDigest.constData(), keyDigest.size()) != 0) {
+        it->locked = true;
+        return Result(Result::IncorrectAuthenticationCodeError,
+                      QLatin1String("The given key is not the key of the collection"));
+    }
+
+    it->locked = false;
+    return Result(Result::Succeeded);
+}
+
+Result
+Daemon::Plugins::InMemoryPlugin::reencrypt(
+        const QString &collectionName,
+        const QByteArray &oldkey,
+        const QByteArray &newkey)
+{
+    Result retn = setEncryptionKey(collectionName, oldkey);
+    if (retn.code() == Result::Succeeded) {
+        // the stored data is encrypted with the storage key rather than the
+        // collection key, so only the key which unlocks the collection changes.
+        QMutexLocker locker(&m_mutex);
+        const QByteArray keyDigest = keyedDigest('k', collectionName, QString::fromLatin1(newkey.toHex()));
+        QHash<QString, Collection>::iterator it = m_collections.find(collectionName);
+        if (it == m_collections.end()) {
+            retn = noSuchCollection();
+        } else if (keyDigest.isEmpty()) {
+            retn = Result(Result::SecretsPluginEncryptionError,
+                          QLatin1String("In-memory plugin unable to store the collection key"));
+        } else {
+            it->keyDigest = keyDigest;
+        }
+    }
+
+    return retn;
+}
+
+Result
+Daemon::Plugins::InMemoryPlugin::setSecret(
+        const QString &collectionName,
+        const QString &secretName,
+        const QByteArray &secret,
+        const Secret::FilterData &filterData)
+{
+    if (secretName.isEmpty()) {
+        return Result(Result::InvalidSecretError,
+                      QString::fromUtf8("Empty secret name given"));
+    }
+
+    QMutexLocker locker(&m_mutex);
+    Collection *collection = Q_NULLPTR;
+    Result retn = unlockedCollection(collectionName, &collection);
+    if (retn.code() != Result::Succeeded) {
+        return retn;
+    }
+
+    QByteArray serializedFilterData;
+    {
+        QDataStream out(&serializedFilterData, QIODevice::WriteOnly);
+        out << static_cast<const QMap<QString, QString> &>(filterData);
+    }
+
+    StoredSecret stored;
+    if (!seal(secret, authenticationData('s', collectionName, secretName), &stored.secret)
+            || !seal(serializedFilterData, authenticationData('f', collectionName, secretName), &stored.filterData)) {
+        return Result(Result::SecretsPluginEncryptionError,
+                      QLatin1String("In-memory plugin failed to encrypt the secret"));
+    }
+    stored.filterDigests = filterDigests(filterData);
+
+    // replace any previously stored secret with that name.
+    QHash<QString, StoredSecret>::iterator it = collection->secrets.find(secretName);
+    if (it != collection->secrets.end()) {
+        for (const QByteArray &digest : it->filterDigests) {
+            QHash<QByteArray, QSet<QString> >::iterator iit = collection->filterIndex.find(digest);
+            if (iit != collection->filterIndex.end()) {
+                iit->remove(secretName);
+                if (iit->isEmpty()) {
+                    collection->filterIndex.erase(iit);
+                }
+            }
+        }
+    }
+    for (const QByteArray &digest : stored.filterDigests) {
+        collection->filterIndex[digest].insert(secretName);
+    }
+    collection->secrets.insert(secretName, stored);
+    return Result(Result::Succeeded);
+}
+
+Result
+Daemon::Plugins::InMemoryPlugin::getSecret(
+        const QString &collectionName,
+        const QString &secretName,
+        QByteArray *secret,
+        Secret::FilterData *filterData)
+{
+    if (secretName.isEmpty()) {
+        return Result(Result::InvalidSecretError,
+                      QString::fromUtf8("Empty secret name given"));
+    }
+
+    QMutexLocker locker(&m_mutex);
+    Collection *collection = Q_NULLPTR;
+    Result retn = unlockedCollection(collectionName, &collection);
+    if (retn.code() != Result::Succeeded) {
+        return retn;
+    }
+
+    QHash<QString, StoredSecret>::const_iterator it = collection->secrets.constFind(secretName);
+    if (it == collection->secrets.constEnd()) {
+        return Result(Result::InvalidSecretError,
+                      QString::fromUtf8("No such secret stored"));
+    }
+
+    QByteArray secretData;
+    Secret::FilterData secretFilterData;
+    if (!unseal(it->secret, authenticationData('s', collectionName, secretName), &secretData)
+            || !unsealFilterData(collectionName, secretName, *it, &secretFilterData)) {
+        return Result(Result::SecretsPluginDecryptionError,
+                      QLatin1String("In-memory plugin failed to decrypt the secret"));
+    }
+
+    *secret = secretData;
+    *filterData = secretFilterData;
+    return Result(Result::Succeeded);
+}
+
+Result
+Daemon::Plugins::InMemoryPlugin::getSecretFilterData(
+        const QString &collectionName,
+        const QString &secretName,
+        Secret::FilterData *filterData)
+{
+    if (secretName.isEmpty()) {
+        return Result(Result::InvalidSecretError,
+                      QString::fromUtf8("Empty secret name given"));
+    }
+
+    QMutexLocker locker(&m_mutex);
+    Collection *collection = Q_NULLPTR;
+    Result retn = unlockedCollection(collectionName, &collection);
+    if (retn.code() != Result::Succeeded) {
+        return retn;
+    }
+
+    // only the filter data is decrypted, not the secret itself.
+    QHash<QString, StoredSecret>::const_iterator it = collection->secrets.constFind(secretName);
+    if (it == collection->secrets.constEnd()) {
+        return Result(Result::InvalidSecretError,
+                      QString::fromUtf8("No such secret stored"));
+    } else if (!unsealFilterData(collectionName, secretName, *it, filterData)) {
+        return Result(Result::SecretsPluginDecryptionError,
+                      QLatin1String("In-memory plugin failed to decrypt the secret filter data"));
+    }
+
+    return Result(Result::Succeeded);
+}
+
+Result
+Daemon::Plugins::InMemoryPlugin::secretNames(
+        const QString &collectionName,
+        QStringList *secretNames)
+{
+    QMutexLocker locker(&m_mutex);
+    Collection *collection = Q_NULLPTR;
+    Result retn = unlockedCollection(collectionName, &collection);
+    if (retn.code() != Result::Succeeded) {
+        return retn;
+    }
+
+    *secretNames = collection->secrets.keys();
+    return Result(Result::Succeeded);
+}
+
+Result
+Daemon::Plugins::InMemoryPlugin::findSecrets(
+        const QString &collectionName,
+        const Secret::FilterData &filter,
+        StoragePlugin::FilterOperator filterOperator,
+        QVector<Secret::Identifier> *identifiers)
+{
+    return findSecrets(collectionName, filter, filterOperator, StoragePlugin::MatchExact, identifiers);
+}
+
+Result
+Daemon::Plugins::InMemoryPlugin::findSecrets(
+        const QString &collectionName,
+        const Secret::FilterData &filter,
+        StoragePlugin::FilterOperator filterOperator,
+        StoragePlugin::FilterMatch filterMatch,
+        QVector<Secret::Identifier> *identifiers)
+{
+    if (filter.isEmpty()) {
+        return Result(Result::InvalidFilterError,
+                      QString::fromUtf8("Empty filter given"));
+    }
+
+    if (filterMatch != StoragePlugin::MatchExact
+            && filterMatch != StoragePlugin::MatchPrefix
+            && filterMatch != StoragePlugin::MatchGlob
+            && filterMatch != StoragePlugin::MatchFullText) {
+        return Result(Result::OperationNotSupportedError,
+                      QString::fromUtf8("In-memory plugin does not support the given filter match"));
+    }
+
+    QMutexLocker locker(&m_mutex);
+    Collection *collection = Q_NULLPTR;
+    Result retn = unlockedCollection(collectionName, &collection);
+    if (retn.code() != Result::Succeeded) {
+        return retn;
+    }
+
+    // exact and full-text matches are looked up in the index,
+    // other matches require the filter data of each secret.
+    QSet<QString> matchingSecretNames;
+    if (filterMatch == StoragePlugin::MatchExact || filterMatch == StoragePlugin::MatchFullText) {
+        matchingSecretNames = indexedMatches(*collection, filter, filterOperator, filterMatch);
+    } else {
+        for (QHash<QString, StoredSecret>::const_iterator it = collection->secrets.constBegin(); it != collection->secrets.constEnd(); it++) {
+            Secret::FilterData secretFilterData;
+            if (!unsealFilterData(collectionName, it.key(), *it, &secretFilterData)) {
+                return Result(Result::SecretsPluginDecryptionError,
+                              QLatin1String("In-memory plugin failed to decrypt the secret filter data"));
+            }
+            if (StoragePlugin::filterDataMatches(secretFilterData, filter, filterOperator, filterMatch)) {
+                matchingSecretNames.insert(it.key());
+            }
+        }
+    }
+
+    QVector<Secret::Identifier> matches;
+    const QString pluginName = name();
+    matches.reserve(matchingSecretNames.size());
+    for (const QString &secretName : matchingSecretNames) {
+        matches.append(Secret::Identifier(secretName, collectionName, pluginName));
+    }
+
+    *identifiers = matches;
+    return Result(Result::Succeeded);
+}
+
+Result
+Daemon::Plugins::InMemoryPlugin::removeSecret(
+        const QString &collectionName,
+        const QString &secretName)
+{
+    if (secretName.isEmpty()) {
+        return Result(Result::InvalidSecretError,
+                      QString::fromUtf8("Empty secret name given"));
+    }
+
+    QMutexLocker locker(&m_mutex);
+    Collection *collection = Q_NULLPTR;
+    Result retn = unlockedCollection(collectionName, &collection);
+    if (retn.code() != Result::Succeeded) {
+        return retn;
+    }
+
+    const StoredSecret stored = collection->secrets.take(secretName);
+    for (const QByteArray &digest : stored.filterDigests) {
+        QHash<QByteArray, QSet<QString> >::iterator iit = collection->filterIndex.find(digest);
+        if (iit != collection->filterIndex.end()) {
+            iit->remove(secretName);
+            if (iit->isEmpty()) {
+                collection->filterIndex.erase(iit);
+            }
+        }
+    }
+
+    return Result(Result::Succeeded);
+}
+
+Result
+Daemon::Plugins::InMemoryPlugin::setSecret(
+        const QString &secretName,
+        const QByteArray &secret,
+        const Secret::FilterData &filterData,
+        const QByteArray &key)
+{
+    Q_UNUSED(secretName);
+    Q_UNUSED(secret);
+    Q_UNUSED(filterData);
+    Q_UNUSED(key);
+    return Result(Result::OperationNotSupportedError,
+                  QLatin1String("In-memory plugin doesn't support standalone secret operations"));
+}
+
+Result
+Daemon::Plugins::InMemoryPlugin::accessSecret(
+        const QString &secretName,
+        const QByteArray &key,
+        QByteArray *secret,
+        Secret::FilterData *filterData)
+{
+    Q_UNUSED(secretName);
+    Q_UNUSED(secret);
+    Q_UNUSED(filterData);
+    Q_UNUSED(key);
+    return Result(Result::OperationNotSupportedError,
+                  QLatin1String("In-memory plugin doesn't support standalone secret operations"));
+}
+
+Result
+Daemon::Plugins::InMemoryPlugin::removeSecret(
+        const QString &secretName)
+{
+    Q_UNUSED(secretName);
+    return Result(Result::OperationNotSupportedError,
+                  QLatin1String("In-memory plugin doesn't support standalone secret operations"));
+}
+
+Result
+Daemon::Plugins::InMemoryPlugin::reencryptSecret(
+        const QString &secretName,
+        const QByteArray &oldkey,
+        const QByteArray &newkey)
+{
+    Q_UNUSED(secretName);
+    Q_UNUSED(oldkey);
+    Q_UNUSED(newkey);
+    return Result(Result::OperationNotSupportedError,
+                  QLatin1String("In-memory plugin doesn't support standalone secret operations"));
+}
@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2018 Jolla Ltd.
+ * Contact: Chris Adams <chris.adams@jollamobile.com>
+ * All rights reserved.
+ * BSD 3-Clause License, see LICENSE.
+ */
+
+#ifndef SAILFISHSECRETS_PLUGIN_ENCRYPTEDSTORAGE_INMEMORY_H
+#define SAILFISHSECRETS_PLUGIN_ENCRYPTEDSTORAGE_INMEMORY_H
+
+#include "Secrets/Plugins/extensionplugins.h"
+
+#include "Secrets/secret.h"
+#include "Secrets/result.h"
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+#include <QString>
+#include <QByteArray>
+#include <QMutex>
+
+namespace Sailfish {
+
+namespace Secrets {
+
+namespace Daemon {
+
+namespace Plugins {
+
+// Stores collections in memory only, so that they do not survive a reboot.
+// Secrets and their filter data are encrypted with AES-256-GCM under a random
+// key which is generated when the plugin is loaded and kept in mlock()ed memory.
+// Filter data is indexed by keyed digests of its fields and values (and words),
+// so exact and full-text matches do not need to decrypt every secret.
+// The collections are lost by design when the daemon exits.  At the next
+// startup the daemon's metadata for them is removed, as the plugin wrapper
+// synchronizes the metadata database with the (empty) plugin when it is
+// initialized, see MetadataDatabase::initializeCollectionsFromPluginData().
+class Q_DECL_EXPORT InMemoryPlugin : public QObject, public virtual Sailfish::Secrets::EncryptedStoragePlugin
+{
+    Q_OBJECT
+    Q_PLUGIN_METADATA(IID Sailfish_Secrets_EncryptedStoragePlugin_IID)
+    Q_INTERFACES(Sailfish::Secrets::EncryptedStoragePlugin)
+
+public:
+    InMemoryPlugin(QObject *parent = Q_NULLPTR);
+    ~InMemoryPlugin();
+
+    QString displayName() const Q_DECL_OVERRIDE {
+        return QStringLiteral("In-memory");
+    }
+    QString name() const Q_DECL_OVERRIDE {
+#ifdef SAILFISHSECRETS_TESTPLUGIN
+        return QLatin1String("org.sailfishos.secrets.plugin.encryptedstorage.inmemory.test");
+#else
+        return QLatin1String("org.sailfishos.secrets.plugin.encryptedstorage.inmemory");
+#endif
+    }
+    int version() const Q_DECL_OVERRIDE {
+        return 1;
+    }
+
+    bool isAvailable() const Q_DECL_OVERRIDE;
+
+    Sailfish::Secrets::StoragePlugin::StorageType storageType() const Q_DECL_OVERRIDE { return Sailfish::Secrets::StoragePlugin::InMemoryStorage; }
+    Sailfish::Secrets::EncryptionPlugin::EncryptionType encryptionType() const Q_DECL_OVERRIDE { return Sailfish::Secrets::EncryptionPlugin::SoftwareEncryption; }
+    Sailfish::Secrets::EncryptionPlugin::EncryptionAlgorithm encryptionAlgorithm() const Q_DECL_OVERRIDE { return Sailfish::Secrets::EncryptionPlugin::CustomAlgorithm; }
+
+    Sailfish::Secrets::Result collectionNames(QStringList *names) Q_DECL_OVERRIDE;
+    Sailfish::Secrets::Result createCollection(const QString &collectionName, const QByteArray &key) Q_DECL_OVERRIDE;
+    Sailfish::Secrets::Result removeCollection(const QString &collectionName) Q_DECL_OVERRIDE;
+
+    Sailfish::Secrets::Result isCollectionLocked(const QString &collectionName, bool *locked) Q_DECL_OVERRIDE;
+    Sailfish::Secrets::Result deriveKeyFromCode(const QByteArray &authenticationCode, const QByteArray &salt, QByteArray *key) Q_DECL_OVERRIDE;
+    Sailfish::Secrets::Result deriveKeyFromCodeWithParameters(const QByteArray &authenticationCode, const QByteArray &salt, const QVariantMap &parameters, QByteArray *key) Q_DECL_OVERRIDE;
+    Sailfish::Secrets::Result setEncryptionKey(const QString &collectionName, const QByteArray &key) Q_DECL_OVERRIDE;
+    Sailfish::Secrets::Result reencrypt(const QString &collectionName, const QByteArray &oldkey, const QByteArray &newkey) Q_DECL_OVERRIDE;
+
+    Sailfish::Secrets::Result setSecret(const QString &collectionName, const QString &secretName, const QByteArray &secret, const Sailfish::Secrets::Secret::FilterData &filterData) Q_DECL_OVERRIDE;
+    Sailfish::Secrets::Result getSecret(const QString &collectionName, const QString &secretName, QByteArray *secret, Sailfish::Secrets::Secret::FilterData *filterData) Q_DECL_OVERRIDE;
+    Sailfish::Secrets::Result getSecretFilterData(const QString &collectionName, const QString &secretName, Sailfish::Secrets::Secret::FilterData *filterData) Q_DECL_OVERRIDE;
+    Sailfish::Secrets::Result secretNames(const QString &collectionName, QStringList *secretNames) Q_DECL_OVERRIDE;
+    Sailfish::Secrets::Result findSecrets(const QString &collectionName, const Sailfish::Secrets::Secret::FilterData &filter, Sailfish::Secrets::StoragePlugin::FilterOperator filterOperator, QVector<Sailfish::Secrets::Secret::Identifier> *identifiers) Q_DECL_OVERRIDE;
+    Sailfish::Secrets::Result findSecrets(const QString &collectionName, const Sailfish::Secrets::Secret::FilterData &filter, Sailfish::Secrets::StoragePlugin::FilterOperator filterOperator, Sailfish::Secrets::StoragePlugin::FilterMatch filterMatch, QVector<Sailfish::Secrets::Secret::Identifier> *identifiers) Q_DECL_OVERRIDE;
+    Sailfish::Secrets::Result removeSecret(const QString &collectionName, const QString &secretName) Q_DECL_OVERRIDE;
+
+    Sailfish::Secrets::Result setSecret(const QString &secretName, const QByteArray &secret, const Sailfish::Secrets::Secret::FilterData &filterData, const QByteArray &key) Q_DECL_OVERRIDE;
+    Sailfish::Secrets::Result accessSecret(const QString &secretName, const QByteArray &key, QByteArray *secret, Sailfish::Secrets::Secret::FilterData *filterData) Q_DECL_OVERRIDE;
+    Sailfish::Secrets::Result removeSecret(const QString &secretName) Q_DECL_OVERRIDE;
+    Sailfish::Secrets::Result reencryptSecret(const QString &secretName, const QByteArray &oldkey, const QByteArray &newkey) Q_DECL_OVERRIDE;
+
+private:
+    struct StoredSecret {
+        QByteArray secret;     // sealed secret data
+        QByteArray filterData; // sealed serialized filter data
+        QVector<QByteArray> filterDigests; // index keys referring to this secret
+    };
+    struct Collection {
+        Collection() : locked(false) {}
+        QByteArray keyDigest;
+        bool locked;
+        QHash<QString, StoredSecret> secrets;
+        QHash<QByteArray, QSet<QString> > filterIndex; // keyed digest to secret names
+    };
+
+    QByteArray keyedDigest(char domain, const QString &field, const QString &value) const;
+    QVector<QByteArray> filterDigests(const Sailfish::Secrets::Secret::FilterData &filterData) const;
+    QSet<QString> indexedMatches(const Collection &collection, const Sailfish::Secrets::Secret::FilterData &filter, Sailfish::Secrets::StoragePlugin::FilterOperator filterOperator, Sailfish::Secrets::StoragePlugin::FilterMatch filterMatch) const;
+    bool seal(const QByteArray &plaintext, const QByteArray &authenticationData, QByteArray *sealed) const;
+    bool unseal(const QByteArray &sealed, const QByteArray &authenticationData, QByteArray *plaintext) const;
+    bool unsealFilterData(const QString &collectionName, const QString &secretName, const StoredSecret &stored, Sailfish::Secrets::Secret::FilterData *filterData) const;
+    Sailfish::Secrets::Result unlockedCollection(const QString &collectionName, Collection **collection);
+
+    QHash<QString, Collection> m_collections;
+    unsigned char *m_bootKey;
+    bool m_bootKeyValid;
+    mutable QMutex m_mutex;
+};
+
+} // namespace Plugins
+
+} // namespace Daemon
+
+} // namespace Secrets
+
+} // namespace Sailfish
+
+#endif // SAILFISHSECRETS_PLUGIN_ENCRYPTEDSTORAGE_INMEMORY_H
@@ -0,0 +1,20 @@
+TEMPLATE = lib
+CONFIG += plugin hide_symbols link_pkgconfig
+TARGET = sailfishsecrets-inmemory
+TARGET = $$qtLibraryTarget($$TARGET)
+PKGCONFIG += libcrypto
+
+include($$PWD/../../common.pri)
+include($$PWD/../../lib/libsailfishsecretspluginapi.pri)
+include($$PWD/../../lib/libsailfishcryptoevp.pri)
+
+INCLUDEPATH += $$PWD/../opensslcryptoplugin/evp/
+DEPENDPATH += $$PWD/../opensslcryptoplugin/evp/
+
+HEADERS += \
+    $$PWD/inmemoryplugin.h
+SOURCES += \
+    $$PWD/inmemoryplugin.cpp
+
+target.path=/usr/lib/Sailfish/Secrets/
+INSTALLS += target
@@ -11,9 +11,18 @@
 #include <openssl/pem.h>
 #include <openssl/crypto.h>
 
+#if OPENSSL_VERSION_NUMBER >= 0x30200000L
+#include <openssl/core_names.h>
+#include <openssl/kdf.h>
+#include <openssl/params.h>
+#include <openssl/thread.h>
+#endif
+
 #include <QtCore/QMutex>
 #include <QtCore/QVector>
 #include <QtCore/QThread>
+#include <QtCore/QThreadPool>
+#include <QtCore/QRunnable>
 #include <QtCore/QHash>
 
 #define OSSLEVP_PRINT_ERR(message) \
@@ -87,35 +96,204 @@ static unsigned long qthreads_thread_id()
 
 #endif // OPENSSL_VERSION_NUMBER < 0x10100000L
 
+namespace {
+
+struct CipherEntry
+{
+    const char *name;
+    const EVP_CIPHER *(*legacy)(void);
+};
+
+struct DigestEntry
+{
+    const char *name;
+    const EVP_MD *(*legacy)(void);
+};
+
+// Indexed by OpenSslEvp::CipherAlgorithm.
+const CipherEntry s_cipherEntries[OpenSslEvp::CipherAlgorithmCount] = {
+    { "AES-128-ECB", EVP_aes_128_ecb }, { "AES-192-ECB", EVP_aes_192_ecb }, { "AES-256-ECB", EVP_aes_256_ecb },
+    { "AES-128-CBC", EVP_aes_128_cbc }, { "AES-192-CBC", EVP_aes_192_cbc }, { "AES-256-CBC", EVP_aes_256_cbc },
+    { "AES-128-CFB1", EVP_aes_128_cfb1 }, { "AES-192-CFB1", EVP_aes_192_cfb1 }, { "AES-256-CFB1", EVP_aes_256_cfb1 },
+    { "AES-128-CFB8", EVP_aes_128_cfb8 }, { "AES-192-CFB8", EVP_aes_192_cfb8 }, { "AES-256-CFB8", EVP_aes_256_cfb8 },
+    { "AES-128-CFB", EVP_aes_128_cfb128 }, { "AES-192-CFB", EVP_aes_192_cfb128 }, { "AES-256-CFB", EVP_aes_256_cfb128 },
+    { "AES-128-OFB", EVP_aes_128_ofb }, { "AES-192-OFB", EVP_aes_192_ofb }, { "AES-256-OFB", EVP_aes_256_ofb },
+    { "AES-128-CTR", EVP_aes_128_ctr }, { "AES-192-CTR", EVP_aes_192_ctr }, { "AES-256-CTR", EVP_aes_256_ctr },
+    { "AES-128-GCM", EVP_aes_128_gcm }, { "AES-192-GCM", EVP_aes_192_gcm }, { "AES-256-GCM", EVP_aes_256_gcm },
+    { "AES-128-CCM", EVP_aes_128_ccm }, { "AES-192-CCM", EVP_aes_192_ccm }, { "AES-256-CCM", EVP_aes_256_ccm },
+    { "AES-128-XTS", EVP_aes_128_xts }, { "AES-256-XTS", EVP_aes_256_xts }
+};
+
+// Indexed by OpenSslEvp::DigestAlgorithm.
+const DigestEntry s_digestEntries[OpenSslEvp::DigestAlgorithmCount] = {
+    { "SHA1", EVP_sha1 },
+    { "SHA256", EVP_sha256 },
+    { "SHA512", EVP_sha512 },
+    { "MD5", EVP_md5 }
+};
+
+int initializeLibrary()
+{
+#if OPENSSL_VERSION_NUMBER >= 0x10100000L
+    // Since OpenSSL 1.1.0 the library initializes itself thread-safely,
+    // including loading the configuration file which OPENSSL_config()
+    // used to load.  This also registers the library's own cleanup
+    // handler, which must run after the algorithm table is destroyed.
+    OPENSSL_init_crypto(OPENSSL_INIT_LOAD_CRYPTO_STRINGS
+                        | OPENSSL_INIT_ADD_ALL_CIPHERS
+                        | OPENSSL_INIT_ADD_ALL_DIGESTS
+                        | OPENSSL_INIT_LOAD_CONFIG, NULL);
+#else
+    ERR_load_crypto_strings();
+    OpenSSL_add_all_algorithms();
+    OPENSSL_config(NULL);
+
+    s_mutexes.init(CRYPTO_num_locks());
+    CRYPTO_set_id_callback(qthreads_thread_id);
+    CRYPTO_set_locking_callback(qthreads_locking_callback);
+#endif
+    return 1;
+}
+
+int ensureLibraryInitialized()
+{
+    static const int initialized = initializeLibrary();
+    return initialized;
+}
+
+// The cipher and digest implementations used by the helpers.
+// With OpenSSL 3, passing one of the EVP_aes_*() or EVP_sha*() objects
+// to an operation makes the library fetch the implementation from the
+// provider on every call, which takes global locks.  The implementations
+// are instead fetched once here and the fetched objects are reused.
+// With earlier versions the objects are static, and are simply recorded.
+class AlgorithmTable
+{
+public:
+    AlgorithmTable()
+    {
+        ensureLibraryInitialized();
+
+        for (int i = 0; i < OpenSslEvp::CipherAlgorithmCount; ++i) {
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+            m_fetchedCiphers[i] = EVP_CIPHER_fetch(NULL, s_cipherEntries[i].name, NULL);
+            if (!m_fetchedCiphers[i]) {
+                // not available from the loaded providers.  Operations
+                // using the legacy object will fail in the usual way.
+                ERR_clear_error();
+            }
+            m_ciphers[i] = m_fetchedCiphers[i] ? m_fetchedCiphers[i] : s_cipherEntries[i].legacy();
+#else
+            m_ciphers[i] = s_cipherEntries[i].legacy();
+#endif
+        }
+
+        for (int i = 0; i < OpenSslEvp::DigestAlgorithmCount; ++i) {
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+            m_fetchedDigests[i] = EVP_MD_fetch(NULL, s_digestEntries[i].name, NULL);
+            if (!m_fetchedDigests[i]) {
+                ERR_clear_error();
+            }
+            m_digests[i] = m_fetchedDigests[i] ? m_fetchedDigests[i] : s_digestEntries[i].legacy();
+#else
+            m_digests[i] = s_digestEntries[i].legacy();
+#endif
+        }
+    }
+
+    ~AlgorithmTable()
+    {
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+        for (int i = 0; i < OpenSslEvp::CipherAlgorithmCount; ++i) {
+            EVP_CIPHER_free(m_fetchedCiphers[i]);
+        }
+        for (int i = 0; i < OpenSslEvp::DigestAlgorithmCount; ++i) {
+            EVP_MD_free(m_fetchedDigests[i]);
+        }
+#endif
+    }
+
+    const EVP_CIPHER *cipher(int algorithm) const { return m_ciphers[algorithm]; }
+    const EVP_MD *digest(int algorithm) const { return m_digests[algorithm]; }
+
+private:
+    const EVP_CIPHER *m_ciphers[OpenSslEvp::CipherAlgorithmCount];
+    const EVP_MD *m_digests[OpenSslEvp::DigestAlgorithmCount];
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+    EVP_CIPHER *m_fetchedCiphers[OpenSslEvp::CipherAlgorithmCount];
+    EVP_MD *m_fetchedDigests[OpenSslEvp::DigestAlgorithmCount];
+#endif
+};
+
+// Built on first use.  Threads which need the table while it is
+// being built (e.g. by the prefetcher) wait for it to be completed.
+const AlgorithmTable *algorithmTable()
+{
+    static const AlgorithmTable table;
+    return &table;
+}
+
+class AlgorithmPrefetcher : public QRunnable
+{
+public:
+    void run() Q_DECL_OVERRIDE
+    {
+        algorithmTable();
+    }
+};
+
+} // namespace
+
 /*
-    int OpenSslEvp::init()
+    int OpenSslEvp::init(bool prefetchInBackground)
+
+    Initializes the OpenSSL engine for encryption and decryption, and
+    fetches the cipher and digest implementations used by the helpers.
+    If \a prefetchInBackground is true, the implementations are fetched
+    on a thread pool thread, so that the caller (e.g. a plugin constructor
+    on the daemon's main thread) is not blocked; operations requested
+    before the fetch has completed wait for it.
 
-    Initializes the OpenSSL engine for encryption and decryption.
+    May be called multiple times and from any thread.
     Returns 1 on success, 0 on failure.
  */
-int OpenSslEvp::init()
+int OpenSslEvp::init(bool prefetchInBackground)
 {
-    static int initialized;
-    if (initialized < 1) {
-        ERR_load_crypto_strings();
-        OpenSSL_add_all_algorithms();
-
-        // TODO: figure out what is needed in openssl 1.1.0 instead of OPENSSL_config,
-        //       see https://github.com/sailfishos/sailfish-secrets/issues/34 for discussion.
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
-        OPENSSL_config(NULL);
-#pragma GCC diagnostic pop
+    const int initialized = ensureLibraryInitialized();
+    if (prefetchInBackground) {
+        QThreadPool::globalInstance()->start(new AlgorithmPrefetcher);
+    } else {
+        algorithmTable();
+    }
+    return initialized;
+}
 
-#if OPENSSL_VERSION_NUMBER < 0x10100000L
-        s_mutexes.init(CRYPTO_num_locks());
-        CRYPTO_set_id_callback(qthreads_thread_id);
-        CRYPTO_set_locking_callback(qthreads_locking_callback);
-#endif
+/*
+    const EVP_CIPHER *OpenSslEvp::fetched_cipher(CipherAlgorithm algorithm)
 
-        initialized += 1;
+    Returns the pre-fetched implementation of the given cipher
+    \a algorithm, or NULL if the \a algorithm is not valid.
+ */
+const EVP_CIPHER *OpenSslEvp::fetched_cipher(CipherAlgorithm algorithm)
+{
+    if (algorithm < 0 || algorithm >= CipherAlgorithmCount) {
+        return NULL;
     }
-    return initialized;
+    return algorithmTable()->cipher(algorithm);
+}
+
+/*
+    const EVP_MD *OpenSslEvp::fetched_digest(DigestAlgorithm algorithm)
+
+    Returns the pre-fetched implementation of the given digest
+    \a algorithm, or NULL if the \a algorithm is not valid.
+ */
+const EVP_MD *OpenSslEvp::fetched_digest(DigestAlgorithm algorithm)
+{
+    if (algorithm < 0 || algorithm >= DigestAlgorithmCount) {
+        return NULL;
+    }
+    return algorithmTable()->digest(algorithm);
 }
 
 /*
@@ -153,16 +331,204 @@ int OpenSslEvp::pkcs5_pbkdf2_hmac(const char *pass, int passlen,
 
     // see CryptoManager::DigestFunction
     switch (digestFunction) {
-        case 10: md = EVP_sha1(); break;
-        case 21: md = EVP_sha256(); break;
-        case 23: md = EVP_sha512(); break;
-        default: md = EVP_sha256(); break;
+        case 10: md = fetched_digest(Sha1); break;
+        case 21: md = fetched_digest(Sha256); break;
+        case 23: md = fetched_digest(Sha512); break;
+        default: md = fetched_digest(Sha256); break;
     }
 
     return PKCS5_PBKDF2_HMAC(pass, passlen, salt, saltlen,
                              iter, md, keylen, out);
 }
 
+/*
+    int OpenSslEvp::scrypt(const char *pass,
+                           int passlen,
+                           const unsigned char *salt,
+                           int saltlen,
+                           uint64_t n,
+                           int r,
+                           int p,
+                           int keylen,
+                           unsigned char *out)
+
+    Derive a key from input data via scrypt (RFC 7914) with the CPU/memory
+    cost \a n (a power of two greater than one), block size \a r and
+    parallelism \a p.  The lanes are computed one after another, each
+    reusing 128 * r * n bytes of memory.  Parameters which would require
+    more than OSSLEVP_KDF_MAX_MEMORY bytes are rejected.
+
+    Returns 1 on success, 0 on failure.
+ */
+int OpenSslEvp::scrypt(const char *pass, int passlen,
+                       const unsigned char *salt, int saltlen,
+                       uint64_t n, int r, int p,
+                       int keylen, unsigned char *out)
+{
+    if (!scrypt_parameters_valid(n, r, p) || keylen < 1) {
+        OSSLEVP_PRINT_ERR("invalid scrypt parameters");
+        return 0;
+    }
+
+#if OPENSSL_VERSION_NUMBER >= 0x10100000L
+    if (EVP_PBE_scrypt(pass, passlen, salt, saltlen,
+                       n, static_cast<uint64_t>(r), static_cast<uint64_t>(p),
+                       OSSLEVP_KDF_MAX_MEMORY,
+                       out, keylen) != 1) {
+        ERR_print_errors_fp(stderr);
+        OSSLEVP_PRINT_ERR("failed to derive scrypt key");
+        return 0;
+    }
+
+    return 1;
+#else
+    Q_UNUSED(pass)
+    Q_UNUSED(passlen)
+    Q_UNUSED(salt)
+    Q_UNUSED(saltlen)
+    Q_UNUSED(out)
+    OSSLEVP_PRINT_ERR("scrypt requires OpenSSL 1.1.0 or later");
+    return 0;
+#endif
+}
+
+/*
+    bool OpenSslEvp::scrypt_parameters_valid(uint64_t n, int r, int p)
+
+    Returns true if the scrypt CPU/memory cost \a n is a power of two
+    within [2, OSSLEVP_SCRYPT_MAX_COST], the block size \a r is within
+    [1, OSSLEVP_SCRYPT_MAX_BLOCK_SIZE], the parallelism \a p is within
+    [1, OSSLEVP_SCRYPT_MAX_PARALLELISM], and the memory which a derivation
+    with them requires does not exceed OSSLEVP_KDF_MAX_MEMORY.
+ */
+bool OpenSslEvp::scrypt_parameters_valid(uint64_t n, int r, int p)
+{
+    if (n < 2 || n > OSSLEVP_SCRYPT_MAX_COST || (n & (n - 1)) != 0
+            || r < 1 || r > OSSLEVP_SCRYPT_MAX_BLOCK_SIZE
+            || p < 1 || p > OSSLEVP_SCRYPT_MAX_PARALLELISM) {
+        return false;
+    }
+
+    // the bounds above keep these products well within 64 bits.
+    // the memory is the working block of every lane plus the
+    // vector (and two temporary blocks) of the current lane.
+    const uint64_t blockSize = 128 * static_cast<uint64_t>(r);
+    const uint64_t memory = blockSize * static_cast<uint64_t>(p)
+                          + blockSize * (n + 2);
+    return memory <= OSSLEVP_KDF_MAX_MEMORY;
+}
+
+/*
+    bool OpenSslEvp::argon2id_available()
+
+    Returns true if the OpenSSL library provides the Argon2id key
+    derivation function (which requires OpenSSL 3.2 or later).
+ */
+bool OpenSslEvp::argon2id_available()
+{
+#if OPENSSL_VERSION_NUMBER >= 0x30200000L
+    EVP_KDF *kdf = EVP_KDF_fetch(NULL, "ARGON2ID", NULL);
+    if (!kdf) {
+        ERR_clear_error();
+        return false;
+    }
+    EVP_KDF_free(kdf);
+    return true;
+#else
+    return false;
+#endif
+}
+
+/*
+    int OpenSslEvp::argon2id(const char *pass,
+                             int passlen,
+                             const unsigned char *salt,
+                             int saltlen,
+                             uint32_t iterations,
+                             uint32_t memoryKiB,
+                             uint32_t lanes,
+                             int keylen,
+                             unsigned char *out)
+
+    Derive a key from input data via Argon2id (RFC 9106) with the given
+    number of passes over \a memoryKiB kibibytes of memory, divided into
+    \a lanes lanes.  The lanes are computed concurrently by as many of the
+    threads of OpenSSL's thread pool as are available, or on the calling
+    thread if none are.  The size of that pool is left to the application
+    which hosts the plugin; the plugin does not enable it.  The \a salt must be at least 8 bytes long.
+
+    Returns 1 on success, 0 on failure (including if Argon2id is not
+    available, see argon2id_available()).
+ */
+int OpenSslEvp::argon2id(const char *pass, int passlen,
+                         const unsigned char *salt, int saltlen,
+                         uint32_t iterations, uint32_t memoryKiB, uint32_t lanes,
+                         int keylen, unsigned char *out)
+{
+#if OPENSSL_VERSION_NUMBER >= 0x30200000L
+    EVP_KDF *kdf = EVP_KDF_fetch(NULL, "ARGON2ID", NULL);
+    if (!kdf) {
+        ERR_print_errors_fp(stderr);
+        OSSLEVP_PRINT_ERR("Argon2id is not available");
+        return 0;
+    }
+    EVP_KDF_CTX *kctx = EVP_KDF_CTX_new(kdf);
+    EVP_KDF_free(kdf);
+    if (!kctx) {
+        ERR_print_errors_fp(stderr);
+        OSSLEVP_PRINT_ERR("failed to create Argon2id context");
+        return 0;
+    }
+
+    const uint64_t availableThreads = OSSL_get_max_threads(NULL);
+    uint32_t threads = lanes < availableThreads ? lanes : static_cast<uint32_t>(availableThreads);
+    if (threads < 1) {
+        threads = 1;
+    }
+
+    int result = 0;
+    for (;;) {
+        OSSL_PARAM params[7];
+        OSSL_PARAM *param = params;
+        *param++ = OSSL_PARAM_construct_octet_string(OSSL_KDF_PARAM_PASSWORD, const_cast<char *>(pass), passlen);
+        *param++ = OSSL_PARAM_construct_octet_string(OSSL_KDF_PARAM_SALT, const_cast<unsigned char *>(salt), saltlen);
+        *param++ = OSSL_PARAM_construct_uint32(OSSL_KDF_PARAM_ITER, &iterations);
+        *param++ = OSSL_PARAM_construct_uint32(OSSL_KDF_PARAM_ARGON2_MEMCOST, &memoryKiB);
+        *param++ = OSSL_PARAM_construct_uint32(OSSL_KDF_PARAM_ARGON2_LANES, &lanes);
+        *param++ = OSSL_PARAM_construct_uint32(OSSL_KDF_PARAM_THREADS, &threads);
+        *param = OSSL_PARAM_construct_end();
+
+        result = EVP_KDF_derive(kctx, out, keylen, params) == 1 ? 1 : 0;
+        if (result == 1 || threads == 1) {
+            break;
+        }
+        // the pool threads are in use by other derivations: the lanes
+        // can still be computed, only on the calling thread.
+        ERR_clear_error();
+        threads = 1;
+    }
+
+    if (result != 1) {
+        ERR_print_errors_fp(stderr);
+        OSSLEVP_PRINT_ERR("failed to derive Argon2id key");
+    }
+    EVP_KDF_CTX_free(kctx);
+    return result;
+#else
+    Q_UNUSED(pass)
+    Q_UNUSED(passlen)
+    Q_UNUSED(salt)
+    Q_UNUSED(saltlen)
+    Q_UNUSED(iterations)
+    Q_UNUSED(memoryKiB)
+    Q_UNUSED(lanes)
+    Q_UNUSED(keylen)
+    Q_UNUSED(out)
+    OSSLEVP_PRINT_ERR("Argon2id requires OpenSSL 3.2 or later");
+    return 0;
+#endif
+}
+
 /*
     int OpenSslEvp::aes_encrypt_plaintext(const EVP_CIPHER *evp_cipher,
                                           const unsigned char *init_vector,
@@ -5,6 +5,9 @@
  * BSD 3-Clause License, see LICENSE.
  */
 
+#include "evp_p.h"
+#include "evpvalidation_p.h"
+
 #include "Crypto/key.h"
 #include "Crypto/keypairgenerationparameters.h"
 #include "Crypto/keyderivationparameters.h"
@@ -32,10 +35,6 @@
 
 #define CIPHER_SESSION_INACTIVITY_TIMEOUT 60000 /* 1 minute, change to 10 sec for timeout test */
 #define MAX_CIPHER_SESSIONS_PER_CLIENT 5
-#define SAILFISH_CRYPTO_GCM_TAG_SIZE 16
-#define SAILFISH_CRYPTO_GCM_IV_SIZE 12
-#define SAILFISH_CRYPTO_CCM_TAG_SIZE 14
-#define SAILFISH_CRYPTO_CCM_IV_SIZE 7
 
 class CipherSessionData
 {
@@ -114,61 +113,14 @@ quint32 getNextCipherSessionToken(QMap<quint64, QMap<quint32, CipherSessionData*
     return 0; // no cipher sessions available.
 }
 
-int initializationVectorSize(Sailfish::Crypto::CryptoManager::Algorithm algorithm,
-                             Sailfish::Crypto::CryptoManager::BlockMode blockMode,
-                             int keySize)
-{
-    Q_UNUSED(keySize)   // not yet used in calculations
-
-    if (blockMode == Sailfish::Crypto::CryptoManager::BlockModeEcb) {
-        // IV not required for these configurations
-        return 0;
-    }
-
-    switch (algorithm) {
-    case Sailfish::Crypto::CryptoManager::AlgorithmRsa:
-        // IV not yet supported for RSA
-        return 0;
-    case Sailfish::Crypto::CryptoManager::AlgorithmAes:
-        if (blockMode == Sailfish::Crypto::CryptoManager::BlockModeGcm) {
-            return SAILFISH_CRYPTO_GCM_IV_SIZE;
-        } else if (blockMode == Sailfish::Crypto::CryptoManager::BlockModeCcm) {
-            return SAILFISH_CRYPTO_CCM_IV_SIZE;
-        } else {
-            return 16;  // AES = 128-bit block size
-        }
-    default:
-        break;
-    }
-
-    // Unrecognized configuration, IV should be ignored
-    return -1;
-}
-
-int authenticationTagSize(Sailfish::Crypto::CryptoManager::Algorithm algorithm,
-                          Sailfish::Crypto::CryptoManager::BlockMode blockMode)
-{
-    switch (algorithm) {
-    case Sailfish::Crypto::CryptoManager::AlgorithmAes:
-        if (blockMode == Sailfish::Crypto::CryptoManager::BlockModeGcm) {
-            return SAILFISH_CRYPTO_GCM_TAG_SIZE;
-        } else if (blockMode == Sailfish::Crypto::CryptoManager::BlockModeCcm) {
-            return SAILFISH_CRYPTO_CCM_TAG_SIZE;
-        }
-    default:
-        break;
-    }
-    return 0;
-}
-
 const EVP_MD *getEvpDigestFunction(Sailfish::Crypto::CryptoManager::DigestFunction digestFunction) {
     switch (digestFunction) {
     case Sailfish::Crypto::CryptoManager::DigestSha256:
-        return EVP_sha256();
+        return OpenSslEvp::fetched_digest(OpenSslEvp::Sha256);
     case Sailfish::Crypto::CryptoManager::DigestSha512:
-        return EVP_sha512();
+        return OpenSslEvp::fetched_digest(OpenSslEvp::Sha512);
     case Sailfish::Crypto::CryptoManager::DigestMd5:
-        return EVP_md5();
+        return OpenSslEvp::fetched_digest(OpenSslEvp::Md5);
     default:
         return Q_NULLPTR;
     }
@@ -180,81 +132,81 @@ const EVP_CIPHER *getEvpCipher(int block_mode, int key_length_bytes)
 
     if (block_mode == Sailfish::Crypto::CryptoManager::BlockModeEcb) {
         switch (key_length_bits) {
-        case 128: return EVP_aes_128_ecb();
-        case 192: return EVP_aes_192_ecb();
-        case 256: return EVP_aes_256_ecb();
+        case 128: return OpenSslEvp::fetched_cipher(OpenSslEvp::Aes128Ecb);
+        case 192: return OpenSslEvp::fetched_cipher(OpenSslEvp::Aes192Ecb);
+        case 256: return OpenSslEvp::fetched_cipher(OpenSslEvp::Aes256Ecb);
         default:
             fprintf(stderr, "%s: %d\n", "unsupported encryption size for ECB block mode", key_length_bits);
             return NULL;
         }
     } else if (block_mode == Sailfish::Crypto::CryptoManager::BlockModeCbc) {
         switch (key_length_bits) {
-        case 128: return EVP_aes_128_cbc();
-        case 192: return EVP_aes_192_cbc();
-        case 256: return EVP_aes_256_cbc();
+        case 128: return OpenSslEvp::fetched_cipher(OpenSslEvp::Aes128Cbc);
+        case 192: return OpenSslEvp::fetched_cipher(OpenSslEvp::Aes192Cbc);
+        case 256: return OpenSslEvp::fetched_cipher(OpenSslEvp::Aes256Cbc);
         default:
             fprintf(stderr, "%s: %d\n", "unsupported encryption size for CBC block mode", key_length_bits);
             return NULL;
         }
     } else if (block_mode == Sailfish::Crypto::CryptoManager::BlockModeCfb1) {
         switch (key_length_bits) {
-        case 128: return EVP_aes_128_cfb1();
-        case 192: return EVP_aes_192_cfb1();
-        case 256: return EVP_aes_256_cfb1();
+        case 128: return OpenSslEvp::fetched_cipher(OpenSslEvp::Aes128Cfb1);
+        case 192: return OpenSslEvp::fetched_cipher(OpenSslEvp::Aes192Cfb1);
+        case 256: return OpenSslEvp::fetched_cipher(OpenSslEvp::Aes256Cfb1);
         default:
             fprintf(stderr, "%s: %d\n", "unsupported encryption size for CFB-1 block mode", key_length_bits);
             return NULL;
         }
     } else if (block_mode == Sailfish::Crypto::CryptoManager::BlockModeCfb8) {
         switch (key_length_bits) {
-        case 128: return EVP_aes_128_cfb8();
-        case 192: return EVP_aes_192_cfb8();
-        case 256: return EVP_aes_256_cfb8();
+        case 128: return OpenSslEvp::fetched_cipher(OpenSslEvp::Aes128Cfb8);
+        case 192: return OpenSslEvp::fetched_cipher(OpenSslEvp::Aes192Cfb8);
+        case 256: return OpenSslEvp::fetched_cipher(OpenSslEvp::Aes256Cfb8);
         default:
             fprintf(stderr, "%s: %d\n", "unsupported encryption size for CFB-8 block mode", key_length_bits);
             return NULL;
         }
     } else if (block_mode == Sailfish::Crypto::CryptoManager::BlockModeCfb128) {
         switch (key_length_bits) {
-        case 128: return EVP_aes_128_cfb128();
-        case 192: return EVP_aes_192_cfb128();
-        case 256: return EVP_aes_256_cfb128();
+        case 128: return OpenSslEvp::fetched_cipher(OpenSslEvp::Aes128Cfb128);
+        case 192: return OpenSslEvp::fetched_cipher(OpenSslEvp::Aes192Cfb128);
+        case 256: return OpenSslEvp::fetched_cipher(OpenSslEvp::Aes256Cfb128);
         default:
             fprintf(stderr, "%s: %d\n", "unsupported encryption size for CFB-128 block mode", key_length_bits);
             return NULL;
         }
     } else if (block_mode == Sailfish::Crypto::CryptoManager::BlockModeOfb) {
         switch (key_length_bits) {
-        case 128: return EVP_aes_128_ofb();
-        case 192: return EVP_aes_192_ofb();
-        case 256: return EVP_aes_256_ofb();
+        case 128: return OpenSslEvp::fetched_cipher(OpenSslEvp::Aes128Ofb);
+        case 192: return OpenSslEvp::fetched_cipher(OpenSslEvp::Aes192Ofb);
+        case 256: return OpenSslEvp::fetched_cipher(OpenSslEvp::Aes256Ofb);
         default:
             fprintf(stderr, "%s: %d\n", "unsupported encryption size for OFB block mode", key_length_bits);
             return NULL;
         }
     } else if (block_mode == Sailfish::Crypto::CryptoManager::BlockModeCtr) {
         switch (key_length_bits) {
-        case 128: return EVP_aes_128_ctr();
-        case 192: return EVP_aes_192_ctr();
-        case 256: return EVP_aes_256_ctr();
+        case 128: return OpenSslEvp::fetched_cipher(OpenSslEvp::Aes128Ctr);
+        case 192: return OpenSslEvp::fetched_cipher(OpenSslEvp::Aes192Ctr);
+        case 256: return OpenSslEvp::fetched_cipher(OpenSslEvp::Aes256Ctr);
         default:
             fprintf(stderr, "%s: %d\n", "unsupported encryption size for OFB block mode", key_length_bits);
             return NULL;
         }
     } else if (block_mode == Sailfish::Crypto::CryptoManager::BlockModeGcm) {
         switch (key_length_bits) {
-        case 128: return EVP_aes_128_gcm();
-        case 192: return EVP_aes_192_gcm();
-        case 256: return EVP_aes_256_gcm();
+        case 128: return OpenSslEvp::fetched_cipher(OpenSslEvp::Aes128Gcm);
+        case 192: return OpenSslEvp::fetched_cipher(OpenSslEvp::Aes192Gcm);
+        case 256: return OpenSslEvp::fetched_cipher(OpenSslEvp::Aes256Gcm);
         default:
             fprintf(stderr, "%s: %d\n", "unsupported encryption size for GCM block mode", key_length_bits);
             return NULL;
         }
     } else if (block_mode == Sailfish::Crypto::CryptoManager::BlockModeCcm) {
         switch (key_length_bits) {
-        case 128: return EVP_aes_128_ccm();
-        case 192: return EVP_aes_192_ccm();
-        case 256: return EVP_aes_256_ccm();
+        case 128: return OpenSslEvp::fetched_cipher(OpenSslEvp::Aes128Ccm);
+        case 192: return OpenSslEvp::fetched_cipher(OpenSslEvp::Aes192Ccm);
+        case 256: return OpenSslEvp::fetched_cipher(OpenSslEvp::Aes256Ccm);
         default:
             fprintf(stderr, "%s: %d\n", "unsupported encryption size for CCM block mode", key_length_bits);
             return NULL;
@@ -262,8 +214,8 @@ const EVP_CIPHER *getEvpCipher(int block_mode, int key_length_bytes)
     } else if (block_mode == Sailfish::Crypto::CryptoManager::BlockModeXts) {
         switch (key_length_bits) {
         // Note: current openssl does not support XTS 192-bit.
-        case 128: return EVP_aes_128_xts();
-        case 256: return EVP_aes_256_xts();
+        case 128: return OpenSslEvp::fetched_cipher(OpenSslEvp::Aes128Xts);
+        case 256: return OpenSslEvp::fetched_cipher(OpenSslEvp::Aes256Xts);
         default:
             fprintf(stderr, "%s: %d\n", "unsupported encryption size for XTS block mode", key_length_bits);
             return NULL;
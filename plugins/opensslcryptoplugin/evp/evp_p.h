@@ -21,14 +21,61 @@
 
 namespace OpenSslEvp {
 
-int init();
+// The algorithm implementations which are fetched once per process
+// and then shared by every operation, see fetched_cipher().
+enum CipherAlgorithm {
+    Aes128Ecb = 0, Aes192Ecb, Aes256Ecb,
+    Aes128Cbc, Aes192Cbc, Aes256Cbc,
+    Aes128Cfb1, Aes192Cfb1, Aes256Cfb1,
+    Aes128Cfb8, Aes192Cfb8, Aes256Cfb8,
+    Aes128Cfb128, Aes192Cfb128, Aes256Cfb128,
+    Aes128Ofb, Aes192Ofb, Aes256Ofb,
+    Aes128Ctr, Aes192Ctr, Aes256Ctr,
+    Aes128Gcm, Aes192Gcm, Aes256Gcm,
+    Aes128Ccm, Aes192Ccm, Aes256Ccm,
+    Aes128Xts, Aes256Xts,
+    CipherAlgorithmCount
+};
+
+enum DigestAlgorithm {
+    Sha1 = 0,
+    Sha256,
+    Sha512,
+    Md5,
+    DigestAlgorithmCount
+};
+
+int init(bool prefetchInBackground = false);
 void cleanup();
 
+const EVP_CIPHER *fetched_cipher(CipherAlgorithm algorithm);
+const EVP_MD *fetched_digest(DigestAlgorithm algorithm);
+
 int pkcs5_pbkdf2_hmac(const char *pass, int passlen,
                       const unsigned char *salt, int saltlen,
                       int iter, int digestFunction,
                       int keylen, unsigned char *out);
 
+// The bounds of the memory-hard key derivation parameters.  The memory
+// limit applies to a single derivation; derivations are not run
+// concurrently by the daemon, which serializes crypto plugin operations.
+#define OSSLEVP_KDF_MAX_MEMORY (128 * 1024 * 1024)
+#define OSSLEVP_SCRYPT_MAX_COST (1 << 20)
+#define OSSLEVP_SCRYPT_MAX_BLOCK_SIZE 32
+#define OSSLEVP_SCRYPT_MAX_PARALLELISM 16
+
+bool scrypt_parameters_valid(uint64_t n, int r, int p);
+int scrypt(const char *pass, int passlen,
+           const unsigned char *salt, int saltlen,
+           uint64_t n, int r, int p,
+           int keylen, unsigned char *out);
+
+bool argon2id_available();
+int argon2id(const char *pass, int passlen,
+             const unsigned char *salt, int saltlen,
+             uint32_t iterations, uint32_t memoryKiB, uint32_t lanes,
+             int keylen, unsigned char *out);
+
 int aes_encrypt_plaintext(const EVP_CIPHER *evp_cipher,
                           const unsigned char *init_vector,
                           const unsigned char *key,
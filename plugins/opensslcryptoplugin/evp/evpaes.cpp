@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2018 Jolla Ltd.
+ * Contact: Chris Adams <chris.adams@jollamobile.com>
+ * All rights reserved.
+ * BSD 3-Clause License, see LICENSE.
+ */
+
+#include "evpaes_p.h"
+#include "evp_p.h"
+
+QByteArray OpenSslAes::encrypt(
+        const EVP_CIPHER *evpCipher,
+        const QByteArray &plaintext,
+        const QByteArray &key,
+        const QByteArray &initVector)
+{
+    unsigned char *encrypted = Q_NULLPTR;
+    int size = OpenSslEvp::aes_encrypt_plaintext(evpCipher,
+                                                 (const unsigned char *)initVector.constData(),
+                                                 (const unsigned char *)key.constData(),
+                                                 key.size(),
+                                                 (const unsigned char *)plaintext.constData(),
+                                                 plaintext.size(),
+                                                 &encrypted);
+    if (size <= 0) {
+        return QByteArray();
+    }
+
+    QByteArray encryptedData((const char *)encrypted, size);
+    free(encrypted);
+    return encryptedData;
+}
+
+QByteArray OpenSslAes::decrypt(
+        const EVP_CIPHER *evpCipher,
+        const QByteArray &ciphertext,
+        const QByteArray &key,
+        const QByteArray &initVector)
+{
+    unsigned char *decrypted = Q_NULLPTR;
+    int size = OpenSslEvp::aes_decrypt_ciphertext(evpCipher,
+                                                  (const unsigned char *)initVector.constData(),
+                                                  (const unsigned char *)key.constData(),
+                                                  key.size(),
+                                                  (const unsigned char *)ciphertext.constData(),
+                                                  ciphertext.size(),
+                                                  &decrypted);
+    if (size <= 0) {
+        return QByteArray();
+    }
+
+    QByteArray decryptedData((const char *)decrypted, size);
+    free(decrypted);
+    return decryptedData;
+}
+
+QPair<QByteArray, QByteArray> OpenSslAes::authEncrypt(
+        const EVP_CIPHER *evpCipher,
+        const QByteArray &plaintext,
+        const QByteArray &key,
+        const QByteArray &initVector,
+        const QByteArray &auth,
+        unsigned int authenticationTagLength)
+{
+    unsigned char *encrypted = Q_NULLPTR;
+    unsigned char *authenticationTag = Q_NULLPTR;
+    int encryptedSize = OpenSslEvp::aes_auth_encrypt_plaintext(evpCipher,
+                                                               (const unsigned char *)initVector.constData(),
+                                                               initVector.size(),
+                                                               (const unsigned char *)key.constData(),
+                                                               key.size(),
+                                                               (const unsigned char *)auth.constData(),
+                                                               auth.size(),
+                                                               (const unsigned char *)plaintext.constData(),
+                                                               plaintext.size(),
+                                                               &encrypted,
+                                                               &authenticationTag,
+                                                               authenticationTagLength);
+    if (encryptedSize <= 0) {
+        return qMakePair(QByteArray(), QByteArray());
+    }
+
+    QByteArray encryptedData((const char *)encrypted, encryptedSize);
+    free(encrypted);
+    QByteArray authenticationTagData((const char *)authenticationTag, authenticationTagLength);
+    free(authenticationTag);
+    return qMakePair(encryptedData, authenticationTagData);
+}
+
+QPair<QByteArray, bool> OpenSslAes::authDecrypt(
+        const EVP_CIPHER *evpCipher,
+        const QByteArray &ciphertext,
+        const QByteArray &key,
+        const QByteArray &initVector,
+        const QByteArray &auth,
+        const QByteArray &authenticationTag)
+{
+    int verifyResult = -1;
+    unsigned char *decrypted = Q_NULLPTR;
+    // OpenSSL takes the expected tag as non-const data.
+    QByteArray authenticationTagCopy(authenticationTag);
+    int size = OpenSslEvp::aes_auth_decrypt_ciphertext(evpCipher,
+                                                       (const unsigned char *)initVector.constData(),
+                                                       initVector.size(),
+                                                       (const unsigned char *)key.constData(),
+                                                       key.size(),
+                                                       (const unsigned char *)auth.constData(),
+                                                       auth.size(),
+                                                       (unsigned char *)authenticationTagCopy.data(),
+                                                       authenticationTagCopy.size(),
+                                                       (const unsigned char *)ciphertext.constData(),
+                                                       ciphertext.size(),
+                                                       &decrypted,
+                                                       &verifyResult);
+    if (size <= 0) {
+        return qMakePair(QByteArray(), false);
+    }
+
+    QByteArray decryptedData((const char *)decrypted, size);
+    free(decrypted);
+    return qMakePair(decryptedData, (verifyResult > 0));
+}
@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2018 Jolla Ltd.
+ * Contact: Chris Adams <chris.adams@jollamobile.com>
+ * All rights reserved.
+ * BSD 3-Clause License, see LICENSE.
+ */
+
+#ifndef SAILFISHCRYPTO_PLUGIN_CRYPTO_OPENSSL_EVPAES_P_H
+#define SAILFISHCRYPTO_PLUGIN_CRYPTO_OPENSSL_EVPAES_P_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QPair>
+
+#include <openssl/evp.h>
+
+// QByteArray wrappers of the OpenSslEvp AES functions, shared by the
+// OpenSSL crypto plugin and the in-process execution of the crypto library.
+// An empty result means that the operation failed.
+namespace OpenSslAes {
+
+QByteArray encrypt(const EVP_CIPHER *evpCipher,
+                   const QByteArray &plaintext,
+                   const QByteArray &key,
+                   const QByteArray &initVector);
+
+QByteArray decrypt(const EVP_CIPHER *evpCipher,
+                   const QByteArray &ciphertext,
+                   const QByteArray &key,
+                   const QByteArray &initVector);
+
+// Returns the ciphertext and the authentication tag.
+QPair<QByteArray, QByteArray> authEncrypt(const EVP_CIPHER *evpCipher,
+                                          const QByteArray &plaintext,
+                                          const QByteArray &key,
+                                          const QByteArray &initVector,
+                                          const QByteArray &auth,
+                                          unsigned int authenticationTagLength);
+
+// Returns the plaintext and whether the authentication tag was verified.
+QPair<QByteArray, bool> authDecrypt(const EVP_CIPHER *evpCipher,
+                                    const QByteArray &ciphertext,
+                                    const QByteArray &key,
+                                    const QByteArray &initVector,
+                                    const QByteArray &auth,
+                                    const QByteArray &authenticationTag);
+
+} // OpenSslAes
+
+#endif // SAILFISHCRYPTO_PLUGIN_CRYPTO_OPENSSL_EVPAES_P_H
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2018 Jolla Ltd.
+ * Contact: Chris Adams <chris.adams@jollamobile.com>
+ * All rights reserved.
+ * BSD 3-Clause License, see LICENSE.
+ */
+
+#include "evpkdf_p.h"
+#include "evp_p.h"
+
+#include <QtCore/QString>
+
+namespace {
+
+// scrypt uses a fixed block size, as recommended by RFC 7914.
+const int ScryptBlockSize = 8;
+
+struct KdfParameters
+{
+    KdfParameters(const QVariantMap &parameters)
+        : function(parameters.value(QStringLiteral("keyDerivationFunction"),
+                                    QStringLiteral("pbkdf2")).toString())
+        , iterations(parameters.value(QStringLiteral("iterations"),
+                                      OpenSslKdf::DefaultPbkdf2Iterations).toInt())
+        , memorySize(parameters.value(QStringLiteral("memorySize")).toInt())
+        , parallelism(parameters.value(QStringLiteral("parallelism"), 1).toInt())
+    {
+    }
+
+    QString function;
+    int iterations;
+    int memorySize;
+    int parallelism;
+};
+
+}
+
+bool OpenSslKdf::parametersSupported(const QVariantMap &parameters, const QByteArray &salt)
+{
+    const KdfParameters kdf(parameters);
+    if (kdf.function == QLatin1String("pbkdf2")) {
+        return kdf.iterations > 0 && kdf.iterations <= MaximumPbkdf2Iterations;
+    } else if (kdf.function == QLatin1String("scrypt")) {
+        return kdf.iterations > 0
+                && OpenSslEvp::scrypt_parameters_valid(static_cast<uint64_t>(kdf.iterations),
+                                                       ScryptBlockSize, kdf.parallelism);
+    } else if (kdf.function == QLatin1String("argon2id")) {
+        return kdf.iterations > 0 && kdf.iterations <= 64
+                && kdf.parallelism > 0 && kdf.parallelism <= OSSLEVP_SCRYPT_MAX_PARALLELISM
+                && kdf.memorySize >= 8 * kdf.parallelism
+                && kdf.memorySize <= OSSLEVP_KDF_MAX_MEMORY / 1024
+                && salt.size() >= 8
+                && OpenSslEvp::argon2id_available();
+    }
+    return false;
+}
+
+QByteArray OpenSslKdf::deriveKey(
+        const QByteArray &authenticationCode,
+        const QByteArray &salt,
+        const QVariantMap &parameters,
+        int keyLength)
+{
+    if (keyLength <= 0 || !parametersSupported(parameters, salt)) {
+        return QByteArray();
+    }
+
+    const KdfParameters kdf(parameters);
+    const QByteArray inputData = authenticationCode.isEmpty()
+                         ? QByteArray(1, '\0')
+                         : authenticationCode;
+    const unsigned char *saltData = salt.isEmpty()
+            ? Q_NULLPTR
+            : reinterpret_cast<const unsigned char*>(salt.constData());
+    QByteArray key(keyLength, '\0');
+    unsigned char *out = reinterpret_cast<unsigned char*>(key.data());
+
+    int derived = 0;
+    if (kdf.function == QLatin1String("pbkdf2")) {
+        derived = PKCS5_PBKDF2_HMAC(inputData.constData(), inputData.size(),
+                                    saltData, salt.size(), kdf.iterations,
+                                    OpenSslEvp::fetched_digest(OpenSslEvp::Sha256),
+                                    keyLength, out);
+    } else if (kdf.function == QLatin1String("scrypt")) {
+        derived = OpenSslEvp::scrypt(inputData.constData(), inputData.size(),
+                                     saltData, salt.size(),
+                                     static_cast<uint64_t>(kdf.iterations),
+                                     ScryptBlockSize, kdf.parallelism,
+                                     keyLength, out);
+    } else {
+        derived = OpenSslEvp::argon2id(inputData.constData(), inputData.size(),
+                                       saltData, salt.size(),
+                                       static_cast<uint32_t>(kdf.iterations),
+                                       static_cast<uint32_t>(kdf.memorySize),
+                                       static_cast<uint32_t>(kdf.parallelism),
+                                       keyLength, out);
+    }
+
+    if (derived != 1) {
+        OPENSSL_cleanse(key.data(), key.size());
+        return QByteArray();
+    }
+    return key;
+}
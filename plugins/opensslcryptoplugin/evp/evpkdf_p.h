@@ -0,0 +1,37 @@
+/*
+ * Copyright (C) 2018 Jolla Ltd.
+ * Contact: Chris Adams <chris.adams@jollamobile.com>
+ * All rights reserved.
+ * BSD 3-Clause License, see LICENSE.
+ */
+
+#ifndef SAILFISHCRYPTO_PLUGIN_CRYPTO_OPENSSL_EVPKDF_P_H
+#define SAILFISHCRYPTO_PLUGIN_CRYPTO_OPENSSL_EVPKDF_P_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QVariantMap>
+
+// Derivation of collection keys from authentication codes, shared by the
+// secrets plugins which use OpenSSL.  The key derivation function and its
+// cost are described by a parameter map, as documented for
+// EncryptionPlugin::deriveKeyFromCodeWithParameters().
+namespace OpenSslKdf {
+
+// The derivation used if no parameters are given, which is the one that
+// the plugins have always used: PBKDF2-HMAC-SHA256 with 10000 iterations.
+static const int DefaultPbkdf2Iterations = 10000;
+static const int MaximumPbkdf2Iterations = 4000000;
+
+// Returns true if a key can be derived with the given parameters and salt.
+bool parametersSupported(const QVariantMap &parameters, const QByteArray &salt);
+
+// Returns the key of the given length in bytes, or an empty array if the
+// parameters are not supported or the derivation fails.
+QByteArray deriveKey(const QByteArray &authenticationCode,
+                     const QByteArray &salt,
+                     const QVariantMap &parameters,
+                     int keyLength);
+
+} // OpenSslKdf
+
+#endif // SAILFISHCRYPTO_PLUGIN_CRYPTO_OPENSSL_EVPKDF_P_H
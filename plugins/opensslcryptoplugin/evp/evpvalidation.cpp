@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2018 Jolla Ltd.
+ * Contact: Chris Adams <chris.adams@jollamobile.com>
+ * All rights reserved.
+ * BSD 3-Clause License, see LICENSE.
+ */
+
+#include "evpvalidation_p.h"
+
+#include <QtCore/QString>
+
+int initializationVectorSize(Sailfish::Crypto::CryptoManager::Algorithm algorithm,
+                             Sailfish::Crypto::CryptoManager::BlockMode blockMode,
+                             int keySize)
+{
+    Q_UNUSED(keySize)   // not yet used in calculations
+
+    if (blockMode == Sailfish::Crypto::CryptoManager::BlockModeEcb) {
+        // IV not required for these configurations
+        return 0;
+    }
+
+    switch (algorithm) {
+    case Sailfish::Crypto::CryptoManager::AlgorithmRsa:
+        // IV not yet supported for RSA
+        return 0;
+    case Sailfish::Crypto::CryptoManager::AlgorithmAes:
+        if (blockMode == Sailfish::Crypto::CryptoManager::BlockModeGcm) {
+            return SAILFISH_CRYPTO_GCM_IV_SIZE;
+        } else if (blockMode == Sailfish::Crypto::CryptoManager::BlockModeCcm) {
+            return SAILFISH_CRYPTO_CCM_IV_SIZE;
+        } else {
+            return 16;  // AES = 128-bit block size
+        }
+    default:
+        break;
+    }
+
+    // Unrecognized configuration, IV should be ignored
+    return -1;
+}
+
+int authenticationTagSize(Sailfish::Crypto::CryptoManager::Algorithm algorithm,
+                          Sailfish::Crypto::CryptoManager::BlockMode blockMode)
+{
+    switch (algorithm) {
+    case Sailfish::Crypto::CryptoManager::AlgorithmAes:
+        if (blockMode == Sailfish::Crypto::CryptoManager::BlockModeGcm) {
+            return SAILFISH_CRYPTO_GCM_TAG_SIZE;
+        } else if (blockMode == Sailfish::Crypto::CryptoManager::BlockModeCcm) {
+            return SAILFISH_CRYPTO_CCM_TAG_SIZE;
+        }
+    default:
+        break;
+    }
+    return 0;
+}
+
+namespace {
+
+Sailfish::Crypto::Result checkInitializationVector(
+        const QByteArray &iv,
+        const Sailfish::Crypto::Key &key,
+        Sailfish::Crypto::CryptoManager::BlockMode blockMode)
+{
+    const int expectedIvSize = initializationVectorSize(key.algorithm(), blockMode, key.size());
+    if (!iv.isEmpty() && expectedIvSize < 0) {
+        return Sailfish::Crypto::Result(Sailfish::Crypto::Result::InvalidInitializationVectorError,
+                                        QStringLiteral("Initialization Vector should not be provided for this algorithm/mode/key configuration"));
+    } else if (iv.size() != expectedIvSize) {
+        return Sailfish::Crypto::Result(Sailfish::Crypto::Result::InvalidInitializationVectorError,
+                                        QStringLiteral("Initialization Vector length should be %1 but was %2")
+                                                .arg(expectedIvSize)
+                                                .arg(iv.size()));
+    }
+    return Sailfish::Crypto::Result(Sailfish::Crypto::Result::Succeeded);
+}
+
+}
+
+Sailfish::Crypto::Result OpenSslValidation::checkDigestParameters(
+        const QByteArray &data,
+        Sailfish::Crypto::CryptoManager::SignaturePadding padding)
+{
+    if (data.length() == 0) {
+        return Sailfish::Crypto::Result(Sailfish::Crypto::Result::EmptyDataError,
+                                        QLatin1String("Can't digest data if there is no data."));
+    }
+
+    if (padding != Sailfish::Crypto::CryptoManager::SignaturePaddingNone) {
+        return Sailfish::Crypto::Result(Sailfish::Crypto::Result::OperationNotSupportedError,
+                                        QLatin1String("TODO: digest padding other than None"));
+    }
+
+    return Sailfish::Crypto::Result(Sailfish::Crypto::Result::Succeeded);
+}
+
+Sailfish::Crypto::Result OpenSslValidation::checkEncryptParameters(
+        const QByteArray &iv,
+        const Sailfish::Crypto::Key &key,
+        Sailfish::Crypto::CryptoManager::BlockMode blockMode,
+        Sailfish::Crypto::CryptoManager::EncryptionPadding padding,
+        const QByteArray &authenticationData)
+{
+    if (padding != Sailfish::Crypto::CryptoManager::EncryptionPaddingNone) {
+        return Sailfish::Crypto::Result(Sailfish::Crypto::Result::OperationNotSupportedError,
+                                        QLatin1String("TODO: encryption padding other than None"));
+    }
+
+    if (key.secretKey().size() * 8 != key.size()) {
+        // The secret is not of the expected length (e.g. 128-bit, 256-bit)
+        return Sailfish::Crypto::Result(Sailfish::Crypto::Result::CryptoPluginKeyGenerationError,
+                                        QLatin1String("Secret key size does not match"));
+    }
+
+    if (!authenticationData.isEmpty() && authenticationTagSize(key.algorithm(), blockMode) == 0) {
+        return Sailfish::Crypto::Result(Sailfish::Crypto::Result::BlockModeNotSupportedError,
+                                        QLatin1String("Authenticated encryption not supported for block modes other than GCM and CCM"));
+    }
+
+    return checkInitializationVector(iv, key, blockMode);
+}
+
+Sailfish::Crypto::Result OpenSslValidation::checkDecryptParameters(
+        const QByteArray &iv,
+        const Sailfish::Crypto::Key &key,
+        Sailfish::Crypto::CryptoManager::BlockMode blockMode,
+        Sailfish::Crypto::CryptoManager::EncryptionPadding padding,
+        const QByteArray &authenticationData,
+        const QByteArray &authenticationTag)
+{
+    if (padding != Sailfish::Crypto::CryptoManager::EncryptionPaddingNone) {
+        return Sailfish::Crypto::Result(Sailfish::Crypto::Result::OperationNotSupportedError,
+                                        QLatin1String("TODO: encryption padding other than None"));
+    }
+
+    if (!authenticationData.isEmpty()) {
+        if (blockMode != Sailfish::Crypto::CryptoManager::BlockModeGcm
+                && blockMode != Sailfish::Crypto::CryptoManager::BlockModeCcm) {
+            return Sailfish::Crypto::Result(Sailfish::Crypto::Result::BlockModeNotSupportedError,
+                                            QLatin1String("Authenticated decryption not supported for block modes other than GCM and CCM"));
+        }
+        if (authenticationTag.size() != authenticationTagSize(key.algorithm(), blockMode)) {
+            return Sailfish::Crypto::Result(Sailfish::Crypto::Result::InvalidAuthenticationTagError,
+                                            QStringLiteral("Authenticated decryption failed, authentication tag length should be %1 but was %2")
+                                                    .arg(authenticationTagSize(key.algorithm(), blockMode))
+                                                    .arg(authenticationTag.size()));
+        }
+    }
+
+    return checkInitializationVector(iv, key, blockMode);
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2018 Jolla Ltd.
+ * Contact: Chris Adams <chris.adams@jollamobile.com>
+ * All rights reserved.
+ * BSD 3-Clause License, see LICENSE.
+ */
+
+#ifndef SAILFISHCRYPTO_PLUGIN_CRYPTO_OPENSSL_EVPVALIDATION_P_H
+#define SAILFISHCRYPTO_PLUGIN_CRYPTO_OPENSSL_EVPVALIDATION_P_H
+
+#include "Crypto/cryptomanager.h"
+#include "Crypto/key.h"
+#include "Crypto/result.h"
+
+#include <QtCore/QByteArray>
+
+#define SAILFISH_CRYPTO_GCM_TAG_SIZE 16
+#define SAILFISH_CRYPTO_GCM_IV_SIZE 12
+#define SAILFISH_CRYPTO_CCM_TAG_SIZE 14
+#define SAILFISH_CRYPTO_CCM_IV_SIZE 7
+
+// Returns the initialization vector size in bytes for the given configuration,
+// zero if no initialization vector is used, or -1 if it is not recognized.
+int initializationVectorSize(Sailfish::Crypto::CryptoManager::Algorithm algorithm,
+                             Sailfish::Crypto::CryptoManager::BlockMode blockMode,
+                             int keySize);
+
+// Returns the authentication tag size in bytes for the given configuration,
+// or zero if authenticated encryption is not supported.
+int authenticationTagSize(Sailfish::Crypto::CryptoManager::Algorithm algorithm,
+                          Sailfish::Crypto::CryptoManager::BlockMode blockMode);
+
+// Validation of the parameters of digest and AES cipher operations, shared by
+// the OpenSSL crypto plugin and the in-process execution of the crypto library
+// so that both report the same errors.  A succeeded result means that the
+// parameters are supported.
+namespace OpenSslValidation {
+
+Sailfish::Crypto::Result checkDigestParameters(
+        const QByteArray &data,
+        Sailfish::Crypto::CryptoManager::SignaturePadding padding);
+
+Sailfish::Crypto::Result checkEncryptParameters(
+        const QByteArray &iv,
+        const Sailfish::Crypto::Key &key,
+        Sailfish::Crypto::CryptoManager::BlockMode blockMode,
+        Sailfish::Crypto::CryptoManager::EncryptionPadding padding,
+        const QByteArray &authenticationData);
+
+Sailfish::Crypto::Result checkDecryptParameters(
+        const QByteArray &iv,
+        const Sailfish::Crypto::Key &key,
+        Sailfish::Crypto::CryptoManager::BlockMode blockMode,
+        Sailfish::Crypto::CryptoManager::EncryptionPadding padding,
+        const QByteArray &authenticationData,
+        const QByteArray &authenticationTag);
+
+} // OpenSslValidation
+
+#endif // SAILFISHCRYPTO_PLUGIN_CRYPTO_OPENSSL_EVPVALIDATION_P_H
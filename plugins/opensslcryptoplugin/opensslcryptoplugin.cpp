@@ -8,6 +8,8 @@
 #include "opensslcryptoplugin.h"
 #include "evp_p.h"
 #include "evp_helpers_p.h"
+#include "evpaes_p.h"
+#include "evpvalidation_p.h"
 
 #include "Crypto/key.h"
 #include "Crypto/generaterandomdatarequest.h"
@@ -35,8 +37,9 @@ using namespace Sailfish::Crypto;
 Daemon::Plugins::OpenSslCryptoPlugin::OpenSslCryptoPlugin(QObject *parent)
     : QObject(parent)
 {
-    // initialize EVP
-    OpenSslEvp::init();
+    // initialize EVP, fetching the algorithm implementations in the
+    // background so that plugin loading is not delayed.
+    OpenSslEvp::init(true);
 
     // seed the RNG
     char seed[1024] = {0};
@@ -345,7 +348,7 @@ Daemon::Plugins::OpenSslCryptoPlugin::generateKey(
         const Sailfish::Crypto::Key &keyTemplate,
         const Sailfish::Crypto::KeyPairGenerationParameters &kpgParams,
         const Sailfish::Crypto::KeyDerivationParameters &skdfParams,
-        const QVariantMap & /* customParameters */,
+        const QVariantMap &customParameters,
         Sailfish::Crypto::Key *key)
 {
     // generate an asymmetrical key pair if required
@@ -391,6 +394,11 @@ Daemon::Plugins::OpenSslCryptoPlugin::generateKey(
     }
 
     // use key derivation to derive a key from input data.
+    if (skdfParams.keyDerivationFunction() == Sailfish::Crypto::CryptoManager::KdfScrypt
+            || skdfParams.keyDerivationFunction() == Sailfish::Crypto::CryptoManager::KdfArgon2id) {
+        return deriveMemoryHardKey(skdfParams, keyTemplate, key);
+    }
+
     if (skdfParams.keyDerivationFunction() != Sailfish::Crypto::CryptoManager::KdfPkcs5Pbkdf2) {
         return Sailfish::Crypto::Result(Sailfish::Crypto::Result::OperationNotSupportedError,
                                         QLatin1String("Unsupported key derivation function specified"));
@@ -414,7 +422,13 @@ Daemon::Plugins::OpenSslCryptoPlugin::generateKey(
                                         QLatin1String("Unsupported derived key size specified"));
     }
 
-    if (skdfParams.iterations() < 0 || skdfParams.iterations() > 32768) {
+    // the daemon may use a higher cost, calibrated for the device,
+    // when deriving keys from the master lock code.
+    const int maximumIterations = customParameters.value(
+                QLatin1String(Sailfish_Crypto_CryptoPlugin_DaemonRequestParameter)).toBool()
+            ? 4000000
+            : 32768;
+    if (skdfParams.iterations() < 0 || skdfParams.iterations() > maximumIterations) {
         return Sailfish::Crypto::Result(Sailfish::Crypto::Result::OperationNotSupportedError,
                                         QLatin1String("Unsupported iterations specified"));
     }
@@ -442,6 +456,89 @@ Daemon::Plugins::OpenSslCryptoPlugin::generateKey(
     return Sailfish::Crypto::Result(Sailfish::Crypto::Result::Succeeded);
 }
 
+// Derives a key with one of the memory-hard key derivation functions.
+// For scrypt the iterations are the CPU/memory cost N (a power of two),
+// with the block size r fixed to 8, so the derivation uses 1 KiB * N of memory.
+// For Argon2id the iterations are the number of passes over the memory,
+// and the memory size is given in KiB.  In both cases the parallelism
+// is the number of lanes, and the memory used by a single derivation is
+// bounded by OSSLEVP_KDF_MAX_MEMORY.
+Sailfish::Crypto::Result
+Daemon::Plugins::OpenSslCryptoPlugin::deriveMemoryHardKey(
+        const Sailfish::Crypto::KeyDerivationParameters &skdfParams,
+        const Sailfish::Crypto::Key &keyTemplate,
+        Sailfish::Crypto::Key *key)
+{
+    const bool scrypt = skdfParams.keyDerivationFunction() == Sailfish::Crypto::CryptoManager::KdfScrypt;
+
+    if (skdfParams.outputKeySize() < 8 || skdfParams.outputKeySize() > 2048 || (skdfParams.outputKeySize() % 8) != 0) {
+        return Sailfish::Crypto::Result(Sailfish::Crypto::Result::OperationNotSupportedError,
+                                        QLatin1String("Unsupported derived key size specified"));
+    }
+
+    if (skdfParams.parallelism() < 1 || skdfParams.parallelism() > OSSLEVP_SCRYPT_MAX_PARALLELISM) {
+        return Sailfish::Crypto::Result(Sailfish::Crypto::Result::OperationNotSupportedError,
+                                        QLatin1String("Unsupported parallelism specified"));
+    }
+
+    if (scrypt) {
+        if (skdfParams.iterations() < 2
+                || !OpenSslEvp::scrypt_parameters_valid(static_cast<uint64_t>(skdfParams.iterations()),
+                                                        8, skdfParams.parallelism())) {
+            return Sailfish::Crypto::Result(Sailfish::Crypto::Result::OperationNotSupportedError,
+                                            QLatin1String("Unsupported iterations specified"));
+        }
+    } else {
+        if (!OpenSslEvp::argon2id_available()) {
+            return Sailfish::Crypto::Result(Sailfish::Crypto::Result::OperationNotSupportedError,
+                                            QLatin1String("Argon2id is not supported by this OpenSSL version"));
+        }
+        if (skdfParams.iterations() < 1 || skdfParams.iterations() > 64) {
+            return Sailfish::Crypto::Result(Sailfish::Crypto::Result::OperationNotSupportedError,
+                                            QLatin1String("Unsupported iterations specified"));
+        }
+        if (skdfParams.memorySize() < 8 * skdfParams.parallelism() || skdfParams.memorySize() > OSSLEVP_KDF_MAX_MEMORY / 1024) {
+            return Sailfish::Crypto::Result(Sailfish::Crypto::Result::OperationNotSupportedError,
+                                            QLatin1String("Unsupported memory size specified"));
+        }
+        if (skdfParams.salt().size() < 8) {
+            return Sailfish::Crypto::Result(Sailfish::Crypto::Result::OperationNotSupportedError,
+                                            QLatin1String("Argon2id requires a salt of at least 8 bytes"));
+        }
+    }
+
+    const unsigned char *salt = skdfParams.salt().isEmpty()
+            ? Q_NULLPTR
+            : reinterpret_cast<const unsigned char*>(skdfParams.salt().constData());
+    int nbytes = skdfParams.outputKeySize() / 8;
+    QScopedArrayPointer<char> buf(new char[nbytes]);
+    const int derived = scrypt
+            ? OpenSslEvp::scrypt(skdfParams.inputData().constData(),
+                                 skdfParams.inputData().size(),
+                                 salt, skdfParams.salt().size(),
+                                 static_cast<uint64_t>(skdfParams.iterations()), 8,
+                                 skdfParams.parallelism(),
+                                 nbytes,
+                                 reinterpret_cast<unsigned char*>(buf.data()))
+            : OpenSslEvp::argon2id(skdfParams.inputData().constData(),
+                                   skdfParams.inputData().size(),
+                                   salt, skdfParams.salt().size(),
+                                   static_cast<uint32_t>(skdfParams.iterations()),
+                                   static_cast<uint32_t>(skdfParams.memorySize()),
+                                   static_cast<uint32_t>(skdfParams.parallelism()),
+                                   nbytes,
+                                   reinterpret_cast<unsigned char*>(buf.data()));
+    if (derived != 1) {
+        return Sailfish::Crypto::Result(Sailfish::Crypto::Result::CryptoPluginKeyGenerationError,
+                                        QLatin1String("The crypto plugin failed to derive the key data"));
+    }
+
+    *key = keyTemplate;
+    key->setSecretKey(QByteArray(buf.data(), nbytes));
+    key->setSize(skdfParams.outputKeySize());
+    return Sailfish::Crypto::Result(Sailfish::Crypto::Result::Succeeded);
+}
+
 struct PassphraseData
 {
     const QByteArray &passphrase;
@@ -580,14 +677,9 @@ Daemon::Plugins::OpenSslCryptoPlugin::calculateDigest(
                                         QLatin1String("Given output argument 'digest' was nullptr."));
     }
 
-    if (data.length() == 0) {
-        return Sailfish::Crypto::Result(Sailfish::Crypto::Result::EmptyDataError,
-                                        QLatin1String("Can't digest data if there is no data."));
-    }
-
-    if (padding != Sailfish::Crypto::CryptoManager::SignaturePaddingNone) {
-        return Sailfish::Crypto::Result(Sailfish::Crypto::Result::OperationNotSupportedError,
-                                        QLatin1String("TODO: digest padding other than None"));
+    const Sailfish::Crypto::Result parametersResult = OpenSslValidation::checkDigestParameters(data, padding);
+    if (parametersResult.code() != Sailfish::Crypto::Result::Succeeded) {
+        return parametersResult;
     }
 
     // Get the EVP digest function
@@ -874,47 +966,21 @@ Daemon::Plugins::OpenSslCryptoPlugin::encryptAes(
                                         QLatin1String("OpenSslCryptoPlugin::encryptAes should only be used with AES"));
     }
 
-    if (padding != Sailfish::Crypto::CryptoManager::EncryptionPaddingNone) {
-        return Sailfish::Crypto::Result(Sailfish::Crypto::Result::OperationNotSupportedError,
-                                        QLatin1String("TODO: encryption padding other than None"));
-    }
-
-    if (key.secretKey().size() * 8 != key.size()) {
-        // The secret is not of the expected length (e.g. 128-bit, 256-bit)
-        return Sailfish::Crypto::Result(Sailfish::Crypto::Result::CryptoPluginKeyGenerationError,
-                                        QLatin1String("Secret key size does not match"));
-    }
-
-    unsigned int tagSize = authenticationTagSize(key.algorithm(), blockMode);
-    if (!authenticationData.isEmpty()) {
-        if (key.algorithm() != Sailfish::Crypto::CryptoManager::AlgorithmAes) {
-            return Sailfish::Crypto::Result(Sailfish::Crypto::Result::OperationNotSupportedError,
-                                            QLatin1String("Authenticated encryption not supported for algorithms other than AES"));
-        }
-        if (tagSize == 0) {
-            return Sailfish::Crypto::Result(Sailfish::Crypto::Result::BlockModeNotSupportedError,
-                                            QLatin1String("Authenticated encryption not supported for block modes other than GCM and CCM"));
-        }
-        if (!authenticationTag) {
-            return Sailfish::Crypto::Result(Sailfish::Crypto::Result::InvalidAuthenticationTagError,
-                                            QLatin1String("Authenticated encryption failed, no authentication tag container provided"));
-        }
+    const Sailfish::Crypto::Result parametersResult = OpenSslValidation::checkEncryptParameters(
+                iv, key, blockMode, padding, authenticationData);
+    if (parametersResult.code() != Sailfish::Crypto::Result::Succeeded) {
+        return parametersResult;
     }
 
-    const int expectedIvSize = initializationVectorSize(key.algorithm(), blockMode, key.size());
-    if (!iv.isEmpty() && expectedIvSize < 0) {
-        return Sailfish::Crypto::Result(Sailfish::Crypto::Result::InvalidInitializationVectorError,
-                                        QStringLiteral("Initialization Vector should not be provided for this algorithm/mode/key configuration"));
-    } else if (iv.size() != expectedIvSize) {
-        return Sailfish::Crypto::Result(Sailfish::Crypto::Result::InvalidInitializationVectorError,
-                                        QStringLiteral("Initialization Vector length should be %1 but was %2")
-                                                .arg(expectedIvSize)
-                                                .arg(iv.size()));
+    const unsigned int tagSize = authenticationTagSize(key.algorithm(), blockMode);
+    if (!authenticationData.isEmpty() && !authenticationTag) {
+        return Sailfish::Crypto::Result(Sailfish::Crypto::Result::InvalidAuthenticationTagError,
+                                        QLatin1String("Authenticated encryption failed, no authentication tag container provided"));
     }
 
     // encrypt plaintext
     if (!authenticationData.isEmpty()) {
-        QPair<QByteArray, QByteArray> resultData = aes_auth_encrypt_plaintext(blockMode, data, key.secretKey(), iv, authenticationData, tagSize);
+        QPair<QByteArray, QByteArray> resultData = OpenSslAes::authEncrypt(getEvpCipher(blockMode, key.secretKey().size()), data, key.secretKey(), iv, authenticationData, tagSize);
         const QByteArray &ciphertext = resultData.first;
         const QByteArray &authenticationTagData = resultData.second;
         if (authenticationTagData.isEmpty()) {
@@ -927,7 +993,7 @@ Daemon::Plugins::OpenSslCryptoPlugin::encryptAes(
             return Sailfish::Crypto::Result(Sailfish::Crypto::Result::Succeeded);
         }
     } else {
-        const QByteArray &ciphertext = aes_encrypt_plaintext(blockMode, data, key.secretKey(), iv);
+        const QByteArray &ciphertext = OpenSslAes::encrypt(getEvpCipher(blockMode, key.secretKey().size()), data, key.secretKey(), iv);
         if (!ciphertext.isEmpty()) {
             *encrypted = ciphertext;
             return Sailfish::Crypto::Result(Sailfish::Crypto::Result::Succeeded);
@@ -1063,51 +1129,23 @@ Daemon::Plugins::OpenSslCryptoPlugin::decryptAes(
                                         QLatin1String("OpenSslCryptoPlugin::decryptAes should only be used with AES"));
     }
 
-    if (padding != Sailfish::Crypto::CryptoManager::EncryptionPaddingNone) {
-        return Sailfish::Crypto::Result(Sailfish::Crypto::Result::OperationNotSupportedError,
-                                        QLatin1String("TODO: encryption padding other than None"));
-    }
-
-    if (!authenticationData.isEmpty()) {
-        if (key.algorithm() != Sailfish::Crypto::CryptoManager::AlgorithmAes) {
-            return Sailfish::Crypto::Result(Sailfish::Crypto::Result::OperationNotSupportedError,
-                                            QLatin1String("Authenticated decryption not supported for algorithms other than AES"));
-        }
-        if (blockMode != Sailfish::Crypto::CryptoManager::BlockModeGcm
-                && blockMode != Sailfish::Crypto::CryptoManager::BlockModeCcm) {
-            return Sailfish::Crypto::Result(Sailfish::Crypto::Result::BlockModeNotSupportedError,
-                                            QLatin1String("Authenticated decryption not supported for block modes other than GCM and CCM"));
-        }
-        if (authenticationTag.size() != authenticationTagSize(key.algorithm(), blockMode)) {
-            return Sailfish::Crypto::Result(Sailfish::Crypto::Result::InvalidAuthenticationTagError,
-                                            QStringLiteral("Authenticated decryption failed, authentication tag length should be %1 but was %2")
-                                                    .arg(authenticationTagSize(key.algorithm(), blockMode))
-                                                    .arg(authenticationTag.size()));
-        }
-    }
-
-    const int expectedIvSize = initializationVectorSize(key.algorithm(), blockMode, key.size());
-    if (!iv.isEmpty() && expectedIvSize < 0) {
-        return Sailfish::Crypto::Result(Sailfish::Crypto::Result::InvalidInitializationVectorError,
-                                        QStringLiteral("Initialization Vector should not be provided for this algorithm/mode/key configuration"));
-    } else if (iv.size() != expectedIvSize) {
-        return Sailfish::Crypto::Result(Sailfish::Crypto::Result::InvalidInitializationVectorError,
-                                        QStringLiteral("Initialization Vector length should be %1 but was %2")
-                                                .arg(expectedIvSize)
-                                                .arg(iv.size()));
+    const Sailfish::Crypto::Result parametersResult = OpenSslValidation::checkDecryptParameters(
+                iv, key, blockMode, padding, authenticationData, authenticationTag);
+    if (parametersResult.code() != Sailfish::Crypto::Result::Succeeded) {
+        return parametersResult;
     }
 
     // decrypt ciphertext
     QByteArray plaintext;
     Sailfish::Crypto::CryptoManager::VerificationStatus verificationStatusResult = Sailfish::Crypto::CryptoManager::VerificationFailed;
     if (!authenticationData.isEmpty()) {
-        QPair<QByteArray, bool> authDecryptResult = aes_auth_decrypt_ciphertext(blockMode, data, key.secretKey(), iv, authenticationData, authenticationTag);
+        QPair<QByteArray, bool> authDecryptResult = OpenSslAes::authDecrypt(getEvpCipher(blockMode, key.secretKey().size()), data, key.secretKey(), iv, authenticationData, authenticationTag);
         plaintext = authDecryptResult.first;
         verificationStatusResult = authDecryptResult.second
                 ? Sailfish::Crypto::CryptoManager::VerificationSucceeded
                 : Sailfish::Crypto::CryptoManager::VerificationFailed;
     } else {
-        plaintext = aes_decrypt_ciphertext(blockMode, data, key.secretKey(), iv);
+        plaintext = OpenSslAes::decrypt(getEvpCipher(blockMode, key.secretKey().size()), data, key.secretKey(), iv);
     }
     if (!plaintext.size() || (plaintext.size() == 1 && plaintext.at(0) == 0)) {
         return Sailfish::Crypto::Result(Sailfish::Crypto::Result::CryptoPluginDecryptionError,
@@ -1585,128 +1623,3 @@ Daemon::Plugins::OpenSslCryptoPlugin::finalizeCipherSession(
 
     return Sailfish::Crypto::Result(Sailfish::Crypto::Result::Succeeded);
 }
-
-QByteArray
-Daemon::Plugins::OpenSslCryptoPlugin::aes_encrypt_plaintext(
-        Sailfish::Crypto::CryptoManager::BlockMode blockMode,
-        const QByteArray &plaintext,
-        const QByteArray &key,
-        const QByteArray &init_vector)
-{
-    QByteArray encryptedData;
-    unsigned char *encrypted = Q_NULLPTR;
-    int size = OpenSslEvp::aes_encrypt_plaintext(getEvpCipher(blockMode, key.size()),
-                                             (const unsigned char *)init_vector.constData(),
-                                             (const unsigned char *)key.constData(),
-                                             key.size(),
-                                             (const unsigned char *)plaintext.constData(),
-                                             plaintext.size(),
-                                             &encrypted);
-    if (size <= 0) {
-        return QByteArray();
-    }
-
-    encryptedData = QByteArray((const char *)encrypted, size);
-    free(encrypted);
-    return encryptedData;
-}
-
-QByteArray
-Daemon::Plugins::OpenSslCryptoPlugin::aes_decrypt_ciphertext(
-        Sailfish::Crypto::CryptoManager::BlockMode blockMode,
-        const QByteArray &ciphertext,
-        const QByteArray &key,
-        const QByteArray &init_vector)
-{
-    QByteArray decryptedData;
-    unsigned char *decrypted = Q_NULLPTR;
-    int size = OpenSslEvp::aes_decrypt_ciphertext(getEvpCipher(blockMode, key.size()),
-                                              (const unsigned char *)init_vector.constData(),
-                                              (const unsigned char *)key.constData(),
-                                              key.size(),
-                                              (const unsigned char *)ciphertext.constData(),
-                                              ciphertext.size(),
-                                              &decrypted);
-    if (size <= 0) {
-        return QByteArray();
-    }
-
-    decryptedData = QByteArray((const char *)decrypted, size);
-    free(decrypted);
-    return decryptedData;
-}
-
-QPair<QByteArray, QByteArray>
-Daemon::Plugins::OpenSslCryptoPlugin::aes_auth_encrypt_plaintext(
-        Sailfish::Crypto::CryptoManager::BlockMode blockMode,
-        const QByteArray &plaintext,
-        const QByteArray &key,
-        const QByteArray &init_vector,
-        const QByteArray &auth,
-        unsigned int authenticationTagLength)
-{
-    QByteArray encryptedData;
-    QByteArray authenticationTagData;
-    unsigned char *encrypted = Q_NULLPTR;
-    unsigned char *authenticationTag = Q_NULLPTR;
-
-    int encryptedSize = OpenSslEvp::aes_auth_encrypt_plaintext(getEvpCipher(blockMode, key.size()),
-                                                           (const unsigned char *)init_vector.constData(),
-                                                           init_vector.size(),
-                                                           (const unsigned char *)key.constData(),
-                                                           key.size(),
-                                                           (const unsigned char *)auth.constData(),
-                                                           auth.size(),
-                                                           (const unsigned char *)plaintext.constData(),
-                                                           plaintext.size(),
-                                                           &encrypted,
-                                                           &authenticationTag,
-                                                           authenticationTagLength);
-    if (encryptedSize <= 0) {
-        return qMakePair(QByteArray(), QByteArray());
-    }
-
-    encryptedData = QByteArray((const char *)encrypted, encryptedSize);
-    free(encrypted);
-    authenticationTagData = QByteArray((const char *)authenticationTag, authenticationTagLength);
-    free(authenticationTag);
-
-    return qMakePair(encryptedData, authenticationTagData);
-}
-
-QPair<QByteArray, bool>
-Daemon::Plugins::OpenSslCryptoPlugin::aes_auth_decrypt_ciphertext(
-        Sailfish::Crypto::CryptoManager::BlockMode blockMode,
-        const QByteArray &ciphertext,
-        const QByteArray &key,
-        const QByteArray &init_vector,
-        const QByteArray &auth,
-        const QByteArray &authenticationTag)
-{
-    QByteArray decryptedData;
-    int verifyResult = -1;
-    unsigned char *decrypted = Q_NULLPTR;
-    unsigned char *authenticationTagData = (unsigned char *)authenticationTag.data();
-
-    int size = OpenSslEvp::aes_auth_decrypt_ciphertext(getEvpCipher(blockMode, key.size()),
-                                                   (const unsigned char *)init_vector.constData(),
-                                                   init_vector.size(),
-                                                   (const unsigned char *)key.constData(),
-                                                   key.size(),
-                                                   (const unsigned char *)auth.constData(),
-                                                   auth.size(),
-                                                   authenticationTagData,
-                                                   authenticationTag.size(),
-                                                   (const unsigned char *)ciphertext.constData(),
-                                                   ciphertext.size(),
-                                                   &decrypted,
-                                                   &verifyResult);
-    if (size <= 0) {
-        return qMakePair(QByteArray(), false);
-    }
-
-    decryptedData = QByteArray((const char *)decrypted, size);
-    free(decrypted);
-    return qMakePair(decryptedData, (verifyResult > 0));
-}
-
@@ -203,12 +203,6 @@ public:
             Sailfish::Crypto::CryptoManager::VerificationStatus *verificationStatus) Q_DECL_OVERRIDE;
 
 private:
-    QByteArray aes_encrypt_plaintext(Sailfish::Crypto::CryptoManager::BlockMode blockMode, const QByteArray &plaintext, const QByteArray &key, const QByteArray &init_vector);
-    QByteArray aes_decrypt_ciphertext(Sailfish::Crypto::CryptoManager::BlockMode blockMode, const QByteArray &ciphertext, const QByteArray &key, const QByteArray &init_vector);
-
-    QPair<QByteArray, QByteArray> aes_auth_encrypt_plaintext(Sailfish::Crypto::CryptoManager::BlockMode blockMode, const QByteArray &plaintext, const QByteArray &key, const QByteArray &init_vector, const QByteArray &auth, unsigned int authenticationTagLength);
-    QPair<QByteArray, bool> aes_auth_decrypt_ciphertext(Sailfish::Crypto::CryptoManager::BlockMode blockMode, const QByteArray &ciphertext, const QByteArray &key, const QByteArray &init_vector, const QByteArray &auth, const QByteArray &authenticationTag);
-
     Sailfish::Crypto::Result generateRsaKey(
             const Sailfish::Crypto::Key &keyTemplate,
             const Sailfish::Crypto::KeyPairGenerationParameters &kpgParams,
@@ -221,6 +215,11 @@ private:
             const Sailfish::Crypto::KeyDerivationParameters &skdfParams,
             Sailfish::Crypto::Key *key);
 
+    Sailfish::Crypto::Result deriveMemoryHardKey(
+            const Sailfish::Crypto::KeyDerivationParameters &skdfParams,
+            const Sailfish::Crypto::Key &keyTemplate,
+            Sailfish::Crypto::Key *key);
+
     Sailfish::Crypto::Result encryptAes(const QByteArray &data,
             const QByteArray &iv,
             const Sailfish::Crypto::Key &key,
@@ -7,11 +7,12 @@ PKGCONFIG += libcrypto
 
 include($$PWD/../../common.pri)
 include($$PWD/../../lib/libsailfishcryptopluginapi.pri)
+include($$PWD/../../lib/libsailfishcryptoevp.pri)
 
 INCLUDEPATH += $$PWD/evp/
 DEPENDPATH += $$PWD/evp/
-HEADERS += $$PWD/evp/evp_p.h $$PWD/evp/evp_helpers_p.h $$PWD/opensslcryptoplugin.h
-SOURCES += $$PWD/evp/evp.cpp $$PWD/opensslcryptoplugin.cpp
+HEADERS += $$PWD/opensslcryptoplugin.h
+SOURCES += $$PWD/opensslcryptoplugin.cpp
 
 target.path=/usr/lib/Sailfish/Crypto/
 INSTALLS += target
@@ -6,15 +6,14 @@ PKGCONFIG += libcrypto
 
 include($$PWD/../../common.pri)
 include($$PWD/../../lib/libsailfishsecretspluginapi.pri)
+include($$PWD/../../lib/libsailfishcryptoevp.pri)
 
 INCLUDEPATH += $$PWD/../opensslcryptoplugin/evp/
 DEPENDPATH += $$PWD/../opensslcryptoplugin/evp/
 
 HEADERS += \
-    $$PWD/../opensslcryptoplugin/evp/evp_p.h \
     $$PWD/plugin.h
 SOURCES += \
-    $$PWD/../opensslcryptoplugin/evp/evp.cpp \
     $$PWD/plugin.cpp
 
 target.path=/usr/lib/Sailfish/Secrets/
@@ -7,6 +7,7 @@
 
 #include "plugin.h"
 #include "evp_p.h"
+#include "evpkdf_p.h"
 #include "evp_helpers_p.h"
 
 #include "Crypto/cryptomanager.h"
@@ -32,27 +33,29 @@ Daemon::Plugins::OpenSslPlugin::deriveKeyFromCode(
         const QByteArray &salt,
         QByteArray *key)
 {
-    const QByteArray inputData = authenticationCode.isEmpty()
-                         ? QByteArray(1, '\0')
-                         : authenticationCode;
-    const int nbytes = 32; // 256 bit
-    QScopedArrayPointer<char> buf(new char[nbytes]);
-    if (OpenSslEvp::pkcs5_pbkdf2_hmac(
-            inputData.constData(),
-            inputData.size(),
-            salt.isEmpty()
-                    ? NULL
-                    : reinterpret_cast<const unsigned char*>(salt.constData()),
-            salt.size(),
-            10000, // iterations
-            21, // CryptoManager::DigestSha256
-            nbytes,
-            reinterpret_cast<unsigned char*>(buf.data())) != 1) {
+    return deriveKeyFromCodeWithParameters(authenticationCode, salt, QVariantMap(), key);
+}
+
+Result
+Daemon::Plugins::OpenSslPlugin::deriveKeyFromCodeWithParameters(
+        const QByteArray &authenticationCode,
+        const QByteArray &salt,
+        const QVariantMap &parameters,
+        QByteArray *key)
+{
+    if (!OpenSslKdf::parametersSupported(parameters, salt)) {
+        return Result(Result::OperationNotSupportedError,
+                      QLatin1String("Unsupported key derivation parameters specified"));
+    }
+
+    const QByteArray derived = OpenSslKdf::deriveKey(authenticationCode, salt, parameters,
+                                                     32); // 256 bit
+    if (derived.isEmpty()) {
         return Result(Result::SecretsPluginKeyDerivationError,
                       QLatin1String("The OpenSSL plugin failed to derive the key data"));
     }
 
-    *key = QByteArray(buf.data(), nbytes);
+    *key = derived;
     return Result(Result::Succeeded);
 }
 
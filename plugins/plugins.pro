@@ -6,6 +6,7 @@ SUBDIRS += \
     $$PWD/sqliteplugin \
     $$PWD/opensslplugin \
     $$PWD/sqlcipherplugin \
+    $$PWD/inmemoryplugin \
     $$PWD/opensslcryptoplugin \
     $$PWD/exampleusbtokenplugin \
     $$PWD/gnupgplugin
@@ -7,6 +7,8 @@
 
 #include "sqlcipherplugin.h"
 #include "evp_p.h"
+#include "evpkdf_p.h"
+#include "filterdataindex_p.h"
 
 #include <QDir>
 #include <QFile>
@@ -46,11 +48,12 @@ static const char *createSecretsTable =
 
 static const char *createSecretsFilterDataTable =
         "\n CREATE TABLE SecretsFilterData ("
+        "   FilterDataId INTEGER PRIMARY KEY,"
         "   SecretName TEXT NOT NULL,"
         "   Field TEXT NOT NULL,"
         "   Value TEXT,"
         "   FOREIGN KEY (SecretName) REFERENCES Secrets (SecretName) ON DELETE CASCADE,"
-        "   PRIMARY KEY (SecretName, Field));";
+        "   UNIQUE (SecretName, Field));";
 
 static const char *createStatements[] =
 {
@@ -59,11 +62,24 @@ static const char *createStatements[] =
     NULL
 };
 
+// Version 2 gives the filter data an explicit row id, to which the
+// full-text index of the filter data values refers.
+static const char *upgradeVersion1[] = {
+    "\n ALTER TABLE SecretsFilterData RENAME TO OldSecretsFilterData;",
+    createSecretsFilterDataTable,
+    "\n INSERT INTO SecretsFilterData (SecretName, Field, Value)"
+    "   SELECT SecretName, Field, Value FROM OldSecretsFilterData;",
+    "\n DROP TABLE OldSecretsFilterData;",
+    "\n PRAGMA user_version=2;",
+    0
+};
+
 static Daemon::Sqlite::UpgradeOperation upgradeVersions[] = {
+    { Daemon::Sqlite::FilterDataIndex::drop, upgradeVersion1 },
     { 0, 0 },
 };
 
-static const int currentSchemaVersion = 1;
+static const int currentSchemaVersion = 2;
 
 Result
 Daemon::Plugins::SqlCipherPlugin::openCollectionDatabase(
@@ -114,6 +130,9 @@ Daemon::Plugins::SqlCipherPlugin::openCollectionDatabase(
                               QLatin1String("SQLCipher plugin was unable to open the collection database"));
             } else {
                 m_collectionDatabases.insert(collectionName, db);
+                if (Daemon::Sqlite::FilterDataIndex::open(db)) {
+                    m_indexedCollectionDatabases.insert(collectionName);
+                }
                 retn = Result(Result::Succeeded);
             }
         }
@@ -184,6 +203,7 @@ Daemon::Plugins::SqlCipherPlugin::removeCollection(
 {
     Result retn(Result::Succeeded);
     Daemon::Sqlite::Database *db = m_collectionDatabases.take(collectionName);
+    m_indexedCollectionDatabases.remove(collectionName);
     if (db) {
         db->close();
         delete db;
@@ -239,27 +259,29 @@ Daemon::Plugins::SqlCipherPlugin::deriveKeyFromCode(
         const QByteArray &salt,
         QByteArray *key)
 {
-    const QByteArray inputData = authenticationCode.isEmpty()
-                         ? QByteArray(1, '\0')
-                         : authenticationCode;
-    const int nbytes = 32; // 256 bit
-    QScopedArrayPointer<char> buf(new char[nbytes]);
-    if (OpenSslEvp::pkcs5_pbkdf2_hmac(
-            inputData.constData(),
-            inputData.size(),
-            salt.isEmpty()
-                    ? NULL
-                    : reinterpret_cast<const unsigned char*>(salt.constData()),
-            salt.size(),
-            10000, // iterations
-            21, // CryptoManager::DigestSha256
-            nbytes,
-            reinterpret_cast<unsigned char*>(buf.data())) != 1) {
+    return deriveKeyFromCodeWithParameters(authenticationCode, salt, QVariantMap(), key);
+}
+
+Result
+Daemon::Plugins::SqlCipherPlugin::deriveKeyFromCodeWithParameters(
+        const QByteArray &authenticationCode,
+        const QByteArray &salt,
+        const QVariantMap &parameters,
+        QByteArray *key)
+{
+    if (!OpenSslKdf::parametersSupported(parameters, salt)) {
+        return Result(Result::OperationNotSupportedError,
+                      QLatin1String("Unsupported key derivation parameters specified"));
+    }
+
+    const QByteArray derived = OpenSslKdf::deriveKey(authenticationCode, salt, parameters,
+                                                     32); // 256 bit
+    if (derived.isEmpty()) {
         return Result(Result::SecretsPluginKeyDerivationError,
-                      QLatin1String("The OpenSSL plugin failed to derive the key data"));
+                      QLatin1String("The SQLCipher plugin failed to derive the key data"));
     }
 
-    *key = QByteArray(buf.data(), nbytes);
+    *key = derived;
     return Result(Result::Succeeded);
 }
 
@@ -270,6 +292,7 @@ Daemon::Plugins::SqlCipherPlugin::setEncryptionKey(
 {
     if (m_collectionDatabases.contains(collectionName)) {
         Daemon::Sqlite::Database *db = m_collectionDatabases.take(collectionName);
+        m_indexedCollectionDatabases.remove(collectionName);
         if (db) {
             db->close();
             delete db;
@@ -601,6 +624,108 @@ Daemon::Plugins::SqlCipherPlugin::getSecret(
     return Result(Result::Succeeded);
 }
 
+Result
+Daemon::Plugins::SqlCipherPlugin::getSecretFilterData(
+        const QString &collectionName,
+        const QString &secretName,
+        Secret::FilterData *filterData)
+{
+    // Note: don't disallow collectionName=standalone, since that's how we store standalone secrets.
+    if (secretName.isEmpty()) {
+        return Result(Result::InvalidSecretError,
+                      QString::fromUtf8("Empty secret name given"));
+    } else if (collectionName.isEmpty()) {
+        return Result(Result::InvalidCollectionError,
+                      QString::fromUtf8("Empty collection name given"));
+    }
+
+    Daemon::Sqlite::Database *db = m_collectionDatabases.value(collectionName);
+    if (!db) {
+        const QString collectionPath = m_databaseDirPath + collectionName + QLatin1String(".db");
+        return QFile::exists(collectionPath)
+                ? Result(Result::CollectionIsLockedError,
+                         QLatin1String("That collection is locked"))
+                : Result(Result::InvalidCollectionError,
+                         QLatin1String("No collection with that name exists"));
+    }
+
+    Daemon::Sqlite::DatabaseLocker locker(db);
+
+    // only check that the secret exists, the secret blob itself is not read.
+    const QString selectSecretQuery = QStringLiteral(
+                 "SELECT"
+                    " SecretName"
+                  " FROM Secrets"
+                  " WHERE SecretName = ?;"
+             );
+
+    QString errorText;
+    Daemon::Sqlite::Database::Query sq = db->prepare(selectSecretQuery, &errorText);
+    if (!errorText.isEmpty()) {
+        return Result(Result::DatabaseQueryError,
+                      QString::fromUtf8("SQLCipher plugin unable to prepare select secret query: %1").arg(errorText));
+    }
+
+    QVariantList values;
+    values << QVariant::fromValue<QString>(secretName);
+    sq.bindValues(values);
+
+    if (!db->beginTransaction()) {
+        return Result(Result::DatabaseTransactionError,
+                      QString::fromUtf8("SQLCipher plugin unable to begin transaction"));
+    }
+
+    if (!db->execute(sq, &errorText)) {
+        db->rollbackTransaction();
+        return Result(Result::DatabaseQueryError,
+                      QString::fromUtf8("SQLCipher plugin unable to execute select secret query: %1").arg(errorText));
+    }
+
+    const bool found = sq.next();
+    Secret::FilterData secretFilterData;
+    if (found) {
+        const QString selectSecretFilterDataQuery = QStringLiteral(
+                     "SELECT"
+                        " Field,"
+                        " Value"
+                      " FROM SecretsFilterData"
+                      " WHERE SecretName = ?;"
+                 );
+
+        Daemon::Sqlite::Database::Query sfdq = db->prepare(selectSecretFilterDataQuery, &errorText);
+        if (!errorText.isEmpty()) {
+            db->rollbackTransaction();
+            return Result(Result::DatabaseQueryError,
+                          QString::fromUtf8("SQLCipher plugin unable to prepare select secret filter data query: %1").arg(errorText));
+        }
+        sfdq.bindValues(values);
+
+        if (!db->execute(sfdq, &errorText)) {
+            db->rollbackTransaction();
+            return Result(Result::DatabaseQueryError,
+                          QString::fromUtf8("SQLCipher plugin unable to execute select secret filter data query: %1").arg(errorText));
+        }
+
+        while (sfdq.next()) {
+            secretFilterData.insert(sfdq.value(0).value<QString>(), sfdq.value(1).value<QString>());
+        }
+    }
+
+    if (!db->commitTransaction()) {
+        db->rollbackTransaction();
+        return Result(Result::DatabaseTransactionError,
+                      QString::fromUtf8("SQLCipher plugin unable to commit select secret filter data transaction"));
+    }
+
+    if (!found) {
+        return Result(Result::InvalidSecretError,
+                      QString::fromUtf8("No such secret stored"));
+    }
+
+    *filterData = secretFilterData;
+    return Result(Result::Succeeded);
+}
+
 Result
 Daemon::Plugins::SqlCipherPlugin::secretNames(
         const QString &collectionName,
@@ -657,6 +782,17 @@ Daemon::Plugins::SqlCipherPlugin::findSecrets(
         const Secret::FilterData &filter,
         StoragePlugin::FilterOperator filterOperator,
         QVector<Secret::Identifier> *identifiers)
+{
+    return findSecrets(collectionName, filter, filterOperator, StoragePlugin::MatchExact, identifiers);
+}
+
+Result
+Daemon::Plugins::SqlCipherPlugin::findSecrets(
+        const QString &collectionName,
+        const Secret::FilterData &filter,
+        StoragePlugin::FilterOperator filterOperator,
+        StoragePlugin::FilterMatch filterMatch,
+        QVector<Secret::Identifier> *identifiers)
 {
     // Note: don't disallow collectionName=standalone, since that's how we store standalone secrets.
     if (collectionName.isEmpty()) {
@@ -679,16 +815,45 @@ Daemon::Plugins::SqlCipherPlugin::findSecrets(
 
     Daemon::Sqlite::DatabaseLocker locker(db);
 
-    // very naive implementation.
-    // first, select all of the field/value filter data for the secret
+    if (filterMatch != StoragePlugin::MatchExact
+            && filterMatch != StoragePlugin::MatchPrefix
+            && filterMatch != StoragePlugin::MatchGlob
+            && filterMatch != StoragePlugin::MatchFullText) {
+        return Result(Result::OperationNotSupportedError,
+                      QString::fromUtf8("SQLCipher plugin does not support the given filter match"));
+    }
+
+    // first, select the field/value filter data for the secrets.
+    // if the full-text index is available, only those secrets which
+    // have a value containing the words of some filter value need
+    // to be considered; otherwise all secrets in the collection are.
     // second, filter in-memory.
+    const QString matchExpression = filterMatch == StoragePlugin::MatchFullText
+                                    && m_indexedCollectionDatabases.contains(collectionName)
+            ? Daemon::Sqlite::FilterDataIndex::matchExpression(filter)
+            : QString();
 
-    const QString selectSecretsFilterDataQuery = QStringLiteral(
+    const QString selectSecretsFilterDataQuery = matchExpression.isEmpty()
+            ? QStringLiteral(
                  "SELECT"
                     " SecretName,"
                     " Field,"
                     " Value"
                  " FROM SecretsFilterData;"
+             )
+            : QStringLiteral(
+                 "SELECT"
+                    " SecretName,"
+                    " Field,"
+                    " Value"
+                 " FROM SecretsFilterData"
+                 " WHERE SecretName IN ("
+                    "SELECT SecretName"
+                    " FROM SecretsFilterData"
+                    " WHERE FilterDataId IN ("
+                        "SELECT rowid"
+                        " FROM SecretsFilterDataIndex"
+                        " WHERE SecretsFilterDataIndex MATCH ?));"
              );
 
     QString errorText;
@@ -698,6 +863,12 @@ Daemon::Plugins::SqlCipherPlugin::findSecrets(
                       QString::fromUtf8("SQLCipher plugin unable to prepare select secrets filter data query: %1").arg(errorText));
     }
 
+    if (!matchExpression.isEmpty()) {
+        QVariantList values;
+        values << QVariant::fromValue<QString>(matchExpression);
+        sq.bindValues(values);
+    }
+
     if (!db->beginTransaction()) {
         return Result(Result::DatabaseTransactionError,
                       QString::fromUtf8("SQLCipher plugin unable to begin find secrets transaction"));
@@ -717,42 +888,16 @@ Daemon::Plugins::SqlCipherPlugin::findSecrets(
     // perform in-memory filtering.
     QSet<QString> matchingSecretNames;
     for (QMap<QString, Secret::FilterData >::const_iterator it = secretNameToFilterData.constBegin(); it != secretNameToFilterData.constEnd(); it++) {
-        const Secret::FilterData &currFilterData(it.value());
-        bool matches = filterOperator == StoragePlugin::OperatorOr ? false : true;
-        for (Secret::FilterData::const_iterator fit = filter.constBegin(); fit != filter.constEnd(); fit++) {
-            bool found = false;
-            for (Secret::FilterData::const_iterator mit = currFilterData.constBegin(); mit != currFilterData.constEnd(); mit++) {
-                if (fit.key().compare(mit.key(), Qt::CaseInsensitive) == 0) {
-                    found = true; // found a matching metadata field for this filter field
-                    if (fit.value().compare(mit.value(), Qt::CaseInsensitive) == 0) {
-                        // the metadata value matches the filter value
-                        if (filterOperator == StoragePlugin::OperatorOr) {
-                            // we have a match!
-                            matches = true;
-                        }
-                    } else {
-                        if (filterOperator == StoragePlugin::OperatorAnd) {
-                            // we know that this one doesn't match.
-                            matches = false;
-                        }
-                    }
-                    break; // mit
-                }
-            }
-            if (!found && filterOperator == StoragePlugin::OperatorAnd) {
-                // the metadata is missing a required filter field.
-                matches = false;
-                break; // fit
-            }
-        }
-        if (matches) {
+        if (StoragePlugin::filterDataMatches(it.value(), filter, filterOperator, filterMatch)) {
             matchingSecretNames.insert(it.key());
         }
     }
 
     QVector<Secret::Identifier> retn;
+    const QString pluginName = name();
+    retn.reserve(matchingSecretNames.size());
     for (const QString &secretName : matchingSecretNames) {
-        retn.append(Secret::Identifier(secretName, collectionName, name()));
+        retn.append(Secret::Identifier(secretName, collectionName, pluginName));
     }
 
     if (!db->commitTransaction()) {
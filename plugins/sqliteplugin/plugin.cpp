@@ -7,6 +7,7 @@
 
 #include "plugin.h"
 #include "sqlitedatabase_p.h"
+#include "filterdataindex_p.h"
 
 Q_PLUGIN_METADATA(IID Sailfish_Secrets_StoragePlugin_IID)
 
@@ -16,6 +17,7 @@ using namespace Sailfish::Secrets;
 
 Daemon::Plugins::SqlitePlugin::SqlitePlugin(QObject *parent)
     : QObject(parent)
+    , m_filterDataIndexed(false)
 {
 }
 
@@ -68,6 +70,8 @@ void Daemon::Plugins::SqlitePlugin::openDatabaseIfNecessary()
             m_db.rollbackTransaction();
         }
     }
+
+    m_filterDataIndexed = Daemon::Sqlite::FilterDataIndex::open(&m_db);
 }
 
 Daemon::Plugins::SqlitePlugin::~SqlitePlugin()
@@ -514,6 +518,102 @@ Daemon::Plugins::SqlitePlugin::getSecret(
     return Result(Result::Succeeded);
 }
 
+Result
+Daemon::Plugins::SqlitePlugin::getSecretFilterData(
+        const QString &collectionName,
+        const QString &secretName,
+        Secret::FilterData *filterData)
+{
+    openDatabaseIfNecessary();
+    Daemon::Sqlite::DatabaseLocker locker(&m_db);
+
+    // Note: don't disallow collectionName=standalone, since that's how we store standalone secrets.
+    if (secretName.isEmpty()) {
+        return Result(Result::InvalidSecretError,
+                      QString::fromUtf8("Empty secret name given"));
+    } else if (collectionName.isEmpty()) {
+        return Result(Result::InvalidCollectionError,
+                      QString::fromUtf8("Empty collection name given"));
+    }
+
+    // only check that the secret exists, the secret blob itself is not read.
+    const QString selectSecretQuery = QStringLiteral(
+                 "SELECT"
+                    " SecretName"
+                  " FROM Secrets"
+                  " WHERE CollectionName = ?"
+                  " AND SecretName = ?;"
+             );
+
+    QString errorText;
+    Daemon::Sqlite::Database::Query sq = m_db.prepare(selectSecretQuery, &errorText);
+    if (!errorText.isEmpty()) {
+        return Result(Result::DatabaseQueryError,
+                      QString::fromUtf8("Sqlite plugin unable to prepare select secret query: %1").arg(errorText));
+    }
+
+    QVariantList values;
+    values << QVariant::fromValue<QString>(collectionName);
+    values << QVariant::fromValue<QString>(secretName);
+    sq.bindValues(values);
+
+    if (!m_db.beginTransaction()) {
+        return Result(Result::DatabaseTransactionError,
+                      QString::fromUtf8("Sqlite plugin unable to begin transaction"));
+    }
+
+    if (!m_db.execute(sq, &errorText)) {
+        m_db.rollbackTransaction();
+        return Result(Result::DatabaseQueryError,
+                      QString::fromUtf8("Sqlite plugin unable to execute select secret query: %1").arg(errorText));
+    }
+
+    const bool found = sq.next();
+    Secret::FilterData secretFilterData;
+    if (found) {
+        const QString selectSecretFilterDataQuery = QStringLiteral(
+                     "SELECT"
+                        " Field,"
+                        " Value"
+                      " FROM SecretsFilterData"
+                      " WHERE CollectionName = ?"
+                      " AND SecretName = ?;"
+                 );
+
+        Daemon::Sqlite::Database::Query sfdq = m_db.prepare(selectSecretFilterDataQuery, &errorText);
+        if (!errorText.isEmpty()) {
+            m_db.rollbackTransaction();
+            return Result(Result::DatabaseQueryError,
+                          QString::fromUtf8("Sqlite plugin unable to prepare select secret filter data query: %1").arg(errorText));
+        }
+        sfdq.bindValues(values);
+
+        if (!m_db.execute(sfdq, &errorText)) {
+            m_db.rollbackTransaction();
+            return Result(Result::DatabaseQueryError,
+                          QString::fromUtf8("Sqlite plugin unable to execute select secret filter data query: %1").arg(errorText));
+        }
+
+        while (sfdq.next()) {
+            secretFilterData.insert(sfdq.value(0).value<QString>(), sfdq.value(1).value<QString>());
+        }
+    }
+
+    if (!m_db.commitTransaction()) {
+        m_db.rollbackTransaction();
+        return Result(Result::DatabaseTransactionError,
+                      QString::fromUtf8("Sqlite plugin unable to commit select secret filter data transaction"));
+    }
+
+    if (!found) {
+        return Result(Result::InvalidSecretError,
+                      QString::fromUtf8("No such secret stored"));
+    }
+
+    *filterData = secretFilterData;
+    return Result(Result::Succeeded);
+}
+
 Result
 Daemon::Plugins::SqlitePlugin::secretNames(const QString &collectionName,
                                            QStringList *names)
@@ -558,6 +658,17 @@ Daemon::Plugins::SqlitePlugin::findSecrets(
         const Secret::FilterData &filter,
         StoragePlugin::FilterOperator filterOperator,
         QStringList *secretNames)
+{
+    return findSecrets(collectionName, filter, filterOperator, StoragePlugin::MatchExact, secretNames);
+}
+
+Result
+Daemon::Plugins::SqlitePlugin::findSecrets(
+        const QString &collectionName,
+        const Secret::FilterData &filter,
+        StoragePlugin::FilterOperator filterOperator,
+        StoragePlugin::FilterMatch filterMatch,
+        QStringList *secretNames)
 {
     openDatabaseIfNecessary();
     Daemon::Sqlite::DatabaseLocker locker(&m_db);
@@ -571,17 +682,47 @@ Daemon::Plugins::SqlitePlugin::findSecrets(
                       QString::fromUtf8("Empty filter given"));
     }
 
-    // very naive implementation.
-    // first, select all of the field/value filter data for the secret
+    if (filterMatch != StoragePlugin::MatchExact
+            && filterMatch != StoragePlugin::MatchPrefix
+            && filterMatch != StoragePlugin::MatchGlob
+            && filterMatch != StoragePlugin::MatchFullText) {
+        return Result(Result::OperationNotSupportedError,
+                      QString::fromUtf8("Sqlite plugin does not support the given filter match"));
+    }
+
+    // first, select the field/value filter data for the secrets.
+    // if the full-text index is available, only those secrets which
+    // have a value containing the words of some filter value need
+    // to be considered; otherwise all secrets in the collection are.
     // second, filter in-memory.
+    const QString matchExpression = filterMatch == StoragePlugin::MatchFullText && m_filterDataIndexed
+            ? Daemon::Sqlite::FilterDataIndex::matchExpression(filter)
+            : QString();
 
-    const QString selectSecretsFilterDataQuery = QStringLiteral(
+    const QString selectSecretsFilterDataQuery = matchExpression.isEmpty()
+            ? QStringLiteral(
                  "SELECT"
                     " SecretName,"
                     " Field,"
                     " Value"
                  " FROM SecretsFilterData"
                  " WHERE CollectionName = ?;"
+             )
+            : QStringLiteral(
+                 "SELECT"
+                    " SecretName,"
+                    " Field,"
+                    " Value"
+                 " FROM SecretsFilterData"
+                 " WHERE CollectionName = ?"
+                 " AND SecretName IN ("
+                    "SELECT SecretName"
+                    " FROM SecretsFilterData"
+                    " WHERE CollectionName = ?"
+                    " AND FilterDataId IN ("
+                        "SELECT rowid"
+                        " FROM SecretsFilterDataIndex"
+                        " WHERE SecretsFilterDataIndex MATCH ?));"
              );
 
     QString errorText;
@@ -593,6 +734,10 @@ Daemon::Plugins::SqlitePlugin::findSecrets(
 
     QVariantList values;
     values << QVariant::fromValue<QString>(collectionName);
+    if (!matchExpression.isEmpty()) {
+        values << QVariant::fromValue<QString>(collectionName);
+        values << QVariant::fromValue<QString>(matchExpression);
+    }
     sq.bindValues(values);
 
     if (!m_db.beginTransaction()) {
@@ -612,38 +757,8 @@ Daemon::Plugins::SqlitePlugin::findSecrets(
     }
 
     // perform in-memory filtering.
-    QSet<QString> matchingSecretNames;
     for (QMap<QString, Secret::FilterData >::const_iterator it = secretNameToFilterData.constBegin(); it != secretNameToFilterData.constEnd(); it++) {
-        const Secret::FilterData &currFilterData(it.value());
-        bool matches = filterOperator == StoragePlugin::OperatorOr ? false : true;
-        for (Secret::FilterData::const_iterator fit = filter.constBegin(); fit != filter.constEnd(); fit++) {
-            bool found = false;
-            for (Secret::FilterData::const_iterator mit = currFilterData.constBegin(); mit != currFilterData.constEnd(); mit++) {
-                if (fit.key().compare(mit.key(), Qt::CaseInsensitive) == 0) {
-                    found = true; // found a matching metadata field for this filter field
-                    if (fit.value().compare(mit.value(), Qt::CaseInsensitive) == 0) {
-                        // the metadata value matches the filter value
-                        if (filterOperator == StoragePlugin::OperatorOr) {
-                            // we have a match!
-                            matches = true;
-                        }
-                    } else {
-                        if (filterOperator == StoragePlugin::OperatorAnd) {
-                            // we know that this one doesn't match.
-                            matches = false;
-                        }
-                    }
-                    break; // mit
-                }
-            }
-            if (!found && filterOperator == StoragePlugin::OperatorAnd) {
-                // the metadata is missing a required filter field.
-                matches = false;
-                break; // fit
-            }
-        }
-        if (matches && !matchingSecretNames.contains(it.key())) {
-            matchingSecretNames.insert(it.key());
+        if (StoragePlugin::filterDataMatches(it.value(), filter, filterOperator, filterMatch)) {
             secretNames->append(it.key());
         }
     }
@@ -9,6 +9,7 @@
 #define SAILFISHSECRETS_PLUGIN_STORAGE_SQLITE_DATABASE_P_H
 
 #include "database_p.h"
+#include "filterdataindex_p.h"
 
 static const char *setupEnforceForeignKeys =
         "\n PRAGMA foreign_keys = ON;";
@@ -41,12 +42,13 @@ static const char *createSecretsTable =
 
 static const char *createSecretsFilterDataTable =
         "\n CREATE TABLE SecretsFilterData ("
+        "   FilterDataId INTEGER PRIMARY KEY,"
         "   CollectionName TEXT NOT NULL,"
         "   SecretName TEXT NOT NULL,"
         "   Field TEXT NOT NULL,"
         "   Value TEXT,"
         "   FOREIGN KEY (CollectionName, SecretName) REFERENCES Secrets (CollectionName, SecretName) ON DELETE CASCADE,"
-        "   PRIMARY KEY (CollectionName, SecretName, Field));";
+        "   UNIQUE (CollectionName, SecretName, Field));";
 
 static const char *setupStatements[] =
 {
@@ -66,10 +68,23 @@ static const char *createStatements[] =
     NULL
 };
 
+// Version 2 gives the filter data an explicit row id, to which the
+// full-text index of the filter data values refers.
+static const char *upgradeVersion1[] = {
+    "\n ALTER TABLE SecretsFilterData RENAME TO OldSecretsFilterData;",
+    createSecretsFilterDataTable,
+    "\n INSERT INTO SecretsFilterData (CollectionName, SecretName, Field, Value)"
+    "   SELECT CollectionName, SecretName, Field, Value FROM OldSecretsFilterData;",
+    "\n DROP TABLE OldSecretsFilterData;",
+    "\n PRAGMA user_version=2;",
+    0
+};
+
 static Sailfish::Secrets::Daemon::Sqlite::UpgradeOperation upgradeVersions[] = {
+    { Sailfish::Secrets::Daemon::Sqlite::FilterDataIndex::drop, upgradeVersion1 },
     { 0, 0 },
 };
 
-static const int currentSchemaVersion = 1;
+static const int currentSchemaVersion = 2;
 
 #endif // SAILFISHSECRETS_PLUGIN_STORAGE_SQLITE_DATABASE_P_H
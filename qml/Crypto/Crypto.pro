@@ -10,11 +10,13 @@ QT += qml core
 
 HEADERS += \
     $$PWD/plugintypes.h \
-    $$PWD/storedkeyidentifiersrequestwrapper.h
+    $$PWD/storedkeyidentifiersrequestwrapper.h \
+    $$PWD/batchverifyrequestwrapper.h
 
 SOURCES += \
     $$PWD/main.cpp \
-    $$PWD/storedkeyidentifiersrequestwrapper.cpp
+    $$PWD/storedkeyidentifiersrequestwrapper.cpp \
+    $$PWD/batchverifyrequestwrapper.cpp
 
 OTHER_FILES += $$PWD/qmldir
 
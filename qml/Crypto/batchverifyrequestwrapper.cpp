@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2018 Jolla Ltd.
+ * Contact: Chris Adams <chris.adams@jollamobile.com>
+ * All rights reserved.
+ * BSD 3-Clause License, see LICENSE.
+ */
+
+#include "batchverifyrequestwrapper.h"
+
+#include <QtCore/QVariant>
+#include <QtCore/QVariantList>
+
+namespace {
+    QVariantList toVariantList(const QVector<QByteArray> &values)
+    {
+        QVariantList results;
+        for (const QByteArray &value : values) {
+            results.append(value);
+        }
+        return results;
+    }
+
+    QVector<QByteArray> fromVariantList(const QVariantList &values)
+    {
+        QVector<QByteArray> results;
+        results.reserve(values.size());
+        for (const QVariant &value : values) {
+            results.append(value.toByteArray());
+        }
+        return results;
+    }
+}
+
+Sailfish::Crypto::Plugin::BatchVerifyRequestWrapper::BatchVerifyRequestWrapper(QObject *parent) : Sailfish::Crypto::BatchVerifyRequest(parent)
+{
+}
+
+QVariantList Sailfish::Crypto::Plugin::BatchVerifyRequestWrapper::signatureList() const
+{
+    return toVariantList(Sailfish::Crypto::BatchVerifyRequest::signatures());
+}
+
+void Sailfish::Crypto::Plugin::BatchVerifyRequestWrapper::setSignatureList(const QVariantList &signatures)
+{
+    Sailfish::Crypto::BatchVerifyRequest::setSignatures(fromVariantList(signatures));
+}
+
+QVariantList Sailfish::Crypto::Plugin::BatchVerifyRequestWrapper::dataList() const
+{
+    return toVariantList(Sailfish::Crypto::BatchVerifyRequest::data());
+}
+
+void Sailfish::Crypto::Plugin::BatchVerifyRequestWrapper::setDataList(const QVariantList &data)
+{
+    Sailfish::Crypto::BatchVerifyRequest::setData(fromVariantList(data));
+}
+
+QVariantList Sailfish::Crypto::Plugin::BatchVerifyRequestWrapper::verificationStatusList() const
+{
+    QVariantList results;
+    for (auto status : Sailfish::Crypto::BatchVerifyRequest::verificationStatuses()) {
+        results.append(static_cast<int>(status));
+    }
+    return results;
+}
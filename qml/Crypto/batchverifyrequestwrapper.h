@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2018 Jolla Ltd.
+ * Contact: Chris Adams <chris.adams@jollamobile.com>
+ * All rights reserved.
+ * BSD 3-Clause License, see LICENSE.
+ */
+
+#ifndef SAILFISHCRYPTO_QML_BATCHVERIFYREQUESTWRAPPER_H
+#define SAILFISHCRYPTO_QML_BATCHVERIFYREQUESTWRAPPER_H
+
+#include "Crypto/batchverifyrequest.h"
+
+#include <QtCore/QVariant>
+#include <QtCore/QVariantList>
+
+namespace Sailfish {
+
+namespace Crypto {
+
+namespace Plugin {
+
+// QML has no conversion for QVector<QByteArray>, so expose the
+// batch as plain lists instead.
+class BatchVerifyRequestWrapper : public Sailfish::Crypto::BatchVerifyRequest {
+    Q_OBJECT
+    Q_PROPERTY(QVariantList signatures READ signatureList WRITE setSignatureList NOTIFY signaturesChanged)
+    Q_PROPERTY(QVariantList data READ dataList WRITE setDataList NOTIFY dataChanged)
+    Q_PROPERTY(QVariantList verificationStatuses READ verificationStatusList NOTIFY verificationStatusesChanged)
+
+public:
+    BatchVerifyRequestWrapper(QObject *parent = Q_NULLPTR);
+
+    QVariantList signatureList() const;
+    void setSignatureList(const QVariantList &signatures);
+
+    QVariantList dataList() const;
+    void setDataList(const QVariantList &data);
+
+    QVariantList verificationStatusList() const;
+};
+
+} // Plugin
+
+} // Crypto
+
+} // Sailfish
+
+#endif // SAILFISHCRYPTO_QML_BATCHVERIFYREQUESTWRAPPER_H
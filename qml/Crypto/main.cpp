@@ -7,6 +7,7 @@
 
 #include "plugintypes.h"
 #include "storedkeyidentifiersrequestwrapper.h"
+#include "batchverifyrequestwrapper.h"
 
 #include <QtQml/QQmlEngine>
 #include <QtQml>
@@ -43,7 +44,9 @@ void Sailfish::Crypto::Plugin::CryptoPlugin::registerTypes(const char *uri)
     qmlRegisterType<Sailfish::Crypto::CalculateDigestRequest>(uri, 1, 0, "CalculateDigestRequest");
     qmlRegisterType<Sailfish::Crypto::SignRequest>(uri, 1, 0, "SignRequest");
     qmlRegisterType<Sailfish::Crypto::VerifyRequest>(uri, 1, 0, "VerifyRequest");
+    qmlRegisterType<Sailfish::Crypto::Plugin::BatchVerifyRequestWrapper>(uri, 1, 0, "BatchVerifyRequest");
     qmlRegisterType<Sailfish::Crypto::CipherRequest>(uri, 1, 0, "CipherRequest");
+    qmlRegisterType<Sailfish::Crypto::KeySessionRequest>(uri, 1, 0, "KeySessionRequest");
 
     qmlRegisterUncreatableType<Sailfish::Crypto::KeyPairGenerationParameters>(uri, 1, 0, "KeyPairGenerationParameters", QStringLiteral("Use CryptoManager.constructRsaKeygenParams, can't construct Q_GADGET type KeyPairGenerationParameters in QML"));
     qmlRegisterUncreatableType<Sailfish::Crypto::EcKeyPairGenerationParameters>(uri, 1, 0, "EcKeyPairGenerationParameters", QStringLiteral("Use CryptoManager.constructRsaKeygenParams, can't construct Q_GADGET type EcKeyPairGenerationParameters in QML"));
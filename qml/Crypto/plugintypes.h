@@ -27,7 +27,9 @@
 #include "Crypto/calculatedigestrequest.h"
 #include "Crypto/signrequest.h"
 #include "Crypto/verifyrequest.h"
+#include "Crypto/batchverifyrequest.h"
 #include "Crypto/cipherrequest.h"
+#include "Crypto/keysessionrequest.h"
 
 #include <QQmlExtensionPlugin>
 #include <QQmlParserStatus>
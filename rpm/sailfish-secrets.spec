@@ -49,6 +49,7 @@ BuildRequires:  pkgconfig(nemodevicelock)
 Requires:   qt5-qtdeclarative-import-qttest
 Requires:   qt5-qtdeclarative-devel-tools
 Requires:   libsailfishsecrets = %{version}-%{release}
+Requires:   libsailfishcrypto = %{version}-%{release}
 Requires:   openssl
 Requires:   nemo-qml-plugin-devicelock
 
@@ -98,6 +99,7 @@ Group:      System/Libraries
 BuildRequires:  pkgconfig(Qt5Core)
 BuildRequires:  pkgconfig(Qt5Sql)
 BuildRequires:  pkgconfig(Qt5DBus)
+BuildRequires:  pkgconfig(libcrypto)
 
 %description -n libsailfishcrypto
 %{summary}.
@@ -288,7 +290,7 @@ rm -rf %{buildroot}
 
 mkdir -p %{buildroot}/%{_docdir}/Sailfish/Secrets/
 mkdir -p %{buildroot}/%{_docdir}/Sailfish/Crypto/
-mkdir -p %{buildroot}/%{user_unitdir}/user-session.target.wants/
+mkdir -p %{buildroot}/%{user_unitdir}
 mkdir -p %{buildroot}/%{_datadir}/dbus-1/services/
 mkdir -p %{buildroot}/%{_datadir}/mapplauncherd/privileges.d/
 
@@ -298,8 +300,6 @@ install -m 0644 daemon/sailfish-secretsd.service %{buildroot}/%{user_unitdir}
 install -m 0644 daemon/sailfish-secretsd.privileges %{buildroot}/%{_datadir}/mapplauncherd/privileges.d/
 install -m 0644 daemon/org.sailfishos.secrets.daemon.discovery.service %{buildroot}/%{_datadir}/dbus-1/services/
 
-ln -s ../sailfish-secretsd.service %{buildroot}/%{user_unitdir}/user-session.target.wants/sailfish-secretsd.service
-
 %files -n libsailfishsecrets
 %defattr(-,root,root,-)
 %{_libdir}/libsailfishsecrets.so.*
@@ -320,14 +320,24 @@ ln -s ../sailfish-secretsd.service %{buildroot}/%{user_unitdir}/user-session.tar
 /opt/tests/Sailfish/Secrets/authentication-client
 /opt/tests/Sailfish/Secrets/tst_secrets
 /opt/tests/Sailfish/Secrets/tst_dataprotection
+/opt/tests/Sailfish/Secrets/tst_kdfparameters
 /opt/tests/Sailfish/Secrets/tst_secrets.qml
 /opt/tests/Sailfish/Secrets/tst_secretsrequests
 /opt/tests/Sailfish/Secrets/tst_secretsrequests.qml
+/opt/tests/Sailfish/Secrets/tst_secretsserialization
+/opt/tests/Sailfish/Secrets/tst_storagebenchmarks
+/opt/tests/Sailfish/Secrets/tst_startup
+/opt/tests/Sailfish/Secrets/tst_idle
+/opt/tests/Sailfish/Secrets/tst_requeststatistics
+/opt/tests/Sailfish/Secrets/tst_kdfcalibration
+/opt/tests/Sailfish/Secrets/secrets-loadgen
 %{_libdir}/Sailfish/Secrets/libsailfishsecrets-testexampleusbtoken.so
+%{_libdir}/Sailfish/Secrets/libsailfishsecrets-testlatency.so
 %{_libdir}/Sailfish/Secrets/libsailfishsecrets-testinappauth.so
 %{_libdir}/Sailfish/Secrets/libsailfishsecrets-testpasswordagentauth.so
 %{_libdir}/Sailfish/Secrets/libsailfishsecrets-testopenssl.so
 %{_libdir}/Sailfish/Secrets/libsailfishsecrets-testsqlcipher.so
+%{_libdir}/Sailfish/Secrets/libsailfishsecrets-testinmemory.so
 %{_libdir}/Sailfish/Secrets/libsailfishsecrets-testsqlite.so
 
 %files ts-devel
@@ -370,7 +380,9 @@ ln -s ../sailfish-secretsd.service %{buildroot}/%{user_unitdir}/user-session.tar
 /opt/tests/Sailfish/Crypto/tst_crypto
 /opt/tests/Sailfish/Crypto/tst_cryptorequests
 /opt/tests/Sailfish/Crypto/tst_cryptosecrets
+/opt/tests/Sailfish/Crypto/tst_cryptoserialization
 /opt/tests/Sailfish/Crypto/tst_evp
+/opt/tests/Sailfish/Crypto/tst_cryptobenchmarks
 /opt/tests/Sailfish/Crypto/tst_qml_signing
 /opt/tests/Sailfish/Crypto/tst_qml_signing.qml
 /opt/tests/Sailfish/Crypto/tst_gnupgplugin
@@ -400,13 +412,13 @@ ln -s ../sailfish-secretsd.service %{buildroot}/%{user_unitdir}/user-session.tar
 %{_datadir}/translations/sailfish-secrets_eng_en.qm
 %{_datadir}/mapplauncherd/privileges.d/sailfish-secretsd.privileges
 %{user_unitdir}/sailfish-secretsd.service
-%{user_unitdir}/user-session.target.wants/sailfish-secretsd.service
 %{_datadir}/dbus-1/services/org.sailfishos.secrets.daemon.discovery.service
 
 %files -n %{secretsdaemon}-secretsplugins-default
 %defattr(-,root,root,-)
 %{_libdir}/Sailfish/Secrets/libsailfishsecrets-openssl.so
 %{_libdir}/Sailfish/Secrets/libsailfishsecrets-sqlite.so
+%{_libdir}/Sailfish/Secrets/libsailfishsecrets-inmemory.so
 
 %files -n %{secretsdaemon}-secretsplugin-common
 %{_libdir}/Sailfish/Secrets/libsailfishsecrets-inappauth.so
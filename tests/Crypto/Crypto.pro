@@ -3,4 +3,6 @@ SUBDIRS = \
     $$PWD/tst_crypto \
     $$PWD/tst_cryptorequests \
     $$PWD/tst_cryptosecrets \
-    $$PWD/tst_evp
+    $$PWD/tst_cryptoserialization \
+    $$PWD/tst_evp \
+    $$PWD/tst_cryptobenchmarks
@@ -0,0 +1,702 @@
+/*
+ * Copyright (C) 2018 Jolla Ltd.
+ * Contact: Chris Adams <chris.adams@jollamobile.com>
+ * All rights reserved.
+ * BSD 3-Clause License, see LICENSE.
+ */
+
+#include "tst_cryptobenchmarks.h"
+#include "opensslcryptoplugin.h"
+
+#include "Crypto/keypairgenerationparameters.h"
+#include "Crypto/keyderivationparameters.h"
+#include "Crypto/result.h"
+
+#include <QtCore/QDateTime>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QSysInfo>
+#include <QtCore/QThreadPool>
+#include <QtCore/QRunnable>
+#include <QtCore/QAtomicInt>
+#include <QtCore/QVector>
+
+#include <openssl/opensslv.h>
+
+#define ENV_BENCHMARK_JSON "SAILFISH_CRYPTO_BENCHMARK_JSON"
+#define DEFAULT_BENCHMARK_JSON QStringLiteral("/tmp/sailfish_crypto_tst_cryptobenchmarks.json")
+
+#define SIGNED_DATA_SIZE 1024
+#define AUTHENTICATION_DATA_SIZE 32
+#define CONCURRENT_DATA_SIZE 1024
+#define CONCURRENT_OPERATIONS_PER_THREAD 2000
+
+QTEST_MAIN(tst_cryptobenchmarks)
+
+using namespace Sailfish::Crypto;
+
+namespace {
+    // XTS is not included: its key consists of two AES keys, which the
+    // plugin's key size validation does not currently allow for.
+    const QList<CryptoManager::BlockMode> blockModes {
+        CryptoManager::BlockModeEcb,
+        CryptoManager::BlockModeCbc,
+        CryptoManager::BlockModeCfb1,
+        CryptoManager::BlockModeCfb8,
+        CryptoManager::BlockModeCfb128,
+        CryptoManager::BlockModeOfb,
+        CryptoManager::BlockModeCtr,
+        CryptoManager::BlockModeGcm,
+        CryptoManager::BlockModeCcm
+    };
+    const QList<CryptoManager::BlockMode> sessionBlockModes {
+        CryptoManager::BlockModeCbc,
+        CryptoManager::BlockModeCtr,
+        CryptoManager::BlockModeGcm
+    };
+    const QList<int> aesKeySizes { 128, 192, 256 };
+    const QList<int> bufferSizes { 64, 1024, 16384, 1048576 };
+    const QList<int> chunkSizes { 16, 256, 4096, 65536 };
+    const QList<int> pbkdf2Iterations { 1000, 4096, 16384, 32768 };
+    const QList<int> threadCounts { 1, 2, 4, 8 };
+    const QList<CryptoManager::DigestFunction> pbkdf2Digests {
+        CryptoManager::DigestSha1,
+        CryptoManager::DigestSha256,
+        CryptoManager::DigestSha512
+    };
+    const QStringList keyPairTypes {
+        QStringLiteral("rsa1024"),
+        QStringLiteral("rsa2048"),
+        QStringLiteral("rsa4096"),
+        QStringLiteral("ecSecp256r1"),
+        QStringLiteral("ecSecp384r1"),
+        QStringLiteral("ecSecp521r1")
+    };
+
+    bool isAuthenticatedMode(CryptoManager::BlockMode blockMode)
+    {
+        return blockMode == CryptoManager::BlockModeGcm
+                || blockMode == CryptoManager::BlockModeCcm;
+    }
+
+    QString blockModeName(CryptoManager::BlockMode blockMode)
+    {
+        switch (blockMode) {
+            case CryptoManager::BlockModeEcb:    return QStringLiteral("ecb");
+            case CryptoManager::BlockModeCbc:    return QStringLiteral("cbc");
+            case CryptoManager::BlockModeCfb1:   return QStringLiteral("cfb1");
+            case CryptoManager::BlockModeCfb8:   return QStringLiteral("cfb8");
+            case CryptoManager::BlockModeCfb128: return QStringLiteral("cfb128");
+            case CryptoManager::BlockModeOfb:    return QStringLiteral("ofb");
+            case CryptoManager::BlockModeCtr:    return QStringLiteral("ctr");
+            case CryptoManager::BlockModeGcm:    return QStringLiteral("gcm");
+            case CryptoManager::BlockModeCcm:    return QStringLiteral("ccm");
+            default:                             return QString::number(static_cast<int>(blockMode));
+        }
+    }
+
+    QString digestName(CryptoManager::DigestFunction digest)
+    {
+        switch (digest) {
+            case CryptoManager::DigestSha1:   return QStringLiteral("sha1");
+            case CryptoManager::DigestSha256: return QStringLiteral("sha256");
+            case CryptoManager::DigestSha512: return QStringLiteral("sha512");
+            default:                          return QString::number(static_cast<int>(digest));
+        }
+    }
+
+    QByteArray benchmarkData(int size)
+    {
+        QByteArray data(size, Qt::Uninitialized);
+        for (int i = 0; i < size; ++i) {
+            data[i] = static_cast<char>(i * 31 + 7);
+        }
+        return data;
+    }
+}
+
+// Accumulates the time spent in the measured operation over all of the
+// executions of a QBENCHMARK body, so that the per-operation cost can be
+// reported independently of the QtTest output format.
+class OperationTimer
+{
+public:
+    void start() { m_timer.start(); }
+    void stop() { m_totalNsecs += m_timer.nsecsElapsed(); ++m_operations; }
+    void add(const OperationTimer &other) { m_totalNsecs += other.m_totalNsecs; m_operations += other.m_operations; }
+
+    qint64 operations() const { return m_operations; }
+    qint64 totalNsecs() const { return m_totalNsecs; }
+
+private:
+    QElapsedTimer m_timer;
+    qint64 m_totalNsecs = 0;
+    qint64 m_operations = 0;
+};
+
+// Encrypts the same buffer repeatedly from a thread pool thread,
+// recording the latency of the first and of the subsequent operations.
+class ConcurrentEncryptor : public QRunnable
+{
+public:
+    ConcurrentEncryptor(Daemon::Plugins::OpenSslCryptoPlugin *plugin,
+                        const Key &key, const QByteArray &iv, const QByteArray &plaintext,
+                        QAtomicInt *failures)
+        : m_plugin(plugin), m_key(key), m_iv(iv), m_plaintext(plaintext), m_failures(failures)
+    {
+        setAutoDelete(false);
+    }
+
+    void run() Q_DECL_OVERRIDE
+    {
+        for (int i = 0; i < CONCURRENT_OPERATIONS_PER_THREAD; ++i) {
+            QByteArray encrypted;
+            QByteArray tag;
+            OperationTimer &timer(i == 0 ? firstOperation : subsequentOperations);
+            timer.start();
+            const Result result = m_plugin->encrypt(m_plaintext, m_iv, m_key, CryptoManager::BlockModeCbc,
+                                                    CryptoManager::EncryptionPaddingNone,
+                                                    QByteArray(), QVariantMap(), &encrypted, &tag);
+            timer.stop();
+            if (result.code() != Result::Succeeded) {
+                m_failures->ref();
+            }
+        }
+    }
+
+    OperationTimer firstOperation;
+    OperationTimer subsequentOperations;
+
+private:
+    Daemon::Plugins::OpenSslCryptoPlugin *m_plugin;
+    Key m_key;
+    QByteArray m_iv;
+    QByteArray m_plaintext;
+    QAtomicInt *m_failures;
+};
+
+void tst_cryptobenchmarks::initTestCase()
+{
+    qRegisterMetaType<CryptoManager::BlockMode>();
+    qRegisterMetaType<CryptoManager::DigestFunction>();
+
+    // the first request after loading the plugin includes fetching the
+    // algorithm implementations (unless the plugin has completed that in
+    // the background meanwhile), so record its latency separately.
+    OperationTimer loadTimer;
+    loadTimer.start();
+    m_plugin = new Daemon::Plugins::OpenSslCryptoPlugin(this);
+    loadTimer.stop();
+
+    const Key key = aesKey(256);
+    QVERIFY(!key.secretKey().isEmpty());
+    const QByteArray iv = initializationVector(CryptoManager::BlockModeCbc, 256);
+    const QByteArray plaintext = benchmarkData(CONCURRENT_DATA_SIZE);
+
+    OperationTimer firstRequestTimer;
+    QByteArray encrypted;
+    QByteArray tag;
+    firstRequestTimer.start();
+    const Result result = m_plugin->encrypt(plaintext, iv, key, CryptoManager::BlockModeCbc,
+                                            CryptoManager::EncryptionPaddingNone,
+                                            QByteArray(), QVariantMap(), &encrypted, &tag);
+    firstRequestTimer.stop();
+    QCOMPARE(result.code(), Result::Succeeded);
+
+    recordResult(firstRequestTimer, CONCURRENT_DATA_SIZE, QJsonObject {
+        { QStringLiteral("blockMode"), blockModeName(CryptoManager::BlockModeCbc) },
+        { QStringLiteral("keySize"), 256 },
+        { QStringLiteral("bufferSize"), CONCURRENT_DATA_SIZE },
+        { QStringLiteral("firstRequest"), true },
+        { QStringLiteral("pluginLoadNsecs"), double(loadTimer.totalNsecs()) }
+    });
+}
+
+void tst_cryptobenchmarks::cleanupTestCase()
+{
+    QJsonObject environment;
+    environment.insert(QStringLiteral("plugin"), m_plugin->name());
+    environment.insert(QStringLiteral("openssl"), QStringLiteral(OPENSSL_VERSION_TEXT));
+    environment.insert(QStringLiteral("cpuArchitecture"), QSysInfo::currentCpuArchitecture());
+    environment.insert(QStringLiteral("kernelVersion"), QSysInfo::kernelVersion());
+    environment.insert(QStringLiteral("timestamp"), QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+
+    QJsonObject document;
+    document.insert(QStringLiteral("environment"), environment);
+    document.insert(QStringLiteral("results"), m_results);
+
+    const QByteArray path = qgetenv(ENV_BENCHMARK_JSON);
+    QFile file(path.isEmpty() ? DEFAULT_BENCHMARK_JSON : QString::fromLocal8Bit(path));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Unable to write benchmark results to" << file.fileName();
+    } else {
+        file.write(QJsonDocument(document).toJson());
+        qDebug() << "Wrote benchmark results to" << file.fileName();
+    }
+
+    delete m_plugin;
+    m_plugin = Q_NULLPTR;
+}
+
+void tst_cryptobenchmarks::recordResult(const OperationTimer &timer, qint64 bytesPerOperation, const QJsonObject &parameters)
+{
+    if (timer.operations() == 0 || QTest::currentTestFailed()) {
+        return;
+    }
+
+    const double nsecsPerOperation = double(timer.totalNsecs()) / double(timer.operations());
+    QJsonObject result(parameters);
+    result.insert(QStringLiteral("benchmark"), QString::fromLatin1(QTest::currentTestFunction()));
+    result.insert(QStringLiteral("dataTag"), QString::fromLatin1(QTest::currentDataTag()));
+    result.insert(QStringLiteral("operations"), double(timer.operations()));
+    result.insert(QStringLiteral("nsecsPerOperation"), nsecsPerOperation);
+    result.insert(QStringLiteral("operationsPerSecond"), nsecsPerOperation > 0 ? 1e9 / nsecsPerOperation : 0.0);
+    if (bytesPerOperation > 0) {
+        result.insert(QStringLiteral("bytesPerOperation"), double(bytesPerOperation));
+        result.insert(QStringLiteral("bytesPerSecond"), nsecsPerOperation > 0 ? double(bytesPerOperation) * 1e9 / nsecsPerOperation : 0.0);
+    }
+    m_results.append(result);
+}
+
+Key tst_cryptobenchmarks::aesKey(int keySize)
+{
+    if (!m_aesKeys.contains(keySize)) {
+        Key keyTemplate;
+        keyTemplate.setAlgorithm(CryptoManager::AlgorithmAes);
+        keyTemplate.setSize(keySize);
+        keyTemplate.setOperations(CryptoManager::OperationEncrypt | CryptoManager::OperationDecrypt);
+        Key key;
+        const Result result = m_plugin->generateKey(keyTemplate, KeyPairGenerationParameters(),
+                                                    KeyDerivationParameters(), QVariantMap(), &key);
+        if (result.code() != Result::Succeeded) {
+            qWarning() << "Unable to generate AES key:" << result.errorMessage();
+            return Key();
+        }
+        m_aesKeys.insert(keySize, key);
+    }
+    return m_aesKeys.value(keySize);
+}
+
+Key tst_cryptobenchmarks::keyPair(const QString &keyType)
+{
+    if (!m_keyPairs.contains(keyType)) {
+        Key keyTemplate;
+        keyTemplate.setOperations(CryptoManager::OperationSign | CryptoManager::OperationVerify);
+        KeyPairGenerationParameters kpgParams;
+        if (keyType.startsWith(QLatin1String("rsa"))) {
+            RsaKeyPairGenerationParameters rsaParams;
+            rsaParams.setModulusLength(keyType.mid(3).toInt());
+            kpgParams = rsaParams;
+            keyTemplate.setAlgorithm(CryptoManager::AlgorithmRsa);
+            keyTemplate.setSize(rsaParams.modulusLength());
+        } else {
+            EcKeyPairGenerationParameters ecParams;
+            ecParams.setEllipticCurve(keyType == QLatin1String("ecSecp256r1")
+                                      ? CryptoManager::CurveSecp256r1
+                                      : keyType == QLatin1String("ecSecp384r1")
+                                      ? CryptoManager::CurveSecp384r1
+                                      : CryptoManager::CurveSecp521r1);
+            kpgParams = ecParams;
+            keyTemplate.setAlgorithm(CryptoManager::AlgorithmEc);
+        }
+
+        Key key;
+        const Result result = m_plugin->generateKey(keyTemplate, kpgParams, KeyDerivationParameters(),
+                                                    QVariantMap(), &key);
+        if (result.code() != Result::Succeeded) {
+            qWarning() << "Unable to generate" << keyType << "key pair:" << result.errorMessage();
+            return Key();
+        }
+        m_keyPairs.insert(keyType, key);
+    }
+    return m_keyPairs.value(keyType);
+}
+
+QByteArray tst_cryptobenchmarks::initializationVector(CryptoManager::BlockMode blockMode, int keySize)
+{
+    QByteArray iv;
+    const Result result = m_plugin->generateInitializationVector(CryptoManager::AlgorithmAes, blockMode,
+                                                                 keySize, QVariantMap(), &iv);
+    if (result.code() != Result::Succeeded) {
+        qWarning() << "Unable to generate initialization vector:" << result.errorMessage();
+    }
+    return iv;
+}
+
+void tst_cryptobenchmarks::addSymmetricRows(bool authenticatedOnly)
+{
+    QTest::addColumn<CryptoManager::BlockMode>("blockMode");
+    QTest::addColumn<int>("keySize");
+    QTest::addColumn<int>("bufferSize");
+
+    for (CryptoManager::BlockMode blockMode : blockModes) {
+        if (authenticatedOnly && !isAuthenticatedMode(blockMode)) {
+            continue;
+        }
+        for (int keySize : aesKeySizes) {
+            for (int bufferSize : bufferSizes) {
+                const QString tag = QStringLiteral("aes%1-%2/%3")
+                        .arg(keySize).arg(blockModeName(blockMode)).arg(bufferSize);
+                QTest::newRow(tag.toLatin1().constData()) << blockMode << keySize << bufferSize;
+            }
+        }
+    }
+}
+
+void tst_cryptobenchmarks::addKeyPairRows()
+{
+    QTest::addColumn<QString>("keyType");
+    for (const QString &keyType : keyPairTypes) {
+        QTest::newRow(keyType.toLatin1().constData()) << keyType;
+    }
+}
+
+void tst_cryptobenchmarks::encrypt_data()
+{
+    addSymmetricRows(false);
+}
+
+void tst_cryptobenchmarks::encrypt()
+{
+    QFETCH(CryptoManager::BlockMode, blockMode);
+    QFETCH(int, keySize);
+    QFETCH(int, bufferSize);
+
+    const Key key = aesKey(keySize);
+    QVERIFY(!key.secretKey().isEmpty());
+    const QByteArray iv = initializationVector(blockMode, keySize);
+    const QByteArray plaintext = benchmarkData(bufferSize);
+
+    OperationTimer timer;
+    QBENCHMARK {
+        QByteArray encrypted;
+        QByteArray tag;
+        timer.start();
+        const Result result = m_plugin->encrypt(plaintext, iv, key, blockMode,
+                                                CryptoManager::EncryptionPaddingNone,
+                                                QByteArray(), QVariantMap(), &encrypted, &tag);
+        timer.stop();
+        QCOMPARE(result.code(), Result::Succeeded);
+    }
+
+    recordResult(timer, bufferSize, QJsonObject {
+        { QStringLiteral("blockMode"), blockModeName(blockMode) },
+        { QStringLiteral("keySize"), keySize },
+        { QStringLiteral("bufferSize"), bufferSize }
+    });
+}
+
+void tst_cryptobenchmarks::authenticatedEncrypt_data()
+{
+    addSymmetricRows(true);
+}
+
+void tst_cryptobenchmarks::authenticatedEncrypt()
+{
+    QFETCH(CryptoManager::BlockMode, blockMode);
+    QFETCH(int, keySize);
+    QFETCH(int, bufferSize);
+
+    const Key key = aesKey(keySize);
+    QVERIFY(!key.secretKey().isEmpty());
+    const QByteArray iv = initializationVector(blockMode, keySize);
+    const QByteArray plaintext = benchmarkData(bufferSize);
+    const QByteArray authenticationData = benchmarkData(AUTHENTICATION_DATA_SIZE);
+
+    OperationTimer timer;
+    QBENCHMARK {
+        QByteArray encrypted;
+        QByteArray tag;
+        timer.start();
+        const Result result = m_plugin->encrypt(plaintext, iv, key, blockMode,
+                                                CryptoManager::EncryptionPaddingNone,
+                                                authenticationData, QVariantMap(), &encrypted, &tag);
+        timer.stop();
+        QCOMPARE(result.code(), Result::Succeeded);
+    }
+
+    recordResult(timer, bufferSize, QJsonObject {
+        { QStringLiteral("blockMode"), blockModeName(blockMode) },
+        { QStringLiteral("keySize"), keySize },
+        { QStringLiteral("bufferSize"), bufferSize },
+        { QStringLiteral("authenticationDataSize"), AUTHENTICATION_DATA_SIZE }
+    });
+}
+
+void tst_cryptobenchmarks::decrypt_data()
+{
+    addSymmetricRows(false);
+}
+
+void tst_cryptobenchmarks::decrypt()
+{
+    QFETCH(CryptoManager::BlockMode, blockMode);
+    QFETCH(int, keySize);
+    QFETCH(int, bufferSize);
+
+    const Key key = aesKey(keySize);
+    QVERIFY(!key.secretKey().isEmpty());
+    const QByteArray iv = initializationVector(blockMode, keySize);
+    const QByteArray authenticationData = isAuthenticatedMode(blockMode)
+            ? benchmarkData(AUTHENTICATION_DATA_SIZE)
+            : QByteArray();
+
+    QByteArray ciphertext;
+    QByteArray tag;
+    Result result = m_plugin->encrypt(benchmarkData(bufferSize), iv, key, blockMode,
+                                      CryptoManager::EncryptionPaddingNone,
+                                      authenticationData, QVariantMap(), &ciphertext, &tag);
+    QCOMPARE(result.code(), Result::Succeeded);
+
+    OperationTimer timer;
+    QBENCHMARK {
+        QByteArray decrypted;
+        CryptoManager::VerificationStatus status = CryptoManager::VerificationStatusUnknown;
+        timer.start();
+        result = m_plugin->decrypt(ciphertext, iv, key, blockMode,
+                                   CryptoManager::EncryptionPaddingNone,
+                                   authenticationData, tag, QVariantMap(), &decrypted, &status);
+        timer.stop();
+        QCOMPARE(result.code(), Result::Succeeded);
+    }
+
+    recordResult(timer, bufferSize, QJsonObject {
+        { QStringLiteral("blockMode"), blockModeName(blockMode) },
+        { QStringLiteral("keySize"), keySize },
+        { QStringLiteral("bufferSize"), bufferSize },
+        { QStringLiteral("authenticationDataSize"), authenticationData.size() }
+    });
+}
+
+void tst_cryptobenchmarks::sign_data()
+{
+    addKeyPairRows();
+}
+
+void tst_cryptobenchmarks::sign()
+{
+    QFETCH(QString, keyType);
+
+    const Key key = keyPair(keyType);
+    QVERIFY(!key.privateKey().isEmpty());
+    const QByteArray data = benchmarkData(SIGNED_DATA_SIZE);
+
+    OperationTimer timer;
+    QBENCHMARK {
+        QByteArray signature;
+        timer.start();
+        const Result result = m_plugin->sign(data, key, CryptoManager::SignaturePaddingNone,
+                                             CryptoManager::DigestSha256, QVariantMap(), &signature);
+        timer.stop();
+        QCOMPARE(result.code(), Result::Succeeded);
+    }
+
+    recordResult(timer, 0, QJsonObject {
+        { QStringLiteral("keyType"), keyType },
+        { QStringLiteral("digest"), digestName(CryptoManager::DigestSha256) },
+        { QStringLiteral("dataSize"), SIGNED_DATA_SIZE }
+    });
+}
+
+void tst_cryptobenchmarks::verify_data()
+{
+    addKeyPairRows();
+}
+
+void tst_cryptobenchmarks::verify()
+{
+    QFETCH(QString, keyType);
+
+    const Key key = keyPair(keyType);
+    QVERIFY(!key.privateKey().isEmpty());
+    const QByteArray data = benchmarkData(SIGNED_DATA_SIZE);
+
+    QByteArray signature;
+    Result result = m_plugin->sign(data, key, CryptoManager::SignaturePaddingNone,
+                                   CryptoManager::DigestSha256, QVariantMap(), &signature);
+    QCOMPARE(result.code(), Result::Succeeded);
+
+    OperationTimer timer;
+    QBENCHMARK {
+        CryptoManager::VerificationStatus status = CryptoManager::VerificationStatusUnknown;
+        timer.start();
+        result = m_plugin->verify(signature, data, key, CryptoManager::SignaturePaddingNone,
+                                  CryptoManager::DigestSha256, QVariantMap(), &status);
+        timer.stop();
+        QCOMPARE(result.code(), Result::Succeeded);
+        QCOMPARE(status, CryptoManager::VerificationSucceeded);
+    }
+
+    recordResult(timer, 0, QJsonObject {
+        { QStringLiteral("keyType"), keyType },
+        { QStringLiteral("digest"), digestName(CryptoManager::DigestSha256) },
+        { QStringLiteral("dataSize"), SIGNED_DATA_SIZE }
+    });
+}
+
+void tst_cryptobenchmarks::pbkdf2_data()
+{
+    QTest::addColumn<CryptoManager::DigestFunction>("digest");
+    QTest::addColumn<int>("iterations");
+
+    for (CryptoManager::DigestFunction digest : pbkdf2Digests) {
+        for (int iterations : pbkdf2Iterations) {
+            const QString tag = QStringLiteral("%1/%2").arg(digestName(digest)).arg(iterations);
+            QTest::newRow(tag.toLatin1().constData()) << digest << iterations;
+        }
+    }
+}
+
+void tst_cryptobenchmarks::pbkdf2()
+{
+    QFETCH(CryptoManager::DigestFunction, digest);
+    QFETCH(int, iterations);
+
+    Key keyTemplate;
+    keyTemplate.setAlgorithm(CryptoManager::AlgorithmAes);
+    keyTemplate.setOperations(CryptoManager::OperationEncrypt | CryptoManager::OperationDecrypt);
+
+    KeyDerivationParameters skdfParams;
+    skdfParams.setInputData(QByteArray("benchmark passphrase"));
+    skdfParams.setSalt(benchmarkData(16));
+    skdfParams.setKeyDerivationFunction(CryptoManager::KdfPkcs5Pbkdf2);
+    skdfParams.setKeyDerivationMac(CryptoManager::MacHmac);
+    skdfParams.setKeyDerivationDigestFunction(digest);
+    skdfParams.setIterations(iterations);
+    skdfParams.setOutputKeySize(256);
+
+    OperationTimer timer;
+    QBENCHMARK {
+        Key key;
+        timer.start();
+        const Result result = m_plugin->generateKey(keyTemplate, KeyPairGenerationParameters(),
+                                                    skdfParams, QVariantMap(), &key);
+        timer.stop();
+        QCOMPARE(result.code(), Result::Succeeded);
+    }
+
+    QJsonObject parameters {
+        { QStringLiteral("digest"), digestName(digest) },
+        { QStringLiteral("iterations"), iterations },
+        { QStringLiteral("outputKeySize"), 256 }
+    };
+    if (timer.operations() > 0) {
+        parameters.insert(QStringLiteral("nsecsPerIteration"),
+                          double(timer.totalNsecs()) / double(timer.operations()) / double(iterations));
+    }
+    recordResult(timer, 0, parameters);
+}
+
+void tst_cryptobenchmarks::cipherSessionUpdate_data()
+{
+    QTest::addColumn<CryptoManager::BlockMode>("blockMode");
+    QTest::addColumn<int>("chunkSize");
+
+    for (CryptoManager::BlockMode blockMode : sessionBlockModes) {
+        for (int chunkSize : chunkSizes) {
+            const QString tag = QStringLiteral("aes256-%1/%2").arg(blockModeName(blockMode)).arg(chunkSize);
+            QTest::newRow(tag.toLatin1().constData()) << blockMode << chunkSize;
+        }
+    }
+}
+
+void tst_cryptobenchmarks::cipherSessionUpdate()
+{
+    QFETCH(CryptoManager::BlockMode, blockMode);
+    QFETCH(int, chunkSize);
+
+    const quint64 clientId = 1;
+    const Key key = aesKey(256);
+    QVERIFY(!key.secretKey().isEmpty());
+    const QByteArray iv = initializationVector(blockMode, 256);
+    const QByteArray chunk = benchmarkData(chunkSize);
+
+    quint32 token = 0;
+    Result result = m_plugin->initializeCipherSession(clientId, iv, key, CryptoManager::OperationEncrypt,
+                                                      blockMode, CryptoManager::EncryptionPaddingNone,
+                                                      CryptoManager::SignaturePaddingNone,
+                                                      CryptoManager::DigestUnknown,
+                                                      QVariantMap(), &token);
+    QCOMPARE(result.code(), Result::Succeeded);
+
+    OperationTimer timer;
+    QBENCHMARK {
+        QByteArray generated;
+        timer.start();
+        result = m_plugin->updateCipherSession(clientId, chunk, QVariantMap(), token, &generated);
+        timer.stop();
+        QCOMPARE(result.code(), Result::Succeeded);
+    }
+
+    QByteArray generated;
+    CryptoManager::VerificationStatus status = CryptoManager::VerificationStatusUnknown;
+    result = m_plugin->finalizeCipherSession(clientId, QByteArray(), QVariantMap(), token, &generated, &status);
+    QCOMPARE(result.code(), Result::Succeeded);
+
+    recordResult(timer, chunkSize, QJsonObject {
+        { QStringLiteral("blockMode"), blockModeName(blockMode) },
+        { QStringLiteral("keySize"), 256 },
+        { QStringLiteral("chunkSize"), chunkSize }
+    });
+}
+
+void tst_cryptobenchmarks::concurrentEncrypt_data()
+{
+    QTest::addColumn<int>("threadCount");
+
+    for (int threadCount : threadCounts) {
+        const QString tag = QStringLiteral("aes256-cbc/%1/threads%2").arg(CONCURRENT_DATA_SIZE).arg(threadCount);
+        QTest::newRow(tag.toLatin1().constData()) << threadCount;
+    }
+}
+
+void tst_cryptobenchmarks::concurrentEncrypt()
+{
+    QFETCH(int, threadCount);
+
+    const Key key = aesKey(256);
+    QVERIFY(!key.secretKey().isEmpty());
+    const QByteArray iv = initializationVector(CryptoManager::BlockModeCbc, 256);
+    const QByteArray plaintext = benchmarkData(CONCURRENT_DATA_SIZE);
+
+    QAtomicInt failures;
+    QVector<ConcurrentEncryptor*> encryptors;
+    for (int i = 0; i < threadCount; ++i) {
+        encryptors.append(new ConcurrentEncryptor(m_plugin, key, iv, plaintext, &failures));
+    }
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(threadCount);
+    QElapsedTimer wallTimer;
+    wallTimer.start();
+    for (ConcurrentEncryptor *encryptor : encryptors) {
+        pool.start(encryptor);
+    }
+    pool.waitForDone();
+    const qint64 wallNsecs = wallTimer.nsecsElapsed();
+
+    // steady-state latency is averaged over all threads, while the
+    // first-operation latency reported is that of the slowest thread.
+    OperationTimer timer;
+    qint64 firstOperationNsecs = 0;
+    qint64 totalOperations = 0;
+    for (ConcurrentEncryptor *encryptor : encryptors) {
+        timer.add(encryptor->subsequentOperations);
+        firstOperationNsecs = qMax(firstOperationNsecs, encryptor->firstOperation.totalNsecs());
+        totalOperations += encryptor->firstOperation.operations() + encryptor->subsequentOperations.operations();
+    }
+    qDeleteAll(encryptors);
+    QCOMPARE(failures.load(), 0);
+
+    recordResult(timer, CONCURRENT_DATA_SIZE, QJsonObject {
+        { QStringLiteral("blockMode"), blockModeName(CryptoManager::BlockModeCbc) },
+        { QStringLiteral("keySize"), 256 },
+        { QStringLiteral("bufferSize"), CONCURRENT_DATA_SIZE },
+        { QStringLiteral("threads"), threadCount },
+        { QStringLiteral("firstOperationNsecs"), double(firstOperationNsecs) },
+        { QStringLiteral("aggregateOperationsPerSecond"),
+          wallNsecs > 0 ? double(totalOperations) * 1e9 / double(wallNsecs) : 0.0 }
+    });
+}
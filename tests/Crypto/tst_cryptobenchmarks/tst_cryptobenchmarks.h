@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2018 Jolla Ltd.
+ * Contact: Chris Adams <chris.adams@jollamobile.com>
+ * All rights reserved.
+ * BSD 3-Clause License, see LICENSE.
+ */
+
+#include <QtTest>
+#include <QtCore/QObject>
+#include <QtCore/QString>
+#include <QtCore/QByteArray>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonObject>
+#include <QtCore/QMap>
+
+#include "Crypto/key.h"
+
+namespace Sailfish { namespace Crypto { namespace Daemon { namespace Plugins {
+    class OpenSslCryptoPlugin;
+} } } }
+
+class OperationTimer;
+
+// Benchmarks the cryptographic primitives of the OpenSSL crypto plugin,
+// by compiling the plugin into the benchmark and calling it directly,
+// without involving the secrets daemon.
+//
+// Covers symmetric encryption (per block mode, key size and buffer size,
+// with and without authentication data for the authenticated modes),
+// signing and verification (per key type), PBKDF2 key derivation (per
+// iteration count and digest) and cipher session updates (per chunk size).
+// The latency of the first request after the plugin has been loaded, and
+// of requests performed concurrently by several worker threads (as the
+// daemon's crypto thread pool does), are recorded too.
+//
+// In addition to the standard QtTest benchmark output, the results are
+// written as a JSON document to the file named by
+// SAILFISH_CRYPTO_BENCHMARK_JSON (or to a default location in /tmp),
+// so that they can be compared between runs, devices and OpenSSL versions.
+class tst_cryptobenchmarks : public QObject
+{
+    Q_OBJECT
+
+public slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+private slots:
+    void encrypt_data();
+    void encrypt();
+    void authenticatedEncrypt_data();
+    void authenticatedEncrypt();
+    void decrypt_data();
+    void decrypt();
+    void sign_data();
+    void sign();
+    void verify_data();
+    void verify();
+    void pbkdf2_data();
+    void pbkdf2();
+    void cipherSessionUpdate_data();
+    void cipherSessionUpdate();
+    void concurrentEncrypt_data();
+    void concurrentEncrypt();
+
+private:
+    void addSymmetricRows(bool authenticatedOnly);
+    void addKeyPairRows();
+    Sailfish::Crypto::Key aesKey(int keySize);
+    Sailfish::Crypto::Key keyPair(const QString &keyType);
+    QByteArray initializationVector(Sailfish::Crypto::CryptoManager::BlockMode blockMode, int keySize);
+    void recordResult(const OperationTimer &timer, qint64 bytesPerOperation, const QJsonObject &parameters);
+
+    Sailfish::Crypto::Daemon::Plugins::OpenSslCryptoPlugin *m_plugin = Q_NULLPTR;
+    QMap<int, Sailfish::Crypto::Key> m_aesKeys;
+    QMap<QString, Sailfish::Crypto::Key> m_keyPairs;
+    QJsonArray m_results;
+};
@@ -0,0 +1,31 @@
+TEMPLATE = app
+TARGET = tst_cryptobenchmarks
+target.path = /opt/tests/Sailfish/Crypto/
+
+QT += testlib
+CONFIG += link_pkgconfig
+PKGCONFIG += libcrypto
+
+include($$PWD/../../../lib/libsailfishcryptopluginapi.pri)
+include($$PWD/../../../lib/libsailfishcryptoevp.pri)
+
+# The plugin is compiled directly into the benchmark, so that the primitives
+# are measured without any daemon or IPC overhead.
+DEFINES += SAILFISHCRYPTO_TESTPLUGIN
+
+INCLUDEPATH += \
+    $$PWD/../../../plugins/opensslcryptoplugin/ \
+    $$PWD/../../../plugins/opensslcryptoplugin/evp/
+DEPENDPATH += \
+    $$PWD/../../../plugins/opensslcryptoplugin/ \
+    $$PWD/../../../plugins/opensslcryptoplugin/evp/
+
+HEADERS += \
+    $$PWD/../../../plugins/opensslcryptoplugin/opensslcryptoplugin.h \
+    $$PWD/tst_cryptobenchmarks.h
+
+SOURCES += \
+    $$PWD/../../../plugins/opensslcryptoplugin/opensslcryptoplugin.cpp \
+    $$PWD/tst_cryptobenchmarks.cpp
+
+INSTALLS += target
@@ -25,6 +25,7 @@
 #include "Crypto/generatestoredkeyrequest.h"
 #include "Crypto/importkeyrequest.h"
 #include "Crypto/importstoredkeyrequest.h"
+#include "Crypto/keysessionrequest.h"
 #include "Crypto/lockcoderequest.h"
 #include "Crypto/plugininforequest.h"
 #include "Crypto/seedrandomdatageneratorrequest.h"
@@ -156,6 +157,9 @@ private slots:
     void importKey();
     void importKeyAndStore_data();
     void importKeyAndStore();
+    void keySession();
+    void keySessionAccessRelock();
+    void inProcessExecution();
     void exampleUsbTokenPlugin();
 };
 
@@ -3286,6 +3290,265 @@ void tst_cryptorequests::importKeyAndStore()
     }
 }
 
+void tst_cryptorequests::keySession()
+{
+    TestPluginMap plugins;
+    plugins.insert(CryptoTest::CryptoPlugin, DEFAULT_TEST_CRYPTO_STORAGE_PLUGIN_NAME);
+    plugins.insert(CryptoTest::StoragePlugin, DEFAULT_TEST_CRYPTO_STORAGE_PLUGIN_NAME);
+    plugins.insert(CryptoTest::EncryptionPlugin, DEFAULT_TEST_CRYPTO_STORAGE_PLUGIN_NAME);
+
+    Key keyTemplate = createTestKey(0, CryptoManager::AlgorithmRsa, Key::OriginDevice,
+                                    CryptoManager::OperationEncrypt
+                                    | CryptoManager::OperationSign
+                                    | CryptoManager::OperationVerify);
+    keyTemplate.setComponentConstraints(Key::MetaData | Key::PublicKeyData | Key::PrivateKeyData);
+    keyTemplate.setIdentifier(Key::Identifier(
+                                  QLatin1String("sessionkey"),
+                                  QLatin1String("tstcryptosecretskeysession"),
+                                  plugins.value(CryptoTest::StoragePlugin)));
+
+    RsaKeyPairGenerationParameters rsakpg;
+    rsakpg.setModulusLength(2048);
+    rsakpg.setPublicExponent(65537);
+    rsakpg.setNumberPrimes(2);
+
+    // create the collection and a stored key pair within it.
+    QScopedPointer<Sailfish::Secrets::CreateCollectionRequest> ccr(
+            newCreateCollectionRequestWithDeviceLock(keyTemplate.identifier().collectionName(), plugins));
+    ccr->startRequest();
+    WAIT_FOR_REQUEST_SUCCEEDED((*ccr));
+
+    GenerateStoredKeyRequest gskr;
+    gskr.setManager(&m_cm);
+    gskr.setKeyTemplate(keyTemplate);
+    gskr.setKeyPairGenerationParameters(rsakpg);
+    gskr.setCryptoPluginName(plugins.value(CryptoTest::CryptoPlugin));
+    gskr.startRequest();
+    WAIT_FOR_REQUEST_SUCCEEDED(gskr);
+    const Key keyReference = gskr.generatedKeyReference();
+
+    // open a key session which permits signing and verifying.
+    KeySessionRequest ksr;
+    ksr.setManager(&m_cm);
+    QSignalSpy ksrss(&ksr, &KeySessionRequest::statusChanged);
+    QSignalSpy ksrts(&ksr, &KeySessionRequest::keySessionTokenChanged);
+    ksr.setKeySessionRequestType(KeySessionRequest::OpenKeySession);
+    QCOMPARE(ksr.keySessionRequestType(), KeySessionRequest::OpenKeySession);
+    ksr.setKey(keyReference);
+    QCOMPARE(ksr.key(), keyReference);
+    ksr.setOperations(CryptoManager::OperationSign | CryptoManager::OperationVerify);
+    QCOMPARE(ksr.operations(), CryptoManager::OperationSign | CryptoManager::OperationVerify);
+    ksr.setCryptoPluginName(plugins.value(CryptoTest::CryptoPlugin));
+    QCOMPARE(ksr.cryptoPluginName(), plugins.value(CryptoTest::CryptoPlugin));
+    QCOMPARE(ksr.keySessionToken(), quint32(0));
+    START_AND_WAIT_FOR_REQUEST(ksr, ksrss, Result::Succeeded, Result::NoError, 10 * 1000);
+    QCOMPARE(ksrts.count(), 1);
+    const quint32 token = ksr.keySessionToken();
+    QVERIFY(token != 0);
+
+    QVariantMap sessionParameters;
+    sessionParameters.insert(KeySessionRequest::keySessionParameterName(), token);
+
+    // sign and verify by citing the session, without giving the key identifier.
+    const QByteArray dataToSign = QByteArrayLiteral("Data signed with a key resolved by a key session");
+    SignRequest sr;
+    sr.setManager(&m_cm);
+    sr.setCustomParameters(sessionParameters);
+    sr.setData(dataToSign);
+    sr.setDigestFunction(CryptoManager::DigestSha256);
+    sr.setPadding(CryptoManager::SignaturePaddingNone);
+    sr.setCryptoPluginName(plugins.value(CryptoTest::CryptoPlugin));
+    sr.startRequest();
+    WAIT_FOR_REQUEST_SUCCEEDED(sr);
+    const QByteArray signature = sr.signature();
+    QVERIFY(!signature.isEmpty());
+
+    VerifyRequest vr;
+    vr.setManager(&m_cm);
+    vr.setCustomParameters(sessionParameters);
+    vr.setData(dataToSign);
+    vr.setSignature(signature);
+    vr.setDigestFunction(CryptoManager::DigestSha256);
+    vr.setPadding(CryptoManager::SignaturePaddingNone);
+    vr.setKey(keyReference);
+    vr.setCryptoPluginName(plugins.value(CryptoTest::CryptoPlugin));
+    vr.startRequest();
+    WAIT_FOR_REQUEST_SUCCEEDED(vr);
+    QCOMPARE(vr.verificationStatus(), CryptoManager::VerificationSucceeded);
+
+    // the session doesn't permit encryption, even though the key does.
+    EncryptRequest er;
+    er.setManager(&m_cm);
+    er.setCustomParameters(sessionParameters);
+    er.setData(dataToSign);
+    er.setBlockMode(CryptoManager::BlockModeUnknown);
+    er.setPadding(CryptoManager::EncryptionPaddingNone);
+    er.setKey(keyReference);
+    er.setCryptoPluginName(plugins.value(CryptoTest::CryptoPlugin));
+    er.startRequest();
+    WAIT_FOR_REQUEST_FAILED(er, Result::OperationNotSupportedError);
+
+    // close the session, after which citing it is an error.
+    ksr.setKeySessionRequestType(KeySessionRequest::CloseKeySession);
+    START_AND_WAIT_FOR_REQUEST(ksr, ksrss, Result::Succeeded, Result::NoError, 10 * 1000);
+    QCOMPARE(ksr.keySessionToken(), quint32(0));
+
+    sr.startRequest();
+    WAIT_FOR_REQUEST_FAILED(sr, Result::InvalidKeySessionToken);
+
+    // closing an already closed session is also an error.
+    ksr.startRequest();
+    WAIT_FOR_REQUEST_FAILED(ksr, Result::InvalidKeySessionToken);
+}
+
+void tst_cryptorequests::keySessionAccessRelock()
+{
+    TestPluginMap plugins;
+    plugins.insert(CryptoTest::CryptoPlugin, DEFAULT_TEST_CRYPTO_STORAGE_PLUGIN_NAME);
+    plugins.insert(CryptoTest::StoragePlugin, DEFAULT_TEST_CRYPTO_STORAGE_PLUGIN_NAME);
+    plugins.insert(CryptoTest::EncryptionPlugin, DEFAULT_TEST_CRYPTO_STORAGE_PLUGIN_NAME);
+    plugins.insert(CryptoTest::AuthenticationPlugin, PASSWORD_AGENT_TEST_AUTH_PLUGIN);
+
+    Key keyTemplate = createTestKey(256, CryptoManager::AlgorithmAes, Key::OriginDevice,
+                                    CryptoManager::OperationEncrypt | CryptoManager::OperationDecrypt,
+                                    Key::Identifier(QLatin1String("relocksessionkey"),
+                                                    QLatin1String("tstcryptosecretskeysessionrelock"),
+                                                    plugins.value(CryptoTest::StoragePlugin)));
+    keyTemplate.setComponentConstraints(Key::MetaData | Key::PublicKeyData | Key::PrivateKeyData);
+
+    // the collection is locked again after every access.
+    QScopedPointer<Sailfish::Secrets::CreateCollectionRequest> ccr(
+            newCreateCollectionRequestWithCustomLock(keyTemplate.identifier().collectionName(), plugins, true,
+                                                     Sailfish::Secrets::SecretManager::CustomLockAccessRelock));
+    ccr->startRequest();
+    WAIT_FOR_REQUEST_SUCCEEDED((*ccr));
+
+    GenerateStoredKeyRequest gskr;
+    gskr.setManager(&m_cm);
+    gskr.setKeyTemplate(keyTemplate);
+    gskr.setCryptoPluginName(plugins.value(CryptoTest::CryptoPlugin));
+    gskr.startRequest();
+    WAIT_FOR_REQUEST_SUCCEEDED(gskr);
+
+    // a key session would retain the collection key past the access,
+    // so it cannot be opened.
+    KeySessionRequest ksr;
+    ksr.setManager(&m_cm);
+    ksr.setKeySessionRequestType(KeySessionRequest::OpenKeySession);
+    ksr.setKey(gskr.generatedKeyReference());
+    ksr.setOperations(CryptoManager::OperationEncrypt);
+    ksr.setCryptoPluginName(plugins.value(CryptoTest::CryptoPlugin));
+    ksr.startRequest();
+    WAIT_FOR_REQUEST_FAILED(ksr, Result::OperationNotSupportedError);
+    QCOMPARE(ksr.keySessionToken(), quint32(0));
+}
+
+void tst_cryptorequests::inProcessExecution()
+{
+    // requests on caller-supplied data performed in-process
+    // must produce the same results as the daemon's plugin.
+    const QString opensslPluginName = QStringLiteral("org.sailfishos.crypto.plugin.crypto.openssl.test");
+    CryptoManager inProcessManager;
+    QVERIFY(!inProcessManager.inProcessExecutionEnabled());
+    inProcessManager.setInProcessExecutionEnabled(true);
+    QVERIFY(inProcessManager.inProcessExecutionEnabled());
+
+    Key keyTemplate = createTestKey(256, CryptoManager::AlgorithmAes, Key::OriginDevice,
+                                    CryptoManager::OperationEncrypt | CryptoManager::OperationDecrypt);
+    GenerateKeyRequest gkr;
+    gkr.setManager(&m_cm);
+    gkr.setKeyTemplate(keyTemplate);
+    gkr.setCryptoPluginName(opensslPluginName);
+    gkr.startRequest();
+    WAIT_FOR_REQUEST_SUCCEEDED(gkr);
+    const Key fullKey = gkr.generatedKey();
+    QVERIFY(!fullKey.secretKey().isEmpty());
+
+    const QByteArray plaintext = QByteArrayLiteral("Test plaintext data");
+    const QByteArray initVector = QByteArrayLiteral("0123456789abcdef");
+
+    // digest
+    CalculateDigestRequest cdr;
+    cdr.setManager(&m_cm);
+    cdr.setData(plaintext);
+    cdr.setPadding(CryptoManager::SignaturePaddingNone);
+    cdr.setDigestFunction(CryptoManager::DigestSha256);
+    cdr.setCryptoPluginName(opensslPluginName);
+    cdr.startRequest();
+    WAIT_FOR_REQUEST_SUCCEEDED(cdr);
+
+    CalculateDigestRequest ipcdr;
+    ipcdr.setManager(&inProcessManager);
+    ipcdr.setData(plaintext);
+    ipcdr.setPadding(CryptoManager::SignaturePaddingNone);
+    ipcdr.setDigestFunction(CryptoManager::DigestSha256);
+    ipcdr.setCryptoPluginName(opensslPluginName);
+    QSignalSpy ipcdrStatusSpy(&ipcdr, &CalculateDigestRequest::statusChanged);
+    ipcdr.startRequest();
+    // completion is reported from the event loop, as for a daemon round trip.
+    QCOMPARE(ipcdrStatusSpy.count(), 1);
+    QCOMPARE(ipcdr.status(), Request::Active);
+    QTRY_COMPARE(ipcdrStatusSpy.count(), 2);
+    QCOMPARE(ipcdr.status(), Request::Finished);
+    QCOMPARE(ipcdr.result().code(), Result::Succeeded);
+    QCOMPARE(ipcdr.digest(), cdr.digest());
+
+    // failures are reported identically
+    cdr.setData(QByteArray());
+    cdr.startRequest();
+    WAIT_FOR_REQUEST_FAILED(cdr, Result::EmptyDataError);
+    ipcdr.setData(QByteArray());
+    ipcdr.startRequest();
+    ipcdr.waitForFinished();
+    QCOMPARE(ipcdr.status(), Request::Finished);
+    QCOMPARE(ipcdr.result().code(), cdr.result().code());
+    QCOMPARE(ipcdr.result().errorCode(), cdr.result().errorCode());
+    QCOMPARE(ipcdr.result().errorMessage(), cdr.result().errorMessage());
+
+    // encrypt
+    EncryptRequest er;
+    er.setManager(&m_cm);
+    er.setData(plaintext);
+    er.setInitializationVector(initVector);
+    er.setKey(fullKey);
+    er.setBlockMode(CryptoManager::BlockModeCbc);
+    er.setPadding(CryptoManager::EncryptionPaddingNone);
+    er.setCryptoPluginName(opensslPluginName);
+    er.startRequest();
+    WAIT_FOR_REQUEST_SUCCEEDED(er);
+
+    EncryptRequest iper;
+    iper.setManager(&inProcessManager);
+    iper.setData(plaintext);
+    iper.setInitializationVector(initVector);
+    iper.setKey(fullKey);
+    iper.setBlockMode(CryptoManager::BlockModeCbc);
+    iper.setPadding(CryptoManager::EncryptionPaddingNone);
+    iper.setCryptoPluginName(opensslPluginName);
+    iper.startRequest();
+    WAIT_FOR_REQUEST_SUCCEEDED(iper);
+    QCOMPARE(iper.ciphertext(), er.ciphertext());
+
+    // decrypt
+    DecryptRequest ipdr;
+    ipdr.setManager(&inProcessManager);
+    ipdr.setData(er.ciphertext());
+    ipdr.setInitializationVector(initVector);
+    ipdr.setKey(fullKey);
+    ipdr.setBlockMode(CryptoManager::BlockModeCbc);
+    ipdr.setPadding(CryptoManager::EncryptionPaddingNone);
+    ipdr.setCryptoPluginName(opensslPluginName);
+    ipdr.startRequest();
+    WAIT_FOR_REQUEST_SUCCEEDED(ipdr);
+    QCOMPARE(ipdr.plaintext(), plaintext);
+
+    // requests which name another plugin are still performed by the daemon.
+    ipdr.setCryptoPluginName(DEFAULT_TEST_CRYPTO_PLUGIN_NAME);
+    ipdr.startRequest();
+    WAIT_FOR_REQUEST_SUCCEEDED(ipdr);
+    QCOMPARE(ipdr.plaintext(), plaintext);
+}
+
 void tst_cryptorequests::exampleUsbTokenPlugin()
 {
     // first, ensure that it is loaded by the secrets service.
@@ -171,6 +171,7 @@ void tst_cryptosecrets::secretsStoredKey()
                 keyTemplate.identifier().storagePluginName(),
                 filter,
                 Sailfish::Secrets::SecretManager::OperatorAnd,
+                Sailfish::Secrets::SecretManager::MatchExact,
                 Sailfish::Secrets::SecretManager::PreventInteraction);
     filterReply.waitForFinished();
     QVERIFY(filterReply.isValid());
@@ -186,6 +187,7 @@ void tst_cryptosecrets::secretsStoredKey()
                 keyTemplate.identifier().storagePluginName(),
                 filter,
                 Sailfish::Secrets::SecretManager::OperatorAnd,
+                Sailfish::Secrets::SecretManager::MatchExact,
                 Sailfish::Secrets::SecretManager::PreventInteraction);
     filterReply.waitForFinished();
     QVERIFY(filterReply.isValid());
@@ -382,6 +384,7 @@ void tst_cryptosecrets::cryptoStoredKey()
                 keyTemplate.identifier().storagePluginName(),
                 filter,
                 Sailfish::Secrets::SecretManager::OperatorAnd,
+                Sailfish::Secrets::SecretManager::MatchExact,
                 Sailfish::Secrets::SecretManager::PreventInteraction);
     filterReply.waitForFinished();
     QVERIFY(filterReply.isValid());
@@ -397,6 +400,7 @@ void tst_cryptosecrets::cryptoStoredKey()
                 keyTemplate.identifier().storagePluginName(),
                 filter,
                 Sailfish::Secrets::SecretManager::OperatorAnd,
+                Sailfish::Secrets::SecretManager::MatchExact,
                 Sailfish::Secrets::SecretManager::PreventInteraction);
     filterReply.waitForFinished();
     QVERIFY(filterReply.isValid());
@@ -618,6 +622,7 @@ void tst_cryptosecrets::cryptoStoredKey()
                 keyTemplate.identifier().storagePluginName(),
                 filter,
                 Sailfish::Secrets::SecretManager::OperatorAnd,
+                Sailfish::Secrets::SecretManager::MatchExact,
                 Sailfish::Secrets::SecretManager::PreventInteraction);
     filterReply.waitForFinished();
     QVERIFY(filterReply.isValid());
@@ -633,6 +638,7 @@ void tst_cryptosecrets::cryptoStoredKey()
                 keyTemplate.identifier().storagePluginName(),
                 filter,
                 Sailfish::Secrets::SecretManager::OperatorAnd,
+                Sailfish::Secrets::SecretManager::MatchExact,
                 Sailfish::Secrets::SecretManager::PreventInteraction);
     filterReply.waitForFinished();
     QVERIFY(filterReply.isValid());
@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) 2018 Jolla Ltd.
+ * Contact: Chris Adams <chris.adams@jollamobile.com>
+ * All rights reserved.
+ * BSD 3-Clause License, see LICENSE.
+ */
+
+#include <QtTest>
+#include <QObject>
+#include <QDBusConnection>
+#include <QDBusContext>
+#include <QDBusMessage>
+#include <QDBusMetaType>
+#include <QDBusPendingCall>
+#include <QDBusServer>
+
+#include "Crypto/key.h"
+#include "Crypto/serialization_p.h"
+
+using namespace Sailfish::Crypto;
+
+#define CLIENT_CONNECTION_NAME QStringLiteral("tst_cryptoserialization-client")
+#define RECEIVER_PATH QStringLiteral("/receiver")
+
+typedef QVector<Key::Identifier> IdentifierVector;
+typedef QVector<KeyIdentifierGroup> IdentifierGroupVector;
+
+// Receives the marshalled identifiers on the server side of a
+// peer-to-peer connection, both as identifiers and as the runs
+// of identifiers sharing a storage plugin and collection.
+class Receiver : public QObject, protected QDBusContext
+{
+    Q_OBJECT
+
+public:
+    IdentifierVector identifiers;
+    IdentifierGroupVector groups;
+    QString signature;
+
+public slots:
+    void receiveIdentifiers(const QVector<Sailfish::Crypto::Key::Identifier> &identifiers)
+    {
+        this->identifiers = identifiers;
+        signature = message().signature();
+    }
+
+    void receiveGroups(const QVector<Sailfish::Crypto::KeyIdentifierGroup> &groups)
+    {
+        this->groups = groups;
+        signature = message().signature();
+    }
+};
+
+class tst_cryptoserialization : public QObject
+{
+    Q_OBJECT
+
+public slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+private slots:
+    void signature();
+    void roundTrip_data();
+    void roundTrip();
+
+private:
+    bool send(const QString &method, const IdentifierVector &identifiers);
+
+    QDBusServer *m_server = Q_NULLPTR;
+    QList<QDBusConnection> m_serverConnections;
+    Receiver m_receiver;
+};
+
+void tst_cryptoserialization::initTestCase()
+{
+    qDBusRegisterMetaType<Key::Identifier>();
+    qDBusRegisterMetaType<KeyIdentifierGroup>();
+    qDBusRegisterMetaType<IdentifierVector>();
+    qDBusRegisterMetaType<IdentifierGroupVector>();
+
+    m_server = new QDBusServer(this);
+    QVERIFY2(m_server->isConnected(), qPrintable(m_server->lastError().message()));
+    connect(m_server, &QDBusServer::newConnection, this, [this] (const QDBusConnection &connection) {
+        m_serverConnections.append(connection);
+        m_serverConnections.last().registerObject(RECEIVER_PATH, &m_receiver, QDBusConnection::ExportAllSlots);
+    });
+
+    QDBusConnection client = QDBusConnection::connectToPeer(m_server->address(), CLIENT_CONNECTION_NAME);
+    QVERIFY2(client.isConnected(), qPrintable(client.lastError().message()));
+}
+
+void tst_cryptoserialization::cleanupTestCase()
+{
+    QDBusConnection::disconnectFromPeer(CLIENT_CONNECTION_NAME);
+    m_serverConnections.clear();
+}
+
+// Sends the identifiers to the receiver through the peer-to-peer
+// connection, so that they are marshalled and demarshalled as they
+// would be between a client and the daemon.
+bool tst_cryptoserialization::send(const QString &method, const IdentifierVector &identifiers)
+{
+    QDBusMessage call = QDBusMessage::createMethodCall(QString(), RECEIVER_PATH, QString(), method);
+    call << QVariant::fromValue(identifiers);
+    // the receiver is served by the event loop of this thread,
+    // so the reply must be waited for without blocking it.
+    QDBusPendingCall reply = QDBusConnection(CLIENT_CONNECTION_NAME).asyncCall(call);
+    for (int maxWait = 5000; !reply.isFinished() && maxWait > 0; maxWait -= 50) {
+        QTest::qWait(50);
+    }
+    if (!reply.isFinished() || reply.isError()) {
+        qWarning() << "Failed to send the identifiers:" << reply.error().message();
+        return false;
+    }
+    return true;
+}
+
+void tst_cryptoserialization::signature()
+{
+    QCOMPARE(QString::fromLatin1(QDBusMetaType::typeToSignature(qMetaTypeId<IdentifierVector>())),
+             QStringLiteral("a(ssas)"));
+    QCOMPARE(QString::fromLatin1(QDBusMetaType::typeToSignature(qMetaTypeId<KeyIdentifierGroup>())),
+             QStringLiteral("(ssas)"));
+}
+
+void tst_cryptoserialization::roundTrip_data()
+{
+    QTest::addColumn<IdentifierVector>("identifiers");
+    QTest::addColumn<int>("groupCount");
+
+    const QString pluginA = QStringLiteral("org.sailfishos.crypto.plugin.crypto.openssl.test");
+    const QString pluginB = QStringLiteral("org.sailfishos.secrets.plugin.encryptedstorage.sqlcipher.test");
+
+    QTest::newRow("empty")
+            << IdentifierVector()
+            << 0;
+    QTest::newRow("single run")
+            << (IdentifierVector()
+                << Key::Identifier(QStringLiteral("first"), QStringLiteral("collection"), pluginA)
+                << Key::Identifier(QStringLiteral("second"), QStringLiteral("collection"), pluginA)
+                << Key::Identifier(QStringLiteral("third"), QStringLiteral("collection"), pluginA))
+            << 1;
+    // a run which recurs after another one must not be merged with it,
+    // as the order of the identifiers is significant.
+    QTest::newRow("interleaved plugins")
+            << (IdentifierVector()
+                << Key::Identifier(QStringLiteral("first"), QStringLiteral("collection"), pluginA)
+                << Key::Identifier(QStringLiteral("second"), QStringLiteral("collection"), pluginB)
+                << Key::Identifier(QStringLiteral("third"), QStringLiteral("collection"), pluginA))
+            << 3;
+    QTest::newRow("interleaved collections")
+            << (IdentifierVector()
+                << Key::Identifier(QStringLiteral("first"), QStringLiteral("collectionA"), pluginA)
+                << Key::Identifier(QStringLiteral("second"), QStringLiteral("collectionA"), pluginA)
+                << Key::Identifier(QStringLiteral("third"), QStringLiteral("collectionB"), pluginA)
+                << Key::Identifier(QStringLiteral("fourth"), QStringLiteral("collectionA"), pluginA))
+            << 3;
+    // an empty name must not be mistaken for the start of a new run.
+    QTest::newRow("empty names")
+            << (IdentifierVector()
+                << Key::Identifier(QString(), QStringLiteral("collection"), pluginA)
+                << Key::Identifier(QString(), QStringLiteral("collection"), pluginA)
+                << Key::Identifier(QStringLiteral("third"), QStringLiteral("collection"), pluginA)
+                << Key::Identifier(QString(), QStringLiteral("collection"), pluginB))
+            << 2;
+    QTest::newRow("standalone keys")
+            << (IdentifierVector()
+                << Key::Identifier(QStringLiteral("first"), QString(), pluginA)
+                << Key::Identifier(QStringLiteral("second"), QStringLiteral("collection"), pluginA)
+                << Key::Identifier(QStringLiteral("third"), QString(), pluginA))
+            << 3;
+}
+
+void tst_cryptoserialization::roundTrip()
+{
+    QFETCH(IdentifierVector, identifiers);
+    QFETCH(int, groupCount);
+
+    m_receiver.identifiers = IdentifierVector() << Key::Identifier(QStringLiteral("stale"), QString(), QString());
+    m_receiver.signature.clear();
+    QVERIFY(send(QStringLiteral("receiveIdentifiers"), identifiers));
+    QCOMPARE(m_receiver.signature, QStringLiteral("a(ssas)"));
+    QCOMPARE(m_receiver.identifiers.size(), identifiers.size());
+    for (int i = 0; i < identifiers.size(); ++i) {
+        QCOMPARE(m_receiver.identifiers.at(i).name(), identifiers.at(i).name());
+        QCOMPARE(m_receiver.identifiers.at(i).collectionName(), identifiers.at(i).collectionName());
+        QCOMPARE(m_receiver.identifiers.at(i).storagePluginName(), identifiers.at(i).storagePluginName());
+    }
+    QVERIFY(m_receiver.identifiers == identifiers);
+
+    // each run of identifiers sharing a storage plugin and collection
+    // is sent as a single group.
+    m_receiver.groups.clear();
+    QVERIFY(send(QStringLiteral("receiveGroups"), identifiers));
+    QCOMPARE(m_receiver.groups.size(), groupCount);
+    int names = 0;
+    for (const KeyIdentifierGroup &group : m_receiver.groups) {
+        QVERIFY(!group.names.isEmpty());
+        names += group.names.size();
+    }
+    QCOMPARE(names, identifiers.size());
+}
+
+#include "tst_cryptoserialization.moc"
+QTEST_MAIN(tst_cryptoserialization)
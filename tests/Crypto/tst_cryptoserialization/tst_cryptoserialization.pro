@@ -0,0 +1,7 @@
+TEMPLATE = app
+TARGET = tst_cryptoserialization
+target.path = /opt/tests/Sailfish/Crypto/
+include($$PWD/../../../lib/libsailfishcrypto.pri)
+QT += testlib dbus
+SOURCES += tst_cryptoserialization.cpp
+INSTALLS += target
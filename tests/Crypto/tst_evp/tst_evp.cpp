@@ -363,4 +363,80 @@ QByteArray tst_evp::digestWithEvp(const QByteArray &data)
     return result;
 }
 
+/*!
+ * Tests scrypt key derivation against the test vectors of RFC 7914,
+ * which include a case with several lanes.
+ */
+void tst_evp::testScrypt_data()
+{
+    QTest::addColumn<QByteArray>("password");
+    QTest::addColumn<QByteArray>("salt");
+    QTest::addColumn<int>("n");
+    QTest::addColumn<int>("r");
+    QTest::addColumn<int>("p");
+    QTest::addColumn<QByteArray>("expected");
+
+    QTest::newRow("empty")
+            << QByteArray() << QByteArray() << 16 << 1 << 1
+            << QByteArray::fromHex("77d6576238657b203b19ca42c18a0497f16b4844e3074ae8dfdffa3fede21442"
+                                   "fcd0069ded0948f8326a753a0fc81f17e8d3e0fb2e0d3628cf35e20c38d18906");
+    QTest::newRow("16 lanes")
+            << QByteArray("password") << QByteArray("NaCl") << 1024 << 8 << 16
+            << QByteArray::fromHex("fdbabe1c9d3472007856e7190d01e9fe7c6ad7cbc8237830e77376634b373162"
+                                   "2eaf30d92e22a3886ff109279d9830dac727afb94a83ee6d8360cbdfa2cc0640");
+}
+
+void tst_evp::testScrypt()
+{
+    QFETCH(QByteArray, password);
+    QFETCH(QByteArray, salt);
+    QFETCH(int, n);
+    QFETCH(int, r);
+    QFETCH(int, p);
+    QFETCH(QByteArray, expected);
+
+    QByteArray derived(expected.size(), '\0');
+    int result = OpenSslEvp::scrypt(password.constData(), password.size(),
+                                    reinterpret_cast<const unsigned char *>(salt.constData()), salt.size(),
+                                    n, r, p,
+                                    derived.size(), reinterpret_cast<unsigned char *>(derived.data()));
+    QCOMPARE(result, 1);
+    QCOMPARE(derived.toHex(), expected.toHex());
+}
+
+/*!
+ * Tests that scrypt parameters which are not a valid cost, or which
+ * would require more than OSSLEVP_KDF_MAX_MEMORY bytes, are rejected.
+ */
+void tst_evp::testScryptLimits_data()
+{
+    QTest::addColumn<int>("n");
+    QTest::addColumn<int>("r");
+    QTest::addColumn<int>("p");
+
+    QTest::newRow("cost not a power of two") << 1000 << 8 << 1;
+    QTest::newRow("cost too small") << 1 << 8 << 1;
+    QTest::newRow("too much memory") << (1 << 20) << 8 << 1;
+    QTest::newRow("block size too large") << 16 << (OSSLEVP_SCRYPT_MAX_BLOCK_SIZE + 1) << 1;
+    QTest::newRow("too many lanes") << 16 << 8 << (OSSLEVP_SCRYPT_MAX_PARALLELISM + 1);
+}
+
+void tst_evp::testScryptLimits()
+{
+    QFETCH(int, n);
+    QFETCH(int, r);
+    QFETCH(int, p);
+
+    const QByteArray password("password");
+    const QByteArray salt("NaCl");
+    QVERIFY(!OpenSslEvp::scrypt_parameters_valid(n, r, p));
+
+    QByteArray derived(64, '\0');
+    int result = OpenSslEvp::scrypt(password.constData(), password.size(),
+                                    reinterpret_cast<const unsigned char *>(salt.constData()), salt.size(),
+                                    n, r, p,
+                                    derived.size(), reinterpret_cast<unsigned char *>(derived.data()));
+    QCOMPARE(result, 0);
+}
+
 QTEST_MAIN(tst_evp)
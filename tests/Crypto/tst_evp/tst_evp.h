@@ -32,6 +32,10 @@ private slots:
     void testSign();
     void testVerifyCorrect();
     void testVerifyIncorrect();
+    void testScrypt_data();
+    void testScrypt();
+    void testScryptLimits_data();
+    void testScryptLimits();
 
 private:
     QByteArray generateTestData(size_t size);
@@ -6,15 +6,15 @@ QT += testlib
 CONFIG += link_pkgconfig
 PKGCONFIG += openssl
 
+include($$PWD/../../../lib/libsailfishcryptoevp.pri)
+
 INCLUDEPATH += $$PWD/../../../plugins/opensslcryptoplugin/evp
 DEPENDPATH  += $$PWD/../../../plugins/opensslcryptoplugin/evp
 
 HEADERS += \
-    $$PWD/../../../plugins/opensslcryptoplugin/evp/evp_p.h \
     tst_evp.h
 
 SOURCES += \
-    $$PWD/../../../plugins/opensslcryptoplugin/evp/evp.cpp \
     tst_evp.cpp
 
 INSTALLS += target
@@ -2,4 +2,11 @@ TEMPLATE = subdirs
 SUBDIRS = \
     $$PWD/tst_secrets \
     $$PWD/tst_secretsrequests \
-    $$PWD/tst_dataprotection
+    $$PWD/tst_secretsserialization \
+    $$PWD/tst_dataprotection \
+    $$PWD/tst_kdfparameters \
+    $$PWD/tst_storagebenchmarks \
+    $$PWD/tst_startup \
+    $$PWD/tst_requeststatistics \
+    $$PWD/tst_idle \
+    $$PWD/tst_kdfcalibration
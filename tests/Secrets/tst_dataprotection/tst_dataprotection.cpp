@@ -123,3 +123,111 @@ void tst_dataprotection::testWriteThenCorruptOneFile_expectSuccess()
     QCOMPARE(s, DataProtector::Success);
     QVERIFY2(testData == actualData, "Data read should still match the test data, despite the corruption");
 }
+
+void tst_dataprotection::testCorruptFirstReplica_expectFallbackToOtherReplica()
+{
+    QByteArray testData = createTestData();
+    {
+        DataProtector dp(TESTCASE_PATH);
+        QCOMPARE(dp.putData(testData), DataProtector::Success);
+    }
+
+    QDir protectedRoot(TESTCASE_PATH);
+    QFileInfoList dataDirs = protectedRoot.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot);
+    QVERIFY2(dataDirs.size() == 1, "There should be exactly one data dir");
+    QFile replica(QDir(dataDirs.at(0).absoluteFilePath()).absoluteFilePath(QStringLiteral("file0")));
+    QVERIFY(replica.open(QIODevice::ReadWrite));
+    QByteArray contents = replica.readAll();
+    contents[contents.size() / 2] = contents.at(contents.size() / 2) ^ 0x01;
+    QVERIFY(replica.seek(0));
+    QCOMPARE(replica.write(contents), qint64(contents.size()));
+    replica.close();
+
+    // a new protector has nothing cached, so it has to verify the replicas
+    DataProtector dp(TESTCASE_PATH);
+    QByteArray actualData;
+    QCOMPARE(dp.getData(&actualData), DataProtector::Success);
+    QVERIFY2(testData == actualData, "Data read should match the test data, despite the corrupted first replica");
+}
+
+void tst_dataprotection::testCorruptAllReplicas_expectIrretrievable()
+{
+    {
+        DataProtector dp(TESTCASE_PATH);
+        QCOMPARE(dp.putData(createTestData()), DataProtector::Success);
+    }
+
+    QDir protectedRoot(TESTCASE_PATH);
+    QFileInfoList dataDirs = protectedRoot.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot);
+    QVERIFY2(dataDirs.size() == 1, "There should be exactly one data dir");
+    QDir dataDir(dataDirs.at(0).absoluteFilePath());
+    for (const QFileInfo &fileInfo : dataDir.entryInfoList(QDir::Files)) {
+        QFile dataFile(fileInfo.absoluteFilePath());
+        QVERIFY(dataFile.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        dataFile.write(QByteArray("totally not valid data"));
+        dataFile.close();
+    }
+
+    DataProtector dp(TESTCASE_PATH);
+    QByteArray actualData;
+    QCOMPARE(dp.getData(&actualData), DataProtector::Irretrievable);
+}
+
+void tst_dataprotection::testIncompleteWrite_expectPreviousData()
+{
+    QByteArray testData = createTestData();
+    {
+        DataProtector dp(TESTCASE_PATH);
+        QCOMPARE(dp.putData(testData), DataProtector::Success);
+    }
+
+    // simulate a write which was interrupted before any replica was complete
+    QDir protectedRoot(TESTCASE_PATH);
+    QFileInfoList dataDirs = protectedRoot.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot);
+    QVERIFY2(dataDirs.size() == 1, "There should be exactly one data dir");
+    const QString incompleteDirPath = protectedRoot.absoluteFilePath(QStringLiteral("gen-ffffffffffffff00"));
+    QVERIFY(protectedRoot.mkdir(incompleteDirPath));
+    QFile partialReplica(QDir(incompleteDirPath).absoluteFilePath(QStringLiteral("file0")));
+    QVERIFY(partialReplica.open(QIODevice::WriteOnly));
+    partialReplica.write(QByteArray("SDP2"));
+    partialReplica.close();
+
+    DataProtector dp(TESTCASE_PATH);
+    QByteArray actualData;
+    QCOMPARE(dp.getData(&actualData), DataProtector::Success);
+    QVERIFY2(testData == actualData, "Data read should match the data of the last complete write");
+    QVERIFY2(!QDir(incompleteDirPath).exists(), "The incomplete data dir should have been deleted");
+}
+
+void tst_dataprotection::testLegacyDirectory_expectMigrated()
+{
+    // write the data as the previous versions did: three identical
+    // unchecksummed files in a directory named by a UUID
+    QByteArray testData = createTestData();
+    QDir protectedRoot(TESTCASE_PATH);
+    QVERIFY(protectedRoot.mkpath(TESTCASE_PATH));
+    const QString legacyDirPath = protectedRoot.absoluteFilePath(QStringLiteral("8c4d7a1e-3f0b-4c55-9d2e-6a1b0c9f7e21"));
+    QVERIFY(protectedRoot.mkdir(legacyDirPath));
+    for (int i = 0; i < 3; ++i) {
+        QFile dataFile(QDir(legacyDirPath).absoluteFilePath(QStringLiteral("file%1").arg(i)));
+        QVERIFY(dataFile.open(QIODevice::WriteOnly));
+        dataFile.write(i == 0 ? QByteArray("totally not valid data") : testData);
+        dataFile.close();
+    }
+
+    {
+        DataProtector dp(TESTCASE_PATH);
+        QByteArray actualData;
+        QCOMPARE(dp.getData(&actualData), DataProtector::Success);
+        QVERIFY2(testData == actualData, "Data read should match the majority of the legacy files");
+    }
+
+    QFileInfoList dataDirs = protectedRoot.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot);
+    QVERIFY2(dataDirs.size() == 1, "There should be exactly one data dir");
+    QVERIFY2(dataDirs.at(0).fileName() != QFileInfo(legacyDirPath).fileName(), "The legacy data dir should have been migrated");
+
+    DataProtector dp(TESTCASE_PATH);
+    QByteArray actualData;
+    QCOMPARE(dp.getData(&actualData), DataProtector::Success);
+    QVERIFY2(testData == actualData, "Data read after migration should match the test data");
+}
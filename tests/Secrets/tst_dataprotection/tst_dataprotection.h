@@ -24,6 +24,10 @@ private slots:
     void testWriteAndRead_checkData();
     void testRewrite_checkOldDeletedAndNewDataIntact();
     void testWriteThenCorruptOneFile_expectSuccess();
+    void testCorruptFirstReplica_expectFallbackToOtherReplica();
+    void testCorruptAllReplicas_expectIrretrievable();
+    void testIncompleteWrite_expectPreviousData();
+    void testLegacyDirectory_expectMigrated();
 
 private:
     QByteArray createTestData();
@@ -0,0 +1,258 @@
+/*
+ * Copyright (C) 2018 Jolla Ltd.
+ * Contact: Chris Adams <chris.adams@jollamobile.com>
+ * All rights reserved.
+ * BSD 3-Clause License, see LICENSE.
+ */
+
+#include <QtTest>
+#include <QObject>
+#include <QDBusConnection>
+#include <QDBusConnectionInterface>
+#include <QDBusInterface>
+#include <QDBusReply>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QProcess>
+#include <QProcessEnvironment>
+
+#define DAEMON_PATH QStringLiteral("/usr/bin/sailfishsecretsd")
+#define TOOL_PATH QStringLiteral("/usr/bin/secrets-tool")
+#define DISCOVERY_SERVICE QStringLiteral("org.sailfishos.secrets.daemon.discovery")
+#define DISCOVERY_PATH QStringLiteral("/Sailfish/Secrets/Discovery")
+#define DEFAULT_STORAGE_PLUGIN QStringLiteral("plugin.storage.default")
+#define DEFAULT_CRYPTOSTORAGE_PLUGIN QStringLiteral("plugin.cryptostorage.default")
+#define IN_MEMORY_TEST_ENCRYPTEDSTORAGE_PLUGIN QStringLiteral("org.sailfishos.secrets.plugin.encryptedstorage.inmemory.test")
+#define TEST_COLLECTION_NAME QStringLiteral("tstidlecollection")
+#define TEST_SECRET_NAME QStringLiteral("tstidlesecret")
+#define CLIENT_CONNECTION_NAME QStringLiteral("tst_idle-client")
+
+// The idle exit and trim timeouts of the daemon under test, in seconds.
+// The daemon exits once it has been idle for a whole interval, i.e. after
+// between one and two intervals, and trims likewise.
+#define IDLE_EXIT_TIMEOUT 1
+#define IDLE_TRIM_TIMEOUT 1
+
+// Long enough for the daemon to have exited had it been idle.
+#define STAY_UP_MSECS (4 * IDLE_EXIT_TIMEOUT * 1000)
+#define EXIT_MSECS (10 * IDLE_EXIT_TIMEOUT * 1000)
+#define TRIM_MSECS (10 * IDLE_TRIM_TIMEOUT * 1000)
+
+#define ENV_IDLE_EXIT_TIMEOUT "SAILFISH_SECRETSD_IDLE_EXIT_TIMEOUT"
+#define ENV_IDLE_TRIM_TIMEOUT "SAILFISH_SECRETSD_IDLE_TRIM_TIMEOUT"
+
+// Starts the daemon in autotest mode with a short idle exit timeout, and
+// checks that it exits when idle but stays up while a client is connected
+// or while it holds state which would be lost if it exited.  Also checks
+// that requests still succeed after the daemon has trimmed its memory.
+// The daemon must not already be running, as the test must control its
+// environment.
+class tst_idle : public QObject
+{
+    Q_OBJECT
+
+public slots:
+    void initTestCase();
+    void cleanup();
+
+private slots:
+    void exitWhenIdle();
+    void stayUpWhileClientConnected();
+    void stayUpWhileUnlockedStateHeld();
+    void requestsAfterTrim();
+
+private:
+    bool startDaemon(const char *timeoutVariable, int timeout);
+    bool runTool(const QStringList &args);
+    QJsonObject trimStatistics();
+
+    QProcess m_daemon;
+};
+
+void tst_idle::initTestCase()
+{
+    if (!QFileInfo(DAEMON_PATH).isExecutable()) {
+        QSKIP("The secrets daemon is not installed");
+    }
+
+    QDBusConnectionInterface *bus = QDBusConnection::sessionBus().interface();
+    QVERIFY(bus);
+    if (bus->isServiceRegistered(DISCOVERY_SERVICE)) {
+        QSKIP("The secrets daemon is already running, stop it to test the idle exit");
+    }
+}
+
+void tst_idle::cleanup()
+{
+    QDBusConnection::disconnectFromPeer(CLIENT_CONNECTION_NAME);
+    if (m_daemon.state() != QProcess::NotRunning) {
+        m_daemon.terminate();
+        if (!m_daemon.waitForFinished()) {
+            m_daemon.kill();
+            m_daemon.waitForFinished();
+        }
+    }
+}
+
+bool tst_idle::startDaemon(const char *timeoutVariable, int timeout)
+{
+    QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+    environment.insert(QString::fromLatin1(timeoutVariable), QString::number(timeout));
+    m_daemon.setProcessEnvironment(environment);
+    m_daemon.setProcessChannelMode(QProcess::ForwardedChannels);
+    m_daemon.start(DAEMON_PATH, QStringList() << QStringLiteral("--test"));
+    if (!m_daemon.waitForStarted()) {
+        return false;
+    }
+
+    QDBusConnectionInterface *bus = QDBusConnection::sessionBus().interface();
+    QElapsedTimer timer;
+    timer.start();
+    while (!bus->isServiceRegistered(DISCOVERY_SERVICE)) {
+        if (timer.hasExpired(20000) || m_daemon.state() == QProcess::NotRunning) {
+            return false;
+        }
+        QTest::qWait(50);
+    }
+    return true;
+}
+
+// Returns the trim statistics of the daemon, or an empty object if they
+// could not be read.
+QJsonObject tst_idle::trimStatistics()
+{
+    QDBusInterface iface(DISCOVERY_SERVICE, DISCOVERY_PATH, DISCOVERY_SERVICE, QDBusConnection::sessionBus());
+    QDBusReply<QString> reply = iface.call(QStringLiteral("trimStatistics"));
+    return reply.isValid()
+            ? QJsonDocument::fromJson(reply.value().toUtf8()).object()
+            : QJsonObject();
+}
+
+bool tst_idle::runTool(const QStringList &args)
+{
+    QProcess tool;
+    tool.setProcessChannelMode(QProcess::ForwardedChannels);
+    tool.start(TOOL_PATH, QStringList() << QStringLiteral("--test") << args);
+    return tool.waitForFinished(30000)
+            && tool.exitStatus() == QProcess::NormalExit
+            && tool.exitCode() == 0;
+}
+
+void tst_idle::exitWhenIdle()
+{
+    QVERIFY(startDaemon(ENV_IDLE_EXIT_TIMEOUT, IDLE_EXIT_TIMEOUT));
+
+    QTRY_VERIFY_WITH_TIMEOUT(m_daemon.state() == QProcess::NotRunning, EXIT_MSECS);
+    QCOMPARE(m_daemon.exitStatus(), QProcess::NormalExit);
+    QCOMPARE(m_daemon.exitCode(), 0);
+    QVERIFY(!QDBusConnection::sessionBus().interface()->isServiceRegistered(DISCOVERY_SERVICE));
+}
+
+void tst_idle::stayUpWhileClientConnected()
+{
+    QVERIFY(startDaemon(ENV_IDLE_EXIT_TIMEOUT, IDLE_EXIT_TIMEOUT));
+
+    QDBusInterface iface(DISCOVERY_SERVICE, DISCOVERY_PATH, DISCOVERY_SERVICE, QDBusConnection::sessionBus());
+    QDBusReply<QString> address = iface.call(QStringLiteral("peerToPeerAddress"));
+    QVERIFY2(address.isValid(), qPrintable(address.error().message()));
+
+    QDBusConnection client = QDBusConnection::connectToPeer(address.value(), CLIENT_CONNECTION_NAME);
+    QVERIFY2(client.isConnected(), qPrintable(client.lastError().message()));
+
+    QTest::qWait(STAY_UP_MSECS);
+    QCOMPARE(m_daemon.state(), QProcess::Running);
+
+    // Once the client has gone away the daemon is idle again.
+    QDBusConnection::disconnectFromPeer(CLIENT_CONNECTION_NAME);
+    QTRY_VERIFY_WITH_TIMEOUT(m_daemon.state() == QProcess::NotRunning, EXIT_MSECS);
+    QCOMPARE(m_daemon.exitStatus(), QProcess::NormalExit);
+    QCOMPARE(m_daemon.exitCode(), 0);
+}
+
+void tst_idle::stayUpWhileUnlockedStateHeld()
+{
+    if (!QFileInfo(TOOL_PATH).isExecutable()) {
+        QSKIP("The secrets tool is not installed");
+    }
+    QVERIFY(startDaemon(ENV_IDLE_EXIT_TIMEOUT, IDLE_EXIT_TIMEOUT));
+
+    // The collections of the in-memory plugin would be lost if the daemon
+    // exited, so it must stay up after the client which created one exits.
+    QVERIFY(runTool(QStringList() << QStringLiteral("--create-collection")
+                                  << QStringLiteral("--devicelock")
+                                  << QStringLiteral("--keep-unlocked")
+                                  << IN_MEMORY_TEST_ENCRYPTEDSTORAGE_PLUGIN
+                                  << TEST_COLLECTION_NAME));
+
+    QTest::qWait(STAY_UP_MSECS);
+    QCOMPARE(m_daemon.state(), QProcess::Running);
+
+    // Once the collection is gone the daemon is idle again.
+    QVERIFY(runTool(QStringList() << QStringLiteral("--delete-collection")
+                                  << IN_MEMORY_TEST_ENCRYPTEDSTORAGE_PLUGIN
+                                  << TEST_COLLECTION_NAME));
+    QTRY_VERIFY_WITH_TIMEOUT(m_daemon.state() == QProcess::NotRunning, EXIT_MSECS);
+    QCOMPARE(m_daemon.exitStatus(), QProcess::NormalExit);
+    QCOMPARE(m_daemon.exitCode(), 0);
+}
+
+void tst_idle::requestsAfterTrim()
+{
+    if (!QFileInfo(TOOL_PATH).isExecutable()) {
+        QSKIP("The secrets tool is not installed");
+    }
+    QVERIFY(startDaemon(ENV_IDLE_TRIM_TIMEOUT, IDLE_TRIM_TIMEOUT));
+
+    QDBusInterface iface(DISCOVERY_SERVICE, DISCOVERY_PATH, DISCOVERY_SERVICE, QDBusConnection::sessionBus());
+    QDBusReply<QString> reply = iface.call(QStringLiteral("trimStatistics"));
+    if (reply.error().type() == QDBusError::AccessDenied) {
+        QSKIP("The trim statistics are only available to platform applications, run within a devel-su -p shell");
+    }
+    QVERIFY2(reply.isValid(), qPrintable(reply.error().message()));
+
+    // Use the databases of the secrets and crypto storage plugins, and the
+    // crypto worker thread, so that the trim has something to release.
+    QVERIFY(runTool(QStringList() << QStringLiteral("--create-collection")
+                                  << QStringLiteral("--devicelock")
+                                  << QStringLiteral("--keep-unlocked")
+                                  << DEFAULT_STORAGE_PLUGIN
+                                  << TEST_COLLECTION_NAME));
+    QVERIFY(runTool(QStringList() << QStringLiteral("--store-collection-secret")
+                                  << DEFAULT_STORAGE_PLUGIN
+                                  << TEST_COLLECTION_NAME
+                                  << TEST_SECRET_NAME
+                                  << QStringLiteral("tst_idle secret data")));
+    QVERIFY(runTool(QStringList() << QStringLiteral("--list-keys")
+                                  << DEFAULT_CRYPTOSTORAGE_PLUGIN));
+
+    const int trimCount = trimStatistics().value(QStringLiteral("trimCount")).toInt();
+    QTRY_VERIFY_WITH_TIMEOUT(trimStatistics().value(QStringLiteral("trimCount")).toInt() > trimCount, TRIM_MSECS);
+    const QJsonObject lastTrim = trimStatistics().value(QStringLiteral("lastTrim")).toObject();
+    qInfo() << "RSS before trim:" << lastTrim.value(QStringLiteral("rssBeforeKb")).toDouble() << "kB"
+            << "after:" << lastTrim.value(QStringLiteral("rssAfterKb")).toDouble() << "kB";
+    QVERIFY(lastTrim.value(QStringLiteral("rssBeforeKb")).toDouble() > 0);
+    QVERIFY(lastTrim.value(QStringLiteral("rssAfterKb")).toDouble() > 0);
+    QVERIFY(lastTrim.value(QStringLiteral("databasesShrunk")).toInt() > 0);
+
+    // The released prepared queries and worker threads are created again
+    // on demand, so the same requests still succeed.
+    QVERIFY(runTool(QStringList() << QStringLiteral("--get-collection-secret")
+                                  << DEFAULT_STORAGE_PLUGIN
+                                  << TEST_COLLECTION_NAME
+                                  << TEST_SECRET_NAME));
+    QVERIFY(runTool(QStringList() << QStringLiteral("--list-keys")
+                                  << DEFAULT_CRYPTOSTORAGE_PLUGIN));
+
+    // and the daemon trims again once it is idle again.
+    const int secondTrimCount = trimStatistics().value(QStringLiteral("trimCount")).toInt();
+    QTRY_VERIFY_WITH_TIMEOUT(trimStatistics().value(QStringLiteral("trimCount")).toInt() > secondTrimCount, TRIM_MSECS);
+
+    QVERIFY(runTool(QStringList() << QStringLiteral("--delete-collection")
+                                  << DEFAULT_STORAGE_PLUGIN
+                                  << TEST_COLLECTION_NAME));
+}
+
+#include "tst_idle.moc"
+QTEST_MAIN(tst_idle)
@@ -0,0 +1,8 @@
+TEMPLATE = app
+TARGET = tst_idle
+target.path = /opt/tests/Sailfish/Secrets/
+QT += testlib dbus
+INSTALLS += target
+
+SOURCES += \
+    $$PWD/tst_idle.cpp
@@ -0,0 +1,309 @@
+/*
+ * Copyright (C) 2018 Jolla Ltd.
+ * Contact: Chris Adams <chris.adams@jollamobile.com>
+ * All rights reserved.
+ * BSD 3-Clause License, see LICENSE.
+ */
+
+#include <QtTest>
+#include <QObject>
+#include <QDBusConnection>
+#include <QDBusConnectionInterface>
+#include <QDBusInterface>
+#include <QDBusReply>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QProcess>
+#include <QProcessEnvironment>
+#include <QScopedPointer>
+#include <QTemporaryDir>
+
+#include "Secrets/secretmanager.h"
+#include "Secrets/secret.h"
+#include "Secrets/interactionparameters.h"
+#include "Secrets/createcollectionrequest.h"
+#include "Secrets/lockcoderequest.h"
+#include "Secrets/storedsecretrequest.h"
+#include "Secrets/storesecretrequest.h"
+
+using namespace Sailfish::Secrets;
+
+#define DAEMON_PATH QStringLiteral("/usr/bin/sailfishsecretsd")
+#define DISCOVERY_SERVICE QStringLiteral("org.sailfishos.secrets.daemon.discovery")
+#define DISCOVERY_PATH QStringLiteral("/Sailfish/Secrets/Discovery")
+#define DEFAULT_TEST_STORAGE_PLUGIN SecretManager::DefaultStoragePluginName + QLatin1String(".test")
+#define DEFAULT_TEST_ENCRYPTION_PLUGIN SecretManager::DefaultEncryptionPluginName + QLatin1String(".test")
+#define IN_APP_TEST_AUTHENTICATION_PLUGIN SecretManager::InAppAuthenticationPluginName + QLatin1String(".test")
+#define TEST_SECRET_NAME QStringLiteral("tstkdfcalibrationsecret")
+#define TEST_SECRET_DATA QByteArrayLiteral("tstkdfcalibrationvalue")
+
+#define ENV_MASTERLOCK_KDF_TARGET_MSECS "SAILFISH_SECRETSD_MASTERLOCK_KDF_TARGET_MSECS"
+#define ENV_PLUGIN_STATISTICS "SAILFISH_SECRETSD_PLUGIN_STATISTICS"
+
+// Cannot use waitForFinished() for some replies, as ui flows require user interaction / event handling.
+#define WAIT_FOR_FINISHED_WITHOUT_BLOCKING(request)                     \
+    do {                                                                \
+        int maxWait = 60000;                                            \
+        while (request.status() != Request::Finished && maxWait > 0) {  \
+            QTest::qWait(100);                                          \
+            maxWait -= 100;                                             \
+        }                                                               \
+    } while (0)
+
+// Starts the daemon in autotest mode with its data in a temporary directory,
+// and checks that the key derivation parameters calibrated for the device
+// are still used after the daemon restarts: by collections created with
+// them, by new collections, and by the master lock code.
+// The daemon must not already be running, as the test must control its
+// environment.
+class tst_kdfcalibration : public QObject
+{
+    Q_OBJECT
+
+public slots:
+    void initTestCase();
+    void init();
+    void cleanup();
+
+private slots:
+    void customLockCollectionAfterRestart();
+    void collectionCalibrationAfterRestart();
+    void masterLockAfterRestart();
+
+private:
+    bool startDaemon();
+    void stopDaemon();
+    Result createCollection(const QString &collectionName);
+    Result storeSecret(const QString &collectionName);
+    Result storedSecret(const QString &collectionName, QByteArray *data);
+    Result lockCodeRequest(LockCodeRequest::LockCodeRequestType type,
+                           LockCodeRequest::LockStatus *lockStatus = Q_NULLPTR);
+    double pluginCalls(const QString &operation, bool *ok);
+
+    QScopedPointer<QTemporaryDir> m_dataDir;
+    QProcess m_daemon;
+};
+
+void tst_kdfcalibration::initTestCase()
+{
+    if (!QFileInfo(DAEMON_PATH).isExecutable()) {
+        QSKIP("The secrets daemon is not installed");
+    }
+
+    QDBusConnectionInterface *bus = QDBusConnection::sessionBus().interface();
+    QVERIFY(bus);
+    if (bus->isServiceRegistered(DISCOVERY_SERVICE)) {
+        QSKIP("The secrets daemon is already running, stop it to test the calibration");
+    }
+}
+
+void tst_kdfcalibration::init()
+{
+    m_dataDir.reset(new QTemporaryDir);
+    QVERIFY(m_dataDir->isValid());
+}
+
+void tst_kdfcalibration::cleanup()
+{
+    stopDaemon();
+    m_dataDir.reset();
+}
+
+bool tst_kdfcalibration::startDaemon()
+{
+    QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+    environment.insert(QStringLiteral("XDG_DATA_HOME"), m_dataDir->path());
+    environment.insert(QStringLiteral(ENV_MASTERLOCK_KDF_TARGET_MSECS), QStringLiteral("1"));
+    environment.insert(QStringLiteral(ENV_PLUGIN_STATISTICS), QStringLiteral("1"));
+    m_daemon.setProcessEnvironment(environment);
+    m_daemon.setProcessChannelMode(QProcess::ForwardedChannels);
+    m_daemon.start(DAEMON_PATH, QStringList() << QStringLiteral("--test"));
+    if (!m_daemon.waitForStarted()) {
+        return false;
+    }
+
+    QDBusConnectionInterface *bus = QDBusConnection::sessionBus().interface();
+    QElapsedTimer timer;
+    timer.start();
+    while (!bus->isServiceRegistered(DISCOVERY_SERVICE)) {
+        if (timer.hasExpired(20000) || m_daemon.state() == QProcess::NotRunning) {
+            return false;
+        }
+        QTest::qWait(50);
+    }
+    return true;
+}
+
+void tst_kdfcalibration::stopDaemon()
+{
+    if (m_daemon.state() != QProcess::NotRunning) {
+        m_daemon.terminate();
+        if (!m_daemon.waitForFinished()) {
+            m_daemon.kill();
+            m_daemon.waitForFinished();
+        }
+    }
+}
+
+// Each request uses its own manager, so that it connects to the
+// daemon which is currently running.
+Result tst_kdfcalibration::createCollection(const QString &collectionName)
+{
+    SecretManager sm;
+    CreateCollectionRequest ccr;
+    ccr.setManager(&sm);
+    ccr.setCollectionLockType(CreateCollectionRequest::CustomLock);
+    ccr.setCollectionName(collectionName);
+    ccr.setStoragePluginName(DEFAULT_TEST_STORAGE_PLUGIN);
+    ccr.setEncryptionPluginName(DEFAULT_TEST_ENCRYPTION_PLUGIN);
+    ccr.setAuthenticationPluginName(IN_APP_TEST_AUTHENTICATION_PLUGIN);
+    ccr.setCustomLockUnlockSemantic(SecretManager::CustomLockKeepUnlocked);
+    ccr.setAccessControlMode(SecretManager::OwnerOnlyMode);
+    ccr.setUserInteractionMode(SecretManager::ApplicationInteraction);
+    ccr.startRequest();
+    WAIT_FOR_FINISHED_WITHOUT_BLOCKING(ccr);
+    return ccr.result();
+}
+
+Result tst_kdfcalibration::storeSecret(const QString &collectionName)
+{
+    Secret secret(Secret::Identifier(TEST_SECRET_NAME, collectionName, DEFAULT_TEST_STORAGE_PLUGIN));
+    secret.setData(TEST_SECRET_DATA);
+    secret.setType(Secret::TypeBlob);
+
+    SecretManager sm;
+    StoreSecretRequest ssr;
+    ssr.setManager(&sm);
+    ssr.setSecretStorageType(StoreSecretRequest::CollectionSecret);
+    ssr.setUserInteractionMode(SecretManager::ApplicationInteraction);
+    ssr.setSecret(secret);
+    ssr.startRequest();
+    WAIT_FOR_FINISHED_WITHOUT_BLOCKING(ssr);
+    return ssr.result();
+}
+
+Result tst_kdfcalibration::storedSecret(const QString &collectionName, QByteArray *data)
+{
+    SecretManager sm;
+    StoredSecretRequest gsr;
+    gsr.setManager(&sm);
+    gsr.setIdentifier(Secret::Identifier(TEST_SECRET_NAME, collectionName, DEFAULT_TEST_STORAGE_PLUGIN));
+    gsr.setUserInteractionMode(SecretManager::ApplicationInteraction);
+    gsr.startRequest();
+    WAIT_FOR_FINISHED_WITHOUT_BLOCKING(gsr);
+    *data = gsr.secret().data();
+    return gsr.result();
+}
+
+Result tst_kdfcalibration::lockCodeRequest(LockCodeRequest::LockCodeRequestType type,
+                                           LockCodeRequest::LockStatus *lockStatus)
+{
+    InteractionParameters uiParams;
+    uiParams.setAuthenticationPluginName(IN_APP_TEST_AUTHENTICATION_PLUGIN);
+    uiParams.setInputType(InteractionParameters::AlphaNumericInput);
+    uiParams.setEchoMode(InteractionParameters::PasswordEcho);
+
+    SecretManager sm;
+    LockCodeRequest lcr;
+    lcr.setManager(&sm);
+    lcr.setLockCodeRequestType(type);
+    lcr.setLockCodeTargetType(LockCodeRequest::MetadataDatabase);
+    lcr.setUserInteractionMode(SecretManager::ApplicationInteraction);
+    lcr.setInteractionParameters(uiParams);
+    lcr.setLockCodeTarget(QString());
+    lcr.startRequest();
+    WAIT_FOR_FINISHED_WITHOUT_BLOCKING(lcr);
+    if (lockStatus) {
+        *lockStatus = lcr.lockStatus();
+    }
+    return lcr.result();
+}
+
+// Returns the number of calls of the given operation summed over all
+// plugins.  Reading the statistics requires a platform application.
+double tst_kdfcalibration::pluginCalls(const QString &operation, bool *ok)
+{
+    QDBusInterface iface(DISCOVERY_SERVICE, DISCOVERY_PATH, DISCOVERY_SERVICE, QDBusConnection::sessionBus());
+    QDBusReply<QString> reply = iface.call(QStringLiteral("pluginStatistics"));
+    *ok = reply.isValid();
+
+    double calls = 0;
+    const QJsonObject plugins = QJsonDocument::fromJson(reply.value().toUtf8())
+            .object().value(QStringLiteral("plugins")).toObject();
+    for (const QJsonValue &operations : plugins) {
+        calls += operations.toObject().value(operation).toObject()
+                .value(QStringLiteral("calls")).toDouble();
+    }
+    return calls;
+}
+
+void tst_kdfcalibration::customLockCollectionAfterRestart()
+{
+    QVERIFY(startDaemon());
+    Result result = createCollection(QStringLiteral("tstkdfcalibrationcollection"));
+    QVERIFY2(result.code() == Result::Succeeded, qPrintable(result.errorMessage()));
+    result = storeSecret(QStringLiteral("tstkdfcalibrationcollection"));
+    QVERIFY2(result.code() == Result::Succeeded, qPrintable(result.errorMessage()));
+
+    // The collection key must be derived with the parameters it was
+    // created with, which are no longer held in memory by the daemon.
+    stopDaemon();
+    QVERIFY(startDaemon());
+    QByteArray data;
+    result = storedSecret(QStringLiteral("tstkdfcalibrationcollection"), &data);
+    QVERIFY2(result.code() == Result::Succeeded, qPrintable(result.errorMessage()));
+    QCOMPARE(data, TEST_SECRET_DATA);
+}
+
+void tst_kdfcalibration::collectionCalibrationAfterRestart()
+{
+    QVERIFY(startDaemon());
+    bool ok = false;
+    pluginCalls(QStringLiteral("calibrateAndDeriveKeyFromCode"), &ok);
+    if (!ok) {
+        QSKIP("The plugin statistics are only available to platform applications, run within a devel-su -p shell");
+    }
+
+    Result result = createCollection(QStringLiteral("tstkdfcalibrationfirst"));
+    QVERIFY2(result.code() == Result::Succeeded, qPrintable(result.errorMessage()));
+    QCOMPARE(pluginCalls(QStringLiteral("calibrateAndDeriveKeyFromCode"), &ok), 1.0);
+
+    // The calibration is stored, so it is not repeated after a restart.
+    stopDaemon();
+    QVERIFY(startDaemon());
+    result = createCollection(QStringLiteral("tstkdfcalibrationsecond"));
+    QVERIFY2(result.code() == Result::Succeeded, qPrintable(result.errorMessage()));
+    QCOMPARE(pluginCalls(QStringLiteral("calibrateAndDeriveKeyFromCode"), &ok), 0.0);
+    QCOMPARE(pluginCalls(QStringLiteral("deriveKeyFromCode"), &ok), 1.0);
+}
+
+void tst_kdfcalibration::masterLockAfterRestart()
+{
+    QVERIFY(startDaemon());
+
+    // Setting the master lock code calibrates its key derivation.  The
+    // test authentication plugin provides the empty code as the old code
+    // and "masterlock" as the new one.
+    Result result = lockCodeRequest(LockCodeRequest::ModifyLockCode);
+    QVERIFY2(result.code() == Result::Succeeded, qPrintable(result.errorMessage()));
+
+    // After a restart the daemon cannot unlock itself with the empty code,
+    // and the correct code only unlocks it if the stored parameters are used.
+    stopDaemon();
+    QVERIFY(startDaemon());
+    LockCodeRequest::LockStatus lockStatus = LockCodeRequest::Unknown;
+    result = lockCodeRequest(LockCodeRequest::QueryLockStatus, &lockStatus);
+    QVERIFY2(result.code() == Result::Succeeded, qPrintable(result.errorMessage()));
+    QCOMPARE(lockStatus, LockCodeRequest::Locked);
+
+    result = lockCodeRequest(LockCodeRequest::ProvideLockCode);
+    QVERIFY2(result.code() == Result::Succeeded, qPrintable(result.errorMessage()));
+    result = lockCodeRequest(LockCodeRequest::QueryLockStatus, &lockStatus);
+    QVERIFY2(result.code() == Result::Succeeded, qPrintable(result.errorMessage()));
+    QCOMPARE(lockStatus, LockCodeRequest::Unlocked);
+}
+
+#include "tst_kdfcalibration.moc"
+QTEST_MAIN(tst_kdfcalibration)
@@ -0,0 +1,9 @@
+TEMPLATE = app
+TARGET = tst_kdfcalibration
+target.path = /opt/tests/Sailfish/Secrets/
+include($$PWD/../../../lib/libsailfishsecrets.pri)
+QT += testlib dbus
+INSTALLS += target
+
+SOURCES += \
+    $$PWD/tst_kdfcalibration.cpp
@@ -0,0 +1,180 @@
+/*
+ * Copyright (C) 2018 Jolla Ltd.
+ * Contact: Chris Adams <chris.adams@jollamobile.com>
+ * All rights reserved.
+ * BSD 3-Clause License, see LICENSE.
+ */
+
+#include "tst_kdfparameters.h"
+#include "../../../daemon/SecretsImpl/kdfparametersstore_p.h"
+
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+
+#define TEST_PATH QStringLiteral("/tmp/secrets_tst_kdfparameters/")
+#define TESTCASE_PATH QString(TEST_PATH + QString(__func__))
+
+QTEST_MAIN(tst_kdfparameters)
+Q_LOGGING_CATEGORY(lcSailfishSecretsDaemon, "org.sailfishos.secrets.daemon", QtWarningMsg)
+
+using namespace Sailfish::Secrets::Daemon::ApiImpl;
+
+void tst_kdfparameters::init()
+{
+    cleanup();
+}
+
+void tst_kdfparameters::cleanup()
+{
+    QDir dir(TEST_PATH);
+    if (dir.exists()) {
+        if (!dir.removeRecursively()) {
+            qWarning() << "Could not cleanup test directory.";
+        }
+    }
+}
+
+void tst_kdfparameters::testMasterLock_initiallyLegacy()
+{
+    // keys derived before calibration was introduced used the legacy cost.
+    KdfParametersStore store(TESTCASE_PATH, true);
+    MasterLockKdfParameters parameters;
+    QCOMPARE(store.readMasterLockParameters(&parameters), DataProtector::Success);
+    QVERIFY(parameters == MasterLockKdfParameters::legacy());
+}
+
+void tst_kdfparameters::testMasterLock_persistedAcrossRestart()
+{
+    const MasterLockKdfParameters calibrated(4000, 5332);
+    QVERIFY(KdfParametersStore(TESTCASE_PATH, true).writeMasterLockParameters(calibrated));
+
+    // a new store reads the parameters as the daemon does after a restart,
+    // so that the next unlock derives the keys with the calibrated cost.
+    KdfParametersStore store(TESTCASE_PATH, true);
+    MasterLockKdfParameters parameters;
+    QCOMPARE(store.readMasterLockParameters(&parameters), DataProtector::Success);
+    QVERIFY(parameters == calibrated);
+
+    // the parameters of the autotest mode are separate.
+    KdfParametersStore productionStore(TESTCASE_PATH, false);
+    QCOMPARE(productionStore.readMasterLockParameters(&parameters), DataProtector::Success);
+    QVERIFY(parameters == MasterLockKdfParameters::legacy());
+}
+
+void tst_kdfparameters::testMasterLock_invalidIgnored()
+{
+    KdfParametersStore store(TESTCASE_PATH, true);
+    QVERIFY(store.writeMasterLockParameters(MasterLockKdfParameters(0, 16000)));
+
+    MasterLockKdfParameters parameters;
+    QCOMPARE(store.readMasterLockParameters(&parameters), DataProtector::Success);
+    QVERIFY(parameters == MasterLockKdfParameters::legacy());
+}
+
+void tst_kdfparameters::testReplace_commitSucceeds_expectNewParameters()
+{
+    const MasterLockKdfParameters previous(8000, 10664);
+    const MasterLockKdfParameters calibrated(4000, 5332);
+    KdfParametersStore store(TESTCASE_PATH, true);
+    QVERIFY(store.writeMasterLockParameters(previous));
+
+    // the new parameters are stored before the data which depends upon them.
+    bool committed = false;
+    QVERIFY(store.replaceMasterLockParameters(calibrated, [&] {
+        MasterLockKdfParameters stored;
+        committed = store.readMasterLockParameters(&stored) == DataProtector::Success
+                && stored == calibrated;
+        return true;
+    }));
+    QVERIFY(committed);
+
+    MasterLockKdfParameters parameters;
+    QCOMPARE(KdfParametersStore(TESTCASE_PATH, true).readMasterLockParameters(&parameters), DataProtector::Success);
+    QVERIFY(parameters == calibrated);
+}
+
+void tst_kdfparameters::testReplace_commitFails_expectPreviousRestored()
+{
+    const MasterLockKdfParameters previous(8000, 10664);
+    const MasterLockKdfParameters calibrated(4000, 5332);
+    KdfParametersStore store(TESTCASE_PATH, true);
+    QVERIFY(store.writeMasterLockParameters(previous));
+
+    // e.g. the test cipher text could not be written.
+    QVERIFY(!store.replaceMasterLockParameters(calibrated, [] { return false; }));
+
+    MasterLockKdfParameters parameters;
+    QCOMPARE(KdfParametersStore(TESTCASE_PATH, true).readMasterLockParameters(&parameters), DataProtector::Success);
+    QVERIFY(parameters == previous);
+}
+
+void tst_kdfparameters::testReplace_writeFails_expectNoCommit()
+{
+    const MasterLockKdfParameters previous(8000, 10664);
+    const MasterLockKdfParameters calibrated(4000, 5332);
+    KdfParametersStore store(TESTCASE_PATH, true);
+    QVERIFY(store.writeMasterLockParameters(previous));
+
+    // make the next write fail, by occupying the path of the
+    // next generation of the protected data with a regular file.
+    QDir protectedRoot(QDir(TESTCASE_PATH).absoluteFilePath(QStringLiteral("kdfparameters-test")));
+    const QFileInfoList dataDirs = protectedRoot.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot);
+    QCOMPARE(dataDirs.size(), 1);
+    bool ok = false;
+    const quint64 generation = dataDirs.first().fileName().mid(4).toULongLong(&ok, 16);
+    QVERIFY(ok);
+    QFile blocker(protectedRoot.absoluteFilePath(QStringLiteral("gen-%1").arg(generation + 1, 16, 16, QLatin1Char('0'))));
+    QVERIFY(blocker.open(QIODevice::WriteOnly));
+    blocker.close();
+
+    // the data which depends upon the parameters must not be replaced.
+    bool committed = false;
+    QVERIFY(!store.replaceMasterLockParameters(calibrated, [&] {
+        committed = true;
+        return true;
+    }));
+    QVERIFY(!committed);
+
+    MasterLockKdfParameters parameters;
+    QCOMPARE(KdfParametersStore(TESTCASE_PATH, true).readMasterLockParameters(&parameters), DataProtector::Success);
+    QVERIFY(parameters == previous);
+}
+
+void tst_kdfparameters::testCollection_persistedAcrossRestart()
+{
+    QMap<QString, QVariantMap> parameters;
+    QCOMPARE(KdfParametersStore(TESTCASE_PATH, true).readCollectionParameters(&parameters), DataProtector::Success);
+    QVERIFY(parameters.isEmpty());
+
+    QVariantMap pbkdf2;
+    pbkdf2.insert(QStringLiteral("keyDerivationFunction"), QStringLiteral("pbkdf2"));
+    pbkdf2.insert(QStringLiteral("iterations"), 20000);
+    QMap<QString, QVariantMap> calibrated;
+    calibrated.insert(QStringLiteral("org.sailfishos.secrets.plugin.encryption.openssl.test"), pbkdf2);
+    // a plugin which only supports its default key derivation.
+    calibrated.insert(QStringLiteral("org.sailfishos.secrets.plugin.encryptedstorage.sqlcipher.test"), QVariantMap());
+    QVERIFY(KdfParametersStore(TESTCASE_PATH, true).writeCollectionParameters(calibrated));
+
+    QCOMPARE(KdfParametersStore(TESTCASE_PATH, true).readCollectionParameters(&parameters), DataProtector::Success);
+    QCOMPARE(parameters, calibrated);
+    QVERIFY(parameters.contains(QStringLiteral("org.sailfishos.secrets.plugin.encryptedstorage.sqlcipher.test")));
+    QVERIFY(!parameters.contains(QStringLiteral("org.sailfishos.secrets.plugin.encryptedstorage.inmemory.test")));
+}
+
+void tst_kdfparameters::testCollection_storedNextToMasterLock()
+{
+    KdfParametersStore store(TESTCASE_PATH, true);
+    QVERIFY(store.writeMasterLockParameters(MasterLockKdfParameters(4000, 5332)));
+    QMap<QString, QVariantMap> calibrated;
+    calibrated.insert(QStringLiteral("plugin"), QVariantMap());
+    QVERIFY(store.writeCollectionParameters(calibrated));
+
+    // writing the collection parameters leaves the master lock parameters intact.
+    MasterLockKdfParameters parameters;
+    QCOMPARE(store.readMasterLockParameters(&parameters), DataProtector::Success);
+    QVERIFY(parameters == MasterLockKdfParameters(4000, 5332));
+
+    QDir secretsDir(TESTCASE_PATH);
+    QVERIFY(secretsDir.exists(QStringLiteral("kdfparameters-test")));
+    QVERIFY(secretsDir.exists(QStringLiteral("collectionkdfparameters-test")));
+}
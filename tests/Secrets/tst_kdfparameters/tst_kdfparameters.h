@@ -0,0 +1,30 @@
+/*
+ * Copyright (C) 2018 Jolla Ltd.
+ * Contact: Chris Adams <chris.adams@jollamobile.com>
+ * All rights reserved.
+ * BSD 3-Clause License, see LICENSE.
+ */
+
+#include <QtTest>
+#include <QtCore/QObject>
+#include <QtCore/QString>
+
+class tst_kdfparameters : public QObject
+{
+    Q_OBJECT
+
+public slots:
+    void init();
+    void cleanup();
+
+private slots:
+    void testMasterLock_initiallyLegacy();
+    void testMasterLock_persistedAcrossRestart();
+    void testMasterLock_invalidIgnored();
+    void testReplace_commitSucceeds_expectNewParameters();
+    void testReplace_commitFails_expectPreviousRestored();
+    void testReplace_writeFails_expectNoCommit();
+    void testCollection_persistedAcrossRestart();
+    void testCollection_storedNextToMasterLock();
+
+};
@@ -0,0 +1,15 @@
+TEMPLATE = app
+TARGET = tst_kdfparameters
+target.path = /opt/tests/Sailfish/Secrets/
+QT += testlib
+INSTALLS += target
+
+HEADERS += \
+    $$PWD/../../../daemon/SecretsImpl/dataprotector_p.h \
+    $$PWD/../../../daemon/SecretsImpl/kdfparametersstore_p.h \
+    $$PWD/tst_kdfparameters.h
+
+SOURCES += \
+    $$PWD/../../../daemon/SecretsImpl/dataprotector.cpp \
+    $$PWD/../../../daemon/SecretsImpl/kdfparametersstore.cpp \
+    $$PWD/tst_kdfparameters.cpp
@@ -0,0 +1,264 @@
+/*
+ * Copyright (C) 2018 Jolla Ltd.
+ * Contact: Chris Adams <chris.adams@jollamobile.com>
+ * All rights reserved.
+ * BSD 3-Clause License, see LICENSE.
+ */
+
+#include <QtTest>
+#include <QObject>
+#include <QJsonArray>
+#include <QJsonObject>
+
+#include "../../../daemon/plugincallstatistics_p.h"
+#include "../../../daemon/requeststatistics_p.h"
+
+using namespace Sailfish::Secrets::Daemon::ApiImpl;
+
+namespace {
+    class TestPlugin : public Sailfish::Secrets::PluginBase
+    {
+    public:
+        TestPlugin(const QString &name) : m_name(name) {}
+        QString displayName() const Q_DECL_OVERRIDE { return m_name; }
+        QString name() const Q_DECL_OVERRIDE { return m_name; }
+        int version() const Q_DECL_OVERRIDE { return 1; }
+    private:
+        QString m_name;
+    };
+
+    QJsonObject operationStatistics(const QString &pluginName, const QString &operation)
+    {
+        return PluginCallStatistics::instance()->toJson()
+                .value(QStringLiteral("plugins")).toObject()
+                .value(pluginName).toObject()
+                .value(operation).toObject();
+    }
+}
+
+// Tests the request and plugin call statistics of the daemon in isolation.
+// The end-to-end collection of the statistics is tested by tst_startup.
+class tst_requeststatistics : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void bucketIndex_data();
+    void bucketIndex();
+    void bucketBounds();
+    void percentiles();
+    void emptyHistogram();
+    void requestCounters();
+    void pluginCallCounters();
+    void pluginCallScope();
+};
+
+void tst_requeststatistics::bucketIndex_data()
+{
+    QTest::addColumn<quint64>("usecs");
+    QTest::addColumn<int>("index");
+    QTest::addColumn<quint64>("upperBound");
+
+    // Values below SubBucketCount have a bucket of their own.
+    QTest::newRow("0") << Q_UINT64_C(0) << 0 << Q_UINT64_C(0);
+    QTest::newRow("3") << Q_UINT64_C(3) << 3 << Q_UINT64_C(3);
+    // The first magnitude still has a bucket width of one.
+    QTest::newRow("4") << Q_UINT64_C(4) << 4 << Q_UINT64_C(4);
+    QTest::newRow("7") << Q_UINT64_C(7) << 7 << Q_UINT64_C(7);
+    // Above that, each magnitude is split into four buckets.
+    QTest::newRow("8") << Q_UINT64_C(8) << 8 << Q_UINT64_C(9);
+    QTest::newRow("9") << Q_UINT64_C(9) << 8 << Q_UINT64_C(9);
+    QTest::newRow("10") << Q_UINT64_C(10) << 9 << Q_UINT64_C(11);
+    QTest::newRow("15") << Q_UINT64_C(15) << 11 << Q_UINT64_C(15);
+    QTest::newRow("16") << Q_UINT64_C(16) << 12 << Q_UINT64_C(19);
+    QTest::newRow("1023") << Q_UINT64_C(1023) << 35 << Q_UINT64_C(1023);
+    QTest::newRow("1024") << Q_UINT64_C(1024) << 36 << Q_UINT64_C(1279);
+    // The last magnitude, and anything beyond it, ends up in the last bucket.
+    QTest::newRow("2^31") << (Q_UINT64_C(1) << 31) << int(LatencyHistogram::BucketCount) - 4 << Q_UINT64_C(2684354559);
+    QTest::newRow("2^32-1") << (Q_UINT64_C(1) << 32) - 1 << int(LatencyHistogram::BucketCount) - 1 << (Q_UINT64_C(1) << 32) - 1;
+    QTest::newRow("2^40") << (Q_UINT64_C(1) << 40) << int(LatencyHistogram::BucketCount) - 1 << (Q_UINT64_C(1) << 32) - 1;
+}
+
+void tst_requeststatistics::bucketIndex()
+{
+    QFETCH(quint64, usecs);
+    QFETCH(int, index);
+    QFETCH(quint64, upperBound);
+
+    QCOMPARE(LatencyHistogram::bucketIndex(usecs), index);
+    QCOMPARE(LatencyHistogram::bucketUpperBound(index), upperBound);
+}
+
+void tst_requeststatistics::bucketBounds()
+{
+    // Every value falls into the bucket whose range contains it, and
+    // the upper bound of that bucket is within 1 / SubBucketCount of it.
+    int previousIndex = 0;
+    for (quint64 usecs = 0; usecs < (Q_UINT64_C(1) << 20); usecs += 1 + usecs / 64) {
+        const int index = LatencyHistogram::bucketIndex(usecs);
+        QVERIFY(index >= previousIndex);
+        QVERIFY(LatencyHistogram::bucketUpperBound(index) >= usecs);
+        if (index > 0) {
+            QVERIFY(LatencyHistogram::bucketUpperBound(index - 1) < usecs);
+        }
+        QVERIFY(double(LatencyHistogram::bucketUpperBound(index) - usecs)
+                <= double(usecs) / LatencyHistogram::SubBucketCount);
+        previousIndex = index;
+    }
+}
+
+void tst_requeststatistics::percentiles()
+{
+    LatencyHistogram histogram;
+    for (int usecs = 1; usecs <= 100; ++usecs) {
+        histogram.record(usecs);
+    }
+
+    QCOMPARE(histogram.count(), Q_UINT64_C(100));
+    QCOMPARE(histogram.sum(), Q_UINT64_C(5050));
+    QCOMPARE(histogram.max(), Q_UINT64_C(100));
+
+    // The estimate is the upper bound of the bucket containing
+    // the requested rank, capped at the maximum recorded value.
+    QCOMPARE(histogram.percentile(0.0), Q_UINT64_C(1));
+    QCOMPARE(histogram.percentile(0.50), Q_UINT64_C(55));
+    QCOMPARE(histogram.percentile(0.90), Q_UINT64_C(95));
+    QCOMPARE(histogram.percentile(0.99), Q_UINT64_C(100));
+    QCOMPARE(histogram.percentile(1.0), Q_UINT64_C(100));
+
+    const QJsonObject json = histogram.toJson();
+    QCOMPARE(json.value(QStringLiteral("count")).toDouble(), 100.0);
+    QCOMPARE(json.value(QStringLiteral("meanUsecs")).toDouble(), 50.5);
+    QCOMPARE(json.value(QStringLiteral("p50Usecs")).toDouble(), 55.0);
+    QCOMPARE(json.value(QStringLiteral("p90Usecs")).toDouble(), 95.0);
+    QCOMPARE(json.value(QStringLiteral("p99Usecs")).toDouble(), 100.0);
+
+    double bucketTotal = 0;
+    double previousUpperBound = -1;
+    for (const QJsonValue &value : json.value(QStringLiteral("buckets")).toArray()) {
+        const QJsonArray bucket = value.toArray();
+        QVERIFY(bucket.at(0).toDouble() > previousUpperBound);
+        previousUpperBound = bucket.at(0).toDouble();
+        bucketTotal += bucket.at(1).toDouble();
+    }
+    QCOMPARE(bucketTotal, 100.0);
+}
+
+void tst_requeststatistics::emptyHistogram()
+{
+    LatencyHistogram histogram;
+    QCOMPARE(histogram.count(), Q_UINT64_C(0));
+    QCOMPARE(histogram.percentile(0.5), Q_UINT64_C(0));
+    QCOMPARE(histogram.toJson().value(QStringLiteral("meanUsecs")).toDouble(), 0.0);
+    QVERIFY(histogram.toJson().value(QStringLiteral("buckets")).toArray().isEmpty());
+
+    // Negative durations (e.g. from an unset start time) are clamped to zero.
+    histogram.record(-5);
+    QCOMPARE(histogram.count(), Q_UINT64_C(1));
+    QCOMPARE(histogram.sum(), Q_UINT64_C(0));
+    QCOMPARE(histogram.percentile(1.0), Q_UINT64_C(0));
+}
+
+void tst_requeststatistics::requestCounters()
+{
+    RequestStatistics statistics;
+    statistics.requestEnqueued(3);
+    statistics.requestEnqueued(3);
+    statistics.requestRejected(3);
+    statistics.requestCompleted(3, 1000, 2000, 3000, 7000000);
+    // Out of range request types are ignored.
+    statistics.requestEnqueued(-1);
+    statistics.requestEnqueued(RequestStatistics::MaximumRequestTypes);
+
+    const QJsonObject json = statistics.toJson([] (int type) {
+        return QStringLiteral("Type%1").arg(type);
+    });
+    QCOMPARE(json.keys(), QStringList() << QStringLiteral("Type3"));
+
+    const QJsonObject type = json.value(QStringLiteral("Type3")).toObject();
+    QCOMPARE(type.value(QStringLiteral("enqueued")).toDouble(), 2.0);
+    QCOMPARE(type.value(QStringLiteral("rejected")).toDouble(), 1.0);
+    QCOMPARE(type.value(QStringLiteral("completed")).toDouble(), 1.0);
+
+    const QStringList phases {
+        RequestStatistics::phaseToString(RequestStatistics::QueueWaitPhase),
+        RequestStatistics::phaseToString(RequestStatistics::ProcessingPhase),
+        RequestStatistics::phaseToString(RequestStatistics::PluginExecutionPhase),
+        RequestStatistics::phaseToString(RequestStatistics::TotalPhase)
+    };
+    const QList<double> maxUsecs { 1.0, 2.0, 3.0, 7000.0 };
+    for (int i = 0; i < phases.size(); ++i) {
+        const QJsonObject phase = type.value(phases.at(i)).toObject();
+        QCOMPARE(phase.value(QStringLiteral("count")).toDouble(), 1.0);
+        QCOMPARE(phase.value(QStringLiteral("maxUsecs")).toDouble(), maxUsecs.at(i));
+    }
+}
+
+void tst_requeststatistics::pluginCallCounters()
+{
+    const QString pluginName = QStringLiteral("tst_requeststatistics.counters");
+    PluginCallStatistics *statistics = PluginCallStatistics::instance();
+    statistics->record(pluginName, "read", false, 10, 100, 5000, 2000);
+    statistics->record(pluginName, "read", true, 20, 0, 15000, 0);
+    statistics->record(pluginName, "write", false, -1, -1, 1000, -1);
+
+    const QJsonObject read = operationStatistics(pluginName, QStringLiteral("read"));
+    QCOMPARE(read.value(QStringLiteral("calls")).toDouble(), 2.0);
+    QCOMPARE(read.value(QStringLiteral("errors")).toDouble(), 1.0);
+    QCOMPARE(read.value(QStringLiteral("bytesIn")).toDouble(), 30.0);
+    QCOMPARE(read.value(QStringLiteral("bytesOut")).toDouble(), 100.0);
+    QCOMPARE(read.value(QStringLiteral("cpuUsecs")).toDouble(), 2.0);
+    const QJsonObject wallTime = read.value(QStringLiteral("wallTime")).toObject();
+    QCOMPARE(wallTime.value(QStringLiteral("count")).toDouble(), 2.0);
+    QCOMPARE(wallTime.value(QStringLiteral("sumUsecs")).toDouble(), 20.0);
+    QCOMPARE(wallTime.value(QStringLiteral("maxUsecs")).toDouble(), 15.0);
+
+    // Negative byte counts and CPU times are not accumulated.
+    const QJsonObject write = operationStatistics(pluginName, QStringLiteral("write"));
+    QCOMPARE(write.value(QStringLiteral("calls")).toDouble(), 1.0);
+    QCOMPARE(write.value(QStringLiteral("errors")).toDouble(), 0.0);
+    QCOMPARE(write.value(QStringLiteral("bytesIn")).toDouble(), 0.0);
+    QCOMPARE(write.value(QStringLiteral("bytesOut")).toDouble(), 0.0);
+    QCOMPARE(write.value(QStringLiteral("cpuUsecs")).toDouble(), 0.0);
+}
+
+void tst_requeststatistics::pluginCallScope()
+{
+    const TestPlugin plugin(QStringLiteral("tst_requeststatistics.scope"));
+    const bool wasEnabled = PluginCallStatistics::isEnabled();
+
+    PluginCallStatistics::setEnabled(false);
+    QCOMPARE(PluginCallStatistics::instance()->toJson().value(QStringLiteral("enabled")).toBool(), false);
+    {
+        PluginCallScope scope(&plugin, "operation", 8);
+        scope.result(true);
+    }
+    QVERIFY(operationStatistics(plugin.name(), QStringLiteral("operation")).isEmpty());
+
+    PluginCallStatistics::setEnabled(true);
+    QCOMPARE(PluginCallStatistics::instance()->toJson().value(QStringLiteral("enabled")).toBool(), true);
+    {
+        PluginCallScope scope(&plugin, "operation", 8);
+        scope.setBytesOut(16);
+        scope.result(true);
+    }
+    {
+        PluginCallScope scope(&plugin, "operation");
+        scope.result(false);
+    }
+    {
+        PluginCallScope scope(&plugin, "operation");
+        scope.result(Sailfish::Secrets::Result(Sailfish::Secrets::Result::Failed));
+    }
+    PluginCallStatistics::setEnabled(wasEnabled);
+
+    const QJsonObject operation = operationStatistics(plugin.name(), QStringLiteral("operation"));
+    QCOMPARE(operation.value(QStringLiteral("calls")).toDouble(), 3.0);
+    QCOMPARE(operation.value(QStringLiteral("errors")).toDouble(), 2.0);
+    QCOMPARE(operation.value(QStringLiteral("bytesIn")).toDouble(), 8.0);
+    QCOMPARE(operation.value(QStringLiteral("bytesOut")).toDouble(), 16.0);
+    QCOMPARE(operation.value(QStringLiteral("wallTime")).toObject().value(QStringLiteral("count")).toDouble(), 3.0);
+}
+
+#include "tst_requeststatistics.moc"
+QTEST_MAIN(tst_requeststatistics)
@@ -0,0 +1,18 @@
+TEMPLATE = app
+TARGET = tst_requeststatistics
+target.path = /opt/tests/Sailfish/Secrets/
+include($$PWD/../../../lib/libsailfishsecretspluginapi.pri)
+include($$PWD/../../../lib/libsailfishcrypto.pri)
+QT += testlib concurrent
+INSTALLS += target
+
+HEADERS += \
+    $$PWD/../../../daemon/plugincallstatistics_p.h \
+    $$PWD/../../../daemon/requeststatistics_p.h \
+    $$PWD/../../../daemon/requesttracer_p.h
+
+SOURCES += \
+    $$PWD/../../../daemon/plugincallstatistics.cpp \
+    $$PWD/../../../daemon/requeststatistics.cpp \
+    $$PWD/../../../daemon/requesttracer.cpp \
+    $$PWD/tst_requeststatistics.cpp
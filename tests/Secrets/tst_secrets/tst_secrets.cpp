@@ -140,6 +140,7 @@ void tst_secrets::devicelockCollectionSecret()
                 SecretManager::DefaultStoragePluginName + QLatin1String(".test"),
                 filter,
                 SecretManager::OperatorAnd,
+                SecretManager::MatchExact,
                 SecretManager::PreventInteraction);
     filterReply.waitForFinished();
     QVERIFY(filterReply.isValid());
@@ -154,6 +155,7 @@ void tst_secrets::devicelockCollectionSecret()
                 SecretManager::DefaultStoragePluginName + QLatin1String(".test"),
                 filter,
                 SecretManager::OperatorAnd,
+                SecretManager::MatchExact,
                 SecretManager::PreventInteraction);
     filterReply.waitForFinished();
     QVERIFY(filterReply.isValid());
@@ -166,6 +168,7 @@ void tst_secrets::devicelockCollectionSecret()
                 SecretManager::DefaultStoragePluginName + QLatin1String(".test"),
                 filter,
                 SecretManager::OperatorOr,
+                SecretManager::MatchExact,
                 SecretManager::PreventInteraction);
     filterReply.waitForFinished();
     QVERIFY(filterReply.isValid());
@@ -180,6 +183,7 @@ void tst_secrets::devicelockCollectionSecret()
                 SecretManager::DefaultStoragePluginName + QLatin1String(".test"),
                 filter,
                 SecretManager::OperatorOr,
+                SecretManager::MatchExact,
                 SecretManager::PreventInteraction);
     filterReply.waitForFinished();
     QVERIFY(filterReply.isValid());
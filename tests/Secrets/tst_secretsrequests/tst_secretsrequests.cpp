@@ -32,6 +32,7 @@ using namespace Sailfish::Secrets;
 #define DEFAULT_TEST_ENCRYPTION_PLUGIN SecretManager::DefaultEncryptionPluginName + QLatin1String(".test")
 #define DEFAULT_TEST_ENCRYPTEDSTORAGE_PLUGIN SecretManager::DefaultEncryptedStoragePluginName + QLatin1String(".test")
 #define IN_APP_TEST_AUTHENTICATION_PLUGIN SecretManager::InAppAuthenticationPluginName + QLatin1String(".test")
+#define IN_MEMORY_TEST_ENCRYPTEDSTORAGE_PLUGIN QLatin1String("org.sailfishos.secrets.plugin.encryptedstorage.inmemory.test")
 
 // Cannot use waitForFinished() for some replies, as ui flows require user interaction / event handling.
 #define WAIT_FOR_FINISHED_WITHOUT_BLOCKING(request)                     \
@@ -63,6 +64,8 @@ private slots:
     void customlockStandaloneSecret();
 
     void encryptedStorageCollection();
+    void inMemoryCollection();
+    void findSecretsInCollections();
 
     void storeUserSecret();
 
@@ -290,6 +293,20 @@ void tst_secretsrequests::devicelockCollectionSecret()
     QCOMPARE(gsr.secret().name(), testSecret.name());
     QCOMPARE(gsr.secret().collectionName(), testSecret.collectionName());
 
+    // retrieve only the metadata of the secret, ensure no secret data is returned
+    QCOMPARE(gsr.metadataOnly(), false);
+    gsr.setMetadataOnly(true);
+    QCOMPARE(gsr.metadataOnly(), true);
+    gsr.startRequest();
+    WAIT_FOR_FINISHED_WITHOUT_BLOCKING(gsr);
+    QCOMPARE(gsr.status(), Request::Finished);
+    QCOMPARE(gsr.result().code(), Result::Succeeded);
+    QVERIFY(gsr.secret().data().isEmpty());
+    QCOMPARE(gsr.secret().type(), testSecret.type());
+    QCOMPARE(gsr.secret().filterData(), testSecret.filterData());
+    QCOMPARE(gsr.secret().identifier(), testSecret.identifier());
+    gsr.setMetadataOnly(false);
+
     // test filtering, first with AND with both matching metadata field values, expect match
     Secret::FilterData filter;
     filter.insert(QLatin1String("domain"), testSecret.filterData(QLatin1String("domain")));
@@ -347,6 +364,103 @@ void tst_secretsrequests::devicelockCollectionSecret()
     QCOMPARE(fsr.result().code(), Result::Succeeded);
     QCOMPARE(fsr.identifiers().size(), 0);
 
+    // test prefix filtering with AND with both values prefixes of the metadata, expect match
+    QCOMPARE(fsr.filterMatch(), SecretManager::MatchExact);
+    filter.clear();
+    filter.insert(QLatin1String("domain"), QLatin1String("SAILFISH"));
+    filter.insert(QLatin1String("test"), QLatin1String("tr"));
+    fsr.setFilter(filter);
+    fsr.setFilterOperator(SecretManager::OperatorAnd);
+    fsr.setFilterMatch(SecretManager::MatchPrefix);
+    QCOMPARE(fsr.filterMatch(), SecretManager::MatchPrefix);
+    fsr.startRequest();
+    WAIT_FOR_FINISHED_WITHOUT_BLOCKING(fsr);
+    QCOMPARE(fsr.status(), Request::Finished);
+    QCOMPARE(fsr.result().code(), Result::Succeeded);
+    QCOMPARE(fsr.identifiers().size(), 1);
+    QCOMPARE(fsr.identifiers().at(0), testSecret.identifier());
+
+    // the same filter with exact matching, expect no-match
+    fsr.setFilterMatch(SecretManager::MatchExact);
+    fsr.startRequest();
+    WAIT_FOR_FINISHED_WITHOUT_BLOCKING(fsr);
+    QCOMPARE(fsr.status(), Request::Finished);
+    QCOMPARE(fsr.result().code(), Result::Succeeded);
+    QCOMPARE(fsr.identifiers().size(), 0);
+
+    // test glob filtering, expect match only if the pattern matches the whole value
+    filter.clear();
+    filter.insert(QLatin1String("domain"), QLatin1String("*.ORG"));
+    fsr.setFilter(filter);
+    fsr.setFilterMatch(SecretManager::MatchGlob);
+    fsr.startRequest();
+    WAIT_FOR_FINISHED_WITHOUT_BLOCKING(fsr);
+    QCOMPARE(fsr.status(), Request::Finished);
+    QCOMPARE(fsr.result().code(), Result::Succeeded);
+    QCOMPARE(fsr.identifiers().size(), 1);
+    QCOMPARE(fsr.identifiers().at(0), testSecret.identifier());
+
+    filter.insert(QLatin1String("domain"), QLatin1String("sailfish*.com"));
+    fsr.setFilter(filter);
+    fsr.startRequest();
+    WAIT_FOR_FINISHED_WITHOUT_BLOCKING(fsr);
+    QCOMPARE(fsr.status(), Request::Finished);
+    QCOMPARE(fsr.result().code(), Result::Succeeded);
+    QCOMPARE(fsr.identifiers().size(), 0);
+
+    // test full-text filtering, expect match only if every word occurs in the value
+    filter.insert(QLatin1String("domain"), QLatin1String("org sailfishos"));
+    fsr.setFilter(filter);
+    fsr.setFilterMatch(SecretManager::MatchFullText);
+    fsr.startRequest();
+    WAIT_FOR_FINISHED_WITHOUT_BLOCKING(fsr);
+    QCOMPARE(fsr.status(), Request::Finished);
+    QCOMPARE(fsr.result().code(), Result::Succeeded);
+    QCOMPARE(fsr.identifiers().size(), 1);
+    QCOMPARE(fsr.identifiers().at(0), testSecret.identifier());
+
+    filter.insert(QLatin1String("domain"), QLatin1String("sailfish org"));
+    fsr.setFilter(filter);
+    fsr.startRequest();
+    WAIT_FOR_FINISHED_WITHOUT_BLOCKING(fsr);
+    QCOMPARE(fsr.status(), Request::Finished);
+    QCOMPARE(fsr.result().code(), Result::Succeeded);
+    QCOMPARE(fsr.identifiers().size(), 0);
+    fsr.setFilterMatch(SecretManager::MatchExact);
+
+    // search every collection of the storage plugin, expect match
+    filter.clear();
+    filter.insert(QLatin1String("domain"), testSecret.filterData(QLatin1String("domain")));
+    fsr.setFilter(filter);
+    QCOMPARE(fsr.searchScope(), FindSecretsRequest::CollectionSearch);
+    fsr.setSearchScope(FindSecretsRequest::StoragePluginSearch);
+    QCOMPARE(fsr.searchScope(), FindSecretsRequest::StoragePluginSearch);
+    fsr.startRequest();
+    WAIT_FOR_FINISHED_WITHOUT_BLOCKING(fsr);
+    QCOMPARE(fsr.status(), Request::Finished);
+    QCOMPARE(fsr.result().code(), Result::Succeeded);
+    QVERIFY(fsr.identifiers().contains(testSecret.identifier()));
+    QCOMPARE(fsr.skippedCollections().size(), fsr.skippedCollectionResults().size());
+
+    // search every collection of every storage plugin, expect match
+    fsr.setSearchScope(FindSecretsRequest::AllStoragePluginsSearch);
+    fsr.startRequest();
+    WAIT_FOR_FINISHED_WITHOUT_BLOCKING(fsr);
+    QCOMPARE(fsr.status(), Request::Finished);
+    QCOMPARE(fsr.result().code(), Result::Succeeded);
+    QVERIFY(fsr.identifiers().contains(testSecret.identifier()));
+    QCOMPARE(fsr.skippedCollections().size(), fsr.skippedCollectionResults().size());
+
+    // a plugin-wide search requires a storage plugin name
+    fsr.setSearchScope(FindSecretsRequest::StoragePluginSearch);
+    fsr.setStoragePluginName(QString());
+    fsr.startRequest();
+    QCOMPARE(fsr.status(), Request::Finished);
+    QCOMPARE(fsr.result().code(), Result::Failed);
+    QCOMPARE(fsr.result().errorCode(), Result::InvalidExtensionPluginError);
+    fsr.setStoragePluginName(DEFAULT_TEST_STORAGE_PLUGIN);
+    fsr.setSearchScope(FindSecretsRequest::CollectionSearch);
+
     // delete the secret
     DeleteSecretRequest dsr;
     dsr.setManager(&sm);
@@ -894,6 +1008,329 @@ void tst_secretsrequests::encryptedStorageCollection()
     QCOMPARE(dcr.result().code(), Result::Succeeded);
 }
 
+void tst_secretsrequests::inMemoryCollection()
+{
+    // construct the in-process authentication key UI.
+    QQuickView v(QUrl::fromLocalFile(QStringLiteral("%1/tst_secretsrequests.qml").arg(QCoreApplication::applicationDirPath())));
+    v.show();
+    QObject *interactionView = v.rootObject()->findChild<QObject*>("interactionview");
+    QVERIFY(interactionView);
+    QMetaObject::invokeMethod(interactionView, "setSecretManager", Qt::DirectConnection, Q_ARG(QObject*, &sm));
+
+    // create a new custom-lock collection stored in the in-memory plugin.
+    // use the AccessRelock semantic so that every access has to unlock it.
+    CreateCollectionRequest ccr;
+    ccr.setManager(&sm);
+    QSignalSpy ccrss(&ccr, &CreateCollectionRequest::statusChanged);
+    ccr.setCollectionLockType(CreateCollectionRequest::CustomLock);
+    QCOMPARE(ccr.collectionLockType(), CreateCollectionRequest::CustomLock);
+    ccr.setCollectionName(QLatin1String("testinmemorycollection"));
+    QCOMPARE(ccr.collectionName(), QLatin1String("testinmemorycollection"));
+    ccr.setStoragePluginName(IN_MEMORY_TEST_ENCRYPTEDSTORAGE_PLUGIN);
+    QCOMPARE(ccr.storagePluginName(), IN_MEMORY_TEST_ENCRYPTEDSTORAGE_PLUGIN);
+    ccr.setEncryptionPluginName(IN_MEMORY_TEST_ENCRYPTEDSTORAGE_PLUGIN);
+    QCOMPARE(ccr.encryptionPluginName(), IN_MEMORY_TEST_ENCRYPTEDSTORAGE_PLUGIN);
+    ccr.setAuthenticationPluginName(IN_APP_TEST_AUTHENTICATION_PLUGIN);
+    QCOMPARE(ccr.authenticationPluginName(), IN_APP_TEST_AUTHENTICATION_PLUGIN);
+    ccr.setCustomLockUnlockSemantic(SecretManager::CustomLockAccessRelock);
+    QCOMPARE(ccr.customLockUnlockSemantic(), SecretManager::CustomLockAccessRelock);
+    ccr.setAccessControlMode(SecretManager::OwnerOnlyMode);
+    QCOMPARE(ccr.accessControlMode(), SecretManager::OwnerOnlyMode);
+    ccr.setUserInteractionMode(SecretManager::ApplicationInteraction);
+    QCOMPARE(ccr.userInteractionMode(), SecretManager::ApplicationInteraction);
+    QCOMPARE(ccr.status(), Request::Inactive);
+    ccr.startRequest();
+    QCOMPARE(ccrss.count(), 1);
+    QCOMPARE(ccr.status(), Request::Active);
+    QCOMPARE(ccr.result().code(), Result::Pending);
+    WAIT_FOR_FINISHED_WITHOUT_BLOCKING(ccr);
+    QCOMPARE(ccrss.count(), 2);
+    QCOMPARE(ccr.status(), Request::Finished);
+    QCOMPARE(ccr.result().code(), Result::Succeeded);
+
+    // ensure that the collection is reported, and that it is locked
+    CollectionNamesRequest cnr;
+    cnr.setManager(&sm);
+    cnr.setStoragePluginName(IN_MEMORY_TEST_ENCRYPTEDSTORAGE_PLUGIN);
+    QCOMPARE(cnr.status(), Request::Inactive);
+    cnr.startRequest();
+    QCOMPARE(cnr.status(), Request::Active);
+    QCOMPARE(cnr.result().code(), Result::Pending);
+    WAIT_FOR_FINISHED_WITHOUT_BLOCKING(cnr);
+    QCOMPARE(cnr.status(), Request::Finished);
+    QCOMPARE(cnr.result().code(), Result::Succeeded);
+    QCOMPARE(cnr.collectionNames(), QStringList() << QLatin1String("testinmemorycollection"));
+    QCOMPARE(cnr.isCollectionLocked(QLatin1String("testinmemorycollection")), true);
+
+    // store a secret into the collection
+    Secret testSecret(
+                Secret::Identifier(
+                    QLatin1String("testsecretname"),
+                    QLatin1String("testinmemorycollection"),
+                    IN_MEMORY_TEST_ENCRYPTEDSTORAGE_PLUGIN));
+    testSecret.setData("testsecretvalue");
+    testSecret.setType(Secret::TypeBlob);
+    testSecret.setFilterData(QLatin1String("domain"), QLatin1String("sailfishos.org"));
+    testSecret.setFilterData(QLatin1String("test"), QLatin1String("true"));
+
+    StoreSecretRequest ssr;
+    ssr.setManager(&sm);
+    QSignalSpy ssrss(&ssr, &StoreSecretRequest::statusChanged);
+    ssr.setSecretStorageType(StoreSecretRequest::CollectionSecret);
+    QCOMPARE(ssr.secretStorageType(), StoreSecretRequest::CollectionSecret);
+    ssr.setUserInteractionMode(SecretManager::ApplicationInteraction);
+    QCOMPARE(ssr.userInteractionMode(), SecretManager::ApplicationInteraction);
+    ssr.setSecret(testSecret);
+    QCOMPARE(ssr.secret(), testSecret);
+    QCOMPARE(ssr.status(), Request::Inactive);
+    ssr.startRequest();
+    QCOMPARE(ssrss.count(), 1);
+    QCOMPARE(ssr.status(), Request::Active);
+    QCOMPARE(ssr.result().code(), Result::Pending);
+    WAIT_FOR_FINISHED_WITHOUT_BLOCKING(ssr);
+    QCOMPARE(ssrss.count(), 2);
+    QCOMPARE(ssr.status(), Request::Finished);
+    QCOMPARE(ssr.result().code(), Result::Succeeded);
+
+    // the collection should have been relocked after the access
+    cnr.startRequest();
+    WAIT_FOR_FINISHED_WITHOUT_BLOCKING(cnr);
+    QCOMPARE(cnr.result().code(), Result::Succeeded);
+    QCOMPARE(cnr.isCollectionLocked(QLatin1String("testinmemorycollection")), true);
+
+    // retrieve the secret, ensure it matches
+    StoredSecretRequest gsr;
+    gsr.setManager(&sm);
+    QSignalSpy gsrss(&gsr, &StoredSecretRequest::statusChanged);
+    gsr.setIdentifier(testSecret.identifier());
+    QCOMPARE(gsr.identifier(), testSecret.identifier());
+    gsr.setUserInteractionMode(SecretManager::ApplicationInteraction);
+    QCOMPARE(gsr.userInteractionMode(), SecretManager::ApplicationInteraction);
+    QCOMPARE(gsr.status(), Request::Inactive);
+    gsr.startRequest();
+    QCOMPARE(gsrss.count(), 1);
+    QCOMPARE(gsr.status(), Request::Active);
+    QCOMPARE(gsr.result().code(), Result::Pending);
+    WAIT_FOR_FINISHED_WITHOUT_BLOCKING(gsr);
+    QCOMPARE(gsrss.count(), 2);
+    QCOMPARE(gsr.status(), Request::Finished);
+    QCOMPARE(gsr.result().code(), Result::Succeeded);
+    QCOMPARE(gsr.secret().data(), testSecret.data());
+
+    // delete the secret
+    DeleteSecretRequest dsr;
+    dsr.setManager(&sm);
+    QSignalSpy dsrss(&dsr, &DeleteSecretRequest::statusChanged);
+    dsr.setIdentifier(testSecret.identifier());
+    QCOMPARE(dsr.identifier(), testSecret.identifier());
+    dsr.setUserInteractionMode(SecretManager::ApplicationInteraction);
+    QCOMPARE(dsr.userInteractionMode(), SecretManager::ApplicationInteraction);
+    QCOMPARE(dsr.status(), Request::Inactive);
+    dsr.startRequest();
+    QCOMPARE(dsrss.count(), 1);
+    QCOMPARE(dsr.status(), Request::Active);
+    QCOMPARE(dsr.result().code(), Result::Pending);
+    WAIT_FOR_FINISHED_WITHOUT_BLOCKING(dsr);
+    QCOMPARE(dsrss.count(), 2);
+    QCOMPARE(dsr.status(), Request::Finished);
+    QCOMPARE(dsr.result().code(), Result::Succeeded);
+
+    // ensure that the delete worked properly.
+    gsr.startRequest();
+    WAIT_FOR_FINISHED_WITHOUT_BLOCKING(gsr);
+    QCOMPARE(gsr.result().code(), Result::Failed);
+
+    // finally, clean up the collection
+    DeleteCollectionRequest dcr;
+    dcr.setManager(&sm);
+    QSignalSpy dcrss(&dcr, &DeleteCollectionRequest::statusChanged);
+    dcr.setCollectionName(QLatin1String("testinmemorycollection"));
+    QCOMPARE(dcr.collectionName(), QLatin1String("testinmemorycollection"));
+    dcr.setStoragePluginName(IN_MEMORY_TEST_ENCRYPTEDSTORAGE_PLUGIN);
+    QCOMPARE(dcr.storagePluginName(), IN_MEMORY_TEST_ENCRYPTEDSTORAGE_PLUGIN);
+    dcr.setUserInteractionMode(SecretManager::ApplicationInteraction);
+    QCOMPARE(dcr.userInteractionMode(), SecretManager::ApplicationInteraction);
+    QCOMPARE(dcr.status(), Request::Inactive);
+    dcr.startRequest();
+    QCOMPARE(dcrss.count(), 1);
+    QCOMPARE(dcr.status(), Request::Active);
+    QCOMPARE(dcr.result().code(), Result::Pending);
+    WAIT_FOR_FINISHED_WITHOUT_BLOCKING(dcr);
+    QCOMPARE(dcrss.count(), 2);
+    QCOMPARE(dcr.status(), Request::Finished);
+    QCOMPARE(dcr.result().code(), Result::Succeeded);
+
+    // ensure that the collection is no longer returned.
+    cnr.startRequest();
+    WAIT_FOR_FINISHED_WITHOUT_BLOCKING(cnr);
+    QCOMPARE(cnr.result().code(), Result::Succeeded);
+    QVERIFY(cnr.collectionNames().isEmpty());
+}
+
+void tst_secretsrequests::findSecretsInCollections()
+{
+    // construct the in-process authentication key UI.
+    QQuickView v(QUrl::fromLocalFile(QStringLiteral("%1/tst_secretsrequests.qml").arg(QCoreApplication::applicationDirPath())));
+    v.show();
+    QObject *interactionView = v.rootObject()->findChild<QObject*>("interactionview");
+    QVERIFY(interactionView);
+    QMetaObject::invokeMethod(interactionView, "setSecretManager", Qt::DirectConnection, Q_ARG(QObject*, &sm));
+
+    // create an unlocked collection in the storage plugin, an unlocked
+    // collection in the encrypted storage plugin, and a collection in the
+    // encrypted storage plugin which is relocked after every access.
+    CreateCollectionRequest ccr;
+    ccr.setManager(&sm);
+    ccr.setCollectionLockType(CreateCollectionRequest::DeviceLock);
+    ccr.setCollectionName(QLatin1String("testsearchcollection"));
+    ccr.setStoragePluginName(DEFAULT_TEST_STORAGE_PLUGIN);
+    ccr.setEncryptionPluginName(DEFAULT_TEST_ENCRYPTION_PLUGIN);
+    ccr.setDeviceLockUnlockSemantic(SecretManager::DeviceLockKeepUnlocked);
+    ccr.setAccessControlMode(SecretManager::OwnerOnlyMode);
+    ccr.startRequest();
+    WAIT_FOR_FINISHED_WITHOUT_BLOCKING(ccr);
+    QCOMPARE(ccr.status(), Request::Finished);
+    QCOMPARE(ccr.result().code(), Result::Succeeded);
+
+    ccr.setCollectionLockType(CreateCollectionRequest::CustomLock);
+    ccr.setCollectionName(QLatin1String("testsearchencrypted"));
+    ccr.setStoragePluginName(DEFAULT_TEST_ENCRYPTEDSTORAGE_PLUGIN);
+    ccr.setEncryptionPluginName(DEFAULT_TEST_ENCRYPTEDSTORAGE_PLUGIN);
+    ccr.setAuthenticationPluginName(IN_APP_TEST_AUTHENTICATION_PLUGIN);
+    ccr.setCustomLockUnlockSemantic(SecretManager::CustomLockKeepUnlocked);
+    ccr.setUserInteractionMode(SecretManager::ApplicationInteraction);
+    ccr.startRequest();
+    WAIT_FOR_FINISHED_WITHOUT_BLOCKING(ccr);
+    QCOMPARE(ccr.status(), Request::Finished);
+    QCOMPARE(ccr.result().code(), Result::Succeeded);
+
+    ccr.setCollectionName(QLatin1String("testsearchlocked"));
+    ccr.setCustomLockUnlockSemantic(SecretManager::CustomLockAccessRelock);
+    ccr.startRequest();
+    WAIT_FOR_FINISHED_WITHOUT_BLOCKING(ccr);
+    QCOMPARE(ccr.status(), Request::Finished);
+    QCOMPARE(ccr.result().code(), Result::Succeeded);
+
+    // store a secret with the same filter data into each collection
+    const Secret::Identifier storageIdentifier(
+                QLatin1String("testsearchsecret"),
+                QLatin1String("testsearchcollection"),
+                DEFAULT_TEST_STORAGE_PLUGIN);
+    const Secret::Identifier encryptedIdentifier(
+                QLatin1String("testsearchsecret"),
+                QLatin1String("testsearchencrypted"),
+                DEFAULT_TEST_ENCRYPTEDSTORAGE_PLUGIN);
+    const Secret::Identifier lockedIdentifier(
+                QLatin1String("testsearchsecret"),
+                QLatin1String("testsearchlocked"),
+                DEFAULT_TEST_ENCRYPTEDSTORAGE_PLUGIN);
+    for (const Secret::Identifier &identifier : { storageIdentifier, encryptedIdentifier, lockedIdentifier }) {
+        Secret testSecret(identifier);
+        testSecret.setData("testsecretvalue");
+        testSecret.setType(Secret::TypeBlob);
+        testSecret.setFilterData(QLatin1String("search"), QLatin1String("crossplugin"));
+
+        StoreSecretRequest ssr;
+        ssr.setManager(&sm);
+        ssr.setSecretStorageType(StoreSecretRequest::CollectionSecret);
+        ssr.setUserInteractionMode(SecretManager::ApplicationInteraction);
+        ssr.setSecret(testSecret);
+        ssr.startRequest();
+        WAIT_FOR_FINISHED_WITHOUT_BLOCKING(ssr);
+        QCOMPARE(ssr.status(), Request::Finished);
+        QCOMPARE(ssr.result().code(), Result::Succeeded);
+    }
+
+    Secret::FilterData filter;
+    filter.insert(QLatin1String("search"), QLatin1String("crossplugin"));
+
+    // search every collection of every storage plugin.  The secrets of the
+    // unlocked collections in both plugins must be found, and the locked
+    // collection must be reported as skipped.
+    FindSecretsRequest fsr;
+    fsr.setManager(&sm);
+    fsr.setSearchScope(FindSecretsRequest::AllStoragePluginsSearch);
+    QCOMPARE(fsr.searchScope(), FindSecretsRequest::AllStoragePluginsSearch);
+    fsr.setFilter(filter);
+    fsr.setFilterOperator(SecretManager::OperatorAnd);
+    fsr.setUserInteractionMode(SecretManager::PreventInteraction);
+    fsr.startRequest();
+    WAIT_FOR_FINISHED_WITHOUT_BLOCKING(fsr);
+    QCOMPARE(fsr.status(), Request::Finished);
+    QCOMPARE(fsr.result().code(), Result::Succeeded);
+    QCOMPARE(fsr.identifiers().size(), 2);
+    for (const Secret::Identifier &identifier : fsr.identifiers()) {
+        QCOMPARE(identifier.name(), QLatin1String("testsearchsecret"));
+        if (identifier.storagePluginName() == DEFAULT_TEST_STORAGE_PLUGIN) {
+            QCOMPARE(identifier.collectionName(), QLatin1String("testsearchcollection"));
+        } else {
+            QCOMPARE(identifier.storagePluginName(), DEFAULT_TEST_ENCRYPTEDSTORAGE_PLUGIN);
+            QCOMPARE(identifier.collectionName(), QLatin1String("testsearchencrypted"));
+        }
+    }
+    QVERIFY(fsr.identifiers().contains(storageIdentifier));
+    QVERIFY(fsr.identifiers().contains(encryptedIdentifier));
+
+    // every skipped collection must name the plugin and collection it
+    // belongs to, and the locked collection must be one of them.
+    QCOMPARE(fsr.skippedCollections().size(), fsr.skippedCollectionResults().size());
+    int lockedIndex = -1;
+    for (int i = 0; i < fsr.skippedCollections().size(); ++i) {
+        const Secret::Identifier skipped = fsr.skippedCollections().at(i);
+        QVERIFY(skipped.name().isEmpty());
+        QVERIFY(!skipped.storagePluginName().isEmpty());
+        QVERIFY(!skipped.collectionName().isEmpty());
+        QCOMPARE(fsr.skippedCollectionResults().at(i).code(), Result::Failed);
+        QVERIFY(skipped.storagePluginName() != DEFAULT_TEST_STORAGE_PLUGIN
+                || skipped.collectionName() != QLatin1String("testsearchcollection"));
+        QVERIFY(skipped.storagePluginName() != DEFAULT_TEST_ENCRYPTEDSTORAGE_PLUGIN
+                || skipped.collectionName() != QLatin1String("testsearchencrypted"));
+        if (skipped.storagePluginName() == DEFAULT_TEST_ENCRYPTEDSTORAGE_PLUGIN
+                && skipped.collectionName() == QLatin1String("testsearchlocked")) {
+            QCOMPARE(lockedIndex, -1);
+            lockedIndex = i;
+        }
+    }
+    QVERIFY(lockedIndex >= 0);
+    QCOMPARE(fsr.skippedCollectionResults().at(lockedIndex).errorCode(), Result::CollectionIsLockedError);
+
+    // search every collection of the encrypted storage plugin only
+    fsr.setSearchScope(FindSecretsRequest::StoragePluginSearch);
+    fsr.setStoragePluginName(DEFAULT_TEST_ENCRYPTEDSTORAGE_PLUGIN);
+    fsr.startRequest();
+    WAIT_FOR_FINISHED_WITHOUT_BLOCKING(fsr);
+    QCOMPARE(fsr.status(), Request::Finished);
+    QCOMPARE(fsr.result().code(), Result::Succeeded);
+    QCOMPARE(fsr.identifiers(), QVector<Secret::Identifier>() << encryptedIdentifier);
+    QCOMPARE(fsr.skippedCollections().size(), fsr.skippedCollectionResults().size());
+    lockedIndex = -1;
+    for (int i = 0; i < fsr.skippedCollections().size(); ++i) {
+        const Secret::Identifier skipped = fsr.skippedCollections().at(i);
+        QVERIFY(skipped.name().isEmpty());
+        QCOMPARE(skipped.storagePluginName(), DEFAULT_TEST_ENCRYPTEDSTORAGE_PLUGIN);
+        QVERIFY(!skipped.collectionName().isEmpty());
+        QVERIFY(skipped.collectionName() != QLatin1String("testsearchencrypted"));
+        if (skipped.collectionName() == QLatin1String("testsearchlocked")) {
+            lockedIndex = i;
+        }
+    }
+    QVERIFY(lockedIndex >= 0);
+    QCOMPARE(fsr.skippedCollectionResults().at(lockedIndex).errorCode(), Result::CollectionIsLockedError);
+
+    // clean up the collections
+    DeleteCollectionRequest dcr;
+    dcr.setManager(&sm);
+    dcr.setUserInteractionMode(SecretManager::ApplicationInteraction);
+    for (const Secret::Identifier &identifier : { storageIdentifier, encryptedIdentifier, lockedIdentifier }) {
+        dcr.setCollectionName(identifier.collectionName());
+        dcr.setStoragePluginName(identifier.storagePluginName());
+        dcr.startRequest();
+        WAIT_FOR_FINISHED_WITHOUT_BLOCKING(dcr);
+        QCOMPARE(dcr.status(), Request::Finished);
+        QCOMPARE(dcr.result().code(), Result::Succeeded);
+    }
+}
+
 void tst_secretsrequests::storeUserSecret()
 {
     // construct the in-process authentication key UI.
@@ -0,0 +1,7 @@
+TEMPLATE = app
+TARGET = tst_secretsserialization
+target.path = /opt/tests/Sailfish/Secrets/
+include($$PWD/../../../lib/libsailfishsecrets.pri)
+QT += testlib dbus
+SOURCES += tst_secretsserialization.cpp
+INSTALLS += target
@@ -0,0 +1,321 @@
+/*
+ * Copyright (C) 2018 Jolla Ltd.
+ * Contact: Chris Adams <chris.adams@jollamobile.com>
+ * All rights reserved.
+ * BSD 3-Clause License, see LICENSE.
+ */
+
+#include <QtTest>
+#include <QObject>
+#include <QDBusConnection>
+#include <QDBusConnectionInterface>
+#include <QDBusInterface>
+#include <QDBusMessage>
+#include <QDBusReply>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QProcess>
+#include <QSet>
+
+#define DAEMON_PATH QStringLiteral("/usr/bin/sailfishsecretsd")
+#define DISCOVERY_SERVICE QStringLiteral("org.sailfishos.secrets.daemon.discovery")
+#define DISCOVERY_PATH QStringLiteral("/Sailfish/Secrets/Discovery")
+#define SECRETS_PATH QStringLiteral("/Sailfish/Secrets")
+#define SECRETS_INTERFACE QStringLiteral("org.sailfishos.secrets")
+#define DEFAULT_TEST_STORAGE_PLUGIN QStringLiteral("plugin.storage.default.test")
+#define CLIENT_CONNECTION_NAME QStringLiteral("tst_startup_client")
+
+// The maximum time from the entry to main() until the daemon is ready to
+// accept requests, in milliseconds.  Wall-clock timings depend on the load
+// of the machine running the test, so the budget is only enforced when it
+// is set in the environment (e.g. when profiling on an idle device).
+#define ENV_STARTUP_BUDGET "SAILFISH_SECRETSD_STARTUP_BUDGET_MS"
+
+// Enables the request tracing of the daemon (see requesttracer_p.h).
+#define ENV_TRACE_BUFFER_SIZE "SAILFISH_SECRETSD_TRACE_BUFFER_SIZE"
+#define TRACE_BUFFER_SIZE "1024"
+
+// Starts the daemon in autotest mode and reports its cold start time,
+// as measured by the startup phase markers of the daemon itself, as a
+// benchmark result.  The daemon must not already be running, as only the
+// first startup after the test is launched is cold.
+// The daemon is started with request tracing enabled, so that the spans
+// and statistics recorded for a request sent by the test can be checked, too.
+class tst_startup : public QObject
+{
+    Q_OBJECT
+
+public slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+private slots:
+    void coldStart();
+    void startupPhases();
+    void requestTrace();
+    void requestStatistics();
+
+private:
+    QDBusMessage collectionNames(quint64 traceId);
+    QJsonObject discoveryStatistics(const QString &method);
+    QJsonArray traceEvents(const QString &traceId);
+
+    QProcess m_daemon;
+    QJsonObject m_statistics;
+    qint64 m_budgetMsecs = 0;
+};
+
+void tst_startup::initTestCase()
+{
+    if (!QFileInfo(DAEMON_PATH).isExecutable()) {
+        QSKIP("The secrets daemon is not installed");
+    }
+
+    bool ok = false;
+    const qint64 budget = qgetenv(ENV_STARTUP_BUDGET).toLongLong(&ok);
+    if (ok && budget > 0) {
+        m_budgetMsecs = budget;
+    }
+
+    QDBusConnectionInterface *bus = QDBusConnection::sessionBus().interface();
+    QVERIFY(bus);
+    if (bus->isServiceRegistered(DISCOVERY_SERVICE)) {
+        QSKIP("The secrets daemon is already running, stop it to measure a cold start");
+    }
+
+    // Wait for the discovery service, which is registered (along with
+    // the peer to peer server being set up) just before the daemon is ready.
+    QElapsedTimer timer;
+    timer.start();
+    QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+    environment.insert(QStringLiteral(ENV_TRACE_BUFFER_SIZE), QStringLiteral(TRACE_BUFFER_SIZE));
+    m_daemon.setProcessEnvironment(environment);
+    m_daemon.setProcessChannelMode(QProcess::ForwardedChannels);
+    m_daemon.start(DAEMON_PATH, QStringList() << QStringLiteral("--test"));
+    QVERIFY(m_daemon.waitForStarted());
+    QTRY_VERIFY_WITH_TIMEOUT(bus->isServiceRegistered(DISCOVERY_SERVICE), 20000);
+    qInfo() << "Discovery service registered" << timer.elapsed() << "ms after starting the daemon";
+
+    // The daemon may have registered the service but not yet returned to the
+    // event loop, in which case the call below simply waits for it.
+    QDBusInterface iface(DISCOVERY_SERVICE, DISCOVERY_PATH, DISCOVERY_SERVICE, QDBusConnection::sessionBus());
+    QDBusReply<QString> reply = iface.call(QStringLiteral("startupStatistics"));
+    if (reply.error().type() == QDBusError::AccessDenied) {
+        QSKIP("The startup statistics are only available to platform applications, run within a devel-su -p shell");
+    }
+    QVERIFY2(reply.isValid(), qPrintable(reply.error().message()));
+    m_statistics = QJsonDocument::fromJson(reply.value().toUtf8()).object();
+    QVERIFY(!m_statistics.isEmpty());
+}
+
+void tst_startup::cleanupTestCase()
+{
+    QDBusConnection::disconnectFromPeer(CLIENT_CONNECTION_NAME);
+    if (m_daemon.state() != QProcess::NotRunning) {
+        m_daemon.terminate();
+        if (!m_daemon.waitForFinished()) {
+            m_daemon.kill();
+            m_daemon.waitForFinished();
+        }
+    }
+}
+
+void tst_startup::coldStart()
+{
+    const double readyNsecs = m_statistics.value(QStringLiteral("readyNsecs")).toDouble(-1);
+    QVERIFY(readyNsecs >= 0);
+
+    const qint64 readyMsecs = qint64(readyNsecs / 1000000);
+    qInfo() << "Daemon ready" << readyMsecs << "ms after main()";
+    QTest::setBenchmarkResult(readyMsecs, QTest::WalltimeMilliseconds);
+    if (m_budgetMsecs > 0) {
+        QVERIFY2(readyMsecs <= m_budgetMsecs,
+                 qPrintable(QStringLiteral("Cold start took %1 ms, exceeding the budget of %2 ms")
+                            .arg(readyMsecs).arg(m_budgetMsecs)));
+    }
+}
+
+void tst_startup::startupPhases()
+{
+    const double readyNsecs = m_statistics.value(QStringLiteral("readyNsecs")).toDouble(-1);
+    const QJsonArray phases = m_statistics.value(QStringLiteral("phases")).toArray();
+
+    QSet<QString> names;
+    for (const QJsonValue &value : phases) {
+        const QJsonObject phase = value.toObject();
+        const QString name = phase.value(QStringLiteral("phase")).toString();
+        const double startNsecs = phase.value(QStringLiteral("startNsecs")).toDouble(-1);
+        const double durationNsecs = phase.value(QStringLiteral("durationNsecs")).toDouble(-1);
+        qInfo() << qPrintable(name) << qPrintable(phase.value(QStringLiteral("detail")).toString())
+                << "started at" << qint64(startNsecs / 1000) << "us, took"
+                << qint64(durationNsecs / 1000) << "us";
+
+        QVERIFY(startNsecs >= 0);
+        QVERIFY(durationNsecs >= 0);
+        QVERIFY(startNsecs + durationNsecs <= readyNsecs);
+        names.insert(name);
+    }
+
+    // Every daemon startup passes through these phases; the others
+    // depend on which plugins are installed.
+    const QStringList expected {
+        QStringLiteral("loadPlugins"),
+        QStringLiteral("controllerConstruction"),
+        QStringLiteral("initialize"),
+        QStringLiteral("readSalt"),
+        QStringLiteral("dbusSetup")
+    };
+    for (const QString &name : expected) {
+        QVERIFY2(names.contains(name), qPrintable(QStringLiteral("Missing startup phase: %1").arg(name)));
+    }
+}
+
+QDBusMessage tst_startup::collectionNames(quint64 traceId)
+{
+    QDBusConnection client(CLIENT_CONNECTION_NAME);
+    if (!client.isConnected()) {
+        QDBusInterface discovery(DISCOVERY_SERVICE, DISCOVERY_PATH, DISCOVERY_SERVICE, QDBusConnection::sessionBus());
+        QDBusReply<QString> address = discovery.call(QStringLiteral("peerToPeerAddress"));
+        client = QDBusConnection::connectToPeer(address.value(), CLIENT_CONNECTION_NAME);
+    }
+
+    QDBusMessage call = QDBusMessage::createMethodCall(QString(), SECRETS_PATH, SECRETS_INTERFACE,
+                                                       QStringLiteral("collectionNames"));
+    call << DEFAULT_TEST_STORAGE_PLUGIN << QVariant::fromValue<quint64>(traceId);
+    return client.call(call);
+}
+
+QJsonObject tst_startup::discoveryStatistics(const QString &method)
+{
+    QDBusInterface iface(DISCOVERY_SERVICE, DISCOVERY_PATH, DISCOVERY_SERVICE, QDBusConnection::sessionBus());
+    QDBusReply<QString> reply = iface.call(method);
+    return QJsonDocument::fromJson(reply.value().toUtf8()).object();
+}
+
+QJsonArray tst_startup::traceEvents(const QString &traceId)
+{
+    QDBusInterface iface(DISCOVERY_SERVICE, DISCOVERY_PATH, DISCOVERY_SERVICE, QDBusConnection::sessionBus());
+    QDBusReply<QString> reply = iface.call(QStringLiteral("requestTrace"));
+    const QJsonArray events = QJsonDocument::fromJson(reply.value().toUtf8())
+            .object().value(QStringLiteral("traceEvents")).toArray();
+
+    QJsonArray matching;
+    for (const QJsonValue &value : events) {
+        const QJsonObject event = value.toObject();
+        if (event.value(QStringLiteral("args")).toObject().value(QStringLiteral("traceId")).toString() == traceId) {
+            matching.append(event);
+        }
+    }
+    return matching;
+}
+
+void tst_startup::requestTrace()
+{
+    // Send the request with a trace id of our own, in the format used by
+    // the client library: the pid of the client in the upper 32 bits.
+    const quint64 traceId = (quint64(QCoreApplication::applicationPid()) << 32) | 1;
+    const QDBusMessage reply = collectionNames(traceId);
+    QVERIFY2(reply.type() == QDBusMessage::ReplyMessage, qPrintable(reply.errorMessage()));
+
+    // The total span is recorded when the request completes, which may
+    // happen after the reply has been sent.
+    const QString traceIdString = QString::number(traceId, 16);
+    QJsonArray events;
+    QTRY_VERIFY_WITH_TIMEOUT((events = traceEvents(traceIdString)).size() > 0
+                             && events.last().toObject().value(QStringLiteral("cat")).toString()
+                                    == QLatin1String("request"), 5000);
+
+    // The spans are recorded in the order in which they end.  The request
+    // passes through the queue, is scheduled on the thread pool of the
+    // storage plugin by the processor, calls the plugin and is finished
+    // by the queue again, all within the total span of the request.
+    const QStringList expected {
+        QStringLiteral("queue:queued"),
+        QStringLiteral("queue:handlePendingRequest"),
+        QStringLiteral("threadpool:scheduled"),
+        QStringLiteral("plugin:pluginCall"),
+        QStringLiteral("queue:handleFinishedRequest"),
+        QStringLiteral("request:total")
+    };
+    QHash<QString, QPair<qint64, qint64> > spans;
+    QStringList order;
+    for (const QJsonValue &value : events) {
+        const QJsonObject event = value.toObject();
+        QString name = event.value(QStringLiteral("name")).toString();
+        QVERIFY2(name.startsWith(QLatin1String("CollectionNamesRequest:")), qPrintable(name));
+        name = event.value(QStringLiteral("cat")).toString() + name.mid(name.indexOf(QLatin1Char(':')));
+        // The timestamps are in microseconds, with nanosecond precision.
+        const qint64 startNsecs = qRound64(event.value(QStringLiteral("ts")).toDouble() * 1000);
+        const qint64 endNsecs = startNsecs + qRound64(event.value(QStringLiteral("dur")).toDouble() * 1000);
+        spans.insert(name, qMakePair(startNsecs, endNsecs));
+        if (expected.contains(name)) {
+            order.append(name);
+        }
+    }
+    QCOMPARE(order, expected);
+
+    const QPair<qint64, qint64> queued = spans.value(expected.at(0));
+    const QPair<qint64, qint64> handlePending = spans.value(expected.at(1));
+    const QPair<qint64, qint64> scheduled = spans.value(expected.at(2));
+    const QPair<qint64, qint64> pluginCall = spans.value(expected.at(3));
+    const QPair<qint64, qint64> handleFinished = spans.value(expected.at(4));
+    const QPair<qint64, qint64> total = spans.value(expected.at(5));
+    QVERIFY(handlePending.first >= queued.second);
+    QVERIFY(scheduled.first >= handlePending.first);
+    QVERIFY(scheduled.first <= handlePending.second);
+    QVERIFY(pluginCall.first >= scheduled.second);
+    QVERIFY(handleFinished.first >= pluginCall.second);
+    QCOMPARE(total.first, queued.first);
+    QVERIFY(total.second >= handleFinished.second);
+}
+
+void tst_startup::requestStatistics()
+{
+    QDBusInterface discovery(DISCOVERY_SERVICE, DISCOVERY_PATH, DISCOVERY_SERVICE, QDBusConnection::sessionBus());
+    QDBusReply<void> enabled = discovery.call(QStringLiteral("setPluginStatisticsEnabled"), true);
+    QVERIFY2(enabled.isValid(), qPrintable(enabled.error().message()));
+    QVERIFY(discoveryStatistics(QStringLiteral("pluginStatistics")).value(QStringLiteral("enabled")).toBool());
+
+    // Plugin calls of the storage plugin are counted per plugin, so sum
+    // them up rather than depending on which plugin is the default one.
+    auto pluginCalls = [this] () {
+        double calls = 0;
+        const QJsonObject plugins = discoveryStatistics(QStringLiteral("pluginStatistics"))
+                .value(QStringLiteral("plugins")).toObject();
+        for (const QJsonValue &operations : plugins) {
+            calls += operations.toObject().value(QStringLiteral("collectionNames")).toObject()
+                    .value(QStringLiteral("calls")).toDouble();
+        }
+        return calls;
+    };
+    auto requestCount = [this] (const QString &counter) {
+        const QJsonObject type = discoveryStatistics(QStringLiteral("requestStatistics"))
+                .value(QStringLiteral("CollectionNamesRequest")).toObject();
+        return counter == QLatin1String("total")
+                ? type.value(counter).toObject().value(QStringLiteral("count")).toDouble()
+                : type.value(counter).toDouble();
+    };
+
+    // The other tests may already have run requests of the same type.
+    const double enqueued = requestCount(QStringLiteral("enqueued"));
+    const double completed = requestCount(QStringLiteral("completed"));
+    const double total = requestCount(QStringLiteral("total"));
+    const double calls = pluginCalls();
+
+    const QDBusMessage reply = collectionNames((quint64(QCoreApplication::applicationPid()) << 32) | 2);
+    QVERIFY2(reply.type() == QDBusMessage::ReplyMessage, qPrintable(reply.errorMessage()));
+
+    // The request is recorded as completed after the reply has been sent.
+    QTRY_COMPARE_WITH_TIMEOUT(requestCount(QStringLiteral("completed")), completed + 1, 5000);
+    QCOMPARE(requestCount(QStringLiteral("enqueued")), enqueued + 1);
+    QCOMPARE(requestCount(QStringLiteral("total")), total + 1);
+    QCOMPARE(pluginCalls(), calls + 1);
+
+    discovery.call(QStringLiteral("setPluginStatisticsEnabled"), false);
+}
+
+#include "tst_startup.moc"
+QTEST_MAIN(tst_startup)
@@ -0,0 +1,460 @@
+/*
+ * Copyright (C) 2018 Jolla Ltd.
+ * Contact: Chris Adams <chris.adams@jollamobile.com>
+ * All rights reserved.
+ * BSD 3-Clause License, see LICENSE.
+ */
+
+#include "tst_storagebenchmarks.h"
+
+#include <QtCore/QDir>
+#include <QtCore/QPluginLoader>
+#include <QtCore/QSet>
+
+#define PLUGIN_DIRECTORY QStringLiteral("/usr/lib/Sailfish/Secrets/")
+#define ENCRYPTION_PLUGIN QStringLiteral("org.sailfishos.secrets.plugin.encryption.openssl.test")
+#define SQLITE_PLUGIN QStringLiteral("org.sailfishos.secrets.plugin.storage.sqlite.test")
+#define SQLCIPHER_PLUGIN QStringLiteral("org.sailfishos.secrets.plugin.encryptedstorage.sqlcipher.test")
+#define INMEMORY_PLUGIN QStringLiteral("org.sailfishos.secrets.plugin.encryptedstorage.inmemory.test")
+#define USBTOKEN_PLUGIN QStringLiteral("org.sailfishos.secrets.plugin.cryptostorage.exampleusbtoken.test")
+#define USBTOKEN_LOCK_CODE QByteArray("12345")
+
+#define POPULATED_SECRET_SIZE 256
+
+QTEST_MAIN(tst_storagebenchmarks)
+
+using namespace Sailfish::Secrets;
+
+namespace {
+    const QList<int> collectionSizes { 100, 1000, 10000, 100000 };
+    const QList<int> secretSizes { 16, 256, 4096, 65536 };
+    const QList<int> filterCardinalities { 1, 10, 100, 1000 };
+
+    QString collectionNameForSize(int collectionSize)
+    {
+        return QStringLiteral("benchmark%1").arg(collectionSize);
+    }
+
+    QString groupField(int cardinality)
+    {
+        return QStringLiteral("group%1").arg(cardinality);
+    }
+
+    QByteArray initialKey() { return QByteArray(32, 'a'); }
+    QByteArray alternateKey() { return QByteArray(32, 'b'); }
+}
+
+// Presents the storage and encrypted storage plugin interfaces
+// uniformly to the benchmarks.
+class StorageBackend
+{
+public:
+    virtual ~StorageBackend() {}
+
+    virtual QString name() const = 0;
+
+    // Read-only backends provide a single fixed secret in a single
+    // fixed collection, and only take part in the getSecret benchmark.
+    virtual bool isWritable() const { return true; }
+    virtual QString fixedCollectionName() const { return QString(); }
+    virtual QString fixedSecretName() const { return QString(); }
+
+    virtual Result createCollection(const QString &collectionName, const QByteArray &key) = 0;
+    virtual Result removeCollection(const QString &collectionName) = 0;
+    virtual Result setSecret(const QString &collectionName, const QString &secretName,
+                             const QByteArray &data, const Secret::FilterData &filterData) = 0;
+    virtual Result getSecret(const QString &collectionName, const QString &secretName, QByteArray *data) = 0;
+    virtual Result removeSecret(const QString &collectionName, const QString &secretName) = 0;
+    virtual Result findSecrets(const QString &collectionName, const Secret::FilterData &filter, int *count) = 0;
+    virtual Result reencrypt(const QString &collectionName, const QByteArray &oldKey, const QByteArray &newKey) = 0;
+
+    // Encrypts the data as the daemon would before handing it to the plugin.
+    virtual QByteArray prepareSecretData(const QByteArray &plaintext, const QByteArray &key) = 0;
+
+    QSet<QString> populatedCollections;
+    QMap<QString, QByteArray> collectionKeys;
+};
+
+class StoragePluginBackend : public StorageBackend
+{
+public:
+    StoragePluginBackend(StoragePlugin *plugin, EncryptionPlugin *encryptionPlugin)
+        : m_plugin(plugin), m_encryptionPlugin(encryptionPlugin) {}
+
+    QString name() const Q_DECL_OVERRIDE { return m_plugin->name(); }
+
+    Result createCollection(const QString &collectionName, const QByteArray &) Q_DECL_OVERRIDE {
+        return m_plugin->createCollection(collectionName);
+    }
+    Result removeCollection(const QString &collectionName) Q_DECL_OVERRIDE {
+        return m_plugin->removeCollection(collectionName);
+    }
+    Result setSecret(const QString &collectionName, const QString &secretName,
+                     const QByteArray &data, const Secret::FilterData &filterData) Q_DECL_OVERRIDE {
+        return m_plugin->setSecret(collectionName, secretName, data, filterData);
+    }
+    Result getSecret(const QString &collectionName, const QString &secretName, QByteArray *data) Q_DECL_OVERRIDE {
+        Secret::FilterData filterData;
+        return m_plugin->getSecret(collectionName, secretName, data, &filterData);
+    }
+    Result removeSecret(const QString &collectionName, const QString &secretName) Q_DECL_OVERRIDE {
+        return m_plugin->removeSecret(collectionName, secretName);
+    }
+    Result findSecrets(const QString &collectionName, const Secret::FilterData &filter, int *count) Q_DECL_OVERRIDE {
+        QStringList secretNames;
+        Result result = m_plugin->findSecrets(collectionName, filter, StoragePlugin::OperatorAnd, StoragePlugin::MatchExact, &secretNames);
+        *count = secretNames.size();
+        return result;
+    }
+    Result reencrypt(const QString &collectionName, const QByteArray &oldKey, const QByteArray &newKey) Q_DECL_OVERRIDE {
+        if (!m_encryptionPlugin) {
+            return Result(Result::OperationNotSupportedError,
+                          QStringLiteral("No encryption plugin available"));
+        }
+        return m_plugin->reencrypt(collectionName, QString(), oldKey, newKey, m_encryptionPlugin);
+    }
+    QByteArray prepareSecretData(const QByteArray &plaintext, const QByteArray &key) Q_DECL_OVERRIDE {
+        QByteArray encrypted;
+        if (!m_encryptionPlugin
+                || m_encryptionPlugin->encryptSecret(plaintext, key, &encrypted).code() != Result::Succeeded) {
+            return plaintext;
+        }
+        return encrypted;
+    }
+
+private:
+    StoragePlugin *m_plugin;
+    EncryptionPlugin *m_encryptionPlugin;
+};
+
+class EncryptedStoragePluginBackend : public StorageBackend
+{
+public:
+    EncryptedStoragePluginBackend(EncryptedStoragePlugin *plugin)
+        : m_plugin(plugin) {}
+
+    QString name() const Q_DECL_OVERRIDE { return m_plugin->name(); }
+
+    Result createCollection(const QString &collectionName, const QByteArray &key) Q_DECL_OVERRIDE {
+        return m_plugin->createCollection(collectionName, key);
+    }
+    Result removeCollection(const QString &collectionName) Q_DECL_OVERRIDE {
+        return m_plugin->removeCollection(collectionName);
+    }
+    Result setSecret(const QString &collectionName, const QString &secretName,
+                     const QByteArray &data, const Secret::FilterData &filterData) Q_DECL_OVERRIDE {
+        return m_plugin->setSecret(collectionName, secretName, data, filterData);
+    }
+    Result getSecret(const QString &collectionName, const QString &secretName, QByteArray *data) Q_DECL_OVERRIDE {
+        Secret::FilterData filterData;
+        return m_plugin->getSecret(collectionName, secretName, data, &filterData);
+    }
+    Result removeSecret(const QString &collectionName, const QString &secretName) Q_DECL_OVERRIDE {
+        return m_plugin->removeSecret(collectionName, secretName);
+    }
+    Result findSecrets(const QString &collectionName, const Secret::FilterData &filter, int *count) Q_DECL_OVERRIDE {
+        QVector<Secret::Identifier> identifiers;
+        Result result = m_plugin->findSecrets(collectionName, filter, StoragePlugin::OperatorAnd, StoragePlugin::MatchExact, &identifiers);
+        *count = identifiers.size();
+        return result;
+    }
+    Result reencrypt(const QString &collectionName, const QByteArray &oldKey, const QByteArray &newKey) Q_DECL_OVERRIDE {
+        return m_plugin->reencrypt(collectionName, oldKey, newKey);
+    }
+    QByteArray prepareSecretData(const QByteArray &plaintext, const QByteArray &) Q_DECL_OVERRIDE {
+        // the plugin encrypts the data itself.
+        return plaintext;
+    }
+
+protected:
+    EncryptedStoragePlugin *m_plugin;
+};
+
+class ReadOnlyEncryptedStoragePluginBackend : public EncryptedStoragePluginBackend
+{
+public:
+    ReadOnlyEncryptedStoragePluginBackend(EncryptedStoragePlugin *plugin)
+        : EncryptedStoragePluginBackend(plugin) {}
+
+    bool isWritable() const Q_DECL_OVERRIDE { return false; }
+    QString fixedCollectionName() const Q_DECL_OVERRIDE { return QStringLiteral("Default"); }
+    QString fixedSecretName() const Q_DECL_OVERRIDE { return QStringLiteral("Default"); }
+};
+
+void tst_storagebenchmarks::initTestCase()
+{
+    bool ok = false;
+    const int maximumCollectionSize = qgetenv("SAILFISH_SECRETS_BENCHMARK_MAX_COLLECTION_SIZE").toInt(&ok);
+    if (ok && maximumCollectionSize > 0) {
+        m_maximumCollectionSize = maximumCollectionSize;
+    }
+
+    QString pluginDirectory = QString::fromLocal8Bit(qgetenv("SAILFISH_SECRETS_BENCHMARK_PLUGIN_DIRECTORY"));
+    if (pluginDirectory.isEmpty()) {
+        pluginDirectory = PLUGIN_DIRECTORY;
+    }
+
+    QMap<QString, QObject*> plugins;
+    QDir dir(pluginDirectory);
+    for (const QFileInfo &file : dir.entryInfoList(QDir::Files | QDir::NoDotAndDotDot, QDir::Name)) {
+        if (!file.fileName().startsWith(QStringLiteral("lib")) || !file.fileName().contains(QStringLiteral(".so"))) {
+            continue;
+        }
+
+        QPluginLoader loader(file.absoluteFilePath());
+        QObject *instance = loader.instance();
+        PluginBase *plugin = Q_NULLPTR;
+        if (EncryptionPlugin *p = qobject_cast<EncryptionPlugin*>(instance)) {
+            plugin = p;
+        } else if (StoragePlugin *p = qobject_cast<StoragePlugin*>(instance)) {
+            plugin = p;
+        } else if (EncryptedStoragePlugin *p = qobject_cast<EncryptedStoragePlugin*>(instance)) {
+            plugin = p;
+        }
+        if (plugin) {
+            plugin->initialize();
+            plugins.insert(plugin->name(), instance);
+        }
+    }
+
+    m_encryptionPlugin = qobject_cast<EncryptionPlugin*>(plugins.value(ENCRYPTION_PLUGIN));
+    if (StoragePlugin *p = qobject_cast<StoragePlugin*>(plugins.value(SQLITE_PLUGIN))) {
+        m_backends.insert(p->name(), QSharedPointer<StorageBackend>(new StoragePluginBackend(p, m_encryptionPlugin)));
+    }
+    if (EncryptedStoragePlugin *p = qobject_cast<EncryptedStoragePlugin*>(plugins.value(SQLCIPHER_PLUGIN))) {
+        m_backends.insert(p->name(), QSharedPointer<StorageBackend>(new EncryptedStoragePluginBackend(p)));
+    }
+    if (EncryptedStoragePlugin *p = qobject_cast<EncryptedStoragePlugin*>(plugins.value(INMEMORY_PLUGIN))) {
+        m_backends.insert(p->name(), QSharedPointer<StorageBackend>(new EncryptedStoragePluginBackend(p)));
+    }
+    if (EncryptedStoragePlugin *p = qobject_cast<EncryptedStoragePlugin*>(plugins.value(USBTOKEN_PLUGIN))) {
+        if (p->unlock(USBTOKEN_LOCK_CODE)) {
+            m_backends.insert(p->name(), QSharedPointer<StorageBackend>(new ReadOnlyEncryptedStoragePluginBackend(p)));
+        }
+    }
+
+    if (m_backends.isEmpty()) {
+        QSKIP("No storage plugins available to benchmark");
+    }
+
+    // remove any collections left over from a previous, aborted run.
+    for (QSharedPointer<StorageBackend> backend : m_backends) {
+        if (backend->isWritable()) {
+            for (int collectionSize : collectionSizes) {
+                backend->removeCollection(collectionNameForSize(collectionSize));
+            }
+        }
+    }
+}
+
+void tst_storagebenchmarks::cleanupTestCase()
+{
+    for (QSharedPointer<StorageBackend> backend : m_backends) {
+        for (const QString &collectionName : backend->populatedCollections) {
+            backend->removeCollection(collectionName);
+        }
+    }
+    m_backends.clear();
+}
+
+void tst_storagebenchmarks::addCollectionSizeRows(const QList<int> &secondaryValues, bool writableOnly)
+{
+    for (QSharedPointer<StorageBackend> backend : m_backends) {
+        if (!backend->isWritable()) {
+            if (!writableOnly) {
+                QTest::newRow(qPrintable(backend->name())) << backend->name() << 1 << 0;
+            }
+            continue;
+        }
+        for (int collectionSize : collectionSizes) {
+            for (int secondaryValue : secondaryValues) {
+                if (secondaryValue > collectionSize) {
+                    continue;
+                }
+                QTest::newRow(qPrintable(QStringLiteral("%1:%2:%3").arg(backend->name()).arg(collectionSize).arg(secondaryValue)))
+                        << backend->name() << collectionSize << secondaryValue;
+            }
+        }
+    }
+}
+
+StorageBackend *tst_storagebenchmarks::backendForRow(int collectionSize)
+{
+    QFETCH(QString, plugin);
+    StorageBackend *backend = m_backends.value(plugin).data();
+    if (backend && backend->isWritable()) {
+        if (collectionSize > m_maximumCollectionSize) {
+            return Q_NULLPTR;
+        }
+        if (!populate(backend, collectionSize)) {
+            return Q_NULLPTR;
+        }
+    }
+    return backend;
+}
+
+bool tst_storagebenchmarks::populate(StorageBackend *backend, int collectionSize)
+{
+    // Each collection size has its own collection, which is populated
+    // the first time it is needed and reused by the subsequent benchmarks.
+    const QString collectionName = collectionNameForSize(collectionSize);
+    if (backend->populatedCollections.contains(collectionName)) {
+        return true;
+    }
+
+    const QByteArray key = initialKey();
+    Result result = backend->createCollection(collectionName, key);
+    if (result.code() != Result::Succeeded) {
+        qWarning() << "Unable to create benchmark collection:" << result.errorMessage();
+        return false;
+    }
+    backend->populatedCollections.insert(collectionName);
+    backend->collectionKeys.insert(collectionName, key);
+
+    // Every secret has a filter field per cardinality, such that
+    // filtering on value "0" of a field matches exactly that many secrets.
+    const QByteArray data = backend->prepareSecretData(QByteArray(POPULATED_SECRET_SIZE, 'x'), key);
+    for (int i = 0; i < collectionSize; ++i) {
+        Secret::FilterData filterData;
+        for (int cardinality : filterCardinalities) {
+            filterData.insert(groupField(cardinality), QString::number(i / cardinality));
+        }
+        result = backend->setSecret(collectionName, QStringLiteral("secret%1").arg(i), data, filterData);
+        if (result.code() != Result::Succeeded) {
+            qWarning() << "Unable to populate benchmark collection:" << result.errorMessage();
+            return false;
+        }
+    }
+    return true;
+}
+
+void tst_storagebenchmarks::setSecret_data()
+{
+    QTest::addColumn<QString>("plugin");
+    QTest::addColumn<int>("collectionSize");
+    QTest::addColumn<int>("secretSize");
+    addCollectionSizeRows(secretSizes, true);
+}
+
+void tst_storagebenchmarks::setSecret()
+{
+    QFETCH(int, collectionSize);
+    QFETCH(int, secretSize);
+    StorageBackend *backend = backendForRow(collectionSize);
+    if (!backend) {
+        QSKIP("Collection size not enabled or not available");
+    }
+
+    const QString collectionName = collectionNameForSize(collectionSize);
+    const QByteArray data = backend->prepareSecretData(QByteArray(secretSize, 'y'),
+                                                       backend->collectionKeys.value(collectionName));
+    Secret::FilterData filterData;
+    filterData.insert(QStringLiteral("benchmark"), QStringLiteral("setSecret"));
+
+    QStringList addedSecrets;
+    QBENCHMARK {
+        const QString secretName = QStringLiteral("added%1").arg(addedSecrets.size());
+        addedSecrets.append(secretName);
+        QCOMPARE(backend->setSecret(collectionName, secretName, data, filterData).code(), Result::Succeeded);
+    }
+
+    // restore the collection to its original size for the other benchmarks.
+    for (const QString &secretName : addedSecrets) {
+        QCOMPARE(backend->removeSecret(collectionName, secretName).code(), Result::Succeeded);
+    }
+}
+
+void tst_storagebenchmarks::getSecret_data()
+{
+    QTest::addColumn<QString>("plugin");
+    QTest::addColumn<int>("collectionSize");
+    QTest::addColumn<int>("secretSize");
+    addCollectionSizeRows(secretSizes, false);
+}
+
+void tst_storagebenchmarks::getSecret()
+{
+    QFETCH(int, collectionSize);
+    QFETCH(int, secretSize);
+    StorageBackend *backend = backendForRow(collectionSize);
+    if (!backend) {
+        QSKIP("Collection size not enabled or not available");
+    }
+
+    QString collectionName = backend->fixedCollectionName();
+    QString secretName = backend->fixedSecretName();
+    if (backend->isWritable()) {
+        collectionName = collectionNameForSize(collectionSize);
+        secretName = QStringLiteral("sized%1").arg(secretSize);
+        const QByteArray data = backend->prepareSecretData(QByteArray(secretSize, 'z'),
+                                                           backend->collectionKeys.value(collectionName));
+        QCOMPARE(backend->setSecret(collectionName, secretName, data, Secret::FilterData()).code(), Result::Succeeded);
+    }
+
+    QByteArray data;
+    QBENCHMARK {
+        QCOMPARE(backend->getSecret(collectionName, secretName, &data).code(), Result::Succeeded);
+    }
+    QVERIFY(!data.isEmpty());
+
+    if (backend->isWritable()) {
+        QCOMPARE(backend->removeSecret(collectionName, secretName).code(), Result::Succeeded);
+    }
+}
+
+void tst_storagebenchmarks::findSecrets_data()
+{
+    QTest::addColumn<QString>("plugin");
+    QTest::addColumn<int>("collectionSize");
+    QTest::addColumn<int>("filterCardinality");
+    addCollectionSizeRows(filterCardinalities, true);
+}
+
+void tst_storagebenchmarks::findSecrets()
+{
+    QFETCH(int, collectionSize);
+    QFETCH(int, filterCardinality);
+    StorageBackend *backend = backendForRow(collectionSize);
+    if (!backend) {
+        QSKIP("Collection size not enabled or not available");
+    }
+
+    const QString collectionName = collectionNameForSize(collectionSize);
+    Secret::FilterData filter;
+    filter.insert(groupField(filterCardinality), QStringLiteral("0"));
+
+    int count = 0;
+    QBENCHMARK {
+        QCOMPARE(backend->findSecrets(collectionName, filter, &count).code(), Result::Succeeded);
+    }
+    QCOMPARE(count, filterCardinality);
+}
+
+void tst_storagebenchmarks::reencrypt_data()
+{
+    QTest::addColumn<QString>("plugin");
+    QTest::addColumn<int>("collectionSize");
+    QTest::addColumn<int>("unused");
+    addCollectionSizeRows(QList<int>() << 0, true);
+}
+
+void tst_storagebenchmarks::reencrypt()
+{
+    QFETCH(int, collectionSize);
+    StorageBackend *backend = backendForRow(collectionSize);
+    if (!backend) {
+        QSKIP("Collection size not enabled or not available");
+    }
+
+    const QString collectionName = collectionNameForSize(collectionSize);
+    QBENCHMARK {
+        const QByteArray oldKey = backend->collectionKeys.value(collectionName);
+        const QByteArray newKey = oldKey == initialKey() ? alternateKey() : initialKey();
+        const Result result = backend->reencrypt(collectionName, oldKey, newKey);
+        if (result.errorCode() == Result::OperationNotSupportedError) {
+            QSKIP("Re-encryption not supported");
+        }
+        QCOMPARE(result.code(), Result::Succeeded);
+        backend->collectionKeys.insert(collectionName, newKey);
+    }
+}
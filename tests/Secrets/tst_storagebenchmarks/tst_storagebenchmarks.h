@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2018 Jolla Ltd.
+ * Contact: Chris Adams <chris.adams@jollamobile.com>
+ * All rights reserved.
+ * BSD 3-Clause License, see LICENSE.
+ */
+
+#include <QtTest>
+#include <QtCore/QObject>
+#include <QtCore/QString>
+#include <QtCore/QByteArray>
+#include <QtCore/QMap>
+#include <QtCore/QSharedPointer>
+
+#include "Secrets/Plugins/extensionplugins.h"
+
+class StorageBackend;
+
+// Benchmarks the storage operations of the (test builds of the) storage
+// and encrypted storage plugins, by loading the plugins in-process and
+// calling them directly, without involving the secrets daemon.
+//
+// Each benchmark is parametrised by plugin and by collection size
+// (and by secret size or filter cardinality, where relevant).
+// Collection sizes above SAILFISH_SECRETS_BENCHMARK_MAX_COLLECTION_SIZE
+// (if set) are skipped.  The plugin directory may be overridden with
+// SAILFISH_SECRETS_BENCHMARK_PLUGIN_DIRECTORY.
+//
+// Use the standard QtTest output options to produce machine-readable
+// results which can be compared between runs, e.g.:
+//   tst_storagebenchmarks -o results.xml,xml
+//   tst_storagebenchmarks -o results.csv,csv
+class tst_storagebenchmarks : public QObject
+{
+    Q_OBJECT
+
+public slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+private slots:
+    void setSecret_data();
+    void setSecret();
+    void getSecret_data();
+    void getSecret();
+    void findSecrets_data();
+    void findSecrets();
+    void reencrypt_data();
+    void reencrypt();
+
+private:
+    void addCollectionSizeRows(const QList<int> &secondaryValues, bool writableOnly);
+    StorageBackend *backendForRow(int collectionSize);
+    bool populate(StorageBackend *backend, int collectionSize);
+
+    QMap<QString, QSharedPointer<StorageBackend> > m_backends;
+    Sailfish::Secrets::EncryptionPlugin *m_encryptionPlugin = Q_NULLPTR;
+    int m_maximumCollectionSize = 100000;
+};
@@ -0,0 +1,12 @@
+TEMPLATE = app
+TARGET = tst_storagebenchmarks
+target.path = /opt/tests/Sailfish/Secrets/
+include($$PWD/../../../lib/libsailfishsecretspluginapi.pri)
+QT += testlib
+INSTALLS += target
+
+HEADERS += \
+    $$PWD/tst_storagebenchmarks.h
+
+SOURCES += \
+    $$PWD/tst_storagebenchmarks.cpp
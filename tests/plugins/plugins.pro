@@ -5,7 +5,9 @@ SUBDIRS += \
     $$PWD/testsqliteplugin \
     $$PWD/testopensslplugin \
     $$PWD/testsqlcipherplugin \
+    $$PWD/testinmemoryplugin \
     $$PWD/testopensslcryptoplugin \
     $$PWD/testexampleusbtokenplugin \
     $$PWD/testgnupgplugin \
-    $$PWD/testopenpgpplugin
+    $$PWD/testopenpgpplugin \
+    $$PWD/testlatencyplugin
@@ -8,6 +8,7 @@ include($$PWD/../../../common.pri)
 include($$PWD/../../../lib/libsailfishsecrets.pri)
 include($$PWD/../../../lib/libsailfishcrypto.pri)
 include($$PWD/../../../database/database.pri)
+include($$PWD/../../../lib/libsailfishcryptoevp.pri)
 
 DEFINES += SAILFISHSECRETS_TESTPLUGIN
 
@@ -21,13 +22,10 @@ DEPENDPATH += \
     $$PWD/../../../plugins/opensslcryptoplugin/evp/
 
 HEADERS += \
-    $$PWD/../../../plugins/opensslcryptoplugin/evp/evp_p.h \
-    $$PWD/../../../plugins/opensslcryptoplugin/evp/evp_helpers_p.h \
     $$PWD/../../../plugins/opensslcryptoplugin/opensslcryptoplugin.h \
     $$PWD/../../../plugins/exampleusbtokenplugin/exampleusbtokenplugin.h
 
 SOURCES += \
-    $$PWD/../../../plugins/opensslcryptoplugin/evp/evp.cpp \
     $$PWD/../../../plugins/opensslcryptoplugin/opensslcryptoplugin.cpp \
     $$PWD/../../../plugins/exampleusbtokenplugin/exampleusbtokenplugin.cpp \
     $$PWD/../../../plugins/exampleusbtokenplugin/encryptedstorageplugin.cpp \
@@ -5,5 +5,5 @@ SOURCES += tst_gnupgplugin.cpp
 
 target.path = /opt/tests/Sailfish/Crypto/
 include($$PWD/../../../lib/libsailfishcrypto.pri)
-QT += testlib
+QT += testlib dbus
 INSTALLS += target
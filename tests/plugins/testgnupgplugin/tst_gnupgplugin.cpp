@@ -7,6 +7,8 @@
 
 #include <QtTest>
 #include <QSignalSpy>
+#include <QTemporaryFile>
+#include <QDBusUnixFileDescriptor>
 
 #include "Crypto/cryptomanager.h"
 #include "Crypto/storedkeyidentifiersrequest.h"
@@ -16,6 +18,7 @@
 #include "Crypto/deletestoredkeyrequest.h"
 #include "Crypto/signrequest.h"
 #include "Crypto/verifyrequest.h"
+#include "Crypto/batchverifyrequest.h"
 #include "Crypto/encryptrequest.h"
 #include "Crypto/decryptrequest.h"
 #include "Crypto/key.h"
@@ -83,11 +86,19 @@ private slots:
     void encryptDecrypt_data();
     void signVerify();
     void signVerify_data();
+    void batchVerify();
+    void streamedSignVerify();
+    void streamedEncryptDecrypt();
     void storedKeyIdentifiers();
+    void signLatency();
+    void encryptLatency();
 
 private:
     Key  addKey(CryptoManager::Algorithm algorithm,
                 CryptoManager::Operation operations);
+    bool createStreamFiles(const QByteArray &input,
+                           QTemporaryFile *inputFile, QTemporaryFile *outputFile,
+                           QVariantMap *customParameters);
     CryptoManager cm;
 };
 
@@ -297,6 +308,218 @@ void tst_gnupgplugin::signVerify()
     QCOMPARE(vr.verificationStatus(), CryptoManager::VerificationSucceeded);
 }
 
+void tst_gnupgplugin::batchVerify()
+{
+    TmpKey fullKey(addKey(CryptoManager::AlgorithmRsa, CryptoManager::OperationSign));
+    QVERIFY(fullKey.identifier().isValid());
+
+    // Sign a few test messages
+    // ----------------------------
+
+    QVector<QByteArray> messages;
+    QVector<QByteArray> signatures;
+    for (int i = 0; i < 3; ++i) {
+        messages << QByteArray("Test plaintext data ") + QByteArray::number(i);
+
+        SignRequest sr;
+        sr.setManager(&cm);
+        sr.setKey(fullKey);
+        sr.setData(messages.last());
+        sr.setCryptoPluginName(OPENPGP_PLUGIN);
+        sr.startRequest();
+        WAIT_FOR_FINISHED_WITHOUT_BLOCKING(sr);
+        QCOMPARE(sr.result().code(), Result::Succeeded);
+        signatures << sr.signature();
+    }
+
+    // Verify them in a single request, along with
+    // a tampered message and a malformed signature.
+    // ----------------------------
+
+    messages << messages.at(0) + QByteArray(" tampered");
+    signatures << signatures.at(0);
+    messages << messages.at(1);
+    signatures << QByteArray("not a signature");
+
+    BatchVerifyRequest bvr;
+    bvr.setManager(&cm);
+    QSignalSpy bvrss(&bvr, &BatchVerifyRequest::statusChanged);
+    QSignalSpy bvrvs(&bvr, &BatchVerifyRequest::verificationStatusesChanged);
+    QVERIFY(bvr.verificationStatuses().isEmpty());
+    QCOMPARE(bvr.status(), Request::Inactive);
+    bvr.setKey(fullKey);
+    bvr.setData(messages);
+    QCOMPARE(bvr.data(), messages);
+    bvr.setSignatures(signatures);
+    QCOMPARE(bvr.signatures(), signatures);
+    bvr.setCryptoPluginName(OPENPGP_PLUGIN);
+
+    bvr.startRequest();
+    QCOMPARE(bvrss.count(), 1);
+    QCOMPARE(bvr.status(), Request::Active);
+    QCOMPARE(bvr.result().code(), Result::Pending);
+    WAIT_FOR_FINISHED_WITHOUT_BLOCKING(bvr);
+    QCOMPARE(bvrss.count(), 2);
+    QCOMPARE(bvr.status(), Request::Finished);
+
+    QCOMPARE(bvr.result().code(), Result::Succeeded);
+    QCOMPARE(bvrvs.count(), 1);
+    const QVector<CryptoManager::VerificationStatus> statuses = bvr.verificationStatuses();
+    QCOMPARE(statuses.size(), messages.size());
+    QCOMPARE(statuses.at(0), CryptoManager::VerificationSucceeded);
+    QCOMPARE(statuses.at(1), CryptoManager::VerificationSucceeded);
+    QCOMPARE(statuses.at(2), CryptoManager::VerificationSucceeded);
+    QCOMPARE(statuses.at(3), CryptoManager::VerificationSignatureInvalid);
+    QVERIFY(statuses.at(4) != CryptoManager::VerificationSucceeded);
+
+    // Mismatched signatures and data are rejected.
+    bvr.setSignatures(signatures.mid(1));
+    bvr.startRequest();
+    WAIT_FOR_FINISHED_WITHOUT_BLOCKING(bvr);
+    QCOMPARE(bvr.result().code(), Result::Failed);
+    QVERIFY(bvr.verificationStatuses().isEmpty());
+}
+
+// The file descriptors are shared with the daemon, along with their
+// offsets, so the input is rewound before the request is started and
+// the output is rewound before it is read.
+bool tst_gnupgplugin::createStreamFiles(const QByteArray &input,
+                                        QTemporaryFile *inputFile, QTemporaryFile *outputFile,
+                                        QVariantMap *customParameters)
+{
+    if (!inputFile->open() || !outputFile->open()
+            || inputFile->write(input) != input.size()
+            || !inputFile->flush() || !inputFile->seek(0)) {
+        return false;
+    }
+    customParameters->insert(QStringLiteral("Input-Fd"),
+                             QVariant::fromValue(QDBusUnixFileDescriptor(inputFile->handle())));
+    customParameters->insert(QStringLiteral("Output-Fd"),
+                             QVariant::fromValue(QDBusUnixFileDescriptor(outputFile->handle())));
+    return true;
+}
+
+void tst_gnupgplugin::streamedSignVerify()
+{
+    TmpKey fullKey(addKey(CryptoManager::AlgorithmRsa, CryptoManager::OperationSign));
+    QVERIFY(fullKey.identifier().isValid());
+
+    // Sign a payload which is larger than the chunks gpgme
+    // reads, streaming it from and to file descriptors.
+    // ----------------------------
+
+    QByteArray plaintext;
+    for (int i = 0; plaintext.size() < 1024 * 1024; ++i) {
+        plaintext += QByteArray("Test plaintext data ") + QByteArray::number(i) + '\n';
+    }
+
+    QTemporaryFile inputFile, outputFile;
+    QVariantMap customParameters;
+    QVERIFY(createStreamFiles(plaintext, &inputFile, &outputFile, &customParameters));
+
+    SignRequest sr;
+    sr.setManager(&cm);
+    sr.setKey(fullKey);
+    sr.setCustomParameters(customParameters);
+    sr.setCryptoPluginName(OPENPGP_PLUGIN);
+    sr.startRequest();
+    WAIT_FOR_FINISHED_WITHOUT_BLOCKING(sr);
+    QCOMPARE(sr.result().code(), Result::Succeeded);
+    QVERIFY(sr.signature().isEmpty());
+
+    QVERIFY(outputFile.seek(0));
+    const QByteArray signature = outputFile.readAll();
+    QVERIFY(!signature.isEmpty());
+
+    // Verify the streamed signature, against both
+    // the streamed data and the data in memory.
+    // ----------------------------
+
+    QVERIFY(inputFile.seek(0));
+    customParameters.remove(QStringLiteral("Output-Fd"));
+    VerifyRequest vr;
+    vr.setManager(&cm);
+    vr.setKey(fullKey);
+    vr.setSignature(signature);
+    vr.setCustomParameters(customParameters);
+    vr.setCryptoPluginName(OPENPGP_PLUGIN);
+    vr.startRequest();
+    WAIT_FOR_FINISHED_WITHOUT_BLOCKING(vr);
+    QCOMPARE(vr.result().code(), Result::Succeeded);
+    QCOMPARE(vr.verificationStatus(), CryptoManager::VerificationSucceeded);
+
+    vr.setCustomParameters(QVariantMap());
+    vr.setData(plaintext);
+    vr.startRequest();
+    WAIT_FOR_FINISHED_WITHOUT_BLOCKING(vr);
+    QCOMPARE(vr.result().code(), Result::Succeeded);
+    QCOMPARE(vr.verificationStatus(), CryptoManager::VerificationSucceeded);
+}
+
+void tst_gnupgplugin::streamedEncryptDecrypt()
+{
+    TmpKey fullKey(addKey(CryptoManager::AlgorithmRsa, CryptoManager::OperationEncrypt));
+    QVERIFY(fullKey.identifier().isValid());
+
+    QByteArray plaintext;
+    for (int i = 0; plaintext.size() < 1024 * 1024; ++i) {
+        plaintext += QByteArray("Test plaintext data ") + QByteArray::number(i) + '\n';
+    }
+
+    // Encrypt the payload from and to file descriptors.
+    // ----------------------------
+
+    QTemporaryFile plaintextFile, cipherFile;
+    QVariantMap customParameters;
+    QVERIFY(createStreamFiles(plaintext, &plaintextFile, &cipherFile, &customParameters));
+
+    EncryptRequest er;
+    er.setManager(&cm);
+    er.setKey(fullKey);
+    er.setCustomParameters(customParameters);
+    er.setCryptoPluginName(OPENPGP_PLUGIN);
+    er.startRequest();
+    WAIT_FOR_FINISHED_WITHOUT_BLOCKING(er);
+    QCOMPARE(er.result().code(), Result::Succeeded);
+    QVERIFY(er.ciphertext().isEmpty());
+
+    QVERIFY(cipherFile.seek(0));
+    const QByteArray cipher = cipherFile.readAll();
+    QVERIFY(!cipher.isEmpty());
+
+    // Decrypt it, streaming the plaintext out again.
+    // ----------------------------
+
+    QTemporaryFile decryptInputFile, decryptOutputFile;
+    customParameters.clear();
+    QVERIFY(createStreamFiles(cipher, &decryptInputFile, &decryptOutputFile, &customParameters));
+
+    DecryptRequest dr;
+    dr.setManager(&cm);
+    dr.setKey(fullKey);
+    dr.setCustomParameters(customParameters);
+    dr.setCryptoPluginName(OPENPGP_PLUGIN);
+    dr.startRequest();
+    WAIT_FOR_FINISHED_WITHOUT_BLOCKING(dr);
+    QCOMPARE(dr.result().code(), Result::Succeeded);
+    QVERIFY(dr.plaintext().isEmpty());
+
+    QVERIFY(decryptOutputFile.seek(0));
+    QCOMPARE(decryptOutputFile.readAll(), plaintext);
+
+    // Output can only be streamed to a descriptor, not to a path.
+    // ----------------------------
+
+    customParameters.clear();
+    customParameters.insert(QStringLiteral("Output-Fd"), decryptOutputFile.fileName());
+    dr.setCustomParameters(customParameters);
+    dr.setData(cipher);
+    dr.startRequest();
+    WAIT_FOR_FINISHED_WITHOUT_BLOCKING(dr);
+    QCOMPARE(dr.result().code(), Result::Failed);
+    QCOMPARE(dr.result().errorCode(), Result::CryptoPluginDecryptionError);
+}
+
 void tst_gnupgplugin::encryptDecrypt_data()
 {
     QTest::addColumn<CryptoManager::Algorithm>("algorithm");
@@ -377,5 +600,44 @@ void tst_gnupgplugin::encryptDecrypt()
     QCOMPARE(dr.verificationStatus(), CryptoManager::VerificationStatusUnknown);
 }
 
+// The latency of repeated operations with the same key, which
+// benefit from the reuse of gpgme contexts and of looked up keys.
+// Compare the results between builds with e.g. -o result.xml,xml
+void tst_gnupgplugin::signLatency()
+{
+    TmpKey fullKey(addKey(CryptoManager::AlgorithmRsa, CryptoManager::OperationSign));
+    QVERIFY(fullKey.identifier().isValid());
+
+    const QByteArray plaintext = "Test plaintext data";
+    QBENCHMARK {
+        SignRequest sr;
+        sr.setManager(&cm);
+        sr.setKey(fullKey);
+        sr.setData(plaintext);
+        sr.setCryptoPluginName(OPENPGP_PLUGIN);
+        sr.startRequest();
+        SHORT_WAIT_FOR_FINISHED_WITHOUT_BLOCKING(sr);
+        QCOMPARE(sr.result().code(), Result::Succeeded);
+    }
+}
+
+void tst_gnupgplugin::encryptLatency()
+{
+    TmpKey fullKey(addKey(CryptoManager::AlgorithmRsa, CryptoManager::OperationEncrypt));
+    QVERIFY(fullKey.identifier().isValid());
+
+    const QByteArray plaintext = "Test plaintext data";
+    QBENCHMARK {
+        EncryptRequest er;
+        er.setManager(&cm);
+        er.setKey(fullKey);
+        er.setData(plaintext);
+        er.setCryptoPluginName(OPENPGP_PLUGIN);
+        er.startRequest();
+        SHORT_WAIT_FOR_FINISHED_WITHOUT_BLOCKING(er);
+        QCOMPARE(er.result().code(), Result::Succeeded);
+    }
+}
+
 #include "tst_gnupgplugin.moc"
 QTEST_MAIN(tst_gnupgplugin)
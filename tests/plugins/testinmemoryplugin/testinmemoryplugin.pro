@@ -0,0 +1,27 @@
+TEMPLATE = lib
+CONFIG += plugin hide_symbols link_pkgconfig
+TARGET = sailfishsecrets-testinmemory
+TARGET = $$qtLibraryTarget($$TARGET)
+PKGCONFIG += libcrypto
+
+include($$PWD/../../../common.pri)
+include($$PWD/../../../lib/libsailfishsecrets.pri)
+include($$PWD/../../../lib/libsailfishcryptoevp.pri)
+
+DEFINES += SAILFISHSECRETS_TESTPLUGIN
+
+INCLUDEPATH += \
+    $$PWD/../../../plugins/inmemoryplugin \
+    $$PWD/../../../plugins/opensslcryptoplugin/evp/
+DEPENDPATH += \
+    $$PWD/../../../plugins/inmemoryplugin \
+    $$PWD/../../../plugins/opensslcryptoplugin/evp/
+
+HEADERS += \
+    $$PWD/../../../plugins/inmemoryplugin/inmemoryplugin.h
+
+SOURCES += \
+    $$PWD/../../../plugins/inmemoryplugin/inmemoryplugin.cpp
+
+target.path=/usr/lib/Sailfish/Secrets/
+INSTALLS += target
@@ -0,0 +1,263 @@
+/*
+ * Copyright (C) 2018 Jolla Ltd.
+ * Contact: Chris Adams <chris.adams@jollamobile.com>
+ * All rights reserved.
+ * BSD 3-Clause License, see LICENSE.
+ */
+
+#include "latencyplugin.h"
+
+#include "Crypto/key.h"
+#include "Crypto/result.h"
+
+#include <QtCore/QByteArray>
+#include <QtCore/QVariantMap>
+#include <QtCore/QVector>
+#include <QtCore/QString>
+
+using namespace Sailfish::Secrets::Daemon::Plugins;
+using namespace Sailfish::Crypto;
+
+// The profile from the environment may be overridden by the custom
+// parameters of each request.  The operation itself is performed while
+// the simulated (possibly serialized) channel is held.
+#define SIMULATE_CRYPTO_OPERATION(customParameters, errorCode)          \
+    SimulatedOperation simulated(m_profile.withOverrides(customParameters), &m_channel); \
+    if (simulated.failed()) {                                           \
+        return Result(errorCode,                                        \
+                      QLatin1String("Injected latency plugin failure")); \
+    }
+
+Result
+LatencyPlugin::generateRandomData(
+        quint64 callerIdent,
+        const QString &csprngEngineName,
+        quint64 numberBytes,
+        const QVariantMap &customParameters,
+        QByteArray *randomData)
+{
+    SIMULATE_CRYPTO_OPERATION(customParameters, Result::CryptoPluginRandomDataError)
+    return m_crypto.generateRandomData(callerIdent, csprngEngineName, numberBytes, customParameters, randomData);
+}
+
+Result
+LatencyPlugin::seedRandomDataGenerator(
+        quint64 callerIdent,
+        const QString &csprngEngineName,
+        const QByteArray &seedData,
+        double entropyEstimate,
+        const QVariantMap &customParameters)
+{
+    SIMULATE_CRYPTO_OPERATION(customParameters, Result::CryptoPluginRandomDataError)
+    return m_crypto.seedRandomDataGenerator(callerIdent, csprngEngineName, seedData, entropyEstimate, customParameters);
+}
+
+Result
+LatencyPlugin::generateInitializationVector(
+        CryptoManager::Algorithm algorithm,
+        CryptoManager::BlockMode blockMode,
+        int keySize,
+        const QVariantMap &customParameters,
+        QByteArray *generatedIV)
+{
+    SIMULATE_CRYPTO_OPERATION(customParameters, Result::CryptoPluginRandomDataError)
+    return m_crypto.generateInitializationVector(algorithm, blockMode, keySize, customParameters, generatedIV);
+}
+
+Result
+LatencyPlugin::generateKey(
+        const Key &keyTemplate,
+        const KeyPairGenerationParameters &kpgParams,
+        const KeyDerivationParameters &skdfParams,
+        const QVariantMap &customParameters,
+        Key *key)
+{
+    SIMULATE_CRYPTO_OPERATION(customParameters, Result::CryptoPluginKeyGenerationError)
+    return m_crypto.generateKey(keyTemplate, kpgParams, skdfParams, customParameters, key);
+}
+
+Result
+LatencyPlugin::generateAndStoreKey(
+        const Key & /* keyTemplate */,
+        const KeyPairGenerationParameters & /* kpgParams */,
+        const KeyDerivationParameters & /* skdfParams */,
+        const QVariantMap & /* customParameters */,
+        Key * /* keyMetadata */)
+{
+    return Result(Result::OperationNotSupportedError,
+                  QLatin1String("The latency plugin doesn't support storing keys"));
+}
+
+Result
+LatencyPlugin::importKey(
+        const QByteArray &data,
+        const QByteArray &passphrase,
+        const QVariantMap &customParameters,
+        Key *importedKey)
+{
+    SIMULATE_CRYPTO_OPERATION(customParameters, Result::CryptoPluginKeyImportError)
+    return m_crypto.importKey(data, passphrase, customParameters, importedKey);
+}
+
+Result
+LatencyPlugin::importAndStoreKey(
+        const QByteArray & /* data */,
+        const Key & /* keyTemplate */,
+        const QByteArray & /* passphrase */,
+        const QVariantMap & /* customParameters */,
+        Key * /* keyMetadata */)
+{
+    return Result(Result::OperationNotSupportedError,
+                  QLatin1String("The latency plugin doesn't support storing keys"));
+}
+
+Result
+LatencyPlugin::storedKey(
+        const Key::Identifier & /* identifier */,
+        Key::Components /* keyComponents */,
+        const QVariantMap & /* customParameters */,
+        Key * /* key */)
+{
+    return Result(Result::OperationNotSupportedError,
+                  QLatin1String("The latency plugin doesn't support storing keys"));
+}
+
+Result
+LatencyPlugin::storedKeyIdentifiers(
+        const QString & /* collectionName */,
+        const QVariantMap & /* customParameters */,
+        QVector<Key::Identifier> * /* identifiers */)
+{
+    return Result(Result::OperationNotSupportedError,
+                  QLatin1String("The latency plugin doesn't support storing keys"));
+}
+
+Result
+LatencyPlugin::calculateDigest(
+        const QByteArray &data,
+        CryptoManager::SignaturePadding padding,
+        CryptoManager::DigestFunction digestFunction,
+        const QVariantMap &customParameters,
+        QByteArray *digest)
+{
+    SIMULATE_CRYPTO_OPERATION(customParameters, Result::CryptoPluginDigestError)
+    return m_crypto.calculateDigest(data, padding, digestFunction, customParameters, digest);
+}
+
+Result
+LatencyPlugin::sign(
+        const QByteArray &data,
+        const Key &key,
+        CryptoManager::SignaturePadding padding,
+        CryptoManager::DigestFunction digestFunction,
+        const QVariantMap &customParameters,
+        QByteArray *signature)
+{
+    SIMULATE_CRYPTO_OPERATION(customParameters, Result::CryptoPluginSigningError)
+    return m_crypto.sign(data, key, padding, digestFunction, customParameters, signature);
+}
+
+Result
+LatencyPlugin::verify(
+        const QByteArray &signature,
+        const QByteArray &data,
+        const Key &key,
+        CryptoManager::SignaturePadding padding,
+        CryptoManager::DigestFunction digestFunction,
+        const QVariantMap &customParameters,
+        CryptoManager::VerificationStatus *verificationStatus)
+{
+    SIMULATE_CRYPTO_OPERATION(customParameters, Result::CryptoPluginVerificationError)
+    return m_crypto.verify(signature, data, key, padding, digestFunction, customParameters, verificationStatus);
+}
+
+Result
+LatencyPlugin::encrypt(
+        const QByteArray &data,
+        const QByteArray &iv,
+        const Key &key,
+        CryptoManager::BlockMode blockMode,
+        CryptoManager::EncryptionPadding padding,
+        const QByteArray &authenticationData,
+        const QVariantMap &customParameters,
+        QByteArray *encrypted,
+        QByteArray *authenticationTag)
+{
+    SIMULATE_CRYPTO_OPERATION(customParameters, Result::CryptoPluginEncryptionError)
+    return m_crypto.encrypt(data, iv, key, blockMode, padding, authenticationData,
+                            customParameters, encrypted, authenticationTag);
+}
+
+Result
+LatencyPlugin::decrypt(
+        const QByteArray &data,
+        const QByteArray &iv,
+        const Key &key,
+        CryptoManager::BlockMode blockMode,
+        CryptoManager::EncryptionPadding padding,
+        const QByteArray &authenticationData,
+        const QByteArray &authenticationTag,
+        const QVariantMap &customParameters,
+        QByteArray *decrypted,
+        CryptoManager::VerificationStatus *verificationStatus)
+{
+    SIMULATE_CRYPTO_OPERATION(customParameters, Result::CryptoPluginDecryptionError)
+    return m_crypto.decrypt(data, iv, key, blockMode, padding, authenticationData, authenticationTag,
+                            customParameters, decrypted, verificationStatus);
+}
+
+Result
+LatencyPlugin::initializeCipherSession(
+        quint64 clientId,
+        const QByteArray &iv,
+        const Key &key,
+        CryptoManager::Operation operation,
+        CryptoManager::BlockMode blockMode,
+        CryptoManager::EncryptionPadding encryptionPadding,
+        CryptoManager::SignaturePadding signaturePadding,
+        CryptoManager::DigestFunction digestFunction,
+        const QVariantMap &customParameters,
+        quint32 *cipherSessionToken)
+{
+    SIMULATE_CRYPTO_OPERATION(customParameters, Result::CryptoPluginCipherSessionError)
+    return m_crypto.initializeCipherSession(clientId, iv, key, operation, blockMode,
+                                            encryptionPadding, signaturePadding, digestFunction,
+                                            customParameters, cipherSessionToken);
+}
+
+Result
+LatencyPlugin::updateCipherSessionAuthentication(
+        quint64 clientId,
+        const QByteArray &authenticationData,
+        const QVariantMap &customParameters,
+        quint32 cipherSessionToken)
+{
+    SIMULATE_CRYPTO_OPERATION(customParameters, Result::CryptoPluginCipherSessionError)
+    return m_crypto.updateCipherSessionAuthentication(clientId, authenticationData, customParameters, cipherSessionToken);
+}
+
+Result
+LatencyPlugin::updateCipherSession(
+        quint64 clientId,
+        const QByteArray &data,
+        const QVariantMap &customParameters,
+        quint32 cipherSessionToken,
+        QByteArray *generatedData)
+{
+    SIMULATE_CRYPTO_OPERATION(customParameters, Result::CryptoPluginCipherSessionError)
+    return m_crypto.updateCipherSession(clientId, data, customParameters, cipherSessionToken, generatedData);
+}
+
+Result
+LatencyPlugin::finalizeCipherSession(
+        quint64 clientId,
+        const QByteArray &data,
+        const QVariantMap &customParameters,
+        quint32 cipherSessionToken,
+        QByteArray *generatedData,
+        CryptoManager::VerificationStatus *verificationStatus)
+{
+    SIMULATE_CRYPTO_OPERATION(customParameters, Result::CryptoPluginCipherSessionError)
+    return m_crypto.finalizeCipherSession(clientId, data, customParameters, cipherSessionToken,
+                                          generatedData, verificationStatus);
+}
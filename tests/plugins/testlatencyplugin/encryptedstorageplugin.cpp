@@ -0,0 +1,288 @@
+/*
+ * Copyright (C) 2018 Jolla Ltd.
+ * Contact: Chris Adams <chris.adams@jollamobile.com>
+ * All rights reserved.
+ * BSD 3-Clause License, see LICENSE.
+ */
+
+#include "latencyplugin.h"
+
+#include "Secrets/result.h"
+
+#include <QtCore/QByteArray>
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+
+using namespace Sailfish::Secrets;
+using namespace Sailfish::Secrets::Daemon::Plugins;
+
+// The storage operations have no custom parameters, so they are
+// always performed according to the profile set in the environment.
+#define SIMULATE_STORAGE_OPERATION(errorCode)                           \
+    SimulatedOperation simulated(m_profile, &m_channel);                \
+    if (simulated.failed()) {                                           \
+        return Result(errorCode,                                        \
+                      QLatin1String("Injected latency plugin failure")); \
+    }                                                                   \
+    QMutexLocker locker(&m_storageMutex);
+
+Result
+LatencyPlugin::lockedOrMissing(
+        const QString &collectionName) const
+{
+    if (!m_collections.contains(collectionName)) {
+        return Result(Result::InvalidCollectionError,
+                      QStringLiteral("No such collection exists: %1").arg(collectionName));
+    }
+    if (m_collections.value(collectionName).locked) {
+        return Result(Result::CollectionIsLockedError,
+                      QStringLiteral("Collection %1 is locked").arg(collectionName));
+    }
+    return Result(Result::Succeeded);
+}
+
+Result
+LatencyPlugin::collectionNames(
+        QStringList *names)
+{
+    SIMULATE_STORAGE_OPERATION(Result::DatabaseError)
+    *names = m_collections.keys();
+    return Result(Result::Succeeded);
+}
+
+Result
+LatencyPlugin::createCollection(
+        const QString &collectionName,
+        const QByteArray &key)
+{
+    SIMULATE_STORAGE_OPERATION(Result::DatabaseError)
+    if (m_collections.contains(collectionName)) {
+        return Result(Result::CollectionAlreadyExistsError,
+                      QStringLiteral("Collection %1 already exists").arg(collectionName));
+    }
+
+    Collection collection;
+    collection.key = key;
+    m_collections.insert(collectionName, collection);
+    return Result(Result::Succeeded);
+}
+
+Result
+LatencyPlugin::removeCollection(
+        const QString &collectionName)
+{
+    SIMULATE_STORAGE_OPERATION(Result::DatabaseError)
+    m_collections.remove(collectionName);
+    return Result(Result::Succeeded);
+}
+
+Result
+LatencyPlugin::isCollectionLocked(
+        const QString &collectionName,
+        bool *locked)
+{
+    SIMULATE_STORAGE_OPERATION(Result::DatabaseError)
+    if (!m_collections.contains(collectionName)) {
+        return Result(Result::InvalidCollectionError,
+                      QStringLiteral("No such collection exists: %1").arg(collectionName));
+    }
+    *locked = m_collections.value(collectionName).locked;
+    return Result(Result::Succeeded);
+}
+
+Result
+LatencyPlugin::deriveKeyFromCode(
+        const QByteArray &authenticationCode,
+        const QByteArray &salt,
+        QByteArray *key)
+{
+    // The key derivation is not the subject of the simulation; the cost of
+    // a real key derivation function should be modelled via the CPU burn.
+    SIMULATE_STORAGE_OPERATION(Result::SecretsPluginKeyDerivationError)
+    *key = QCryptographicHash::hash(salt + authenticationCode, QCryptographicHash::Sha256);
+    return Result(Result::Succeeded);
+}
+
+Result
+LatencyPlugin::setEncryptionKey(
+        const QString &collectionName,
+        const QByteArray &key)
+{
+    SIMULATE_STORAGE_OPERATION(Result::DatabaseError)
+    if (!m_collections.contains(collectionName)) {
+        return Result(Result::InvalidCollectionError,
+                      QStringLiteral("No such collection exists: %1").arg(collectionName));
+    }
+
+    // an empty key locks the collection, the correct key unlocks it.
+    Collection &collection(m_collections[collectionName]);
+    if (key.isEmpty()) {
+        collection.locked = true;
+    } else if (key == collection.key) {
+        collection.locked = false;
+    } else {
+        return Result(Result::IncorrectAuthenticationCodeError,
+                      QStringLiteral("Incorrect key for collection %1").arg(collectionName));
+    }
+    return Result(Result::Succeeded);
+}
+
+Result
+LatencyPlugin::reencrypt(
+        const QString &collectionName,
+        const QByteArray &oldkey,
+        const QByteArray &newkey)
+{
+    SIMULATE_STORAGE_OPERATION(Result::SecretsPluginEncryptionError)
+    if (!m_collections.contains(collectionName)) {
+        return Result(Result::InvalidCollectionError,
+                      QStringLiteral("No such collection exists: %1").arg(collectionName));
+    }
+
+    Collection &collection(m_collections[collectionName]);
+    if (oldkey != collection.key) {
+        return Result(Result::IncorrectAuthenticationCodeError,
+                      QStringLiteral("Incorrect key for collection %1").arg(collectionName));
+    }
+    collection.key = newkey;
+    collection.locked = false;
+    return Result(Result::Succeeded);
+}
+
+Result
+LatencyPlugin::setSecret(
+        const QString &collectionName,
+        const QString &secretName,
+        const QByteArray &secret,
+        const Secret::FilterData &filterData)
+{
+    SIMULATE_STORAGE_OPERATION(Result::DatabaseError)
+    const Result result = lockedOrMissing(collectionName);
+    if (result.code() != Result::Succeeded) {
+        return result;
+    }
+
+    StoredSecret stored;
+    stored.data = secret;
+    stored.filterData = filterData;
+    m_collections[collectionName].secrets.insert(secretName, stored);
+    return Result(Result::Succeeded);
+}
+
+Result
+LatencyPlugin::getSecret(
+        const QString &collectionName,
+        const QString &secretName,
+        QByteArray *secret,
+        Secret::FilterData *filterData)
+{
+    SIMULATE_STORAGE_OPERATION(Result::DatabaseError)
+    const Result result = lockedOrMissing(collectionName);
+    if (result.code() != Result::Succeeded) {
+        return result;
+    }
+
+    const QHash<QString, StoredSecret> &secrets(m_collections[collectionName].secrets);
+    if (!secrets.contains(secretName)) {
+        return Result(Result::InvalidSecretError,
+                      QStringLiteral("No such secret %1 in collection %2").arg(secretName, collectionName));
+    }
+    *secret = secrets.value(secretName).data;
+    *filterData = secrets.value(secretName).filterData;
+    return Result(Result::Succeeded);
+}
+
+Result
+LatencyPlugin::secretNames(
+        const QString &collectionName,
+        QStringList *secretNames)
+{
+    SIMULATE_STORAGE_OPERATION(Result::DatabaseError)
+    const Result result = lockedOrMissing(collectionName);
+    if (result.code() != Result::Succeeded) {
+        return result;
+    }
+
+    *secretNames = m_collections[collectionName].secrets.keys();
+    return Result(Result::Succeeded);
+}
+
+Result
+LatencyPlugin::findSecrets(
+        const QString &collectionName,
+        const Secret::FilterData &filter,
+        StoragePlugin::FilterOperator filterOperator,
+        StoragePlugin::FilterMatch filterMatch,
+        QVector<Secret::Identifier> *identifiers)
+{
+    SIMULATE_STORAGE_OPERATION(Result::DatabaseError)
+    const Result result = lockedOrMissing(collectionName);
+    if (result.code() != Result::Succeeded) {
+        return result;
+    }
+
+    const QHash<QString, StoredSecret> &secrets(m_collections[collectionName].secrets);
+    for (QHash<QString, StoredSecret>::const_iterator it = secrets.constBegin(); it != secrets.constEnd(); ++it) {
+        if (StoragePlugin::filterDataMatches(it.value().filterData, filter, filterOperator, filterMatch)) {
+            identifiers->append(Secret::Identifier(it.key(), collectionName, name()));
+        }
+    }
+    return Result(Result::Succeeded);
+}
+
+Result
+LatencyPlugin::removeSecret(
+        const QString &collectionName,
+        const QString &secretName)
+{
+    SIMULATE_STORAGE_OPERATION(Result::DatabaseError)
+    const Result result = lockedOrMissing(collectionName);
+    if (result.code() != Result::Succeeded) {
+        return result;
+    }
+
+    m_collections[collectionName].secrets.remove(secretName);
+    return Result(Result::Succeeded);
+}
+
+Result
+LatencyPlugin::setSecret(
+        const QString & /* secretName */,
+        const QByteArray & /* secret */,
+        const Secret::FilterData & /* filterData */,
+        const QByteArray & /* key */)
+{
+    return Result(Result::OperationNotSupportedError,
+                  QLatin1String("The latency plugin doesn't support standalone secret operations"));
+}
+
+Result
+LatencyPlugin::accessSecret(
+        const QString & /* secretName */,
+        const QByteArray & /* key */,
+        QByteArray * /* secret */,
+        Secret::FilterData * /* filterData */)
+{
+    return Result(Result::OperationNotSupportedError,
+                  QLatin1String("The latency plugin doesn't support standalone secret operations"));
+}
+
+Result
+LatencyPlugin::removeSecret(
+        const QString & /* secretName */)
+{
+    return Result(Result::OperationNotSupportedError,
+                  QLatin1String("The latency plugin doesn't support standalone secret operations"));
+}
+
+Result
+LatencyPlugin::reencryptSecret(
+        const QString & /* secretName */,
+        const QByteArray & /* oldkey */,
+        const QByteArray & /* newkey */)
+{
+    return Result(Result::OperationNotSupportedError,
+                  QLatin1String("The latency plugin doesn't support standalone secret operations"));
+}
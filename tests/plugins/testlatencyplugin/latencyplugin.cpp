@@ -0,0 +1,191 @@
+/*
+ * Copyright (C) 2018 Jolla Ltd.
+ * Contact: Chris Adams <chris.adams@jollamobile.com>
+ * All rights reserved.
+ * BSD 3-Clause License, see LICENSE.
+ */
+
+#include "latencyplugin.h"
+
+#include <QtCore/QByteArray>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QThread>
+
+#include <QtDebug>
+
+#include <random>
+
+Q_PLUGIN_METADATA(IID Sailfish_Secrets_EncryptedStoragePlugin_IID)
+
+using namespace Sailfish::Secrets::Daemon::Plugins;
+
+namespace {
+    std::mt19937 &randomEngine()
+    {
+        // each daemon request processor thread has its own engine,
+        // so that sampling doesn't serialize otherwise parallel operations.
+        static thread_local std::mt19937 engine(std::random_device{}());
+        return engine;
+    }
+
+    bool parseBool(const QString &value)
+    {
+        const QString lowered = value.trimmed().toLower();
+        return lowered == QLatin1String("1")
+                || lowered == QLatin1String("true")
+                || lowered == QLatin1String("yes");
+    }
+
+    double parseDouble(const QString &value, double defaultValue)
+    {
+        bool ok = false;
+        const double parsed = value.trimmed().toDouble(&ok);
+        return ok && parsed >= 0 ? parsed : defaultValue;
+    }
+}
+
+LatencyProfile LatencyProfile::fromEnvironment()
+{
+    LatencyProfile profile;
+    const QString latency = QString::fromLocal8Bit(qgetenv(ENV_LATENCY_PLUGIN_LATENCY));
+    if (!latency.isEmpty() && !profile.setLatency(latency)) {
+        qWarning() << "Ignoring invalid latency specification:" << latency;
+    }
+    profile.cpuBurnMsecs = parseDouble(QString::fromLocal8Bit(qgetenv(ENV_LATENCY_PLUGIN_CPU_BURN)), 0);
+    profile.failureRate = qMin(parseDouble(QString::fromLocal8Bit(qgetenv(ENV_LATENCY_PLUGIN_FAILURE_RATE)), 0), 1.0);
+    profile.serialized = parseBool(QString::fromLocal8Bit(qgetenv(ENV_LATENCY_PLUGIN_SERIALIZED)));
+    return profile;
+}
+
+LatencyProfile LatencyProfile::withOverrides(const QVariantMap &customParameters) const
+{
+    LatencyProfile profile(*this);
+    if (customParameters.contains(QStringLiteral("latency"))
+            && !profile.setLatency(customParameters.value(QStringLiteral("latency")).toString())) {
+        qWarning() << "Ignoring invalid latency specification:"
+                   << customParameters.value(QStringLiteral("latency"));
+    }
+    if (customParameters.contains(QStringLiteral("cpuBurn"))) {
+        profile.cpuBurnMsecs = parseDouble(customParameters.value(QStringLiteral("cpuBurn")).toString(),
+                                           cpuBurnMsecs);
+    }
+    if (customParameters.contains(QStringLiteral("failureRate"))) {
+        profile.failureRate = qMin(parseDouble(customParameters.value(QStringLiteral("failureRate")).toString(),
+                                               failureRate), 1.0);
+    }
+    if (customParameters.contains(QStringLiteral("serialized"))) {
+        profile.serialized = parseBool(customParameters.value(QStringLiteral("serialized")).toString());
+    }
+    return profile;
+}
+
+bool LatencyProfile::setLatency(const QString &specification)
+{
+    const QStringList parts = specification.trimmed().split(QLatin1Char(':'));
+    QVector<double> values;
+    for (int i = (parts.size() > 1 ? 1 : 0); i < parts.size(); ++i) {
+        bool ok = false;
+        const double value = parts.at(i).toDouble(&ok);
+        if (!ok || value < 0) {
+            return false;
+        }
+        values.append(value);
+    }
+
+    const QString type = parts.size() > 1 ? parts.first().toLower() : QStringLiteral("fixed");
+    if (type == QLatin1String("fixed") && values.size() == 1) {
+        distribution = Fixed;
+        first = values.at(0);
+        second = 0;
+    } else if (type == QLatin1String("uniform") && values.size() == 2 && values.at(0) <= values.at(1)) {
+        distribution = Uniform;
+        first = values.at(0);
+        second = values.at(1);
+    } else if (type == QLatin1String("exponential") && values.size() == 1) {
+        distribution = Exponential;
+        first = values.at(0);
+        second = 0;
+    } else if (type == QLatin1String("normal") && values.size() == 2) {
+        distribution = Normal;
+        first = values.at(0);
+        second = values.at(1);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+double LatencyProfile::sampleLatencyMsecs() const
+{
+    switch (distribution) {
+        case Uniform: {
+            std::uniform_real_distribution<double> uniform(first, second);
+            return uniform(randomEngine());
+        }
+        case Exponential: {
+            if (first <= 0) {
+                return 0;
+            }
+            std::exponential_distribution<double> exponential(1.0 / first);
+            return exponential(randomEngine());
+        }
+        case Normal: {
+            if (second <= 0) {
+                return first;
+            }
+            std::normal_distribution<double> normal(first, second);
+            return qMax(0.0, normal(randomEngine()));
+        }
+        default: break;
+    }
+    return first;
+}
+
+SimulatedOperation::SimulatedOperation(const LatencyProfile &profile, QMutex *channel)
+    : m_channel(profile.serialized ? channel : Q_NULLPTR)
+    , m_failed(false)
+{
+    if (m_channel) {
+        m_channel->lock();
+    }
+
+    const qint64 latencyUsecs = static_cast<qint64>(profile.sampleLatencyMsecs() * 1000);
+    if (latencyUsecs > 0) {
+        QThread::usleep(static_cast<unsigned long>(latencyUsecs));
+    }
+
+    if (profile.cpuBurnMsecs > 0) {
+        const qint64 burnNsecs = static_cast<qint64>(profile.cpuBurnMsecs * 1000000);
+        QElapsedTimer timer;
+        timer.start();
+        volatile quint64 spin = 0;
+        while (timer.nsecsElapsed() < burnNsecs) {
+            spin = spin + 1;
+        }
+    }
+
+    if (profile.failureRate > 0) {
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+        m_failed = uniform(randomEngine()) < profile.failureRate;
+    }
+}
+
+SimulatedOperation::~SimulatedOperation()
+{
+    if (m_channel) {
+        m_channel->unlock();
+    }
+}
+
+LatencyPlugin::LatencyPlugin(QObject *parent)
+    : QObject(parent)
+    , m_profile(LatencyProfile::fromEnvironment())
+    , m_crypto(this)
+{
+}
+
+LatencyPlugin::~LatencyPlugin()
+{
+}
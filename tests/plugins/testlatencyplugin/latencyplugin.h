@@ -0,0 +1,341 @@
+/*
+ * Copyright (C) 2018 Jolla Ltd.
+ * Contact: Chris Adams <chris.adams@jollamobile.com>
+ * All rights reserved.
+ * BSD 3-Clause License, see LICENSE.
+ */
+
+#ifndef SAILFISHSECRETS_PLUGIN_CRYPTOSTORAGE_LATENCY_H
+#define SAILFISHSECRETS_PLUGIN_CRYPTOSTORAGE_LATENCY_H
+
+#include "Secrets/Plugins/extensionplugins.h"
+
+#include "Secrets/secret.h"
+#include "Secrets/result.h"
+
+#include "Crypto/Plugins/extensionplugins.h"
+
+#include "Crypto/key.h"
+#include "Crypto/result.h"
+
+#include "opensslcryptoplugin.h"
+
+#include <QObject>
+#include <QHash>
+#include <QMutex>
+#include <QVector>
+#include <QString>
+#include <QByteArray>
+#include <QVariantMap>
+
+// Environment variables which configure the default behaviour of the plugin.
+// Crypto operations may override each of these via the custom parameters
+// of the request, using the keys "latency", "cpuBurn", "failureRate" and
+// "serialized" respectively.
+#define ENV_LATENCY_PLUGIN_LATENCY      "SAILFISH_SECRETS_LATENCY_PLUGIN_LATENCY"
+#define ENV_LATENCY_PLUGIN_CPU_BURN     "SAILFISH_SECRETS_LATENCY_PLUGIN_CPU_BURN"
+#define ENV_LATENCY_PLUGIN_FAILURE_RATE "SAILFISH_SECRETS_LATENCY_PLUGIN_FAILURE_RATE"
+#define ENV_LATENCY_PLUGIN_SERIALIZED   "SAILFISH_SECRETS_LATENCY_PLUGIN_SERIALIZED"
+
+namespace Sailfish {
+
+namespace Secrets {
+
+namespace Daemon {
+
+namespace Plugins {
+
+// The simulated cost of each plugin operation.
+// The latency is specified as a distribution of milliseconds, one of:
+//   fixed:<ms>, uniform:<min>:<max>, exponential:<mean>, normal:<mean>:<stddev>
+// (a plain number is treated as a fixed latency).  The latency is spent
+// sleeping, while the CPU burn (in milliseconds) is spent busy-looping,
+// so that the two can model I/O-bound and CPU-bound plugins respectively.
+// A fraction of operations (given by the failure rate, from 0 to 1) fail.
+// If serialized, only one operation may be in progress at any time,
+// simulating a hardware token with a single communication channel.
+struct LatencyProfile
+{
+    enum Distribution {
+        Fixed = 0,
+        Uniform,
+        Exponential,
+        Normal
+    };
+
+    static LatencyProfile fromEnvironment();
+    LatencyProfile withOverrides(const QVariantMap &customParameters) const;
+    bool setLatency(const QString &specification);
+    double sampleLatencyMsecs() const;
+
+    Distribution distribution = Fixed;
+    double first = 0;
+    double second = 0;
+    double cpuBurnMsecs = 0;
+    double failureRate = 0;
+    bool serialized = false;
+};
+
+// Applies a latency profile to a single plugin operation, from construction
+// until destruction.  If the profile is serialized, the simulated channel is
+// held for the whole lifetime of the object, so the operation itself should
+// be performed while the object is alive.
+class SimulatedOperation
+{
+public:
+    SimulatedOperation(const LatencyProfile &profile, QMutex *channel);
+    ~SimulatedOperation();
+
+    bool failed() const { return m_failed; }
+
+private:
+    Q_DISABLE_COPY(SimulatedOperation)
+    QMutex *m_channel;
+    bool m_failed;
+};
+
+// we need to do some function renaming to override the appropriate methods correctly.
+class LatencyEncryptedStoragePlugin : public virtual Sailfish::Secrets::EncryptedStoragePlugin
+{
+public:
+    LatencyEncryptedStoragePlugin() : Sailfish::Secrets::EncryptedStoragePlugin() {}
+    virtual Sailfish::Secrets::EncryptionPlugin::EncryptionType encryptedStorageEncryptionType() const = 0;
+    Sailfish::Secrets::EncryptionPlugin::EncryptionType encryptionType() const Q_DECL_OVERRIDE
+    { return encryptedStorageEncryptionType(); }
+};
+
+class LatencyCryptoPlugin : public virtual Sailfish::Crypto::CryptoPlugin
+{
+public:
+    LatencyCryptoPlugin() : Sailfish::Crypto::CryptoPlugin() {}
+    virtual Sailfish::Crypto::CryptoPlugin::EncryptionType cryptoEncryptionType() const = 0;
+    Sailfish::Crypto::CryptoPlugin::EncryptionType encryptionType() const Q_DECL_OVERRIDE
+    { return cryptoEncryptionType(); }
+};
+
+// A test-only encrypted storage and crypto plugin with controllable
+// performance characteristics, for benchmarking the scheduling and
+// concurrency behaviour of the daemon without real hardware.
+// Secrets are held in memory, and crypto operations are performed
+// by an embedded OpenSSL crypto plugin.
+class Q_DECL_EXPORT LatencyPlugin : public QObject
+                                  , public virtual Sailfish::Secrets::Daemon::Plugins::LatencyEncryptedStoragePlugin
+                                  , public virtual Sailfish::Secrets::Daemon::Plugins::LatencyCryptoPlugin
+{
+    Q_OBJECT
+    Q_PLUGIN_METADATA(IID Sailfish_Secrets_EncryptedStoragePlugin_IID)
+    Q_INTERFACES(Sailfish::Secrets::EncryptedStoragePlugin Sailfish::Crypto::CryptoPlugin)
+
+public:
+    LatencyPlugin(QObject *parent = Q_NULLPTR);
+    ~LatencyPlugin();
+
+    QString displayName() const Q_DECL_OVERRIDE {
+        return QStringLiteral("Latency Injection");
+    }
+    QString name() const Q_DECL_OVERRIDE {
+        return QLatin1String("org.sailfishos.secrets.plugin.cryptostorage.latency.test");
+    }
+    int version() const Q_DECL_OVERRIDE {
+        return 1;
+    }
+
+    // This plugin implements the EncryptedStoragePlugin interface
+    Sailfish::Secrets::StoragePlugin::StorageType storageType() const Q_DECL_OVERRIDE { return Sailfish::Secrets::StoragePlugin::InMemoryStorage; }
+    Sailfish::Secrets::EncryptionPlugin::EncryptionType encryptedStorageEncryptionType() const Q_DECL_OVERRIDE { return Sailfish::Secrets::EncryptionPlugin::SoftwareEncryption; }
+    Sailfish::Secrets::EncryptionPlugin::EncryptionAlgorithm encryptionAlgorithm() const Q_DECL_OVERRIDE { return Sailfish::Secrets::EncryptionPlugin::AES_256_CBC; }
+
+    Sailfish::Secrets::Result collectionNames(QStringList *names) Q_DECL_OVERRIDE;
+    Sailfish::Secrets::Result createCollection(const QString &collectionName, const QByteArray &key) Q_DECL_OVERRIDE;
+    Sailfish::Secrets::Result removeCollection(const QString &collectionName) Q_DECL_OVERRIDE;
+
+    Sailfish::Secrets::Result isCollectionLocked(const QString &collectionName, bool *locked) Q_DECL_OVERRIDE;
+    Sailfish::Secrets::Result deriveKeyFromCode(const QByteArray &authenticationCode, const QByteArray &salt, QByteArray *key) Q_DECL_OVERRIDE;
+    Sailfish::Secrets::Result setEncryptionKey(const QString &collectionName, const QByteArray &key) Q_DECL_OVERRIDE;
+    Sailfish::Secrets::Result reencrypt(const QString &collectionName, const QByteArray &oldkey, const QByteArray &newkey) Q_DECL_OVERRIDE;
+
+    Sailfish::Secrets::Result setSecret(const QString &collectionName, const QString &secretName, const QByteArray &secret, const Sailfish::Secrets::Secret::FilterData &filterData) Q_DECL_OVERRIDE;
+    Sailfish::Secrets::Result getSecret(const QString &collectionName, const QString &secretName, QByteArray *secret, Sailfish::Secrets::Secret::FilterData *filterData) Q_DECL_OVERRIDE;
+    Sailfish::Secrets::Result secretNames(const QString &collectionName, QStringList *secretNames) Q_DECL_OVERRIDE;
+    Sailfish::Secrets::Result findSecrets(const QString &collectionName, const Sailfish::Secrets::Secret::FilterData &filter, Sailfish::Secrets::StoragePlugin::FilterOperator filterOperator, Sailfish::Secrets::StoragePlugin::FilterMatch filterMatch, QVector<Sailfish::Secrets::Secret::Identifier> *identifiers) Q_DECL_OVERRIDE;
+    Sailfish::Secrets::Result removeSecret(const QString &collectionName, const QString &secretName) Q_DECL_OVERRIDE;
+
+    Sailfish::Secrets::Result setSecret(const QString &secretName, const QByteArray &secret, const Sailfish::Secrets::Secret::FilterData &filterData, const QByteArray &key) Q_DECL_OVERRIDE;
+    Sailfish::Secrets::Result accessSecret(const QString &secretName, const QByteArray &key, QByteArray *secret, Sailfish::Secrets::Secret::FilterData *filterData) Q_DECL_OVERRIDE;
+    Sailfish::Secrets::Result removeSecret(const QString &secretName) Q_DECL_OVERRIDE;
+    Sailfish::Secrets::Result reencryptSecret(const QString &secretName, const QByteArray &oldkey, const QByteArray &newkey) Q_DECL_OVERRIDE;
+
+    // And it also implements the CryptoPlugin interface
+    bool canStoreKeys() const Q_DECL_OVERRIDE { return false; }
+    Sailfish::Crypto::CryptoPlugin::EncryptionType cryptoEncryptionType() const Q_DECL_OVERRIDE { return Sailfish::Crypto::CryptoPlugin::SoftwareEncryption; }
+
+    Sailfish::Crypto::Result generateRandomData(
+            quint64 callerIdent,
+            const QString &csprngEngineName,
+            quint64 numberBytes,
+            const QVariantMap &customParameters,
+            QByteArray *randomData) Q_DECL_OVERRIDE;
+
+    Sailfish::Crypto::Result seedRandomDataGenerator(
+            quint64 callerIdent,
+            const QString &csprngEngineName,
+            const QByteArray &seedData,
+            double entropyEstimate,
+            const QVariantMap &customParameters) Q_DECL_OVERRIDE;
+
+    Sailfish::Crypto::Result generateInitializationVector(
+            Sailfish::Crypto::CryptoManager::Algorithm algorithm,
+            Sailfish::Crypto::CryptoManager::BlockMode blockMode,
+            int keySize,
+            const QVariantMap &customParameters,
+            QByteArray *generatedIV) Q_DECL_OVERRIDE;
+
+    Sailfish::Crypto::Result generateKey(
+            const Sailfish::Crypto::Key &keyTemplate,
+            const Sailfish::Crypto::KeyPairGenerationParameters &kpgParams,
+            const Sailfish::Crypto::KeyDerivationParameters &skdfParams,
+            const QVariantMap &customParameters,
+            Sailfish::Crypto::Key *key) Q_DECL_OVERRIDE;
+
+    Sailfish::Crypto::Result generateAndStoreKey(
+            const Sailfish::Crypto::Key &keyTemplate,
+            const Sailfish::Crypto::KeyPairGenerationParameters &kpgParams,
+            const Sailfish::Crypto::KeyDerivationParameters &skdfParams,
+            const QVariantMap &customParameters,
+            Sailfish::Crypto::Key *keyMetadata) Q_DECL_OVERRIDE;
+
+    Sailfish::Crypto::Result importKey(
+            const QByteArray &data,
+            const QByteArray &passphrase,
+            const QVariantMap &customParameters,
+            Sailfish::Crypto::Key *importedKey) Q_DECL_OVERRIDE;
+
+    Sailfish::Crypto::Result importAndStoreKey(
+            const QByteArray &data,
+            const Sailfish::Crypto::Key &keyTemplate,
+            const QByteArray &passphrase,
+            const QVariantMap &customParameters,
+            Sailfish::Crypto::Key *keyMetadata) Q_DECL_OVERRIDE;
+
+    Sailfish::Crypto::Result storedKey(
+            const Sailfish::Crypto::Key::Identifier &identifier,
+            Sailfish::Crypto::Key::Components keyComponents,
+            const QVariantMap &customParameters,
+            Sailfish::Crypto::Key *key) Q_DECL_OVERRIDE;
+
+    Sailfish::Crypto::Result storedKeyIdentifiers(
+            const QString &collectionName,
+            const QVariantMap &customParameters,
+            QVector<Sailfish::Crypto::Key::Identifier> *identifiers) Q_DECL_OVERRIDE;
+
+    Sailfish::Crypto::Result calculateDigest(
+            const QByteArray &data,
+            Sailfish::Crypto::CryptoManager::SignaturePadding padding,
+            Sailfish::Crypto::CryptoManager::DigestFunction digestFunction,
+            const QVariantMap &customParameters,
+            QByteArray *digest) Q_DECL_OVERRIDE;
+
+    Sailfish::Crypto::Result sign(
+            const QByteArray &data,
+            const Sailfish::Crypto::Key &key,
+            Sailfish::Crypto::CryptoManager::SignaturePadding padding,
+            Sailfish::Crypto::CryptoManager::DigestFunction digestFunction,
+            const QVariantMap &customParameters,
+            QByteArray *signature) Q_DECL_OVERRIDE;
+
+    Sailfish::Crypto::Result verify(
+            const QByteArray &signature,
+            const QByteArray &data,
+            const Sailfish::Crypto::Key &key,
+            Sailfish::Crypto::CryptoManager::SignaturePadding padding,
+            Sailfish::Crypto::CryptoManager::DigestFunction digestFunction,
+            const QVariantMap &customParameters,
+            Sailfish::Crypto::CryptoManager::VerificationStatus *verificationStatus) Q_DECL_OVERRIDE;
+
+    Sailfish::Crypto::Result encrypt(
+            const QByteArray &data,
+            const QByteArray &iv,
+            const Sailfish::Crypto::Key &key,
+            Sailfish::Crypto::CryptoManager::BlockMode blockMode,
+            Sailfish::Crypto::CryptoManager::EncryptionPadding padding,
+            const QByteArray &authenticationData,
+            const QVariantMap &customParameters,
+            QByteArray *encrypted,
+            QByteArray *authenticationTag) Q_DECL_OVERRIDE;
+
+    Sailfish::Crypto::Result decrypt(
+            const QByteArray &data,
+            const QByteArray &iv,
+            const Sailfish::Crypto::Key &key,
+            Sailfish::Crypto::CryptoManager::BlockMode blockMode,
+            Sailfish::Crypto::CryptoManager::EncryptionPadding padding,
+            const QByteArray &authenticationData,
+            const QByteArray &authenticationTag,
+            const QVariantMap &customParameters,
+            QByteArray *decrypted,
+            Sailfish::Crypto::CryptoManager::VerificationStatus *verificationStatus) Q_DECL_OVERRIDE;
+
+    Sailfish::Crypto::Result initializeCipherSession(
+            quint64 clientId,
+            const QByteArray &iv,
+            const Sailfish::Crypto::Key &key, // or keyreference, i.e. Key(keyName)
+            Sailfish::Crypto::CryptoManager::Operation operation,
+            Sailfish::Crypto::CryptoManager::BlockMode blockMode,
+            Sailfish::Crypto::CryptoManager::EncryptionPadding encryptionPadding,
+            Sailfish::Crypto::CryptoManager::SignaturePadding signaturePadding,
+            Sailfish::Crypto::CryptoManager::DigestFunction digestFunction,
+            const QVariantMap &customParameters,
+            quint32 *cipherSessionToken) Q_DECL_OVERRIDE;
+
+    Sailfish::Crypto::Result updateCipherSessionAuthentication(
+            quint64 clientId,
+            const QByteArray &authenticationData,
+            const QVariantMap &customParameters,
+            quint32 cipherSessionToken) Q_DECL_OVERRIDE;
+
+    Sailfish::Crypto::Result updateCipherSession(
+            quint64 clientId,
+            const QByteArray &data,
+            const QVariantMap &customParameters,
+            quint32 cipherSessionToken,
+            QByteArray *generatedData) Q_DECL_OVERRIDE;
+
+    Sailfish::Crypto::Result finalizeCipherSession(
+            quint64 clientId,
+            const QByteArray &data,
+            const QVariantMap &customParameters,
+            quint32 cipherSessionToken,
+            QByteArray *generatedData,
+            Sailfish::Crypto::CryptoManager::VerificationStatus *verificationStatus) Q_DECL_OVERRIDE;
+
+private:
+    struct StoredSecret {
+        QByteArray data;
+        Sailfish::Secrets::Secret::FilterData filterData;
+    };
+    struct Collection {
+        QByteArray key;
+        bool locked = false;
+        QHash<QString, StoredSecret> secrets;
+    };
+
+    Sailfish::Secrets::Result lockedOrMissing(const QString &collectionName) const;
+
+    LatencyProfile m_profile;
+    QMutex m_channel;
+    mutable QMutex m_storageMutex;
+    QHash<QString, Collection> m_collections;
+
+    // The crypto operations themselves are performed by OpenSSL.
+    Sailfish::Crypto::Daemon::Plugins::OpenSslCryptoPlugin m_crypto;
+};
+
+} // namespace Plugins
+
+} // namespace Daemon
+
+} // namespace Secrets
+
+} // namespace Sailfish
+
+#endif // SAILFISHSECRETS_PLUGIN_CRYPTOSTORAGE_LATENCY_H
@@ -0,0 +1,32 @@
+TEMPLATE = lib
+CONFIG += plugin hide_symbols link_pkgconfig
+TARGET = sailfishsecrets-testlatency
+TARGET = $$qtLibraryTarget($$TARGET)
+PKGCONFIG += libcrypto
+
+include($$PWD/../../../common.pri)
+include($$PWD/../../../lib/libsailfishsecrets.pri)
+include($$PWD/../../../lib/libsailfishcrypto.pri)
+include($$PWD/../../../lib/libsailfishcryptoevp.pri)
+
+DEFINES += SAILFISHSECRETS_TESTPLUGIN
+
+INCLUDEPATH += \
+    $$PWD/../../../plugins/opensslcryptoplugin \
+    $$PWD/../../../plugins/opensslcryptoplugin/evp
+DEPENDPATH += \
+    $$PWD/../../../plugins/opensslcryptoplugin \
+    $$PWD/../../../plugins/opensslcryptoplugin/evp/
+
+HEADERS += \
+    $$PWD/../../../plugins/opensslcryptoplugin/opensslcryptoplugin.h \
+    $$PWD/latencyplugin.h
+
+SOURCES += \
+    $$PWD/../../../plugins/opensslcryptoplugin/opensslcryptoplugin.cpp \
+    $$PWD/latencyplugin.cpp \
+    $$PWD/encryptedstorageplugin.cpp \
+    $$PWD/cryptoplugin.cpp
+
+target.path=/usr/lib/Sailfish/Secrets/
+INSTALLS += target
@@ -4,6 +4,7 @@ TARGET = sailfishcrypto-testopenpgp
 TARGET = $$qtLibraryTarget($$TARGET)
 LIBS += $$system(gpgme-config --libs)
 PKGCONFIG += libcrypto
+QT += dbus
 
 include($$PWD/../../../common.pri)
 include($$PWD/../../../lib/libsailfishcrypto.pri)
@@ -14,10 +15,12 @@ DEFINES += SAILFISHCRYPTO_TESTPLUGIN
 HEADERS += $$PWD/../../../plugins/gnupgplugin/openpgpplugin/plugin.h \
            $$PWD/../../../plugins/gnupgplugin/gpgmebase.h \
            $$PWD/../../../plugins/gnupgplugin/gpgmestorage.h \
-           $$PWD/../../../plugins/gnupgplugin/gpgme_p.h
+           $$PWD/../../../plugins/gnupgplugin/gpgme_p.h \
+           $$PWD/../../../plugins/gnupgplugin/gpgmepool_p.h
 SOURCES += $$PWD/../../../plugins/gnupgplugin/openpgpplugin/plugin.cpp \
            $$PWD/../../../plugins/gnupgplugin/gpgmebase.cpp \
-           $$PWD/../../../plugins/gnupgplugin/gpgmestorage.cpp
+           $$PWD/../../../plugins/gnupgplugin/gpgmestorage.cpp \
+           $$PWD/../../../plugins/gnupgplugin/gpgmepool.cpp
 
 target.path=/usr/lib/Sailfish/Crypto/
 INSTALLS += target
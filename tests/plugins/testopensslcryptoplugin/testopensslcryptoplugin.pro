@@ -6,6 +6,7 @@ PKGCONFIG += libcrypto
 
 include($$PWD/../../../common.pri)
 include($$PWD/../../../lib/libsailfishcrypto.pri)
+include($$PWD/../../../lib/libsailfishcryptoevp.pri)
 
 DEFINES += SAILFISHCRYPTO_TESTPLUGIN SAILFISHCRYPTO_BUILD_OPENSSLCRYPTOPLUGIN
 
@@ -13,11 +14,9 @@ INCLUDEPATH += $$PWD/../../../plugins/opensslcryptoplugin/evp/
 DEPENDPATH += $$PWD/../../../plugins/opensslcryptoplugin/evp/
 
 HEADERS += \
-    $$PWD/../../../plugins/opensslcryptoplugin/evp/evp_p.h \
     $$PWD/../../../plugins/opensslcryptoplugin/opensslcryptoplugin.h
 
 SOURCES += \
-    $$PWD/../../../plugins/opensslcryptoplugin/evp/evp.cpp \
     $$PWD/../../../plugins/opensslcryptoplugin/opensslcryptoplugin.cpp
 
 target.path=/usr/lib/Sailfish/Crypto/
@@ -6,6 +6,7 @@ PKGCONFIG += libcrypto
 
 include($$PWD/../../../common.pri)
 include($$PWD/../../../lib/libsailfishsecrets.pri)
+include($$PWD/../../../lib/libsailfishcryptoevp.pri)
 
 DEFINES += SAILFISHSECRETS_TESTPLUGIN
 
@@ -13,11 +14,9 @@ INCLUDEPATH += $$PWD/../../../plugins/opensslcryptoplugin/evp/
 DEPENDPATH += $$PWD/../../../plugins/opensslcryptoplugin/evp/
 
 HEADERS += \
-    $$PWD/../../../plugins/opensslcryptoplugin/evp/evp_p.h \
     $$PWD/../../../plugins/opensslplugin/plugin.h
 
 SOURCES += \
-    $$PWD/../../../plugins/opensslcryptoplugin/evp/evp.cpp \
     $$PWD/../../../plugins/opensslplugin/plugin.cpp
 
 target.path=/usr/lib/Sailfish/Secrets/
@@ -0,0 +1,338 @@
+/*
+ * Copyright (C) 2018 Jolla Ltd.
+ * Contact: Chris Adams <chris.adams@jollamobile.com>
+ * All rights reserved.
+ * BSD 3-Clause License, see LICENSE.
+ */
+
+#include "loadworker.h"
+
+#include <Secrets/createcollectionrequest.h>
+#include <Secrets/deletecollectionrequest.h>
+
+#include <Crypto/generatekeyrequest.h>
+#include <Crypto/generateinitializationvectorrequest.h>
+#include <Crypto/keypairgenerationparameters.h>
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDateTime>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QJsonArray>
+#include <QtCore/QtDebug>
+
+#define TEST_STORAGE_PLUGIN (Sailfish::Secrets::SecretManager::DefaultStoragePluginName + QLatin1String(".test"))
+#define TEST_ENCRYPTION_PLUGIN (Sailfish::Secrets::SecretManager::DefaultEncryptionPluginName + QLatin1String(".test"))
+#define TEST_CRYPTO_PLUGIN (Sailfish::Crypto::CryptoManager::DefaultCryptoPluginName + QLatin1String(".test"))
+
+namespace {
+    const QString StoreType = QStringLiteral("store");
+    const QString GetType = QStringLiteral("get");
+    const QString FindType = QStringLiteral("find");
+    const QString EncryptType = QStringLiteral("encrypt");
+    const QString SignType = QStringLiteral("sign");
+
+    bool runRequest(Sailfish::Secrets::Request *request)
+    {
+        request->startRequest();
+        request->waitForFinished();
+        return request->status() == Sailfish::Secrets::Request::Finished
+                && request->result().code() == Sailfish::Secrets::Result::Succeeded;
+    }
+
+    bool runRequest(Sailfish::Crypto::Request *request)
+    {
+        request->startRequest();
+        request->waitForFinished();
+        return request->status() == Sailfish::Crypto::Request::Finished
+                && request->result().code() == Sailfish::Crypto::Result::Succeeded;
+    }
+}
+
+QStringList LoadConfiguration::requestTypes()
+{
+    return QStringList() << StoreType << GetType << FindType << EncryptType << SignType;
+}
+
+bool LoadConfiguration::parseMix(const QString &mix, QMap<QString, int> *weights)
+{
+    QMap<QString, int> parsed;
+    const QStringList entries = mix.split(QLatin1Char(','), QString::SkipEmptyParts);
+    for (const QString &entry : entries) {
+        const QStringList parts = entry.split(QLatin1Char('='));
+        bool ok = false;
+        const int weight = parts.size() == 2 ? parts.at(1).toInt(&ok) : 0;
+        if (!ok || weight < 0 || !requestTypes().contains(parts.at(0))) {
+            return false;
+        }
+        if (weight > 0) {
+            parsed.insert(parts.at(0), weight);
+        }
+    }
+    if (parsed.isEmpty()) {
+        return false;
+    }
+    *weights = parsed;
+    return true;
+}
+
+LoadWorker::LoadWorker(int index, const LoadConfiguration &config)
+    : m_config(config)
+    , m_collectionName(QStringLiteral("loadgen%1").arg(QCoreApplication::applicationPid()))
+    , m_data(config.dataSize, 'x')
+    , m_index(index)
+{
+    for (int weight : m_config.mix) {
+        m_totalWeight += weight;
+    }
+    qsrand(uint(QDateTime::currentMSecsSinceEpoch()) ^ uint(QCoreApplication::applicationPid()));
+
+    m_storeRequest.setManager(&m_secretManager);
+    m_storeRequest.setSecretStorageType(Sailfish::Secrets::StoreSecretRequest::CollectionSecret);
+    m_storeRequest.setUserInteractionMode(Sailfish::Secrets::SecretManager::ApplicationInteraction);
+
+    m_storedRequest.setManager(&m_secretManager);
+    m_storedRequest.setUserInteractionMode(Sailfish::Secrets::SecretManager::ApplicationInteraction);
+
+    m_findRequest.setManager(&m_secretManager);
+    m_findRequest.setCollectionName(m_collectionName);
+    m_findRequest.setStoragePluginName(TEST_STORAGE_PLUGIN);
+    m_findRequest.setFilterOperator(Sailfish::Secrets::SecretManager::OperatorAnd);
+    m_findRequest.setUserInteractionMode(Sailfish::Secrets::SecretManager::PreventInteraction);
+
+    m_encryptRequest.setManager(&m_cryptoManager);
+    m_encryptRequest.setData(m_data);
+    m_encryptRequest.setBlockMode(Sailfish::Crypto::CryptoManager::BlockModeCbc);
+    m_encryptRequest.setPadding(Sailfish::Crypto::CryptoManager::EncryptionPaddingNone);
+    m_encryptRequest.setCryptoPluginName(TEST_CRYPTO_PLUGIN);
+
+    m_signRequest.setManager(&m_cryptoManager);
+    m_signRequest.setData(m_data);
+    m_signRequest.setPadding(Sailfish::Crypto::CryptoManager::SignaturePaddingNone);
+    m_signRequest.setDigestFunction(Sailfish::Crypto::CryptoManager::DigestSha256);
+    m_signRequest.setCryptoPluginName(TEST_CRYPTO_PLUGIN);
+}
+
+Sailfish::Secrets::Secret::Identifier LoadWorker::secretIdentifier(int index) const
+{
+    return Sailfish::Secrets::Secret::Identifier(QStringLiteral("secret%1").arg(index),
+                                                 m_collectionName,
+                                                 TEST_STORAGE_PLUGIN);
+}
+
+Sailfish::Secrets::Secret::FilterData LoadWorker::filterData(int index) const
+{
+    Sailfish::Secrets::Secret::FilterData filter;
+    filter.insert(QStringLiteral("group"), QString::number(index % m_config.filterCardinality));
+    return filter;
+}
+
+bool LoadWorker::setUp()
+{
+    Sailfish::Secrets::CreateCollectionRequest ccr;
+    ccr.setManager(&m_secretManager);
+    ccr.setCollectionLockType(Sailfish::Secrets::CreateCollectionRequest::DeviceLock);
+    ccr.setCollectionName(m_collectionName);
+    ccr.setStoragePluginName(TEST_STORAGE_PLUGIN);
+    ccr.setEncryptionPluginName(TEST_ENCRYPTION_PLUGIN);
+    ccr.setDeviceLockUnlockSemantic(Sailfish::Secrets::SecretManager::DeviceLockKeepUnlocked);
+    ccr.setAccessControlMode(Sailfish::Secrets::SecretManager::OwnerOnlyMode);
+    if (!runRequest(&ccr)) {
+        qWarning() << "Worker" << m_index << "failed to create collection:" << ccr.result().errorMessage();
+        return false;
+    }
+    m_collectionCreated = true;
+
+    // Populate the collection, so that get and find requests have
+    // something to retrieve.
+    for (int i = 0; i < m_config.populateCount; ++i) {
+        if (!storeSecret()) {
+            qWarning() << "Worker" << m_index << "failed to populate collection:" << m_storeRequest.result().errorMessage();
+            return false;
+        }
+    }
+
+    if (m_config.mix.contains(EncryptType)) {
+        Sailfish::Crypto::Key keyTemplate;
+        keyTemplate.setAlgorithm(Sailfish::Crypto::CryptoManager::AlgorithmAes);
+        keyTemplate.setSize(256);
+        keyTemplate.setOperations(Sailfish::Crypto::CryptoManager::OperationEncrypt | Sailfish::Crypto::CryptoManager::OperationDecrypt);
+
+        Sailfish::Crypto::GenerateKeyRequest gkr;
+        gkr.setManager(&m_cryptoManager);
+        gkr.setKeyTemplate(keyTemplate);
+        gkr.setCryptoPluginName(TEST_CRYPTO_PLUGIN);
+        if (!runRequest(&gkr)) {
+            qWarning() << "Worker" << m_index << "failed to generate symmetric key:" << gkr.result().errorMessage();
+            return false;
+        }
+        m_symmetricKey = gkr.generatedKey();
+
+        Sailfish::Crypto::GenerateInitializationVectorRequest ivr;
+        ivr.setManager(&m_cryptoManager);
+        ivr.setAlgorithm(Sailfish::Crypto::CryptoManager::AlgorithmAes);
+        ivr.setBlockMode(Sailfish::Crypto::CryptoManager::BlockModeCbc);
+        ivr.setKeySize(256);
+        ivr.setCryptoPluginName(TEST_CRYPTO_PLUGIN);
+        if (!runRequest(&ivr)) {
+            qWarning() << "Worker" << m_index << "failed to generate initialization vector:" << ivr.result().errorMessage();
+            return false;
+        }
+        m_initializationVector = ivr.generatedInitializationVector();
+
+        m_encryptRequest.setKey(m_symmetricKey);
+        m_encryptRequest.setInitializationVector(m_initializationVector);
+    }
+
+    if (m_config.mix.contains(SignType)) {
+        Sailfish::Crypto::Key keyTemplate;
+        keyTemplate.setAlgorithm(Sailfish::Crypto::CryptoManager::AlgorithmRsa);
+        keyTemplate.setSize(2048);
+        keyTemplate.setOperations(Sailfish::Crypto::CryptoManager::OperationSign | Sailfish::Crypto::CryptoManager::OperationVerify);
+
+        Sailfish::Crypto::RsaKeyPairGenerationParameters rsaParams;
+        rsaParams.setModulusLength(2048);
+
+        Sailfish::Crypto::GenerateKeyRequest gkr;
+        gkr.setManager(&m_cryptoManager);
+        gkr.setKeyTemplate(keyTemplate);
+        gkr.setKeyPairGenerationParameters(rsaParams);
+        gkr.setCryptoPluginName(TEST_CRYPTO_PLUGIN);
+        if (!runRequest(&gkr)) {
+            qWarning() << "Worker" << m_index << "failed to generate signing key:" << gkr.result().errorMessage();
+            return false;
+        }
+        m_signingKey = gkr.generatedKey();
+        m_signRequest.setKey(m_signingKey);
+    }
+
+    return true;
+}
+
+void LoadWorker::run()
+{
+    QElapsedTimer elapsed;
+    QElapsedTimer latency;
+    const qint64 durationMsecs = qint64(m_config.durationSecs) * 1000;
+    int performed = 0;
+
+    elapsed.start();
+    while (m_config.requestsPerClient > 0
+            ? performed < m_config.requestsPerClient
+            : elapsed.elapsed() < durationMsecs) {
+        const QString type = pickRequestType();
+        latency.start();
+        const bool succeeded = performRequest(type);
+        const qint64 latencyUsecs = latency.nsecsElapsed() / 1000;
+
+        TypeResults &results(m_results[type]);
+        if (succeeded) {
+            results.latenciesUsecs.append(latencyUsecs);
+        } else {
+            results.errors++;
+        }
+        performed++;
+    }
+    m_elapsedUsecs = elapsed.nsecsElapsed() / 1000;
+}
+
+void LoadWorker::tearDown()
+{
+    if (!m_collectionCreated) {
+        return;
+    }
+
+    Sailfish::Secrets::DeleteCollectionRequest dcr;
+    dcr.setManager(&m_secretManager);
+    dcr.setCollectionName(m_collectionName);
+    dcr.setStoragePluginName(TEST_STORAGE_PLUGIN);
+    dcr.setUserInteractionMode(Sailfish::Secrets::SecretManager::ApplicationInteraction);
+    if (!runRequest(&dcr)) {
+        qWarning() << "Worker" << m_index << "failed to delete collection:" << dcr.result().errorMessage();
+    }
+    m_collectionCreated = false;
+}
+
+QJsonObject LoadWorker::results() const
+{
+    QJsonObject types;
+    for (QMap<QString, TypeResults>::const_iterator it = m_results.constBegin(); it != m_results.constEnd(); ++it) {
+        QJsonArray latencies;
+        for (qint64 latency : it.value().latenciesUsecs) {
+            latencies.append(double(latency));
+        }
+        QJsonObject type;
+        type.insert(QStringLiteral("latenciesUsecs"), latencies);
+        type.insert(QStringLiteral("errors"), it.value().errors);
+        types.insert(it.key(), type);
+    }
+
+    QJsonObject results;
+    results.insert(QStringLiteral("worker"), m_index);
+    results.insert(QStringLiteral("elapsedUsecs"), double(m_elapsedUsecs));
+    results.insert(QStringLiteral("types"), types);
+    return results;
+}
+
+QString LoadWorker::pickRequestType() const
+{
+    int choice = qrand() % m_totalWeight;
+    for (QMap<QString, int>::const_iterator it = m_config.mix.constBegin(); it != m_config.mix.constEnd(); ++it) {
+        if (choice < it.value()) {
+            return it.key();
+        }
+        choice -= it.value();
+    }
+    return m_config.mix.lastKey();
+}
+
+bool LoadWorker::performRequest(const QString &type)
+{
+    if (type == StoreType) {
+        return storeSecret();
+    } else if (type == GetType) {
+        return getSecret();
+    } else if (type == FindType) {
+        return findSecrets();
+    } else if (type == EncryptType) {
+        return encrypt();
+    } else if (type == SignType) {
+        return sign();
+    }
+    return false;
+}
+
+bool LoadWorker::storeSecret()
+{
+    const int index = m_storedCount++;
+    Sailfish::Secrets::Secret secret(secretIdentifier(index));
+    secret.setData(m_data);
+    secret.setType(Sailfish::Secrets::Secret::TypeBlob);
+    secret.setFilterData(filterData(index));
+    m_storeRequest.setSecret(secret);
+    return runRequest(&m_storeRequest);
+}
+
+bool LoadWorker::getSecret()
+{
+    if (m_storedCount == 0) {
+        return false;
+    }
+    m_storedRequest.setIdentifier(secretIdentifier(qrand() % m_storedCount));
+    return runRequest(&m_storedRequest);
+}
+
+bool LoadWorker::findSecrets()
+{
+    m_findRequest.setFilter(filterData(qrand()));
+    return runRequest(&m_findRequest);
+}
+
+bool LoadWorker::encrypt()
+{
+    return runRequest(&m_encryptRequest);
+}
+
+bool LoadWorker::sign()
+{
+    return runRequest(&m_signRequest);
+}
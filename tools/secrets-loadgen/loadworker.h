@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2018 Jolla Ltd.
+ * Contact: Chris Adams <chris.adams@jollamobile.com>
+ * All rights reserved.
+ * BSD 3-Clause License, see LICENSE.
+ */
+
+#ifndef SAILFISH_SECRETS_LOADGEN_LOADWORKER_H
+#define SAILFISH_SECRETS_LOADGEN_LOADWORKER_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QJsonObject>
+#include <QtCore/QMap>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QVector>
+
+#include <Secrets/secretmanager.h>
+#include <Secrets/secret.h>
+#include <Secrets/storesecretrequest.h>
+#include <Secrets/storedsecretrequest.h>
+#include <Secrets/findsecretsrequest.h>
+
+#include <Crypto/cryptomanager.h>
+#include <Crypto/key.h>
+#include <Crypto/encryptrequest.h>
+#include <Crypto/signrequest.h>
+
+// The load generator options which are shared by the coordinating
+// process and each of the client (worker) processes.
+struct LoadConfiguration
+{
+    static QStringList requestTypes();
+    static bool parseMix(const QString &mix, QMap<QString, int> *weights);
+
+    int clients = 4;
+    int durationSecs = 10;
+    int requestsPerClient = 0;  // 0 means until the duration has elapsed
+    int dataSize = 256;
+    int populateCount = 100;
+    int filterCardinality = 10;
+    QMap<QString, int> mix;     // request type to relative weight
+};
+
+// A single client connection to the (autotest-mode) secrets daemon.
+// Each worker runs in its own process, as the client libraries maintain
+// a single peer-to-peer connection to the daemon per process.
+//
+// The worker creates its own collection (and keys) using the test
+// plugins, then issues requests back-to-back, chosen randomly according
+// to the configured mix, and records the round-trip latency of each.
+class LoadWorker
+{
+public:
+    LoadWorker(int index, const LoadConfiguration &config);
+
+    bool setUp();
+    void run();
+    void tearDown();
+
+    QJsonObject results() const;
+
+private:
+    bool performRequest(const QString &type);
+    bool storeSecret();
+    bool getSecret();
+    bool findSecrets();
+    bool encrypt();
+    bool sign();
+    QString pickRequestType() const;
+    Sailfish::Secrets::Secret::Identifier secretIdentifier(int index) const;
+    Sailfish::Secrets::Secret::FilterData filterData(int index) const;
+
+    struct TypeResults {
+        QVector<qint64> latenciesUsecs;
+        int errors = 0;
+    };
+
+    Sailfish::Secrets::SecretManager m_secretManager;
+    Sailfish::Crypto::CryptoManager m_cryptoManager;
+    Sailfish::Secrets::StoreSecretRequest m_storeRequest;
+    Sailfish::Secrets::StoredSecretRequest m_storedRequest;
+    Sailfish::Secrets::FindSecretsRequest m_findRequest;
+    Sailfish::Crypto::EncryptRequest m_encryptRequest;
+    Sailfish::Crypto::SignRequest m_signRequest;
+
+    LoadConfiguration m_config;
+    QString m_collectionName;
+    QByteArray m_data;
+    Sailfish::Crypto::Key m_symmetricKey;
+    Sailfish::Crypto::Key m_signingKey;
+    QByteArray m_initializationVector;
+    QMap<QString, TypeResults> m_results;
+    qint64 m_elapsedUsecs = 0;
+    int m_index;
+    int m_storedCount = 0;
+    int m_totalWeight = 0;
+    bool m_collectionCreated = false;
+};
+
+#endif // SAILFISH_SECRETS_LOADGEN_LOADWORKER_H
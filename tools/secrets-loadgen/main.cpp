@@ -0,0 +1,313 @@
+/*
+ * Copyright (C) 2018 Jolla Ltd.
+ * Contact: Chris Adams <chris.adams@jollamobile.com>
+ * All rights reserved.
+ * BSD 3-Clause License, see LICENSE.
+ */
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QFile>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QProcess>
+#include <QtCore/QSharedPointer>
+#include <QtCore/QStringList>
+#include <QtCore/QString>
+#include <QtCore/QByteArray>
+#include <QtDebug>
+
+#include <algorithm>
+#include <cmath>
+
+#include "loadworker.h"
+
+#define WORKER_READY "ready"
+#define WORKER_START "start"
+#define WORKER_SETUP_TIMEOUT 120000
+
+namespace {
+
+void printUsage(const QString &appName)
+{
+    const QString text = QStringLiteral(
+        "Usage: %1 [options]\n"
+        "\n"
+        "Generates load against a secrets daemon running in --test mode, using the\n"
+        "test plugins, and reports the throughput and latency percentiles of each\n"
+        "request type.  Each client connection runs in its own process.\n"
+        "\n"
+        "Options:\n"
+        "  --clients <count>             Number of concurrent client connections (default 4)\n"
+        "  --duration <seconds>          Duration of the measured run (default 10)\n"
+        "  --requests <count>            Requests per client, instead of a duration\n"
+        "  --mix <type=weight,...>       Request mix, from the types store, get, find, encrypt\n"
+        "                                and sign (default store=1,get=4,find=2,encrypt=2,sign=1)\n"
+        "  --data-size <bytes>           Size of the stored secrets and encrypted or signed data (default 256)\n"
+        "  --populate <count>            Secrets stored by each client before the run (default 100)\n"
+        "  --filter-cardinality <count>  Number of distinct filter values used by find requests (default 10)\n"
+        "  --json                        Print the results as JSON\n"
+        "  --help, -h                    Display this help text\n"
+        "\n"
+        "E.g.:\n"
+        "  %1 --clients 8 --duration 30 --mix get=10,encrypt=1\n").arg(appName);
+    fprintf(stdout, "%s", text.toLocal8Bit().constData());
+}
+
+bool parseArguments(const QStringList &args, LoadConfiguration *config, bool *json, int *workerIndex)
+{
+    LoadConfiguration::parseMix(QStringLiteral("store=1,get=4,find=2,encrypt=2,sign=1"), &config->mix);
+
+    for (int i = 0; i < args.size(); ++i) {
+        const QString &arg(args.at(i));
+        if (arg == QStringLiteral("--json")) {
+            *json = true;
+            continue;
+        }
+        if (arg == QStringLiteral("--test")) {
+            // Accepted for consistency with secrets-tool: the test plugins are always used.
+            continue;
+        }
+        if (i + 1 >= args.size()) {
+            return false;
+        }
+        const QString value = args.at(++i);
+        bool ok = true;
+        if (arg == QStringLiteral("--mix")) {
+            ok = LoadConfiguration::parseMix(value, &config->mix);
+        } else if (arg == QStringLiteral("--clients")) {
+            config->clients = value.toInt(&ok);
+            ok = ok && config->clients > 0;
+        } else if (arg == QStringLiteral("--duration")) {
+            config->durationSecs = value.toInt(&ok);
+            ok = ok && config->durationSecs > 0;
+        } else if (arg == QStringLiteral("--requests")) {
+            config->requestsPerClient = value.toInt(&ok);
+            ok = ok && config->requestsPerClient >= 0;
+        } else if (arg == QStringLiteral("--data-size")) {
+            config->dataSize = value.toInt(&ok);
+            ok = ok && config->dataSize > 0;
+        } else if (arg == QStringLiteral("--populate")) {
+            config->populateCount = value.toInt(&ok);
+            ok = ok && config->populateCount >= 0;
+        } else if (arg == QStringLiteral("--filter-cardinality")) {
+            config->filterCardinality = value.toInt(&ok);
+            ok = ok && config->filterCardinality > 0;
+        } else if (arg == QStringLiteral("--worker")) {
+            *workerIndex = value.toInt(&ok);
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            fprintf(stderr, "Invalid argument: %s %s\n", arg.toLocal8Bit().constData(), value.toLocal8Bit().constData());
+            return false;
+        }
+    }
+    return true;
+}
+
+// Runs a single client connection.  The worker sets up its collection and
+// keys, reports that it is ready, waits for the coordinator to tell it to
+// start, then runs the load and writes its raw results as a line of JSON.
+int runWorker(int index, const LoadConfiguration &config)
+{
+    QFile input;
+    QFile output;
+    input.open(stdin, QIODevice::ReadOnly);
+    output.open(stdout, QIODevice::WriteOnly);
+
+    LoadWorker worker(index, config);
+    if (!worker.setUp()) {
+        worker.tearDown();
+        return 1;
+    }
+
+    output.write(WORKER_READY "\n");
+    output.flush();
+    if (input.readLine().trimmed() != WORKER_START) {
+        worker.tearDown();
+        return 1;
+    }
+
+    worker.run();
+    worker.tearDown();
+
+    output.write(QJsonDocument(worker.results()).toJson(QJsonDocument::Compact));
+    output.write("\n");
+    output.flush();
+    return 0;
+}
+
+qint64 percentile(const QVector<qint64> &sorted, double p)
+{
+    if (sorted.isEmpty()) {
+        return 0;
+    }
+    // nearest-rank percentile
+    int rank = int(std::ceil(p / 100.0 * sorted.size()));
+    return sorted.at(qBound(0, rank - 1, sorted.size() - 1));
+}
+
+QJsonObject summarize(const QVector<qint64> &latencies, int errors, double elapsedSecs)
+{
+    QVector<qint64> sorted(latencies);
+    std::sort(sorted.begin(), sorted.end());
+    qint64 total = 0;
+    for (qint64 latency : sorted) {
+        total += latency;
+    }
+
+    QJsonObject latency;
+    latency.insert(QStringLiteral("min"), double(sorted.isEmpty() ? 0 : sorted.first()));
+    latency.insert(QStringLiteral("mean"), sorted.isEmpty() ? 0.0 : double(total) / sorted.size());
+    latency.insert(QStringLiteral("p50"), double(percentile(sorted, 50)));
+    latency.insert(QStringLiteral("p90"), double(percentile(sorted, 90)));
+    latency.insert(QStringLiteral("p99"), double(percentile(sorted, 99)));
+    latency.insert(QStringLiteral("p999"), double(percentile(sorted, 99.9)));
+    latency.insert(QStringLiteral("max"), double(sorted.isEmpty() ? 0 : sorted.last()));
+
+    QJsonObject summary;
+    summary.insert(QStringLiteral("count"), sorted.size());
+    summary.insert(QStringLiteral("errors"), errors);
+    summary.insert(QStringLiteral("requestsPerSecond"), elapsedSecs > 0 ? sorted.size() / elapsedSecs : 0.0);
+    summary.insert(QStringLiteral("latencyUsecs"), latency);
+    return summary;
+}
+
+void printSummary(const QJsonObject &report)
+{
+    const QJsonObject types = report.value(QStringLiteral("types")).toObject();
+    fprintf(stdout, "%d clients, %.2f seconds\n\n",
+            report.value(QStringLiteral("clients")).toInt(),
+            report.value(QStringLiteral("elapsedUsecs")).toDouble() / 1e6);
+    fprintf(stdout, "%-8s %9s %7s %10s %9s %9s %9s %9s %9s\n",
+            "type", "count", "errors", "req/s", "p50 us", "p90 us", "p99 us", "p99.9 us", "max us");
+
+    QStringList names = types.keys();
+    names.append(QStringLiteral("total"));
+    for (const QString &name : names) {
+        const QJsonObject summary = name == QStringLiteral("total")
+                ? report.value(QStringLiteral("total")).toObject()
+                : types.value(name).toObject();
+        const QJsonObject latency = summary.value(QStringLiteral("latencyUsecs")).toObject();
+        fprintf(stdout, "%-8s %9d %7d %10.1f %9.0f %9.0f %9.0f %9.0f %9.0f\n",
+                name.toLatin1().constData(),
+                summary.value(QStringLiteral("count")).toInt(),
+                summary.value(QStringLiteral("errors")).toInt(),
+                summary.value(QStringLiteral("requestsPerSecond")).toDouble(),
+                latency.value(QStringLiteral("p50")).toDouble(),
+                latency.value(QStringLiteral("p90")).toDouble(),
+                latency.value(QStringLiteral("p99")).toDouble(),
+                latency.value(QStringLiteral("p999")).toDouble(),
+                latency.value(QStringLiteral("max")).toDouble());
+    }
+}
+
+// Starts one worker process per client, waits until all of them have
+// finished setting up, starts them simultaneously, then merges their
+// raw latencies into per-request-type percentiles.
+int runCoordinator(const QStringList &args, const LoadConfiguration &config, bool json)
+{
+    QList<QSharedPointer<QProcess> > workers;
+    for (int i = 0; i < config.clients; ++i) {
+        QSharedPointer<QProcess> worker(new QProcess);
+        worker->setProcessChannelMode(QProcess::ForwardedErrorChannel);
+        worker->start(QCoreApplication::applicationFilePath(),
+                      QStringList(args) << QStringLiteral("--worker") << QString::number(i));
+        workers.append(worker);
+    }
+
+    bool ready = true;
+    for (const QSharedPointer<QProcess> &worker : workers) {
+        while (ready && !worker->canReadLine()) {
+            ready = worker->waitForReadyRead(WORKER_SETUP_TIMEOUT);
+        }
+        if (!ready || worker->readLine().trimmed() != WORKER_READY) {
+            ready = false;
+            break;
+        }
+    }
+
+    for (const QSharedPointer<QProcess> &worker : workers) {
+        worker->write(ready ? WORKER_START "\n" : "\n");
+        worker->closeWriteChannel();
+    }
+
+    QMap<QString, QVector<qint64> > latencies;
+    QMap<QString, int> errors;
+    double elapsedUsecs = 0;
+    bool succeeded = ready;
+    for (const QSharedPointer<QProcess> &worker : workers) {
+        worker->waitForFinished(-1);
+        if (worker->exitStatus() != QProcess::NormalExit || worker->exitCode() != 0) {
+            succeeded = false;
+            continue;
+        }
+        const QJsonObject results = QJsonDocument::fromJson(worker->readAll().trimmed()).object();
+        elapsedUsecs = qMax(elapsedUsecs, results.value(QStringLiteral("elapsedUsecs")).toDouble());
+        const QJsonObject types = results.value(QStringLiteral("types")).toObject();
+        for (QJsonObject::const_iterator it = types.constBegin(); it != types.constEnd(); ++it) {
+            const QJsonObject type = it.value().toObject();
+            QVector<qint64> &typeLatencies(latencies[it.key()]);
+            for (const QJsonValue &latency : type.value(QStringLiteral("latenciesUsecs")).toArray()) {
+                typeLatencies.append(qint64(latency.toDouble()));
+            }
+            errors[it.key()] += type.value(QStringLiteral("errors")).toInt();
+        }
+    }
+
+    if (!succeeded) {
+        qWarning() << "One or more clients failed, is the daemon running in --test mode?";
+        return 1;
+    }
+
+    const double elapsedSecs = elapsedUsecs / 1e6;
+    QVector<qint64> allLatencies;
+    int allErrors = 0;
+    QJsonObject types;
+    for (QMap<QString, QVector<qint64> >::const_iterator it = latencies.constBegin(); it != latencies.constEnd(); ++it) {
+        types.insert(it.key(), summarize(it.value(), errors.value(it.key()), elapsedSecs));
+        allLatencies += it.value();
+        allErrors += errors.value(it.key());
+    }
+
+    QJsonObject report;
+    report.insert(QStringLiteral("clients"), config.clients);
+    report.insert(QStringLiteral("elapsedUsecs"), elapsedUsecs);
+    report.insert(QStringLiteral("dataSize"), config.dataSize);
+    report.insert(QStringLiteral("types"), types);
+    report.insert(QStringLiteral("total"), summarize(allLatencies, allErrors, elapsedSecs));
+
+    if (json) {
+        fprintf(stdout, "%s\n", QJsonDocument(report).toJson(QJsonDocument::Indented).constData());
+    } else {
+        printSummary(report);
+    }
+    return 0;
+}
+
+}
+
+Q_DECL_EXPORT int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QStringList args(app.arguments());
+    const QString appName = args.takeFirst();
+
+    if (args.contains(QStringLiteral("--help")) || args.contains(QStringLiteral("-h"))) {
+        printUsage(appName);
+        return 0;
+    }
+
+    LoadConfiguration config;
+    bool json = false;
+    int workerIndex = -1;
+    if (!parseArguments(args, &config, &json, &workerIndex)) {
+        printUsage(appName);
+        return 1;
+    }
+
+    return workerIndex >= 0
+            ? runWorker(workerIndex, config)
+            : runCoordinator(args, config, json);
+}
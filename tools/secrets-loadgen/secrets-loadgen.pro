@@ -0,0 +1,14 @@
+TEMPLATE = app
+TARGET = secrets-loadgen
+
+CONFIG += link_pkgconfig console
+PKGCONFIG += Qt5Core Qt5DBus
+
+include($$PWD/../../lib/libsailfishsecrets.pri)
+include($$PWD/../../lib/libsailfishcrypto.pri)
+
+SOURCES += $$PWD/loadworker.cpp $$PWD/main.cpp
+HEADERS += $$PWD/loadworker.h
+
+target.path = /opt/tests/Sailfish/Secrets/
+INSTALLS += target
@@ -32,8 +32,14 @@
 #include <Crypto/decryptrequest.h>
 #include <Crypto/generateinitializationvectorrequest.h>
 
+#include <QtDBus/QDBusConnection>
+#include <QtDBus/QDBusInterface>
+#include <QtDBus/QDBusReply>
+
 #include <QtCore/QFile>
 #include <QtCore/QByteArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
 #include <QtDebug>
 
 #define EXITCODE_SUCCESS 0
@@ -104,6 +110,20 @@ static QVariantMap toCustomParameters(const QStringList &options)
     return customs;
 }
 
+static bool daemonRequestStatistics(const QString &service, const QString &path, QJsonObject *statistics)
+{
+    QDBusInterface iface(service, path, service, QDBusConnection::sessionBus());
+    QDBusReply<QString> reply = iface.call(QStringLiteral("requestStatistics"));
+    if (!reply.isValid()) {
+        qInfo() << "Failed to retrieve request statistics from" << service;
+        qInfo() << "Error:" << reply.error().message();
+        return false;
+    }
+
+    *statistics = QJsonDocument::fromJson(reply.value().toUtf8()).object();
+    return true;
+}
+
 CommandHelper::CommandHelper(bool autotestMode, QObject *parent)
     : QObject(parent), m_step(0), m_exitCode(0), m_autotestMode(autotestMode)
 {
@@ -861,6 +881,79 @@ void CommandHelper::start(const QString &command, const QStringList &args, const
         connect(m_secretsRequest.data(), &Sailfish::Secrets::Request::statusChanged,
                 this, &CommandHelper::secretsRequestStatusChanged);
         m_secretsRequest->startRequest();
+    } else if (command == QStringLiteral("--request-statistics")) {
+        QJsonObject secretsStatistics;
+        QJsonObject cryptoStatistics;
+        if (!daemonRequestStatistics(QStringLiteral("org.sailfishos.secrets.daemon.discovery"),
+                                     QStringLiteral("/Sailfish/Secrets/Discovery"),
+                                     &secretsStatistics)
+                || !daemonRequestStatistics(QStringLiteral("org.sailfishos.crypto.daemon.discovery"),
+                                            QStringLiteral("/Sailfish/Crypto/Discovery"),
+                                            &cryptoStatistics)) {
+            emitFinished(EXITCODE_FAILED);
+            return;
+        }
+        QJsonObject statistics;
+        statistics.insert(QStringLiteral("secrets"), secretsStatistics);
+        statistics.insert(QStringLiteral("crypto"), cryptoStatistics);
+        qInfo().noquote() << QString::fromUtf8(QJsonDocument(statistics).toJson(QJsonDocument::Indented));
+        emitFinished(EXITCODE_SUCCESS);
+    } else if (command == QStringLiteral("--request-trace")) {
+        QDBusInterface iface(QStringLiteral("org.sailfishos.secrets.daemon.discovery"),
+                             QStringLiteral("/Sailfish/Secrets/Discovery"),
+                             QStringLiteral("org.sailfishos.secrets.daemon.discovery"),
+                             QDBusConnection::sessionBus());
+        QDBusReply<QString> reply = iface.call(QStringLiteral("requestTrace"));
+        if (!reply.isValid()) {
+            qInfo() << "Failed to retrieve request trace!";
+            qInfo() << "Error:" << reply.error().message();
+            emitFinished(EXITCODE_FAILED);
+            return;
+        }
+        if (args.size()) {
+            QFile file(args.value(0));
+            if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+                qInfo() << "Unable to open file:" << args.value(0);
+                emitFinished(EXITCODE_FAILED);
+                return;
+            }
+            file.write(reply.value().toUtf8());
+            file.close();
+        } else {
+            qInfo().noquote() << reply.value();
+        }
+        emitFinished(EXITCODE_SUCCESS);
+    } else if (command == QStringLiteral("--plugin-statistics")) {
+        QDBusInterface iface(QStringLiteral("org.sailfishos.secrets.daemon.discovery"),
+                             QStringLiteral("/Sailfish/Secrets/Discovery"),
+                             QStringLiteral("org.sailfishos.secrets.daemon.discovery"),
+                             QDBusConnection::sessionBus());
+        if (args.size()) {
+            if (args.value(0) != QStringLiteral("enable") && args.value(0) != QStringLiteral("disable")) {
+                qInfo() << "Invalid argument:" << args.value(0);
+                emitFinished(EXITCODE_FAILED);
+                return;
+            }
+            QDBusReply<void> reply = iface.call(QStringLiteral("setPluginStatisticsEnabled"),
+                                                args.value(0) == QStringLiteral("enable"));
+            if (!reply.isValid()) {
+                qInfo() << "Failed to change plugin statistics collection!";
+                qInfo() << "Error:" << reply.error().message();
+                emitFinished(EXITCODE_FAILED);
+                return;
+            }
+            emitFinished(EXITCODE_SUCCESS);
+            return;
+        }
+        QDBusReply<QString> reply = iface.call(QStringLiteral("pluginStatistics"));
+        if (!reply.isValid()) {
+            qInfo() << "Failed to retrieve plugin statistics!";
+            qInfo() << "Error:" << reply.error().message();
+            emitFinished(EXITCODE_FAILED);
+            return;
+        }
+        qInfo().noquote() << QString::fromUtf8(QJsonDocument::fromJson(reply.value().toUtf8()).toJson(QJsonDocument::Indented));
+        emitFinished(EXITCODE_SUCCESS);
     } else {
         qInfo() << "Unknown command:" << command;
         emitFinished(EXITCODE_FAILED);
@@ -74,6 +74,9 @@ Q_DECL_EXPORT int main(int argc, char *argv[])
         {"--decrypt", "Decrypt a particular file with the specified key, output to stdout" },
         {"--get-user-input", "Request user input via system dialog" },
         {"--health-check", "Check the health of secrets daemon data" },
+        {"--request-statistics", "Dump the per-request-type counters and latency histograms of the secrets daemon, as JSON" },
+        {"--request-trace", "Dump the recently traced requests of the secrets daemon, in Chrome trace-event JSON format (the daemon must be started with SAILFISH_SECRETSD_TRACE_BUFFER_SIZE set)" },
+        {"--plugin-statistics", "Dump the per-plugin call counts, errors, bytes and timings of the secrets daemon as JSON, or enable or disable their collection" },
     };
 
     const QMap<QString, QString> paramOptions {
@@ -98,6 +101,9 @@ Q_DECL_EXPORT int main(int argc, char *argv[])
         {"--decrypt", "<cryptoPlugin> <storagePlugin> <collectionName> <keyName> <fileName>" },
         {"--get-user-input", "" },
         {"--health-check", "" },
+        {"--request-statistics", "" },
+        {"--request-trace", "[<outputFile>]" },
+        {"--plugin-statistics", "[enable|disable]" },
     };
 
     const QMap<QString, int> paramOptionsMin {
@@ -125,6 +131,9 @@ Q_DECL_EXPORT int main(int argc, char *argv[])
         {"--decrypt", 5 },
         {"--get-user-input", 0 },
         {"--health-check", 0 },
+        {"--request-statistics", 0 },
+        {"--request-trace", 0 },
+        {"--plugin-statistics", 0 },
     };
 
     const QMap<QString, int> paramOptionsMax {
@@ -152,6 +161,9 @@ Q_DECL_EXPORT int main(int argc, char *argv[])
         {"--decrypt", 5 },
         {"--get-user-input", 0 },
         {"--health-check", 0 },
+        {"--request-statistics", 0 },
+        {"--request-trace", 1 },
+        {"--plugin-statistics", 1 },
     };
 
     const QMap<QString, QString> paramExamples {
@@ -179,6 +191,9 @@ Q_DECL_EXPORT int main(int argc, char *argv[])
         {"--decrypt", "org.sailfishos.secrets.plugin.encryptedstorage.sqlcipher org.sailfishos.secrets.plugin.encryptedstorage.sqlcipher MyCollection MyAesKey document.txt.enc > document.txt.dec" },
         {"--get-user-input", "" },
         {"--health-check", "" },
+        {"--request-statistics", "" },
+        {"--request-trace", "trace.json" },
+        {"--plugin-statistics", "enable" },
     };
 
     bool autotestMode = false;
@@ -1,3 +1,4 @@
 TEMPLATE = subdirs
 SUBDIRS += \
-    $$PWD/secrets-tool
+    $$PWD/secrets-tool \
+    $$PWD/secrets-loadgen